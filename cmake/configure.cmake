@@ -40,6 +40,14 @@ if (SSE3_FOUND)
     add_definitions(-DPADDLE_WITH_SSE3)
 endif()
 
+if(AVX512VNNI_INTRINSICS_FOUND AND NOT WIN32)
+    add_definitions(-DPADDLE_WITH_AVX512VNNI_INTRINSICS)
+endif()
+
+if(AVX512BF16_INTRINSICS_FOUND AND NOT WIN32)
+    add_definitions(-DPADDLE_WITH_AVX512BF16_INTRINSICS)
+endif()
+
 if(WIN32)
   # windows header option for all targets.
   add_definitions(-D_XKEYCHECK_H)
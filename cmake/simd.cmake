@@ -96,4 +96,32 @@ int main()
 }" AVX512F_FOUND)
 
 set(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_RETAINED})
-mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND)
+
+# Check the intrinsics of AVX512-VNNI (GCC 8) and AVX512-BF16 (GCC 10), which
+# the kernels compile with the target attribute and choose at run time.
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+__attribute__((target(\"avx512f,avx512bw,avx512vnni\")))
+__m512i Dot(__m512i acc, __m512i a, __m512i b) {
+    return _mm512_dpbusd_epi32(acc, a, b);
+}
+int main()
+{
+    return 0;
+}" AVX512VNNI_INTRINSICS_FOUND)
+
+CHECK_CXX_SOURCE_COMPILES("
+#include <immintrin.h>
+__attribute__((target(\"avx512f,avx512bw,avx512vl,avx512bf16\")))
+__m512 Dot(__m512 acc, __m512 x, __m512i b) {
+    __m256i a = (__m256i)_mm512_cvtneps_pbh(x);
+    return _mm512_dpbf16_ps(acc, (__m512bh)_mm512_broadcast_i64x4(a),
+                            (__m512bh)b);
+}
+int main()
+{
+    return 0;
+}" AVX512BF16_INTRINSICS_FOUND)
+
+mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND
+                 AVX512VNNI_INTRINSICS_FOUND AVX512BF16_INTRINSICS_FOUND)
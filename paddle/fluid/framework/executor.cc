@@ -30,6 +30,7 @@ limitations under the License. */
 
 DECLARE_bool(benchmark);
 DECLARE_bool(use_mkldnn);
+DECLARE_bool(enable_adaptive_gc);
 
 namespace paddle {
 namespace framework {
@@ -460,7 +461,11 @@ void Executor::RunPartialPreparedContext(ExecutorPrepareContext* ctx,
           platform::errors::Unimplemented("No GPU gc found in CPU/XPU paddle"));
 #endif
     } else if (platform::is_cpu_place(place_)) {
-      gc.reset(new CPUGarbageCollector(place_, max_memory_size));
+      if (FLAGS_enable_adaptive_gc) {
+        gc.reset(new CPUAdaptiveGarbageCollector(place_));
+      } else {
+        gc.reset(new CPUGarbageCollector(place_, max_memory_size));
+      }
     } else if (platform::is_xpu_place(place_)) {
 #ifdef PADDLE_WITH_XPU
       gc.reset(new XPUGarbageCollector(place_, max_memory_size));
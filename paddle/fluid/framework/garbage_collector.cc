@@ -18,11 +18,15 @@
 #endif
 #include "gflags/gflags.h"
 #include "paddle/fluid/framework/garbage_collector.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/allocation/reuse_allocator.h"
 #include "paddle/fluid/platform/device/device_wrapper.h"
+#include "paddle/fluid/platform/os_info.h"
 
 DECLARE_double(eager_delete_tensor_gb);
 DECLARE_double(memory_fraction_of_eager_deletion);
 DECLARE_bool(fast_eager_deletion_mode);
+DECLARE_int32(adaptive_gc_max_memory_mb);
 
 namespace paddle {
 namespace framework {
@@ -45,6 +49,116 @@ void CPUGarbageCollector::ClearCallback(const std::function<void()> &callback) {
   callback();
 }
 
+AdaptiveGarbageReleaser &AdaptiveGarbageReleaser::Instance() {
+  // Never destroyed, otherwise the garbages pending at exit may be freed
+  // after the allocators.
+  static AdaptiveGarbageReleaser *instance = new AdaptiveGarbageReleaser();
+  return *instance;
+}
+
+static size_t AdaptiveGCMaxThreshold() {
+  return (std::max)(AdaptiveGarbageReleaser::kMinThreshold,
+                    static_cast<size_t>(FLAGS_adaptive_gc_max_memory_mb)
+                        << 20);
+}
+
+constexpr size_t AdaptiveGarbageReleaser::kMinThreshold;
+
+AdaptiveGarbageReleaser::AdaptiveGarbageReleaser() {
+  size_t threshold = static_cast<size_t>(
+      (std::max)(GetEagerDeletionThreshold(), static_cast<int64_t>(0)));
+  threshold = (std::max)(threshold, kMinThreshold);
+  threshold_.store((std::min)(threshold, AdaptiveGCMaxThreshold()));
+  // It is nullptr if the CPU allocator is not wrapped by ReuseAllocator,
+  // e.g. FLAGS_use_system_allocator is on
+  reuse_allocator_ = dynamic_cast<memory::allocation::ReuseAllocator *>(
+      memory::allocation::AllocatorFacade::Instance()
+          .GetAllocator(platform::CPUPlace())
+          .get());
+  if (reuse_allocator_ != nullptr) {
+    reuse_allocator_->SetCapacity(Threshold());
+  }
+  thread_ = std::thread([this]() { ReleaseLoop(); });
+}
+
+void AdaptiveGarbageReleaser::Release(std::function<void()> free_fn) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    free_fns_.push_back(std::move(free_fn));
+  }
+  release_cv_.notify_one();
+}
+
+void AdaptiveGarbageReleaser::ReleaseLoop() {
+  platform::SetCurrentThreadName("AdaptiveGC");
+  while (true) {
+    std::deque<std::function<void()>> free_fns;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      release_cv_.wait(lock, [this]() { return !free_fns_.empty(); });
+      free_fns.swap(free_fns_);
+    }
+    for (auto &free_fn : free_fns) {
+      free_fn();
+    }
+    TuneThreshold();
+  }
+}
+
+size_t AdaptiveGarbageReleaser::NextThreshold(
+    size_t threshold, const memory::allocation::ReuseAllocatorStats &stats,
+    size_t last_peak_allocated_bytes) {
+  constexpr double kHighFragmentation = 0.5;
+  constexpr double kLowFragmentation = 0.25;
+  // The cached bytes are held by the process but not used by any tensor
+  size_t reserved_bytes = stats.allocated_bytes + stats.cached_bytes;
+  double fragmentation =
+      reserved_bytes == 0
+          ? 0
+          : static_cast<double>(stats.cached_bytes) / reserved_bytes;
+  if (stats.peak_allocated_bytes > last_peak_allocated_bytes ||
+      fragmentation > kHighFragmentation) {
+    threshold /= 2;
+  } else if (fragmentation < kLowFragmentation) {
+    threshold *= 2;
+  }
+  return (std::min)((std::max)(threshold, kMinThreshold),
+                    AdaptiveGCMaxThreshold());
+}
+
+void AdaptiveGarbageReleaser::TuneThreshold() {
+  if (reuse_allocator_ == nullptr) {
+    return;
+  }
+  auto stats = reuse_allocator_->GetStats();
+  size_t threshold =
+      NextThreshold(Threshold(), stats, last_peak_allocated_bytes_);
+  last_peak_allocated_bytes_ = stats.peak_allocated_bytes;
+  if (threshold != Threshold()) {
+    VLOG(10) << "AdaptiveGarbageReleaser sets threshold to " << threshold
+             << ", peak allocated " << stats.peak_allocated_bytes
+             << ", cached " << stats.cached_bytes;
+    threshold_.store(threshold, std::memory_order_relaxed);
+    reuse_allocator_->SetCapacity(threshold);
+  }
+}
+
+CPUAdaptiveGarbageCollector::CPUAdaptiveGarbageCollector(
+    const platform::CPUPlace &place)
+    : GarbageCollector(place, AdaptiveGarbageReleaser::kMinThreshold) {}
+
+CPUAdaptiveGarbageCollector::~CPUAdaptiveGarbageCollector() {
+  if (garbages_ && !garbages_->empty()) {
+    GarbageQueue *garbage_queue = garbages_.release();
+    ClearCallback([garbage_queue]() { delete garbage_queue; });
+  }
+}
+
+void CPUAdaptiveGarbageCollector::ClearCallback(
+    const std::function<void()> &callback) {
+  AdaptiveGarbageReleaser::Instance().Release(callback);
+}
+
 #ifdef PADDLE_WITH_XPU
 XPUGarbageCollector::XPUGarbageCollector(const platform::XPUPlace &place,
                                          size_t max_memory_size)
@@ -14,10 +14,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "gflags/gflags.h"
@@ -27,6 +30,13 @@
 #endif
 
 namespace paddle {
+namespace memory {
+namespace allocation {
+class ReuseAllocator;
+struct ReuseAllocatorStats;
+}  // namespace allocation
+}  // namespace memory
+
 namespace framework {
 
 class GarbageCollector {
@@ -52,6 +62,9 @@ class GarbageCollector {
  protected:
   virtual void ClearCallback(const std::function<void()> &callback) = 0;
 
+  // Garbages are cleared once their size reaches the threshold
+  virtual size_t ReleaseThreshold() const { return max_memory_size_; }
+
   platform::DeviceContext *dev_ctx_;
   std::unique_ptr<GarbageQueue> garbages_;
   mutable std::unique_ptr<std::mutex> mutex_;
@@ -67,6 +80,68 @@ class CPUGarbageCollector : public GarbageCollector {
   void ClearCallback(const std::function<void()> &callback) override;
 };
 
+// AdaptiveGarbageReleaser frees the garbages of the adaptive garbage
+// collectors on a dedicated thread, so the frees are off the critical path
+// of the executors. After each batch it tunes the threshold, i.e. how many
+// bytes of garbages a collector batches before handing them over: it is
+// halved when the peak memory grows or most of the cached memory is not
+// reused, and doubled otherwise, within kMinThreshold and
+// FLAGS_adaptive_gc_max_memory_mb. The threshold is also the capacity of the
+// ReuseAllocator of CPU, which keeps the freed buffers for the allocations
+// of the same size.
+class AdaptiveGarbageReleaser {
+ public:
+  static AdaptiveGarbageReleaser &Instance();
+
+  // Runs free_fn on the releasing thread.
+  void Release(std::function<void()> free_fn);
+
+  size_t Threshold() const {
+    return threshold_.load(std::memory_order_relaxed);
+  }
+
+  // The threshold tuned from threshold by the stats of the ReuseAllocator
+  // after a batch, and the peak allocated bytes after the previous one.
+  static size_t NextThreshold(
+      size_t threshold, const memory::allocation::ReuseAllocatorStats &stats,
+      size_t last_peak_allocated_bytes);
+
+  static constexpr size_t kMinThreshold = 1 << 20;
+
+ private:
+  AdaptiveGarbageReleaser();
+  DISABLE_COPY_AND_ASSIGN(AdaptiveGarbageReleaser);
+
+  void ReleaseLoop();
+  void TuneThreshold();
+
+  std::atomic<size_t> threshold_;
+  memory::allocation::ReuseAllocator *reuse_allocator_{nullptr};
+  size_t last_peak_allocated_bytes_{0};
+
+  std::deque<std::function<void()>> free_fns_;
+  std::mutex mutex_;
+  std::condition_variable release_cv_;
+  std::thread thread_;
+};
+
+// CPUAdaptiveGarbageCollector batches the garbages up to the threshold of
+// AdaptiveGarbageReleaser, and frees them on the releasing thread. It is
+// used instead of CPUGarbageCollector when FLAGS_enable_adaptive_gc is on.
+class CPUAdaptiveGarbageCollector : public GarbageCollector {
+ public:
+  explicit CPUAdaptiveGarbageCollector(const platform::CPUPlace &place);
+
+  ~CPUAdaptiveGarbageCollector();
+
+ protected:
+  void ClearCallback(const std::function<void()> &callback) override;
+
+  size_t ReleaseThreshold() const override {
+    return AdaptiveGarbageReleaser::Instance().Threshold();
+  }
+};
+
 #ifdef PADDLE_WITH_XPU
 class XPUGarbageCollector : public GarbageCollector {
  public:
@@ -265,7 +340,7 @@ void GarbageCollector::Add(Container &&objs, Callback &&callback) {
       cur_memory_size_ += obj->size();
       garbages_->push_back(std::move(obj));
     }
-    if (cur_memory_size_ >= max_memory_size_) {
+    if (cur_memory_size_ >= ReleaseThreshold()) {
       cur_memory_size_ = 0;
       garbage_queue = garbages_.release();
       garbages_.reset(new GarbageQueue());
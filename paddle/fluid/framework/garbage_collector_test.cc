@@ -0,0 +1,107 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/garbage_collector.h"
+
+#include <gtest/gtest.h>
+
+#include <future>  // NOLINT
+
+#include "paddle/fluid/memory/allocation/reuse_allocator.h"
+
+DECLARE_int32(adaptive_gc_max_memory_mb);
+
+namespace paddle {
+namespace framework {
+
+using memory::allocation::ReuseAllocatorStats;
+
+// Blocks until the garbages released before are freed, which the releasing
+// thread does in order.
+static void WaitReleased() {
+  std::promise<void> released;
+  AdaptiveGarbageReleaser::Instance().Release(
+      [&released]() { released.set_value(); });
+  released.get_future().wait();
+}
+
+static std::shared_ptr<memory::Allocation> MakeGarbage(size_t size) {
+  static char buffer[1];
+  return std::make_shared<memory::allocation::Allocation>(
+      buffer, size, platform::CPUPlace());
+}
+
+TEST(AdaptiveGarbageReleaser, next_threshold) {
+  constexpr size_t kMin = AdaptiveGarbageReleaser::kMinThreshold;
+  const size_t max = static_cast<size_t>(FLAGS_adaptive_gc_max_memory_mb)
+                     << 20;
+  ReuseAllocatorStats stats;
+  stats.allocated_bytes = 90;
+  stats.cached_bytes = 10;
+  stats.peak_allocated_bytes = 100;
+  // Little cached memory and a stable peak, so more garbages are batched.
+  EXPECT_EQ(AdaptiveGarbageReleaser::NextThreshold(4 * kMin, stats, 100),
+            8 * kMin);
+  // The peak grows.
+  EXPECT_EQ(AdaptiveGarbageReleaser::NextThreshold(4 * kMin, stats, 50),
+            2 * kMin);
+  // Most of the cached memory is not reused.
+  stats.allocated_bytes = 40;
+  stats.cached_bytes = 60;
+  EXPECT_EQ(AdaptiveGarbageReleaser::NextThreshold(4 * kMin, stats, 100),
+            2 * kMin);
+  stats.allocated_bytes = 60;
+  stats.cached_bytes = 40;
+  EXPECT_EQ(AdaptiveGarbageReleaser::NextThreshold(4 * kMin, stats, 100),
+            4 * kMin);
+
+  // Within kMinThreshold and FLAGS_adaptive_gc_max_memory_mb.
+  EXPECT_EQ(AdaptiveGarbageReleaser::NextThreshold(kMin, stats, 50), kMin);
+  stats.allocated_bytes = 100;
+  stats.cached_bytes = 0;
+  EXPECT_EQ(AdaptiveGarbageReleaser::NextThreshold(max, stats, 100), max);
+}
+
+TEST(AdaptiveGarbageReleaser, release) {
+  auto& releaser = AdaptiveGarbageReleaser::Instance();
+  EXPECT_GE(releaser.Threshold(), AdaptiveGarbageReleaser::kMinThreshold);
+  std::promise<std::thread::id> released;
+  releaser.Release(
+      [&released]() { released.set_value(std::this_thread::get_id()); });
+  EXPECT_NE(released.get_future().get(), std::this_thread::get_id());
+}
+
+TEST(CPUAdaptiveGarbageCollector, release_threshold) {
+  const size_t threshold = AdaptiveGarbageReleaser::Instance().Threshold();
+  CPUAdaptiveGarbageCollector gc{platform::CPUPlace()};
+
+  std::deque<std::shared_ptr<memory::Allocation>> garbages;
+  garbages.push_back(MakeGarbage(threshold / 2));
+  std::weak_ptr<memory::Allocation> first = garbages.front();
+  gc.Add(std::move(garbages));
+  WaitReleased();
+  EXPECT_FALSE(first.expired());
+
+  // The garbages reach the threshold and are freed together.
+  garbages.clear();
+  garbages.push_back(MakeGarbage(threshold / 2));
+  std::weak_ptr<memory::Allocation> second = garbages.front();
+  gc.Add(std::move(garbages));
+  WaitReleased();
+  EXPECT_TRUE(first.expired());
+  EXPECT_TRUE(second.expired());
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -14,8 +14,16 @@
 
 #include "paddle/fluid/framework/ir/cost_model.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/platform/errors.h"
 #include "paddle/fluid/platform/place.h"
@@ -41,6 +49,16 @@ double CostData::GetOpMemoryBytes(int op_id) const {
 double CostData::GetWholeTimeMs() const { return whole_time_ms_; }
 double CostData::GetWholeMemoryBytes() const { return whole_memory_bytes_; }
 
+void CostData::SetOpCost(int op_id, double time_ms, double memory_bytes) {
+  op_time_ms_[op_id] = time_ms;
+  op_memory_bytes_[op_id] = memory_bytes;
+}
+
+void CostData::SetWholeCost(double time_ms, double memory_bytes) {
+  whole_time_ms_ = time_ms;
+  whole_memory_bytes_ = memory_bytes;
+}
+
 const Graph* CostData::GetGraph() const { return graph_; }
 const ProgramDesc* CostData::GetProgram() const { return program_; }
 
@@ -265,5 +283,431 @@ CostData CostModel::ProfileMeasure(
   return cost_data;
 }
 
+static bool IsTensorVar(const VarDesc* var) {
+  return var != nullptr &&
+         (var->GetType() == proto::VarType::LOD_TENSOR ||
+          var->GetType() == proto::VarType::SELECTED_ROWS);
+}
+
+static std::vector<int64_t> GetVarShape(const BlockDesc& block,
+                                        const std::string& name) {
+  VarDesc* var = block.FindVarRecursive(name);
+  if (!IsTensorVar(var)) {
+    return {};
+  }
+  return var->GetShape();
+}
+
+static double GetNumel(const std::vector<int64_t>& shape) {
+  double numel = 1;
+  for (int64_t dim : shape) {
+    numel *= std::max<int64_t>(dim, 1);
+  }
+  return numel;
+}
+
+static double GetVarBytes(const BlockDesc& block, const std::string& name) {
+  VarDesc* var = block.FindVarRecursive(name);
+  if (!IsTensorVar(var)) {
+    return 0;
+  }
+  return GetNumel(var->GetShape()) * SizeOfType(var->GetDataType());
+}
+
+static std::vector<int64_t> GetInputShape(const OpDesc& op,
+                                          const BlockDesc& block,
+                                          const std::string& slot) {
+  auto it = op.Inputs().find(slot);
+  if (it == op.Inputs().end() || it->second.empty()) {
+    return {};
+  }
+  return GetVarShape(block, it->second[0]);
+}
+
+static double GetOutputNumel(const OpDesc& op, const BlockDesc& block) {
+  double numel = 0;
+  for (const auto& name : op.OutputArgumentNames()) {
+    VarDesc* var = block.FindVarRecursive(name);
+    if (IsTensorVar(var)) {
+      numel += GetNumel(var->GetShape());
+    }
+  }
+  return numel;
+}
+
+static double GetInputNumel(const OpDesc& op, const BlockDesc& block) {
+  double numel = 0;
+  for (const auto& name : op.InputArgumentNames()) {
+    VarDesc* var = block.FindVarRecursive(name);
+    if (IsTensorVar(var)) {
+      numel += GetNumel(var->GetShape());
+    }
+  }
+  return numel;
+}
+
+template <typename T>
+static T GetAttrOr(const OpDesc& op, const std::string& name, T value) {
+  return op.HasAttr(name) ? BOOST_GET_CONST(T, op.GetAttr(name)) : value;
+}
+
+using OpFlopsFunc = std::function<double(const OpDesc&, const BlockDesc&)>;
+
+// Returns flops = output numel * factor, for the element-wise ops
+static OpFlopsFunc ElementwiseFlops(double factor) {
+  return [factor](const OpDesc& op, const BlockDesc& block) {
+    return GetOutputNumel(op, block) * factor;
+  };
+}
+
+static double MatmulFlops(const OpDesc& op, const BlockDesc& block) {
+  std::vector<int64_t> x_shape = GetInputShape(op, block, "X");
+  if (x_shape.empty()) {
+    return GetOutputNumel(op, block);
+  }
+  bool trans_x = GetAttrOr<bool>(op, "transpose_X", false) ||
+                 GetAttrOr<bool>(op, "trans_x", false);
+  int64_t k = x_shape.back();
+  if (trans_x && x_shape.size() > 1) {
+    k = x_shape[x_shape.size() - 2];
+  }
+  return 2.0 * GetOutputNumel(op, block) * std::max<int64_t>(k, 1);
+}
+
+static double MulFlops(const OpDesc& op, const BlockDesc& block) {
+  std::vector<int64_t> y_shape = GetInputShape(op, block, "Y");
+  int y_num_col_dims = GetAttrOr<int>(op, "y_num_col_dims", 1);
+  y_shape.resize(std::min<size_t>(y_shape.size(), y_num_col_dims));
+  return 2.0 * GetOutputNumel(op, block) * GetNumel(y_shape);
+}
+
+static double FcFlops(const OpDesc& op, const BlockDesc& block) {
+  std::vector<int64_t> w_shape = GetInputShape(op, block, "W");
+  double k = w_shape.empty() ? 1 : std::max<int64_t>(w_shape[0], 1);
+  return 2.0 * GetOutputNumel(op, block) * k;
+}
+
+// Each output element of a convolution is a dot product of length
+// Cin / groups * kernel_size, which is filter numel / filter dims[0].
+static double ConvFlops(const OpDesc& op, const BlockDesc& block) {
+  std::vector<int64_t> filter_shape = GetInputShape(op, block, "Filter");
+  if (filter_shape.empty()) {
+    return GetOutputNumel(op, block);
+  }
+  double dot_size =
+      GetNumel(filter_shape) / std::max<int64_t>(filter_shape[0], 1);
+  return 2.0 * GetOutputNumel(op, block) * dot_size;
+}
+
+// Each input element of a transposed convolution is scattered to
+// Cout / groups * kernel_size outputs.
+static double ConvTransposeFlops(const OpDesc& op, const BlockDesc& block) {
+  std::vector<int64_t> filter_shape = GetInputShape(op, block, "Filter");
+  std::vector<int64_t> input_shape = GetInputShape(op, block, "Input");
+  if (filter_shape.empty() || input_shape.empty()) {
+    return GetOutputNumel(op, block);
+  }
+  double scatter_size =
+      GetNumel(filter_shape) / std::max<int64_t>(filter_shape[0], 1);
+  return 2.0 * GetNumel(input_shape) * scatter_size;
+}
+
+static double PoolFlops(const OpDesc& op, const BlockDesc& block) {
+  if (GetAttrOr<bool>(op, "global_pooling", false) ||
+      GetAttrOr<bool>(op, "adaptive", false)) {
+    return GetInputNumel(op, block);
+  }
+  std::vector<int> ksize = GetAttrOr<std::vector<int>>(op, "ksize", {});
+  double window = 1;
+  for (int k : ksize) {
+    window *= std::max(k, 1);
+  }
+  return GetOutputNumel(op, block) * window;
+}
+
+static double ReduceFlops(const OpDesc& op, const BlockDesc& block) {
+  return GetInputNumel(op, block);
+}
+
+static double ZeroFlops(const OpDesc& op, const BlockDesc& block) {
+  return 0;
+}
+
+static const std::unordered_map<std::string, OpFlopsFunc>& OpFlopsFuncs() {
+  static const std::unordered_map<std::string, OpFlopsFunc> funcs = {
+      {"mul", MulFlops},
+      {"matmul", MatmulFlops},
+      {"matmul_v2", MatmulFlops},
+      {"bmm", MatmulFlops},
+      {"fc", FcFlops},
+      {"conv2d", ConvFlops},
+      {"conv3d", ConvFlops},
+      {"depthwise_conv2d", ConvFlops},
+      {"conv2d_transpose", ConvTransposeFlops},
+      {"conv3d_transpose", ConvTransposeFlops},
+      {"depthwise_conv2d_transpose", ConvTransposeFlops},
+      {"pool2d", PoolFlops},
+      {"pool3d", PoolFlops},
+      {"reduce_sum", ReduceFlops},
+      {"reduce_mean", ReduceFlops},
+      {"reduce_max", ReduceFlops},
+      {"reduce_min", ReduceFlops},
+      {"mean", ReduceFlops},
+      {"sum", ReduceFlops},
+      {"softmax", ElementwiseFlops(5)},
+      {"log_softmax", ElementwiseFlops(5)},
+      {"softmax_with_cross_entropy", ElementwiseFlops(6)},
+      {"layer_norm", ElementwiseFlops(8)},
+      {"batch_norm", ElementwiseFlops(8)},
+      {"sigmoid", ElementwiseFlops(4)},
+      {"tanh", ElementwiseFlops(4)},
+      {"exp", ElementwiseFlops(4)},
+      {"gelu", ElementwiseFlops(8)},
+      {"swish", ElementwiseFlops(5)},
+      {"silu", ElementwiseFlops(5)},
+      // ops which only move data, their cost comes from the bytes
+      {"feed", ZeroFlops},
+      {"fetch", ZeroFlops},
+      {"reshape2", ZeroFlops},
+      {"squeeze2", ZeroFlops},
+      {"unsqueeze2", ZeroFlops},
+      {"flatten2", ZeroFlops},
+      {"flatten_contiguous_range", ZeroFlops},
+      {"transpose2", ZeroFlops},
+      {"concat", ZeroFlops},
+      {"split", ZeroFlops},
+      {"slice", ZeroFlops},
+      {"assign", ZeroFlops},
+      {"cast", ZeroFlops},
+  };
+  return funcs;
+}
+
+static double EstimateOpFlops(const OpDesc& op, const BlockDesc& block) {
+  const auto& funcs = OpFlopsFuncs();
+  auto it = funcs.find(op.Type());
+  if (it != funcs.end()) {
+    return it->second(op, block);
+  }
+  // The other ops are taken as one flop per output element
+  return GetOutputNumel(op, block);
+}
+
+// Computes c = a * b of n x n matrices and returns the best GFLOP/s
+static double BenchmarkGflops() {
+  const int n = 256;
+  std::vector<float> a(n * n, 1.0f);
+  std::vector<float> b(n * n, 0.5f);
+  std::vector<float> c(n * n);
+  double best_seconds = std::numeric_limits<double>::max();
+  for (int repeat = 0; repeat < 3; ++repeat) {
+    std::fill(c.begin(), c.end(), 0.0f);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+      for (int k = 0; k < n; ++k) {
+        float a_ik = a[i * n + k];
+        for (int j = 0; j < n; ++j) {
+          c[i * n + j] += a_ik * b[k * n + j];
+        }
+      }
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best_seconds = std::min(best_seconds, elapsed.count());
+  }
+  // keep the result alive so the loops are not optimized away
+  volatile float sink = c[n * n - 1];
+  (void)sink;
+  return 2.0 * n * n * n / std::max(best_seconds, 1e-9) / 1e9;
+}
+
+// Copies a buffer much larger than the last level cache and returns the best
+// GB/s, counting both the read and the write
+static double BenchmarkMemoryBandwidth() {
+  const size_t size = 64 << 20;
+  std::vector<char> src(size, 1);
+  std::vector<char> dst(size);
+  double best_seconds = std::numeric_limits<double>::max();
+  for (int repeat = 0; repeat < 3; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    std::memcpy(dst.data(), src.data(), size);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best_seconds = std::min(best_seconds, elapsed.count());
+  }
+  volatile char sink = dst[size - 1];
+  (void)sink;
+  return 2.0 * size / std::max(best_seconds, 1e-9) / 1e9;
+}
+
+static MachineProfile CalibrateCPUProfile() {
+  MachineProfile profile;
+  profile.gflops = BenchmarkGflops();
+  profile.memory_bandwidth_gbps = BenchmarkMemoryBandwidth();
+  // typical cost of the executor to prepare and dispatch one op
+  profile.op_overhead_ms = 0.005;
+  VLOG(3) << "Calibrated cpu for CostModel: " << profile.gflops
+          << " GFLOP/s, " << profile.memory_bandwidth_gbps << " GB/s";
+  return profile;
+}
+
+static std::mutex& MachineProfilesMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::map<std::string, MachineProfile>& MachineProfiles() {
+  static std::map<std::string, MachineProfile> profiles;
+  return profiles;
+}
+
+MachineProfile CostModel::GetMachineProfile(const std::string& device) {
+  std::string device_lower_case = ToLowerCopy(device);
+  std::lock_guard<std::mutex> guard(MachineProfilesMutex());
+  auto& profiles = MachineProfiles();
+  auto it = profiles.find(device_lower_case);
+  if (it != profiles.end()) {
+    return it->second;
+  }
+  PADDLE_ENFORCE_EQ(
+      device_lower_case, "cpu",
+      platform::errors::PreconditionNotMet(
+          "The MachineProfile of %s is not set, please call "
+          "CostModel::SetMachineProfile before estimating costs on it.",
+          device));
+  MachineProfile profile = CalibrateCPUProfile();
+  profiles[device_lower_case] = profile;
+  return profile;
+}
+
+void CostModel::SetMachineProfile(const std::string& device,
+                                  const MachineProfile& profile) {
+  PADDLE_ENFORCE_GT(profile.gflops, 0,
+                    platform::errors::InvalidArgument(
+                        "The gflops of MachineProfile must be positive."));
+  PADDLE_ENFORCE_GT(
+      profile.memory_bandwidth_gbps, 0,
+      platform::errors::InvalidArgument(
+          "The memory_bandwidth_gbps of MachineProfile must be positive."));
+  std::lock_guard<std::mutex> guard(MachineProfilesMutex());
+  MachineProfiles()[ToLowerCopy(device)] = profile;
+}
+
+CostData CostModel::StaticEstimate(const ProgramDesc& main_program,
+                                   const std::string& device,
+                                   int64_t batch_size) const {
+  std::string device_lower_case = ToLowerCopy(device);
+  if (device_lower_case != "cpu" && device_lower_case != "gpu") {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "Not support %s in CostModel now", device));
+  }
+  PADDLE_ENFORCE_GT(batch_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The batch_size of StaticEstimate must be positive, "
+                        "but got %d.",
+                        batch_size));
+  MachineProfile profile = GetMachineProfile(device_lower_case);
+
+  CostData cost_data;
+  if (main_program.Size() == 0 || main_program.Block(0).OpSize() == 0) {
+    cost_data.SetWholeCost(0, 0);
+    return cost_data;
+  }
+
+  // Work on a copy, InferShape writes the shapes back to the VarDescs
+  ProgramDesc program(main_program);
+  BlockDesc* block = program.MutableBlock(0);
+  for (VarDesc* var : block->AllVars()) {
+    if (!IsTensorVar(var)) {
+      continue;
+    }
+    std::vector<int64_t> shape = var->GetShape();
+    bool has_unknown_dim = false;
+    for (auto& dim : shape) {
+      if (dim < 0) {
+        dim = batch_size;
+        has_unknown_dim = true;
+      }
+    }
+    if (has_unknown_dim) {
+      var->SetShape(shape);
+    }
+  }
+
+  size_t op_size = block->OpSize();
+  double persistable_bytes = 0;
+  // first and last op which touches a non-persistable var
+  std::unordered_map<std::string, std::pair<size_t, size_t>> var_live_range;
+  double whole_time_ms = 0;
+  for (size_t i = 0; i < op_size; ++i) {
+    OpDesc* op = block->Op(i);
+    const OpInfo* op_info = OpInfoMap::Instance().GetNullable(op->Type());
+    if (op_info != nullptr && op_info->infer_shape_) {
+      try {
+        op->InferShape(*block);
+      } catch (platform::EnforceNotMet& e) {
+        VLOG(3) << "CostModel keeps the declared output shapes of "
+                << op->Type() << " since InferShape fails: " << e.what();
+      }
+    }
+
+    double bytes = 0;
+    for (const auto& name : op->InputArgumentNames()) {
+      bytes += GetVarBytes(*block, name);
+    }
+    double output_bytes = 0;
+    for (const auto& name : op->OutputArgumentNames()) {
+      double var_bytes = GetVarBytes(*block, name);
+      bytes += var_bytes;
+      VarDesc* var = block->FindVarRecursive(name);
+      if (var != nullptr && !var->Persistable()) {
+        output_bytes += var_bytes;
+      }
+    }
+    for (const auto& name : op->InputArgumentNames()) {
+      var_live_range.emplace(name, std::make_pair(i, i)).first->second.second =
+          i;
+    }
+    for (const auto& name : op->OutputArgumentNames()) {
+      var_live_range.emplace(name, std::make_pair(i, i)).first->second.second =
+          i;
+    }
+
+    double flops = EstimateOpFlops(*op, *block);
+    double compute_ms = flops / (profile.gflops * 1e6);
+    double memory_ms = bytes / (profile.memory_bandwidth_gbps * 1e6);
+    double time_ms = std::max(compute_ms, memory_ms) + profile.op_overhead_ms;
+    VLOG(4) << "CostModel estimates op " << i << " " << op->Type() << ": "
+            << flops << " flops, " << bytes << " bytes, " << time_ms << " ms";
+    cost_data.SetOpCost(i, time_ms, output_bytes);
+    whole_time_ms += time_ms;
+  }
+
+  // Peak memory of the tensors which are alive at the same op
+  std::vector<double> live_bytes_delta(op_size + 1, 0);
+  for (const auto& pair : var_live_range) {
+    VarDesc* var = block->FindVarRecursive(pair.first);
+    if (var == nullptr || var->Persistable()) {
+      continue;
+    }
+    double var_bytes = GetVarBytes(*block, pair.first);
+    live_bytes_delta[pair.second.first] += var_bytes;
+    live_bytes_delta[pair.second.second + 1] -= var_bytes;
+  }
+  for (VarDesc* var : block->AllVars()) {
+    if (var->Persistable()) {
+      persistable_bytes += GetVarBytes(*block, var->Name());
+    }
+  }
+  double live_bytes = 0;
+  double peak_live_bytes = 0;
+  for (size_t i = 0; i < op_size; ++i) {
+    live_bytes += live_bytes_delta[i];
+    peak_live_bytes = std::max(peak_live_bytes, live_bytes);
+  }
+  cost_data.SetWholeCost(whole_time_ms, persistable_bytes + peak_live_bytes);
+  return cost_data;
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -54,6 +54,10 @@ class CostData {
       const ProgramDesc& program,
       const std::vector<std::vector<platform::Event>>& time_events);
 
+  // Used by CostModel::StaticEstimate to fill the estimated costs
+  void SetOpCost(int op_id, double time_ms, double memory_bytes);
+  void SetWholeCost(double time_ms, double memory_bytes);
+
   static const double NOT_MEASURED;
 
  private:
@@ -71,6 +75,13 @@ class CostData {
       NOT_MEASURED};  // communication cost of the whole program or graph
 };
 
+// Throughput of a device, used to turn the FLOPs and bytes of an op into time
+struct MachineProfile {
+  double gflops{0};                 // sustained compute, GFLOP/s
+  double memory_bandwidth_gbps{0};  // sustained memory bandwidth, GB/s
+  double op_overhead_ms{0};         // fixed dispatch cost of each op
+};
+
 class CostModel {
  public:
   CostModel() {}
@@ -80,6 +91,25 @@ class CostModel {
       const ProgramDesc& main_program, const ProgramDesc& startup_program,
       const std::string& device,
       const std::vector<std::string>& fetch_cost_list) const;
+
+  // Predicts the cost of the global block of main_program without running
+  // it. Shapes come from the compile-time InferShape of each op, with the
+  // unknown (-1) dims replaced by batch_size. The time of an op is
+  //   max(flops / gflops, bytes / memory_bandwidth) + op_overhead_ms
+  // where flops comes from a per op type formula and bytes is the size of
+  // its inputs and outputs. The memory of an op is the size of its
+  // non-persistable outputs, and the whole memory is the persistable size
+  // plus the peak size of the live non-persistable tensors.
+  CostData StaticEstimate(const ProgramDesc& main_program,
+                          const std::string& device,
+                          int64_t batch_size = 1) const;
+
+  // The profile of "cpu" is calibrated by a micro-benchmark of the local
+  // machine the first time it is needed, other devices must be set by
+  // SetMachineProfile before StaticEstimate.
+  static MachineProfile GetMachineProfile(const std::string& device);
+  static void SetMachineProfile(const std::string& device,
+                                const MachineProfile& profile);
 };
 
 }  // namespace framework
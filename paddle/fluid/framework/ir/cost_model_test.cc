@@ -205,5 +205,85 @@ TEST(CostDataTest, TestNoWholeEvent) {
   EXPECT_EQ(cost_data.SetCostData(program, time_events), false);
 }
 
+TEST(CostModelTest, TestCalibrateMachineProfile) {
+  MachineProfile profile = CostModel::GetMachineProfile("cpu");
+  EXPECT_GT(profile.gflops, 0);
+  EXPECT_GT(profile.memory_bandwidth_gbps, 0);
+}
+
+ProgramDesc CreateStaticEstimateProgram() {
+  // create a ProgramDesc:
+  //   Z = mul(X, Y)
+  //   Out = relu(Z)
+  // where X has an unknown batch dim and Y is persistable
+  ProgramDesc program;
+  auto *global_block = program.MutableBlock(0);
+  auto add_var = [global_block](const std::string &name,
+                                const std::vector<int64_t> &shape) {
+    auto *var = global_block->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetShape(shape);
+    return var;
+  };
+  add_var("X", {-1, 784});
+  add_var("Y", {784, 100})->SetPersistable(true);
+  add_var("Z", {-1, 100});
+  add_var("Out", {-1, 100});
+
+  auto *op0 = global_block->AppendOp();
+  op0->SetType("mul");
+  op0->SetInput("X", {"X"});
+  op0->SetInput("Y", {"Y"});
+  op0->SetOutput("Out", {"Z"});
+
+  auto *op1 = global_block->AppendOp();
+  op1->SetType("relu");
+  op1->SetInput("X", {"Z"});
+  op1->SetOutput("Out", {"Out"});
+  return program;
+}
+
+TEST(CostModelTest, TestStaticEstimate_Program) {
+  MachineProfile profile;
+  profile.gflops = 1;
+  profile.memory_bandwidth_gbps = 1;
+  profile.op_overhead_ms = 0;
+  CostModel cost_model;
+  ProgramDesc program = CreateStaticEstimateProgram();
+
+  // The gpu is not calibrated automatically
+  EXPECT_THROW(cost_model.StaticEstimate(program, "gpu", 10),
+               paddle::platform::EnforceNotMet);
+  // The profiles are global, so the calibrated one is restored at the end.
+  MachineProfile calibrated = CostModel::GetMachineProfile("cpu");
+  CostModel::SetMachineProfile("cpu", profile);
+  CostData cost_data = cost_model.StaticEstimate(program, "cpu", 10);
+
+  // mul is compute bound: 2 * 10 * 784 * 100 flops at 1 GFLOP/s
+  EXPECT_NEAR(cost_data.GetOpTimeMs(0), 1.568, 1e-6);
+  // relu is memory bound: 2 * 10 * 100 floats at 1 GB/s
+  EXPECT_NEAR(cost_data.GetOpTimeMs(1), 0.008, 1e-6);
+  EXPECT_NEAR(cost_data.GetWholeTimeMs(), 1.576, 1e-6);
+  EXPECT_EQ(cost_data.GetOpMemoryBytes(0), 10 * 100 * 4);
+  // persistable Y, plus X and Z which are alive at mul
+  EXPECT_EQ(cost_data.GetWholeMemoryBytes(),
+            784 * 100 * 4 + 10 * 784 * 4 + 10 * 100 * 4);
+
+  CostData larger_batch = cost_model.StaticEstimate(program, "cpu", 20);
+  EXPECT_GT(larger_batch.GetWholeTimeMs(), cost_data.GetWholeTimeMs());
+  EXPECT_GT(larger_batch.GetWholeMemoryBytes(),
+            cost_data.GetWholeMemoryBytes());
+  CostModel::SetMachineProfile("cpu", calibrated);
+}
+
+TEST(CostModelTest, TestStaticEstimate_EmptyProgram) {
+  CostModel cost_model;
+  ProgramDesc empty_program;
+  CostData cost_data = cost_model.StaticEstimate(empty_program, "cpu");
+  EXPECT_EQ(cost_data.GetWholeTimeMs(), 0);
+  EXPECT_EQ(cost_data.GetWholeMemoryBytes(), 0);
+}
+
 }  // namespace framework
 }  // namespace paddle
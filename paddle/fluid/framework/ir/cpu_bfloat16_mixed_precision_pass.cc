@@ -0,0 +1,208 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_bfloat16_mixed_precision_pass.h"
+
+#include <algorithm>
+
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+bool IsFloatTensor(Node* var) {
+  return var->IsVar() && !var->IsCtrlVar() && var->Var() &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         var->Var()->GetDataType() == proto::VarType::FP32;
+}
+
+bool IsFetched(Node* var) {
+  return std::any_of(var->outputs.begin(), var->outputs.end(), [](Node* op) {
+    return op->IsOp() && op->Op()->Type() == "fetch";
+  });
+}
+
+// Inserts the op casting in to out, from and to the dtypes of their descs.
+void InsertCast(Graph* graph, Node* in, Node* out) {
+  OpDesc desc;
+  desc.SetType("cast");
+  desc.SetInput("X", {in->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetAttr("in_dtype", static_cast<int>(in->Var()->GetDataType()));
+  desc.SetAttr("out_dtype", static_cast<int>(out->Var()->GetDataType()));
+  desc.SetAttr("use_mkldnn", false);
+  desc.SetAttr("with_quant_attr", false);
+  desc.Flush();
+  auto* cast = graph->CreateOpNode(&desc);
+
+  IR_NODE_LINK_TO(in, cast);
+  IR_NODE_LINK_TO(cast, out);
+}
+
+}  // namespace
+
+bool CpuBfloat16MixedPrecisionPass::CanConvertWeight(
+    Node* var, const StringSet& enabled_ops) const {
+  if (!var->inputs.empty()) return false;
+  for (auto* op : var->outputs) {
+    if (!op->IsOp() || !enabled_ops.count(op->Op()->Type())) return false;
+  }
+  auto* scope_var = param_scope()->FindVar(var->Name());
+  if (scope_var == nullptr || !scope_var->IsType<LoDTensor>()) return false;
+  const auto& tensor = scope_var->Get<LoDTensor>();
+  return tensor.IsInitialized() && platform::is_cpu_place(tensor.place()) &&
+         tensor.dtype() == phi::DataType::FLOAT32;
+}
+
+void CpuBfloat16MixedPrecisionPass::ConvertWeight(Node* var) const {
+  auto* tensor = param_scope()->FindVar(var->Name())->GetMutable<LoDTensor>();
+  Tensor bf16_tensor;
+  bf16_tensor.Resize(tensor->dims());
+  auto* bf16_data =
+      bf16_tensor.mutable_data<platform::bfloat16>(platform::CPUPlace());
+  phi::funcs::ConvertFromFloat(tensor->data<float>(), tensor->numel(),
+                               bf16_data);
+  tensor->clear();
+  TensorCopySync(bf16_tensor, platform::CPUPlace(), tensor);
+  var->Var()->SetDataType(proto::VarType::BF16);
+}
+
+Node* CpuBfloat16MixedPrecisionPass::CastVar(
+    Graph* graph, Node* var, proto::VarType::Type out_dtype,
+    std::unordered_map<Node*, Node*>* casts) const {
+  auto it = casts->find(var);
+  if (it != casts->end()) return it->second;
+
+  std::string name =
+      var->Name() +
+      (out_dtype == proto::VarType::BF16 ? "_bf16_cast.tmp" : "_fp32_cast.tmp");
+  VarDesc out_desc(name);
+  out_desc.SetShape(var->Var()->GetShape());
+  out_desc.SetDataType(out_dtype);
+  out_desc.SetPersistable(false);
+  auto* out = graph->CreateVarNode(&out_desc);
+  InsertCast(graph, var, out);
+  (*casts)[var] = out;
+  return out;
+}
+
+Node* CpuBfloat16MixedPrecisionPass::RenameOutput(
+    Graph* graph, Node* op, Node* var, const StringSet& enabled_ops) const {
+  VarDesc bf16_desc(var->Name() + "_bf16.tmp");
+  bf16_desc.SetShape(var->Var()->GetShape());
+  bf16_desc.SetDataType(proto::VarType::BF16);
+  bf16_desc.SetPersistable(false);
+  auto* bf16_var = graph->CreateVarNode(&bf16_desc);
+
+  op->Op()->RenameOutput(var->Name(), bf16_var->Name());
+  std::replace(op->outputs.begin(), op->outputs.end(), var, bf16_var);
+  var->inputs.erase(std::remove(var->inputs.begin(), var->inputs.end(), op),
+                    var->inputs.end());
+  bf16_var->inputs.push_back(op);
+
+  auto readers = var->outputs;
+  for (auto* reader : readers) {
+    if (reader->IsOp() && enabled_ops.count(reader->Op()->Type())) {
+      ReplaceInput(reader, var, bf16_var);
+    }
+  }
+  InsertCast(graph, bf16_var, var);
+  return bf16_var;
+}
+
+void CpuBfloat16MixedPrecisionPass::ReplaceInput(Node* op, Node* var,
+                                                 Node* new_var) const {
+  // The ops reading var twice are replaced at once.
+  if (std::find(op->inputs.begin(), op->inputs.end(), var) ==
+      op->inputs.end()) {
+    return;
+  }
+  op->Op()->RenameInput(var->Name(), new_var->Name());
+  var->outputs.erase(
+      std::remove(var->outputs.begin(), var->outputs.end(), op),
+      var->outputs.end());
+  std::replace(op->inputs.begin(), op->inputs.end(), var, new_var);
+  new_var->outputs.push_back(op);
+}
+
+void CpuBfloat16MixedPrecisionPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init(name_scope_, graph);
+  const auto& enabled_ops = Get<StringSet>("cpu_bfloat16_enabled_op_types");
+
+  // The bfloat16 and float casts of the vars, shared by their readers.
+  std::unordered_map<Node*, Node*> bf16_casts;
+  std::unordered_map<Node*, Node*> fp32_casts;
+  int bf16_ops = 0;
+  int fetched_casts = 0;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (!enabled_ops.count(op->Op()->Type())) continue;
+    // The ops writing the weights keep float.
+    if (std::any_of(op->outputs.begin(), op->outputs.end(), [](Node* var) {
+          return IsFloatTensor(var) && var->Var()->Persistable();
+        })) {
+      continue;
+    }
+
+    auto inputs = op->inputs;
+    for (auto* var : inputs) {
+      if (!IsFloatTensor(var)) continue;
+      if (var->Var()->Persistable() && CanConvertWeight(var, enabled_ops)) {
+        ConvertWeight(var);
+      } else {
+        ReplaceInput(
+            op, var, CastVar(graph, var, proto::VarType::BF16, &bf16_casts));
+      }
+    }
+    auto outputs = op->outputs;
+    for (auto* var : outputs) {
+      if (!IsFloatTensor(var)) continue;
+      // The fetched outputs keep their names and float, the cast writing
+      // them, so that the output handles of the predictor find them.
+      if (IsFetched(var)) {
+        RenameOutput(graph, op, var, enabled_ops);
+        ++fetched_casts;
+        continue;
+      }
+      var->Var()->SetDataType(proto::VarType::BF16);
+      auto readers = var->outputs;
+      for (auto* reader : readers) {
+        if (reader->IsOp() && !enabled_ops.count(reader->Op()->Type())) {
+          ReplaceInput(reader, var,
+                       CastVar(graph, var, proto::VarType::FP32, &fp32_casts));
+        }
+      }
+    }
+    ++bf16_ops;
+  }
+  AddStatis(bf16_ops);
+  VLOG(3) << "Ran " << bf16_ops << " ops in bfloat16, inserting "
+          << bf16_casts.size() + fp32_casts.size() + fetched_casts
+          << " cast ops.";
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(cpu_bfloat16_mixed_precision_pass,
+              paddle::framework::ir::CpuBfloat16MixedPrecisionPass)
+    .RequirePassAttr("cpu_bfloat16_enabled_op_types");
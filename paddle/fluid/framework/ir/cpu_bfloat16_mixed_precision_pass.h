@@ -0,0 +1,70 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Runs the ops of "cpu_bfloat16_enabled_op_types" on the bfloat16 kernels
+ * of phi, which compute in float on the AVX512-BF16 instructions. The float
+ * weights only these ops read are converted to bfloat16 in the scope, and
+ * cast ops are inserted on the other float inputs of the ops, and before
+ * the ops reading their outputs in float. The fetched outputs keep their
+ * names, written in float by a cast of the bfloat16 output of the ops.
+ */
+class CpuBfloat16MixedPrecisionPass : public FusePassBase {
+ public:
+  virtual ~CpuBfloat16MixedPrecisionPass() {}
+
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  using StringSet = std::unordered_set<std::string>;
+
+  // Whether the weight var can be stored as bfloat16, all its readers being
+  // in enabled_ops.
+  bool CanConvertWeight(Node* var, const StringSet& enabled_ops) const;
+  void ConvertWeight(Node* var) const;
+
+  // Returns the var holding var cast to out_dtype, inserting the cast op
+  // after var unless casts already holds it.
+  Node* CastVar(Graph* graph,
+                Node* var,
+                proto::VarType::Type out_dtype,
+                std::unordered_map<Node*, Node*>* casts) const;
+  // Makes op write the bfloat16 var returned in place of the float var,
+  // which a cast from it writes, and the enabled readers of var read it.
+  Node* RenameOutput(Graph* graph,
+                     Node* op,
+                     Node* var,
+                     const StringSet& enabled_ops) const;
+  // Makes op read new_var in place of var.
+  void ReplaceInput(Node* op, Node* var, Node* new_var) const;
+
+  const std::string name_scope_{"cpu_bfloat16_mixed_precision_pass"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,157 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_bfloat16_mixed_precision_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void AddVarToScope(Scope* param_scope, const std::string& name,
+                   const DDim& dims) {
+  auto* tensor = param_scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(dims);
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = 0.1f * static_cast<float>(i) - 1.f;
+  }
+}
+
+Node* GetVarNode(const std::unique_ptr<Graph>& graph,
+                 const std::string& name) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+TEST(CpuBfloat16MixedPrecisionPass, basic) {
+  // inputs                     operator            output
+  // --------------------------------------------------------
+  // (x, w)                     matmul_v2        -> matmul_out
+  // matmul_out                 softmax          -> softmax_out
+  // softmax_out                relu             -> relu_out
+  // (relu_out, b)              elementwise_add  -> add_out
+  // b                          relu             -> b_relu_out
+  Layers layers;
+  auto* x = layers.data("x", {2, 4});
+  auto* w = layers.data("w", {4, 8}, true);
+  auto* b = layers.data("b", {8}, true);
+  auto* matmul_out = layers.matmul_v2(x, w);
+  auto* softmax_out = layers.softmax(matmul_out, -1);
+  auto* relu_out = layers.relu(softmax_out);
+  auto* add_out = layers.elementwise_add(relu_out, b);
+  layers.relu(b);
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  Scope scope;
+  AddVarToScope(&scope, "w", {4, 8});
+  AddVarToScope(&scope, "b", {8});
+  graph->SetNotOwned("__param_scope__", &scope);
+  auto pass =
+      PassRegistry::Instance().Get("cpu_bfloat16_mixed_precision_pass");
+  pass->Set("cpu_bfloat16_enabled_op_types",
+            new std::unordered_set<std::string>(
+                {"matmul_v2", "softmax", "elementwise_add"}));
+  graph.reset(pass->Apply(graph.release()));
+
+  // Casts of x to bfloat16, of softmax_out to float for relu, and of
+  // relu_out and of b, which relu also reads, to bfloat16.
+  EXPECT_EQ(GetNumOpNodes(graph, "cast"), 4);
+  for (auto* name : {matmul_out, softmax_out, add_out}) {
+    EXPECT_EQ(GetVarNode(graph, name->Name())->Var()->GetDataType(),
+              proto::VarType::BF16);
+  }
+  EXPECT_EQ(GetVarNode(graph, relu_out->Name())->Var()->GetDataType(),
+            proto::VarType::FP32);
+  EXPECT_EQ(GetVarNode(graph, "b")->Var()->GetDataType(),
+            proto::VarType::FP32);
+  EXPECT_EQ(scope.FindVar("b")->Get<LoDTensor>().dtype(),
+            phi::DataType::FLOAT32);
+
+  // w, which only matmul_v2 reads, is stored in bfloat16.
+  EXPECT_EQ(GetVarNode(graph, "w")->Var()->GetDataType(),
+            proto::VarType::BF16);
+  const auto& w_tensor = scope.FindVar("w")->Get<LoDTensor>();
+  ASSERT_EQ(w_tensor.dtype(), phi::DataType::BFLOAT16);
+  ASSERT_EQ(w_tensor.numel(), 32);
+  for (int64_t i = 0; i < w_tensor.numel(); ++i) {
+    float value = 0.1f * static_cast<float>(i) - 1.f;
+    platform::bfloat16 expected;
+    phi::funcs::ConvertFromFloat(&value, 1, &expected);
+    EXPECT_EQ(w_tensor.data<platform::bfloat16>()[i].x, expected.x);
+  }
+}
+
+TEST(CpuBfloat16MixedPrecisionPass, fetch_target) {
+  // inputs                     operator            output
+  // --------------------------------------------------------
+  // (x, w)                     matmul_v2        -> matmul_out
+  // matmul_out                 softmax          -> softmax_out
+  // matmul_out                 relu             -> relu_out
+  // matmul_out                 fetch            -> fetch
+  Layers layers;
+  auto* x = layers.data("x", {2, 4});
+  auto* w = layers.data("w", {4, 8}, true);
+  auto* matmul_out = layers.matmul_v2(x, w);
+  layers.softmax(matmul_out, -1);
+  layers.relu(matmul_out);
+  layers.fetch(matmul_out, 0);
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  Scope scope;
+  AddVarToScope(&scope, "w", {4, 8});
+  graph->SetNotOwned("__param_scope__", &scope);
+  auto pass =
+      PassRegistry::Instance().Get("cpu_bfloat16_mixed_precision_pass");
+  pass->Set("cpu_bfloat16_enabled_op_types",
+            new std::unordered_set<std::string>({"matmul_v2", "softmax"}));
+  graph.reset(pass->Apply(graph.release()));
+
+  // Casts of x to bfloat16, and of the bfloat16 output of matmul_v2 to the
+  // fetched matmul_out, which relu also reads.
+  EXPECT_EQ(GetNumOpNodes(graph, "cast"), 2);
+  auto* fetched = GetVarNode(graph, matmul_out->Name());
+  ASSERT_NE(fetched, nullptr);
+  EXPECT_EQ(fetched->Var()->GetDataType(), proto::VarType::FP32);
+  ASSERT_EQ(fetched->inputs.size(), 1UL);
+  EXPECT_EQ(fetched->inputs[0]->Op()->Type(), "cast");
+  ASSERT_EQ(fetched->outputs.size(), 2UL);
+  for (auto* reader : fetched->outputs) {
+    EXPECT_TRUE(reader->Op()->Type() == "fetch" ||
+                reader->Op()->Type() == "relu");
+  }
+
+  auto* bf16_out = GetVarNode(graph, matmul_out->Name() + "_bf16.tmp");
+  ASSERT_NE(bf16_out, nullptr);
+  EXPECT_EQ(bf16_out->Var()->GetDataType(), proto::VarType::BF16);
+  ASSERT_EQ(bf16_out->inputs.size(), 1UL);
+  EXPECT_EQ(bf16_out->inputs[0]->Op()->Type(), "matmul_v2");
+  EXPECT_EQ(bf16_out->inputs[0]->Op()->Output("Out")[0], bf16_out->Name());
+  ASSERT_EQ(bf16_out->outputs.size(), 2UL);
+  for (auto* reader : bf16_out->outputs) {
+    EXPECT_TRUE(reader->Op()->Type() == "softmax" ||
+                reader->Op()->Type() == "cast");
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(cpu_bfloat16_mixed_precision_pass);
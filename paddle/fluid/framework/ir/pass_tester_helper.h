@@ -409,6 +409,16 @@ struct Layers {
     return out;
   }
 
+  void fetch(VarDesc* x, int col) {
+    VarDesc* out = program_.MutableBlock(0)->Var("fetch");
+    out->SetType(proto::VarType::FETCH_LIST);
+    OpDesc* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType("fetch");
+    op->SetInput("X", {x->Name()});
+    op->SetOutput("Out", {out->Name()});
+    op->SetAttr("col", col);
+  }
+
   void backward(std::vector<VarDesc*> targets) {
     // This function is designed to simulate the structure of training program,
     //  but is constructed differently as the actual program.
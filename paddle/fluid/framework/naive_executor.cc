@@ -13,9 +13,14 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/naive_executor.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
 #include <string>
+#include <unordered_set>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/denormal.h"
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle/fluid/platform/mkldnn_helper.h"
@@ -44,12 +49,356 @@ void NaiveExecutor::Run() {
   platform::RegisterModelLayout(ops_, place_);
 #endif
   platform::ScopedFlushDenormal flush;
+  if (workspace_enabled_) {
+    BindWorkspace();
+  }
+  if (shape_cache_capacity_ > 0) {
+    RunWithShapeCache();
+  } else {
+    for (auto &op : ops_) {
+      RunOp(op.get());
+    }
+  }
+  if (workspace_enabled_) {
+    UpdateWorkspace();
+  }
+}
+
+void NaiveExecutor::RunOp(OperatorBase *op) {
+  VLOG(4) << std::this_thread::get_id() << " run "
+          << op->DebugStringEx(scope_) << " on scope " << scope_;
+  op->SetIsCalledByExecutor(false);
+  for (auto &func : input_hookfuncs_) {
+    func(op, scope_);
+  }
+  op->Run(*scope_, place_);
+  for (auto &func : output_hookfuncs_) {
+    func(op, scope_);
+  }
+}
+
+void NaiveExecutor::RegisterInputHook(const HookFunc &hookfunc) {
+  input_hookfuncs_.push_back(hookfunc);
+}
+
+void NaiveExecutor::RegisterOutputHook(const HookFunc &hookfunc) {
+  output_hookfuncs_.push_back(hookfunc);
+}
+
+void NaiveExecutor::EnableShapeCache(
+    const std::vector<std::string> &input_names, size_t capacity) {
+  shape_cache_inputs_ = input_names;
+  shape_cache_capacity_ = capacity;
+  ResetShapeCache();
+}
+
+// Whether InferShape of the op may read the values of an input, so that its
+// output shapes do not only depend on its input shapes. Inputs like
+// ShapeTensor, StartsTensorList, expand_shapes_tensor or the Shape of
+// reshape2 carry attributes, whose values InferShape reads.
+static bool InferShapeReadsValues(const OperatorBase &op) {
+  static const std::unordered_set<std::string> kValueInputs = {
+      "Shape", "OutSize", "OutputShape", "K"};
+  bool is_interp = op.Type().find("interp") != std::string::npos;
+  for (auto &input : op.Inputs()) {
+    if (input.second.empty()) continue;
+    std::string name = input.first;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name.find("tensor") != std::string::npos ||
+        kValueInputs.count(input.first) ||
+        (is_interp && input.first == "Scale")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the kernel of the op, rather than InferShape, sets the dims or LoD
+// of its outputs from the values of its inputs, e.g. the number of selected
+// elements or boxes, or the iterations of a loop.
+static bool HasValueDependentOutputs(const OperatorBase &op) {
+  static const std::unordered_set<std::string> kOps = {
+      "where_index",
+      "unique",
+      "unique_with_counts",
+      "unique_consecutive",
+      "masked_select",
+      "multiclass_nms",
+      "multiclass_nms2",
+      "multiclass_nms3",
+      "matrix_nms",
+      "locality_aware_nms",
+      "retinanet_detection_output",
+      "generate_proposals",
+      "generate_proposals_v2",
+      "distribute_fpn_proposals",
+      "collect_fpn_proposals",
+      "range",
+      "linspace",
+      "segment_pool",
+      "bincount",
+      "lod_reset",
+      "sequence_erase",
+      "sequence_mask",
+      "sequence_unpad",
+      "ctc_align",
+      "conditional_block",
+      "while",
+      "recurrent"};
+  return kOps.count(op.Type()) > 0;
+}
+
+void NaiveExecutor::ResetShapeCache() {
+  shape_cache_.clear();
+  shape_cache_index_.clear();
+  shape_cached_ops_.clear();
+  // The outputs whose dims are not determined by the cache signature. The
+  // ops reading them must run InferShape as well.
+  std::unordered_set<std::string> dynamic_vars;
   for (auto &op : ops_) {
-    VLOG(4) << std::this_thread::get_id() << " run "
-            << op->DebugStringEx(scope_) << " on scope " << scope_;
-    op->SetIsCalledByExecutor(false);
-    op->Run(*scope_, place_);
+    bool dynamic = HasValueDependentOutputs(*op);
+    for (auto &input : op->Inputs()) {
+      for (auto &name : input.second) {
+        dynamic = dynamic || dynamic_vars.count(name) > 0;
+      }
+    }
+    if (dynamic) {
+      for (auto &output : op->Outputs()) {
+        dynamic_vars.insert(output.second.begin(), output.second.end());
+      }
+    }
+    auto *kernel_op = dynamic_cast<const OperatorWithKernel *>(op.get());
+    if (dynamic || InferShapeReadsValues(*op)) {
+      kernel_op = nullptr;
+    }
+    shape_cached_ops_.push_back(kernel_op);
+  }
+}
+
+static void AppendToSignature(int64_t value, std::string *signature) {
+  signature->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+std::string NaiveExecutor::ShapeSignature() const {
+  std::string signature;
+  for (auto &name : shape_cache_inputs_) {
+    auto *var = scope_->FindVar(name);
+    if (var == nullptr || !var->IsType<LoDTensor>()) {
+      AppendToSignature(-1, &signature);
+      continue;
+    }
+    auto &tensor = var->Get<LoDTensor>();
+    auto &dims = tensor.dims();
+    AppendToSignature(dims.size(), &signature);
+    for (int i = 0; i < dims.size(); ++i) {
+      AppendToSignature(dims[i], &signature);
+    }
+    AppendToSignature(tensor.lod().size(), &signature);
+    for (auto &level : tensor.lod()) {
+      AppendToSignature(level.size(), &signature);
+      for (auto offset : level) {
+        AppendToSignature(offset, &signature);
+      }
+    }
+  }
+  return signature;
+}
+
+void NaiveExecutor::RunWithShapeCache() {
+  auto signature = ShapeSignature();
+  auto it = shape_cache_index_.find(signature);
+  if (it != shape_cache_index_.end()) {
+    ++shape_cache_hits_;
+    shape_cache_.splice(shape_cache_.begin(), shape_cache_, it->second);
+    auto &shapes = it->second->second;
+    for (size_t i = 0; i < ops_.size(); ++i) {
+      if (shape_cached_ops_[i]) {
+        for (auto &shape : shapes[i]) {
+          shape.tensor->Resize(shape.dims);
+          shape.tensor->set_lod(shape.lod);
+        }
+        shape_cached_ops_[i]->SetSkipInferShape(true);
+      }
+      RunOp(ops_[i].get());
+    }
+    return;
+  }
+
+  ++shape_cache_misses_;
+  OutputShapes shapes(ops_.size());
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    if (shape_cached_ops_[i]) {
+      shape_cached_ops_[i]->SetSkipInferShape(false);
+    }
+    RunOp(ops_[i].get());
+    if (!shape_cached_ops_[i]) {
+      continue;
+    }
+    for (auto &output : ops_[i]->Outputs()) {
+      for (auto &name : output.second) {
+        auto *var = scope_->FindVar(name);
+        if (var && var->IsType<LoDTensor>()) {
+          auto *tensor = var->GetMutable<LoDTensor>();
+          shapes[i].push_back({tensor, tensor->dims(), tensor->lod()});
+        }
+      }
+    }
+  }
+  shape_cache_.emplace_front(signature, std::move(shapes));
+  shape_cache_index_[signature] = shape_cache_.begin();
+  if (shape_cache_.size() > shape_cache_capacity_) {
+    shape_cache_index_.erase(shape_cache_.back().first);
+    shape_cache_.pop_back();
+  }
+  VLOG(3) << "Shape cache miss, " << shape_cache_.size() << " signatures "
+          << "cached, " << shape_cache_hits_ << " hits and "
+          << shape_cache_misses_ << " misses so far.";
+}
+
+namespace {
+
+// A place in the workspace, which keeps the workspace alive.
+class WorkspaceSlot : public phi::Allocation {
+ public:
+  WorkspaceSlot(std::shared_ptr<phi::Allocation> workspace, size_t offset,
+                size_t size)
+      : phi::Allocation(static_cast<uint8_t *>(workspace->ptr()) + offset,
+                        size, workspace->place()),
+        workspace_(std::move(workspace)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> workspace_;
+};
+
+}  // namespace
+
+void NaiveExecutor::EnableWorkspace(
+    const std::vector<std::string> &output_names) {
+  workspace_enabled_ = true;
+  workspace_outputs_ = output_names;
+  ResetWorkspace();
+}
+
+// Collects the tensors of the local scope which are written before they are
+// read, and are not used by the operators sharing or keeping their memory.
+void NaiveExecutor::ResetWorkspace() {
+  workspace_tensors_.clear();
+  workspace_.reset();
+  workspace_size_ = 0;
+  workspace_naive_size_ = 0;
+
+  const int num_ops = static_cast<int>(ops_.size());
+  std::map<std::string, TensorUsage> usages;
+  std::unordered_map<std::string, int> last_writes;
+  std::unordered_set<std::string> excluded;
+  for (int i = 0; i < num_ops; ++i) {
+    bool unsafe = IsMemoryReuseUnsafeOp(ops_[i]->Type());
+    for (auto &input : ops_[i]->Inputs()) {
+      for (auto &name : input.second) {
+        auto it = usages.find(name);
+        if (unsafe || it == usages.end()) {
+          excluded.insert(name);
+        } else {
+          it->second.last = i;
+        }
+      }
+    }
+    for (auto &output : ops_[i]->Outputs()) {
+      for (auto &name : output.second) {
+        if (unsafe) {
+          excluded.insert(name);
+        }
+        usages.emplace(name, TensorUsage{0, i, i}).first->second.last = i;
+        last_writes[name] = i;
+      }
+    }
+  }
+  for (auto &name : workspace_outputs_) {
+    last_writes[name] = -1;
+  }
+
+  for (auto &item : usages) {
+    if (excluded.count(item.first)) {
+      continue;
+    }
+    auto *var = scope_->FindLocalVar(item.first);
+    if (var == nullptr || !var->IsType<LoDTensor>()) {
+      continue;
+    }
+    TensorUsage usage = item.second;
+    // A tensor written last may be read after Run.
+    if (last_writes[item.first] == usage.last ||
+        last_writes[item.first] < 0) {
+      usage.last = num_ops;
+    }
+    workspace_tensors_.push_back(
+        {var->GetMutable<LoDTensor>(), usage, nullptr});
+  }
+  VLOG(3) << "NaiveExecutor places " << workspace_tensors_.size()
+          << " tensors in the workspace.";
+}
+
+void NaiveExecutor::BindWorkspace() {
+  for (auto &item : workspace_tensors_) {
+    if (item.slot && item.tensor->Holder() != item.slot) {
+      item.tensor->clear();
+      item.tensor->ResetHolder(item.slot);
+    }
+  }
+}
+
+void NaiveExecutor::UpdateWorkspace() {
+  bool replan = false;
+  for (auto it = workspace_tensors_.begin(); it != workspace_tensors_.end();) {
+    auto &holder = it->tensor->Holder();
+    bool placed = it->slot && holder == it->slot;
+    // The memory of the tensor is shared with another one, e.g. by reshape,
+    // so it can not be moved into the workspace.
+    if (holder && holder.use_count() > (placed ? 2 : 1)) {
+      VLOG(3) << "The memory of a tensor is shared, remove it from the "
+                 "workspace.";
+      it = workspace_tensors_.erase(it);
+      replan = true;
+      continue;
+    }
+    if (holder && !placed) {
+      replan = true;
+    }
+    if (holder) {
+      size_t size = it->tensor->numel() *
+                    paddle::experimental::SizeOf(it->tensor->dtype());
+      it->usage.size = std::max(it->usage.size, size);
+    }
+    ++it;
+  }
+  if (!replan) {
+    return;
+  }
+
+  std::vector<TensorUsage> usages;
+  for (auto &item : workspace_tensors_) {
+    usages.push_back(item.usage);
+  }
+  std::vector<size_t> offsets;
+  workspace_size_ = PlanWorkspaceOffsets(usages, &offsets);
+  workspace_naive_size_ = NaiveWorkspaceSize(usages);
+  // The tensors keep the old workspace alive until they are placed in the new
+  // one, since the outputs are read after Run.
+  workspace_.reset();
+  if (workspace_size_ > 0) {
+    workspace_ = memory::AllocShared(place_, workspace_size_);
+  }
+  for (size_t i = 0; i < workspace_tensors_.size(); ++i) {
+    auto &item = workspace_tensors_[i];
+    item.slot.reset();
+    if (item.usage.size > 0) {
+      item.slot = std::make_shared<WorkspaceSlot>(workspace_, offsets[i],
+                                                  item.usage.size);
+    }
   }
+  VLOG(3) << "NaiveExecutor plans a workspace of " << workspace_size_
+          << " bytes for " << workspace_tensors_.size() << " tensors, which "
+          << "take " << workspace_naive_size_ << " bytes without reuse.";
 }
 
 void NaiveExecutor::CreateVariables(const ProgramDesc &desc, int block_id,
@@ -126,6 +475,12 @@ void NaiveExecutor::CleanFeedFetchOps() {
     }
   }
   ops_.swap(ops);
+  if (shape_cache_capacity_ > 0) {
+    ResetShapeCache();
+  }
+  if (workspace_enabled_) {
+    ResetWorkspace();
+  }
 }
 
 NaiveExecutor::~NaiveExecutor() {
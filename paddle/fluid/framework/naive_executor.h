@@ -14,13 +14,18 @@
 
 #pragma once
 
+#include <functional>
+#include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/workspace_planner.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/place.h"
 
@@ -40,6 +45,8 @@ class Scope;
 
 class NaiveExecutor {
  public:
+  using HookFunc = std::function<void(OperatorBase*, Scope*)>;
+
   explicit NaiveExecutor(const platform::Place& place) : place_(place) {}
 
   ~NaiveExecutor();
@@ -68,15 +75,91 @@ class NaiveExecutor {
 
   void ResetTrtOps(int num);
 
+  // Cache the dims and LoD of the operator outputs for each signature of the
+  // dims and LoD of the tensors named by input_names, and restore them
+  // instead of running InferShape when Run meets a signature again. At most
+  // capacity signatures are kept, the least recently used one is evicted.
+  // The inputs must be set before Run, and the output dims must only depend
+  // on the input dims and LoD. Operators whose InferShape reads the values of
+  // tensor inputs, like ShapeTensor, always run InferShape. So do the
+  // operators whose outputs depend on input values, like where_index, unique
+  // or the NMS ops, and every operator reading their outputs.
+  void EnableShapeCache(const std::vector<std::string>& input_names,
+                        size_t capacity);
+
+  // Call hookfunc before each operator is run.
+  void RegisterInputHook(const HookFunc& hookfunc);
+
+  // Call hookfunc after each operator is run, e.g. to collect the statistics
+  // of its outputs before the memory optimization reuses them.
+  void RegisterOutputHook(const HookFunc& hookfunc);
+
+  size_t shape_cache_hits() const { return shape_cache_hits_; }
+  size_t shape_cache_misses() const { return shape_cache_misses_; }
+
+  // Place the temporary tensors only used by the operators in one workspace,
+  // at the offsets PlanWorkspaceOffsets assigns them from their lifetimes in
+  // the operators and their largest sizes in the runs so far. The tensors
+  // named by output_names stay alive until the end of Run. The workspace is
+  // planned again when a tensor outgrows its place.
+  void EnableWorkspace(const std::vector<std::string>& output_names);
+
+  size_t workspace_size() const { return workspace_size_; }
+  // The memory the tensors of the workspace take without reuse.
+  size_t workspace_naive_size() const { return workspace_naive_size_; }
+
  protected:
   void CreateOps(const ProgramDesc& desc, int block_id,
                  bool with_feed_fetch_ops);
 
  private:
+  struct OutputShape {
+    LoDTensor* tensor;
+    DDim dims;
+    LoD lod;
+  };
+  // The output shapes of each operator.
+  using OutputShapes = std::vector<std::vector<OutputShape>>;
+
+  struct WorkspaceTensor {
+    LoDTensor* tensor;
+    TensorUsage usage;
+    // The place of the tensor in the workspace, nullptr if it is not placed.
+    std::shared_ptr<phi::Allocation> slot;
+  };
+
+  void RunOp(OperatorBase* op);
+  void RunWithShapeCache();
+  void ResetShapeCache();
+  std::string ShapeSignature() const;
+  void ResetWorkspace();
+  void BindWorkspace();
+  void UpdateWorkspace();
+
   const platform::Place place_;
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_;
+  std::vector<HookFunc> input_hookfuncs_;
+  std::vector<HookFunc> output_hookfuncs_;
+
+  std::vector<std::string> shape_cache_inputs_;
+  size_t shape_cache_capacity_{0};
+  // The operators which can skip InferShape, nullptr for the others.
+  std::vector<const OperatorWithKernel*> shape_cached_ops_;
+  // The most recently used signature first.
+  std::list<std::pair<std::string, OutputShapes>> shape_cache_;
+  std::unordered_map<std::string, decltype(shape_cache_)::iterator>
+      shape_cache_index_;
+  size_t shape_cache_hits_{0};
+  size_t shape_cache_misses_{0};
+
+  bool workspace_enabled_{false};
+  std::vector<std::string> workspace_outputs_;
+  std::vector<WorkspaceTensor> workspace_tensors_;
+  std::shared_ptr<phi::Allocation> workspace_;
+  size_t workspace_size_{0};
+  size_t workspace_naive_size_{0};
 };
 
 }  // namespace framework
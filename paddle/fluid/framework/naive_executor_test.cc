@@ -15,8 +15,10 @@
 #include "paddle/fluid/framework/naive_executor.h"
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
+#include "paddle/phi/core/kernel_registry.h"
 
 namespace paddle {
 namespace framework {
@@ -64,7 +66,57 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+// where_index selects a number of rows given by the values of cond, so cast
+// has to run InferShape on each run though the dims of cond do not change.
+TEST(NaiveExecutor, ShapeCacheValueDependentOutputs) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"cond", "index", "out"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* where_index = main_block->AppendOp();
+  where_index->SetType("where_index");
+  where_index->SetInput("Condition", {"cond"});
+  where_index->SetOutput("Out", {"index"});
+  auto* cast = main_block->AppendOp();
+  cast->SetType("cast");
+  cast->SetInput("X", {"index"});
+  cast->SetOutput("Out", {"out"});
+  cast->SetAttr("in_dtype", static_cast<int>(proto::VarType::INT64));
+  cast->SetAttr("out_dtype", static_cast<int>(proto::VarType::FP32));
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.EnableShapeCache({"cond"}, 4);
+  auto* cond_tensor = exe.FindTensor("cond");
+  cond_tensor->Resize({4});
+  for (auto values : {std::vector<bool>{true, false, true, true},
+                      std::vector<bool>{false, true, false, false},
+                      std::vector<bool>{true, true, true, true}}) {
+    bool* cond_data = cond_tensor->mutable_data<bool>(place);
+    std::copy(values.begin(), values.end(), cond_data);
+    exe.Run();
+    auto* out_tensor = exe.FindTensor("out");
+    int64_t num_true = std::count(values.begin(), values.end(), true);
+    ASSERT_EQ(out_tensor->dims(), phi::make_ddim({num_true, 1}));
+    const float* out_data = out_tensor->data<float>();
+    for (int64_t i = 0, j = 0; i < 4; i++) {
+      if (values[i]) {
+        EXPECT_EQ(out_data[j++], static_cast<float>(i));
+      }
+    }
+  }
+  EXPECT_EQ(exe.shape_cache_misses(), 1UL);
+  EXPECT_EQ(exe.shape_cache_hits(), 2UL);
+}
+
 }  // namespace framework
 }  // namespace paddle
 
 USE_OP_ITSELF(elementwise_add);
+USE_OP_ITSELF(where_index);
+USE_OP_ITSELF(cast);
+PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(where_index, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(cast, CPU, ALL_LAYOUT);
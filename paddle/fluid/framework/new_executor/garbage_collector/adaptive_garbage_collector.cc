@@ -0,0 +1,71 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/garbage_collector/adaptive_garbage_collector.h"
+
+#include "paddle/fluid/framework/garbage_collector.h"
+
+namespace paddle {
+namespace framework {
+
+InterpreterCoreAdaptiveGarbageCollector::
+    ~InterpreterCoreAdaptiveGarbageCollector() {
+  if (garbages_ && !garbages_->empty()) {
+    GarbageQueue* garbage_queue = garbages_.release();
+    AdaptiveGarbageReleaser::Instance().Release(
+        [garbage_queue]() { delete garbage_queue; });
+  }
+}
+
+void InterpreterCoreAdaptiveGarbageCollector::Add(
+    Variable* var, platform::DeviceEvent* event,
+    const platform::DeviceContext* ctx) {
+  // The instructions on CPU have finished when their garbages are added
+  Add(var);
+}
+
+void InterpreterCoreAdaptiveGarbageCollector::Add(Variable* var) {
+  if (UNLIKELY(max_memory_size_ < 0) || var == nullptr) {
+    return;
+  }
+
+  ForEachGarbage(var, [this](Garbage garbage) { Add(std::move(garbage)); });
+}
+
+void InterpreterCoreAdaptiveGarbageCollector::Add(Garbage garbage) {
+  if (!garbage) {
+    return;
+  }
+
+  auto& releaser = AdaptiveGarbageReleaser::Instance();
+  GarbageQueue* pending_delete_garbages = nullptr;
+  {  // lock guard
+    std::lock_guard<memory::SpinLock> guard(spinlock_);
+    cur_memory_size_ += garbage->size();
+    garbages_->push_back(std::move(garbage));
+
+    if (cur_memory_size_ >= static_cast<int64_t>(releaser.Threshold())) {
+      cur_memory_size_ = 0;
+      pending_delete_garbages = garbages_.release();
+      garbages_ = std::make_unique<GarbageQueue>();
+    }
+  }
+  if (pending_delete_garbages) {
+    releaser.Release(
+        [pending_delete_garbages]() { delete pending_delete_garbages; });
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
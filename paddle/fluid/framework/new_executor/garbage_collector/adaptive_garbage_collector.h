@@ -0,0 +1,39 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include "paddle/fluid/framework/new_executor/garbage_collector/garbage_collector.h"
+
+namespace paddle {
+namespace framework {
+
+// InterpreterCoreAdaptiveGarbageCollector batches the garbages up to the
+// threshold of AdaptiveGarbageReleaser, and frees them on the releasing
+// thread. It is only used on CPU, where the garbages can be freed as soon as
+// the instruction finishes, when FLAGS_enable_adaptive_gc is on.
+class InterpreterCoreAdaptiveGarbageCollector
+    : public InterpreterCoreGarbageCollector {
+ public:
+  ~InterpreterCoreAdaptiveGarbageCollector();
+
+  void Add(Variable* var) override;
+  void Add(Variable* var, platform::DeviceEvent* event,
+           const platform::DeviceContext* ctx) override;
+
+ private:
+  void Add(Garbage garbage);
+};
+
+}  // namespace framework
+}  // namespace paddle
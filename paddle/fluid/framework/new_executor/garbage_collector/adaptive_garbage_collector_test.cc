@@ -0,0 +1,73 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/garbage_collector/adaptive_garbage_collector.h"
+
+#include <gtest/gtest.h>
+
+#include <future>  // NOLINT
+
+#include "paddle/fluid/framework/garbage_collector.h"
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace framework {
+
+static std::weak_ptr<memory::Allocation> AllocTensor(Variable* var,
+                                                     size_t bytes) {
+  auto* tensor = var->GetMutable<LoDTensor>();
+  tensor->Resize({static_cast<int64_t>(bytes)});
+  tensor->mutable_data<uint8_t>(platform::CPUPlace());
+  return tensor->Holder();
+}
+
+static void WaitReleased() {
+  std::promise<void> released;
+  AdaptiveGarbageReleaser::Instance().Release(
+      [&released]() { released.set_value(); });
+  released.get_future().wait();
+}
+
+TEST(InterpreterCoreAdaptiveGarbageCollector, release_threshold) {
+  const size_t threshold = AdaptiveGarbageReleaser::Instance().Threshold();
+  InterpreterCoreAdaptiveGarbageCollector gc;
+  Variable small, large;
+  auto small_holder = AllocTensor(&small, threshold / 4);
+  auto large_holder = AllocTensor(&large, threshold);
+
+  gc.Add(&small);
+  WaitReleased();
+  EXPECT_FALSE(small.Get<LoDTensor>().IsInitialized());
+  EXPECT_FALSE(small_holder.expired());
+
+  // The garbages reach the threshold and are freed on the releasing thread.
+  gc.Add(&large, nullptr, nullptr);
+  WaitReleased();
+  EXPECT_TRUE(small_holder.expired());
+  EXPECT_TRUE(large_holder.expired());
+}
+
+TEST(InterpreterCoreAdaptiveGarbageCollector, free_on_destruction) {
+  Variable var;
+  auto holder = AllocTensor(&var, 64);
+  {
+    InterpreterCoreAdaptiveGarbageCollector gc;
+    gc.Add(&var);
+  }
+  WaitReleased();
+  EXPECT_TRUE(holder.expired());
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -13,6 +13,7 @@
 // limitations under the License.
 #pragma once
 
+#include <functional>
 #include <queue>
 #include "paddle/fluid/memory/allocation/spin_lock.h"
 #include "paddle/fluid/platform/device_event.h"
@@ -35,6 +36,10 @@ class InterpreterCoreGarbageCollector {
   DISABLE_COPY_AND_ASSIGN(InterpreterCoreGarbageCollector);
 
  protected:
+  // Moves the memory holders of var out, and calls add on each of them.
+  static void ForEachGarbage(Variable* var,
+                             const std::function<void(Garbage)>& add);
+
   std::unique_ptr<GarbageQueue> garbages_;
   int64_t max_memory_size_;
   int64_t cur_memory_size_;
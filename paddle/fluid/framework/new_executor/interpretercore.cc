@@ -16,9 +16,11 @@
 #include <unordered_set>
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/details/share_tensor_buffer_functor.h"
+#include "paddle/fluid/framework/new_executor/garbage_collector/adaptive_garbage_collector.h"
 #include "paddle/fluid/framework/new_executor/garbage_collector/event_garbage_collector.h"
 #include "paddle/fluid/framework/new_executor/garbage_collector/fast_garbage_collector.h"
 #include "paddle/fluid/framework/new_executor/interpretercore_util.h"
+#include "paddle/fluid/framework/op_call_stack.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/platform/os_info.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
@@ -36,6 +38,7 @@ PADDLE_DEFINE_EXPORTED_bool(new_executor_use_local_scope, true,
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(benchmark);
 DECLARE_bool(fast_eager_deletion_mode);
+DECLARE_bool(enable_adaptive_gc);
 
 constexpr const char* kExceptionCaught = "ExceptionCaught";
 constexpr const char* kTaskCompletion = "TaskCompletion";
@@ -64,15 +67,20 @@ InterpreterCore::InterpreterCore(const platform::Place& place,
   async_work_queue_.reset(new interpreter::AsyncWorkQueue(
       kHostNumThreads, kDeviceNumThreads, &main_thread_blocker_));
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-  if (IsInterpretercoreFastGCEnabled()) {
-    gc_ = std::make_unique<InterpreterCoreFastGarbageCollector>();
+  use_adaptive_gc_ = FLAGS_enable_adaptive_gc && platform::is_cpu_place(place_);
+  if (use_adaptive_gc_) {
+    gc_ = std::make_unique<InterpreterCoreAdaptiveGarbageCollector>();
   } else {
-    gc_ = std::make_unique<InterpreterCoreEventGarbageCollector>();
-  }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    if (IsInterpretercoreFastGCEnabled()) {
+      gc_ = std::make_unique<InterpreterCoreFastGarbageCollector>();
+    } else {
+      gc_ = std::make_unique<InterpreterCoreEventGarbageCollector>();
+    }
 #else
-  gc_ = std::make_unique<InterpreterCoreEventGarbageCollector>();
+    gc_ = std::make_unique<InterpreterCoreEventGarbageCollector>();
 #endif
+  }
 
   exception_notifier_ = main_thread_blocker_.RegisterEvent(kExceptionCaught);
   completion_notifier_ = main_thread_blocker_.RegisterEvent(kTaskCompletion);
@@ -470,6 +478,8 @@ void InterpreterCore::RunInstruction(const Instruction& instr_node) {
                            ? global_scope_->GetMutableLocalScope()
                            : global_scope_->GetMutableScope();
   auto op_with_kernel = dynamic_cast<const framework::OperatorWithKernel*>(op);
+  auto allocation_profile_scope =
+      CreateAllocationProfileScope(op->Type(), op->Outputs(), op->Attrs());
   {
     // If it is OperatorBase, InferShape do nothing.
     if (op_with_kernel != nullptr) {
@@ -866,6 +876,10 @@ void InterpreterCore::CheckGC(
     if (is_ready) {
       VLOG(6) << "Async delete variable with name : "
               << var_scope.GetNameById(var_id);
+      if (use_adaptive_gc_) {
+        gc_->Add(var_scope.Var(var_id));
+        continue;
+      }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
       if (IsInterpretercoreFastGCEnabled()) {
         static_cast<InterpreterCoreFastGarbageCollector*>(gc_.get())->Add(
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/op_call_stack.h"
 
+#include <cstring>
 #include <string>
 
 #include "paddle/fluid/framework/op_proto_maker.h"
@@ -83,5 +84,75 @@ void AppendErrorOpHint(const std::string &type,
   exception->set_error_str(sout.str());
 }
 
+// the quoted path of a "  File \"<path>\", line ..." frame
+static std::string FramePath(const std::string &frame) {
+  size_t begin = frame.find('"');
+  size_t end = begin == std::string::npos ? begin : frame.find('"', begin + 1);
+  if (end == std::string::npos) {
+    return "";
+  }
+  return frame.substr(begin + 1, end - begin - 1);
+}
+
+// the directory of the paddle package containing path, or "" if there is none
+static std::string PackageRoot(const std::string &path) {
+  for (const char *dir : {"/paddle/", "\\paddle\\"}) {
+    size_t pos = path.rfind(dir);
+    if (pos != std::string::npos) {
+      return path.substr(0, pos + strlen(dir));
+    }
+  }
+  return "";
+}
+
+std::string GetOpCreationCallSite(const AttributeMap &attrs) {
+  auto iter = attrs.find(OpProtoAndCheckerMaker::OpCreationCallstackAttrName());
+  if (iter == attrs.end()) {
+    return "";
+  }
+  const auto &callstack =
+      BOOST_GET_CONST(std::vector<std::string>, iter->second);
+  // the callstack is recorded as pairs of "  File ..." and source lines, with
+  // the most recent call last, which is in the paddle/fluid/framework.py that
+  // records it, so it gives the root of the installed package
+  std::string package_root;
+  bool innermost = true;
+  for (auto it = callstack.rbegin(); it != callstack.rend(); ++it) {
+    const std::string &line = *it;
+    size_t pos = line.find_first_not_of(' ');
+    if (pos == std::string::npos || line.compare(pos, 4, "File") != 0) {
+      continue;
+    }
+    std::string path = FramePath(line);
+    if (innermost) {
+      innermost = false;
+      package_root = PackageRoot(path);
+    }
+    if (package_root.empty() ||
+        path.compare(0, package_root.size(), package_root) != 0) {
+      return line.substr(pos);
+    }
+  }
+  return "";
+}
+
+std::unique_ptr<memory::AllocationProfileScope> CreateAllocationProfileScope(
+    const std::string &type, const VariableNameMap &outputs,
+    const AttributeMap &attrs) {
+  if (LIKELY(!memory::AllocationProfiler::IsEnabled())) {
+    return nullptr;
+  }
+  std::string var_name;
+  for (auto &pair : outputs) {
+    if (!pair.second.empty()) {
+      var_name = pair.second[0];
+      break;
+    }
+  }
+  return std::unique_ptr<memory::AllocationProfileScope>(
+      new memory::AllocationProfileScope(type, var_name,
+                                         GetOpCreationCallSite(attrs)));
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -14,9 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "paddle/fluid/framework/type_defs.h"
+#include "paddle/fluid/memory/allocation_profiler.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -30,5 +32,15 @@ void InsertCallStackInfo(const std::string &type, const AttributeMap &attrs,
 void AppendErrorOpHint(const std::string &type,
                        platform::EnforceNotMet *exception);
 
+// get the innermost user frame of the python call stack that created the op,
+// frames inside the installed paddle package are skipped
+std::string GetOpCreationCallSite(const AttributeMap &attrs);
+
+// attribute the allocations of the running op to its type, first output and
+// creation call site, returns nullptr if allocation profiling is disabled
+std::unique_ptr<memory::AllocationProfileScope> CreateAllocationProfileScope(
+    const std::string &type, const VariableNameMap &outputs,
+    const AttributeMap &attrs);
+
 }  // namespace framework
 }  // namespace paddle
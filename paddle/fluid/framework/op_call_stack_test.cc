@@ -59,3 +59,32 @@ TEST(OpCallStack, AppendErrorOpHint) {
     EXPECT_TRUE(ex_msg.find("[operator < test > error]") != std::string::npos);
   }
 }
+
+TEST(OpCallStack, GetOpCreationCallSite) {
+  paddle::framework::AttributeMap attr_map;
+  EXPECT_EQ(paddle::framework::GetOpCreationCallSite(attr_map), "");
+
+  std::vector<std::string> stack_test_vec = {
+      "  File \"train.py\", line 10, in <module>",
+      "    out = model(x)",
+      "  File \"/usr/lib/python3/paddle/fluid/framework.py\", line 3, in "
+      "append_op",
+      "    frame = traceback.extract_stack()"};
+  attr_map["op_callstack"] = stack_test_vec;
+  EXPECT_EQ(paddle::framework::GetOpCreationCallSite(attr_map),
+            "File \"train.py\", line 10, in <module>");
+
+  // a user project in a directory named paddle is outside of the package
+  stack_test_vec = {
+      "  File \"/home/user/paddle/train.py\", line 7, in <module>",
+      "    out = conv(x)",
+      "  File \"/usr/lib/python3/paddle/nn/layer/conv.py\", line 5, in "
+      "forward",
+      "    return F.conv2d(x)",
+      "  File \"/usr/lib/python3/paddle/fluid/framework.py\", line 3, in "
+      "append_op",
+      "    frame = traceback.extract_stack()"};
+  attr_map["op_callstack"] = stack_test_vec;
+  EXPECT_EQ(paddle::framework::GetOpCreationCallSite(attr_map),
+            "File \"/home/user/paddle/train.py\", line 7, in <module>");
+}
@@ -269,6 +269,8 @@ void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
           op_name, platform::TracerEventType::Operator,
           FLAGS_enable_host_event_recorder_hook ? 20 : 1,
           platform::EventRole::kUniqueOp);
+      auto allocation_profile_scope =
+          CreateAllocationProfileScope(Type(), outputs_, Attrs());
       RunImpl(scope, place);
     }
 
@@ -1437,7 +1439,7 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   const Scope& exec_scope =
       (transfer_scope == nullptr ? scope : *transfer_scope);
 
-  if (!all_kernels_must_compute_runtime_shape_) {
+  if (!all_kernels_must_compute_runtime_shape_ && !skip_infer_shape_) {
     platform::RecordEvent record_event("infer_shape",
                                        platform::TracerEventType::OperatorInner,
                                        1, platform::EventRole::kInnerOp);
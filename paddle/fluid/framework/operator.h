@@ -585,6 +585,10 @@ class OperatorWithKernel : public OperatorBase {
 
   virtual void InferShape(InferShapeContext* ctx) const;
 
+  // Skips InferShape in the following runs, the caller is responsible for
+  // setting the dims and LoD of the outputs, see NaiveExecutor's shape cache.
+  void SetSkipInferShape(bool skip) const { skip_infer_shape_ = skip; }
+
   void RuntimeInferShape(const Scope& scope, const platform::Place& place,
                          const RuntimeContext& ctx) const override;
 
@@ -700,6 +704,7 @@ class OperatorWithKernel : public OperatorBase {
   mutable bool need_prepare_data_ = true;
   mutable bool enable_cache_runtime_context_ = false;
   mutable bool all_kernels_must_compute_runtime_shape_ = false;
+  mutable bool skip_infer_shape_ = false;
   mutable std::mutex cache_update_mutex_;
   mutable bool enable_cache_transfer_scope_ = false;
   // NOTE(chenweihang): Similar op members are used to adapt to
@@ -46,6 +46,7 @@ limitations under the License. */
 #endif
 
 DECLARE_double(eager_delete_tensor_gb);
+DECLARE_bool(enable_adaptive_gc);
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 DECLARE_bool(sync_nccl_allreduce);
@@ -550,7 +551,11 @@ ir::Graph *ParallelExecutorPrivate::ApplyMemoryOptimizePass(ir::Graph *graph) {
           "Please recompile or reinstall Paddle with CustomDevice support."));
 #endif
     } else if (platform::is_cpu_place(place)) {
-      gc.reset(new CPUGarbageCollector(place, max_memory_size));
+      if (FLAGS_enable_adaptive_gc) {
+        gc.reset(new CPUAdaptiveGarbageCollector(place));
+      } else {
+        gc.reset(new CPUGarbageCollector(place, max_memory_size));
+      }
       VLOG(10) << "Created GarbageCollector at " << place;
     } else {
       PADDLE_THROW(platform::errors::PreconditionNotMet(
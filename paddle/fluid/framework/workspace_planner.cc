@@ -0,0 +1,102 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/workspace_planner.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+
+namespace paddle {
+namespace framework {
+
+static size_t AlignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+size_t PlanWorkspaceOffsets(const std::vector<TensorUsage>& usages,
+                            std::vector<size_t>* offsets, size_t alignment) {
+  std::vector<size_t> order(usages.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return usages[a].size > usages[b].size;
+  });
+
+  offsets->assign(usages.size(), 0);
+  // The placed tensors, ordered by offset.
+  std::vector<size_t> placed;
+  size_t workspace_size = 0;
+  for (size_t idx : order) {
+    const TensorUsage& usage = usages[idx];
+    size_t size = AlignUp(usage.size, alignment);
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (size_t other : placed) {
+      const TensorUsage& placed_usage = usages[other];
+      if (placed_usage.last < usage.first || usage.last < placed_usage.first) {
+        continue;
+      }
+      size_t offset = (*offsets)[other];
+      if (offset >= prev_end + size && offset - prev_end < best_gap) {
+        best_gap = offset - prev_end;
+        best_offset = prev_end;
+      }
+      prev_end =
+          std::max(prev_end, offset + AlignUp(placed_usage.size, alignment));
+    }
+    if (best_gap == std::numeric_limits<size_t>::max()) {
+      best_offset = prev_end;
+    }
+    (*offsets)[idx] = best_offset;
+    workspace_size = std::max(workspace_size, best_offset + size);
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), best_offset,
+                                   [&](size_t offset, size_t other) {
+                                     return offset < (*offsets)[other];
+                                   }),
+                  idx);
+  }
+  return workspace_size;
+}
+
+size_t NaiveWorkspaceSize(const std::vector<TensorUsage>& usages,
+                          size_t alignment) {
+  size_t size = 0;
+  for (auto& usage : usages) {
+    size += AlignUp(usage.size, alignment);
+  }
+  return size;
+}
+
+bool IsMemoryReuseUnsafeOp(const std::string& op_type) {
+  // lod operator reuse may cause unknown errors.
+  static const std::unordered_set<std::string> unsafe_ops = {
+      "while",
+      "conditional_block",
+      "tensorrt_engine",
+      "conditional_block_infer",
+      "merge_lod_tensor_infer",
+      "merge_lod_tensor",
+      "equal",
+      "sequence_pool",
+      "recurrent",
+      "lod_reset",
+      "fetch",
+      "share_data"};
+  return unsafe_ops.count(op_type) > 0;
+}
+
+}  // namespace framework
+}  // namespace paddle
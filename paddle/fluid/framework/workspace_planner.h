@@ -0,0 +1,53 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// A tensor to place in a workspace, which is alive from the operator first
+// to the operator last, both included.
+struct TensorUsage {
+  size_t size;
+  int first;
+  int last;
+};
+
+// Assigns each tensor an offset in one workspace, so that the tensors alive
+// at the same time do not overlap, and returns the size of the workspace.
+//
+// The tensors are placed from the largest to the smallest, each one in the
+// smallest gap left between the placed tensors it overlaps in time which
+// fits it, or after them if there is none. The offsets are multiples of
+// alignment.
+size_t PlanWorkspaceOffsets(const std::vector<TensorUsage>& usages,
+                            std::vector<size_t>* offsets,
+                            size_t alignment = 64);
+
+// The workspace needed if the tensors were not reused, the sum of their
+// aligned sizes.
+size_t NaiveWorkspaceSize(const std::vector<TensorUsage>& usages,
+                          size_t alignment = 64);
+
+// The operators whose inputs and outputs are not reused in the memory
+// optimization, e.g. the ones running sub-blocks or sharing their buffers.
+bool IsMemoryReuseUnsafeOp(const std::string& op_type);
+
+}  // namespace framework
+}  // namespace paddle
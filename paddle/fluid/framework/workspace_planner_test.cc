@@ -0,0 +1,106 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/workspace_planner.h"
+
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+// Checks that the tensors alive at the same time do not overlap, and
+// returns the largest total size of the tensors alive at the same time.
+static size_t CheckPlan(const std::vector<TensorUsage>& usages,
+                        const std::vector<size_t>& offsets,
+                        size_t workspace_size) {
+  int num_ops = 0;
+  for (size_t i = 0; i < usages.size(); ++i) {
+    EXPECT_LE(offsets[i] + usages[i].size, workspace_size);
+    num_ops = std::max(num_ops, usages[i].last + 1);
+    for (size_t j = i + 1; j < usages.size(); ++j) {
+      bool alive = usages[i].first <= usages[j].last &&
+                   usages[j].first <= usages[i].last;
+      bool overlap = offsets[i] < offsets[j] + usages[j].size &&
+                     offsets[j] < offsets[i] + usages[i].size;
+      EXPECT_FALSE(alive && overlap) << "tensors " << i << " and " << j;
+    }
+  }
+  size_t peak = 0;
+  for (int op = 0; op < num_ops; ++op) {
+    size_t live = 0;
+    for (auto& usage : usages) {
+      if (usage.first <= op && op <= usage.last) {
+        live += usage.size;
+      }
+    }
+    peak = std::max(peak, live);
+  }
+  return peak;
+}
+
+TEST(WorkspacePlanner, chain) {
+  std::vector<TensorUsage> usages = {{100, 0, 1}, {200, 1, 2}, {100, 2, 3}};
+  std::vector<size_t> offsets;
+  size_t size = PlanWorkspaceOffsets(usages, &offsets);
+  // The first and the last tensors share the memory after the second one.
+  EXPECT_EQ(offsets[1], 0UL);
+  EXPECT_EQ(offsets[0], 256UL);
+  EXPECT_EQ(offsets[2], 256UL);
+  EXPECT_EQ(size, 384UL);
+  EXPECT_EQ(NaiveWorkspaceSize(usages), 512UL);
+  CheckPlan(usages, offsets, size);
+}
+
+TEST(WorkspacePlanner, best_fit) {
+  std::vector<TensorUsage> usages = {
+      {100, 0, 1}, {60, 2, 3}, {40, 0, 3}, {30, 2, 2}};
+  std::vector<size_t> offsets;
+  size_t size = PlanWorkspaceOffsets(usages, &offsets, 1);
+  EXPECT_EQ(offsets[0], 0UL);
+  EXPECT_EQ(offsets[1], 0UL);
+  EXPECT_EQ(offsets[2], 100UL);
+  // The gap [60, 100) left between the second and the third tensors fits
+  // the last one.
+  EXPECT_EQ(offsets[3], 60UL);
+  EXPECT_EQ(size, 140UL);
+  CheckPlan(usages, offsets, size);
+}
+
+TEST(WorkspacePlanner, random) {
+  std::mt19937 rng(2022);
+  std::uniform_int_distribution<int> op_dist(0, 99);
+  std::uniform_int_distribution<int> length_dist(0, 10);
+  std::uniform_int_distribution<size_t> size_dist(1, 1 << 16);
+  std::vector<TensorUsage> usages;
+  for (int i = 0; i < 300; ++i) {
+    int first = op_dist(rng);
+    usages.push_back({size_dist(rng), first, first + length_dist(rng)});
+  }
+  std::vector<size_t> offsets;
+  size_t size = PlanWorkspaceOffsets(usages, &offsets, 1);
+  size_t lower_bound = CheckPlan(usages, offsets, size);
+  EXPECT_GE(size, lower_bound);
+  EXPECT_LT(size, NaiveWorkspaceSize(usages, 1));
+}
+
+TEST(WorkspacePlanner, unsafe_ops) {
+  EXPECT_TRUE(IsMemoryReuseUnsafeOp("while"));
+  EXPECT_FALSE(IsMemoryReuseUnsafeOp("relu"));
+}
+
+}  // namespace framework
+}  // namespace paddle
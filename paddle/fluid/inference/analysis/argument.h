@@ -141,6 +141,8 @@ struct Argument {
   DECL_ARGUMENT_FIELD(model_program_path, ModelProgramPath, std::string);
   DECL_ARGUMENT_FIELD(model_params_path, ModelParamsPath, std::string);
   DECL_ARGUMENT_FIELD(model_from_memory, ModelFromMemory, bool);
+  // Back the parameters with the pages of the mmapped parameters file.
+  DECL_ARGUMENT_FIELD(model_params_mmap, ModelParamsMmap, bool);
   DECL_ARGUMENT_FIELD(optim_cache_dir, OptimCacheDir, std::string);
   DECL_ARGUMENT_FIELD(enable_analysis_optim, EnableAnalysisOptim, bool);
 
@@ -193,6 +195,9 @@ struct Argument {
   DECL_ARGUMENT_FIELD(use_gpu_fp16, UseGPUFp16, bool);
   DECL_ARGUMENT_FIELD(gpu_fp16_disabled_op_types, GpuFp16DisabledOpTypes,
                       std::unordered_set<std::string>);
+  // A set of op types to run on the bfloat16 CPU kernels of phi.
+  DECL_ARGUMENT_FIELD(cpu_bfloat16_enabled_op_types, CpuBfloat16EnabledOpTypes,
+                      std::unordered_set<std::string>);
 
   // Usually use for trt dynamic shape.
   // TRT will select the best kernel according to opt shape
@@ -270,6 +275,10 @@ struct Argument {
   // optimization relays on the sort algorithm.
   DECL_ARGUMENT_FIELD(memory_optim_sort_kind, MemoryOptimSortKind, int);
 
+  // Whether the executor places the intermediate tensors in one workspace
+  // instead of the memory optimization sharing their names.
+  DECL_ARGUMENT_FIELD(memory_optim_workspace, MemoryOptimWorkspace, bool);
+
   // The program transformed by IR analysis phase.
   DECL_ARGUMENT_UNIQUE_FIELD(ir_analyzed_program, IrAnalyzedProgram,
                              framework::proto::ProgramDesc);
@@ -198,6 +198,10 @@ void IRPassManager::CreatePasses(Argument *argument,
       pass->Set("gpu_fp16_disabled_op_types",
                 new std::unordered_set<std::string>(
                     argument->gpu_fp16_disabled_op_types()));
+    } else if (pass_name == "cpu_bfloat16_mixed_precision_pass") {
+      pass->Set("cpu_bfloat16_enabled_op_types",
+                new std::unordered_set<std::string>(
+                    argument->cpu_bfloat16_enabled_op_types()));
     }
     if (pass_name == "lite_subgraph_pass") {
       bool lite_enable_int8 =
@@ -19,6 +19,7 @@
 
 #include "glog/logging.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/workspace_planner.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -94,32 +95,15 @@ void MemoryOptimizePass::CollectVarMemorySize(
   const int fake_batch_size = 1;
 
   auto valid_var = [&](framework::ir::Node* node) -> bool {
-    // lod operator reuse may cause unknown errors.
-    std::set<std::string> invalid_op = {"while",
-                                        "conditional_block",
-                                        "tensorrt_engine",
-                                        "conditional_block_infer",
-                                        "merge_lod_tensor_infer",
-                                        "merge_lod_tensor",
-                                        "equal",
-                                        "sequence_pool",
-                                        "recurrent",
-                                        "lod_reset",
-                                        "fetch",
-                                        "share_data"};
     for (auto* tmp : node->inputs) {
       CHECK(tmp->IsOp());
-      std::string op_type = tmp->Op()->Type();
-      if (std::find(invalid_op.begin(), invalid_op.end(), op_type) !=
-          invalid_op.end()) {
+      if (framework::IsMemoryReuseUnsafeOp(tmp->Op()->Type())) {
         return false;
       }
     }
     for (auto* tmp : node->outputs) {
       CHECK(tmp->IsOp());
-      std::string op_type = tmp->Op()->Type();
-      if (std::find(invalid_op.begin(), invalid_op.end(), op_type) !=
-          invalid_op.end()) {
+      if (framework::IsMemoryReuseUnsafeOp(tmp->Op()->Type())) {
         return false;
       }
     }
@@ -218,6 +202,32 @@ void MakeSimpleReusePlan(
   }
 }
 
+// Compare the memory of the tensors without reuse, with the reuse plan, in
+// which each cluster takes the size of its largest tensor, and with the
+// tensors placed at offsets in one workspace.
+void ReportReusePlan(
+    const std::unordered_map<std::string, std::pair<int, int>>& lifecycles,
+    const std::unordered_map<std::string, size_t>& space_table,
+    const std::unordered_map<std::string, int>& cluster_size) {
+  if (!VLOG_IS_ON(3)) return;
+  std::vector<framework::TensorUsage> usages;
+  for (auto& data : lifecycles) {
+    if (!space_table.count(data.first)) continue;
+    usages.push_back({space_table.at(data.first), data.second.first,
+                      data.second.second});
+  }
+  size_t reuse_size = 0;
+  for (auto& cluster : cluster_size) {
+    reuse_size += cluster.second;
+  }
+  std::vector<size_t> offsets;
+  size_t workspace_size = framework::PlanWorkspaceOffsets(usages, &offsets, 1);
+  VLOG(3) << "Memory of " << usages.size() << " tensors with batch size 1, "
+          << "naive: " << framework::NaiveWorkspaceSize(usages, 1)
+          << " bytes, reuse plan: " << reuse_size
+          << " bytes, workspace plan: " << workspace_size << " bytes";
+}
+
 // NOTE The optimized opdesc doesn't match ir::Graph.
 void UpdateOpDescsByReuse(
     Graph* graph,
@@ -318,6 +328,13 @@ void MemoryOptimizePass::RunImpl(Argument* argument) {
   CollectLifeCycle(graph, &lifecycles, sort_kind);
   CollectVarMemorySize(graph, &space_table);
   MakeSimpleReusePlan(lifecycles, space_table, &node2cluster, &cluster_size);
+  ReportReusePlan(lifecycles, space_table, cluster_size);
+  // The executor places the tensors in the workspace with their sizes at
+  // runtime, so keep their names apart.
+  if (argument->memory_optim_workspace_valid() &&
+      argument->memory_optim_workspace()) {
+    return;
+  }
   UpdateOpDescsByReuse(graph, node2cluster, sort_kind);
   return;
 }
@@ -232,6 +232,13 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(gpu_fp16_disabled_op_types_);
 
   CP_MEMBER(enable_memory_optim_);
+  CP_MEMBER(enable_workspace_memory_optim_);
+  CP_MEMBER(enable_shared_params_);
+  CP_MEMBER(enable_mmap_params_);
+  CP_MEMBER(enable_program_cache_);
+  CP_MEMBER(shape_cache_capacity_);
+  CP_MEMBER(use_cpu_quantizer_);
+  CP_MEMBER(cpu_quantizer_config_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -260,6 +267,8 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   // Bfloat16 related.
   CP_MEMBER(use_mkldnn_bfloat16_);
   CP_MEMBER(bfloat16_enabled_op_types_);
+  CP_MEMBER(use_cpu_bfloat16_);
+  CP_MEMBER(cpu_bfloat16_enabled_op_types_);
   // Quantization related.
   CP_MEMBER(use_mkldnn_int8_);
   CP_MEMBER(quantize_enabled_op_types_);
@@ -294,6 +303,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
 
   // profile related.
   CP_MEMBER(with_profile_);
+  CP_MEMBER(enable_op_stats_);
 
   // glog related.
   CP_MEMBER(with_glog_info_);
@@ -438,6 +448,22 @@ void AnalysisConfig::EnableMkldnnBfloat16() {
   Update();
 }
 
+void AnalysisConfig::EnableCpuBfloat16(
+    std::unordered_set<std::string> op_list) {
+  if (platform::MayIUse(platform::cpu_isa_t::avx512_bf16)) {
+    use_cpu_bfloat16_ = true;
+    if (!op_list.empty()) {
+      cpu_bfloat16_enabled_op_types_ = op_list;
+    }
+  } else {
+    LOG(INFO) << "CPU does not support AVX512-BF16, the bfloat16 CPU kernels "
+                 "are disabled";
+    use_cpu_bfloat16_ = false;
+  }
+
+  Update();
+}
+
 void AnalysisConfig::EnableMkldnnInt8(
     const std::unordered_set<std::string> &op_list) {
 #ifdef PADDLE_WITH_MKLDNN
@@ -664,6 +690,17 @@ void AnalysisConfig::Update() {
 #endif
   }
 
+  if (use_cpu_bfloat16_) {
+    if (!enable_ir_optim_) {
+      LOG(ERROR) << "EnableCpuBfloat16() only works when IR optimization is "
+                    "enabled.";
+    } else if (use_gpu()) {
+      LOG(ERROR) << "EnableCpuBfloat16() only works when use_gpu is disabled.";
+    } else {
+      pass_builder()->EnableCpuBfloat16();
+    }
+  }
+
   if (use_mkldnn_int8_) {
 #ifdef PADDLE_WITH_MKLDNN
     if (!enable_ir_optim_) {
@@ -680,9 +717,10 @@ void AnalysisConfig::Update() {
 
 #ifdef PADDLE_WITH_MKLDNN
   // Do not optimize when mkldnn is on
-  if (enable_memory_optim_ && !use_mkldnn_) {
+  if ((enable_memory_optim_ || enable_workspace_memory_optim_) &&
+      !use_mkldnn_) {
 #else
-  if (enable_memory_optim_) {
+  if (enable_memory_optim_ || enable_workspace_memory_optim_) {
 #endif
     pass_builder()->AppendAnalysisPass("memory_optimize_pass");
   }
@@ -768,6 +806,8 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << trt_dla_core_;
 
   ss << enable_memory_optim_;
+  ss << enable_workspace_memory_optim_;
+  ss << use_cpu_quantizer_;
 
   ss << use_mkldnn_;
   ss << mkldnn_cache_capacity_;
@@ -777,6 +817,8 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << use_mkldnn_quantizer_;
   ss << use_mkldnn_bfloat16_;
   for (auto &item : bfloat16_enabled_op_types_) ss << item;
+  ss << use_cpu_bfloat16_;
+  for (auto &item : cpu_bfloat16_enabled_op_types_) ss << item;
   ss << use_mkldnn_int8_;
   for (auto &item : quantize_enabled_op_types_) ss << item;
   for (auto &item : quantize_excluded_op_ids_) ss << item;
@@ -784,6 +826,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << model_from_memory_;
 
   ss << with_profile_;
+  ss << enable_op_stats_;
 
   ss << with_glog_info_;
 
@@ -857,6 +900,45 @@ bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
 
+void AnalysisConfig::EnableWorkspaceMemoryOptim(bool x) {
+  enable_workspace_memory_optim_ = x;
+  Update();
+}
+
+void AnalysisConfig::EnableSharedParams(bool x) { enable_shared_params_ = x; }
+
+void AnalysisConfig::EnableMemoryMappedParams(bool x) {
+  enable_mmap_params_ = x;
+}
+
+void AnalysisConfig::EnableOptimizedProgramCache(bool x) {
+  enable_program_cache_ = x;
+}
+
+void AnalysisConfig::EnableShapeCache(int capacity) {
+  PADDLE_ENFORCE_GE(capacity, 0,
+                    platform::errors::InvalidArgument(
+                        "The capacity of the shape cache should be >= 0, "
+                        "but got %d.",
+                        capacity));
+  shape_cache_capacity_ = capacity;
+}
+
+void AnalysisConfig::EnableCpuQuantizer() {
+  if (!cpu_quantizer_config_) {
+    cpu_quantizer_config_.reset(new CpuQuantizerConfig());
+  }
+  use_cpu_quantizer_ = true;
+  Update();
+}
+
+CpuQuantizerConfig *AnalysisConfig::cpu_quantizer_config() const {
+  PADDLE_ENFORCE_NOT_NULL(cpu_quantizer_config_,
+                          platform::errors::PreconditionNotMet(
+                              "CpuQuantizer was not enabled yet."));
+  return cpu_quantizer_config_.get();
+}
+
 void AnalysisConfig::SetModelBuffer(const char *prog_buffer,
                                     size_t prog_buffer_size,
                                     const char *param_buffer,
@@ -888,6 +970,8 @@ void AnalysisConfig::EnableProfile() {
   Update();
 }
 
+void AnalysisConfig::EnableOpStats(bool x) { enable_op_stats_ = x; }
+
 void AnalysisConfig::DisableGlogInfo() {
   with_glog_info_ = false;
   Update();
@@ -1025,7 +1109,15 @@ std::string AnalysisConfig::Summary() {
   os.InsertRow({"ir_optim", enable_ir_optim_ ? "true" : "false"});
   os.InsertRow({"ir_debug", ir_debug_ ? "true" : "false"});
   os.InsertRow({"memory_optim", enable_memory_optim_ ? "true" : "false"});
+  os.InsertRow({"workspace_memory_optim",
+                enable_workspace_memory_optim_ ? "true" : "false"});
+  os.InsertRow({"shared_params", enable_shared_params_ ? "true" : "false"});
+  os.InsertRow({"mmap_params", enable_mmap_params_ ? "true" : "false"});
+  os.InsertRow({"program_cache", enable_program_cache_ ? "true" : "false"});
+  os.InsertRow({"shape_cache_capacity", std::to_string(shape_cache_capacity_)});
+  os.InsertRow({"cpu_quantizer", use_cpu_quantizer_ ? "true" : "false"});
   os.InsertRow({"enable_profile", with_profile_ ? "true" : "false"});
+  os.InsertRow({"op_stats", enable_op_stats_ ? "true" : "false"});
   os.InsertRow({"enable_log", with_glog_info_ ? "true" : "false"});
   os.InsertRow({"collect_shape_range_info",
                 collect_shape_range_info_ ? shape_range_info_path_ : "false"});
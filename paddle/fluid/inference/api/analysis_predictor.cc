@@ -17,9 +17,12 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <fstream>
 #include <memory>
 #include <set>
+#include <unordered_set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -36,10 +39,13 @@
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/analysis/passes/memory_optimize_pass.h"
+#include "paddle/fluid/inference/api/cpu_quantizer.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
+#include "paddle/fluid/inference/io.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
+#include "paddle/fluid/inference/utils/mapped_params.h"
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/cpu_helper.h"
@@ -212,9 +218,91 @@ bool AnalysisPredictor::Init(
     return true;
   }
 
+  // The clones share the quantized program and parameters.
+  if (config_.cpu_quantizer_enabled() && !status_is_cloned_ &&
+      !CpuQuantize()) {
+    return false;
+  }
+
+  if (config_.shared_params_enabled() && !status_is_cloned_) {
+    FreezeParams();
+  }
+
   return true;
 }
 
+bool AnalysisPredictor::InitSharedClone(
+    const std::shared_ptr<framework::Scope> &parent_scope,
+    const std::shared_ptr<framework::ProgramDesc> &program,
+    const std::shared_ptr<inference::FrozenParamArena> &frozen_params) {
+  VLOG(3) << "Predictor::InitSharedClone()";
+  scope_ = parent_scope;
+  status_is_cloned_ = true;
+  inference_program_ = program;
+  frozen_params_ = frozen_params;
+  if (!CreateExecutor()) {
+    return false;
+  }
+  CollectFeedFetchOps();
+  status_shared_clone_pending_ = true;
+  return true;
+}
+
+void AnalysisPredictor::PrepareSharedClone() {
+  if (!status_shared_clone_pending_) {
+    return;
+  }
+  status_shared_clone_pending_ = false;
+  sub_scope_ = &scope_->NewScope();
+  executor_->CreateVariables(*inference_program_, 0, false, sub_scope_);
+  CreateFeedFetchVar(sub_scope_);
+  PrepareExecutor();
+  executor_->ResetTrtOps(trt_clone_id_);
+}
+
+bool AnalysisPredictor::CpuQuantize() {
+  CpuQuantizer quantizer(*this, config_.cpu_quantizer_config());
+  bool succeeded = quantizer.Quantize();
+  // The calibration runs are not counted in the op stats.
+  if (op_stats_) {
+    op_stats_->Reset();
+  }
+  return succeeded;
+}
+
+void AnalysisPredictor::FreezeParams() {
+  if (!platform::is_cpu_place(place_)) {
+    LOG(WARNING) << "Only the parameters on CPU can be frozen, the clones "
+                    "share the parameters on "
+                 << place_ << " without the write protection.";
+    return;
+  }
+  std::vector<std::string> param_names;
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    if (!var->Persistable() || var->Name() == "feed" ||
+        var->Name() == "fetch") {
+      continue;
+    }
+    // The mapped parameters are already shared by the page cache, protect
+    // them in place instead of copying them into the arena.
+    auto *scope_var = scope_->FindVar(var->Name());
+    auto *mapped_file =
+        scope_var && scope_var->IsType<framework::LoDTensor>()
+            ? inference::MappedParamFile::FromTensor(
+                  scope_var->Get<framework::LoDTensor>())
+            : nullptr;
+    if (mapped_file) {
+      mapped_file->Protect();
+    } else {
+      param_names.push_back(var->Name());
+    }
+  }
+  frozen_params_ =
+      inference::FrozenParamArena::Freeze(scope_.get(), param_names);
+  LOG(INFO) << "Froze " << frozen_params_->num_params() << " parameters of "
+            << frozen_params_->size() << " bytes, shared by all the clones.";
+}
+
 bool AnalysisPredictor::PrepareScope(
     const std::shared_ptr<framework::Scope> &parent_scope) {
   if (parent_scope) {
@@ -237,20 +325,34 @@ bool AnalysisPredictor::PrepareScope(
 bool AnalysisPredictor::PrepareProgram(
     const std::shared_ptr<framework::ProgramDesc> &program) {
   if (!program) {
-    if (!LoadProgramDesc()) return false;
-    // If not cloned, the parameters should be loaded.
-    // If config_.ir_optim() is True, parameters is loaded in
-    // OptimizeInferenceProgram(), but other persistable variables
-    // (like RAW type var) are not created in scope.
-    // If config_.ir_optim() is False, parameters is loaded in LoadParameters(),
-    // still need to create other persistable variables.
-    // So in both case, create persistable variables at first.
-    executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
-
-    // if enable_ir_optim_ is false,
-    // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc) will
-    // not be executed.
-    OptimizeInferenceProgram();
+    program_cache_dir_ = GetProgramCacheDir();
+    if (!program_cache_dir_.empty() &&
+        LoadProgramFromCache(program_cache_dir_)) {
+      // The cached program is already optimized and its parameters are
+      // loaded, only the other persistable variables need to be created.
+      LOG(INFO) << "Load the optimized program from " << program_cache_dir_;
+      program_cache_hit_ = true;
+      executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+      config_.PartiallyRelease();
+    } else {
+      if (!LoadProgramDesc()) return false;
+      // If not cloned, the parameters should be loaded.
+      // If config_.ir_optim() is True, parameters is loaded in
+      // OptimizeInferenceProgram(), but other persistable variables
+      // (like RAW type var) are not created in scope.
+      // If config_.ir_optim() is False, parameters is loaded in
+      // LoadParameters(), still need to create other persistable variables.
+      // So in both case, create persistable variables at first.
+      executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+
+      // if enable_ir_optim_ is false,
+      // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc)
+      // will not be executed.
+      OptimizeInferenceProgram();
+      if (!program_cache_dir_.empty()) {
+        SaveProgramToCache(program_cache_dir_);
+      }
+    }
   } else {
     // If the program is passed from external, no need to optimize it, this
     // logic is used in the clone scenario.
@@ -388,6 +490,31 @@ bool AnalysisPredictor::PrepareExecutor() {
 
   executor_->Prepare(sub_scope_, *inference_program_, 0,
                      config_.use_feed_fetch_ops_);
+  if (config_.shape_cache_capacity() > 0) {
+    if (config_.use_feed_fetch_ops_enabled()) {
+      LOG(WARNING) << "The shape cache only works without the feed and fetch "
+                      "ops, it is disabled.";
+    } else {
+      std::vector<std::string> input_names;
+      for (auto &item : idx2feeds_) {
+        input_names.push_back(item.second);
+      }
+      executor_->EnableShapeCache(input_names, config_.shape_cache_capacity());
+    }
+  }
+  if (config_.workspace_memory_optim_enabled() && !config_.use_mkldnn_) {
+    std::vector<std::string> output_names;
+    for (auto &item : idx2fetches_) {
+      output_names.push_back(item.second);
+    }
+    executor_->EnableWorkspace(output_names);
+  }
+  if (config_.op_stats_enabled()) {
+    if (!op_stats_) {
+      op_stats_.reset(new inference::OpStatsCollector(place_));
+    }
+    op_stats_->Attach(executor_.get());
+  }
 
   PADDLE_ENFORCE_NOT_NULL(sub_scope_,
                           platform::errors::PreconditionNotMet(
@@ -677,6 +804,7 @@ void AnalysisPredictor::MkldnnPostReset() {
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
+  PrepareSharedClone();
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
@@ -825,8 +953,11 @@ void AnalysisPredictor::PrepareArgument() {
   argument_.SetUseFcPadding(config_.use_fc_padding());
   argument_.SetGPUDeviceId(config_.gpu_device_id());
   argument_.SetEnableAnalysisOptim(config_.enable_ir_optim_);
-  argument_.SetEnableMemoryOptim(config_.enable_memory_optim());
+  argument_.SetEnableMemoryOptim(config_.enable_memory_optim() ||
+                                 config_.workspace_memory_optim_enabled());
+  argument_.SetMemoryOptimWorkspace(config_.workspace_memory_optim_enabled());
   argument_.SetModelFromMemory(config_.model_from_memory_);
+  argument_.SetModelParamsMmap(config_.mmap_params_enabled());
   // Analyze inference_program
   argument_.SetPredictorID(predictor_id_);
   argument_.SetOptimCacheDir(config_.opt_cache_dir_);
@@ -950,6 +1081,11 @@ void AnalysisPredictor::PrepareArgument() {
     LOG(INFO) << "Bfloat16 is enabled";
     argument_.SetBfloat16EnabledOpTypes(config_.bfloat16_enabled_op_types_);
   }
+  if (config_.cpu_bfloat16_enabled()) {
+    LOG(INFO) << "CPU bfloat16 is enabled";
+    argument_.SetCpuBfloat16EnabledOpTypes(
+        config_.cpu_bfloat16_enabled_op_types_);
+  }
 
   if (config_.use_mkldnn_int8_) {
     LOG(INFO) << "Int8 is enabled";
@@ -1140,6 +1276,10 @@ void AnalysisPredictor::PrepareFeedFetch() {
                           platform::errors::InvalidArgument(
                               "The sub_scope should not be nullptr."));
   CreateFeedFetchVar(sub_scope_);
+  CollectFeedFetchOps();
+}
+
+void AnalysisPredictor::CollectFeedFetchOps() {
   for (auto *op : inference_program_->Block(0).AllOps()) {
     if (op->Type() == "feed") {
       int idx = BOOST_GET_CONST(int, op->GetAttr("col"));
@@ -1200,6 +1340,7 @@ std::vector<std::string> AnalysisPredictor::GetOutputNames() {
 
 std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
     const std::string &name) {
+  PrepareSharedClone();
   framework::Scope *scope;
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
   if (config_.dist_config().use_dist_model()) {
@@ -1249,6 +1390,7 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
 
 std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
     const std::string &name) {
+  PrepareSharedClone();
   framework::Scope *scope;
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
   if (config_.dist_config().use_dist_model()) {
@@ -1297,6 +1439,7 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
+  PrepareSharedClone();
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
   if (config_.dist_config().use_dist_model()) {
     VLOG(3) << "ZeroCopyRun will use the fleet executor.";
@@ -1483,6 +1626,13 @@ bool AnalysisPredictor::LoadParameters() {
                           platform::errors::PreconditionNotMet(
                               "The inference program should be loaded first."));
 
+  if (config_.mmap_params_enabled() && !config_.params_file().empty() &&
+      !config_.model_from_memory() && platform::is_cpu_place(place_) &&
+      inference::LoadMappedPersistables(scope_.get(), *inference_program_,
+                                        config_.params_file())) {
+    return true;
+  }
+
   const auto &global_block = inference_program_->MutableBlock(0);
 
   // create a temporary program to load parameters.
@@ -1536,15 +1686,189 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+// Identifies a version of a model file. Small files are hashed as a whole,
+// large parameter files by their size, modification time and the bytes at
+// both ends, which avoids reading all of them on every startup.
+static std::string FileFingerprint(const std::string &path) {
+  constexpr size_t kSampleBytes = 1 << 20;
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin.is_open()), true,
+      platform::errors::NotFound(
+          "Cannot open file %s, please confirm whether the file is normal.",
+          path));
+  fin.seekg(0, std::ios::end);
+  size_t size = static_cast<size_t>(fin.tellg());
+  std::string head(std::min(size, 2 * kSampleBytes), '\0');
+  fin.seekg(0, std::ios::beg);
+  fin.read(&head[0], head.size());
+  std::string tail;
+  if (size > head.size()) {
+    head.resize(kSampleBytes);
+    tail.resize(kSampleBytes);
+    fin.seekg(size - kSampleBytes, std::ios::beg);
+    fin.read(&tail[0], tail.size());
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+      tail += std::to_string(st.st_mtime);
+    }
+  }
+  std::hash<std::string> hasher;
+  return std::to_string(size) + ":" + std::to_string(hasher(head)) + ":" +
+         std::to_string(hasher(tail));
+}
+
+std::string AnalysisPredictor::GetProgramCacheDir() {
+  if (!config_.optimized_program_cache_enabled() || !config_.ir_optim()) {
+    return "";
+  }
+  if (config_.model_from_memory() || config_.prog_file().empty() ||
+      config_.params_file().empty()) {
+    LOG(WARNING) << "The optimized program can only be cached for the model "
+                    "set by SetModel(prog_file, params_file).";
+    return "";
+  }
+  if (config_.use_gpu() || config_.use_xpu() || config_.use_npu() ||
+      config_.use_ipu() || config_.lite_engine_enabled() ||
+      config_.dlnne_enabled() || config_.mkldnn_quantizer_enabled()) {
+    LOG(WARNING) << "The optimized program can only be cached on CPU.";
+    return "";
+  }
+
+  std::stringstream key;
+  key << get_version();
+  key << config_.SerializeInfoCache();
+  for (auto &pass : config_.pass_builder()->AllPasses()) {
+    key << pass;
+  }
+  for (auto &pass : config_.pass_builder()->AnalysisPasses()) {
+    key << pass;
+  }
+  key << FileFingerprint(config_.prog_file());
+  key << FileFingerprint(config_.params_file());
+
+  std::string cache_root = config_.opt_cache_dir_;
+  if (cache_root.empty()) {
+    cache_root = inference::analysis::GetDirRoot(config_.prog_file()) +
+                 "/_opt_cache/";
+  }
+  if (!inference::analysis::PathExists(cache_root) &&
+      MKDIR(cache_root.c_str()) == -1) {
+    LOG(WARNING) << "Can not create the optimized program cache directory "
+                 << cache_root << ", the optimized program is not cached.";
+    return "";
+  }
+  return cache_root + "/program_" +
+         std::to_string(std::hash<std::string>()(key.str()));
+}
+
+// Removes a directory of the optimized program cache, which holds the model
+// and params files saved by SaveOptimModel.
+static void RemoveProgramCacheDir(const std::string &dir) {
+  std::remove((dir + "/model").c_str());
+  std::remove((dir + "/params").c_str());
+  std::remove(dir.c_str());
+}
+
+bool AnalysisPredictor::LoadProgramFromCache(const std::string &cache_dir) {
+  if (!inference::analysis::FileExists(cache_dir + "/model")) {
+    return false;
+  }
+  platform::CPUPlace place;
+  framework::Executor exe(place);
+  try {
+    inference_program_ =
+        inference::Load(&exe, scope_.get(), cache_dir + "/model",
+                        cache_dir + "/params", config_.mmap_params_enabled());
+  } catch (std::exception &e) {
+    // Remove the corrupt cache, so that the program optimized again
+    // replaces it.
+    LOG(WARNING) << "Failed to load the optimized program from " << cache_dir
+                 << ", it is optimized again: " << e.what();
+    inference_program_.reset();
+    RemoveProgramCacheDir(cache_dir);
+    return false;
+  }
+  return true;
+}
+
+void AnalysisPredictor::SaveProgramToCache(const std::string &cache_dir) {
+  // Save to a temporary directory first, so that a predictor starting at
+  // the same time never loads a partial cache.
+  std::string tmp_dir =
+      cache_dir + ".tmp" +
+      std::to_string(
+          std::chrono::steady_clock::now().time_since_epoch().count());
+  bool saved = true;
+  try {
+    inference::analysis::MakeDirIfNotExists(tmp_dir);
+    SaveOptimModel(tmp_dir);
+  } catch (std::exception &e) {
+    LOG(WARNING) << "Failed to cache the optimized program: " << e.what();
+    saved = false;
+  }
+  // The rename fails if the program has been cached by another predictor.
+  if (saved && std::rename(tmp_dir.c_str(), cache_dir.c_str()) == 0) {
+    LOG(INFO) << "Save the optimized program to " << cache_dir;
+    return;
+  }
+  RemoveProgramCacheDir(tmp_dir);
+}
+
 uint64_t AnalysisPredictor::TryShrinkMemory() {
   ClearIntermediateTensor();
   return paddle::memory::Release(place_);
 }
 
+static uint64_t TensorBytesInScope(const framework::Scope &scope) {
+  std::unordered_set<const phi::Allocation *> holders;
+  uint64_t bytes = 0;
+  for (auto &name : scope.LocalVarNames()) {
+    auto *var = scope.FindLocalVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) {
+      continue;
+    }
+    auto &holder = var->Get<framework::LoDTensor>().Holder();
+    if (holder && holders.insert(holder.get()).second) {
+      bytes += holder->size();
+    }
+  }
+  return bytes;
+}
+
+uint64_t AnalysisPredictor::GetPrivateMemoryBytes() {
+  return sub_scope_ ? TensorBytesInScope(*sub_scope_) : 0;
+}
+
+uint64_t AnalysisPredictor::GetSharedParamsBytes() {
+  if (frozen_params_) {
+    return frozen_params_->size();
+  }
+  return TensorBytesInScope(*scope_);
+}
+
+OpStatsReport AnalysisPredictor::GetOpStats(bool reset) {
+  if (!op_stats_) {
+    return OpStatsReport();
+  }
+  return op_stats_->Report(reset);
+}
+
+uint64_t AnalysisPredictor::GetWorkspaceBytes() {
+  return executor_ ? executor_->workspace_size() : 0;
+}
+
+uint64_t AnalysisPredictor::GetWorkspaceNaiveBytes() {
+  return executor_ ? executor_->workspace_naive_size() : 0;
+}
+
 void AnalysisPredictor::ClearIntermediateTensor() {
   PADDLE_ENFORCE_NOT_NULL(inference_program_.get(),
                           platform::errors::PreconditionNotMet(
                               "The inference program should be loaded first."));
+  if (status_shared_clone_pending_) {
+    return;
+  }
   const auto &global_block = inference_program_->MutableBlock(0);
   for (auto *var : global_block->AllVars()) {
     if (!IsPersistable(var)) {
@@ -1647,8 +1971,14 @@ AnalysisPredictor::~AnalysisPredictor() {
 std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone() {
   std::lock_guard<std::mutex> lk(clone_mutex_);
   auto *x = new AnalysisPredictor(config_);
-  x->Init(scope_, inference_program_);
-  x->executor_->ResetTrtOps(++AnalysisPredictor::clone_num_);
+  if (config_.shared_params_enabled()) {
+    // The clone creates its sub scope and ops when it is used.
+    x->trt_clone_id_ = ++AnalysisPredictor::clone_num_;
+    x->InitSharedClone(scope_, inference_program_, frozen_params_);
+  } else {
+    x->Init(scope_, inference_program_);
+    x->executor_->ResetTrtOps(++AnalysisPredictor::clone_num_);
+  }
   return std::unique_ptr<PaddlePredictor>(x);
 }
 
@@ -1833,6 +2163,26 @@ void Predictor::ClearIntermediateTensor() {
 
 uint64_t Predictor::TryShrinkMemory() { return predictor_->TryShrinkMemory(); }
 
+uint64_t Predictor::GetPrivateMemoryBytes() {
+  return predictor_->GetPrivateMemoryBytes();
+}
+
+uint64_t Predictor::GetSharedParamsBytes() {
+  return predictor_->GetSharedParamsBytes();
+}
+
+OpStatsReport Predictor::GetOpStats(bool reset) {
+  return predictor_->GetOpStats(reset);
+}
+
+uint64_t Predictor::GetWorkspaceBytes() {
+  return predictor_->GetWorkspaceBytes();
+}
+
+uint64_t Predictor::GetWorkspaceNaiveBytes() {
+  return predictor_->GetWorkspaceNaiveBytes();
+}
+
 int GetNumBytesOfDataType(DataType dtype) {
   switch (dtype) {
     case DataType::FLOAT32:
@@ -1871,6 +2221,13 @@ std::string UpdateDllFlag(const char *name, const char *value) {
   return paddle::UpdateDllFlag(name, value);
 }
 
+void ConvertToMappedParams(const std::string &model_file,
+                           const std::string &params_file,
+                           const std::string &mapped_params_file) {
+  paddle::inference::SaveMappedPersistables(model_file, params_file,
+                                            mapped_params_file);
+}
+
 }  // namespace paddle_infer
 
 namespace paddle_infer {
@@ -28,6 +28,8 @@
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/utils/frozen_params.h"
+#include "paddle/fluid/inference/utils/op_stats.h"
 #include "paddle/fluid/platform/device/gpu/gpu_types.h"
 #include "paddle/fluid/platform/float16.h"
 #include "paddle/fluid/string/printf.h"
@@ -224,6 +226,50 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   uint64_t TryShrinkMemory() override;
 
+  ///
+  /// \brief Get the bytes of the tensors in the sub scope, which are only
+  /// held by this predictor. A clone sharing the parameters holds nothing
+  /// before it is used for the first time.
+  ///
+  /// \return Number of bytes
+  ///
+  uint64_t GetPrivateMemoryBytes() override;
+
+  ///
+  /// \brief Get the bytes of the parameters shared by the clones, that is the
+  /// frozen parameters if AnalysisConfig::EnableSharedParams is set, or the
+  /// tensors in the root scope otherwise.
+  ///
+  /// \return Number of bytes
+  ///
+  uint64_t GetSharedParamsBytes() override;
+
+  ///
+  /// \brief Get the per-operator statistics collected since the last reset,
+  /// if AnalysisConfig::EnableOpStats is set.
+  ///
+  /// \param[in] reset Whether to reset the statistics after reading them.
+  /// \return The statistics, empty if they are not collected.
+  ///
+  OpStatsReport GetOpStats(bool reset) override;
+
+  ///
+  /// \brief Get the size of the workspace planned for the intermediate
+  /// tensors, the peak of the last plan, if
+  /// AnalysisConfig::EnableWorkspaceMemoryOptim is set.
+  ///
+  /// \return Number of bytes
+  ///
+  uint64_t GetWorkspaceBytes() override;
+
+  ///
+  /// \brief Get the memory the intermediate tensors of the workspace would
+  /// take without reuse, at the sizes of the last plan.
+  ///
+  /// \return Number of bytes
+  ///
+  uint64_t GetWorkspaceNaiveBytes() override;
+
   ///
   /// \brief Get the argument used by predictor
   ///
@@ -298,6 +344,40 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool PrepareExecutor();
+  ///
+  /// \brief Initialize a clone which shares the frozen parameters of its
+  /// parent. Only the executor and the feed/fetch information are prepared,
+  /// the rest is left to PrepareSharedClone.
+  ///
+  /// \param[in] parent_scope The scope of the predictor to be cloned
+  /// \param[in] program The program of the predictor to be cloned
+  /// \param[in] frozen_params The parameters frozen by the parent, or null
+  /// \return Whether the function executed successfully
+  ///
+  bool InitSharedClone(
+      const std::shared_ptr<framework::Scope> &parent_scope,
+      const std::shared_ptr<framework::ProgramDesc> &program,
+      const std::shared_ptr<inference::FrozenParamArena> &frozen_params);
+  ///
+  /// \brief Create the sub scope, the intermediate variables and the ops of a
+  /// clone initialized by InitSharedClone, once it is used for the first time.
+  ///
+  void PrepareSharedClone();
+  ///
+  /// \brief Move the parameters into a read-only arena shared by the clones.
+  ///
+  void FreezeParams();
+  ///
+  /// \brief Calibrate the program and quantize the weights of its fc ops to
+  /// INT8, see CpuQuantizerConfig.
+  ///
+  /// \return Whether the function executed successfully
+  ///
+  bool CpuQuantize();
+  ///
+  /// \brief Collect the feed and fetch ops of the program.
+  ///
+  void CollectFeedFetchOps();
 
   ///
   /// \brief Load model program.
@@ -311,6 +391,28 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool LoadParameters();
+  ///
+  /// \brief Get the cache directory of the optimized program, which is
+  /// keyed by the model files, the config and the passes.
+  ///
+  /// \return The directory, or an empty string if the optimized program
+  /// can not be cached.
+  ///
+  std::string GetProgramCacheDir();
+  ///
+  /// \brief Load the optimized program and its parameters from the cache.
+  ///
+  /// \param[in] cache_dir the directory returned by GetProgramCacheDir
+  /// \return Whether the cache is hit. A cache which fails to load is
+  /// removed, so that the program optimized again replaces it.
+  ///
+  bool LoadProgramFromCache(const std::string &cache_dir);
+  ///
+  /// \brief Save the optimized program and its parameters to the cache.
+  ///
+  /// \param[in] cache_dir the directory returned by GetProgramCacheDir
+  ///
+  void SaveProgramToCache(const std::string &cache_dir);
 
   ///
   /// \brief Prepare input data, only used in Run()
@@ -391,6 +493,10 @@ class AnalysisPredictor : public PaddlePredictor {
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, OptimizedProgramCache);
+  FRIEND_TEST(AnalysisPredictor, ShapeCache);
+  FRIEND_TEST(AnalysisPredictor, CpuQuantizer);
+  FRIEND_TEST(AnalysisPredictor, CpuQuantizerCalibration);
 #endif
 
  private:
@@ -459,6 +565,9 @@ class AnalysisPredictor : public PaddlePredictor {
   std::vector<framework::OpDesc *> fetches_;
   std::map<size_t, std::string> idx2fetches_;
 
+  // Helper class to perform the INT8 quantization without MKLDNN.
+  class CpuQuantizer;
+
 #if PADDLE_WITH_MKLDNN
   // Helper class to perform quantization
   class MkldnnQuantizer;
@@ -485,6 +594,18 @@ class AnalysisPredictor : public PaddlePredictor {
  private:
   // Some status here that help to determine the status inside the predictor.
   bool status_is_cloned_{false};
+  // A clone sharing the parameters which has not been used yet.
+  bool status_shared_clone_pending_{false};
+  int trt_clone_id_{0};
+  std::shared_ptr<inference::FrozenParamArena> frozen_params_;
+  // The cache directory of the optimized program, empty if it is not cached.
+  std::string program_cache_dir_;
+  // Whether the optimized program is loaded from the cache, which skips the
+  // optimization.
+  bool program_cache_hit_{false};
+  // Collects the per-operator statistics of executor_, reattached whenever
+  // the executor is prepared again.
+  std::unique_ptr<inference::OpStatsCollector> op_stats_;
 
   std::map<std::string, std::vector<std::vector<int32_t>>> shape_info_;
   static int clone_num_;
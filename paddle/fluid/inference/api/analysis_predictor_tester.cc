@@ -18,14 +18,20 @@
 #endif
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <thread>  // NOLINT
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/inference/analysis/helper.h"
+#include "paddle/fluid/inference/api/cpu_quantizer.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/tests/api/tester_helper.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
+#include "paddle/fluid/inference/utils/mapped_params.h"
 #include "paddle/fluid/platform/cpu_info.h"
 
 DEFINE_string(dirname, "", "dirname to tests.");
@@ -267,6 +273,429 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+TEST(AnalysisPredictor, SharedParamsClone) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableSharedParams();
+  LOG(INFO) << config.Summary();
+
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors;
+  predictors.emplace_back(CreatePaddlePredictor(config));
+  auto* main_predictor = static_cast<AnalysisPredictor*>(predictors[0].get());
+  uint64_t shared_bytes = main_predictor->GetSharedParamsBytes();
+  ASSERT_GT(shared_bytes, 0UL);
+
+  const int num_clones = 3;
+  for (int i = 0; i < num_clones; i++) {
+    predictors.emplace_back(predictors.front()->Clone());
+    // The clone creates nothing until it is used.
+    ASSERT_EQ(predictors.back()->GetPrivateMemoryBytes(), 0UL);
+    ASSERT_EQ(predictors.back()->GetSharedParamsBytes(), shared_bytes);
+  }
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  std::vector<PaddleTensor> main_outputs;
+  ASSERT_TRUE(predictors[0]->Run(inputs, &main_outputs));
+  std::vector<std::thread> threads;
+  for (int i = 1; i <= num_clones; i++) {
+    threads.emplace_back([&predictors, &inputs, &main_outputs, i] {
+      std::vector<PaddleTensor> outputs;
+      for (int j = 0; j < 10; j++) {
+        ASSERT_TRUE(predictors[i]->Run(inputs, &outputs));
+        inference::CompareTensor(outputs.front(), main_outputs.front());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto& predictor : predictors) {
+    LOG(INFO) << "private memory: " << predictor->GetPrivateMemoryBytes()
+              << " bytes, shared params: "
+              << predictor->GetSharedParamsBytes() << " bytes";
+    ASSERT_GT(predictor->GetPrivateMemoryBytes(), 0UL);
+  }
+}
+
+TEST(AnalysisPredictor, OptimizedProgramCache) {
+  // The cache works with a model saved as one program file and one params
+  // file.
+  const std::string model_dir = "./program_cache_test";
+  inference::analysis::MakeDirIfNotExists(model_dir);
+  {
+    AnalysisConfig config;
+    config.SetModel(FLAGS_dirname);
+    config.DisableGpu();
+    config.SwitchIrOptim(false);
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    static_cast<AnalysisPredictor*>(predictor.get())->SaveOptimModel(model_dir);
+  }
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  std::vector<std::vector<PaddleTensor>> outputs(4);
+  std::string cache_dir;
+  for (int i = 0; i < 4; i++) {
+    // The third predictor finds a corrupt cache, optimizes the program again
+    // and replaces the cache, which the fourth one reuses.
+    if (i == 2) {
+      std::ofstream corrupt(cache_dir + "/model",
+                            std::ios::out | std::ios::binary);
+      corrupt << "not a program";
+    }
+    AnalysisConfig config;
+    config.SetModel(model_dir + "/model", model_dir + "/params");
+    config.DisableGpu();
+    config.EnableOptimizedProgramCache();
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    auto* analysis_predictor = static_cast<AnalysisPredictor*>(predictor.get());
+    ASSERT_TRUE(predictor->Run(inputs, &outputs[i]));
+
+    // The first predictor fills the cache and the second one reuses it.
+    if (i == 0) {
+      cache_dir = analysis_predictor->program_cache_dir_;
+      ASSERT_FALSE(cache_dir.empty());
+    } else {
+      ASSERT_EQ(analysis_predictor->program_cache_dir_, cache_dir);
+    }
+    EXPECT_EQ(analysis_predictor->program_cache_hit_, i % 2 == 1);
+    ASSERT_TRUE(inference::analysis::FileExists(cache_dir + "/model"));
+    inference::CompareTensor(outputs[0].front(), outputs[i].front());
+  }
+
+  for (auto& dir : {cache_dir, model_dir}) {
+    std::remove((dir + "/model").c_str());
+    std::remove((dir + "/params").c_str());
+  }
+  std::remove(cache_dir.c_str());
+  std::remove(inference::analysis::GetDirRoot(cache_dir).c_str());
+  std::remove(model_dir.c_str());
+  EXPECT_FALSE(inference::analysis::PathExists(model_dir));
+}
+
+TEST(AnalysisPredictor, MemoryMappedParams) {
+  // SaveOptimModel writes the params in the combined format, which is then
+  // converted to the mapped format.
+  const std::string model_dir = "./mapped_params_test";
+  inference::analysis::MakeDirIfNotExists(model_dir);
+  {
+    AnalysisConfig config;
+    config.SetModel(FLAGS_dirname);
+    config.DisableGpu();
+    config.SwitchIrOptim(false);
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    static_cast<AnalysisPredictor*>(predictor.get())->SaveOptimModel(model_dir);
+  }
+  paddle_infer::ConvertToMappedParams(model_dir + "/model",
+                                      model_dir + "/params",
+                                      model_dir + "/mapped_params");
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // Loads the combined params, then maps them, then maps the converted ones.
+  std::vector<std::vector<PaddleTensor>> outputs(3);
+  for (int i = 0; i < 3; i++) {
+    AnalysisConfig config;
+    config.SetModel(model_dir + "/model",
+                    model_dir + (i < 2 ? "/params" : "/mapped_params"));
+    config.DisableGpu();
+    config.SwitchIrOptim(false);
+    config.EnableMemoryMappedParams(i > 0);
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    ASSERT_TRUE(predictor->Run(inputs, &outputs[i]));
+    inference::CompareTensor(outputs[0].front(), outputs[i].front());
+#ifndef _WIN32
+    if (i < 2) {
+      continue;
+    }
+    // Every parameter of the mapped format is backed by the mapping.
+    auto* scope = static_cast<AnalysisPredictor*>(predictor.get())->scope();
+    int num_params = 0;
+    for (auto& name : scope->LocalVarNames()) {
+      auto* var = scope->FindLocalVar(name);
+      if (!var->IsType<framework::LoDTensor>()) {
+        continue;
+      }
+      auto* file = inference::MappedParamFile::FromTensor(
+          var->Get<framework::LoDTensor>());
+      ASSERT_NE(file, nullptr) << name;
+      EXPECT_TRUE(file->is_mapped_format());
+      EXPECT_EQ(file->num_copied(), 0UL);
+      num_params++;
+    }
+    EXPECT_GT(num_params, 0);
+#endif
+  }
+
+  for (auto& file : {"/model", "/params", "/mapped_params"}) {
+    std::remove((model_dir + file).c_str());
+  }
+  std::remove(model_dir.c_str());
+  EXPECT_FALSE(inference::analysis::PathExists(model_dir));
+}
+
+static std::vector<float> RunWithBatch(PaddlePredictor* predictor,
+                                       int batch) {
+  for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+    auto input = predictor->GetInputTensor(name);
+    input->Reshape({batch, 1});
+    auto* data = input->mutable_data<int64_t>(PaddlePlace::kCPU);
+    for (int i = 0; i < batch; i++) {
+      data[i] = i + batch;
+    }
+  }
+  EXPECT_TRUE(predictor->ZeroCopyRun());
+
+  auto out = predictor->GetOutputTensor("fc_1.tmp_2");
+  PaddlePlace place;
+  int size = 0;
+  auto* out_data = out->data<float>(&place, &size);
+  return std::vector<float>(out_data, out_data + size);
+}
+
+TEST(AnalysisPredictor, ShapeCache) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  AnalysisConfig cache_config(config);
+  cache_config.EnableShapeCache(2);
+  ASSERT_EQ(cache_config.shape_cache_capacity(), 2);
+  auto cache_predictor = CreatePaddlePredictor<AnalysisConfig>(cache_config);
+
+  for (int batch : {4, 2, 4}) {
+    auto expected = RunWithBatch(predictor.get(), batch);
+    auto output = RunWithBatch(cache_predictor.get(), batch);
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t i = 0; i < output.size(); i++) {
+      EXPECT_NEAR(output[i], expected[i], 1e-5);
+    }
+  }
+
+  auto* executor =
+      static_cast<AnalysisPredictor*>(cache_predictor.get())->executor_.get();
+  EXPECT_EQ(executor->shape_cache_misses(), 2UL);
+  EXPECT_EQ(executor->shape_cache_hits(), 1UL);
+}
+
+TEST(AnalysisPredictor, OpStats) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  RunWithBatch(predictor.get(), 2);
+  EXPECT_EQ(predictor->GetOpStats(false).num_runs, 0UL);
+
+  config.EnableOpStats();
+  ASSERT_TRUE(config.op_stats_enabled());
+  predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  for (int batch : {4, 2, 4}) {
+    RunWithBatch(predictor.get(), batch);
+  }
+  auto report = predictor->GetOpStats(true);
+  EXPECT_EQ(report.num_runs, 3UL);
+  ASSERT_FALSE(report.ops.empty());
+  ASSERT_FALSE(report.op_types.empty());
+  for (size_t i = 0; i < report.ops.size(); ++i) {
+    EXPECT_EQ(report.ops[i].count, 3UL);
+    EXPECT_FALSE(report.ops[i].shape_signatures.empty());
+    if (i > 0) {
+      EXPECT_GE(report.ops[i - 1].total_us, report.ops[i].total_us);
+    }
+  }
+  EXPECT_EQ(predictor->GetOpStats(false).num_runs, 0UL);
+}
+
+TEST(AnalysisPredictor, WorkspaceMemoryOptim) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  AnalysisConfig workspace_config(config);
+  workspace_config.EnableWorkspaceMemoryOptim();
+  ASSERT_TRUE(workspace_config.workspace_memory_optim_enabled());
+  auto workspace_predictor =
+      CreatePaddlePredictor<AnalysisConfig>(workspace_config);
+
+  // The larger batch outgrows the workspace planned for the smaller one.
+  for (int batch : {2, 4, 2, 4}) {
+    auto expected = RunWithBatch(predictor.get(), batch);
+    auto output = RunWithBatch(workspace_predictor.get(), batch);
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t i = 0; i < output.size(); i++) {
+      EXPECT_NEAR(output[i], expected[i], 1e-5);
+    }
+  }
+  // The tensors whose lifetimes do not overlap share the memory.
+  EXPECT_GT(workspace_predictor->GetWorkspaceBytes(), 0UL);
+  EXPECT_LT(workspace_predictor->GetWorkspaceBytes(),
+            workspace_predictor->GetWorkspaceNaiveBytes());
+  EXPECT_EQ(predictor->GetWorkspaceBytes(), 0UL);
+}
+
+TEST(AnalysisPredictor, CpuQuantizer) {
+  // 1000 values in the bin 0 and 10 outliers in the bin 2047.
+  std::vector<uint64_t> hist(2048, 0);
+  hist[0] = 1000;
+  hist[2047] = 10;
+  using Quantizer = AnalysisPredictor::CpuQuantizer;
+  EXPECT_FLOAT_EQ(Quantizer::Threshold(hist, 1.f, 2048.f, ScaleAlgo::MAX, 0),
+                  2048.f);
+  EXPECT_FLOAT_EQ(
+      Quantizer::Threshold(hist, 1.f, 2048.f, ScaleAlgo::PERCENTILE, 99.f),
+      1.f);
+  // A Laplacian of scale 64 bins, which KL clips at about 11 scales.
+  for (int i = 0; i < 2048; ++i) {
+    hist[i] = std::llround(1e6 * std::exp(-(i + 0.5) / 64.0));
+  }
+  EXPECT_NEAR(Quantizer::Threshold(hist, 1.f, 2048.f, ScaleAlgo::KL, 0),
+              703.f, 32.f);
+
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  AnalysisConfig int8_config(config);
+  int8_config.EnableCpuQuantizer();
+  int8_config.EnableOpStats();
+  ASSERT_TRUE(int8_config.cpu_quantizer_enabled());
+  int num_read = 0;
+  int8_config.cpu_quantizer_config()->SetCalibrationBatchNum(3);
+  int8_config.cpu_quantizer_config()->SetCalibrationReader(
+      [&](std::vector<PaddleTensor>* inputs) {
+        if (num_read == 5) return false;
+        std::vector<int64_t> words(8);
+        for (int i = 0; i < 8; i++) {
+          words[i] = (num_read * 8 + i) % 1000;
+        }
+        for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+          PaddleTensor tensor;
+          tensor.name = name;
+          tensor.shape = {8, 1};
+          tensor.dtype = PaddleDType::INT64;
+          tensor.data.Resize(words.size() * sizeof(int64_t));
+          memcpy(tensor.data.data(), words.data(), tensor.data.length());
+          inputs->push_back(std::move(tensor));
+        }
+        num_read++;
+        return true;
+      });
+  auto int8_predictor = CreatePaddlePredictor<AnalysisConfig>(int8_config);
+  ASSERT_NE(int8_predictor, nullptr);
+  EXPECT_EQ(num_read, 3);
+  // The calibration runs are not counted.
+  EXPECT_EQ(int8_predictor->GetOpStats(false).num_runs, 0UL);
+
+  auto* analysis_predictor =
+      static_cast<AnalysisPredictor*>(int8_predictor.get());
+  int num_int8_fc = 0;
+  for (auto* op : analysis_predictor->inference_program_->Block(0).AllOps()) {
+    if (op->Type() != "fc") continue;
+    auto& w = analysis_predictor->scope_->FindVar(op->Input("W")[0])
+                  ->Get<framework::LoDTensor>();
+    if (framework::TransToProtoVarType(w.dtype()) ==
+        framework::proto::VarType::INT8) {
+      num_int8_fc++;
+      EXPECT_GT(BOOST_GET_CONST(float, op->GetAttr("Scale_in")), 0.f);
+      auto scales =
+          BOOST_GET_CONST(std::vector<float>, op->GetAttr("Scale_weights"));
+      EXPECT_EQ(scales.size(), static_cast<size_t>(w.dims()[1]));
+    }
+  }
+  EXPECT_GT(num_int8_fc, 0);
+
+  for (int batch : {1, 4}) {
+    auto expected = RunWithBatch(predictor.get(), batch);
+    auto output = RunWithBatch(int8_predictor.get(), batch);
+    ASSERT_EQ(output.size(), expected.size());
+    for (size_t i = 0; i < output.size(); i++) {
+      EXPECT_NEAR(output[i], expected[i], 0.05);
+    }
+  }
+}
+
+TEST(AnalysisPredictor, CpuQuantizerCalibration) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* analysis_predictor = static_cast<AnalysisPredictor*>(predictor.get());
+
+  // Two batches feeding the words 0 to 15 to every input.
+  int num_read = 0;
+  CpuQuantizerConfig qconfig;
+  qconfig.SetCalibrationBatchNum(2);
+  qconfig.SetCalibrationReader([&](std::vector<PaddleTensor>* inputs) {
+    std::vector<int64_t> words(8);
+    for (int i = 0; i < 8; i++) {
+      words[i] = num_read * 8 + i;
+    }
+    for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+      PaddleTensor tensor;
+      tensor.name = name;
+      tensor.shape = {8, 1};
+      tensor.dtype = PaddleDType::INT64;
+      tensor.data.Resize(words.size() * sizeof(int64_t));
+      memcpy(tensor.data.data(), words.data(), tensor.data.length());
+      inputs->push_back(std::move(tensor));
+    }
+    num_read++;
+    return true;
+  });
+  AnalysisPredictor::CpuQuantizer quantizer(*analysis_predictor, &qconfig);
+  quantizer.CollectFcOps();
+  ASSERT_FALSE(quantizer.fc_ops_.empty());
+  ASSERT_NE(quantizer.fc_ops_[0], nullptr);
+  ASSERT_TRUE(quantizer.ReadCalibrationData());
+  quantizer.stats_.resize(quantizer.fc_ops_.size());
+  ASSERT_TRUE(quantizer.Calibrate(false));
+
+  // The first fc takes the concatenated embeddings of the words, so the max
+  // absolute value of its input is the one of the first 16 embeddings.
+  std::string table;
+  for (auto* op : analysis_predictor->inference_program_->Block(0).AllOps()) {
+    if (op->Type() == "lookup_table" || op->Type() == "lookup_table_v2") {
+      table = op->Input("W")[0];
+      break;
+    }
+  }
+  ASSERT_FALSE(table.empty());
+  auto& embeddings =
+      analysis_predictor->scope_->FindVar(table)->Get<framework::LoDTensor>();
+  const float* data = embeddings.data<float>();
+  float max_abs = 0.f;
+  for (int64_t i = 0; i < 16 * embeddings.dims()[1]; i++) {
+    max_abs = std::max(max_abs, std::abs(data[i]));
+  }
+  EXPECT_GT(max_abs, 0.f);
+  EXPECT_FLOAT_EQ(quantizer.stats_[0].max_abs, max_abs);
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
@@ -0,0 +1,714 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_batching_predictor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/os_info.h"
+
+namespace paddle_infer {
+namespace services {
+
+using paddle::PaddleBuf;
+using paddle::PaddleTensor;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct BatchingRequest {
+  // Ordered as the inputs of the model.
+  std::vector<PaddleTensor> inputs;
+  int batch_size{0};
+  int length{0};
+  size_t bucket{0};
+  Clock::time_point submit_time;
+  std::promise<std::vector<PaddleTensor>> promise;
+};
+
+size_t NumelFrom(const std::vector<int>& shape, size_t begin) {
+  size_t numel = 1;
+  for (size_t i = begin; i < shape.size(); ++i) {
+    numel *= shape[i];
+  }
+  return numel;
+}
+
+std::string ShapeToString(const std::vector<int>& shape) {
+  std::string str;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    str += (i == 0 ? "" : ", ") + std::to_string(shape[i]);
+  }
+  return str;
+}
+
+size_t DataTypeSize(DataType dtype) {
+  switch (dtype) {
+    case DataType::FLOAT32:
+      return sizeof(float);
+    case DataType::INT64:
+      return sizeof(int64_t);
+    case DataType::INT32:
+      return sizeof(int32_t);
+    case DataType::UINT8:
+      return sizeof(uint8_t);
+    case DataType::INT8:
+      return sizeof(int8_t);
+    default:
+      PADDLE_THROW(paddle::platform::errors::Unimplemented(
+          "BatchingPredictor does not support the data type %d.",
+          static_cast<int>(dtype)));
+  }
+}
+
+int BatchSizeOf(const PaddleTensor& tensor) {
+  if (!tensor.lod.empty()) {
+    return static_cast<int>(tensor.lod[0].size()) - 1;
+  }
+  return tensor.shape.empty() ? 0 : tensor.shape[0];
+}
+
+// The longest sequence of the last LoD level, or dim 1 of a dense tensor.
+int SequenceLengthOf(const PaddleTensor& tensor) {
+  if (!tensor.lod.empty()) {
+    const auto& level = tensor.lod.back();
+    size_t length = 0;
+    for (size_t i = 1; i < level.size(); ++i) {
+      length = std::max(length, level[i] - level[i - 1]);
+    }
+    return static_cast<int>(length);
+  }
+  return tensor.shape.size() > 1 ? tensor.shape[1] : 1;
+}
+
+// Requests can be merged if their inputs have the same types, ranks and
+// LoD levels, and their inputs with LoD, which are not padded, the same
+// non-batch dims.
+bool CanMerge(const BatchingRequest& a, const BatchingRequest& b) {
+  for (size_t i = 0; i < a.inputs.size(); ++i) {
+    const PaddleTensor& x = a.inputs[i];
+    const PaddleTensor& y = b.inputs[i];
+    if (x.dtype != y.dtype || x.shape.size() != y.shape.size() ||
+        x.lod.size() != y.lod.size()) {
+      return false;
+    }
+    if (!x.lod.empty() && !x.shape.empty() &&
+        !std::equal(x.shape.begin() + 1, x.shape.end(), y.shape.begin() + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void FillWith(void* data, size_t numel, float value) {
+  std::fill_n(static_cast<T*>(data), numel, static_cast<T>(value));
+}
+
+void FillBuffer(PaddleBuf* buf, DataType dtype, float value) {
+  size_t numel = buf->length() / DataTypeSize(dtype);
+  switch (dtype) {
+    case DataType::FLOAT32:
+      FillWith<float>(buf->data(), numel, value);
+      break;
+    case DataType::INT64:
+      FillWith<int64_t>(buf->data(), numel, value);
+      break;
+    case DataType::INT32:
+      FillWith<int32_t>(buf->data(), numel, value);
+      break;
+    case DataType::UINT8:
+      FillWith<uint8_t>(buf->data(), numel, value);
+      break;
+    case DataType::INT8:
+      FillWith<int8_t>(buf->data(), numel, value);
+      break;
+    default:
+      break;
+  }
+}
+
+// Copies a tensor of src_shape into the leading corner of a tensor whose
+// non-batch dims are dst_shape[1:].
+void CopyPadded(const char* src, const std::vector<int>& src_shape, char* dst,
+                const std::vector<int>& dst_shape, size_t dim,
+                size_t elem_size) {
+  if (dim + 1 == src_shape.size()) {
+    std::memcpy(dst, src, src_shape[dim] * elem_size);
+    return;
+  }
+  size_t src_stride = NumelFrom(src_shape, dim + 1) * elem_size;
+  size_t dst_stride = NumelFrom(dst_shape, dim + 1) * elem_size;
+  for (int i = 0; i < src_shape[dim]; ++i) {
+    CopyPadded(src + i * src_stride, src_shape, dst + i * dst_stride,
+               dst_shape, dim + 1, elem_size);
+  }
+}
+
+// Concatenates the idx-th inputs of the batch along the batch dimension.
+// Inputs with LoD keep their sequences and get the merged LoD, dense inputs
+// are padded to the largest non-batch dims, and dim 1 is padded to at least
+// pad_length.
+PaddleTensor MergeInputs(
+    const std::vector<std::unique_ptr<BatchingRequest>>& batch, size_t idx,
+    float pad_value, int pad_length) {
+  const PaddleTensor& first = batch.front()->inputs[idx];
+  size_t elem_size = DataTypeSize(first.dtype);
+  PaddleTensor merged;
+  merged.name = first.name;
+  merged.dtype = first.dtype;
+  merged.shape = first.shape;
+  merged.shape[0] = 0;
+  merged.lod.assign(first.lod.size(), std::vector<size_t>(1, 0));
+  if (first.lod.empty() && merged.shape.size() > 1) {
+    merged.shape[1] = std::max(merged.shape[1], pad_length);
+  }
+
+  bool need_pad = false;
+  for (auto& request : batch) {
+    const PaddleTensor& tensor = request->inputs[idx];
+    merged.shape[0] += tensor.shape[0];
+    for (size_t d = 1; d < tensor.shape.size(); ++d) {
+      if (tensor.shape[d] != merged.shape[d]) {
+        PADDLE_ENFORCE_EQ(
+            first.lod.empty(), true,
+            paddle::platform::errors::InvalidArgument(
+                "The inputs %s with LoD can only be merged if their non-batch "
+                "dims are equal, but got [%s] and [%s].",
+                first.name, ShapeToString(first.shape),
+                ShapeToString(tensor.shape)));
+        need_pad = true;
+        merged.shape[d] = std::max(merged.shape[d], tensor.shape[d]);
+      }
+    }
+    for (size_t level = 0; level < tensor.lod.size(); ++level) {
+      auto& merged_level = merged.lod[level];
+      size_t base = merged_level.back();
+      for (size_t i = 1; i < tensor.lod[level].size(); ++i) {
+        merged_level.push_back(base + tensor.lod[level][i] -
+                               tensor.lod[level][0]);
+      }
+    }
+  }
+
+  merged.data.Resize(NumelFrom(merged.shape, 0) * elem_size);
+  if (need_pad) {
+    FillBuffer(&merged.data, merged.dtype, pad_value);
+  }
+  size_t dst_row_bytes = NumelFrom(merged.shape, 1) * elem_size;
+  char* dst = static_cast<char*>(merged.data.data());
+  for (auto& request : batch) {
+    const PaddleTensor& tensor = request->inputs[idx];
+    const char* src = static_cast<const char*>(tensor.data.data());
+    if (need_pad) {
+      CopyPadded(src, tensor.shape, dst, merged.shape, 0, elem_size);
+    } else {
+      std::memcpy(dst, src, tensor.shape[0] * dst_row_bytes);
+    }
+    dst += tensor.shape[0] * dst_row_bytes;
+  }
+  return merged;
+}
+
+// Takes the samples [begin, end) of the batch output. The samples are rows
+// for outputs without LoD, and sequences of the first LoD level otherwise.
+PaddleTensor SliceOutput(const PaddleTensor& output, size_t begin,
+                         size_t end) {
+  PaddleTensor slice;
+  slice.name = output.name;
+  slice.dtype = output.dtype;
+  slice.shape = output.shape;
+  for (auto& level : output.lod) {
+    std::vector<size_t> sub_level;
+    for (size_t i = begin; i <= end; ++i) {
+      sub_level.push_back(level[i] - level[begin]);
+    }
+    slice.lod.push_back(std::move(sub_level));
+    size_t next_begin = level[begin];
+    end = level[end];
+    begin = next_begin;
+  }
+  size_t row_bytes = NumelFrom(output.shape, 1) * DataTypeSize(output.dtype);
+  slice.shape[0] = static_cast<int>(end - begin);
+  slice.data.Resize(slice.shape[0] * row_bytes);
+  if (slice.data.length() > 0) {
+    std::memcpy(slice.data.data(),
+                static_cast<const char*>(output.data.data()) +
+                    begin * row_bytes,
+                slice.data.length());
+  }
+  return slice;
+}
+
+void FeedInput(const PaddleTensor& input, Tensor* handle) {
+  handle->Reshape(input.shape);
+  switch (input.dtype) {
+    case DataType::FLOAT32:
+      handle->CopyFromCpu(static_cast<const float*>(input.data.data()));
+      break;
+    case DataType::INT64:
+      handle->CopyFromCpu(static_cast<const int64_t*>(input.data.data()));
+      break;
+    case DataType::INT32:
+      handle->CopyFromCpu(static_cast<const int32_t*>(input.data.data()));
+      break;
+    case DataType::UINT8:
+      handle->CopyFromCpu(static_cast<const uint8_t*>(input.data.data()));
+      break;
+    case DataType::INT8:
+      handle->CopyFromCpu(static_cast<const int8_t*>(input.data.data()));
+      break;
+    default:
+      break;
+  }
+  if (!input.lod.empty()) {
+    handle->SetLoD(input.lod);
+  }
+}
+
+PaddleTensor FetchOutput(const std::string& name, const Tensor& handle) {
+  PaddleTensor output;
+  output.name = name;
+  output.shape = handle.shape();
+  output.dtype = handle.type();
+  output.lod = handle.lod();
+  output.data.Resize(NumelFrom(output.shape, 0) * DataTypeSize(output.dtype));
+  switch (output.dtype) {
+    case DataType::FLOAT32:
+      handle.CopyToCpu(static_cast<float*>(output.data.data()));
+      break;
+    case DataType::INT64:
+      handle.CopyToCpu(static_cast<int64_t*>(output.data.data()));
+      break;
+    case DataType::INT32:
+      handle.CopyToCpu(static_cast<int32_t*>(output.data.data()));
+      break;
+    case DataType::UINT8:
+      handle.CopyToCpu(static_cast<uint8_t*>(output.data.data()));
+      break;
+    case DataType::INT8:
+      handle.CopyToCpu(static_cast<int8_t*>(output.data.data()));
+      break;
+    default:
+      break;
+  }
+  return output;
+}
+
+}  // namespace
+
+struct BatchingPredictor::Impl {
+  explicit Impl(size_t num_buckets)
+      : queues(num_buckets), queued_samples(num_buckets, 0) {}
+
+  std::unique_ptr<BatchingRequest> MakeRequest(
+      std::vector<PaddleTensor> inputs) const;
+  size_t PickBucket() const;
+  void WorkerLoop(Predictor* predictor);
+  void FeedBatch(Predictor* predictor,
+                 const std::vector<std::unique_ptr<BatchingRequest>>& batch);
+  void RunBatch(Predictor* predictor,
+                std::vector<std::unique_ptr<BatchingRequest>>* batch);
+  void Warmup(Predictor* predictor);
+
+  BatchingOptions options;
+  std::vector<std::string> input_names;
+  std::vector<std::string> output_names;
+  // Whether the length of a request is taken from the input, and dim 1 of
+  // the input is padded to the bucket bound.
+  std::vector<bool> is_length_input;
+  std::vector<std::unique_ptr<Predictor>> predictors;
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  // One queue per length bucket.
+  std::vector<std::deque<std::unique_ptr<BatchingRequest>>> queues;
+  std::vector<int> queued_samples;
+  size_t num_queued{0};
+  bool stop{false};
+
+  std::atomic<uint64_t> num_requests{0};
+  std::atomic<uint64_t> num_batches{0};
+  std::atomic<uint64_t> num_samples{0};
+  std::atomic<uint64_t> num_dense_elements{0};
+  std::atomic<uint64_t> num_padding_elements{0};
+};
+
+std::unique_ptr<BatchingRequest> BatchingPredictor::Impl::MakeRequest(
+    std::vector<PaddleTensor> inputs) const {
+  PADDLE_ENFORCE_EQ(inputs.size(), input_names.size(),
+                    paddle::platform::errors::InvalidArgument(
+                        "The model has %d inputs, but the request has %d.",
+                        input_names.size(), inputs.size()));
+  std::unique_ptr<BatchingRequest> request(new BatchingRequest);
+  bool by_name = std::all_of(
+      inputs.begin(), inputs.end(),
+      [](const PaddleTensor& tensor) { return !tensor.name.empty(); });
+  request->inputs.resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    size_t idx = i;
+    if (by_name) {
+      idx = std::find(input_names.begin(), input_names.end(),
+                      inputs[i].name) -
+            input_names.begin();
+      PADDLE_ENFORCE_LT(idx, input_names.size(),
+                        paddle::platform::errors::NotFound(
+                            "The model has no input named %s.",
+                            inputs[i].name));
+    }
+    PaddleTensor& input = inputs[i];
+    // Throws for the data types which can not be merged.
+    DataTypeSize(input.dtype);
+    PADDLE_ENFORCE_GT(input.shape.size(), 0UL,
+                      paddle::platform::errors::InvalidArgument(
+                          "The input %s is of rank 0, but the requests are "
+                          "merged along dim 0.",
+                          input_names[idx]));
+    int batch_size = BatchSizeOf(input);
+    PADDLE_ENFORCE_GT(batch_size, 0,
+                      paddle::platform::errors::InvalidArgument(
+                          "The input %s has no samples.", input_names[idx]));
+    PADDLE_ENFORCE_EQ(
+        request->batch_size == 0 || request->batch_size == batch_size, true,
+        paddle::platform::errors::InvalidArgument(
+            "The inputs of a request should have the same batch size, but "
+            "the input %s has %d samples and the others have %d.",
+            input_names[idx], batch_size, request->batch_size));
+    request->batch_size = batch_size;
+    if (is_length_input[idx]) {
+      request->length = std::max(request->length, SequenceLengthOf(input));
+    }
+    input.name = input_names[idx];
+    request->inputs[idx] = std::move(input);
+  }
+  const auto& bounds = options.length_buckets;
+  request->bucket =
+      std::lower_bound(bounds.begin(), bounds.end(), request->length) -
+      bounds.begin();
+  return request;
+}
+
+// Picks a full bucket if there is one, or else the bucket whose first
+// request has waited the longest.
+size_t BatchingPredictor::Impl::PickBucket() const {
+  size_t picked = queues.size();
+  for (size_t b = 0; b < queues.size(); ++b) {
+    if (queues[b].empty()) {
+      continue;
+    }
+    if (queued_samples[b] >= options.max_batch_size) {
+      return b;
+    }
+    if (picked == queues.size() ||
+        queues[b].front()->submit_time < queues[picked].front()->submit_time) {
+      picked = b;
+    }
+  }
+  return picked;
+}
+
+void BatchingPredictor::Impl::WorkerLoop(Predictor* predictor) {
+  paddle::platform::SetCurrentThreadName("BatchingPredictor");
+  auto timeout = std::chrono::microseconds(options.batch_timeout_us);
+  while (true) {
+    std::vector<std::unique_ptr<BatchingRequest>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this] { return stop || num_queued > 0; });
+      if (num_queued == 0) {
+        return;
+      }
+      // Wait for more requests until a bucket is full or the first request
+      // of a bucket has waited for batch_timeout_us.
+      size_t bucket = PickBucket();
+      while (!stop && queued_samples[bucket] < options.max_batch_size) {
+        auto deadline = queues[bucket].front()->submit_time + timeout;
+        bool timed_out =
+            cv.wait_until(lock, deadline) == std::cv_status::timeout;
+        if (num_queued == 0) {
+          break;
+        }
+        bucket = PickBucket();
+        if (timed_out) {
+          break;
+        }
+      }
+      if (num_queued == 0) {
+        continue;
+      }
+      auto& queue = queues[bucket];
+      int batch_size = 0;
+      while (!queue.empty()) {
+        auto& request = queue.front();
+        if (!batch.empty() &&
+            (batch_size + request->batch_size > options.max_batch_size ||
+             !CanMerge(*batch.front(), *request))) {
+          break;
+        }
+        batch_size += request->batch_size;
+        queued_samples[bucket] -= request->batch_size;
+        --num_queued;
+        batch.push_back(std::move(request));
+        queue.pop_front();
+      }
+      if (num_queued > 0) {
+        cv.notify_one();
+      }
+    }
+    RunBatch(predictor, &batch);
+  }
+}
+
+void BatchingPredictor::Impl::FeedBatch(
+    Predictor* predictor,
+    const std::vector<std::unique_ptr<BatchingRequest>>& batch) {
+  size_t bucket = batch.front()->bucket;
+  int pad_length = 0;
+  if (options.pad_to_bucket && bucket < options.length_buckets.size()) {
+    pad_length = options.length_buckets[bucket];
+  }
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    PaddleTensor merged = MergeInputs(batch, i, options.pad_value,
+                                      is_length_input[i] ? pad_length : 0);
+    if (merged.lod.empty()) {
+      size_t elem_size = DataTypeSize(merged.dtype);
+      size_t numel = merged.data.length() / elem_size;
+      size_t real_numel = 0;
+      for (auto& request : batch) {
+        real_numel += request->inputs[i].data.length() / elem_size;
+      }
+      num_dense_elements.fetch_add(numel, std::memory_order_relaxed);
+      num_padding_elements.fetch_add(numel - real_numel,
+                                     std::memory_order_relaxed);
+    }
+    FeedInput(merged, predictor->GetInputHandle(input_names[i]).get());
+  }
+}
+
+void BatchingPredictor::Impl::RunBatch(
+    Predictor* predictor,
+    std::vector<std::unique_ptr<BatchingRequest>>* batch) {
+  size_t total = 0;
+  for (auto& request : *batch) {
+    total += request->batch_size;
+  }
+  VLOG(4) << "BatchingPredictor runs " << batch->size()
+          << " requests of bucket " << batch->front()->bucket
+          << " with batch size " << total;
+  num_batches.fetch_add(1, std::memory_order_relaxed);
+  num_samples.fetch_add(total, std::memory_order_relaxed);
+
+  std::vector<std::vector<PaddleTensor>> results(batch->size());
+  try {
+    FeedBatch(predictor, *batch);
+    PADDLE_ENFORCE_EQ(predictor->Run(), true,
+                      paddle::platform::errors::Fatal(
+                          "Failed to run the batch of %d samples.", total));
+    for (auto& name : output_names) {
+      PaddleTensor output =
+          FetchOutput(name, *predictor->GetOutputHandle(name));
+      if (batch->size() == 1) {
+        results[0].push_back(std::move(output));
+        continue;
+      }
+      bool split_by_lod =
+          !output.lod.empty() && output.lod[0].size() == total + 1;
+      PADDLE_ENFORCE_EQ(
+          split_by_lod || (!output.shape.empty() &&
+                           static_cast<size_t>(output.shape[0]) == total),
+          true,
+          paddle::platform::errors::Unimplemented(
+              "The output %s of shape [%s] has no batch dimension of size %d, "
+              "so it can not be split into requests.",
+              name, ShapeToString(output.shape), total));
+      if (!split_by_lod) {
+        output.lod.clear();
+      }
+      size_t begin = 0;
+      for (size_t r = 0; r < batch->size(); ++r) {
+        size_t end = begin + (*batch)[r]->batch_size;
+        results[r].push_back(SliceOutput(output, begin, end));
+        begin = end;
+      }
+    }
+  } catch (...) {
+    for (auto& request : *batch) {
+      request->promise.set_exception(std::current_exception());
+    }
+    return;
+  }
+  for (size_t r = 0; r < batch->size(); ++r) {
+    (*batch)[r]->promise.set_value(std::move(results[r]));
+  }
+}
+
+void BatchingPredictor::Impl::Warmup(Predictor* predictor) {
+  for (auto& inputs : options.warmup_requests) {
+    std::vector<std::unique_ptr<BatchingRequest>> batch;
+    int batch_size = 0;
+    do {
+      batch.push_back(MakeRequest(inputs));
+      batch_size += batch.back()->batch_size;
+    } while (batch_size + batch.back()->batch_size <= options.max_batch_size);
+    FeedBatch(predictor, batch);
+    PADDLE_ENFORCE_EQ(predictor->Run(), true,
+                      paddle::platform::errors::Fatal(
+                          "Failed to run the warmup batch of %d samples.",
+                          batch_size));
+  }
+}
+
+BatchingPredictor::BatchingPredictor(const Config& config,
+                                     const BatchingOptions& options)
+    : impl_(new Impl(options.length_buckets.size() + 1)) {
+  PADDLE_ENFORCE_GE(options.max_batch_size, 1,
+                    paddle::platform::errors::InvalidArgument(
+                        "The max_batch_size of BatchingPredictor should be at "
+                        "least 1, but got %d.",
+                        options.max_batch_size));
+  PADDLE_ENFORCE_GE(options.num_workers, 1,
+                    paddle::platform::errors::InvalidArgument(
+                        "The num_workers of BatchingPredictor should be at "
+                        "least 1, but got %d.",
+                        options.num_workers));
+  PADDLE_ENFORCE_GE(options.batch_timeout_us, 0,
+                    paddle::platform::errors::InvalidArgument(
+                        "The batch_timeout_us of BatchingPredictor should not "
+                        "be negative, but got %d.",
+                        options.batch_timeout_us));
+  PADDLE_ENFORCE_EQ(std::is_sorted(options.length_buckets.begin(),
+                                   options.length_buckets.end()),
+                    true,
+                    paddle::platform::errors::InvalidArgument(
+                        "The length_buckets of BatchingPredictor should be in "
+                        "ascending order."));
+  impl_->options = options;
+  impl_->predictors.emplace_back(new Predictor(config));
+  for (int i = 1; i < options.num_workers; ++i) {
+    if (config.tensorrt_engine_enabled()) {
+      Config config_tmp(config);
+      impl_->predictors.emplace_back(new Predictor(config_tmp));
+    } else {
+      impl_->predictors.push_back(impl_->predictors.front()->Clone());
+    }
+  }
+  impl_->input_names = impl_->predictors.front()->GetInputNames();
+  impl_->output_names = impl_->predictors.front()->GetOutputNames();
+  const auto& input_names = impl_->input_names;
+  impl_->is_length_input.assign(input_names.size(),
+                                options.length_inputs.empty());
+  for (auto& name : options.length_inputs) {
+    size_t idx = std::find(input_names.begin(), input_names.end(), name) -
+                 input_names.begin();
+    PADDLE_ENFORCE_LT(idx, input_names.size(),
+                      paddle::platform::errors::NotFound(
+                          "The length input %s of BatchingPredictor is not an "
+                          "input of the model.",
+                          name));
+    impl_->is_length_input[idx] = true;
+  }
+  for (auto& predictor : impl_->predictors) {
+    impl_->Warmup(predictor.get());
+  }
+  // The stats only count the requests.
+  impl_->num_dense_elements = 0;
+  impl_->num_padding_elements = 0;
+  for (auto& predictor : impl_->predictors) {
+    Impl* impl = impl_.get();
+    Predictor* pred = predictor.get();
+    impl_->workers.emplace_back([impl, pred] { impl->WorkerLoop(pred); });
+  }
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> guard(impl_->mutex);
+    impl_->stop = true;
+  }
+  impl_->cv.notify_all();
+  for (auto& worker : impl_->workers) {
+    worker.join();
+  }
+}
+
+std::future<std::vector<PaddleTensor>> BatchingPredictor::Submit(
+    std::vector<PaddleTensor> inputs) {
+  auto request = impl_->MakeRequest(std::move(inputs));
+  auto future = request->promise.get_future();
+  impl_->num_requests.fetch_add(1, std::memory_order_relaxed);
+  bool full = false;
+  {
+    std::lock_guard<std::mutex> guard(impl_->mutex);
+    PADDLE_ENFORCE_EQ(impl_->stop, false,
+                      paddle::platform::errors::PreconditionNotMet(
+                          "BatchingPredictor has been destroyed."));
+    request->submit_time = Clock::now();
+    size_t bucket = request->bucket;
+    impl_->queued_samples[bucket] += request->batch_size;
+    full = impl_->queued_samples[bucket] >= impl_->options.max_batch_size;
+    impl_->queues[bucket].push_back(std::move(request));
+    ++impl_->num_queued;
+  }
+  if (full) {
+    impl_->cv.notify_all();
+  } else {
+    impl_->cv.notify_one();
+  }
+  return future;
+}
+
+bool BatchingPredictor::Run(const std::vector<PaddleTensor>& inputs,
+                            std::vector<PaddleTensor>* outputs) {
+  try {
+    *outputs = Submit(inputs).get();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "BatchingPredictor failed to run the request: " << e.what();
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string> BatchingPredictor::GetInputNames() const {
+  return impl_->input_names;
+}
+
+std::vector<std::string> BatchingPredictor::GetOutputNames() const {
+  return impl_->output_names;
+}
+
+BatchingStats BatchingPredictor::GetStats() const {
+  BatchingStats stats;
+  stats.num_requests = impl_->num_requests.load(std::memory_order_relaxed);
+  stats.num_batches = impl_->num_batches.load(std::memory_order_relaxed);
+  stats.num_samples = impl_->num_samples.load(std::memory_order_relaxed);
+  stats.num_dense_elements =
+      impl_->num_dense_elements.load(std::memory_order_relaxed);
+  stats.num_padding_elements =
+      impl_->num_padding_elements.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace services
+}  // namespace paddle_infer
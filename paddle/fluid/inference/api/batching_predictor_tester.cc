@@ -0,0 +1,328 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/inference/api/paddle_batching_predictor.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_string(dirname, "", "dirname to tests.");
+DEFINE_double(poisson_qps, 400, "mean arrival rate of the benchmark requests");
+DEFINE_int32(poisson_requests, 2000, "number of the benchmark requests");
+DEFINE_int32(poisson_clients, 32, "number of the benchmark client threads");
+DEFINE_int32(max_batch_size, 16, "max batch size of BatchingPredictor");
+DEFINE_int32(batch_timeout_us, 2000, "batch timeout of BatchingPredictor");
+DEFINE_bool(run_poisson_benchmark, false,
+            "run the Poisson load benchmark, which takes several seconds");
+
+namespace paddle_infer {
+namespace services {
+
+using paddle::PaddleTensor;
+
+static void SetConfig(Config* config) {
+  config->SetModel(FLAGS_dirname);
+  config->DisableGpu();
+  config->SetCpuMathLibraryNumThreads(1);
+}
+
+// The word2vec model has four int64 inputs of shape [N, 1].
+static std::vector<PaddleTensor> MakeInputs(std::vector<int64_t>* words,
+                                            bool with_lod) {
+  std::vector<PaddleTensor> inputs(4);
+  int batch_size = static_cast<int>(words->size() / 4);
+  for (int i = 0; i < 4; ++i) {
+    inputs[i].shape = {batch_size, 1};
+    inputs[i].dtype = DataType::INT64;
+    inputs[i].data.Reset(words->data() + i * batch_size,
+                         batch_size * sizeof(int64_t));
+    if (with_lod) {
+      std::vector<size_t> level;
+      for (int j = 0; j <= batch_size; ++j) {
+        level.push_back(j);
+      }
+      inputs[i].lod.push_back(level);
+    }
+  }
+  return inputs;
+}
+
+static std::vector<float> RunDirectly(Predictor* predictor,
+                                      const std::vector<int64_t>& words) {
+  auto names = predictor->GetInputNames();
+  int batch_size = static_cast<int>(words.size() / 4);
+  for (int i = 0; i < 4; ++i) {
+    auto input = predictor->GetInputHandle(names[i]);
+    input->Reshape({batch_size, 1});
+    input->CopyFromCpu(words.data() + i * batch_size);
+  }
+  CHECK(predictor->Run());
+  auto output = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+  auto shape = output->shape();
+  std::vector<float> out_data(std::accumulate(
+      shape.begin(), shape.end(), 1, std::multiplies<int>()));
+  output->CopyToCpu(out_data.data());
+  return out_data;
+}
+
+static void ExpectNear(const PaddleTensor& tensor,
+                       const std::vector<float>& expected) {
+  ASSERT_EQ(tensor.data.length(), expected.size() * sizeof(float));
+  const float* data = static_cast<const float*>(tensor.data.data());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(data[i], expected[i], 1e-5);
+  }
+}
+
+static void TestMergeAndScatter(bool with_lod) {
+  Config config;
+  SetConfig(&config);
+  auto predictor = CreatePredictor(config);
+  BatchingOptions options;
+  options.max_batch_size = 4;
+  options.batch_timeout_us = 1000 * 1000;
+  BatchingPredictor batching_predictor(config, options);
+
+  std::vector<std::vector<int64_t>> words = {
+      {1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12, 13, 14, 15, 16}};
+  std::vector<std::future<std::vector<PaddleTensor>>> futures;
+  for (auto& request_words : words) {
+    futures.push_back(
+        batching_predictor.Submit(MakeInputs(&request_words, with_lod)));
+  }
+  for (size_t i = 0; i < words.size(); ++i) {
+    auto outputs = futures[i].get();
+    ASSERT_EQ(outputs.size(), 1UL);
+    EXPECT_EQ(outputs[0].shape[0], static_cast<int>(words[i].size() / 4));
+    ExpectNear(outputs[0], RunDirectly(predictor.get(), words[i]));
+  }
+  auto stats = batching_predictor.GetStats();
+  EXPECT_EQ(stats.num_requests, 3UL);
+  EXPECT_EQ(stats.num_batches, 1UL);
+  EXPECT_EQ(stats.num_samples, 4UL);
+}
+
+TEST(BatchingPredictor, merge_and_scatter) { TestMergeAndScatter(false); }
+
+TEST(BatchingPredictor, merge_and_scatter_lod) { TestMergeAndScatter(true); }
+
+TEST(BatchingPredictor, lod_dims_mismatch) {
+  Config config;
+  SetConfig(&config);
+  auto predictor = CreatePredictor(config);
+  BatchingOptions options;
+  options.max_batch_size = 4;
+  options.batch_timeout_us = 100 * 1000;
+  BatchingPredictor batching_predictor(config, options);
+
+  // The inputs with LoD are not padded, so the second request, whose inputs
+  // are of shape [1, 2], runs in its own batch. It fails on the ids of the
+  // embeddings, which must be of width 1, and does not fail the first.
+  std::vector<int64_t> words = {1, 2, 3, 4};
+  std::vector<int64_t> wide_words = {5, 6, 7, 8, 9, 10, 11, 12};
+  auto wide_inputs = MakeInputs(&wide_words, true);
+  for (auto& input : wide_inputs) {
+    input.shape = {1, 2};
+    input.lod = {{0, 1}};
+  }
+  auto future = batching_predictor.Submit(MakeInputs(&words, true));
+  auto wide_future = batching_predictor.Submit(wide_inputs);
+  auto outputs = future.get();
+  ASSERT_EQ(outputs.size(), 1UL);
+  ExpectNear(outputs[0], RunDirectly(predictor.get(), words));
+  EXPECT_THROW(wide_future.get(), std::exception);
+  EXPECT_EQ(batching_predictor.GetStats().num_batches, 2UL);
+}
+
+TEST(BatchingPredictor, length_buckets) {
+  Config config;
+  SetConfig(&config);
+  auto predictor = CreatePredictor(config);
+  BatchingOptions options;
+  options.max_batch_size = 2;
+  options.batch_timeout_us = 100 * 1000;
+  options.length_buckets = {4};
+  options.length_inputs = {predictor->GetInputNames()[0]};
+  std::vector<int64_t> warmup_words = {1, 2, 3, 4};
+  options.warmup_requests.push_back(MakeInputs(&warmup_words, false));
+  BatchingPredictor batching_predictor(config, options);
+
+  // Each request is a single sequence of 2 or 6 words, so the two requests
+  // fall in different buckets and are not merged, though they would fit in
+  // one batch.
+  std::vector<std::vector<int64_t>> words(2);
+  for (int64_t i = 0; i < 8; ++i) {
+    words[0].push_back(i);
+  }
+  for (int64_t i = 0; i < 24; ++i) {
+    words[1].push_back(i + 100);
+  }
+  std::vector<std::future<std::vector<PaddleTensor>>> futures;
+  for (auto& request_words : words) {
+    auto inputs = MakeInputs(&request_words, false);
+    for (auto& input : inputs) {
+      input.lod = {{0, static_cast<size_t>(input.shape[0])}};
+    }
+    futures.push_back(batching_predictor.Submit(inputs));
+  }
+  for (size_t i = 0; i < words.size(); ++i) {
+    auto outputs = futures[i].get();
+    ASSERT_EQ(outputs.size(), 1UL);
+    ExpectNear(outputs[0], RunDirectly(predictor.get(), words[i]));
+  }
+  auto stats = batching_predictor.GetStats();
+  EXPECT_EQ(stats.num_requests, 2UL);
+  EXPECT_EQ(stats.num_batches, 2UL);
+  EXPECT_EQ(stats.num_padding_elements, 0UL);
+}
+
+TEST(BatchingPredictor, invalid_length_input) {
+  Config config;
+  SetConfig(&config);
+  BatchingOptions options;
+  options.length_buckets = {4};
+  options.length_inputs = {"not_an_input"};
+  EXPECT_THROW(BatchingPredictor batching_predictor(config, options),
+               paddle::platform::EnforceNotMet);
+}
+
+TEST(BatchingPredictor, invalid_request) {
+  Config config;
+  SetConfig(&config);
+  BatchingPredictor batching_predictor(config, BatchingOptions());
+  std::vector<int64_t> words = {1, 2, 3, 4};
+  auto inputs = MakeInputs(&words, false);
+  inputs.pop_back();
+  EXPECT_THROW(batching_predictor.Submit(inputs),
+               paddle::platform::EnforceNotMet);
+
+  // A rank 0 input has no batch dim, also when its LoD gives a batch size.
+  inputs = MakeInputs(&words, true);
+  inputs[0].shape.clear();
+  EXPECT_THROW(batching_predictor.Submit(inputs),
+               paddle::platform::EnforceNotMet);
+}
+
+struct LoadResult {
+  double throughput{0};
+  double p50_ms{0};
+  double p99_ms{0};
+};
+
+// Sends FLAGS_poisson_requests requests of batch size 1, whose arrival times
+// form a Poisson process of rate FLAGS_poisson_qps, and measures the latency
+// of each request from its arrival time.
+template <typename RunFunc>
+static LoadResult RunPoissonLoad(RunFunc run) {
+  std::mt19937 rng(2022);
+  std::exponential_distribution<double> interval(FLAGS_poisson_qps);
+  std::vector<double> arrivals(FLAGS_poisson_requests);
+  double now = 0;
+  for (auto& arrival : arrivals) {
+    now += interval(rng);
+    arrival = now;
+  }
+
+  std::vector<double> latencies(arrivals.size());
+  std::atomic<size_t> next{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (int c = 0; c < FLAGS_poisson_clients; ++c) {
+    clients.emplace_back([&, c] {
+      std::vector<int64_t> words(4);
+      for (size_t i = next++; i < arrivals.size(); i = next++) {
+        auto arrival =
+            start + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::duration<double>(arrivals[i]));
+        std::this_thread::sleep_until(arrival);
+        for (size_t j = 0; j < words.size(); ++j) {
+          words[j] = (i + j) % 1000;
+        }
+        run(c, &words);
+        latencies[i] = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - arrival)
+                           .count();
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  double elapsed_s = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+  LoadResult result;
+  result.throughput = arrivals.size() / elapsed_s;
+  std::sort(latencies.begin(), latencies.end());
+  result.p50_ms = latencies[latencies.size() / 2];
+  result.p99_ms = latencies[latencies.size() * 99 / 100];
+  return result;
+}
+
+TEST(BatchingPredictor, poisson_benchmark) {
+  if (!FLAGS_run_poisson_benchmark) {
+    LOG(INFO) << "Skip the Poisson load benchmark, enable it by "
+                 "--run_poisson_benchmark.";
+    return;
+  }
+  Config config;
+  SetConfig(&config);
+
+  // Each client runs batch size 1 on its own cloned predictor.
+  auto main_predictor = CreatePredictor(config);
+  std::vector<std::unique_ptr<Predictor>> clones;
+  for (int c = 0; c < FLAGS_poisson_clients; ++c) {
+    clones.push_back(main_predictor->Clone());
+  }
+  LoadResult cloned = RunPoissonLoad([&](int c, std::vector<int64_t>* words) {
+    RunDirectly(clones[c].get(), *words);
+  });
+
+  BatchingOptions options;
+  options.max_batch_size = FLAGS_max_batch_size;
+  options.batch_timeout_us = FLAGS_batch_timeout_us;
+  BatchingPredictor batching_predictor(config, options);
+  LoadResult batched = RunPoissonLoad([&](int, std::vector<int64_t>* words) {
+    std::vector<PaddleTensor> outputs;
+    CHECK(batching_predictor.Run(MakeInputs(words, false), &outputs));
+  });
+  auto stats = batching_predictor.GetStats();
+
+  LOG(INFO) << "Poisson load of " << FLAGS_poisson_qps << " qps, "
+            << FLAGS_poisson_requests << " requests";
+  LOG(INFO) << "cloned predictors: throughput " << cloned.throughput
+            << " qps, p50 " << cloned.p50_ms << " ms, p99 " << cloned.p99_ms
+            << " ms";
+  LOG(INFO) << "batching predictor: throughput " << batched.throughput
+            << " qps, p50 " << batched.p50_ms << " ms, p99 " << batched.p99_ms
+            << " ms, average batch size "
+            << static_cast<double>(stats.num_samples) / stats.num_batches;
+  EXPECT_EQ(stats.num_requests, static_cast<uint64_t>(FLAGS_poisson_requests));
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -0,0 +1,406 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/cpu_quantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+
+using framework::LoDTensor;
+using framework::proto::VarType;
+
+namespace {
+
+// The number of bins of the histograms of the absolute activation values.
+constexpr int kNumBins = 2048;
+// The number of the non-negative INT8 levels.
+constexpr int kNumLevels = 128;
+
+bool IsFP32(const LoDTensor& tensor) {
+  return framework::TransToProtoVarType(tensor.dtype()) == VarType::FP32;
+}
+
+// KL(P || Q) of two unnormalized distributions, where Q is non-zero
+// wherever P is.
+double KLDivergence(const std::vector<double>& p,
+                    const std::vector<double>& q) {
+  double p_sum = std::accumulate(p.begin(), p.end(), 0.0);
+  double q_sum = std::accumulate(q.begin(), q.end(), 0.0);
+  double kl = 0.0;
+  for (size_t i = 0; i < p.size(); ++i) {
+    if (p[i] > 0) {
+      double p_i = p[i] / p_sum;
+      kl += p_i * std::log(p_i / (q[i] / q_sum));
+    }
+  }
+  return kl;
+}
+
+// The threshold minimizing the information lost when the values clipped at
+// it are quantized to kNumLevels levels.
+float KLThreshold(const std::vector<uint64_t>& hist, float bin_width) {
+  const int num_bins = hist.size();
+  double min_kl = std::numeric_limits<double>::max();
+  int best_bins = num_bins;
+  for (int i = kNumLevels; i <= num_bins; ++i) {
+    if (hist[i - 1] == 0) {
+      continue;
+    }
+    // The reference distribution, with the clipped values in its last bin.
+    std::vector<double> p(hist.begin(), hist.begin() + i);
+    p[i - 1] += std::accumulate(hist.begin() + i, hist.end(), 0.0);
+    // The distribution quantized to kNumLevels levels, each level spread
+    // evenly over the non-empty bins it merges.
+    std::vector<double> q(i, 0.0);
+    for (int level = 0; level < kNumLevels; ++level) {
+      int begin = level * i / kNumLevels;
+      int end = (level + 1) * i / kNumLevels;
+      double sum = 0.0;
+      int non_empty = 0;
+      for (int j = begin; j < end; ++j) {
+        sum += hist[j];
+        non_empty += hist[j] != 0;
+      }
+      for (int j = begin; j < end; ++j) {
+        q[j] = hist[j] != 0 ? sum / non_empty : 0.0;
+      }
+    }
+    double kl = KLDivergence(p, q);
+    if (kl < min_kl) {
+      min_kl = kl;
+      best_bins = i;
+    }
+  }
+  return best_bins * bin_width;
+}
+
+bool CopyToInput(const PaddleTensor& src, ZeroCopyTensor* dst) {
+  dst->Reshape(src.shape);
+  switch (src.dtype) {
+    case PaddleDType::FLOAT32:
+      dst->copy_from_cpu(static_cast<const float*>(src.data.data()));
+      break;
+    case PaddleDType::INT64:
+      dst->copy_from_cpu(static_cast<const int64_t*>(src.data.data()));
+      break;
+    case PaddleDType::INT32:
+      dst->copy_from_cpu(static_cast<const int32_t*>(src.data.data()));
+      break;
+    default:
+      LOG(ERROR) << "CpuQuantizer does not support the calibration input "
+                 << src.name << " of type " << src.dtype;
+      return false;
+  }
+  dst->SetLoD(src.lod);
+  return true;
+}
+
+float PercentileThreshold(const std::vector<uint64_t>& hist, float bin_width,
+                          float percentile) {
+  double total = std::accumulate(hist.begin(), hist.end(), 0.0);
+  double target = total * percentile / 100.0;
+  double count = 0.0;
+  for (size_t i = 0; i < hist.size(); ++i) {
+    count += hist[i];
+    if (count >= target) {
+      return (i + 1) * bin_width;
+    }
+  }
+  return hist.size() * bin_width;
+}
+
+}  // namespace
+
+float AnalysisPredictor::CpuQuantizer::Threshold(
+    const std::vector<uint64_t>& hist, float bin_width, float max_abs,
+    ScaleAlgo algo, float percentile) {
+  if (max_abs <= 0.f || hist.empty()) {
+    return max_abs;
+  }
+  switch (algo) {
+    case ScaleAlgo::MAX:
+      return max_abs;
+    case ScaleAlgo::KL:
+      return std::min(KLThreshold(hist, bin_width), max_abs);
+    case ScaleAlgo::PERCENTILE:
+      PADDLE_ENFORCE_EQ(
+          percentile > 0.f && percentile <= 100.f, true,
+          platform::errors::InvalidArgument(
+              "The percentile should be in (0, 100], but got %f.",
+              percentile));
+      return std::min(PercentileThreshold(hist, bin_width, percentile),
+                      max_abs);
+    default:
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "CpuQuantizer only supports the MAX, KL and PERCENTILE scale "
+          "algorithms for the activations."));
+  }
+}
+
+bool AnalysisPredictor::CpuQuantizer::Quantize() {
+  if (!platform::is_cpu_place(predictor_.place_)) {
+    LOG(ERROR) << "CpuQuantizer only works on CPU.";
+    return false;
+  }
+  CollectFcOps();
+  if (std::count(fc_ops_.begin(), fc_ops_.end(), nullptr) ==
+      static_cast<int64_t>(fc_ops_.size())) {
+    LOG(WARNING) << "CpuQuantizer found no fc operator to quantize.";
+    return true;
+  }
+  if (!ReadCalibrationData()) {
+    return false;
+  }
+
+  stats_.assign(fc_ops_.size(), ActivationStats());
+  if (!Calibrate(false)) {
+    return false;
+  }
+  for (auto& stats : stats_) {
+    stats.hist.assign(kNumBins, 0);
+  }
+  if (!Calibrate(true)) {
+    return false;
+  }
+  batches_.clear();
+
+  int num_quantized = 0;
+  for (size_t i = 0; i < fc_ops_.size(); ++i) {
+    if (fc_ops_[i]) {
+      QuantizeFc(fc_ops_[i], stats_[i]);
+      ++num_quantized;
+    }
+  }
+  // The operators copy the attributes of their OpDesc when they are created.
+  predictor_.CreateExecutor();
+  predictor_.PrepareExecutor();
+  LOG(INFO) << "CpuQuantizer quantized " << num_quantized << " of "
+            << fc_ops_.size() << " fc operators to INT8.";
+  return true;
+}
+
+void AnalysisPredictor::CpuQuantizer::CollectFcOps() {
+  auto& block = predictor_.inference_program_->Block(0);
+  // The weights used by any other operator can not be changed.
+  std::unordered_map<std::string, int> num_users;
+  for (auto* op : block.AllOps()) {
+    for (auto& name : op->InputArgumentNames()) {
+      ++num_users[name];
+    }
+  }
+
+  std::unordered_map<std::string, int> num_quantized_users;
+  for (auto* op : block.AllOps()) {
+    if (op->Type() != "fc") {
+      continue;
+    }
+    fc_ops_.push_back(nullptr);
+    if (op->GetAttrIfExists<bool>("use_mkldnn") ||
+        op->GetAttrIfExists<bool>("padding_weights")) {
+      continue;
+    }
+    auto* w_desc = block.FindVar(op->Input("W")[0]);
+    auto* in_desc = block.FindVar(op->Input("Input")[0]);
+    if (!w_desc || !in_desc || !w_desc->Persistable() ||
+        w_desc->GetType() != VarType::LOD_TENSOR ||
+        w_desc->GetDataType() != VarType::FP32 ||
+        in_desc->GetDataType() != VarType::FP32) {
+      continue;
+    }
+    auto* w_var = predictor_.scope_->FindVar(w_desc->Name());
+    if (!w_var || !w_var->IsType<LoDTensor>()) {
+      continue;
+    }
+    auto& w = w_var->Get<LoDTensor>();
+    if (!w.IsInitialized() || w.dims().size() != 2 ||
+        !platform::is_cpu_place(w.place()) || !IsFP32(w)) {
+      continue;
+    }
+    fc_ops_.back() = op;
+    ++num_quantized_users[w_desc->Name()];
+  }
+
+  for (auto& op : fc_ops_) {
+    if (op && num_quantized_users[op->Input("W")[0]] !=
+                  num_users[op->Input("W")[0]]) {
+      VLOG(3) << "CpuQuantizer skips the fc with the weights "
+              << op->Input("W")[0] << " used by other operators.";
+      op = nullptr;
+    }
+  }
+}
+
+bool AnalysisPredictor::CpuQuantizer::ReadCalibrationData() {
+  auto& reader = qconfig_->calibration_reader();
+  PADDLE_ENFORCE_EQ(static_cast<bool>(reader), true,
+                    platform::errors::PreconditionNotMet(
+                        "The calibration reader of CpuQuantizer is not set."));
+  for (int i = 0; i < qconfig_->calibration_batch_num(); ++i) {
+    std::vector<PaddleTensor> batch;
+    if (!reader(&batch)) {
+      break;
+    }
+    batches_.push_back(std::move(batch));
+  }
+  if (batches_.empty()) {
+    LOG(ERROR) << "CpuQuantizer got no calibration batch.";
+    return false;
+  }
+  VLOG(3) << "CpuQuantizer calibrates with " << batches_.size()
+          << " batches.";
+  return true;
+}
+
+bool AnalysisPredictor::CpuQuantizer::Calibrate(bool with_histogram) {
+  size_t fc_index = 0;
+  predictor_.executor_->RegisterOutputHook(
+      [&](framework::OperatorBase* op, framework::Scope* scope) {
+        if (op->Type() != "fc") {
+          return;
+        }
+        size_t index = fc_index++;
+        if (index >= fc_ops_.size() || !fc_ops_[index]) {
+          return;
+        }
+        auto* var = scope->FindVar(op->Input("Input"));
+        if (!var || !var->IsType<LoDTensor>() ||
+            !IsFP32(var->Get<LoDTensor>())) {
+          fc_ops_[index] = nullptr;
+          return;
+        }
+        CollectStats(var->Get<LoDTensor>(), with_histogram, &stats_[index]);
+      });
+
+  bool succeeded = true;
+  for (auto& batch : batches_) {
+    fc_index = 0;
+    if (!RunBatch(batch)) {
+      LOG(ERROR) << "CpuQuantizer failed to run a calibration batch.";
+      succeeded = false;
+      break;
+    }
+  }
+  // Drop the executor holding the hook.
+  predictor_.CreateExecutor();
+  predictor_.PrepareExecutor();
+  return succeeded;
+}
+
+bool AnalysisPredictor::CpuQuantizer::RunBatch(
+    const std::vector<PaddleTensor>& batch) {
+  if (predictor_.config_.use_feed_fetch_ops_enabled()) {
+    std::vector<PaddleTensor> outputs;
+    return predictor_.Run(batch, &outputs);
+  }
+  auto input_names = predictor_.GetInputNames();
+  if (batch.size() != input_names.size()) {
+    LOG(ERROR) << "CpuQuantizer needs " << input_names.size()
+               << " calibration inputs but got " << batch.size();
+    return false;
+  }
+  for (size_t i = 0; i < batch.size(); ++i) {
+    auto& name = batch[i].name.empty() ? input_names[i] : batch[i].name;
+    auto input = predictor_.GetInputTensor(name);
+    if (!CopyToInput(batch[i], input.get())) {
+      return false;
+    }
+  }
+  return predictor_.ZeroCopyRun();
+}
+
+void AnalysisPredictor::CpuQuantizer::CollectStats(
+    const LoDTensor& tensor, bool with_histogram,
+    ActivationStats* stats) const {
+  const float* data = tensor.data<float>();
+  const int64_t numel = tensor.numel();
+  if (!with_histogram) {
+    for (int64_t i = 0; i < numel; ++i) {
+      stats->max_abs = std::max(stats->max_abs, std::abs(data[i]));
+    }
+    return;
+  }
+  if (stats->max_abs <= 0.f) {
+    return;
+  }
+  const float bin_width = stats->max_abs / kNumBins;
+  for (int64_t i = 0; i < numel; ++i) {
+    int bin = static_cast<int>(std::abs(data[i]) / bin_width);
+    ++stats->hist[std::min(bin, kNumBins - 1)];
+  }
+}
+
+void AnalysisPredictor::CpuQuantizer::QuantizeFc(
+    framework::OpDesc* op, const ActivationStats& stats) {
+  float threshold = Threshold(stats.hist, stats.max_abs / kNumBins,
+                              stats.max_abs, qconfig_->activation_scale_algo(),
+                              qconfig_->percentile());
+  float scale_in = threshold > 0.f ? 127.f / threshold : 1.f;
+
+  auto& w_name = op->Input("W")[0];
+  if (!weight_scales_.count(w_name)) {
+    weight_scales_[w_name] = QuantizeWeights(w_name);
+  }
+  op->SetAttr("Scale_in", scale_in);
+  op->SetAttr("Scale_weights", weight_scales_[w_name]);
+  op->Flush();
+  VLOG(3) << "CpuQuantizer quantized the fc with the weights " << w_name
+          << ", the threshold of its input is " << threshold
+          << " in [0, " << stats.max_abs << "]";
+}
+
+std::vector<float> AnalysisPredictor::CpuQuantizer::QuantizeWeights(
+    const std::string& name) {
+  auto* var = predictor_.scope_->FindVar(name);
+  auto* w = var->GetMutable<LoDTensor>();
+  const int64_t K = w->dims()[0];
+  const int64_t N = w->dims()[1];
+  const float* w_data = w->data<float>();
+
+  std::vector<float> max_abs(N, 0.f);
+  for (int64_t k = 0; k < K; ++k) {
+    for (int64_t n = 0; n < N; ++n) {
+      max_abs[n] = std::max(max_abs[n], std::abs(w_data[k * N + n]));
+    }
+  }
+  std::vector<float> scales(N);
+  for (int64_t n = 0; n < N; ++n) {
+    scales[n] = max_abs[n] > 0.f ? 127.f / max_abs[n] : 1.f;
+  }
+
+  // A new tensor, the FP32 one may be mapped from the params file.
+  LoDTensor w_int8;
+  int8_t* q_data = w_int8.mutable_data<int8_t>(w->dims(), w->place());
+  for (int64_t k = 0; k < K; ++k) {
+    for (int64_t n = 0; n < N; ++n) {
+      float q = std::round(w_data[k * N + n] * scales[n]);
+      q_data[k * N + n] =
+          static_cast<int8_t>(std::min(std::max(q, -127.f), 127.f));
+    }
+  }
+  *w = w_int8;
+
+  auto* w_desc = predictor_.inference_program_->Block(0).FindVar(name);
+  w_desc->SetDataType(VarType::INT8);
+  return scales;
+}
+
+}  // namespace paddle
@@ -0,0 +1,96 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_desc.h"
+#include "paddle/fluid/inference/api/analysis_predictor.h"
+#include "paddle/fluid/inference/api/paddle_cpu_quantizer_config.h"
+
+namespace paddle {
+
+/*
+ * Post-training INT8 quantization of the fc operators, run by the predictor
+ * on CPU after the analysis. It does not depend on MKLDNN:
+ *  1. the calibration batches are run twice through the FP32 program, to
+ *     collect the max absolute value, then the histogram of the absolute
+ *     values of the input of each fc operator, right after it runs, before
+ *     the memory optimization reuses the input;
+ *  2. the scale of each input is derived from its histogram by the
+ *     activation ScaleAlgo, and each output channel of the weights gets the
+ *     scale of its max absolute value;
+ *  3. the scales are set to the Scale_in and Scale_weights attributes of the
+ *     fc operators, the weights are replaced by their INT8 values and the
+ *     operators are created again. The fc kernel quantizes its input at run
+ *     time and multiplies it by the INT8 weights with VNNI when available.
+ */
+class AnalysisPredictor::CpuQuantizer {
+ public:
+  explicit CpuQuantizer(AnalysisPredictor& predictor,  // NOLINT
+                        const CpuQuantizerConfig* qconfig)
+      : predictor_(predictor), qconfig_(qconfig) {}
+
+  // Execute full quantization procedure.
+  bool Quantize();
+
+  // Returns the threshold of the absolute values with a histogram of
+  // hist.size() bins of bin_width over [0, max_abs], above which the values
+  // are clipped.
+  static float Threshold(const std::vector<uint64_t>& hist, float bin_width,
+                         float max_abs, ScaleAlgo algo, float percentile);
+
+ private:
+  struct ActivationStats {
+    float max_abs{0.f};
+    std::vector<uint64_t> hist;
+  };
+
+  // Find the fc operators whose weights can be quantized.
+  void CollectFcOps();
+  bool ReadCalibrationData();
+  // Run the calibration batches, collecting the max absolute values of the
+  // fc inputs, or their histograms if with_histogram.
+  bool Calibrate(bool with_histogram);
+  // Run a calibration batch through the feed ops, or copied to the input
+  // variables when the feed and fetch ops are not used.
+  bool RunBatch(const std::vector<PaddleTensor>& batch);
+  void CollectStats(const framework::LoDTensor& tensor, bool with_histogram,
+                    ActivationStats* stats) const;
+  void QuantizeFc(framework::OpDesc* op, const ActivationStats& stats);
+  // Quantize the weights to INT8 in place, returns the scale per channel.
+  std::vector<float> QuantizeWeights(const std::string& name);
+
+#if PADDLE_WITH_TESTING
+  FRIEND_TEST(AnalysisPredictor, CpuQuantizerCalibration);
+#endif
+
+  AnalysisPredictor& predictor_;
+  const CpuQuantizerConfig* qconfig_;
+
+  // The fc operators of the main block in their run order, nullptr for the
+  // ones which are not quantized.
+  std::vector<framework::OpDesc*> fc_ops_;
+  std::vector<ActivationStats> stats_;
+  std::vector<std::vector<PaddleTensor>> batches_;
+  // The scales of the quantized weights, which may be shared by fc ops.
+  std::unordered_map<std::string, std::vector<float>> weight_scales_;
+};
+
+}  // namespace paddle
@@ -0,0 +1,325 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_inference_runtime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/os_info.h"
+
+namespace paddle_infer {
+namespace services {
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct RuntimeRequest {
+  InferenceRuntime::Task task;
+  Clock::time_point submit_time;
+  std::promise<void> promise;
+};
+
+struct RuntimeModel {
+  explicit RuntimeModel(const Config& config) : config(config) {}
+
+  std::string name;
+  ModelOptions options;
+  Config config;
+  // The threads the running requests of the model can occupy.
+  int quota_threads{1};
+  std::deque<std::unique_ptr<RuntimeRequest>> queue;
+  std::vector<std::unique_ptr<Predictor>> predictors;
+  std::vector<Predictor*> idle_predictors;
+  // The threads occupied by the running requests of the model.
+  int occupied_threads{0};
+  ModelStats stats;
+};
+
+}  // namespace
+
+struct InferenceRuntime::Impl {
+  RuntimeModel* PickModel() const;
+  int IntraOpThreads(const RuntimeModel& model) const;
+  Predictor* AcquirePredictor(RuntimeModel* model);
+  void WorkerLoop();
+
+  int num_threads{1};
+  std::vector<std::thread> workers;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  std::map<std::string, std::unique_ptr<RuntimeModel>> models;
+  size_t num_queued{0};
+  // The threads occupied by the running requests of all the models.
+  int occupied_threads{0};
+  bool stop{false};
+};
+
+// Picks the model with the highest priority among those which have queued
+// requests and free threads in their quota, and among them the one whose
+// first request has waited the longest. Returns nullptr if none can run.
+RuntimeModel* InferenceRuntime::Impl::PickModel() const {
+  if (occupied_threads >= num_threads) {
+    return nullptr;
+  }
+  RuntimeModel* picked = nullptr;
+  for (auto& item : models) {
+    RuntimeModel* model = item.second.get();
+    if (model->queue.empty() ||
+        model->occupied_threads >= model->quota_threads) {
+      continue;
+    }
+    if (picked == nullptr ||
+        model->options.priority > picked->options.priority ||
+        (model->options.priority == picked->options.priority &&
+         model->queue.front()->submit_time <
+             picked->queue.front()->submit_time)) {
+      picked = model;
+    }
+  }
+  return picked;
+}
+
+// Splits the free threads evenly between the request to run and the other
+// queued ones, within the quota and the intra-op limit of the model.
+int InferenceRuntime::Impl::IntraOpThreads(const RuntimeModel& model) const {
+  int free_threads = num_threads - occupied_threads;
+  int threads = free_threads / static_cast<int>(1 + num_queued);
+  threads = std::min(threads, model.quota_threads - model.occupied_threads);
+  if (model.options.max_intra_op_threads > 0) {
+    threads = std::min(threads, model.options.max_intra_op_threads);
+  }
+  return std::max(threads, 1);
+}
+
+// The requests of a model occupy at least a thread of its quota each, so
+// one of the predictors created at registration is always idle.
+Predictor* InferenceRuntime::Impl::AcquirePredictor(RuntimeModel* model) {
+  std::lock_guard<std::mutex> guard(mutex);
+  PADDLE_ENFORCE_EQ(model->idle_predictors.empty(), false,
+                    paddle::platform::errors::PreconditionNotMet(
+                        "The model %s has no idle predictor for a request.",
+                        model->name));
+  Predictor* predictor = model->idle_predictors.back();
+  model->idle_predictors.pop_back();
+  return predictor;
+}
+
+void InferenceRuntime::Impl::WorkerLoop() {
+  paddle::platform::SetCurrentThreadName("InferenceRuntime");
+  while (true) {
+    std::unique_ptr<RuntimeRequest> request;
+    RuntimeModel* model = nullptr;
+    int threads = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this, &model] {
+        model = PickModel();
+        return model != nullptr || (stop && num_queued == 0);
+      });
+      if (model == nullptr) {
+        return;
+      }
+      request = std::move(model->queue.front());
+      model->queue.pop_front();
+      --num_queued;
+      threads = IntraOpThreads(*model);
+      model->occupied_threads += threads;
+      occupied_threads += threads;
+    }
+
+    auto start = Clock::now();
+    std::exception_ptr error;
+    Predictor* predictor = nullptr;
+    try {
+      predictor = AcquirePredictor(model);
+      paddle::platform::SetNumThreadsLimit(threads);
+      request->task(predictor);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    paddle::platform::SetNumThreadsLimit(0);
+    auto end = Clock::now();
+
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      model->occupied_threads -= threads;
+      occupied_threads -= threads;
+      if (predictor != nullptr) {
+        model->idle_predictors.push_back(predictor);
+      }
+      auto& stats = model->stats;
+      ++stats.num_requests;
+      stats.num_failed += error != nullptr;
+      stats.queue_us += std::chrono::duration<double, std::micro>(
+                            start - request->submit_time)
+                            .count();
+      stats.run_us +=
+          std::chrono::duration<double, std::micro>(end - start).count();
+      stats.intra_op_threads += threads;
+    }
+    // The freed threads may let several waiting workers run.
+    cv.notify_all();
+    if (error) {
+      request->promise.set_exception(error);
+    } else {
+      request->promise.set_value();
+    }
+  }
+}
+
+InferenceRuntime::InferenceRuntime(const RuntimeOptions& options)
+    : impl_(new Impl) {
+  PADDLE_ENFORCE_GE(options.num_threads, 0,
+                    paddle::platform::errors::InvalidArgument(
+                        "The num_threads of InferenceRuntime should not be "
+                        "negative, but got %d.",
+                        options.num_threads));
+  impl_->num_threads = options.num_threads;
+  if (impl_->num_threads == 0) {
+    impl_->num_threads =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  // A worker per thread, so that the requests of single-threaded models can
+  // occupy all the threads.
+  for (int i = 0; i < impl_->num_threads; ++i) {
+    Impl* impl = impl_.get();
+    impl_->workers.emplace_back([impl] { impl->WorkerLoop(); });
+  }
+}
+
+InferenceRuntime::~InferenceRuntime() {
+  {
+    std::lock_guard<std::mutex> guard(impl_->mutex);
+    impl_->stop = true;
+  }
+  impl_->cv.notify_all();
+  for (auto& worker : impl_->workers) {
+    worker.join();
+  }
+}
+
+InferenceRuntime* InferenceRuntime::Global() {
+  // Never destroyed, so that the workers do not outlive the globals they
+  // use at exit.
+  static InferenceRuntime* runtime = new InferenceRuntime();
+  return runtime;
+}
+
+void InferenceRuntime::RegisterModel(const std::string& name,
+                                     const Config& config,
+                                     const ModelOptions& options) {
+  PADDLE_ENFORCE_EQ(options.cpu_quota > 0 && options.cpu_quota <= 1, true,
+                    paddle::platform::errors::InvalidArgument(
+                        "The cpu_quota of model %s should be in (0, 1], but "
+                        "got %f.",
+                        name, options.cpu_quota));
+  PADDLE_ENFORCE_GE(options.max_intra_op_threads, 0,
+                    paddle::platform::errors::InvalidArgument(
+                        "The max_intra_op_threads of model %s should not be "
+                        "negative, but got %d.",
+                        name, options.max_intra_op_threads));
+  {
+    std::lock_guard<std::mutex> guard(impl_->mutex);
+    PADDLE_ENFORCE_EQ(impl_->models.count(name), 0,
+                      paddle::platform::errors::AlreadyExists(
+                          "The model %s has been registered.", name));
+  }
+
+  std::unique_ptr<RuntimeModel> model(new RuntimeModel(config));
+  model->name = name;
+  model->options = options;
+  model->quota_threads = std::max(
+      1, static_cast<int>(std::floor(options.cpu_quota * impl_->num_threads)));
+  // The predictors ask for the most threads a request can get, and the
+  // runtime caps them for each request.
+  int max_threads = model->quota_threads;
+  if (options.max_intra_op_threads > 0) {
+    max_threads = std::min(max_threads, options.max_intra_op_threads);
+  }
+  model->config.SetCpuMathLibraryNumThreads(max_threads);
+  // A predictor per thread of the quota, all created before the model takes
+  // requests: a clone writes attributes on the program it shares with the
+  // predictor it is cloned from, so cloning beside a running request races.
+  model->predictors.emplace_back(new Predictor(model->config));
+  for (int i = 1; i < model->quota_threads; ++i) {
+    if (model->config.tensorrt_engine_enabled()) {
+      Config config(model->config);
+      model->predictors.emplace_back(new Predictor(config));
+    } else {
+      model->predictors.push_back(model->predictors.front()->Clone());
+    }
+  }
+  for (auto& predictor : model->predictors) {
+    model->idle_predictors.push_back(predictor.get());
+  }
+  model->stats.num_predictors = static_cast<int>(model->predictors.size());
+  VLOG(3) << "InferenceRuntime creates " << model->predictors.size()
+          << " predictors of model " << name;
+
+  std::lock_guard<std::mutex> guard(impl_->mutex);
+  auto inserted = impl_->models.emplace(name, std::move(model)).second;
+  PADDLE_ENFORCE_EQ(inserted, true,
+                    paddle::platform::errors::AlreadyExists(
+                        "The model %s has been registered.", name));
+}
+
+std::future<void> InferenceRuntime::Submit(const std::string& model,
+                                           Task task) {
+  std::unique_ptr<RuntimeRequest> request(new RuntimeRequest);
+  request->task = std::move(task);
+  auto future = request->promise.get_future();
+  {
+    std::lock_guard<std::mutex> guard(impl_->mutex);
+    PADDLE_ENFORCE_EQ(impl_->stop, false,
+                      paddle::platform::errors::PreconditionNotMet(
+                          "InferenceRuntime has been destroyed."));
+    auto it = impl_->models.find(model);
+    PADDLE_ENFORCE_EQ(it != impl_->models.end(), true,
+                      paddle::platform::errors::NotFound(
+                          "The model %s is not registered.", model));
+    request->submit_time = Clock::now();
+    it->second->queue.push_back(std::move(request));
+    ++impl_->num_queued;
+  }
+  impl_->cv.notify_one();
+  return future;
+}
+
+int InferenceRuntime::num_threads() const { return impl_->num_threads; }
+
+ModelStats InferenceRuntime::GetStats(const std::string& model) const {
+  std::lock_guard<std::mutex> guard(impl_->mutex);
+  auto it = impl_->models.find(model);
+  PADDLE_ENFORCE_EQ(it != impl_->models.end(), true,
+                    paddle::platform::errors::NotFound(
+                        "The model %s is not registered.", model));
+  return it->second->stats;
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -0,0 +1,201 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <vector>
+
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/api/paddle_inference_runtime.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_string(dirname, "", "dirname to tests.");
+
+namespace paddle_infer {
+namespace services {
+
+static void SetConfig(Config* config) {
+  config->SetModel(FLAGS_dirname);
+  config->DisableGpu();
+}
+
+// The word2vec model has four int64 inputs of shape [N, 1].
+static std::vector<float> RunWords(Predictor* predictor,
+                                   const std::vector<int64_t>& words) {
+  auto names = predictor->GetInputNames();
+  int batch_size = static_cast<int>(words.size() / 4);
+  for (int i = 0; i < 4; ++i) {
+    auto input = predictor->GetInputHandle(names[i]);
+    input->Reshape({batch_size, 1});
+    input->CopyFromCpu(words.data() + i * batch_size);
+  }
+  CHECK(predictor->Run());
+  auto output = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+  auto shape = output->shape();
+  std::vector<float> out_data(std::accumulate(
+      shape.begin(), shape.end(), 1, std::multiplies<int>()));
+  output->CopyToCpu(out_data.data());
+  return out_data;
+}
+
+TEST(InferenceRuntime, run_models) {
+  Config config;
+  SetConfig(&config);
+  auto predictor = CreatePredictor(config);
+
+  InferenceRuntime runtime(RuntimeOptions{4});
+  ASSERT_EQ(runtime.num_threads(), 4);
+  runtime.RegisterModel("first", config);
+  ModelOptions options;
+  options.cpu_quota = 0.5;
+  runtime.RegisterModel("second", config, options);
+
+  const int num_requests = 16;
+  std::vector<std::vector<int64_t>> words(num_requests);
+  std::vector<std::vector<float>> outputs(num_requests);
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < num_requests; ++i) {
+    for (int j = 0; j < 4 * (i % 3 + 1); ++j) {
+      words[i].push_back((i * 7 + j) % 1000);
+    }
+    futures.push_back(runtime.Submit(
+        i % 2 ? "second" : "first", [&words, &outputs, i](Predictor* pred) {
+          outputs[i] = RunWords(pred, words[i]);
+        }));
+  }
+  for (int i = 0; i < num_requests; ++i) {
+    futures[i].get();
+    auto expected = RunWords(predictor.get(), words[i]);
+    ASSERT_EQ(outputs[i].size(), expected.size());
+    for (size_t j = 0; j < expected.size(); ++j) {
+      EXPECT_NEAR(outputs[i][j], expected[j], 1e-5);
+    }
+  }
+  for (auto name : {"first", "second"}) {
+    auto stats = runtime.GetStats(name);
+    EXPECT_EQ(stats.num_requests, static_cast<uint64_t>(num_requests / 2));
+    EXPECT_EQ(stats.num_failed, 0UL);
+  }
+  // A predictor per thread of the quota, and the second model occupies at
+  // most 2 of the 4 threads.
+  EXPECT_EQ(runtime.GetStats("first").num_predictors, 4);
+  EXPECT_EQ(runtime.GetStats("second").num_predictors, 2);
+}
+
+TEST(InferenceRuntime, intra_op_threads) {
+  Config config;
+  SetConfig(&config);
+  InferenceRuntime runtime(RuntimeOptions{4});
+  runtime.RegisterModel("full", config);
+  ModelOptions options;
+  options.max_intra_op_threads = 3;
+  runtime.RegisterModel("limited", config, options);
+  options.max_intra_op_threads = 0;
+  options.cpu_quota = 0.5;
+  runtime.RegisterModel("half", config, options);
+
+  // A request alone on the runtime gets all the threads it is allowed.
+  std::vector<int64_t> words = {1, 2, 3, 4};
+  auto run = [&words](Predictor* predictor) { RunWords(predictor, words); };
+  runtime.Submit("full", run).get();
+  runtime.Submit("limited", run).get();
+  runtime.Submit("half", run).get();
+  EXPECT_EQ(runtime.GetStats("full").intra_op_threads, 4UL);
+  EXPECT_EQ(runtime.GetStats("limited").intra_op_threads, 3UL);
+  EXPECT_EQ(runtime.GetStats("half").intra_op_threads, 2UL);
+}
+
+TEST(InferenceRuntime, quota_and_priority) {
+  Config config;
+  SetConfig(&config);
+  InferenceRuntime runtime(RuntimeOptions{2});
+  ModelOptions options;
+  options.cpu_quota = 0.5;
+  runtime.RegisterModel("low", config, options);
+  options.priority = 1;
+  runtime.RegisterModel("high", config, options);
+
+  // Occupy the thread of the quota of the low priority model, so that the
+  // requests queued meanwhile run one by one on the other thread.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<void> started;
+  auto blocker = runtime.Submit("low", [&](Predictor*) {
+    started.set_value();
+    released.wait();
+  });
+  started.get_future().wait();
+
+  std::mutex mutex;
+  std::vector<std::string> order;
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  std::vector<std::future<void>> futures;
+  for (auto name : {"low", "low", "high", "high"}) {
+    futures.push_back(runtime.Submit(name, [&, name](Predictor*) {
+      int now = ++running;
+      max_running = std::max(max_running.load(), now);
+      std::lock_guard<std::mutex> guard(mutex);
+      order.push_back(name);
+      --running;
+    }));
+  }
+  // The low priority requests wait for the blocker, the high priority ones
+  // run on the free thread.
+  futures[2].get();
+  futures[3].get();
+  release.set_value();
+  blocker.get();
+  for (auto& future : futures) {
+    future.get();
+  }
+  std::vector<std::string> expected = {"high", "high", "low", "low"};
+  EXPECT_EQ(order, expected);
+  EXPECT_EQ(max_running.load(), 1);
+  EXPECT_EQ(runtime.GetStats("low").num_predictors, 1);
+}
+
+TEST(InferenceRuntime, errors) {
+  Config config;
+  SetConfig(&config);
+  InferenceRuntime runtime(RuntimeOptions{1});
+  runtime.RegisterModel("model", config);
+  EXPECT_THROW(runtime.RegisterModel("model", config),
+               paddle::platform::EnforceNotMet);
+  ModelOptions options;
+  options.cpu_quota = 1.5;
+  EXPECT_THROW(runtime.RegisterModel("other", config, options),
+               paddle::platform::EnforceNotMet);
+  EXPECT_THROW(runtime.Submit("missing", [](Predictor*) {}),
+               paddle::platform::EnforceNotMet);
+
+  auto future = runtime.Submit("model", [](Predictor*) {
+    PADDLE_THROW(paddle::platform::errors::Fatal("The request failed."));
+  });
+  EXPECT_THROW(future.get(), paddle::platform::EnforceNotMet);
+  EXPECT_EQ(runtime.GetStats("model").num_failed, 1UL);
+  // The runtime keeps serving after a failed request.
+  runtime.Submit("model", [](Predictor*) {}).get();
+  EXPECT_EQ(runtime.GetStats("model").num_requests, 2UL);
+}
+
+}  // namespace services
+}  // namespace paddle_infer
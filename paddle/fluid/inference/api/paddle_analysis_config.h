@@ -37,8 +37,9 @@
 /*! \file */
 // Here we include some header files with relative paths, for that in deploy,
 // the abstract path of this header file will be changed.
-#include "paddle_api.h"           // NOLINT
-#include "paddle_pass_builder.h"  // NOLINT
+#include "paddle_api.h"                   // NOLINT
+#include "paddle_cpu_quantizer_config.h"  // NOLINT
+#include "paddle_pass_builder.h"          // NOLINT
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle_mkldnn_quantizer_config.h"  // NOLINT
 #endif
@@ -266,6 +267,23 @@ struct PD_INFER_DECL AnalysisConfig {
   /// \return bool Whether the GPU fp16 precision is turned on.
   ///
   bool gpu_fp16_enabled() const { return use_gpu_fp16_; }
+  ///
+  /// \brief Run the operators on the bfloat16 CPU kernels, which compute in
+  /// float on the AVX512-BF16 instructions. It is turned off on the CPUs
+  /// without them.
+  ///
+  /// \param op_list The operator type list, replacing the default one of
+  /// matmul_v2, the elementwise operators, softmax, layer_norm and gelu
+  /// when not empty.
+  ///
+  void EnableCpuBfloat16(std::unordered_set<std::string> op_list = {});
+  ///
+  /// \brief A boolean state telling whether the bfloat16 CPU kernels are
+  /// turned on.
+  ///
+  /// \return bool Whether the bfloat16 CPU kernels are turned on.
+  ///
+  bool cpu_bfloat16_enabled() const { return use_cpu_bfloat16_; }
 
   ///
   /// \brief Turn on XPU.
@@ -803,6 +821,115 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool enable_memory_optim() const;
 
+  ///
+  /// \brief Place the intermediate tensors in one workspace, each one at an
+  /// offset planned from the lifetimes of the tensors and their sizes in the
+  /// runs, instead of sharing the names of the tensors whose lifetimes do
+  /// not overlap. Not supported with MKLDNN.
+  ///
+  /// \param x Whether to enable the workspace memory optimization.
+  ///
+  void EnableWorkspaceMemoryOptim(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the workspace memory
+  /// optimization is activated.
+  ///
+  /// \return bool Whether the workspace memory optimization is activated.
+  ///
+  bool workspace_memory_optim_enabled() const {
+    return enable_workspace_memory_optim_;
+  }
+
+  ///
+  /// \brief Share the parameters among the predictors cloned from this one.
+  /// The CPU parameters are frozen into one read-only buffer, and a clone
+  /// only creates its intermediate tensors and operators when it is used for
+  /// the first time.
+  ///
+  /// \param x Whether to share the parameters among the clones.
+  ///
+  void EnableSharedParams(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the clones share the parameters.
+  ///
+  /// \return bool Whether the clones share the parameters.
+  ///
+  bool shared_params_enabled() const { return enable_shared_params_; }
+
+  ///
+  /// \brief Map the combined parameters file into memory and back the CPU
+  /// parameters directly with the mapped pages instead of reading them. The
+  /// pages are shared through the page cache by all the processes loading
+  /// the same file. Only works with SetModel(prog_file, params_file).
+  ///
+  /// \param x Whether to map the parameters file.
+  ///
+  void EnableMemoryMappedParams(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the parameters file is mapped.
+  ///
+  /// \return bool Whether the parameters file is mapped.
+  ///
+  bool mmap_params_enabled() const { return enable_mmap_params_; }
+
+  ///
+  /// \brief Cache the optimized program and its parameters on disk, and
+  /// reuse them instead of running the analysis passes when a predictor is
+  /// created again with the same model, config and passes. The cache lives
+  /// in the directory set by SetOptimCacheDir, or in the _opt_cache
+  /// directory next to the model. Only works on CPU, and with
+  /// SetModel(prog_file, params_file).
+  ///
+  /// \param x Whether to cache the optimized program.
+  ///
+  void EnableOptimizedProgramCache(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the optimized program is
+  /// cached.
+  ///
+  /// \return bool Whether the optimized program is cached.
+  ///
+  bool optimized_program_cache_enabled() const {
+    return enable_program_cache_;
+  }
+
+  ///
+  /// \brief Cache the output shapes of the operators for each distinct
+  /// signature of the input shapes seen by ZeroCopyRun, so that a run with
+  /// known input shapes skips InferShape. Only works when the feed and fetch
+  /// ops are not used, and when the output shapes only depend on the input
+  /// shapes and LoD.
+  ///
+  /// \param capacity The max number of the cached signatures, the least
+  /// recently used one is evicted.
+  ///
+  void EnableShapeCache(int capacity = 8);
+  ///
+  /// \brief Get the max number of the cached input shape signatures.
+  ///
+  /// \return int The capacity of the shape cache, 0 if it is disabled.
+  ///
+  int shape_cache_capacity() const { return shape_cache_capacity_; }
+
+  ///
+  /// \brief Turn on the post-training INT8 quantization of the fc operators
+  /// on CPU, which does not need MKLDNN. The calibration data is set through
+  /// cpu_quantizer_config(). Only works when IR optimization is enabled.
+  ///
+  void EnableCpuQuantizer();
+  ///
+  /// \brief A boolean state telling whether the CPU quantization is enabled.
+  ///
+  /// \return bool Whether the CPU quantization is enabled.
+  ///
+  bool cpu_quantizer_enabled() const { return use_cpu_quantizer_; }
+  ///
+  /// \brief Get the CPU quantizer config.
+  ///
+  /// \return CpuQuantizerConfig* CPU quantizer config.
+  ///
+  CpuQuantizerConfig* cpu_quantizer_config() const;
+
   ///
   /// \brief Turn on profiling report.
   /// If not turned on, no profiling report will be generated.
@@ -815,6 +942,23 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool profile_enabled() const { return with_profile_; }
 
+  ///
+  /// \brief Turn on the per-operator statistics, a latency histogram, the
+  /// allocated bytes and the sampled input shapes of each operator, which
+  /// are much cheaper to collect than the profiling report. The statistics
+  /// are read by PaddlePredictor::GetOpStats().
+  ///
+  /// \param x Whether to collect the per-operator statistics.
+  ///
+  void EnableOpStats(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the per-operator statistics are
+  /// collected.
+  ///
+  /// \return bool Whether the per-operator statistics are collected.
+  ///
+  bool op_stats_enabled() const { return enable_op_stats_; }
+
   ///
   /// \brief Mute all logs in Paddle inference.
   ///
@@ -951,6 +1095,15 @@ struct PD_INFER_DECL AnalysisConfig {
 
   // memory reuse related.
   bool enable_memory_optim_{false};
+  bool enable_workspace_memory_optim_{false};
+  bool enable_shared_params_{false};
+  bool enable_mmap_params_{false};
+  bool enable_program_cache_{false};
+  int shape_cache_capacity_{0};
+
+  // CPU INT8 quantization related.
+  bool use_cpu_quantizer_{false};
+  std::shared_ptr<CpuQuantizerConfig> cpu_quantizer_config_;
 
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
@@ -966,6 +1119,7 @@ struct PD_INFER_DECL AnalysisConfig {
   int cpu_math_library_num_threads_{1};
 
   bool with_profile_{false};
+  bool enable_op_stats_{false};
 
   bool with_glog_info_{true};
 
@@ -999,6 +1153,11 @@ struct PD_INFER_DECL AnalysisConfig {
   std::shared_ptr<MkldnnQuantizerConfig> mkldnn_quantizer_config_;
   bool use_mkldnn_bfloat16_{false};
   std::unordered_set<std::string> bfloat16_enabled_op_types_;
+  bool use_cpu_bfloat16_{false};
+  std::unordered_set<std::string> cpu_bfloat16_enabled_op_types_{
+      "matmul_v2",       "elementwise_add", "elementwise_sub",
+      "elementwise_mul", "elementwise_div", "softmax",
+      "layer_norm",      "gelu"};
   bool use_mkldnn_int8_{false};
   std::unordered_set<int> quantize_excluded_op_ids_{};
   std::unordered_set<std::string> quantize_enabled_op_types_{
@@ -29,6 +29,7 @@
 #include <vector>
 #include "crypto/cipher.h"
 #include "paddle_infer_declare.h"  // NOLINT
+#include "paddle_op_stats.h"       // NOLINT
 #include "paddle_tensor.h"         // NOLINT
                                    /*! \namespace paddle
                                     */
@@ -281,6 +282,47 @@ class PD_INFER_DECL PaddlePredictor {
   ///
   virtual uint64_t TryShrinkMemory() { return 0; }
 
+  ///
+  /// \brief Get the memory only held by this predictor, such as its
+  /// intermediate tensors. The parameters shared with the clones are not
+  /// counted.
+  ///
+  /// \return Number of bytes.
+  ///
+  virtual uint64_t GetPrivateMemoryBytes() { return 0; }
+
+  ///
+  /// \brief Get the memory of the parameters shared with the clones.
+  ///
+  /// \return Number of bytes.
+  ///
+  virtual uint64_t GetSharedParamsBytes() { return 0; }
+
+  ///
+  /// \brief Get the per-operator statistics collected since the last reset,
+  /// see AnalysisConfig::EnableOpStats().
+  ///
+  /// \param[in] reset Whether to reset the statistics after reading them.
+  /// \return The statistics, empty if they are not collected.
+  ///
+  virtual OpStatsReport GetOpStats(bool reset) { return OpStatsReport(); }
+
+  ///
+  /// \brief Get the size of the workspace planned for the intermediate
+  /// tensors, see AnalysisConfig::EnableWorkspaceMemoryOptim().
+  ///
+  /// \return Number of bytes, 0 if the workspace is not enabled.
+  ///
+  virtual uint64_t GetWorkspaceBytes() { return 0; }
+
+  ///
+  /// \brief Get the memory the intermediate tensors of the workspace would
+  /// take without reuse, the sum of their sizes.
+  ///
+  /// \return Number of bytes, 0 if the workspace is not enabled.
+  ///
+  virtual uint64_t GetWorkspaceNaiveBytes() { return 0; }
+
   /// \brief Clone an existing predictor
   /// When using clone, the same network will be created,
   /// and the parameters between them are shared.
@@ -0,0 +1,151 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle_inference_api.h"  // NOLINT
+
+///
+/// \file paddle_batching_predictor.h
+///
+/// \brief A front end which merges concurrent small requests into batches.
+///
+/// \since 2.3.0
+///
+
+namespace paddle_infer {
+namespace services {
+
+///
+/// \brief Options of BatchingPredictor.
+///
+struct PD_INFER_DECL BatchingOptions {
+  /// Requests are merged until a batch holds max_batch_size samples.
+  int max_batch_size{16};
+  /// A batch is run at most batch_timeout_us after its first request is
+  /// submitted, even if it is not full.
+  int batch_timeout_us{2000};
+  /// Number of predictors running batches concurrently. The first one is
+  /// created from the config, the others are cloned from it.
+  int num_workers{1};
+  /// Dense inputs whose non-batch dims differ between requests are padded to
+  /// the largest ones with pad_value.
+  float pad_value{0.f};
+  /// Upper bounds, in ascending order, of the sequence length buckets. Only
+  /// the requests of the same bucket are merged, so that short requests are
+  /// not padded to, nor run with, long ones. The length of a request is the
+  /// longest sequence of the last LoD level, or dim 1 of the dense tensor, of
+  /// its length_inputs. Requests longer than the last bound share one more
+  /// bucket. Empty means a single bucket for all the requests.
+  std::vector<int> length_buckets;
+  /// Names of the inputs which carry the sequence length, e.g. the token ids
+  /// but not the segment ids or the masks. Empty means all the inputs.
+  std::vector<std::string> length_inputs;
+  /// Pad dim 1 of the dense length_inputs to the bound of their bucket, so
+  /// that a bucket only runs a few shapes, which hit the shape and memory
+  /// caches of the predictors. The other inputs are only padded to the
+  /// largest dims of the batch.
+  bool pad_to_bucket{false};
+  /// Requests run by every worker before it serves, e.g. one per bucket.
+  /// Each one is repeated up to max_batch_size samples, so that the
+  /// predictors allocate their memory and select their kernels for the full
+  /// batches in advance.
+  std::vector<std::vector<paddle::PaddleTensor>> warmup_requests;
+};
+
+///
+/// \brief Counters of BatchingPredictor, num_samples / num_batches is the
+/// average batch size.
+///
+struct PD_INFER_DECL BatchingStats {
+  uint64_t num_requests{0};
+  uint64_t num_batches{0};
+  uint64_t num_samples{0};
+  /// Elements of the merged dense inputs, num_padding_elements of which are
+  /// padding.
+  uint64_t num_dense_elements{0};
+  uint64_t num_padding_elements{0};
+};
+
+///
+/// \class BatchingPredictor
+///
+/// \brief BatchingPredictor queues the requests of many threads, merges them
+/// along the batch dimension, runs each batch with one predictor and scatters
+/// the outputs back to the requests. It trades a bounded amount of latency,
+/// see BatchingOptions::batch_timeout_us, for a higher throughput than
+/// running every small request on its own.
+///
+/// The batch dimension of an input is its first dim, or its first LoD level
+/// if the input has LoD. Inputs with LoD are concatenated into a compact
+/// batch without padding, dense inputs are padded if needed. With
+/// BatchingOptions::length_buckets, requests are only merged with requests of
+/// similar lengths. The outputs of a request are the rows, or the
+/// sequences, of the batch outputs which belong to it. The padded dims of the
+/// outputs are not removed.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// BatchingOptions options;
+/// options.max_batch_size = 32;
+/// BatchingPredictor predictor(config, options);
+/// // called from many threads
+/// auto outputs = predictor.Submit(inputs).get();
+/// \endcode
+///
+class PD_INFER_DECL BatchingPredictor {
+ public:
+  BatchingPredictor(const Config& config, const BatchingOptions& options);
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+  ~BatchingPredictor();
+
+  ///
+  /// \brief Queue a request. Thread safe.
+  ///
+  /// \param inputs Inputs on CPU, matched to the model inputs by name, or by
+  /// position if the names are empty. Memory not owned by the PaddleBufs must
+  /// stay valid until the returned future is ready.
+  /// \return The outputs of this request, in the order of GetOutputNames().
+  ///
+  std::future<std::vector<paddle::PaddleTensor>> Submit(
+      std::vector<paddle::PaddleTensor> inputs);
+
+  ///
+  /// \brief Queue a request and wait for its outputs.
+  ///
+  /// \return Whether the request succeeded.
+  ///
+  bool Run(const std::vector<paddle::PaddleTensor>& inputs,
+           std::vector<paddle::PaddleTensor>* outputs);
+
+  std::vector<std::string> GetInputNames() const;
+  std::vector<std::string> GetOutputNames() const;
+
+  BatchingStats GetStats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -0,0 +1,123 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+///
+/// \file paddle_cpu_quantizer_config.h
+///
+/// \brief CPU quantizer config.
+///
+/// \since 2.3
+///
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "paddle_api.h"                     // NOLINT
+#include "paddle_infer_declare.h"           // NOLINT
+#include "paddle_mkldnn_quantizer_config.h"  // NOLINT
+
+namespace paddle {
+
+///
+/// \class CpuQuantizerConfig
+///
+/// \brief Config for the post-training INT8 quantization on CPU, which does
+/// not depend on MKLDNN.
+///
+/// The quantizer runs the FP32 model over the calibration batches, collects
+/// the ranges of the inputs of the fc operators, and turns their weights into
+/// INT8 with a scale per output channel. The quantized fc operators run with
+/// the VNNI instructions when the CPU supports them.
+///
+/// It is not recommended to use this config directly, please refer to
+/// AnalysisConfig::cpu_quantizer_config()
+///
+struct PD_INFER_DECL CpuQuantizerConfig {
+  ///
+  /// \brief Reads the next calibration batch into the inputs, returns false
+  /// when there is no more batch.
+  ///
+  using CalibrationReader = std::function<bool(std::vector<PaddleTensor>*)>;
+
+  ///
+  /// \brief Set the calibration reader
+  ///
+  /// \param[in] reader the reader of the calibration batches.
+  ///
+  void SetCalibrationReader(CalibrationReader reader) {
+    calibration_reader_ = reader;
+  }
+
+  ///
+  /// \brief Get the calibration reader
+  ///
+  /// \return the reader of the calibration batches.
+  ///
+  const CalibrationReader& calibration_reader() const {
+    return calibration_reader_;
+  }
+
+  ///
+  /// \brief Set the maximum number of calibration batches to read
+  ///
+  /// \param[in] batch_num maximum number of calibration batches.
+  ///
+  void SetCalibrationBatchNum(int batch_num) { batch_num_ = batch_num; }
+
+  ///
+  /// \brief Get the maximum number of calibration batches to read
+  ///
+  /// \return maximum number of calibration batches.
+  ///
+  int calibration_batch_num() const { return batch_num_; }
+
+  ///
+  /// \brief Set the algorithm for the scales of the activations
+  ///
+  /// \param[in] algo ScaleAlgo::KL, ScaleAlgo::PERCENTILE or ScaleAlgo::MAX.
+  ///
+  void SetActivationScaleAlgo(ScaleAlgo algo) { activation_algo_ = algo; }
+
+  ///
+  /// \brief Get the algorithm for the scales of the activations
+  ///
+  /// \return the algorithm for the scales of the activations.
+  ///
+  ScaleAlgo activation_scale_algo() const { return activation_algo_; }
+
+  ///
+  /// \brief Set the percentile of the absolute activation values kept
+  /// unclipped, used by ScaleAlgo::PERCENTILE.
+  ///
+  /// \param[in] percentile percentile in (0, 100].
+  ///
+  void SetPercentile(float percentile) { percentile_ = percentile; }
+
+  ///
+  /// \brief Get the percentile used by ScaleAlgo::PERCENTILE
+  ///
+  /// \return the percentile.
+  ///
+  float percentile() const { return percentile_; }
+
+ protected:
+  CalibrationReader calibration_reader_;
+  int batch_num_{10};
+  ScaleAlgo activation_algo_{ScaleAlgo::KL};
+  float percentile_{99.99f};
+};
+
+}  // namespace paddle
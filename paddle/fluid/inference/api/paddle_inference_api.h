@@ -46,6 +46,8 @@ namespace paddle_infer {
 using PrecisionType = paddle::AnalysisConfig::Precision;
 using Config = paddle::AnalysisConfig;
 using DistConfig = paddle::DistConfig;
+using OpStatsReport = paddle::OpStatsReport;
+using OpLatencyStats = paddle::OpLatencyStats;
 
 ///
 /// \class Predictor
@@ -149,6 +151,47 @@ class PD_INFER_DECL Predictor {
   ///
   uint64_t TryShrinkMemory();
 
+  ///
+  /// \brief Get the memory only held by this predictor, such as its
+  /// intermediate tensors. The parameters shared with the clones are not
+  /// counted.
+  ///
+  /// \return Number of bytes.
+  ///
+  uint64_t GetPrivateMemoryBytes();
+
+  ///
+  /// \brief Get the memory of the parameters shared with the clones.
+  ///
+  /// \return Number of bytes.
+  ///
+  uint64_t GetSharedParamsBytes();
+
+  ///
+  /// \brief Get the per-operator statistics collected since the last reset,
+  /// see Config::EnableOpStats().
+  ///
+  /// \param[in] reset Whether to reset the statistics after reading them.
+  /// \return The statistics, empty if they are not collected.
+  ///
+  OpStatsReport GetOpStats(bool reset = false);
+
+  ///
+  /// \brief Get the size of the workspace planned for the intermediate
+  /// tensors, see Config::EnableWorkspaceMemoryOptim().
+  ///
+  /// \return Number of bytes, 0 if the workspace is not enabled.
+  ///
+  uint64_t GetWorkspaceBytes();
+
+  ///
+  /// \brief Get the memory the intermediate tensors of the workspace would
+  /// take without reuse.
+  ///
+  /// \return Number of bytes, 0 if the workspace is not enabled.
+  ///
+  uint64_t GetWorkspaceNaiveBytes();
+
  private:
   std::unique_ptr<paddle::PaddlePredictor> predictor_;
   friend class paddle_infer::experimental::InternalUtils;
@@ -175,6 +218,19 @@ PD_INFER_DECL std::tuple<int, int, int> GetTrtCompileVersion();
 PD_INFER_DECL std::tuple<int, int, int> GetTrtRuntimeVersion();
 PD_INFER_DECL std::string UpdateDllFlag(const char* name, const char* value);
 
+///
+/// \brief Convert the combined params file of a model to the mapped format,
+/// in which every parameter is aligned to be backed directly by the mapped
+/// pages under Config::EnableMemoryMappedParams.
+///
+/// \param[in] model_file the program file of the model
+/// \param[in] params_file the combined params file of the model
+/// \param[in] mapped_params_file the params file to write
+///
+PD_INFER_DECL void ConvertToMappedParams(const std::string& model_file,
+                                         const std::string& params_file,
+                                         const std::string& mapped_params_file);
+
 namespace services {
 ///
 /// \class PredictorPool
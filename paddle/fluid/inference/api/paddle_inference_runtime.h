@@ -0,0 +1,164 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle_inference_api.h"  // NOLINT
+
+///
+/// \file paddle_inference_runtime.h
+///
+/// \brief A process-wide scheduler running the requests of many models on
+/// one pool of CPU threads.
+///
+/// \since 2.3.0
+///
+
+namespace paddle_infer {
+namespace services {
+
+///
+/// \brief Options of InferenceRuntime.
+///
+struct PD_INFER_DECL RuntimeOptions {
+  /// The CPU threads shared by all the models, that is the worker threads
+  /// plus the math library threads of the requests they run. 0 means the
+  /// number of hardware threads.
+  int num_threads{0};
+};
+
+///
+/// \brief Options of a model registered to InferenceRuntime.
+///
+struct PD_INFER_DECL ModelOptions {
+  /// When the threads are scarce, the queued requests of the models with a
+  /// higher priority run first. Models of the same priority run their
+  /// requests in the order they are submitted.
+  int priority{0};
+  /// The fraction in (0, 1] of the threads of the runtime which the requests
+  /// of the model can occupy at the same time. At least one thread.
+  double cpu_quota{1.0};
+  /// The max math library threads of one request, 0 for no limit other than
+  /// the quota. A request gets fewer of them when other requests are
+  /// running or queued.
+  int max_intra_op_threads{0};
+};
+
+///
+/// \brief Counters of a model registered to InferenceRuntime.
+///
+struct PD_INFER_DECL ModelStats {
+  uint64_t num_requests{0};
+  uint64_t num_failed{0};
+  /// The total microseconds the requests waited in the queue, and ran.
+  double queue_us{0};
+  double run_us{0};
+  /// The total math library threads given to the requests, divided by
+  /// num_requests it is the average intra-op parallelism.
+  uint64_t intra_op_threads{0};
+  /// The predictors created for the model, one per thread of its quota.
+  int num_predictors{0};
+};
+
+///
+/// \class InferenceRuntime
+///
+/// \brief InferenceRuntime runs the requests of all the models registered to
+/// it on a shared pool of worker threads, instead of each predictor setting
+/// its own math library threads on the calling thread, which oversubscribes
+/// or idles the cores when many models are co-located.
+///
+/// A request of a model is a task which feeds, runs and fetches a predictor
+/// of the model. Any idle worker takes the next request from the queues of
+/// the models, subject to their priorities and CPU quotas, and runs it with
+/// an idle predictor of the model. The math library threads of the request
+/// adapt to the load: an idle runtime gives a request all the threads the
+/// model is allowed, while a busy one splits the free threads between the
+/// running and the queued requests.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// auto* runtime = InferenceRuntime::Global();
+/// ModelOptions options;
+/// options.priority = 1;
+/// options.cpu_quota = 0.5;
+/// runtime->RegisterModel("ranker", config, options);
+/// // called from many threads
+/// runtime->Submit("ranker", [&](Predictor* predictor) {
+///   auto input = predictor->GetInputHandle("x");
+///   ...
+///   predictor->Run();
+///   ...
+/// }).get();
+/// \endcode
+///
+class PD_INFER_DECL InferenceRuntime {
+ public:
+  using Task = std::function<void(Predictor* predictor)>;
+
+  explicit InferenceRuntime(const RuntimeOptions& options = RuntimeOptions());
+  InferenceRuntime(const InferenceRuntime&) = delete;
+  InferenceRuntime& operator=(const InferenceRuntime&) = delete;
+  ///
+  /// \brief Waits for the queued requests to finish.
+  ///
+  ~InferenceRuntime();
+
+  ///
+  /// \brief The runtime of the process, created with the default options on
+  /// the first call.
+  ///
+  static InferenceRuntime* Global();
+
+  ///
+  /// \brief Register a model. Its first predictor is created from the config
+  /// right away, and cloned to one predictor per thread of the quota of the
+  /// model, before any request runs.
+  ///
+  /// \param name The name to submit the requests to, unique in the runtime.
+  ///
+  void RegisterModel(const std::string& name, const Config& config,
+                     const ModelOptions& options = ModelOptions());
+
+  ///
+  /// \brief Queue a request of a model. Thread safe.
+  ///
+  /// \param task Runs the request with a predictor of the model, which is
+  /// not used by other requests meanwhile.
+  /// \return Ready when the task returns, or holds the exception it throws.
+  ///
+  std::future<void> Submit(const std::string& model, Task task);
+
+  ///
+  /// \brief The number of the threads shared by the models.
+  ///
+  int num_threads() const;
+
+  ModelStats GetStats(const std::string& model) const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace services
+}  // namespace paddle_infer
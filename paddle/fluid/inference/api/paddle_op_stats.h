@@ -0,0 +1,81 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+///
+/// \file paddle_op_stats.h
+///
+/// \brief The per-operator statistics of a predictor.
+///
+/// \since 2.3
+///
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "paddle_infer_declare.h"  // NOLINT
+
+namespace paddle {
+
+///
+/// \brief The latency statistics of an operator of the program, or of all
+/// the operators of a type.
+///
+struct PD_INFER_DECL OpLatencyStats {
+  std::string type;  ///< The operator type.
+  /// The index of the operator in the run order, -1 for an operator type.
+  int index{-1};
+  /// The first output of the operator, empty for an operator type.
+  std::string output;
+  uint64_t count{0};   ///< The number of runs.
+  double total_us{0};  ///< The total latency in microseconds.
+  double max_us{0};    ///< The max latency in microseconds.
+  double p50_us{0};    ///< The median latency, estimated by the histogram.
+  double p99_us{0};    ///< The 99th percentile, estimated by the histogram.
+  /// histogram[0] counts the runs under 1 us, and histogram[i] the runs in
+  /// [2^(i-1), 2^i) us.
+  std::vector<uint64_t> histogram;
+  /// The bytes allocated minus the bytes freed by the running thread during
+  /// the runs, e.g. the outputs growing with the input shapes.
+  int64_t allocated_bytes{0};
+  /// The distinct input shapes sampled from the runs, the most recent first,
+  /// like "X:[8, 128] Y:[128, 64]". Empty for an operator type.
+  std::vector<std::string> shape_signatures;
+};
+
+///
+/// \brief The per-operator statistics collected by a predictor since they
+/// were reset, see AnalysisConfig::EnableOpStats().
+///
+struct PD_INFER_DECL OpStatsReport {
+  uint64_t num_runs{0};                  ///< The number of program runs.
+  double elapsed_seconds{0};             ///< The seconds since the reset.
+  std::vector<OpLatencyStats> ops;       ///< Sorted by total_us descending.
+  std::vector<OpLatencyStats> op_types;  ///< Sorted by total_us descending.
+
+  ///
+  /// \brief A table of the top_k operator types and operators by total
+  /// latency.
+  ///
+  std::string ToString(size_t top_k = 20) const;
+
+  ///
+  /// \brief The report as a JSON object.
+  ///
+  std::string ToJson() const;
+};
+
+}  // namespace paddle
@@ -231,6 +231,10 @@ void GpuPassStrategy::EnableMkldnnInt8() {
   LOG(ERROR) << "GPU not support MKL-DNN int8";
 }
 
+void GpuPassStrategy::EnableCpuBfloat16() {
+  LOG(ERROR) << "GPU not support the bfloat16 CPU kernels";
+}
+
 CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
   // NOTE the large fusions should be located in the front, so that they will
   // not be damaged by smaller ones.
@@ -420,6 +424,24 @@ void CpuPassStrategy::EnableMkldnnInt8() {
 #endif
 }
 
+void CpuPassStrategy::EnableCpuBfloat16() {
+  if (!use_cpu_bfloat16_) {
+    // Keep matmul_v2, which has the bfloat16 kernel, from being mapped to mul
+    // and fused into fc, which has not.
+    for (auto &pass : std::vector<std::string>({
+             "gpu_cpu_map_matmul_v2_to_mul_pass",     //
+             "gpu_cpu_map_matmul_v2_to_matmul_pass",  //
+             "fc_fuse_pass",                          //
+         })) {
+      DeletePass(pass);
+    }
+    auto it = std::find(passes_.begin(), passes_.end(),
+                        "runtime_context_cache_pass");
+    passes_.insert(it, "cpu_bfloat16_mixed_precision_pass");
+  }
+  use_cpu_bfloat16_ = true;
+}
+
 IpuPassStrategy::IpuPassStrategy() : PassStrategy({}) {
   passes_.assign({"inference_process_pass"});
 }
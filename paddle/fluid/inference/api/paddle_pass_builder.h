@@ -143,6 +143,9 @@ class PD_INFER_DECL PassStrategy : public PaddlePassBuilder {
   /// \brief Enable MKLDNN bfloat16.
   virtual void EnableMkldnnBfloat16() {}
 
+  /// \brief Enable the bfloat16 CPU kernels.
+  virtual void EnableCpuBfloat16() {}
+
   /// \brief Enable MKLDNN int8.
   virtual void EnableMkldnnInt8() {}
 
@@ -197,6 +200,7 @@ class PD_INFER_DECL CpuPassStrategy : public PassStrategy {
     use_mkldnn_quantizer_ = other.use_mkldnn_quantizer_;
     use_mkldnn_bfloat16_ = other.use_mkldnn_bfloat16_;
     use_mkldnn_int8_ = other.use_mkldnn_int8_;
+    use_cpu_bfloat16_ = other.use_cpu_bfloat16_;
   }
   /// \brief Default destructor.
   virtual ~CpuPassStrategy() = default;
@@ -216,11 +220,15 @@ class PD_INFER_DECL CpuPassStrategy : public PassStrategy {
   /// \brief Enable MKLDNN int8.
   void EnableMkldnnInt8() override;
 
+  /// \brief Enable the bfloat16 CPU kernels.
+  void EnableCpuBfloat16() override;
+
  protected:
   /// \cond Protected
   bool use_mkldnn_quantizer_{false};
   bool use_mkldnn_bfloat16_{false};
   bool use_mkldnn_int8_{false};
+  bool use_cpu_bfloat16_{false};
   /// \endcond
 };
 
@@ -258,6 +266,9 @@ class PD_INFER_DECL GpuPassStrategy : public PassStrategy {
   /// \brief Not supported in GPU mode yet.
   void EnableMkldnnInt8() override;
 
+  /// \brief Not supported in GPU mode yet.
+  void EnableCpuBfloat16() override;
+
   /// \brief Default destructor.
   virtual ~GpuPassStrategy() = default;
 
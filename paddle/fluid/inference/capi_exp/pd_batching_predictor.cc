@@ -0,0 +1,206 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/capi_exp/pd_batching_predictor.h"
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include "paddle/fluid/inference/api/paddle_batching_predictor.h"
+#include "paddle/fluid/inference/capi_exp/pd_types.h"
+#include "paddle/fluid/inference/capi_exp/types_internal.h"
+#include "paddle/fluid/inference/capi_exp/utils_internal.h"
+#include "paddle/fluid/platform/enforce.h"
+
+#define CHECK_AND_CONVERT_PD_BATCHING_PREDICTOR                             \
+  PADDLE_ENFORCE_NOT_NULL(                                                  \
+      pd_batching_predictor,                                                \
+      paddle::platform::errors::InvalidArgument(                            \
+          "The pointer of paddle batching predictor shouldn't be nullptr")); \
+  auto& predictor = pd_batching_predictor->predictor
+
+#define CHECK_NULL_POINTER_PARM(param)                  \
+  PADDLE_ENFORCE_NOT_NULL(                              \
+      param, paddle::platform::errors::InvalidArgument( \
+                 "The pointer of " #param " shouldn't be nullptr"))
+
+static const paddle::PaddleTensor& GetOutput(PD_BatchingFuture* pd_future,
+                                             size_t index) {
+  CHECK_NULL_POINTER_PARM(pd_future);
+  PADDLE_ENFORCE_EQ(pd_future->succeeded, true,
+                    paddle::platform::errors::PreconditionNotMet(
+                        "The request has not succeeded, please call "
+                        "PD_BatchingFutureWait first."));
+  PADDLE_ENFORCE_LT(index, pd_future->outputs.size(),
+                    paddle::platform::errors::OutOfRange(
+                        "The request has %d outputs, but got the index %d.",
+                        pd_future->outputs.size(), index));
+  return pd_future->outputs[index];
+}
+
+extern "C" {
+
+__pd_give PD_BatchingPredictor* PD_BatchingPredictorCreate(
+    __pd_take PD_Config* pd_config, int32_t max_batch_size,
+    int32_t batch_timeout_us, int32_t num_workers,
+    __pd_keep PD_OneDimArrayInt32* length_buckets,
+    __pd_keep PD_OneDimArrayCstr* length_inputs, PD_Bool pad_to_bucket) {
+  CHECK_NULL_POINTER_PARM(pd_config);
+  // The config is taken even if the creation throws.
+  std::unique_ptr<paddle_infer::Config> config(
+      reinterpret_cast<paddle_infer::Config*>(pd_config));
+  paddle_infer::services::BatchingOptions options;
+  options.max_batch_size = max_batch_size;
+  options.batch_timeout_us = batch_timeout_us;
+  options.num_workers = num_workers;
+  if (length_buckets != nullptr) {
+    options.length_buckets =
+        paddle_infer::CvtOneDimArrayToVecInt32(length_buckets);
+  }
+  if (length_inputs != nullptr) {
+    options.length_inputs =
+        paddle_infer::CvtOneDimArrayToVecCstr(length_inputs);
+  }
+  options.pad_to_bucket = pad_to_bucket;
+  std::unique_ptr<PD_BatchingPredictor> pd_batching_predictor(
+      new PD_BatchingPredictor());
+  pd_batching_predictor->predictor.reset(
+      new paddle_infer::services::BatchingPredictor(*config, options));
+  return pd_batching_predictor.release();
+}
+
+__pd_give PD_OneDimArrayCstr* PD_BatchingPredictorGetInputNames(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor) {
+  CHECK_AND_CONVERT_PD_BATCHING_PREDICTOR;
+  return paddle_infer::CvtVecToOneDimArrayCstr(predictor->GetInputNames());
+}
+
+__pd_give PD_OneDimArrayCstr* PD_BatchingPredictorGetOutputNames(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor) {
+  CHECK_AND_CONVERT_PD_BATCHING_PREDICTOR;
+  return paddle_infer::CvtVecToOneDimArrayCstr(predictor->GetOutputNames());
+}
+
+__pd_give PD_BatchingFuture* PD_BatchingPredictorSubmit(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor,
+    __pd_take PD_BatchingRequest* pd_request) {
+  CHECK_AND_CONVERT_PD_BATCHING_PREDICTOR;
+  CHECK_NULL_POINTER_PARM(pd_request);
+  std::unique_ptr<PD_BatchingRequest> request(pd_request);
+  std::unique_ptr<PD_BatchingFuture> pd_future(new PD_BatchingFuture());
+  pd_future->future = predictor->Submit(std::move(request->inputs));
+  return pd_future.release();
+}
+
+void PD_BatchingPredictorDestroy(
+    __pd_take PD_BatchingPredictor* pd_batching_predictor) {
+  delete pd_batching_predictor;
+}
+
+__pd_give PD_BatchingRequest* PD_BatchingRequestCreate() {
+  return new PD_BatchingRequest();
+}
+
+void PD_BatchingRequestAddInput(__pd_keep PD_BatchingRequest* pd_request,
+                                const char* name, PD_DataType data_type,
+                                size_t shape_size, const int32_t* shape,
+                                const void* data,
+                                __pd_keep PD_TwoDimArraySize* lod) {
+  CHECK_NULL_POINTER_PARM(pd_request);
+  CHECK_NULL_POINTER_PARM(shape);
+  CHECK_NULL_POINTER_PARM(data);
+  PADDLE_ENFORCE_GT(shape_size, 0UL,
+                    paddle::platform::errors::InvalidArgument(
+                        "The input %s should have a batch dim, but its shape "
+                        "is empty.",
+                        name == nullptr ? "" : name));
+  paddle::PaddleTensor input;
+  input.name = name == nullptr ? "" : name;
+  input.dtype = paddle_infer::CvtToCxxDatatype(data_type);
+  size_t numel = 1;
+  for (size_t i = 0; i < shape_size; ++i) {
+    PADDLE_ENFORCE_GE(shape[i], 0,
+                      paddle::platform::errors::InvalidArgument(
+                          "The dim %d of the input %s should not be negative, "
+                          "but got %d.",
+                          i, input.name, shape[i]));
+    input.shape.push_back(shape[i]);
+    numel *= shape[i];
+  }
+  input.data.Resize(numel * paddle::PaddleDtypeSize(input.dtype));
+  if (input.data.length() > 0) {
+    std::memcpy(input.data.data(), data, input.data.length());
+  }
+  if (lod != nullptr) {
+    input.lod = paddle_infer::CvtTwoDimArrayToVecSize(lod);
+  }
+  pd_request->inputs.push_back(std::move(input));
+}
+
+void PD_BatchingRequestDestroy(__pd_take PD_BatchingRequest* pd_request) {
+  delete pd_request;
+}
+
+PD_Bool PD_BatchingFutureIsReady(__pd_keep PD_BatchingFuture* pd_future) {
+  CHECK_NULL_POINTER_PARM(pd_future);
+  return pd_future->done ||
+         pd_future->future.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready;
+}
+
+PD_Bool PD_BatchingFutureWait(__pd_keep PD_BatchingFuture* pd_future) {
+  CHECK_NULL_POINTER_PARM(pd_future);
+  if (!pd_future->done) {
+    pd_future->done = true;
+    try {
+      pd_future->outputs = pd_future->future.get();
+      pd_future->succeeded = true;
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "The batching request failed: " << e.what();
+    }
+  }
+  return pd_future->succeeded;
+}
+
+size_t PD_BatchingFutureGetOutputNum(__pd_keep PD_BatchingFuture* pd_future) {
+  CHECK_NULL_POINTER_PARM(pd_future);
+  return pd_future->outputs.size();
+}
+
+__pd_give PD_OneDimArrayInt32* PD_BatchingFutureGetOutputShape(
+    __pd_keep PD_BatchingFuture* pd_future, size_t index) {
+  return paddle_infer::CvtVecToOneDimArrayInt32(
+      GetOutput(pd_future, index).shape);
+}
+
+__pd_give PD_TwoDimArraySize* PD_BatchingFutureGetOutputLod(
+    __pd_keep PD_BatchingFuture* pd_future, size_t index) {
+  return paddle_infer::CvtVecToTwoDimArraySize(
+      GetOutput(pd_future, index).lod);
+}
+
+PD_DataType PD_BatchingFutureGetOutputDataType(
+    __pd_keep PD_BatchingFuture* pd_future, size_t index) {
+  return paddle_infer::CvtFromCxxDatatype(GetOutput(pd_future, index).dtype);
+}
+
+const void* PD_BatchingFutureGetOutputData(
+    __pd_keep PD_BatchingFuture* pd_future, size_t index) {
+  return GetOutput(pd_future, index).data.data();
+}
+
+void PD_BatchingFutureDestroy(__pd_take PD_BatchingFuture* pd_future) {
+  delete pd_future;
+}
+
+}  // extern "C"
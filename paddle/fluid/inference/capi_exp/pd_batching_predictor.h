@@ -0,0 +1,219 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+///
+/// \file pd_batching_predictor.h
+///
+/// \brief interface for the batching predictor, which merges the requests of
+/// many threads into batches and returns a future for each request.
+///
+/// \since 2.3
+///
+
+#pragma once
+
+#include "pd_common.h"  // NOLINT
+
+typedef struct PD_BatchingPredictor PD_BatchingPredictor;
+typedef struct PD_BatchingRequest PD_BatchingRequest;
+typedef struct PD_BatchingFuture PD_BatchingFuture;
+typedef struct PD_Config PD_Config;
+typedef struct PD_OneDimArrayInt32 PD_OneDimArrayInt32;
+typedef struct PD_OneDimArrayCstr PD_OneDimArrayCstr;
+typedef struct PD_TwoDimArraySize PD_TwoDimArraySize;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+///
+/// \brief Create a new batching predictor.
+///
+/// \param[in] pd_config config
+/// \param[in] max_batch_size requests are merged until a batch holds
+/// max_batch_size samples.
+/// \param[in] batch_timeout_us a batch is run at most batch_timeout_us after
+/// its first request is submitted.
+/// \param[in] num_workers number of predictors running batches concurrently.
+/// \param[in] length_buckets upper bounds of the sequence length buckets in
+/// ascending order, only the requests of the same bucket are merged. NULL
+/// means a single bucket.
+/// \param[in] length_inputs names of the inputs which carry the sequence
+/// length. NULL means all the inputs.
+/// \param[in] pad_to_bucket whether to pad dim 1 of the dense length inputs
+/// to the bound of their bucket.
+/// \return new batching predictor.
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_BatchingPredictor*
+PD_BatchingPredictorCreate(__pd_take PD_Config* pd_config,
+                           int32_t max_batch_size, int32_t batch_timeout_us,
+                           int32_t num_workers,
+                           __pd_keep PD_OneDimArrayInt32* length_buckets,
+                           __pd_keep PD_OneDimArrayCstr* length_inputs,
+                           PD_Bool pad_to_bucket);
+
+///
+/// \brief Get the input names
+///
+/// \param[in] pd_batching_predictor batching predictor
+/// \return input names
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_OneDimArrayCstr*
+PD_BatchingPredictorGetInputNames(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor);
+
+///
+/// \brief Get the output names, which are the order of the outputs of a
+/// future.
+///
+/// \param[in] pd_batching_predictor batching predictor
+/// \return output names
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_OneDimArrayCstr*
+PD_BatchingPredictorGetOutputNames(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor);
+
+///
+/// \brief Queue a request. Thread safe.
+///
+/// \param[in] pd_batching_predictor batching predictor
+/// \param[in] pd_request request
+/// \return the future of the outputs of the request.
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_BatchingFuture*
+PD_BatchingPredictorSubmit(
+    __pd_keep PD_BatchingPredictor* pd_batching_predictor,
+    __pd_take PD_BatchingRequest* pd_request);
+
+///
+/// \brief Destroy a batching predictor, after the queued requests are run.
+///
+/// \param[in] pd_batching_predictor batching predictor
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingPredictorDestroy(
+    __pd_take PD_BatchingPredictor* pd_batching_predictor);
+
+///
+/// \brief Create an empty request.
+///
+/// \return new request.
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_BatchingRequest*
+PD_BatchingRequestCreate();
+
+///
+/// \brief Add an input to the request. The data is copied.
+///
+/// \param[in] pd_request request
+/// \param[in] name input name
+/// \param[in] data_type data type of the input
+/// \param[in] shape_size the size of shape, at least 1
+/// \param[in] shape the shape of the input, whose dim 0 is the batch
+/// \param[in] data the data of the input on CPU
+/// \param[in] lod the lod of the input, or NULL
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingRequestAddInput(
+    __pd_keep PD_BatchingRequest* pd_request, const char* name,
+    PD_DataType data_type, size_t shape_size, const int32_t* shape,
+    const void* data, __pd_keep PD_TwoDimArraySize* lod);
+
+///
+/// \brief Destroy a request which is not submitted.
+///
+/// \param[in] pd_request request
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingRequestDestroy(
+    __pd_take PD_BatchingRequest* pd_request);
+
+///
+/// \brief Whether the outputs of the request are ready, without blocking.
+///
+/// \param[in] pd_future future
+/// \return Whether the outputs are ready
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_BatchingFutureIsReady(
+    __pd_keep PD_BatchingFuture* pd_future);
+
+///
+/// \brief Wait for the outputs of the request.
+///
+/// \param[in] pd_future future
+/// \return Whether the request succeeded
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_BatchingFutureWait(
+    __pd_keep PD_BatchingFuture* pd_future);
+
+///
+/// \brief Get the output number, PD_BatchingFutureWait must be called first.
+///
+/// \param[in] pd_future future
+/// \return output number
+///
+PADDLE_CAPI_EXPORT extern size_t PD_BatchingFutureGetOutputNum(
+    __pd_keep PD_BatchingFuture* pd_future);
+
+///
+/// \brief Get the shape of an output.
+///
+/// \param[in] pd_future future
+/// \param[in] index index of the output
+/// \return the shape of the output
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_OneDimArrayInt32*
+PD_BatchingFutureGetOutputShape(__pd_keep PD_BatchingFuture* pd_future,
+                                size_t index);
+
+///
+/// \brief Get the lod of an output.
+///
+/// \param[in] pd_future future
+/// \param[in] index index of the output
+/// \return the lod of the output
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_TwoDimArraySize*
+PD_BatchingFutureGetOutputLod(__pd_keep PD_BatchingFuture* pd_future,
+                              size_t index);
+
+///
+/// \brief Get the data type of an output.
+///
+/// \param[in] pd_future future
+/// \param[in] index index of the output
+/// \return the data type of the output
+///
+PADDLE_CAPI_EXPORT extern PD_DataType PD_BatchingFutureGetOutputDataType(
+    __pd_keep PD_BatchingFuture* pd_future, size_t index);
+
+///
+/// \brief Get the data of an output on CPU, which is owned by the future.
+///
+/// \param[in] pd_future future
+/// \param[in] index index of the output
+/// \return the data of the output
+///
+PADDLE_CAPI_EXPORT extern const void* PD_BatchingFutureGetOutputData(
+    __pd_keep PD_BatchingFuture* pd_future, size_t index);
+
+///
+/// \brief Destroy a future. A request which is not ready still runs, but
+/// its outputs are dropped.
+///
+/// \param[in] pd_future future
+///
+PADDLE_CAPI_EXPORT extern void PD_BatchingFutureDestroy(
+    __pd_take PD_BatchingFuture* pd_future);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
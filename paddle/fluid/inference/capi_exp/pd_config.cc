@@ -428,6 +428,15 @@ PD_Bool PD_ConfigMemoryOptimEnabled(__pd_keep PD_Config* pd_config) {
   CHECK_AND_CONVERT_PD_CONFIG;
   return config->enable_memory_optim();
 }
+void PD_ConfigEnableWorkspaceMemoryOptim(__pd_keep PD_Config* pd_config,
+                                         PD_Bool x) {
+  CHECK_AND_CONVERT_PD_CONFIG;
+  config->EnableWorkspaceMemoryOptim(x);
+}
+PD_Bool PD_ConfigWorkspaceMemoryOptimEnabled(__pd_keep PD_Config* pd_config) {
+  CHECK_AND_CONVERT_PD_CONFIG;
+  return config->workspace_memory_optim_enabled();
+}
 void PD_ConfigEnableProfile(__pd_keep PD_Config* pd_config) {
   CHECK_AND_CONVERT_PD_CONFIG;
   config->EnableProfile();
@@ -436,6 +445,14 @@ PD_Bool PD_ConfigProfileEnabled(__pd_keep PD_Config* pd_config) {
   CHECK_AND_CONVERT_PD_CONFIG;
   return config->profile_enabled();
 }
+void PD_ConfigEnableOpStats(__pd_keep PD_Config* pd_config, PD_Bool x) {
+  CHECK_AND_CONVERT_PD_CONFIG;
+  config->EnableOpStats(x);
+}
+PD_Bool PD_ConfigOpStatsEnabled(__pd_keep PD_Config* pd_config) {
+  CHECK_AND_CONVERT_PD_CONFIG;
+  return config->op_stats_enabled();
+}
 void PD_ConfigDisableGlogInfo(__pd_keep PD_Config* pd_config) {
   CHECK_AND_CONVERT_PD_CONFIG;
   config->DisableGlogInfo();
@@ -644,6 +644,24 @@ PADDLE_CAPI_EXPORT extern void PD_ConfigEnableMemoryOptim(
 PADDLE_CAPI_EXPORT extern PD_Bool PD_ConfigMemoryOptimEnabled(
     __pd_keep PD_Config* pd_config);
 ///
+/// \brief Place the intermediate tensors at planned offsets in one
+/// workspace.
+///
+/// \param[in] pd_onfig config
+/// \param[in] x Whether to enable the workspace memory optimization.
+///
+PADDLE_CAPI_EXPORT extern void PD_ConfigEnableWorkspaceMemoryOptim(
+    __pd_keep PD_Config* pd_config, PD_Bool x);
+///
+/// \brief A boolean state telling whether the workspace memory
+/// optimization is activated.
+///
+/// \param[in] pd_onfig config
+/// \return Whether the workspace memory optimization is activated.
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_ConfigWorkspaceMemoryOptimEnabled(
+    __pd_keep PD_Config* pd_config);
+///
 /// \brief Turn on profiling report.
 /// If not turned on, no profiling report will be generated.
 ///
@@ -660,6 +678,24 @@ PADDLE_CAPI_EXPORT extern void PD_ConfigEnableProfile(
 PADDLE_CAPI_EXPORT extern PD_Bool PD_ConfigProfileEnabled(
     __pd_keep PD_Config* pd_config);
 ///
+/// \brief Turn on the per-operator statistics, read by
+/// PD_PredictorGetOpStats.
+///
+/// \param[in] pd_onfig config
+/// \param[in] x Whether to collect the per-operator statistics.
+///
+PADDLE_CAPI_EXPORT extern void PD_ConfigEnableOpStats(
+    __pd_keep PD_Config* pd_config, PD_Bool x);
+///
+/// \brief A boolean state telling whether the per-operator statistics are
+/// collected.
+///
+/// \param[in] pd_onfig config
+/// \return Whether the per-operator statistics are collected.
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_ConfigOpStatsEnabled(
+    __pd_keep PD_Config* pd_config);
+///
 /// \brief Mute all logs in Paddle inference.
 ///
 /// \param[in] pd_onfig config
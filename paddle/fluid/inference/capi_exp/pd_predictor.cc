@@ -102,6 +102,12 @@ uint64_t PD_PredictorTryShrinkMemory(__pd_keep PD_Predictor* pd_predictor) {
   return predictor->TryShrinkMemory();
 }
 
+__pd_give PD_Cstr* PD_PredictorGetOpStats(__pd_keep PD_Predictor* pd_predictor,
+                                          PD_Bool reset) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  return paddle_infer::CvtStrToCstr(predictor->GetOpStats(reset).ToJson());
+}
+
 void PD_PredictorDestroy(__pd_take PD_Predictor* pd_predictor) {
   delete pd_predictor;
 }
@@ -30,6 +30,7 @@ typedef struct PD_Predictor PD_Predictor;
 typedef struct PD_Config PD_Config;
 typedef struct PD_Tensor PD_Tensor;
 typedef struct PD_OneDimArrayCstr PD_OneDimArrayCstr;
+typedef struct PD_Cstr PD_Cstr;
 
 #ifdef __cplusplus
 extern "C" {
@@ -135,6 +136,18 @@ PADDLE_CAPI_EXPORT extern void PD_PredictorClearIntermediateTensor(
 PADDLE_CAPI_EXPORT extern uint64_t PD_PredictorTryShrinkMemory(
     __pd_keep PD_Predictor* pd_predictor);
 
+///
+/// \brief Get the per-operator statistics collected since the last reset,
+/// see PD_ConfigEnableOpStats.
+///
+/// \param[in] pd_predictor predictor
+/// \param[in] reset Whether to reset the statistics after reading them.
+/// \return The statistics as a JSON object, with the per-operator and the
+/// per-operator-type latencies under "ops" and "op_types".
+///
+PADDLE_CAPI_EXPORT extern __pd_give PD_Cstr* PD_PredictorGetOpStats(
+    __pd_keep PD_Predictor* pd_predictor, PD_Bool reset);
+
 ///
 /// \brief Destroy a predictor object
 ///
@@ -16,7 +16,10 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <future>
+#include <vector>
 
+#include "paddle/fluid/inference/api/paddle_batching_predictor.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/capi_exp/pd_common.h"
 
@@ -27,3 +30,18 @@ typedef struct PD_Tensor {
 typedef struct PD_Predictor {
   std::shared_ptr<paddle_infer::Predictor> predictor;
 } PD_Predictor;
+
+typedef struct PD_BatchingPredictor {
+  std::unique_ptr<paddle_infer::services::BatchingPredictor> predictor;
+} PD_BatchingPredictor;
+
+typedef struct PD_BatchingRequest {
+  std::vector<paddle::PaddleTensor> inputs;
+} PD_BatchingRequest;
+
+typedef struct PD_BatchingFuture {
+  std::future<std::vector<paddle::PaddleTensor>> future;
+  std::vector<paddle::PaddleTensor> outputs;
+  bool done{false};
+  bool succeeded{false};
+} PD_BatchingFuture;
@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/inference/utils/mapped_params.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/pybind/pybind.h"
@@ -131,6 +132,55 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
   delete load_program;
 }
 
+bool LoadMappedPersistables(framework::Scope* scope,
+                            const framework::ProgramDesc& main_program,
+                            const std::string& param_filename) {
+  std::vector<std::string> paramlist;
+  for (auto* var : main_program.Block(0).AllVars()) {
+    if (IsPersistable(var)) {
+      if (var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+        VLOG(3) << "Can not map the persistable variable " << var->Name()
+                << " which is not a LoDTensor.";
+        return false;
+      }
+      paramlist.push_back(var->Name());
+    }
+  }
+  auto file = MappedParamFile::Open(param_filename);
+  if (!file) {
+    return false;
+  }
+  // sort paramlist to have the same ordering as load_combine
+  std::sort(paramlist.begin(), paramlist.end());
+  file->LoadParams(paramlist, scope);
+  VLOG(3) << "Mapped " << file->num_mapped() << " and copied "
+          << file->num_copied() << " parameters from " << param_filename;
+  return true;
+}
+
+void SaveMappedPersistables(const std::string& prog_filename,
+                            const std::string& param_filename,
+                            const std::string& mapped_filename) {
+  std::string program_desc_str;
+  ReadBinaryFile(prog_filename, &program_desc_str);
+  framework::ProgramDesc main_program(program_desc_str);
+  framework::Scope scope;
+  PADDLE_ENFORCE_EQ(
+      LoadMappedPersistables(&scope, main_program, param_filename), true,
+      platform::errors::Unavailable(
+          "Failed to map the parameters file %s, whose persistable variables "
+          "should all be LoDTensors.",
+          param_filename));
+  std::vector<std::string> paramlist;
+  for (auto* var : main_program.Block(0).AllVars()) {
+    if (IsPersistable(var)) {
+      paramlist.push_back(var->Name());
+    }
+  }
+  std::sort(paramlist.begin(), paramlist.end());
+  SaveMappedParams(scope, paramlist, mapped_filename);
+}
+
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& dirname) {
@@ -154,7 +204,8 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
 
 std::unique_ptr<framework::ProgramDesc> Load(
     framework::Executor* executor, framework::Scope* scope,
-    const std::string& prog_filename, const std::string& param_filename) {
+    const std::string& prog_filename, const std::string& param_filename,
+    bool use_mmap) {
   std::string program_desc_str;
   ReadBinaryFile(prog_filename, &program_desc_str);
 
@@ -165,6 +216,10 @@ std::unique_ptr<framework::ProgramDesc> Load(
       platform::errors::Unavailable("Model version %ld is not supported.",
                                     main_program->Version()));
 
+  if (use_mmap &&
+      LoadMappedPersistables(scope, *main_program, param_filename)) {
+    return main_program;
+  }
   LoadPersistables(executor, scope, *main_program, "", param_filename,
                    false /* model_from_memory */);
   return main_program;
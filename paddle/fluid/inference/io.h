@@ -37,10 +37,27 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& dirname);
 
+// If use_mmap is true, the CPU parameters are backed by the pages of the
+// mmapped param_filename where possible, see MappedParamFile.
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& prog_filename,
-                                             const std::string& param_filename);
+                                             const std::string& param_filename,
+                                             bool use_mmap = false);
+
+// Loads the persistable variables of main_program from the combined
+// param_filename by mapping it. Returns false, with nothing loaded, if some
+// persistable variable is not a LoDTensor or the file can not be mapped.
+bool LoadMappedPersistables(framework::Scope* scope,
+                            const framework::ProgramDesc& main_program,
+                            const std::string& param_filename);
+
+// Saves the persistable variables of the program in prog_filename, loaded
+// from the combined param_filename, to mapped_filename in the mapped format,
+// whose parameters are all backed by the mapped pages when they are loaded.
+void SaveMappedPersistables(const std::string& prog_filename,
+                            const std::string& param_filename,
+                            const std::string& mapped_filename);
 
 std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
     framework::Executor* executor, framework::Scope* scope,
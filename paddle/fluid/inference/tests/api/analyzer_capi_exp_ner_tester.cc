@@ -100,6 +100,119 @@ TEST(PD_PredictorRun, predictor_run) {
   PD_PredictorDestroy(predictor);
 }
 
+// Runs one sequence of words and mentions with the predictor.
+static std::vector<int64_t> RunSequence(PD_Predictor *predictor,
+                                        std::vector<int64_t> *word,
+                                        std::vector<int64_t> *mention) {
+  PD_OneDimArrayCstr *input_names = PD_PredictorGetInputNames(predictor);
+  int32_t shape[2] = {static_cast<int32_t>(word->size()), 1};
+  size_t lod_layer[2] = {0, word->size()};
+  PD_OneDimArraySize layer;
+  layer.size = 2;
+  layer.data = lod_layer;
+  PD_OneDimArraySize *layer_ptr = &layer;
+  PD_TwoDimArraySize lod;
+  lod.size = 1;
+  lod.data = &layer_ptr;
+  std::vector<int64_t> *data[2] = {word, mention};
+  for (size_t i = 0; i < 2; ++i) {
+    PD_Tensor *input =
+        PD_PredictorGetInputHandle(predictor, input_names->data[i]);
+    PD_TensorReshape(input, 2, shape);
+    PD_TensorCopyFromCpuInt64(input, data[i]->data());
+    PD_TensorSetLod(input, &lod);
+    PD_TensorDestroy(input);
+  }
+  EXPECT_TRUE(PD_PredictorRun(predictor));
+
+  PD_OneDimArrayCstr *output_names = PD_PredictorGetOutputNames(predictor);
+  PD_Tensor *output =
+      PD_PredictorGetOutputHandle(predictor, output_names->data[0]);
+  PD_OneDimArrayInt32 *output_shape = PD_TensorGetShape(output);
+  size_t numel = 1;
+  for (size_t i = 0; i < output_shape->size; ++i) {
+    numel *= output_shape->data[i];
+  }
+  std::vector<int64_t> result(numel);
+  PD_TensorCopyToCpuInt64(output, result.data());
+  PD_OneDimArrayInt32Destroy(output_shape);
+  PD_TensorDestroy(output);
+  PD_OneDimArrayCstrDestroy(output_names);
+  PD_OneDimArrayCstrDestroy(input_names);
+  return result;
+}
+
+TEST(PD_BatchingPredictor, length_buckets) {
+  auto model_dir = FLAGS_infer_model;
+  PD_Config *config = PD_ConfigCreate();
+  PD_ConfigSetModel(config, (model_dir + "/__model__").c_str(),
+                    (model_dir + "/param").c_str());
+  PD_ConfigDisableGpu(config);
+  PD_Config *batching_config = PD_ConfigCreate();
+  PD_ConfigSetModel(batching_config, (model_dir + "/__model__").c_str(),
+                    (model_dir + "/param").c_str());
+  PD_ConfigDisableGpu(batching_config);
+
+  PD_Predictor *predictor = PD_PredictorCreate(config);
+  int32_t bounds[2] = {4, 16};
+  PD_OneDimArrayInt32 buckets;
+  buckets.size = 2;
+  buckets.data = bounds;
+  PD_BatchingPredictor *batching_predictor =
+      PD_BatchingPredictorCreate(batching_config, 4, 1000, 1, &buckets,
+                                 NULL, FALSE);
+  PD_OneDimArrayCstr *input_names =
+      PD_BatchingPredictorGetInputNames(batching_predictor);
+  EXPECT_EQ(input_names->size, 2u);
+
+  std::vector<std::vector<int64_t>> words = {
+      {12673, 9763, 905},
+      {12673, 9763, 905, 284, 45, 7474, 20, 17, 1, 4, 9}};
+  std::vector<std::vector<int64_t>> mentions = {
+      {27, 0, 0}, {27, 0, 0, 33, 34, 33, 0, 0, 0, 1, 2}};
+  std::vector<PD_BatchingFuture *> futures;
+  for (size_t r = 0; r < words.size(); ++r) {
+    int32_t shape[2] = {static_cast<int32_t>(words[r].size()), 1};
+    size_t lod_layer[2] = {0, words[r].size()};
+    PD_OneDimArraySize layer;
+    layer.size = 2;
+    layer.data = lod_layer;
+    PD_OneDimArraySize *layer_ptr = &layer;
+    PD_TwoDimArraySize lod;
+    lod.size = 1;
+    lod.data = &layer_ptr;
+    PD_BatchingRequest *request = PD_BatchingRequestCreate();
+    PD_BatchingRequestAddInput(request, input_names->data[0], PD_DATA_INT64,
+                               2, shape, words[r].data(), &lod);
+    PD_BatchingRequestAddInput(request, input_names->data[1], PD_DATA_INT64,
+                               2, shape, mentions[r].data(), &lod);
+    futures.push_back(PD_BatchingPredictorSubmit(batching_predictor, request));
+  }
+
+  for (size_t r = 0; r < words.size(); ++r) {
+    ASSERT_TRUE(PD_BatchingFutureWait(futures[r]));
+    EXPECT_TRUE(PD_BatchingFutureIsReady(futures[r]));
+    ASSERT_EQ(PD_BatchingFutureGetOutputNum(futures[r]), 1u);
+    EXPECT_EQ(PD_BatchingFutureGetOutputDataType(futures[r], 0),
+              PD_DATA_INT64);
+    std::vector<int64_t> expected =
+        RunSequence(predictor, &words[r], &mentions[r]);
+    PD_OneDimArrayInt32 *shape = PD_BatchingFutureGetOutputShape(futures[r], 0);
+    ASSERT_EQ(static_cast<size_t>(shape->data[0]), expected.size());
+    const int64_t *data = static_cast<const int64_t *>(
+        PD_BatchingFutureGetOutputData(futures[r], 0));
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(data[i], expected[i]);
+    }
+    PD_OneDimArrayInt32Destroy(shape);
+    PD_BatchingFutureDestroy(futures[r]);
+  }
+
+  PD_OneDimArrayCstrDestroy(input_names);
+  PD_BatchingPredictorDestroy(batching_predictor);
+  PD_PredictorDestroy(predictor);
+}
+
 }  // namespace analysis
 }  // namespace inference
 }  // namespace paddle
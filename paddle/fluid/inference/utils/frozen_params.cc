@@ -0,0 +1,134 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/frozen_params.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"  // for posix_memalign
+#include "paddle/fluid/platform/enforce.h"
+
+#ifndef _WIN32
+#define posix_memalign_free free
+#endif
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+constexpr size_t kParamAlignment = 64;
+
+size_t AlignTo(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+size_t PageSize() {
+#ifndef _WIN32
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 4096;
+#endif
+}
+
+// A view of a parameter inside the arena, which keeps the arena alive.
+class FrozenParamAllocation : public phi::Allocation {
+ public:
+  FrozenParamAllocation(std::shared_ptr<FrozenParamArena> arena, void* ptr,
+                        size_t size)
+      : phi::Allocation(ptr, size, platform::CPUPlace()),
+        arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<FrozenParamArena> arena_;
+};
+
+}  // namespace
+
+std::shared_ptr<FrozenParamArena> FrozenParamArena::Freeze(
+    framework::Scope* scope, const std::vector<std::string>& param_names) {
+  std::vector<framework::LoDTensor*> params;
+  size_t size = 0;
+  for (auto& name : param_names) {
+    auto* var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) {
+      continue;
+    }
+    auto* tensor = var->GetMutable<framework::LoDTensor>();
+    if (!tensor->IsInitialized() || tensor->numel() == 0 ||
+        !platform::is_cpu_place(tensor->place())) {
+      VLOG(3) << "Parameter " << name << " is not frozen.";
+      continue;
+    }
+    params.push_back(tensor);
+    size += AlignTo(tensor->memory_size(), kParamAlignment);
+  }
+
+  size_t capacity = AlignTo((std::max)(size, kParamAlignment), PageSize());
+  void* data = nullptr;
+  PADDLE_ENFORCE_EQ(posix_memalign(&data, PageSize(), capacity), 0,
+                    platform::errors::ResourceExhausted(
+                        "Failed to allocate %d bytes for the frozen "
+                        "parameters.",
+                        capacity));
+  std::shared_ptr<FrozenParamArena> arena(
+      new FrozenParamArena(data, size, capacity));
+
+  char* cursor = static_cast<char*>(data);
+  for (auto* tensor : params) {
+    size_t bytes = tensor->memory_size();
+    std::memcpy(cursor, tensor->data(), bytes);
+    tensor->set_offset(0);
+    tensor->ResetHolder(
+        std::make_shared<FrozenParamAllocation>(arena, cursor, bytes));
+    cursor += AlignTo(bytes, kParamAlignment);
+  }
+  arena->num_params_ = params.size();
+
+#ifndef _WIN32
+  arena->read_only_ = mprotect(data, capacity, PROT_READ) == 0;
+#endif
+  if (!arena->read_only_) {
+    LOG(WARNING) << "Failed to make the frozen parameters read-only, they are "
+                    "still shared but not protected from writes.";
+  }
+  VLOG(3) << "Froze " << arena->num_params_ << " parameters into " << size
+          << " bytes.";
+  return arena;
+}
+
+FrozenParamArena::~FrozenParamArena() {
+#ifndef _WIN32
+  if (read_only_) {
+    mprotect(data_, capacity_, PROT_READ | PROT_WRITE);
+  }
+#endif
+  posix_memalign_free(data_);
+}
+
+bool FrozenParamArena::Contains(const void* ptr) const {
+  auto* begin = static_cast<const char*>(data_);
+  auto* p = static_cast<const char*>(ptr);
+  return p >= begin && p < begin + size_;
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,62 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace inference {
+
+// FrozenParamArena packs the CPU parameters of a model into one contiguous
+// page-aligned buffer and makes it read-only, so that the predictors cloned
+// with shared params can not modify them by accident: a write to a frozen
+// parameter faults instead of silently changing the results of all clones.
+// The tensors keep the arena alive through their holders.
+class FrozenParamArena {
+ public:
+  // Moves the data of the initialized CPU LoDTensors named by param_names
+  // from scope into a new arena. Tensors on other places are left as they
+  // are.
+  static std::shared_ptr<FrozenParamArena> Freeze(
+      framework::Scope* scope, const std::vector<std::string>& param_names);
+
+  ~FrozenParamArena();
+
+  // Bytes of the parameters, including the alignment padding.
+  size_t size() const { return size_; }
+  size_t num_params() const { return num_params_; }
+  bool read_only() const { return read_only_; }
+  bool Contains(const void* ptr) const;
+
+ private:
+  FrozenParamArena(void* data, size_t size, size_t capacity)
+      : data_(data), size_(size), capacity_(capacity) {}
+  DISABLE_COPY_AND_ASSIGN(FrozenParamArena);
+
+  void* data_;
+  size_t size_;
+  // size_ rounded up to the page size.
+  size_t capacity_;
+  size_t num_params_{0};
+  bool read_only_{false};
+};
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,64 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/frozen_params.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace inference {
+
+TEST(FrozenParamArena, freeze) {
+  framework::Scope scope;
+  platform::CPUPlace place;
+  auto* w = scope.Var("w")->GetMutable<framework::LoDTensor>();
+  float* w_data = w->mutable_data<float>(phi::make_ddim({3, 5}), place);
+  for (int i = 0; i < 15; ++i) {
+    w_data[i] = i * 0.5f;
+  }
+  auto* b = scope.Var("b")->GetMutable<framework::LoDTensor>();
+  b->mutable_data<int64_t>(phi::make_ddim({2}), place)[1] = 7;
+  auto* x = scope.Var("x")->GetMutable<framework::LoDTensor>();
+  x->mutable_data<float>(phi::make_ddim({4}), place);
+  scope.Var("empty");
+
+  auto arena = FrozenParamArena::Freeze(&scope, {"w", "b", "empty", "none"});
+  EXPECT_EQ(arena->num_params(), 2UL);
+  EXPECT_EQ(arena->size(), 128UL);
+  EXPECT_TRUE(arena->Contains(w->data<float>()));
+  EXPECT_TRUE(arena->Contains(b->data<int64_t>()));
+  EXPECT_FALSE(arena->Contains(x->data<float>()));
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_EQ(w->data<float>()[i], i * 0.5f);
+  }
+  EXPECT_EQ(b->data<int64_t>()[1], 7);
+
+  // The tensors keep the arena alive.
+  arena.reset();
+  EXPECT_EQ(w->data<float>()[14], 7.f);
+}
+
+#ifndef _WIN32
+TEST(FrozenParamArenaDeathTest, write) {
+  framework::Scope scope;
+  auto* w = scope.Var("w")->GetMutable<framework::LoDTensor>();
+  w->mutable_data<float>(phi::make_ddim({16}), platform::CPUPlace());
+  auto arena = FrozenParamArena::Freeze(&scope, {"w"});
+  ASSERT_TRUE(arena->read_only());
+  EXPECT_DEATH(w->data<float>()[0] = 1.f, "");
+}
+#endif
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,371 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/mapped_params.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+// The mapped format:
+//   char[8]  magic "PDMPARAM"
+//   uint32_t version
+//   uint32_t number of tensors
+//   for each tensor:
+//     uint32_t name size, char[] name
+//     int32_t  data type, proto::VarType::Type
+//     uint32_t rank, int64_t[] dims
+//     uint32_t lod level, for each level: uint64_t size, uint64_t[] offsets
+//     uint64_t data offset from the beginning of the file, 64 aligned
+//     uint64_t data size in bytes
+//   the data of the tensors
+constexpr char kMagic[] = "PDMPARAM";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+constexpr uint32_t kVersion = 0;
+constexpr uint64_t kDataAlignment = 64;
+
+uint64_t AlignTo(uint64_t size, uint64_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// A parameter backed by the mapped pages, which keeps the mapping alive.
+class MappedParamAllocation : public phi::Allocation {
+ public:
+  MappedParamAllocation(std::shared_ptr<MappedParamFile> file, void* ptr,
+                        size_t size)
+      : phi::Allocation(ptr, size, platform::CPUPlace()),
+        file_(std::move(file)) {}
+
+  MappedParamFile* file() const { return file_.get(); }
+
+ private:
+  std::shared_ptr<MappedParamFile> file_;
+};
+
+class BufferReader {
+ public:
+  BufferReader(const char* data, size_t size, const std::string& path)
+      : data_(data), size_(size), path_(path) {}
+
+  const char* Take(uint64_t bytes) {
+    PADDLE_ENFORCE_LE(
+        bytes, size_ - pos_,
+        platform::errors::InvalidArgument(
+            "The parameter file %s is truncated or damaged.", path_));
+    const char* ptr = data_ + pos_;
+    pos_ += bytes;
+    return ptr;
+  }
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  size_t pos() const { return pos_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t pos_{0};
+  const std::string& path_;
+};
+
+uint64_t TensorBytes(const framework::LoDTensor& tensor) {
+  return tensor.numel() * framework::DataTypeSize(tensor.dtype());
+}
+
+template <typename T>
+void WritePod(std::ostream* os, T value) {
+  os->write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}  // namespace
+
+std::shared_ptr<MappedParamFile> MappedParamFile::Open(
+    const std::string& path) {
+#ifdef _WIN32
+  LOG(WARNING) << "Mapping the parameter file " << path
+               << " is not supported on Windows.";
+  return nullptr;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_GE(fd, 0, platform::errors::Unavailable(
+                               "Failed to open the parameter file %s.", path));
+  struct stat st;
+  int ret = fstat(fd, &st);
+  size_t size = ret == 0 ? static_cast<size_t>(st.st_size) : 0;
+  void* data = MAP_FAILED;
+  if (size > 0) {
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG(WARNING) << "Failed to map the parameter file " << path << ", "
+                 << std::strerror(errno);
+    return nullptr;
+  }
+
+  std::shared_ptr<MappedParamFile> file(
+      new MappedParamFile(path, static_cast<char*>(data), size));
+  if (size >= kMagicSize && std::memcmp(data, kMagic, kMagicSize) == 0) {
+    file->mapped_format_ = true;
+    file->ParseIndex();
+  }
+  return file;
+#endif
+}
+
+MappedParamFile* MappedParamFile::FromTensor(
+    const framework::LoDTensor& tensor) {
+  auto* allocation =
+      dynamic_cast<MappedParamAllocation*>(tensor.Holder().get());
+  return allocation ? allocation->file() : nullptr;
+}
+
+MappedParamFile::~MappedParamFile() {
+#ifndef _WIN32
+  munmap(data_, size_);
+#endif
+}
+
+void MappedParamFile::ParseIndex() {
+  BufferReader reader(data_, size_, path_);
+  reader.Take(kMagicSize);
+  uint32_t version = reader.Read<uint32_t>();
+  PADDLE_ENFORCE_EQ(version, kVersion,
+                    platform::errors::InvalidArgument(
+                        "The version %u of the parameter file %s is not "
+                        "supported, only version %u is supported.",
+                        version, path_, kVersion));
+  uint32_t num_tensors = reader.Read<uint32_t>();
+  for (uint32_t i = 0; i < num_tensors; ++i) {
+    uint32_t name_size = reader.Read<uint32_t>();
+    std::string name(reader.Take(name_size), name_size);
+    Entry entry;
+    entry.data_type = reader.Read<int32_t>();
+    entry.dims.resize(reader.Read<uint32_t>());
+    for (auto& dim : entry.dims) {
+      dim = reader.Read<int64_t>();
+    }
+    entry.lod.resize(reader.Read<uint32_t>());
+    for (auto& level : entry.lod) {
+      std::vector<size_t> offsets(reader.Read<uint64_t>());
+      for (auto& offset : offsets) {
+        offset = reader.Read<uint64_t>();
+      }
+      level = offsets;
+    }
+    entry.offset = reader.Read<uint64_t>();
+    entry.bytes = reader.Read<uint64_t>();
+    PADDLE_ENFORCE_LE(
+        entry.offset + entry.bytes, size_,
+        platform::errors::InvalidArgument(
+            "The data of parameter %s exceeds the parameter file %s.", name,
+            path_));
+    index_.emplace(std::move(name), std::move(entry));
+  }
+}
+
+void MappedParamFile::LoadParams(const std::vector<std::string>& param_names,
+                                 framework::Scope* scope) {
+  if (!mapped_format_) {
+    LoadCombined(param_names, scope);
+  } else {
+    for (auto& name : param_names) {
+      auto it = index_.find(name);
+      PADDLE_ENFORCE_NE(it == index_.end(), true,
+                        platform::errors::NotFound(
+                            "The parameter %s is not found in the parameter "
+                            "file %s.",
+                            name, path_));
+      BindTensor(it->second,
+                 scope->Var(name)->GetMutable<framework::LoDTensor>());
+    }
+  }
+  VLOG(3) << "Loaded " << param_names.size() << " parameters from " << path_
+          << ", " << num_mapped_ << " mapped, " << num_copied_ << " copied.";
+}
+
+void MappedParamFile::LoadCombined(const std::vector<std::string>& param_names,
+                                   framework::Scope* scope) {
+  BufferReader reader(data_, size_, path_);
+  for (auto& name : param_names) {
+    Entry entry;
+    // The layout written by SerializeToStream.
+    uint32_t version = reader.Read<uint32_t>();
+    PADDLE_ENFORCE_EQ(version, 0U,
+                      platform::errors::InvalidArgument(
+                          "Tensor version %u of parameter %s is not "
+                          "supported.",
+                          version, name));
+    entry.lod.resize(reader.Read<uint64_t>());
+    for (auto& level : entry.lod) {
+      uint64_t bytes = reader.Read<uint64_t>();
+      std::vector<size_t> offsets(bytes / sizeof(size_t));
+      std::memcpy(offsets.data(), reader.Take(bytes),
+                  offsets.size() * sizeof(size_t));
+      level = offsets;
+    }
+    version = reader.Read<uint32_t>();
+    PADDLE_ENFORCE_EQ(version, 0U,
+                      platform::errors::InvalidArgument(
+                          "Tensor version %u of parameter %s is not "
+                          "supported.",
+                          version, name));
+    int32_t desc_size = reader.Read<int32_t>();
+    PADDLE_ENFORCE_GE(desc_size, 0, platform::errors::InvalidArgument(
+                                        "Tensor desc size should >= 0"));
+    framework::proto::VarType::TensorDesc desc;
+    PADDLE_ENFORCE_EQ(
+        desc.ParseFromArray(reader.Take(desc_size), desc_size), true,
+        platform::errors::InvalidArgument("Cannot parse tensor desc"));
+    entry.data_type = desc.data_type();
+    entry.dims.assign(desc.dims().begin(), desc.dims().end());
+    entry.bytes = phi::product(phi::make_ddim(entry.dims)) *
+                  framework::SizeOfType(desc.data_type());
+    entry.offset = reader.pos();
+    reader.Take(entry.bytes);
+    BindTensor(entry, scope->Var(name)->GetMutable<framework::LoDTensor>());
+  }
+  PADDLE_ENFORCE_EQ(reader.pos(), size_,
+                    platform::errors::Unavailable(
+                        "Not allowed to load partial data of the parameter "
+                        "file %s.",
+                        path_));
+}
+
+void MappedParamFile::BindTensor(const Entry& entry,
+                                 framework::LoDTensor* tensor) {
+  auto type = static_cast<framework::proto::VarType::Type>(entry.data_type);
+  auto dtype = framework::TransToPhiDataType(type);
+  char* ptr = data_ + entry.offset;
+  tensor->Resize(phi::make_ddim(entry.dims));
+  tensor->set_lod(entry.lod);
+  if (reinterpret_cast<uintptr_t>(ptr) % framework::SizeOfType(type) == 0) {
+    tensor->set_offset(0);
+    tensor->ResetHolderWithType(
+        std::make_shared<MappedParamAllocation>(shared_from_this(), ptr,
+                                                entry.bytes),
+        dtype);
+    ++num_mapped_;
+  } else {
+    void* dst = tensor->mutable_data(platform::CPUPlace(), dtype);
+    std::memcpy(dst, ptr, entry.bytes);
+    ++num_copied_;
+  }
+}
+
+void MappedParamFile::Protect() {
+#ifndef _WIN32
+  if (!read_only_) {
+    read_only_ = mprotect(data_, size_, PROT_READ) == 0;
+  }
+#endif
+}
+
+void SaveMappedParams(const framework::Scope& scope,
+                      const std::vector<std::string>& param_names,
+                      const std::string& path) {
+  std::vector<const framework::LoDTensor*> tensors;
+  for (auto& name : param_names) {
+    auto* var = scope.FindVar(name);
+    PADDLE_ENFORCE_EQ(
+        var != nullptr && var->IsType<framework::LoDTensor>(), true,
+        platform::errors::NotFound("The LoDTensor %s is not found.", name));
+    auto& tensor = var->Get<framework::LoDTensor>();
+    PADDLE_ENFORCE_EQ(
+        tensor.IsInitialized() && platform::is_cpu_place(tensor.place()),
+        true, platform::errors::InvalidArgument(
+                  "The tensor %s should be initialized on CPU.", name));
+    tensors.push_back(&tensor);
+  }
+
+  auto write_header = [&](const std::vector<uint64_t>& offsets) {
+    std::ostringstream os;
+    os.write(kMagic, kMagicSize);
+    WritePod<uint32_t>(&os, kVersion);
+    WritePod<uint32_t>(&os, tensors.size());
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      auto* tensor = tensors[i];
+      WritePod<uint32_t>(&os, param_names[i].size());
+      os.write(param_names[i].data(), param_names[i].size());
+      WritePod<int32_t>(&os, framework::TransToProtoVarType(tensor->dtype()));
+      auto dims = phi::vectorize(tensor->dims());
+      WritePod<uint32_t>(&os, dims.size());
+      for (auto dim : dims) {
+        WritePod<int64_t>(&os, dim);
+      }
+      WritePod<uint32_t>(&os, tensor->lod().size());
+      for (auto& level : tensor->lod()) {
+        WritePod<uint64_t>(&os, level.size());
+        for (auto offset : level) {
+          WritePod<uint64_t>(&os, offset);
+        }
+      }
+      WritePod<uint64_t>(&os, offsets[i]);
+      WritePod<uint64_t>(&os, TensorBytes(*tensor));
+    }
+    return os.str();
+  };
+
+  // The size of the header does not depend on the offsets.
+  std::vector<uint64_t> offsets(tensors.size(), 0);
+  uint64_t offset = AlignTo(write_header(offsets).size(), kDataAlignment);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    offsets[i] = offset;
+    offset = AlignTo(offset + TensorBytes(*tensors[i]), kDataAlignment);
+  }
+  std::string header = write_header(offsets);
+
+  std::ofstream fout(path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable(
+                        "Failed to open %s to save the parameters.", path));
+  fout.write(header.data(), header.size());
+  uint64_t pos = header.size();
+  const std::string padding(kDataAlignment, '\0');
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    fout.write(padding.data(), offsets[i] - pos);
+    fout.write(static_cast<const char*>(tensors[i]->data()),
+               TensorBytes(*tensors[i]));
+    pos = offsets[i] + TensorBytes(*tensors[i]);
+  }
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable(
+                        "Failed to save the parameters to %s.", path));
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,104 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace inference {
+
+// MappedParamFile mmaps a parameter file and backs the CPU parameter tensors
+// directly with the mapped pages instead of deserializing and copying them.
+// The pages of a file are shared through the page cache by all the processes
+// which map it, and a parameter is only read from disk when it is touched.
+//
+// Two formats are supported:
+//  - the combined format written by save_combine, whose tensors are backed
+//    by the mapping when their data happen to be aligned to the element size
+//    and copied otherwise;
+//  - the mapped format written by SaveMappedParams, whose tensors are all
+//    aligned to 64 bytes and always backed by the mapping.
+//
+// The mapping is private: a write to a parameter, e.g. by a fuse pass, copies
+// the page it touches and never reaches the file. Protect() makes the mapping
+// read-only once the parameters are final. The tensors keep the mapping alive
+// through their holders.
+class MappedParamFile
+    : public std::enable_shared_from_this<MappedParamFile> {
+ public:
+  // Returns nullptr if the file can not be mapped on this platform.
+  static std::shared_ptr<MappedParamFile> Open(const std::string& path);
+
+  // Returns the file backing tensor, or nullptr if it is not mapped.
+  static MappedParamFile* FromTensor(const framework::LoDTensor& tensor);
+
+  ~MappedParamFile();
+
+  // Loads the LoDTensors named by param_names into scope. For the combined
+  // format param_names must be all the tensors of the file, in the order
+  // they were saved.
+  void LoadParams(const std::vector<std::string>& param_names,
+                  framework::Scope* scope);
+
+  void Protect();
+
+  bool is_mapped_format() const { return mapped_format_; }
+  size_t size() const { return size_; }
+  size_t num_mapped() const { return num_mapped_; }
+  size_t num_copied() const { return num_copied_; }
+
+ private:
+  struct Entry {
+    int data_type;
+    std::vector<int64_t> dims;
+    framework::LoD lod;
+    uint64_t offset;
+    uint64_t bytes;
+  };
+
+  MappedParamFile(const std::string& path, char* data, size_t size)
+      : path_(path), data_(data), size_(size) {}
+  DISABLE_COPY_AND_ASSIGN(MappedParamFile);
+
+  void ParseIndex();
+  void LoadCombined(const std::vector<std::string>& param_names,
+                    framework::Scope* scope);
+  void BindTensor(const Entry& entry, framework::LoDTensor* tensor);
+
+  std::string path_;
+  char* data_;
+  size_t size_;
+  bool mapped_format_{false};
+  bool read_only_{false};
+  std::unordered_map<std::string, Entry> index_;
+  size_t num_mapped_{0};
+  size_t num_copied_{0};
+};
+
+// Saves the LoDTensors named by param_names in scope to path in the mapped
+// format, in which every tensor can be backed by the mapped pages.
+void SaveMappedParams(const framework::Scope& scope,
+                      const std::vector<std::string>& param_names,
+                      const std::string& path);
+
+}  // namespace inference
+}  // namespace paddle
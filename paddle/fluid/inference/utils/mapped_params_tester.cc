@@ -0,0 +1,130 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/mapped_params.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace inference {
+
+static void CreateParams(framework::Scope* scope) {
+  platform::CPUPlace place;
+  auto* w = scope->Var("w")->GetMutable<framework::LoDTensor>();
+  float* w_data = w->mutable_data<float>(phi::make_ddim({3, 5}), place);
+  for (int i = 0; i < 15; ++i) {
+    w_data[i] = i * 0.5f;
+  }
+  auto* b = scope->Var("b")->GetMutable<framework::LoDTensor>();
+  int64_t* b_data = b->mutable_data<int64_t>(phi::make_ddim({3}), place);
+  for (int i = 0; i < 3; ++i) {
+    b_data[i] = i + 7;
+  }
+  b->set_lod({{0, 1, 3}});
+}
+
+static void CheckParams(const framework::Scope& scope) {
+  auto& w = scope.FindVar("w")->Get<framework::LoDTensor>();
+  ASSERT_EQ(w.dims(), phi::make_ddim({3, 5}));
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_EQ(w.data<float>()[i], i * 0.5f);
+  }
+  auto& b = scope.FindVar("b")->Get<framework::LoDTensor>();
+  ASSERT_EQ(b.dims(), phi::make_ddim({3}));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(b.data<int64_t>()[i], i + 7);
+  }
+  framework::LoD lod{{0, 1, 3}};
+  EXPECT_EQ(b.lod(), lod);
+}
+
+TEST(MappedParamFile, combined_format) {
+  framework::Scope scope;
+  CreateParams(&scope);
+  const std::string path = "mapped_params_combined";
+  {
+    platform::CPUDeviceContext ctx;
+    std::ofstream fout(path, std::ios::binary);
+    // The order of load_combine.
+    for (auto& name : {"b", "w"}) {
+      framework::SerializeToStream(
+          fout, scope.FindVar(name)->Get<framework::LoDTensor>(), ctx);
+    }
+  }
+
+  auto file = MappedParamFile::Open(path);
+  ASSERT_NE(file, nullptr);
+  EXPECT_FALSE(file->is_mapped_format());
+  framework::Scope loaded;
+  file->LoadParams({"b", "w"}, &loaded);
+  EXPECT_EQ(file->num_mapped() + file->num_copied(), 2UL);
+  CheckParams(loaded);
+
+  framework::Scope partial;
+  EXPECT_ANY_THROW(file->LoadParams({"b"}, &partial));
+}
+
+TEST(MappedParamFile, mapped_format) {
+  framework::Scope scope;
+  CreateParams(&scope);
+  const std::string path = "mapped_params_mapped";
+  SaveMappedParams(scope, {"w", "b"}, path);
+
+  auto file = MappedParamFile::Open(path);
+  ASSERT_NE(file, nullptr);
+  EXPECT_TRUE(file->is_mapped_format());
+  framework::Scope loaded;
+  file->LoadParams({"b", "w"}, &loaded);
+  EXPECT_EQ(file->num_mapped(), 2UL);
+  EXPECT_EQ(file->num_copied(), 0UL);
+  CheckParams(loaded);
+
+  auto* w = loaded.FindVar("w")->GetMutable<framework::LoDTensor>();
+  EXPECT_EQ(MappedParamFile::FromTensor(*w), file.get());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(w->data<float>()) % 64, 0UL);
+
+  // Writes stay private to the process, the file is not changed.
+  w->data<float>()[0] = 100.f;
+  framework::Scope reloaded;
+  MappedParamFile::Open(path)->LoadParams({"w", "b"}, &reloaded);
+  CheckParams(reloaded);
+
+  // The tensors keep the mapping alive.
+  file.reset();
+  EXPECT_EQ(w->data<float>()[14], 7.f);
+
+  framework::Scope missing;
+  EXPECT_ANY_THROW(
+      MappedParamFile::Open(path)->LoadParams({"none"}, &missing));
+}
+
+#ifndef _WIN32
+TEST(MappedParamFileDeathTest, protect) {
+  framework::Scope scope;
+  CreateParams(&scope);
+  const std::string path = "mapped_params_protect";
+  SaveMappedParams(scope, {"w", "b"}, path);
+  auto file = MappedParamFile::Open(path);
+  framework::Scope loaded;
+  file->LoadParams({"w"}, &loaded);
+  file->Protect();
+  auto* w = loaded.FindVar("w")->GetMutable<framework::LoDTensor>();
+  EXPECT_DEATH(w->data<float>()[0] = 1.f, "");
+}
+#endif
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,324 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/op_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/inference/utils/table_printer.h"
+
+namespace paddle {
+namespace inference {
+
+int LatencyBucket(double us) {
+  if (us < 1.0) {
+    return 0;
+  }
+  int bucket = static_cast<int>(std::log2(us)) + 1;
+  return std::min(bucket, OpStatsCollector::kNumBuckets - 1);
+}
+
+double LatencyPercentile(const std::vector<uint64_t>& histogram,
+                         double max_us, double percentile) {
+  uint64_t total = 0;
+  for (auto count : histogram) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0.0;
+  }
+  double target = total * percentile / 100.0;
+  uint64_t count = 0;
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    count += histogram[i];
+    if (count >= target) {
+      return std::min(std::ldexp(1.0, static_cast<int>(i)), max_us);
+    }
+  }
+  return max_us;
+}
+
+static std::string ShapeSignature(const framework::OperatorBase& op,
+                                  const framework::Scope& scope) {
+  std::stringstream ss;
+  for (auto& input : op.Inputs()) {
+    for (auto& name : input.second) {
+      auto* var = scope.FindVar(name);
+      if (!var || !var->IsType<framework::LoDTensor>()) {
+        continue;
+      }
+      auto& tensor = var->Get<framework::LoDTensor>();
+      if (!tensor.IsInitialized()) {
+        continue;
+      }
+      if (ss.tellp() > 0) {
+        ss << " ";
+      }
+      ss << input.first << ":[" << tensor.dims() << "]";
+    }
+  }
+  return ss.str();
+}
+
+OpStatsCollector::OpStatsCollector(const platform::Place& place)
+    : allocated_stat_(platform::is_cpu_place(place)
+                          ? memory::StatGetInstance("HostAllocated", 0)
+                          : memory::StatGetInstance("Allocated",
+                                                    place.GetDeviceId())),
+      reset_time_(Clock::now()) {}
+
+void OpStatsCollector::Attach(framework::NaiveExecutor* executor) {
+  op_index_.clear();
+  runs_seen_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+    ResetLocked();
+  }
+  executor->RegisterInputHook(
+      [this](framework::OperatorBase* op, framework::Scope* scope) {
+        OnOpBegin(op, scope);
+      });
+  executor->RegisterOutputHook(
+      [this](framework::OperatorBase*, framework::Scope*) { OnOpEnd(); });
+}
+
+void OpStatsCollector::OnOpBegin(framework::OperatorBase* op,
+                                 framework::Scope* scope) {
+  auto it = op_index_.find(op);
+  if (it == op_index_.end()) {
+    // The ops run in the same order every time, so they are indexed by the
+    // order they are first seen.
+    it = op_index_.emplace(op, op_index_.size()).first;
+    OpRecord record;
+    record.type = op->Type();
+    auto outputs = op->OutputVars(true);
+    record.output = outputs.empty() ? "" : outputs.front();
+    record.histogram.assign(kNumBuckets, 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.push_back(std::move(record));
+  }
+  current_ = it->second;
+  if (current_ == 0) {
+    ++runs_seen_;
+  }
+  if (runs_seen_ % kShapeSampleInterval == 1) {
+    sampled_shapes_ = ShapeSignature(*op, *scope);
+  }
+  allocated_before_ = allocated_stat_->GetThreadCurrentValue();
+  start_ = Clock::now();
+}
+
+void OpStatsCollector::OnOpEnd() {
+  double us =
+      std::chrono::duration<double, std::micro>(Clock::now() - start_).count();
+  int64_t allocated =
+      allocated_stat_->GetThreadCurrentValue() - allocated_before_;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (current_ == 0) {
+    ++num_runs_;
+  }
+  auto& record = records_[current_];
+  ++record.count;
+  record.total_us += us;
+  record.max_us = std::max(record.max_us, us);
+  ++record.histogram[LatencyBucket(us)];
+  record.allocated_bytes += allocated;
+  if (!sampled_shapes_.empty()) {
+    auto& signatures = record.shape_signatures;
+    auto found =
+        std::find(signatures.begin(), signatures.end(), sampled_shapes_);
+    if (found != signatures.end()) {
+      signatures.erase(found);
+    }
+    signatures.insert(signatures.begin(), std::move(sampled_shapes_));
+    if (signatures.size() > kMaxShapeSignatures) {
+      signatures.pop_back();
+    }
+    sampled_shapes_.clear();
+  }
+}
+
+void OpStatsCollector::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResetLocked();
+}
+
+void OpStatsCollector::ResetLocked() {
+  for (auto& record : records_) {
+    record.count = 0;
+    record.total_us = 0;
+    record.max_us = 0;
+    record.histogram.assign(kNumBuckets, 0);
+    record.allocated_bytes = 0;
+    record.shape_signatures.clear();
+  }
+  num_runs_ = 0;
+  reset_time_ = Clock::now();
+}
+
+OpStatsReport OpStatsCollector::Report(bool reset) {
+  OpStatsReport report;
+  std::map<std::string, OpLatencyStats> types;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    report.num_runs = num_runs_;
+    report.elapsed_seconds =
+        std::chrono::duration<double>(Clock::now() - reset_time_).count();
+    for (size_t i = 0; i < records_.size(); ++i) {
+      auto& record = records_[i];
+      if (record.count == 0) {
+        continue;
+      }
+      OpLatencyStats stats;
+      stats.type = record.type;
+      stats.index = i;
+      stats.output = record.output;
+      stats.count = record.count;
+      stats.total_us = record.total_us;
+      stats.max_us = record.max_us;
+      stats.histogram = record.histogram;
+      stats.allocated_bytes = record.allocated_bytes;
+      stats.shape_signatures = record.shape_signatures;
+
+      auto& type_stats = types[record.type];
+      type_stats.type = record.type;
+      type_stats.count += record.count;
+      type_stats.total_us += record.total_us;
+      type_stats.max_us = std::max(type_stats.max_us, record.max_us);
+      type_stats.histogram.resize(kNumBuckets, 0);
+      for (int b = 0; b < kNumBuckets; ++b) {
+        type_stats.histogram[b] += record.histogram[b];
+      }
+      type_stats.allocated_bytes += record.allocated_bytes;
+
+      report.ops.push_back(std::move(stats));
+    }
+    if (reset) {
+      ResetLocked();
+    }
+  }
+
+  for (auto& item : types) {
+    report.op_types.push_back(std::move(item.second));
+  }
+  for (auto* list : {&report.ops, &report.op_types}) {
+    for (auto& stats : *list) {
+      stats.p50_us = LatencyPercentile(stats.histogram, stats.max_us, 50);
+      stats.p99_us = LatencyPercentile(stats.histogram, stats.max_us, 99);
+    }
+    std::stable_sort(list->begin(), list->end(),
+                     [](const OpLatencyStats& a, const OpLatencyStats& b) {
+                       return a.total_us > b.total_us;
+                     });
+  }
+  return report;
+}
+
+}  // namespace inference
+
+static std::string FormatUs(double us) {
+  std::stringstream ss;
+  ss.setf(std::ios::fixed);
+  ss.precision(1);
+  ss << us;
+  return ss.str();
+}
+
+std::string OpStatsReport::ToString(size_t top_k) const {
+  std::stringstream ss;
+  ss << "Op stats of " << num_runs << " runs in " << elapsed_seconds
+     << " seconds\n";
+  double total_us = 0;
+  for (auto& stats : op_types) {
+    total_us += stats.total_us;
+  }
+  for (auto* list : {&op_types, &ops}) {
+    bool by_type = list == &op_types;
+    inference::TablePrinter table(
+        {by_type ? "Op type" : "Op", "Calls", "Total (us)", "Ratio",
+         "Avg (us)", "P50 (us)", "P99 (us)", "Max (us)", "Alloc (B)"});
+    for (size_t i = 0; i < list->size() && i < top_k; ++i) {
+      auto& stats = (*list)[i];
+      std::string name = stats.type;
+      if (!by_type) {
+        name += "#" + std::to_string(stats.index) + " -> " + stats.output;
+      }
+      double ratio = total_us > 0 ? stats.total_us / total_us * 100 : 0;
+      table.InsertRow({name, std::to_string(stats.count),
+                       FormatUs(stats.total_us), FormatUs(ratio) + "%",
+                       FormatUs(stats.total_us / stats.count),
+                       FormatUs(stats.p50_us), FormatUs(stats.p99_us),
+                       FormatUs(stats.max_us),
+                       std::to_string(stats.allocated_bytes)});
+    }
+    ss << table.PrintTable();
+  }
+  return ss.str();
+}
+
+static std::string JsonString(const std::string& str) {
+  std::string out = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+static void OpLatencyStatsToJson(const OpLatencyStats& stats,
+                                 std::stringstream* ss) {
+  *ss << "{\"type\":" << JsonString(stats.type)
+      << ",\"index\":" << stats.index
+      << ",\"output\":" << JsonString(stats.output)
+      << ",\"count\":" << stats.count << ",\"total_us\":" << stats.total_us
+      << ",\"max_us\":" << stats.max_us << ",\"p50_us\":" << stats.p50_us
+      << ",\"p99_us\":" << stats.p99_us
+      << ",\"allocated_bytes\":" << stats.allocated_bytes
+      << ",\"histogram\":[";
+  for (size_t i = 0; i < stats.histogram.size(); ++i) {
+    *ss << (i ? "," : "") << stats.histogram[i];
+  }
+  *ss << "],\"shape_signatures\":[";
+  for (size_t i = 0; i < stats.shape_signatures.size(); ++i) {
+    *ss << (i ? "," : "") << JsonString(stats.shape_signatures[i]);
+  }
+  *ss << "]}";
+}
+
+std::string OpStatsReport::ToJson() const {
+  std::stringstream ss;
+  ss << "{\"num_runs\":" << num_runs
+     << ",\"elapsed_seconds\":" << elapsed_seconds;
+  for (auto* list : {&op_types, &ops}) {
+    ss << (list == &op_types ? ",\"op_types\":[" : ",\"ops\":[");
+    for (size_t i = 0; i < list->size(); ++i) {
+      if (i) ss << ",";
+      OpLatencyStatsToJson((*list)[i], &ss);
+    }
+    ss << "]";
+  }
+  ss << "}";
+  return ss.str();
+}
+
+}  // namespace paddle
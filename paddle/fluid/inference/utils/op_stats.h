@@ -0,0 +1,103 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/inference/api/paddle_op_stats.h"
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace inference {
+
+// OpStatsCollector times the operators run by the NaiveExecutor it is
+// attached to, through the input and output hooks of the executor. For each
+// operator it keeps a histogram of the latencies, the bytes allocated by the
+// running thread and the input shapes sampled from the runs.
+//
+// It is much lighter than the profiler: the executor runs on a single thread,
+// so a run only costs two clock reads and an uncontended lock. Report can be
+// called from any thread while the executor runs.
+class OpStatsCollector {
+ public:
+  explicit OpStatsCollector(const platform::Place& place);
+
+  // Registers the hooks to the executor. The statistics collected from a
+  // previous executor are dropped.
+  void Attach(framework::NaiveExecutor* executor);
+
+  // Returns the statistics since the last reset, and resets them if reset.
+  OpStatsReport Report(bool reset);
+
+  // Drops the statistics collected so far, e.g. of the warmup runs.
+  void Reset();
+
+  static constexpr int kNumBuckets = 32;
+  // The input shapes are sampled once every kShapeSampleInterval runs.
+  static constexpr uint64_t kShapeSampleInterval = 16;
+  static constexpr size_t kMaxShapeSignatures = 4;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct OpRecord {
+    std::string type;
+    std::string output;
+    uint64_t count{0};
+    double total_us{0};
+    double max_us{0};
+    std::vector<uint64_t> histogram;
+    int64_t allocated_bytes{0};
+    std::vector<std::string> shape_signatures;
+  };
+
+  void OnOpBegin(framework::OperatorBase* op, framework::Scope* scope);
+  void OnOpEnd();
+  void ResetLocked();
+
+  // The "HostAllocated" stat on CPU, and "Allocated" of the device else.
+  memory::StatBase* const allocated_stat_;
+
+  // Only touched by the running thread.
+  std::unordered_map<const framework::OperatorBase*, size_t> op_index_;
+  size_t current_{0};
+  uint64_t runs_seen_{0};
+  Clock::time_point start_;
+  int64_t allocated_before_{0};
+  std::string sampled_shapes_;
+
+  // Guards the fields below.
+  std::mutex mutex_;
+  std::vector<OpRecord> records_;
+  uint64_t num_runs_{0};
+  Clock::time_point reset_time_;
+};
+
+// The histogram bucket of a latency, see OpLatencyStats::histogram.
+int LatencyBucket(double us);
+
+// Estimates the percentile in (0, 100] of the latencies of a histogram, as
+// the upper bound of its bucket, clipped by the max latency.
+double LatencyPercentile(const std::vector<uint64_t>& histogram,
+                         double max_us, double percentile);
+
+}  // namespace inference
+}  // namespace paddle
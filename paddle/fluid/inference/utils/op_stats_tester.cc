@@ -0,0 +1,129 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/op_stats.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace inference {
+
+TEST(OpStats, latency_bucket) {
+  EXPECT_EQ(LatencyBucket(0.5), 0);
+  EXPECT_EQ(LatencyBucket(1.0), 1);
+  EXPECT_EQ(LatencyBucket(1.9), 1);
+  EXPECT_EQ(LatencyBucket(2.0), 2);
+  EXPECT_EQ(LatencyBucket(1000.0), 10);
+  EXPECT_EQ(LatencyBucket(1e30), OpStatsCollector::kNumBuckets - 1);
+}
+
+TEST(OpStats, latency_percentile) {
+  std::vector<uint64_t> histogram(OpStatsCollector::kNumBuckets, 0);
+  EXPECT_EQ(LatencyPercentile(histogram, 0, 50), 0);
+  histogram[3] = 98;   // [4, 8) us
+  histogram[10] = 2;   // [512, 1024) us
+  EXPECT_EQ(LatencyPercentile(histogram, 700, 50), 8);
+  EXPECT_EQ(LatencyPercentile(histogram, 700, 98), 8);
+  EXPECT_EQ(LatencyPercentile(histogram, 700, 99), 700);
+}
+
+static void PrepareAdd(framework::ProgramDesc* program,
+                       framework::NaiveExecutor* exe) {
+  auto* block = program->MutableBlock(0);
+  for (auto name : {"a", "b", "c", "d"}) {
+    block->Var(name)->SetType(framework::proto::VarType::LOD_TENSOR);
+  }
+  auto* add = block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+  add = block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"c"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"d"});
+
+  exe->Prepare(nullptr, *program, 0, false);
+  platform::CPUPlace place;
+  for (auto name : {"a", "b"}) {
+    auto* tensor = exe->FindTensor(name);
+    tensor->Resize({2, 3});
+    std::fill_n(tensor->mutable_data<float>(place), 6, 1.f);
+  }
+}
+
+TEST(OpStats, collect) {
+  platform::CPUPlace place;
+  framework::ProgramDesc program;
+  framework::NaiveExecutor exe(place);
+  PrepareAdd(&program, &exe);
+  OpStatsCollector collector(place);
+  collector.Attach(&exe);
+  for (int i = 0; i < 5; ++i) {
+    exe.Run();
+  }
+
+  auto report = collector.Report(true);
+  EXPECT_EQ(report.num_runs, 5UL);
+  ASSERT_EQ(report.ops.size(), 2UL);
+  ASSERT_EQ(report.op_types.size(), 1UL);
+  for (auto& op : report.ops) {
+    EXPECT_EQ(op.type, "elementwise_add");
+    EXPECT_EQ(op.count, 5UL);
+    EXPECT_LE(op.p50_us, op.max_us);
+    // The output is allocated on the host in the first run.
+    EXPECT_GT(op.allocated_bytes, 0);
+    ASSERT_EQ(op.shape_signatures.size(), 1UL);
+    EXPECT_EQ(op.shape_signatures[0], "X:[2, 3] Y:[2, 3]");
+  }
+  EXPECT_EQ(report.ops[0].output, report.ops[0].index == 0 ? "c" : "d");
+  auto& type = report.op_types[0];
+  EXPECT_EQ(type.index, -1);
+  EXPECT_EQ(type.count, 10UL);
+  EXPECT_DOUBLE_EQ(type.total_us,
+                   report.ops[0].total_us + report.ops[1].total_us);
+
+  std::string json = report.ToJson();
+  EXPECT_EQ(json.find("{\"num_runs\":5,"), 0UL);
+  EXPECT_NE(json.find("\"shape_signatures\":[\"X:[2, 3] Y:[2, 3]\"]"),
+            std::string::npos);
+  EXPECT_NE(report.ToString().find("elementwise_add#1 -> d"),
+            std::string::npos);
+
+  // The counters were reset by the last report.
+  report = collector.Report(false);
+  EXPECT_EQ(report.num_runs, 0UL);
+  EXPECT_TRUE(report.ops.empty());
+  exe.Run();
+  report = collector.Report(false);
+  EXPECT_EQ(report.num_runs, 1UL);
+  EXPECT_EQ(report.ops.size(), 2UL);
+  // The outputs are reused, nothing is allocated after the first run.
+  for (auto& op : report.ops) {
+    EXPECT_EQ(op.allocated_bytes, 0);
+  }
+
+  collector.Reset();
+  report = collector.Report(false);
+  EXPECT_EQ(report.num_runs, 0UL);
+  EXPECT_TRUE(report.ops.empty());
+}
+
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP_ITSELF(elementwise_add);
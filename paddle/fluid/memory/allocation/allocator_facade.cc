@@ -22,6 +22,7 @@
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/reuse_allocator.h"
 #include "paddle/fluid/memory/allocation/stat_allocator.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
@@ -94,6 +95,7 @@ PADDLE_DEFINE_EXPORTED_bool(use_cuda_managed_memory, false,
                             "strategy");
 
 DECLARE_string(allocator_strategy);
+DECLARE_bool(enable_adaptive_gc);
 
 namespace paddle {
 namespace memory {
@@ -318,6 +320,10 @@ class AllocatorFacadePrivate {
 
     WrapStatAllocator();
 
+    if (FLAGS_enable_adaptive_gc) {
+      WrapCPUReuseAllocator();
+    }
+
     CheckAllocThreadSafe();
 
 #ifdef PADDLE_WITH_CUDA
@@ -919,10 +925,20 @@ class AllocatorFacadePrivate {
     }
   }
 
+  // The capacity is set by the AdaptiveGarbageReleaser, which finds the
+  // ReuseAllocator through GetAllocator(CPUPlace)
+  void WrapCPUReuseAllocator() {
+    auto& allocator = allocators_[platform::CPUPlace()];
+    allocator = std::make_shared<ReuseAllocator>(allocator);
+  }
+
   void WrapStatAllocator() {
     for (auto& pair : allocators_) {
-      // Now memory stats is only supported for GPU
-      if (platform::is_gpu_place(pair.first)) {
+      // Now memory stats is only supported for GPU and CPU, whose
+      // allocations are counted in the "HostAllocated" stat. It is wrapped
+      // inside the ReuseAllocator, so the reused buffers are not counted.
+      if (platform::is_gpu_place(pair.first) ||
+          platform::is_cpu_place(pair.first)) {
         pair.second = std::make_shared<StatAllocator>(pair.second);
       }
     }
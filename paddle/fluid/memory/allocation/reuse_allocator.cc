@@ -0,0 +1,131 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/reuse_allocator.h"
+
+#include <algorithm>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+ReuseAllocator::ReuseAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                               size_t capacity)
+    : underlying_allocator_(std::move(underlying_allocator)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of ReuseAllocator is NULL"));
+  PADDLE_ENFORCE_EQ(
+      underlying_allocator_->IsAllocThreadSafe(), true,
+      platform::errors::InvalidArgument(
+          "Underlying allocator of ReuseAllocator must be thread safe"));
+  stats_.capacity = capacity;
+}
+
+ReuseAllocator::~ReuseAllocator() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ShrinkCache(0);
+}
+
+void ReuseAllocator::SetCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  stats_.capacity = capacity;
+  ShrinkCache(capacity);
+}
+
+ReuseAllocatorStats ReuseAllocator::GetStats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+void ReuseAllocator::ShrinkCache(size_t capacity) {
+  if (stats_.cached_bytes <= capacity) {
+    return;
+  }
+  std::vector<size_t> sizes;
+  sizes.reserve(cache_.size());
+  for (auto& pair : cache_) {
+    sizes.push_back(pair.first);
+  }
+  std::sort(sizes.begin(), sizes.end(), std::greater<size_t>());
+  for (size_t size : sizes) {
+    auto& allocations = cache_[size];
+    while (!allocations.empty() && stats_.cached_bytes > capacity) {
+      underlying_allocator_->Free(allocations.back());
+      allocations.pop_back();
+      stats_.cached_bytes -= size;
+    }
+    if (allocations.empty()) {
+      cache_.erase(size);
+    }
+    if (stats_.cached_bytes <= capacity) {
+      break;
+    }
+  }
+}
+
+void ReuseAllocator::FreeImpl(phi::Allocation* allocation) {
+  size_t size = allocation->size();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stats_.allocated_bytes -= size;
+    if (stats_.cached_bytes + size <= stats_.capacity) {
+      cache_[size].push_back(allocation);
+      stats_.cached_bytes += size;
+      return;
+    }
+  }
+  underlying_allocator_->Free(allocation);
+}
+
+phi::Allocation* ReuseAllocator::AllocateImpl(size_t size) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = cache_.find(size);
+    if (it != cache_.end()) {
+      phi::Allocation* allocation = it->second.back();
+      it->second.pop_back();
+      if (it->second.empty()) {
+        cache_.erase(it);
+      }
+      stats_.cached_bytes -= size;
+      stats_.allocated_bytes += size;
+      stats_.peak_allocated_bytes =
+          std::max(stats_.peak_allocated_bytes, stats_.allocated_bytes);
+      ++stats_.num_hits;
+      return allocation;
+    }
+  }
+  phi::Allocation* allocation =
+      underlying_allocator_->Allocate(size).release();
+  std::lock_guard<std::mutex> guard(mutex_);
+  stats_.allocated_bytes += allocation->size();
+  stats_.peak_allocated_bytes =
+      std::max(stats_.peak_allocated_bytes, stats_.allocated_bytes);
+  ++stats_.num_misses;
+  return allocation;
+}
+
+uint64_t ReuseAllocator::ReleaseImpl(const platform::Place& place) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ShrinkCache(0);
+  }
+  return underlying_allocator_->Release(place);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,79 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+struct ReuseAllocatorStats {
+  // bytes handed out and not freed yet, and the peak of them
+  size_t allocated_bytes{0};
+  size_t peak_allocated_bytes{0};
+  // bytes freed and kept for reuse
+  size_t cached_bytes{0};
+  size_t capacity{0};
+  uint64_t num_hits{0};
+  uint64_t num_misses{0};
+};
+
+// ReuseAllocator keeps freed allocations, up to capacity bytes, and hands
+// them out again to allocations of exactly the same size, so a workload
+// which allocates the same shapes in every iteration skips the underlying
+// allocator. Unlike BufferedAllocator, the cache is bounded and never gives
+// out a larger allocation than requested. It is put in front of the CPU
+// allocator when FLAGS_enable_adaptive_gc is on, and its capacity is tuned
+// by the AdaptiveGarbageReleaser.
+class ReuseAllocator : public Allocator {
+ public:
+  explicit ReuseAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                          size_t capacity = 0);
+
+  ~ReuseAllocator();
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Allocations beyond the new capacity are freed to the underlying
+  // allocator, largest first.
+  void SetCapacity(size_t capacity);
+
+  ReuseAllocatorStats GetStats() const;
+
+ protected:
+  void FreeImpl(phi::Allocation* allocation) override;
+  phi::Allocation* AllocateImpl(size_t size) override;
+  uint64_t ReleaseImpl(const platform::Place& place) override;
+
+ private:
+  // Must be called with mutex_ held.
+  void ShrinkCache(size_t capacity);
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  std::unordered_map<size_t, std::vector<phi::Allocation*>> cache_;
+  ReuseAllocatorStats stats_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
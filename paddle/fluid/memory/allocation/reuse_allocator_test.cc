@@ -0,0 +1,73 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/reuse_allocator.h"
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(reuse_allocator, reuse_same_size) {
+  auto allocator =
+      std::make_shared<ReuseAllocator>(std::make_shared<CPUAllocator>(), 1024);
+  void* ptr = nullptr;
+  {
+    auto allocation = allocator->Allocate(256);
+    ptr = allocation->ptr();
+  }
+  auto stats = allocator->GetStats();
+  EXPECT_EQ(stats.cached_bytes, 256UL);
+  EXPECT_EQ(stats.allocated_bytes, 0UL);
+
+  // A different size does not take the cached allocation
+  auto other = allocator->Allocate(128);
+  EXPECT_NE(other->ptr(), ptr);
+  auto same = allocator->Allocate(256);
+  EXPECT_EQ(same->ptr(), ptr);
+
+  stats = allocator->GetStats();
+  EXPECT_EQ(stats.num_hits, 1UL);
+  EXPECT_EQ(stats.num_misses, 2UL);
+  EXPECT_EQ(stats.cached_bytes, 0UL);
+  EXPECT_EQ(stats.allocated_bytes, 384UL);
+  EXPECT_EQ(stats.peak_allocated_bytes, 384UL);
+}
+
+TEST(reuse_allocator, capacity) {
+  auto allocator =
+      std::make_shared<ReuseAllocator>(std::make_shared<CPUAllocator>(), 1024);
+  auto small = allocator->Allocate(256);
+  auto large = allocator->Allocate(768);
+  auto too_large = allocator->Allocate(512);
+  small.reset();
+  large.reset();
+  too_large.reset();
+  // Only the allocations within the capacity are kept
+  EXPECT_EQ(allocator->GetStats().cached_bytes, 1024UL);
+
+  // Shrinking the capacity frees the largest first
+  allocator->SetCapacity(300);
+  EXPECT_EQ(allocator->GetStats().cached_bytes, 256UL);
+
+  allocator->Release(platform::CPUPlace());
+  EXPECT_EQ(allocator->GetStats().cached_bytes, 0UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
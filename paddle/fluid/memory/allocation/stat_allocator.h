@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation_profiler.h"
 #include "paddle/fluid/memory/stats.h"
 
 namespace paddle {
@@ -30,16 +31,34 @@ class StatAllocator : public Allocator {
 
  protected:
   void FreeImpl(phi::Allocation* allocation) override {
+    if (platform::is_cpu_place(allocation->place())) {
+      HOST_MEMORY_STAT_UPDATE(Allocated, -allocation->size());
+      underlying_allocator_->Free(allocation);
+      return;
+    }
     MEMORY_STAT_UPDATE(Allocated, allocation->place().GetDeviceId(),
                        -allocation->size());
+    auto& profiler = AllocationProfiler::Instance();
+    if (UNLIKELY(profiler.HasLiveAllocations())) {
+      profiler.RecordFree(allocation);
+    }
     underlying_allocator_->Free(allocation);
   }
 
   phi::Allocation* AllocateImpl(size_t size) override {
     phi::Allocator::AllocationPtr allocation =
         underlying_allocator_->Allocate(size);
+    if (platform::is_cpu_place(allocation->place())) {
+      HOST_MEMORY_STAT_UPDATE(Allocated, allocation->size());
+      return allocation.release();
+    }
     MEMORY_STAT_UPDATE(Allocated, allocation->place().GetDeviceId(),
                        allocation->size());
+    if (UNLIKELY(AllocationProfiler::IsEnabled())) {
+      AllocationProfiler::Instance().RecordAlloc(
+          allocation.get(), allocation->size(),
+          allocation->place().GetDeviceId());
+    }
     return allocation.release();
   }
 
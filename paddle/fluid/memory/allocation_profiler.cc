@@ -0,0 +1,228 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/memory/allocation_profiler.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+DECLARE_bool(enable_allocation_profiling);
+DECLARE_int32(allocation_profiling_sample_rate);
+
+namespace paddle {
+namespace memory {
+
+static thread_local const AllocationProfileScope* current_scope = nullptr;
+
+AllocationProfileScope::AllocationProfileScope(const std::string& op_type,
+                                               const std::string& var_name,
+                                               const std::string& call_site)
+    : op_type_(op_type),
+      var_name_(var_name),
+      call_site_(call_site),
+      parent_(current_scope) {
+  current_scope = this;
+}
+
+AllocationProfileScope::~AllocationProfileScope() { current_scope = parent_; }
+
+const AllocationProfileScope* AllocationProfileScope::Current() {
+  return current_scope;
+}
+
+AllocationProfiler& AllocationProfiler::Instance() {
+  static AllocationProfiler instance;
+  return instance;
+}
+
+bool AllocationProfiler::IsEnabled() {
+  return FLAGS_enable_allocation_profiling;
+}
+
+static int64_t SampleRate() {
+  return std::max(FLAGS_allocation_profiling_sample_rate, 1);
+}
+
+void AllocationProfiler::RecordAlloc(const void* ptr, size_t size,
+                                     int dev_id) {
+  int64_t sample_rate = SampleRate();
+  if (sample_rate > 1) {
+    static thread_local int64_t alloc_counter = 0;
+    if (++alloc_counter < sample_rate) {
+      return;
+    }
+    alloc_counter = 0;
+  }
+
+  AllocationSite site;
+  site.dev_id = dev_id;
+  const AllocationProfileScope* scope = current_scope;
+  if (scope != nullptr) {
+    site.op_type = scope->OpType();
+    site.var_name = scope->VarName();
+    site.call_site = scope->CallSite();
+  }
+  int64_t bytes = static_cast<int64_t>(size) * sample_rate;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = sites_.emplace(std::move(site), AllocationSiteStat()).first;
+  AllocationSiteStat& stat = it->second;
+  stat.live_bytes += bytes;
+  stat.peak_live_bytes = std::max(stat.peak_live_bytes, stat.live_bytes);
+  stat.alloc_bytes += bytes;
+  stat.alloc_count += sample_rate;
+  LiveAllocation allocation{it, bytes, sample_rate};
+  if (live_allocations_.emplace(ptr, allocation).second) {
+    num_live_allocations_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void AllocationProfiler::RecordFree(const void* ptr) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = live_allocations_.find(ptr);
+  if (it == live_allocations_.end()) {
+    return;
+  }
+  AllocationSiteStat& stat = it->second.site->second;
+  stat.live_bytes -= it->second.bytes;
+  stat.free_count += it->second.sample_rate;
+  live_allocations_.erase(it);
+  num_live_allocations_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+AllocationProfileSnapshot AllocationProfiler::Snapshot() {
+  AllocationProfileSnapshot snapshot;
+  snapshot.sample_rate = SampleRate();
+  std::lock_guard<std::mutex> guard(mutex_);
+  snapshot.sites = sites_;
+  return snapshot;
+}
+
+void AllocationProfiler::Reset() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  sites_.clear();
+  live_allocations_.clear();
+  num_live_allocations_.store(0, std::memory_order_relaxed);
+}
+
+static std::string EscapeField(const std::string& field) {
+  if (field.empty()) {
+    return "-";
+  }
+  std::string escaped = field;
+  std::replace(escaped.begin(), escaped.end(), '\t', ' ');
+  std::replace(escaped.begin(), escaped.end(), '\n', ' ');
+  return escaped;
+}
+
+static std::string UnescapeField(const std::string& field) {
+  return field == "-" ? "" : field;
+}
+
+std::string AllocationProfileSnapshot::ToString() const {
+  using SiteIter = std::map<AllocationSite, AllocationSiteStat>::const_iterator;
+  std::vector<SiteIter> ordered;
+  ordered.reserve(sites.size());
+  for (auto it = sites.begin(); it != sites.end(); ++it) {
+    ordered.push_back(it);
+  }
+  std::stable_sort(ordered.begin(), ordered.end(),
+                   [](const SiteIter& lhs, const SiteIter& rhs) {
+                     return lhs->second.live_bytes > rhs->second.live_bytes;
+                   });
+
+  std::ostringstream sout;
+  sout << "# sample_rate\t" << sample_rate << "\n";
+  for (const auto& it : ordered) {
+    const AllocationSite& site = it->first;
+    const AllocationSiteStat& stat = it->second;
+    sout << site.dev_id << "\t" << EscapeField(site.op_type) << "\t"
+         << EscapeField(site.var_name) << "\t" << EscapeField(site.call_site)
+         << "\t" << stat.live_bytes << "\t" << stat.peak_live_bytes << "\t"
+         << stat.alloc_bytes << "\t" << stat.alloc_count << "\t"
+         << stat.free_count << "\n";
+  }
+  return sout.str();
+}
+
+AllocationProfileSnapshot AllocationProfileSnapshot::FromString(
+    const std::string& str) {
+  AllocationProfileSnapshot snapshot;
+  std::istringstream sin(str);
+  std::string line;
+  while (std::getline(sin, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::istringstream line_in(line);
+    std::string field;
+    while (std::getline(line_in, field, '\t')) {
+      fields.push_back(field);
+    }
+    if (fields[0] == "# sample_rate") {
+      PADDLE_ENFORCE_EQ(fields.size(), 2UL,
+                        platform::errors::InvalidArgument(
+                            "Invalid allocation profile header: %s", line));
+      snapshot.sample_rate = std::stoll(fields[1]);
+      continue;
+    }
+    PADDLE_ENFORCE_EQ(fields.size(), 9UL,
+                      platform::errors::InvalidArgument(
+                          "Invalid allocation profile line: %s", line));
+    AllocationSite site;
+    site.dev_id = std::stoi(fields[0]);
+    site.op_type = UnescapeField(fields[1]);
+    site.var_name = UnescapeField(fields[2]);
+    site.call_site = UnescapeField(fields[3]);
+    AllocationSiteStat stat;
+    stat.live_bytes = std::stoll(fields[4]);
+    stat.peak_live_bytes = std::stoll(fields[5]);
+    stat.alloc_bytes = std::stoll(fields[6]);
+    stat.alloc_count = std::stoll(fields[7]);
+    stat.free_count = std::stoll(fields[8]);
+    snapshot.sites[site] = stat;
+  }
+  return snapshot;
+}
+
+AllocationProfileSnapshot DiffAllocationProfileSnapshots(
+    const AllocationProfileSnapshot& before,
+    const AllocationProfileSnapshot& after) {
+  AllocationProfileSnapshot diff;
+  diff.sample_rate = after.sample_rate;
+  for (const auto& pair : after.sites) {
+    AllocationSiteStat stat = pair.second;
+    auto it = before.sites.find(pair.first);
+    if (it != before.sites.end()) {
+      stat.live_bytes -= it->second.live_bytes;
+      stat.alloc_bytes -= it->second.alloc_bytes;
+      stat.alloc_count -= it->second.alloc_count;
+      stat.free_count -= it->second.free_count;
+    }
+    if (stat.live_bytes != 0 || stat.alloc_count != 0 ||
+        stat.free_count != 0) {
+      diff.sites[pair.first] = stat;
+    }
+  }
+  return diff;
+}
+
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,140 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace memory {
+
+// The allocation site that a sampled allocation is attributed to. A site is
+// the op (type and output variable) that was running on the allocating thread
+// together with the Python or C++ code location that created it.
+struct AllocationSite {
+  int dev_id{0};
+  std::string op_type;
+  std::string var_name;
+  std::string call_site;
+
+  bool operator<(const AllocationSite& other) const {
+    return std::tie(dev_id, op_type, var_name, call_site) <
+           std::tie(other.dev_id, other.op_type, other.var_name,
+                    other.call_site);
+  }
+};
+
+struct AllocationSiteStat {
+  int64_t live_bytes{0};
+  int64_t peak_live_bytes{0};
+  int64_t alloc_bytes{0};
+  int64_t alloc_count{0};
+  int64_t free_count{0};
+};
+
+// A point-in-time copy of the per-site statistics. Snapshots of two steps can
+// be subtracted with DiffAllocationProfileSnapshots to find the sites that
+// leak memory, and are serialized as tab-separated text so that they can be
+// dumped to files and compared offline as well.
+struct AllocationProfileSnapshot {
+  int64_t sample_rate{1};
+  std::map<AllocationSite, AllocationSiteStat> sites;
+
+  // One line per site, sorted by live bytes in descending order:
+  // dev_id \t op_type \t var_name \t call_site \t live_bytes \t
+  // peak_live_bytes \t alloc_bytes \t alloc_count \t free_count
+  std::string ToString() const;
+  static AllocationProfileSnapshot FromString(const std::string& str);
+};
+
+// Returns after - before for every site, sites whose counters did not change
+// are dropped. peak_live_bytes is taken from `after`.
+AllocationProfileSnapshot DiffAllocationProfileSnapshots(
+    const AllocationProfileSnapshot& before,
+    const AllocationProfileSnapshot& after);
+
+// Marks the current thread as running an op, allocations made on this thread
+// during the lifetime of the scope are attributed to the given site. Scopes
+// can be nested, the innermost one wins.
+class AllocationProfileScope {
+ public:
+  AllocationProfileScope(const std::string& op_type,
+                         const std::string& var_name,
+                         const std::string& call_site);
+  ~AllocationProfileScope();
+
+  const std::string& OpType() const { return op_type_; }
+  const std::string& VarName() const { return var_name_; }
+  const std::string& CallSite() const { return call_site_; }
+
+  static const AllocationProfileScope* Current();
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(AllocationProfileScope);
+
+  std::string op_type_;
+  std::string var_name_;
+  std::string call_site_;
+  const AllocationProfileScope* parent_;
+};
+
+// AllocationProfiler samples 1 out of FLAGS_allocation_profiling_sample_rate
+// allocations made through the AllocatorFacade while
+// FLAGS_enable_allocation_profiling is on, and keeps the live bytes of every
+// allocation site. The byte counters of sampled allocations are scaled by the
+// sample rate, so they are estimates unless the sample rate is 1.
+class AllocationProfiler {
+ public:
+  static AllocationProfiler& Instance();
+
+  static bool IsEnabled();
+
+  // Whether some allocation recorded by RecordAlloc is still alive. Frees are
+  // tracked as long as this is true, even if profiling has been disabled.
+  bool HasLiveAllocations() const {
+    return num_live_allocations_.load(std::memory_order_relaxed) > 0;
+  }
+
+  void RecordAlloc(const void* ptr, size_t size, int dev_id);
+  void RecordFree(const void* ptr);
+
+  AllocationProfileSnapshot Snapshot();
+  void Reset();
+
+ private:
+  AllocationProfiler() = default;
+  DISABLE_COPY_AND_ASSIGN(AllocationProfiler);
+
+  struct LiveAllocation {
+    std::map<AllocationSite, AllocationSiteStat>::iterator site;
+    int64_t bytes;
+    // The sample rate when it was allocated, which its free is scaled by.
+    int64_t sample_rate;
+  };
+
+  std::mutex mutex_;
+  std::map<AllocationSite, AllocationSiteStat> sites_;
+  std::unordered_map<const void*, LiveAllocation> live_allocations_;
+  std::atomic<int64_t> num_live_allocations_{0};
+};
+
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,123 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation_profiler.h"
+
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+
+DECLARE_bool(enable_allocation_profiling);
+DECLARE_int32(allocation_profiling_sample_rate);
+
+namespace paddle {
+namespace memory {
+
+static AllocationSite MakeSite(const std::string& op_type,
+                               const std::string& var_name) {
+  AllocationSite site;
+  site.op_type = op_type;
+  site.var_name = var_name;
+  return site;
+}
+
+TEST(allocation_profiler_test, LiveBytesBySite) {
+  FLAGS_enable_allocation_profiling = true;
+  auto& profiler = AllocationProfiler::Instance();
+  profiler.Reset();
+
+  int a = 0, b = 0, c = 0;
+  {
+    AllocationProfileScope scope("matmul", "fc_0.tmp_0", "");
+    profiler.RecordAlloc(&a, 100, 0);
+    profiler.RecordAlloc(&b, 200, 0);
+    {
+      AllocationProfileScope inner("relu", "fc_0.tmp_1", "");
+      profiler.RecordAlloc(&c, 50, 0);
+    }
+  }
+  EXPECT_TRUE(profiler.HasLiveAllocations());
+  profiler.RecordFree(&a);
+
+  auto snapshot = profiler.Snapshot();
+  ASSERT_EQ(snapshot.sites.size(), 2UL);
+  auto& matmul = snapshot.sites.at(MakeSite("matmul", "fc_0.tmp_0"));
+  EXPECT_EQ(matmul.live_bytes, 200);
+  EXPECT_EQ(matmul.peak_live_bytes, 300);
+  EXPECT_EQ(matmul.alloc_count, 2);
+  EXPECT_EQ(matmul.free_count, 1);
+  EXPECT_EQ(snapshot.sites.at(MakeSite("relu", "fc_0.tmp_1")).live_bytes, 50);
+
+  profiler.RecordFree(&b);
+  profiler.RecordFree(&c);
+  EXPECT_FALSE(profiler.HasLiveAllocations());
+  profiler.Reset();
+  FLAGS_enable_allocation_profiling = false;
+}
+
+TEST(allocation_profiler_test, SnapshotDiff) {
+  FLAGS_enable_allocation_profiling = true;
+  auto& profiler = AllocationProfiler::Instance();
+  profiler.Reset();
+
+  int a = 0, b = 0;
+  AllocationProfileScope scope("concat", "concat_0.tmp_0",
+                               "File \"train.py\", line 3, in <module>");
+  profiler.RecordAlloc(&a, 64, 0);
+  // Round trip through the text format, as when diffing dumped files.
+  auto before = AllocationProfileSnapshot::FromString(
+      profiler.Snapshot().ToString());
+  profiler.RecordAlloc(&b, 64, 0);
+  auto diff = DiffAllocationProfileSnapshots(before, profiler.Snapshot());
+
+  ASSERT_EQ(diff.sites.size(), 1UL);
+  auto& site = diff.sites.begin()->first;
+  EXPECT_EQ(site.call_site, "File \"train.py\", line 3, in <module>");
+  EXPECT_EQ(diff.sites.begin()->second.live_bytes, 64);
+  EXPECT_EQ(diff.sites.begin()->second.alloc_count, 1);
+
+  profiler.Reset();
+  FLAGS_enable_allocation_profiling = false;
+}
+
+TEST(allocation_profiler_test, Sampling) {
+  FLAGS_enable_allocation_profiling = true;
+  FLAGS_allocation_profiling_sample_rate = 4;
+  auto& profiler = AllocationProfiler::Instance();
+  profiler.Reset();
+
+  int data[8];
+  for (int i = 0; i < 8; ++i) {
+    profiler.RecordAlloc(&data[i], 10, 0);
+  }
+  auto snapshot = profiler.Snapshot();
+  ASSERT_EQ(snapshot.sites.size(), 1UL);
+  EXPECT_EQ(snapshot.sites.begin()->second.alloc_count, 8);
+  EXPECT_EQ(snapshot.sites.begin()->second.live_bytes, 80);
+
+  // The frees are scaled by the sample rate of their allocations.
+  FLAGS_allocation_profiling_sample_rate = 1;
+  for (int i = 0; i < 8; ++i) {
+    profiler.RecordFree(&data[i]);
+  }
+  snapshot = profiler.Snapshot();
+  EXPECT_EQ(snapshot.sites.begin()->second.free_count, 8);
+  EXPECT_EQ(snapshot.sites.begin()->second.live_bytes, 0);
+
+  profiler.Reset();
+  FLAGS_allocation_profiling_sample_rate = 1;
+  FLAGS_enable_allocation_profiling = false;
+}
+
+}  // namespace memory
+}  // namespace paddle
@@ -45,6 +45,10 @@ class StatRegistry {
     return GetStat(stat_type, dev_id)->GetCurrentValue();
   }
 
+  int64_t GetThreadCurrentValue(const std::string& stat_type, int dev_id) {
+    return GetStat(stat_type, dev_id)->GetThreadCurrentValue();
+  }
+
   int64_t GetPeakValue(const std::string& stat_type, int dev_id) {
     return GetStat(stat_type, dev_id)->GetPeakValue();
   }
@@ -76,6 +80,10 @@ int64_t StatGetCurrentValue(const std::string& stat_type, int dev_id) {
   return StatRegistry::GetInstance()->GetCurrentValue(stat_type, dev_id);
 }
 
+int64_t StatGetThreadCurrentValue(const std::string& stat_type, int dev_id) {
+  return StatRegistry::GetInstance()->GetThreadCurrentValue(stat_type, dev_id);
+}
+
 int64_t StatGetPeakValue(const std::string& stat_type, int dev_id) {
   return StatRegistry::GetInstance()->GetPeakValue(stat_type, dev_id);
 }
@@ -84,6 +92,10 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment) {
   StatRegistry::GetInstance()->Update(stat_type, dev_id, increment);
 }
 
+StatBase* StatGetInstance(const std::string& stat_type, int dev_id) {
+  return StatRegistry::GetInstance()->GetStat(stat_type, dev_id);
+}
+
 #define MEMORY_STAT_REGISTER_WITH_ID(item, id) \
   StatRegistry::GetInstance()->Register(       \
       #item, id, Stat<ThreadLocalStatDevice##id##item>::GetInstance());
@@ -109,6 +121,8 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment) {
 int RegisterAllStats() {
   MEMORY_STAT_REGISTER(Allocated);
   MEMORY_STAT_REGISTER(Reserved);
+  StatRegistry::GetInstance()->Register(
+      "HostAllocated", 0, Stat<ThreadLocalStatHostAllocated>::GetInstance());
   return 0;
 }
 
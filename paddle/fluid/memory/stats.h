@@ -38,6 +38,7 @@ class StatBase {
   virtual ~StatBase() = default;
 
   virtual int64_t GetCurrentValue() = 0;
+  virtual int64_t GetThreadCurrentValue() = 0;
   virtual int64_t GetPeakValue() = 0;
   virtual void Update(int64_t) = 0;
 
@@ -64,6 +65,13 @@ class Stat : public StatBase {
     return current_value;
   }
 
+  // The value updated by the calling thread only.
+  int64_t GetThreadCurrentValue() override {
+    return ThreadDataRegistry<ThreadLocalStatType>::GetInstance()
+        .GetMutableCurrentThreadData()
+        ->current;
+  }
+
   int64_t GetPeakValue() override { return peak_value_; }
 
   void Update(int64_t increment) override {
@@ -97,8 +105,12 @@ class Stat : public StatBase {
 // MEMORY_STAT_UPDATE. Try to use the macro functions where ultra-low
 // performance overhead is required.
 int64_t StatGetCurrentValue(const std::string& stat_type, int dev_id);
+int64_t StatGetThreadCurrentValue(const std::string& stat_type, int dev_id);
 int64_t StatGetPeakValue(const std::string& stat_type, int dev_id);
 void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment);
+// The registered STAT, which callers reading it often can keep to skip the
+// lookup by string.
+StatBase* StatGetInstance(const std::string& stat_type, int dev_id);
 
 #define MEMORY_STAT_FUNC_SWITHCH_CASE(item, id)                          \
   case id:                                                               \
@@ -168,5 +180,13 @@ void StatUpdate(const std::string& stat_type, int dev_id, int64_t increment);
 MEMORY_STAT_DECLARE(Allocated);
 MEMORY_STAT_DECLARE(Reserved);
 
+// The host memory allocated through the CPU allocator of AllocatorFacade,
+// registered as "HostAllocated" of device 0.
+struct ThreadLocalStatHostAllocated : public ThreadLocalStatBase {};
+
+#define HOST_MEMORY_STAT_UPDATE(item, increment)                    \
+  paddle::memory::Stat<paddle::memory::ThreadLocalStatHost##item>:: \
+      GetInstance()->Update(increment)
+
 }  // namespace memory
 }  // namespace paddle
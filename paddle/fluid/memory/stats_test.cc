@@ -103,5 +103,28 @@ TEST(stats_test, PeakValueTest) {
   EXPECT_EQ(StatGetPeakValue(stat_type, 0), peak_value);
 }
 
+TEST(stats_test, ThreadCurrentValueTest) {
+  std::string stat_type = "Reserved";
+  int64_t main_value = StatGetThreadCurrentValue(stat_type, 1);
+  std::thread thread([&stat_type]() {
+    int64_t value = StatGetThreadCurrentValue(stat_type, 1);
+    StatUpdate(stat_type, 1, 100);
+    EXPECT_EQ(StatGetThreadCurrentValue(stat_type, 1), value + 100);
+    StatUpdate(stat_type, 1, -100);
+  });
+  thread.join();
+  EXPECT_EQ(StatGetThreadCurrentValue(stat_type, 1), main_value);
+}
+
+TEST(stats_test, HostAllocatedTest) {
+  StatBase* stat = StatGetInstance("HostAllocated", 0);
+  int64_t value = stat->GetThreadCurrentValue();
+  HOST_MEMORY_STAT_UPDATE(Allocated, 100);
+  EXPECT_EQ(stat->GetThreadCurrentValue(), value + 100);
+  EXPECT_EQ(StatGetThreadCurrentValue("HostAllocated", 0), value + 100);
+  HOST_MEMORY_STAT_UPDATE(Allocated, -100);
+  EXPECT_EQ(stat->GetThreadCurrentValue(), value);
+}
+
 }  // namespace memory
 }  // namespace paddle
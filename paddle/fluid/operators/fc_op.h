@@ -49,6 +49,31 @@ inline void FCOutputSize(const framework::DDim& in_dims,
   out_dims.push_back(w_dims1);
 }
 
+// The fc with int8 weights, written by the CPU post-training quantizer of
+// the inference, only has a CPU implementation.
+template <typename DeviceContext, typename T>
+struct Int8FCCompute {
+  void operator()(const DeviceContext& dev_ctx, int M, int N, int K,
+                  const T* input_data, float scale_in, const int8_t* w_data,
+                  const float* scale_weights, T* output_data,
+                  const T* bias_data, bool with_relu) const {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The fc operator with int8 weights is only supported on CPU."));
+  }
+};
+
+template <typename T>
+struct Int8FCCompute<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& dev_ctx, int M, int N,
+                  int K, const T* input_data, float scale_in,
+                  const int8_t* w_data, const float* scale_weights,
+                  T* output_data, const T* bias_data, bool with_relu) const {
+    phi::funcs::Int8FCFunctor<T> fc;
+    fc(M, N, K, input_data, scale_in, w_data, scale_weights, output_data,
+       bias_data, with_relu);
+  }
+};
+
 template <typename DeviceContext, typename T>
 class FCOpKernel : public framework::OpKernel<T> {
  public:
@@ -76,10 +101,30 @@ class FCOpKernel : public framework::OpKernel<T> {
     int M = phi::product(out_dims) / w_dims1;
 
     const T* input_data = input->data<T>();
-    const T* w_data = w->data<T>();
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
-
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
+
+    if (framework::TransToProtoVarType(w->dtype()) ==
+        framework::proto::VarType::INT8) {
+      PADDLE_ENFORCE_EQ(
+          padding_weights, false,
+          platform::errors::InvalidArgument(
+              "The int8 weights of fc can not be padded."));
+      auto scale_weights = ctx.Attr<std::vector<float>>("Scale_weights");
+      PADDLE_ENFORCE_EQ(
+          scale_weights.size(), static_cast<size_t>(w_dims1),
+          platform::errors::InvalidArgument(
+              "The int8 weights of fc need a scale per output channel, "
+              "expected %d scales, but received %d.",
+              w_dims1, scale_weights.size()));
+      Int8FCCompute<DeviceContext, T>()(
+          dev_ctx, M, w_dims1, w_dims0, input_data, ctx.Attr<float>("Scale_in"),
+          w->data<int8_t>(), scale_weights.data(), output_data,
+          bias ? bias->data<T>() : NULL, with_relu);
+      return;
+    }
+
+    const T* w_data = w->data<T>();
     phi::funcs::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, M, w_dims1, w_dims0, input_data, w_data, output_data,
        bias ? bias->data<T>() : NULL, with_relu, padding_weights);
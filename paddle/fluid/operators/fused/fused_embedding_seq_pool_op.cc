@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/fused/fused_embedding_seq_pool_op.h"
 #include <memory>
+#include "paddle/fluid/framework/op_version_registry.h"
 #include "paddle/fluid/framework/var_type_inference.h"
 
 namespace paddle {
@@ -44,11 +45,17 @@ class FusedEmbeddingSeqPoolOp : public framework::OperatorWithKernel {
             "The last dimension of the input tensor 'Ids' should be 1. "
             "But received Ids's size in the last dimension = %d.",
             ids_dims[ids_dims.size() - 1]));
-    // we only support sum now
-    PADDLE_ENFORCE_EQ(combiner, "sum",
-                      platform::errors::Unimplemented(
-                          "The pooling type of sequence_pool only support sum "
-                          "now. So the 'combiner' must be 'sum'."));
+    // throws on the combiners other than sum, mean, sqrt and max
+    phi::funcs::GetEmbeddingPoolType(combiner);
+    if (ctx->HasInput("IdWeight")) {
+      auto weight_dims = ctx->GetInputDim("IdWeight");
+      PADDLE_ENFORCE_EQ(weight_dims, ids_dims,
+                        platform::errors::InvalidArgument(
+                            "The shape of Input(IdWeight) should be equal to "
+                            "the shape of Input(Ids). But received "
+                            "IdWeight's shape = [%s], Ids's shape = [%s].",
+                            weight_dims, ids_dims));
+    }
 
     int64_t last_dim = FusedEmbeddingSeqPoolLastDim(table_dims, ids_dims);
     // in compile time, the lod level of ids must be 1
@@ -83,12 +90,21 @@ class FusedEmbeddingSeqPoolOpMaker : public framework::OpProtoAndCheckerMaker {
              "An input with type int32 or int64 "
              "contains the ids to be looked up in W. "
              "The last dimension size must be 1.");
+    AddInput("IdWeight",
+             "(LoDTensor, optional) The weights of the ids, which have the "
+             "same shape as Ids and the same type as W. The rows looked up "
+             "are scaled by their weights before the pooling. The weights "
+             "get no gradient.")
+        .AsDispensable();
     AddOutput("Out", "The lookup results, which have the same type as W.");
     AddAttr<std::string>("combiner",
                          "(string, default sum) "
-                         "A string specifying the reduction op. Currently sum "
-                         "are supported, sum computes the weighted sum of the "
-                         "embedding results for each row.")
+                         "A string specifying the reduction op. sum computes "
+                         "the weighted sum of the embedding results of each "
+                         "row, mean divides it by the sum of the weights, "
+                         "sqrt divides it by the square root of the sum of "
+                         "the squared weights, and max takes the element-wise "
+                         "max of the weighted embedding results.")
         .SetDefault("sum");
     AddAttr<int64_t>("padding_idx",
                      "(int64, default -1) "
@@ -115,8 +131,8 @@ FusedEmbeddingSeqPool Operator.
 Computes embeddings for the given ids and weights.
 
 This operator is used to perform lookups on the parameter W,
-then computes the weighted sum of the lookups results for each row
-and concatenated into a dense tensor.
+then pools the lookups results of each row, weighted by IdWeight if given,
+with the combiner and concatenates them into a dense tensor.
 
 The input Ids should carry the LoD (Level of Details) information.
 And the output will change the LoD information with input Ids.
@@ -174,6 +190,9 @@ class FusedEmbeddingSeqPoolGradOpMaker
     op->SetType("fused_embedding_seq_pool_grad");
     op->SetInput("Ids", this->Input("Ids"));
     op->SetInput("W", this->Input("W"));
+    if (this->HasInput("IdWeight")) {
+      op->SetInput("IdWeight", this->Input("IdWeight"));
+    }
     op->SetInput(framework::GradVarName("Out"), this->OutputGrad("Out"));
     op->SetOutput(framework::GradVarName("W"), this->InputGrad("W"));
     op->SetAttrMap(this->Attrs());
@@ -194,9 +213,20 @@ REGISTER_OPERATOR(fused_embedding_seq_pool_grad,
                   ops::FusedEmbeddingSeqPoolOpGrad,
                   ops::FusedEmbeddingSeqPoolOpGradVarTypeInference);
 
-REGISTER_OP_CPU_KERNEL(fused_embedding_seq_pool,
-                       ops::FusedEmbeddingSeqPoolKernel<float>,
-                       ops::FusedEmbeddingSeqPoolKernel<double>);
-REGISTER_OP_CPU_KERNEL(fused_embedding_seq_pool_grad,
-                       ops::FusedEmbeddingSeqPoolGradKernel<float>,
-                       ops::FusedEmbeddingSeqPoolGradKernel<double>);
+REGISTER_OP_CPU_KERNEL(
+    fused_embedding_seq_pool, ops::FusedEmbeddingSeqPoolKernel<float>,
+    ops::FusedEmbeddingSeqPoolKernel<double>,
+    ops::FusedEmbeddingSeqPoolKernel<paddle::platform::bfloat16>);
+REGISTER_OP_CPU_KERNEL(
+    fused_embedding_seq_pool_grad, ops::FusedEmbeddingSeqPoolGradKernel<float>,
+    ops::FusedEmbeddingSeqPoolGradKernel<double>,
+    ops::FusedEmbeddingSeqPoolGradKernel<paddle::platform::bfloat16>);
+
+REGISTER_OP_VERSION(fused_embedding_seq_pool)
+    .AddCheckpoint(
+        R"ROC(
+              Upgrade fused_embedding_seq_pool by adding the per-id weights
+              IdWeight and the mean, sqrt and max combiners.)ROC",
+        paddle::framework::compatible::OpVersionDesc().NewInput(
+            "IdWeight", "The weights of the ids, which scale the rows looked "
+                        "up before the pooling."));
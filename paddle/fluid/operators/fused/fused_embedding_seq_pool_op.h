@@ -14,16 +14,13 @@ limitations under the License. */
 
 #pragma once
 
-#include <map>
 #include <string>
 #include <vector>
 
-#include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows_utils.h"
-#include "paddle/fluid/operators/jit/kernels.h"
-#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/cpu_embedding_pool.h"
 
 namespace paddle {
 namespace operators {
@@ -35,87 +32,6 @@ using DDim = framework::DDim;
 
 constexpr int64_t kNoPadding = -1;
 
-#if defined(PADDLE_WITH_MKLML) && !defined(_WIN32) && !defined(__APPLE__) && \
-    !defined(__OSX__)
-template <typename T>
-void prepare_csr_data(const std::vector<uint64_t> &offset,
-                      const int64_t *ids_data, const size_t idx_width,
-                      T *csr_vals, int *csr_colmuns, int *csr_row_idx,
-                      int64_t padding_idx = kNoPadding) {
-  int val_idx = 0;
-  int row_idx = 0;
-  csr_row_idx[0] = 0;
-
-  std::map<int, int> ids_map;
-
-  // for each sequence in batch
-  for (size_t i = 0; i < offset.size() - 1; ++i) {
-    for (size_t idx = 0; idx < idx_width; ++idx) {
-      ids_map.clear();
-
-      // construct a map for creating csr
-      for (size_t j = offset[i]; j < offset[i + 1]; ++j) {
-        auto ids_value = ids_data[idx + j * idx_width];
-        if (ids_value != padding_idx) {
-          unsigned int word_idx = static_cast<unsigned int>(ids_value);
-          ++ids_map[word_idx];
-        }
-      }
-
-      VLOG(4) << "====sequence %d====" << i;
-      for (std::map<int, int>::const_iterator it = ids_map.begin();
-           it != ids_map.end(); ++it) {
-        VLOG(4) << it->first << " => " << it->second;
-        csr_vals[val_idx] = it->second;
-        csr_colmuns[val_idx] = it->first;
-        ++val_idx;
-      }
-      csr_row_idx[row_idx + 1] = csr_row_idx[row_idx] + ids_map.size();
-      ++row_idx;
-    }
-  }
-}
-#else
-template <typename T>
-struct EmbeddingVSumFunctor {
-  void operator()(const framework::ExecutionContext &context,
-                  const LoDTensor *table_t, const LoDTensor *ids_t,
-                  LoDTensor *output_t) {
-    auto *table = table_t->data<T>();
-    int64_t table_height = table_t->dims()[0];
-    int64_t table_width = table_t->dims()[1];
-    int64_t out_width = output_t->dims()[1];
-    const int64_t *ids = ids_t->data<int64_t>();
-    auto ids_lod = ids_t->lod()[0];
-    int64_t idx_width = ids_t->numel() / ids_lod.back();
-    auto *output = output_t->mutable_data<T>(context.GetPlace());
-
-    PADDLE_ENFORCE_LE(table_width * idx_width, out_width,
-                      platform::errors::InvalidArgument(
-                          "table_width * idx_width should be less than or "
-                          "equal to out_width. But received "
-                          "table_width * idx_width = %s, out_width = %d.",
-                          table_width * idx_width, out_width));
-    PADDLE_ENFORCE_GT(ids_lod.size(), 1UL,
-                      platform::errors::InvalidArgument(
-                          "The tensor ids's LoD[0] should be greater than 1. "
-                          "But received the ids's LoD[0] = %d.",
-                          ids_lod.size()));
-
-    jit::emb_seq_pool_attr_t attr(table_height, table_width, 0, idx_width,
-                                  out_width, jit::SeqPoolType::kSum);
-    for (size_t i = 0; i != ids_lod.size() - 1; ++i) {
-      attr.index_height = ids_lod[i + 1] - ids_lod[i];
-      auto emb_seqpool =
-          jit::KernelFuncs<jit::EmbSeqPoolTuple<T>, platform::CPUPlace>::Cache()
-              .At(attr);
-      emb_seqpool(table, ids + ids_lod[i] * idx_width, output + i * out_width,
-                  &attr);
-    }
-  }
-};
-#endif
-
 inline int FusedEmbeddingSeqPoolLastDim(const framework::DDim &table_dims,
                                         const framework::DDim &ids_dims) {
   int64_t last_dim = table_dims[1];
@@ -125,6 +41,40 @@ inline int FusedEmbeddingSeqPoolLastDim(const framework::DDim &table_dims,
   return last_dim;
 }
 
+// The ids of each position of a sequence, the product of the dims of Ids
+// but the first.
+inline int64_t FusedEmbeddingSeqPoolSlots(const framework::DDim &ids_dims) {
+  return phi::product(phi::slice_ddim(ids_dims, 1, ids_dims.size()));
+}
+
+inline const std::vector<uint64_t> &FusedEmbeddingSeqPoolOffsets(
+    const LoDTensor &ids) {
+  const auto &ids_lod = ids.lod();
+  // in run time, the LoD of ids must be 1
+  PADDLE_ENFORCE_EQ(ids_lod.size(), 1UL,
+                    platform::errors::InvalidArgument(
+                        "The LoD level of Input(Ids) should be 1. But "
+                        "received Ids's LoD level = %d.",
+                        ids_lod.size()));
+  return ids_lod[0];
+}
+
+// The per-id weights of Input(IdWeight), or null if it is not given.
+template <typename T>
+const T *FusedEmbeddingSeqPoolIdWeight(
+    const framework::ExecutionContext &context, const LoDTensor &ids) {
+  auto *weight_t = context.Input<LoDTensor>("IdWeight");
+  if (weight_t == nullptr) {
+    return nullptr;
+  }
+  PADDLE_ENFORCE_EQ(weight_t->numel(), ids.numel(),
+                    platform::errors::InvalidArgument(
+                        "The numel of Input(IdWeight) should be equal to the "
+                        "numel of Input(Ids). But received %d and %d.",
+                        weight_t->numel(), ids.numel()));
+  return weight_t->data<T>();
+}
+
 template <typename T>
 class FusedEmbeddingSeqPoolKernel : public framework::OpKernel<T> {
  public:
@@ -132,64 +82,37 @@ class FusedEmbeddingSeqPoolKernel : public framework::OpKernel<T> {
     const LoDTensor *ids_t = context.Input<LoDTensor>("Ids");  // int tensor
     LoDTensor *output_t = context.Output<LoDTensor>("Out");    // float tensor
     const LoDTensor *table_var = context.Input<LoDTensor>("W");
-    const std::string &combiner_type = context.Attr<std::string>("combiner");
 
     int64_t last_dim =
         FusedEmbeddingSeqPoolLastDim(table_var->dims(), ids_t->dims());
-    const auto &ids_lod = ids_t->lod();
-    // in run time, the LoD of ids must be 1
-    PADDLE_ENFORCE_EQ(ids_lod.size(), 1UL,
-                      platform::errors::InvalidArgument(
-                          "The LoD level of Input(Ids) should be 1. But "
-                          "received Ids's LoD level = %d.",
-                          ids_lod.size()));
-    int64_t batch_size = ids_lod[0].size() - 1;
+    const auto &offsets = FusedEmbeddingSeqPoolOffsets(*ids_t);
+    int64_t batch_size = offsets.size() - 1;
     // in run time, the shape from Ids -> output
     // should be [seq_length, 1] -> [batch_size, last_dim]
     output_t->Resize({batch_size, last_dim});
+    T *output = output_t->mutable_data<T>(context.GetPlace());
 
-    if (combiner_type == "sum") {
-#if defined(PADDLE_WITH_MKLML) && !defined(_WIN32) && !defined(__APPLE__) && \
-    !defined(__OSX__)
-      int64_t padding_idx = context.Attr<int64_t>("padding_idx");
-      auto output = output_t->mutable_data<T>(context.GetPlace());
-      int64_t table_height = table_var->dims()[0];
-      int64_t table_width = table_var->dims()[1];
-      auto weights = table_var->data<T>();
-
-      const std::vector<uint64_t> offset = ids_lod[0];
-      auto len = ids_t->numel();
-      int idx_width = len / offset.back();
-
-      Tensor csr_vals_t, csr_colmuns_t, csr_row_idx_t;
-      csr_vals_t.Resize({len});
-      csr_colmuns_t.Resize({len});
-      csr_row_idx_t.Resize({(batch_size + 1) * idx_width});
-      auto csr_vals = csr_vals_t.mutable_data<T>(context.GetPlace());
-      auto csr_colmuns = csr_colmuns_t.mutable_data<int>(context.GetPlace());
-      auto csr_row_idx = csr_row_idx_t.mutable_data<int>(context.GetPlace());
-      prepare_csr_data<T>(offset, ids_t->data<int64_t>(), idx_width, csr_vals,
-                          csr_colmuns, csr_row_idx, padding_idx);
-
-      const char transa = 'N';
-      const T alpha = 1.0;
-      const T beta = 0.0;
-      const char matdescra[] = {'G', 'L', 'N', 'C'};
-
-      const int m = batch_size * idx_width;
-      const int n = table_width;
-      const int k = table_height;
-      auto blas = phi::funcs::GetBlas<platform::CPUDeviceContext, T>(context);
-      blas.CSRMM(&transa, &m, &n, &k, &alpha, matdescra, (const T *)csr_vals,
-                 (const int *)csr_colmuns, (const int *)csr_row_idx,
-                 (const int *)csr_row_idx + 1, weights, &n, &beta, output, &n);
-
-#else
-      EmbeddingVSumFunctor<T> functor;
-      functor(context, table_var, ids_t, output_t);
-#endif
+    if (ids_t->dtype() == phi::DataType::INT32) {
+      Pool<int32_t>(context, *table_var, *ids_t, offsets, output);
+    } else {
+      Pool<int64_t>(context, *table_var, *ids_t, offsets, output);
     }
   }
+
+ private:
+  template <typename IdT>
+  void Pool(const framework::ExecutionContext &context,
+            const LoDTensor &table, const LoDTensor &ids,
+            const std::vector<uint64_t> &offsets, T *output) const {
+    auto &dev_ctx = context.template device_context<phi::CPUContext>();
+    phi::funcs::EmbeddingSeqPool(
+        dev_ctx, table.data<T>(), table.dims()[0], table.dims()[1],
+        ids.data<IdT>(), FusedEmbeddingSeqPoolIdWeight<T>(context, ids),
+        offsets, FusedEmbeddingSeqPoolSlots(ids.dims()),
+        phi::funcs::GetEmbeddingPoolType(
+            context.Attr<std::string>("combiner")),
+        context.Attr<int64_t>("padding_idx"), output);
+  }
 };
 
 template <typename T>
@@ -198,8 +121,11 @@ class FusedEmbeddingSeqPoolGradKernel : public framework::OpKernel<T> {
   void Compute(const framework::ExecutionContext &context) const override {
     auto *table_var = context.InputVar("W");
     DDim table_dim;
+    const T *table = nullptr;
     if (table_var->IsType<LoDTensor>()) {
-      table_dim = context.Input<LoDTensor>("W")->dims();
+      auto *table_t = context.Input<LoDTensor>("W");
+      table_dim = table_t->dims();
+      table = table_t->data<T>();
     } else if (table_var->IsType<phi::SelectedRows>()) {
       auto *table_t = context.Input<phi::SelectedRows>("W");
       table_dim = table_t->value().dims();
@@ -209,90 +135,61 @@ class FusedEmbeddingSeqPoolGradKernel : public framework::OpKernel<T> {
           "must be either LoDTensor or SelectedRows."));
     }
 
-    bool is_sparse = context.Attr<bool>("is_sparse");
+    auto *ids = context.Input<LoDTensor>("Ids");
+    if (ids->dtype() == phi::DataType::INT32) {
+      ComputeGrad<int32_t>(context, table, table_dim, *ids);
+    } else {
+      ComputeGrad<int64_t>(context, table, table_dim, *ids);
+    }
+  }
+
+ private:
+  template <typename IdT>
+  void ComputeGrad(const framework::ExecutionContext &context,
+                   const T *table, const DDim &table_dim,
+                   const LoDTensor &ids) const {
+    auto &dev_ctx = context.template device_context<phi::CPUContext>();
+    auto *d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
+    int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+    auto type = phi::funcs::GetEmbeddingPoolType(
+        context.Attr<std::string>("combiner"));
+    PADDLE_ENFORCE_EQ(
+        type != phi::funcs::EmbeddingPoolType::kMax || table != nullptr, true,
+        platform::errors::Unimplemented(
+            "The gradient of the max combiner needs the parameter W to be "
+            "a LoDTensor."));
+    const auto &offsets = FusedEmbeddingSeqPoolOffsets(ids);
+    const IdT *ids_data = ids.data<IdT>();
     // Since paddings are not trainable and fixed in forward, the gradient of
-    // paddings makes no sense and we don't deal with it in backward.
+    // paddings makes no sense and we don't deal with it in backward. Each
+    // other id gets a single row however often it occurs.
+    auto groups =
+        phi::funcs::GroupEmbeddingIds(ids_data, ids.numel(), padding_idx);
+
+    bool is_sparse = context.Attr<bool>("is_sparse");
+    T *d_table_data = nullptr;
     if (is_sparse) {
-      auto *ids = context.Input<LoDTensor>("Ids");
-      auto *d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
       auto *d_table =
           context.Output<phi::SelectedRows>(framework::GradVarName("W"));
       // runtime shape
       d_table->set_height(table_dim[0]);
-
-      auto *ids_data = ids->data<int64_t>();
-      int64_t ids_num = ids->numel();
-      auto lod = ids->lod()[0];
-      int64_t out_width = d_output->dims()[1];
-
-      framework::Vector<int64_t> *new_rows = d_table->mutable_rows();
-      new_rows->resize(ids_num);
-      std::memcpy(&(*new_rows)[0], ids_data, ids_num * sizeof(int64_t));
+      d_table->set_rows(groups.rows);
 
       auto *d_table_value = d_table->mutable_value();
-      d_table_value->Resize({ids_num, table_dim[1]});
-      T *d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
-      const T *d_output_data = d_output->data<T>();
-
-      auto vbroadcast =
-          jit::KernelFuncs<jit::VBroadcastTuple<T>, platform::CPUPlace>::Cache()
-              .At(out_width);
-      for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-        int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-        const T *src = d_output_data + i * out_width;
-        T *dst = d_table_data + lod[i] * out_width;
-        vbroadcast(src, dst, h, out_width);
-      }
+      d_table_value->Resize(
+          {static_cast<int64_t>(groups.rows.size()), table_dim[1]});
+      d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
     } else {
-#if defined(PADDLE_WITH_MKLML) && !defined(_WIN32) && !defined(__APPLE__) && \
-    !defined(__OSX__)
-      auto *ids = context.Input<LoDTensor>("Ids");
-      auto *d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
       auto *d_table = context.Output<LoDTensor>(framework::GradVarName("W"));
-      int64_t padding_idx = context.Attr<int64_t>("padding_idx");
-
       d_table->Resize(table_dim);
-      auto *d_table_data = d_table->mutable_data<T>(context.GetPlace());
+      d_table_data = d_table->mutable_data<T>(context.GetPlace());
       memset(d_table_data, 0, d_table->numel() * sizeof(T));
-
-      const auto &ids_lod = ids->lod();
-      PADDLE_ENFORCE_EQ(ids_lod.size(), 1UL,
-                        platform::errors::InvalidArgument(
-                            "The LoD level of Input(Ids) should be 1. But "
-                            "received Ids's LoD level = %d.",
-                            ids_lod.size()));
-      const std::vector<uint64_t> offset = ids_lod[0];
-      auto len = ids->numel();
-      int idx_width = len / offset.back();
-
-      Tensor csr_vals_t, csr_colmuns_t, csr_row_idx_t;
-      csr_vals_t.Resize({len});
-      csr_colmuns_t.Resize({len});
-      int64_t batch_size = ids_lod[0].size() - 1;
-      csr_row_idx_t.Resize({(batch_size + 1) * idx_width});
-      auto csr_vals = csr_vals_t.mutable_data<T>(context.GetPlace());
-      auto csr_colmuns = csr_colmuns_t.mutable_data<int>(context.GetPlace());
-      auto csr_row_idx = csr_row_idx_t.mutable_data<int>(context.GetPlace());
-      prepare_csr_data<T>(offset, ids->data<int64_t>(), idx_width, csr_vals,
-                          csr_colmuns, csr_row_idx, padding_idx);
-
-      auto *d_output_data = d_output->data<T>();
-      auto blas = phi::funcs::GetBlas<platform::CPUDeviceContext, T>(context);
-      int width = static_cast<int>(table_dim[1]);
-      int num_seq = batch_size * idx_width;
-      LOG(INFO) << "num seq = " << num_seq << " width = " << width;
-      for (int i = 0; i < num_seq; ++i) {
-        for (int j = csr_row_idx[i]; j < csr_row_idx[i + 1]; ++j) {
-          unsigned int word_idx = csr_colmuns[j];
-          T val = csr_vals[j];
-          blas.AXPY(width, val, d_output_data + i * width,
-                    d_table_data + word_idx * width);
-        }
-      }
-#else
-      LOG(ERROR) << "Dense is not supported in fused_embedding_seq_pool_op now";
-#endif
     }
+    phi::funcs::EmbeddingSeqPoolGrad(
+        dev_ctx, table, table_dim[1], ids_data,
+        FusedEmbeddingSeqPoolIdWeight<T>(context, ids), offsets,
+        FusedEmbeddingSeqPoolSlots(ids.dims()), type, padding_idx, groups,
+        d_output->data<T>(), !is_sparse, d_table_data);
   }
 };
 
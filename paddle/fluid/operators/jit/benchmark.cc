@@ -361,6 +361,45 @@ void BenchKernelSgd() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelAdam() {
+  using T = typename KernelTuple::data_type;
+  const T beta1 = 0.9, beta2 = 0.99, lr = 0.1, eps = 1.0e-8;
+  for (int numel : {100, 1000, 100000}) {
+    std::vector<T> grad(numel), mom1(numel), mom2(numel), param(numel);
+    RandomVec<T>(numel, grad.data(), -1.f, 1.f);
+    RandomVec<T>(numel, mom1.data(), -1.f, 1.f);
+    RandomVec<T>(numel, mom2.data(), 0.f, 1.f);
+    RandomVec<T>(numel, param.data(), -1.f, 1.f);
+    std::vector<T> mom1_out(numel), mom2_out(numel), param_out(numel);
+    jit::adam_attr_t attr(beta1, beta2);
+    BenchAllImpls<KernelTuple, PlaceType>(
+        attr, beta1, beta2, -lr, eps, static_cast<int64_t>(numel),
+        grad.data(), mom1.data(), mom2.data(), param.data(), mom1_out.data(),
+        mom2_out.data(), param_out.data());
+  }
+}
+
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelAdamW() {
+  using T = typename KernelTuple::data_type;
+  const T beta1 = 0.9, beta2 = 0.99, lr = 0.1, eps = 1.0e-8;
+  const T old_lr = 0.1, lr_ratio = 1.0, coeff = 0.01;
+  for (int numel : {100, 1000, 100000}) {
+    std::vector<T> grad(numel), mom1(numel), mom2(numel), param(numel);
+    RandomVec<T>(numel, grad.data(), -1.f, 1.f);
+    RandomVec<T>(numel, mom1.data(), -1.f, 1.f);
+    RandomVec<T>(numel, mom2.data(), 0.f, 1.f);
+    RandomVec<T>(numel, param.data(), -1.f, 1.f);
+    std::vector<T> mom1_out(numel), mom2_out(numel), param_out(numel);
+    jit::adamw_attr_t attr(beta1, beta2, coeff);
+    BenchAllImpls<KernelTuple, PlaceType>(
+        attr, beta1, beta2, -lr, eps, old_lr, lr_ratio, coeff,
+        static_cast<int64_t>(numel), grad.data(), mom1.data(), mom2.data(),
+        param.data(), mom1_out.data(), mom2_out.data(), param_out.data());
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void BenchKernelMatMul() {
   using T = typename KernelTuple::data_type;
@@ -558,6 +597,8 @@ BENCH_FP32_CPU(EmbSeqPool);
 BENCH_FP32_CPU(MatMul);
 BENCH_FP32_CPU(Softmax);
 BENCH_FP32_CPU(Sgd);
+BENCH_FP32_CPU(Adam);
+BENCH_FP32_CPU(AdamW);
 BENCH_FP32_CPU(VBroadcast);
 
 // Benchmark all jit kernels including jitcode, mkl and refer.
@@ -280,6 +280,12 @@ inline std::ostream& operator<<(std::ostream& os, const adam_attr_t& attr) {
   return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os, const adamw_attr_t& attr) {
+  os << "beta1[" << attr.beta1 << "],beta2[" << attr.beta2 << "],coeff["
+     << attr.coeff << "]";
+  return os;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const sgd_attr_t& attr) {
   os << "param_height[" << attr.param_height << "],param_width["
      << attr.param_width << "],grad_height[" << attr.grad_height
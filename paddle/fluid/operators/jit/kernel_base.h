@@ -25,6 +25,7 @@ typedef enum {
   kNone = 0,
   // sort by alphabet
   kAdam = 1,
+  kAdamW,
   kCRFDecoding,
   kEmbSeqPool,
   kGRUH1,
@@ -285,6 +286,24 @@ struct AdamTuple {
                             const T*, T*, T*, T*);
 };
 
+typedef struct adamw_attr_s {
+  float beta1, beta2, coeff;
+  adamw_attr_s() = default;
+  explicit adamw_attr_s(float beta1, float beta2, float coeff)
+      : beta1(beta1), beta2(beta2), coeff(coeff) {}
+} adamw_attr_t;
+
+// beta1, beta2, lr, eps, old_lr, lr_ratio, coeff, numel, grad, mom1, mom2,
+// param, mom1_out, mom2_out, param_out
+template <typename T>
+struct AdamWTuple {
+  static constexpr KernelType kernel_type = kAdamW;
+  typedef T data_type;
+  typedef adamw_attr_t attr_type;
+  typedef void (*func_type)(T, T, T, T, T, T, T, int64_t, const T*, const T*,
+                            const T*, const T*, T*, T*, T*);
+};
+
 typedef struct matmul_attr_s {
   int m, n, k;
   void* packed_weight{nullptr};
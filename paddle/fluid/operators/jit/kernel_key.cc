@@ -68,6 +68,11 @@ int64_t JitCodeKey<adam_attr_t>(const adam_attr_t& attr) {
   return static_cast<int64_t>(attr.beta1 + attr.beta2);
 }
 
+template <>
+int64_t JitCodeKey<adamw_attr_t>(const adamw_attr_t& attr) {
+  return static_cast<int64_t>(attr.beta1 + attr.beta2 + attr.coeff);
+}
+
 }  // namespace jit
 }  // namespace operators
 }  // namespace paddle
@@ -58,11 +58,14 @@ class SoftmaxOp : public framework::OperatorWithKernel {
 #endif
 
 #ifndef PADDLE_WITH_ASCEND_CL
+    // The CPU kernel computes float16 in float.
     if (input_data_type == framework::proto::VarType::FP16) {
-      PADDLE_ENFORCE_EQ(platform::is_gpu_place(ctx.GetPlace()) ||
-                            platform::is_xpu_place(ctx.GetPlace()),
-                        true, platform::errors::InvalidArgument(
-                                  "float16 can only be used on GPU/XPU place"));
+      PADDLE_ENFORCE_EQ(
+          platform::is_cpu_place(ctx.GetPlace()) ||
+              platform::is_gpu_place(ctx.GetPlace()) ||
+              platform::is_xpu_place(ctx.GetPlace()),
+          true, platform::errors::InvalidArgument(
+                    "float16 can only be used on CPU/GPU/XPU place"));
     }
 #endif
 
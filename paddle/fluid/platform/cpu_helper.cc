@@ -24,10 +24,26 @@ limitations under the License. */
 #include <cblas.h>
 #endif
 
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
 namespace paddle {
 namespace platform {
 
+static thread_local int num_threads_limit = 0;
+
+void SetNumThreadsLimit(int limit) {
+  num_threads_limit = limit > 0 ? limit : 0;
+}
+
+int GetNumThreadsLimit() { return num_threads_limit; }
+
 void SetNumThreads(int num_threads) {
+  if (num_threads_limit > 0 && num_threads > num_threads_limit) {
+    num_threads = num_threads_limit;
+  }
+  // The phi CPU kernels run their loops on as many threads as the math
+  // library.
+  phi::SetIntraOpNumThreads(num_threads);
 #ifdef PADDLE_USE_OPENBLAS
 // windows has no support for openblas multi-thread
 // please refer to: https://github.com/PaddlePaddle/Paddle/issues/7234
@@ -40,7 +56,12 @@ void SetNumThreads(int num_threads) {
   openblas_set_num_threads(real_num_threads);
 #elif defined(PADDLE_WITH_MKLML)
   int real_num_threads = num_threads > 1 ? num_threads : 1;
-  platform::dynload::MKL_Set_Num_Threads(real_num_threads);
+  if (num_threads_limit > 0) {
+    // The threads under a cap share MKL, so only set the calling thread.
+    platform::dynload::MKL_Set_Num_Threads_Local(real_num_threads);
+  } else {
+    platform::dynload::MKL_Set_Num_Threads(real_num_threads);
+  }
   omp_set_num_threads(real_num_threads);
 #elif defined(PADDLE_USE_REFERENCE_CBLAS)
   // cblas not support multi-thread
@@ -19,8 +19,17 @@ limitations under the License. */
 namespace paddle {
 namespace platform {
 
-//! Set the number of threads in use.
+//! Set the number of threads in use, by the math library and the
+//! ParallelFor of the phi CPU kernels on the calling thread.
 void SetNumThreads(int num_threads);
 
+//! Cap the number of threads set by SetNumThreads on the calling thread, so
+//! that the threads running requests concurrently share the cores. 0 removes
+//! the cap.
+void SetNumThreadsLimit(int limit);
+
+//! Get the cap of the calling thread, 0 if there is none.
+int GetNumThreadsLimit();
+
 }  // namespace platform
 }  // namespace paddle
@@ -14,9 +14,25 @@ limitations under the License. */
 
 #include "paddle/fluid/platform/cpu_helper.h"
 
+#include <thread>  // NOLINT
+
 #include "gtest/gtest.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
 
 TEST(CpuHelper, SetNumThread) {
   paddle::platform::SetNumThreads(1);
   paddle::platform::SetNumThreads(4);
 }
+
+TEST(CpuHelper, SetNumThreadsLimit) {
+  EXPECT_EQ(paddle::platform::GetNumThreadsLimit(), 0);
+  paddle::platform::SetNumThreadsLimit(2);
+  EXPECT_EQ(paddle::platform::GetNumThreadsLimit(), 2);
+  paddle::platform::SetNumThreads(4);
+  EXPECT_EQ(phi::GetIntraOpNumThreads(), 2);
+  std::thread([] {
+    EXPECT_EQ(paddle::platform::GetNumThreadsLimit(), 0);
+  }).join();
+  paddle::platform::SetNumThreadsLimit(0);
+  EXPECT_EQ(paddle::platform::GetNumThreadsLimit(), 0);
+}
@@ -194,6 +194,13 @@ bool MayIUse(const cpu_isa_t cpu_isa) {
         unsigned int avx512vl_mask = (1 << 31);
         return ((reg[1] & avx512f_mask) && (reg[1] & avx512dq_mask) &&
                 (reg[1] & avx512bw_mask) && (reg[1] & avx512vl_mask));
+      } else if (cpu_isa == avx512_core_vnni) {
+        // AVX512_VNNI: ECX Bit 11, on top of avx512_core
+        unsigned int avx512_core_mask =
+            (1 << 16) | (1 << 17) | (1 << 30) | (1U << 31);
+        unsigned int avx512vnni_mask = (1 << 11);
+        return (reg[1] & avx512_core_mask) == avx512_core_mask &&
+               (reg[2] & avx512vnni_mask) != 0;
       }
       // EAX = 7, ECX = 1
       cpuid(reg, 0x00010007);
@@ -833,3 +833,56 @@ PADDLE_DEFINE_EXPORTED_bool(nccl_blocking_wait, false, "nccl blocking wait");
  * Example:
  */
 PADDLE_DEFINE_EXPORTED_bool(use_autotune, false, "Whether enable autotune.");
+
+/**
+ * Allocator related FLAG
+ * Name: FLAGS_enable_allocation_profiling
+ * Since Version: 2.3.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_enable_allocation_profiling=true would record the live bytes
+ * of every allocation site (op type, output variable and Python call site),
+ * see paddle/fluid/memory/allocation_profiler.h.
+ */
+PADDLE_DEFINE_EXPORTED_bool(enable_allocation_profiling, false,
+                            "Whether to attribute allocations to the op "
+                            "and the call site that make them.");
+
+/**
+ * Allocator related FLAG
+ * Name: FLAGS_allocation_profiling_sample_rate
+ * Since Version: 2.3.0
+ * Value Range: int32, default=1
+ * Example: FLAGS_allocation_profiling_sample_rate=100 would only record 1 out
+ * of every 100 allocations made on a thread when allocation profiling is on.
+ */
+PADDLE_DEFINE_EXPORTED_int32(allocation_profiling_sample_rate, 1,
+                             "Record 1 out of N allocations when allocation "
+                             "profiling is enabled.");
+
+/**
+ * Garbage collector related FLAG
+ * Name: FLAGS_enable_adaptive_gc
+ * Since Version: 2.3.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_enable_adaptive_gc=true would make Executor and
+ * InterpreterCore on CPU batch the garbages and free them on a dedicated
+ * thread, with a batch size tuned from the memory stats, and keep the freed
+ * buffers for the allocations of the same size.
+ */
+PADDLE_DEFINE_EXPORTED_bool(enable_adaptive_gc, false,
+                            "Whether to use the adaptive garbage collector "
+                            "which frees garbages off the critical path on "
+                            "CPU.");
+
+/**
+ * Garbage collector related FLAG
+ * Name: FLAGS_adaptive_gc_max_memory_mb
+ * Since Version: 2.3.0
+ * Value Range: int32, default=64
+ * Example: FLAGS_adaptive_gc_max_memory_mb=256 would allow the adaptive
+ * garbage collector to hold up to 256MB of garbages before freeing them, and
+ * to keep up to 256MB of freed buffers for reuse.
+ */
+PADDLE_DEFINE_EXPORTED_int32(adaptive_gc_max_memory_mb, 64,
+                             "The upper bound of the memory held by the "
+                             "adaptive garbage collector, in MB.");
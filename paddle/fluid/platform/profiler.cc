@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler/common_event.h"
 #include "paddle/fluid/platform/profiler/host_event_recorder.h"
 #include "paddle/fluid/platform/profiler/host_tracer.h"
+#include "paddle/fluid/platform/profiler/perf_counter.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
 #include "paddle/fluid/platform/profiler_helper.h"
 #ifdef PADDLE_WITH_CUDA
@@ -97,6 +98,7 @@ RecordEvent::RecordEvent(const char *name, const TracerEventType type,
   role_ = role;
   type_ = type;
   start_ns_ = PosixInNsec();
+  StartPerfCounters();
 }
 
 RecordEvent::RecordEvent(const std::string &name, const TracerEventType type,
@@ -127,6 +129,7 @@ RecordEvent::RecordEvent(const std::string &name, const TracerEventType type,
   role_ = role;
   type_ = type;
   start_ns_ = PosixInNsec();
+  StartPerfCounters();
 }
 
 RecordEvent::RecordEvent(const std::string &name, const std::string &attr,
@@ -159,6 +162,7 @@ RecordEvent::RecordEvent(const std::string &name, const std::string &attr,
   name_ = new std::string(name);
   start_ns_ = PosixInNsec();
   attr_ = new std::string(attr);
+  StartPerfCounters();
 }
 
 void RecordEvent::OriginalConstruct(const std::string &name,
@@ -179,6 +183,27 @@ void RecordEvent::OriginalConstruct(const std::string &name,
   *name_ = e->name();
 }
 
+void RecordEvent::StartPerfCounters() {
+  if (UNLIKELY(PerfCounters::IsEnabled()) &&
+      PerfCounters::NeedCounters(type_)) {
+    has_perf_counters_ = PerfCounters::Read(&start_perf_counters_);
+  }
+}
+
+template <typename... Args>
+static void RecordHostEvent(bool has_perf_counters,
+                            const PerfCountersInfo &start_perf_counters,
+                            Args &&... args) {
+  PerfCountersInfo end_perf_counters;
+  if (UNLIKELY(has_perf_counters) &&
+      PerfCounters::Read(&end_perf_counters)) {
+    HostEventRecorder::GetInstance().RecordEvent(
+        std::forward<Args>(args)..., end_perf_counters - start_perf_counters);
+  } else {
+    HostEventRecorder::GetInstance().RecordEvent(std::forward<Args>(args)...);
+  }
+}
+
 void RecordEvent::End() {
 #ifndef _WIN32
 #ifdef PADDLE_WITH_CUDA
@@ -191,15 +216,15 @@ void RecordEvent::End() {
   if (LIKELY(FLAGS_enable_host_event_recorder_hook && is_enabled_)) {
     uint64_t end_ns = PosixInNsec();
     if (LIKELY(shallow_copy_name_ != nullptr)) {
-      HostEventRecorder::GetInstance().RecordEvent(
-          shallow_copy_name_, start_ns_, end_ns, role_, type_);
+      RecordHostEvent(has_perf_counters_, start_perf_counters_,
+                      shallow_copy_name_, start_ns_, end_ns, role_, type_);
     } else if (name_ != nullptr) {
       if (attr_ == nullptr) {
-        HostEventRecorder::GetInstance().RecordEvent(*name_, start_ns_, end_ns,
-                                                     role_, type_);
+        RecordHostEvent(has_perf_counters_, start_perf_counters_, *name_,
+                        start_ns_, end_ns, role_, type_);
       } else {
-        HostEventRecorder::GetInstance().RecordEvent(*name_, start_ns_, end_ns,
-                                                     role_, type_, *attr_);
+        RecordHostEvent(has_perf_counters_, start_perf_counters_, *name_,
+                        start_ns_, end_ns, role_, type_, *attr_);
         delete attr_;
       }
       delete name_;
@@ -164,6 +164,41 @@ void ChromeTracingLogger::LogHostTraceEventNode(
           nsToUsFloat(host_node.EndNs(), start_time_));
       break;
     default:
+      if (host_node.HasPerfCounters()) {
+        const PerfCountersInfo& counters = host_node.PerfCounters();
+        double ipc = counters.cycles == 0
+                         ? 0.0
+                         : static_cast<double>(counters.instructions) /
+                               counters.cycles;
+        output_file_stream_ << string_format(
+            std::string(
+                R"JSON(
+  { 
+    "name": "%s[%s]", "pid": %lld, "tid": "%lld(C++)",
+    "ts": %lld, "dur": %.3f,
+    "ph": "X", "cat": "%s", 
+    "cname": "thread_state_runnable",
+    "args": {
+      "start_time": "%.3f us",
+      "end_time": "%.3f us",
+      "cycles": %llu,
+      "instructions": %llu,
+      "IPC": %.3f,
+      "llc_misses": %llu,
+      "branch_misses": %llu
+    }
+  },
+  )JSON"),
+            host_node.Name().c_str(), dur_display.c_str(),
+            host_node.ProcessId(), host_node.ThreadId(),
+            nsToUs(host_node.StartNs()), nsToUsFloat(host_node.Duration()),
+            categary_name_[static_cast<int>(host_node.Type())],
+            nsToUsFloat(host_node.StartNs(), start_time_),
+            nsToUsFloat(host_node.EndNs(), start_time_), counters.cycles,
+            counters.instructions, ipc, counters.llc_misses,
+            counters.branch_misses);
+        break;
+      }
       output_file_stream_ << string_format(
           std::string(
               R"JSON(
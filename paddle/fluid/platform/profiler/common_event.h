@@ -54,12 +54,41 @@ struct CommonEvent {
     name = buf;
   }
 
+  CommonEvent(const char *name, uint64_t start_ns, uint64_t end_ns,
+              EventRole role, TracerEventType type,
+              const PerfCountersInfo &perf_counters)
+      : CommonEvent(name, start_ns, end_ns, role, type) {
+    this->perf_counters = perf_counters;
+    has_perf_counters = true;
+  }
+
+  CommonEvent(std::function<void *(size_t)> arena_allocator,
+              const std::string &name_str, uint64_t start_ns, uint64_t end_ns,
+              EventRole role, TracerEventType type,
+              const PerfCountersInfo &perf_counters)
+      : CommonEvent(arena_allocator, name_str, start_ns, end_ns, role, type) {
+    this->perf_counters = perf_counters;
+    has_perf_counters = true;
+  }
+
+  CommonEvent(std::function<void *(size_t)> arena_allocator,
+              const std::string &name_str, uint64_t start_ns, uint64_t end_ns,
+              EventRole role, TracerEventType type, const std::string &attr_str,
+              const PerfCountersInfo &perf_counters)
+      : CommonEvent(arena_allocator, name_str, start_ns, end_ns, role, type,
+                    attr_str) {
+    this->perf_counters = perf_counters;
+    has_perf_counters = true;
+  }
+
   const char *name = nullptr;  // not owned, designed for performance
   uint64_t start_ns = 0;
   uint64_t end_ns = 0;
   EventRole role = EventRole::kOrdinary;
   TracerEventType type = TracerEventType::NumTypes;
   const char *attr = nullptr;  // not owned, designed for performance
+  bool has_perf_counters = false;
+  PerfCountersInfo perf_counters;
 };
 
 }  // namespace platform
@@ -0,0 +1,178 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/continuous_profiler.h"
+
+#include <cstdio>
+#include <memory>
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/os_info.h"
+#include "paddle/fluid/platform/profiler/event_node.h"
+#include "paddle/fluid/platform/profiler/event_python.h"
+#include "paddle/fluid/platform/profiler/extra_info.h"
+#include "paddle/fluid/platform/profiler/host_event_recorder.h"
+#include "paddle/fluid/platform/profiler/host_tracer.h"
+#include "paddle/fluid/platform/profiler/utils.h"
+
+namespace paddle {
+namespace platform {
+
+ContinuousProfiler& ContinuousProfiler::GetInstance() {
+  static ContinuousProfiler instance;
+  return instance;
+}
+
+ContinuousProfiler::~ContinuousProfiler() {
+  if (IsRunning()) {
+    Stop();
+  }
+}
+
+void ContinuousProfiler::Start(const ContinuousProfilerOptions& options) {
+  PADDLE_ENFORCE_EQ(
+      options.format == "json" || options.format == "pb", true,
+      platform::errors::InvalidArgument(
+          "The format of ContinuousProfiler must be json or pb, but got %s.",
+          options.format));
+  PADDLE_ENFORCE_EQ(running_.exchange(true), false,
+                    platform::errors::PreconditionNotMet(
+                        "ContinuousProfiler has already been started."));
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    options_ = options;
+    stop_ = false;
+    collector_.ClearAll();
+    num_pending_events_ = 0;
+    num_dropped_events_ = 0;
+    last_rotate_ns_ = PosixInNsec();
+  }
+  HostEventRingRegistry::GetInstance().Enable(options.ring_capacity,
+                                              options.sample_rate);
+  HostTraceLevel::GetInstance().SetLevel(options.trace_level);
+  drain_thread_ = std::thread([this]() { DrainLoop(); });
+}
+
+void ContinuousProfiler::Stop() {
+  PADDLE_ENFORCE_EQ(
+      IsRunning(), true,
+      platform::errors::PreconditionNotMet(
+          "ContinuousProfiler must be started before stopping it."));
+  HostTraceLevel::GetInstance().SetLevel(HostTraceLevel::kDisabled);
+  HostEventRingRegistry::GetInstance().Disable();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  drain_thread_.join();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    DrainRings();
+    WriteTraceFile();
+  }
+  running_.store(false);
+}
+
+void ContinuousProfiler::Flush() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  DrainRings();
+  WriteTraceFile();
+}
+
+uint64_t ContinuousProfiler::NumDroppedEvents() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return num_dropped_events_;
+}
+
+std::deque<std::string> ContinuousProfiler::TraceFiles() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return trace_files_;
+}
+
+void ContinuousProfiler::DrainLoop() {
+  SetCurrentThreadName("ContinuousProfiler");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    cv_.wait_for(lock, std::chrono::milliseconds(options_.drain_interval_ms),
+                 [this]() { return stop_; });
+    if (stop_) {
+      break;
+    }
+    DrainRings();
+    uint64_t elapsed_ms = (PosixInNsec() - last_rotate_ns_) / 1000000;
+    if (num_pending_events_ >= options_.max_events_per_file ||
+        elapsed_ms >= options_.rotate_interval_ms) {
+      WriteTraceFile();
+    }
+  }
+}
+
+void ContinuousProfiler::DrainRings() {
+  uint64_t process_id = GetProcessId();
+  for (auto& ring : HostEventRingRegistry::GetInstance().GetAllRings()) {
+    uint64_t thread_id = ring->ThreadId();
+    if (ring->ThreadName() != kDefaultThreadName) {
+      collector_.AddThreadName(thread_id, ring->ThreadName());
+    }
+    num_pending_events_ +=
+        ring->Drain([this, process_id, thread_id](const CommonEvent& evt) {
+          HostTraceEvent event(evt.name, evt.type, evt.start_ns, evt.end_ns,
+                               process_id, thread_id);
+          event.has_perf_counters = evt.has_perf_counters;
+          event.perf_counters = evt.perf_counters;
+          collector_.AddHostEvent(std::move(event));
+        });
+    num_dropped_events_ += ring->TakeNumDropped();
+  }
+}
+
+void ContinuousProfiler::WriteTraceFile() {
+  last_rotate_ns_ = PosixInNsec();
+  if (num_pending_events_ == 0) {
+    return;
+  }
+  std::unique_ptr<NodeTrees> tree(new NodeTrees(collector_.HostEvents(),
+                                                collector_.RuntimeEvents(),
+                                                collector_.DeviceEvents()));
+  ExtraInfo extrainfo;
+  extrainfo.AddExtraInfo(std::string("Dropped Events"), std::string("%llu"),
+                         static_cast<unsigned long long>(  // NOLINT
+                             num_dropped_events_));
+  extrainfo.AddExtraInfo(std::string("Sample Rate"), std::string("%u"),
+                         options_.sample_rate);
+  for (const auto& kv : collector_.ThreadNames()) {
+    extrainfo.AddExtraInfo(string_format(std::string("%llu"), kv.first),
+                           std::string("%s"), kv.second.c_str());
+  }
+  ProfilerResult result(std::move(tree), extrainfo);
+  std::string filename = string_format(
+      std::string("%s.%llu.paddle_trace.%s"), options_.file_prefix.c_str(),
+      static_cast<unsigned long long>(file_index_++),  // NOLINT
+      options_.format.c_str());
+  result.Save(filename, options_.format);
+  VLOG(3) << "ContinuousProfiler writes " << num_pending_events_
+          << " events into " << filename;
+
+  trace_files_.push_back(filename);
+  while (options_.max_files > 0 && trace_files_.size() > options_.max_files) {
+    std::remove(trace_files_.front().c_str());
+    trace_files_.pop_front();
+  }
+  collector_.ClearAll();
+  num_pending_events_ = 0;
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,103 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/profiler/trace_event_collector.h"
+
+namespace paddle {
+namespace platform {
+
+struct ContinuousProfilerOptions {
+  // trace files are named as <file_prefix>.<index>.paddle_trace.<format>
+  std::string file_prefix = "paddle_profile";
+  // "json" for chrome tracing, "pb" for the serialization format
+  std::string format = "json";
+  // verbose level of RecordEvent, works like host_trace_level
+  uint32_t trace_level = 1;
+  // number of events in the ring of each thread, an event takes about 224
+  // bytes, so the default ring takes about 1 MB per thread
+  size_t ring_capacity = 1 << 12;
+  // only keep 1 out of every sample_rate events of a thread
+  uint32_t sample_rate = 1;
+  // how often the background thread drains the rings
+  uint32_t drain_interval_ms = 200;
+  // a trace file is written once it holds this many events, or the
+  // rotate_interval_ms has passed since the last file
+  size_t max_events_per_file = 1 << 20;
+  uint32_t rotate_interval_ms = 60 * 1000;
+  // older trace files are removed, 0 means keep all of them
+  size_t max_files = 10;
+};
+
+// ContinuousProfiler records host events into fixed-size per-thread rings,
+// see HostEventRingBuffer, so its memory does not grow with the running time.
+// A background thread drains the rings periodically and streams the events
+// into rotating trace files. It can be left on in long-running jobs to catch
+// rare latency spikes, and can not be used together with Profiler.
+class ContinuousProfiler {
+ public:
+  static ContinuousProfiler& GetInstance();
+
+  void Start(const ContinuousProfilerOptions& options);
+
+  // Stop recording and write the remaining events.
+  void Stop();
+
+  bool IsRunning() const { return running_.load(); }
+
+  // Drain the rings and write the pending events into a new trace file.
+  void Flush();
+
+  // Number of events dropped because the rings were full.
+  uint64_t NumDroppedEvents() const;
+
+  // Trace files that have been written and not removed yet.
+  std::deque<std::string> TraceFiles();
+
+ private:
+  ContinuousProfiler() = default;
+  ~ContinuousProfiler();
+  DISABLE_COPY_AND_ASSIGN(ContinuousProfiler);
+
+  void DrainLoop();
+  // Must be called with mutex_ held.
+  void DrainRings();
+  void WriteTraceFile();
+
+  ContinuousProfilerOptions options_;
+  std::atomic<bool> running_{false};
+  std::thread drain_thread_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+
+  TraceEventCollector collector_;
+  size_t num_pending_events_ = 0;
+  uint64_t num_dropped_events_ = 0;
+  uint64_t last_rotate_ns_ = 0;
+  size_t file_index_ = 0;
+  std::deque<std::string> trace_files_;
+};
+
+}  // namespace platform
+}  // namespace paddle
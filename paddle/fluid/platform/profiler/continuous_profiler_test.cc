@@ -0,0 +1,118 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/profiler/continuous_profiler.h"
+#include "paddle/fluid/platform/profiler/host_event_recorder.h"
+
+// A new directory for the trace files of a test, the working directory on
+// Windows.
+static std::string MakeTraceDir() {
+#ifndef _WIN32
+  const char* tmp_dir = std::getenv("TMPDIR");
+  std::string pattern = std::string(tmp_dir ? tmp_dir : "/tmp") +
+                        "/continuous_profiler_test.XXXXXX";
+  if (mkdtemp(&pattern[0]) != nullptr) {
+    return pattern;
+  }
+#endif
+  return ".";
+}
+
+TEST(ContinuousProfilerTest, TestRingBuffer) {
+  using paddle::platform::CommonEvent;
+  using paddle::platform::EventRole;
+  using paddle::platform::HostEventRingBuffer;
+  using paddle::platform::TracerEventType;
+  HostEventRingBuffer ring(3, 1, "test");
+  EXPECT_EQ(ring.Capacity(), 4u);
+  for (int i = 0; i < 6; ++i) {
+    ring.Push("event", i, i + 1, EventRole::kOrdinary,
+              TracerEventType::UserDefined, nullptr);
+  }
+  EXPECT_EQ(ring.TakeNumDropped(), 2u);
+  std::string long_name(1000, 'a');
+  std::vector<uint64_t> start_ns;
+  ring.Drain([&start_ns](const CommonEvent& evt) {
+    start_ns.push_back(evt.start_ns);
+  });
+  EXPECT_EQ(start_ns, std::vector<uint64_t>({0, 1, 2, 3}));
+  EXPECT_TRUE(ring.Empty());
+
+  ring.Push(long_name.c_str(), 0, 1, EventRole::kOrdinary,
+            TracerEventType::UserDefined, "attr");
+  ring.Drain([](const CommonEvent& evt) {
+    EXPECT_EQ(strlen(evt.name), HostEventRingBuffer::kMaxNameLength - 1);
+    EXPECT_STREQ(evt.attr, "attr");
+  });
+}
+
+TEST(ContinuousProfilerTest, TestRotateFiles) {
+  using paddle::platform::ContinuousProfiler;
+  using paddle::platform::ContinuousProfilerOptions;
+  using paddle::platform::EventRole;
+  using paddle::platform::HostEventRecorder;
+  using paddle::platform::TracerEventType;
+  const std::string dir = MakeTraceDir();
+  const std::string prefix = dir + "/continuous_profiler_test";
+  ContinuousProfilerOptions options;
+  options.file_prefix = prefix;
+  options.sample_rate = 2;
+  options.max_files = 2;
+  auto& profiler = ContinuousProfiler::GetInstance();
+  profiler.Start(options);
+  EXPECT_TRUE(profiler.IsRunning());
+  for (int file = 0; file < 3; ++file) {
+    std::thread worker([]() {
+      for (int i = 0; i < 10; ++i) {
+        HostEventRecorder::GetInstance().RecordEvent(
+            "ContinuousProfilerTest_record", i, i + 1, EventRole::kOrdinary,
+            TracerEventType::UserDefined);
+      }
+    });
+    worker.join();
+    profiler.Flush();
+  }
+  profiler.Stop();
+  EXPECT_FALSE(profiler.IsRunning());
+
+  auto files = profiler.TraceFiles();
+  ASSERT_EQ(files.size(), 2u);
+  EXPECT_EQ(files.back(), prefix + ".2.paddle_trace.json");
+  std::ifstream removed(prefix + ".0.paddle_trace.json");
+  EXPECT_FALSE(removed.good());
+  std::ifstream last(files.back());
+  std::string content((std::istreambuf_iterator<char>(last)),
+                      std::istreambuf_iterator<char>());
+  last.close();
+  EXPECT_NE(content.find("ContinuousProfilerTest_record"), std::string::npos);
+
+  for (auto& file : files) {
+    EXPECT_EQ(std::remove(file.c_str()), 0) << file;
+  }
+#ifndef _WIN32
+  if (dir != ".") {
+    EXPECT_EQ(rmdir(dir.c_str()), 0) << dir;
+  }
+#endif
+}
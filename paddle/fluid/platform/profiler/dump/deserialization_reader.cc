@@ -171,6 +171,14 @@ HostTraceEventNode* DeserializationReader::RestoreHostTraceEventNode(
   host_event.end_ns = host_event_proto.end_ns();
   host_event.process_id = host_event_proto.process_id();
   host_event.thread_id = host_event_proto.thread_id();
+  if (host_event_proto.has_perf_counters()) {
+    const PerfCountersProto& counters_proto = host_event_proto.perf_counters();
+    host_event.has_perf_counters = true;
+    host_event.perf_counters.cycles = counters_proto.cycles();
+    host_event.perf_counters.instructions = counters_proto.instructions();
+    host_event.perf_counters.llc_misses = counters_proto.llc_misses();
+    host_event.perf_counters.branch_misses = counters_proto.branch_misses();
+  }
   return new HostTraceEventNode(host_event);
 }
 
@@ -120,6 +120,15 @@ void SerializationLogger::LogHostTraceEventNode(
   host_trace_event->set_end_ns(host_node.EndNs());
   host_trace_event->set_process_id(host_node.ProcessId());
   host_trace_event->set_thread_id(host_node.ThreadId());
+  if (host_node.HasPerfCounters()) {
+    const PerfCountersInfo& counters = host_node.PerfCounters();
+    PerfCountersProto* counters_proto =
+        host_trace_event->mutable_perf_counters();
+    counters_proto->set_cycles(counters.cycles);
+    counters_proto->set_instructions(counters.instructions);
+    counters_proto->set_llc_misses(counters.llc_misses);
+    counters_proto->set_branch_misses(counters.branch_misses);
+  }
   current_host_trace_event_node_proto_->set_allocated_host_trace_event(
       host_trace_event);
 }
@@ -133,6 +133,10 @@ class HostTraceEventNode {
   uint64_t Duration() const {
     return host_event_.end_ns - host_event_.start_ns;
   }
+  bool HasPerfCounters() const { return host_event_.has_perf_counters; }
+  const PerfCountersInfo& PerfCounters() const {
+    return host_event_.perf_counters;
+  }
 
   // member function
   void AddChild(HostTraceEventNode* node) { children_.push_back(node); }
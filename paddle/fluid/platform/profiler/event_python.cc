@@ -46,6 +46,14 @@ HostPythonNode* ProfilerResult::CopyTree(HostTraceEventNode* root) {
   host_python_node->end_ns = root->EndNs();
   host_python_node->process_id = root->ProcessId();
   host_python_node->thread_id = root->ThreadId();
+  if (root->HasPerfCounters()) {
+    const PerfCountersInfo& counters = root->PerfCounters();
+    host_python_node->has_perf_counters = true;
+    host_python_node->cycles = counters.cycles;
+    host_python_node->instructions = counters.instructions;
+    host_python_node->llc_misses = counters.llc_misses;
+    host_python_node->branch_misses = counters.branch_misses;
+  }
   for (auto it = root->GetChildren().begin(); it != root->GetChildren().end();
        ++it) {
     host_python_node->children_node_ptrs.push_back(CopyTree(*it));
@@ -58,6 +58,12 @@ struct HostPythonNode {
   uint64_t process_id;
   // thread id of the record
   uint64_t thread_id;
+  // hardware performance counters, valid if has_perf_counters is true
+  bool has_perf_counters = false;
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t llc_misses = 0;
+  uint64_t branch_misses = 0;
   // children node
   std::vector<HostPythonNode*> children_node_ptrs;
   // runtime node
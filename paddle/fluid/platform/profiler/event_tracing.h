@@ -90,6 +90,9 @@ class RecordEvent {
   void OriginalConstruct(const std::string& name, const EventRole role,
                          const std::string& attr);
 
+  // Read the hardware counters at the beginning of the event, if enabled.
+  void StartPerfCounters();
+
   bool is_enabled_{false};
   bool is_pushed_{false};
   // Event name
@@ -103,6 +106,8 @@ class RecordEvent {
   TracerEventType type_{TracerEventType::UserDefined};
   std::string* attr_{nullptr};
   bool finished_{false};
+  bool has_perf_counters_{false};
+  PerfCountersInfo start_perf_counters_;
 };
 
 }  // namespace platform
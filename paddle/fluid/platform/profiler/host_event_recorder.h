@@ -14,6 +14,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -181,6 +186,190 @@ char *EventContainer<EventType>::GetStringStorage(size_t sz) {
   return storage;
 }
 
+// A fixed-size ring of host events for the continuous profiling mode. It is
+// written by exactly one thread and drained by another one without locking.
+// New events are dropped when the ring is full, so a slow consumer never
+// blocks the recording thread. String attributes are copied into the slot
+// and truncated to kMaxNameLength/kMaxAttrLength.
+class HostEventRingBuffer {
+ public:
+  static constexpr size_t kMaxNameLength = 128;
+  static constexpr size_t kMaxAttrLength = 64;
+
+  // capacity is rounded up to a power of 2
+  HostEventRingBuffer(size_t capacity, uint64_t thread_id,
+                      const std::string &thread_name)
+      : thread_id_(thread_id), thread_name_(thread_name) {
+    size_t size = 1;
+    while (size < std::max<size_t>(capacity, 2)) {
+      size <<= 1;
+    }
+    slots_.reset(new Slot[size]);
+    mask_ = size - 1;
+  }
+
+  DISABLE_COPY_AND_ASSIGN(HostEventRingBuffer);
+
+ public:
+  // Producer side, returns false if the event is dropped.
+  bool Push(const char *name, uint64_t start_ns, uint64_t end_ns,
+            EventRole role, TracerEventType type, const char *attr,
+            const PerfCountersInfo *perf_counters = nullptr) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    Slot &slot = slots_[tail & mask_];
+    CopyTruncated(slot.name, name, kMaxNameLength);
+    slot.has_attr = attr != nullptr;
+    if (slot.has_attr) {
+      CopyTruncated(slot.attr, attr, kMaxAttrLength);
+    }
+    slot.has_perf_counters = perf_counters != nullptr;
+    if (slot.has_perf_counters) {
+      slot.perf_counters = *perf_counters;
+    }
+    slot.start_ns = start_ns;
+    slot.end_ns = end_ns;
+    slot.role = role;
+    slot.type = type;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side, calls callback(const CommonEvent &) for every pending
+  // event. The strings of the event are only valid inside the callback.
+  template <typename Callback>
+  size_t Drain(Callback &&callback) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    for (uint64_t i = head; i < tail; ++i) {
+      const Slot &slot = slots_[i & mask_];
+      CommonEvent event(slot.name, slot.start_ns, slot.end_ns, slot.role,
+                        slot.type);
+      if (slot.has_attr) {
+        event.attr = slot.attr;
+      }
+      event.has_perf_counters = slot.has_perf_counters;
+      event.perf_counters = slot.perf_counters;
+      callback(event);
+    }
+    head_.store(tail, std::memory_order_release);
+    return tail - head;
+  }
+
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  // Returns the number of dropped events since the last call.
+  uint64_t TakeNumDropped() {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+  uint64_t ThreadId() const { return thread_id_; }
+
+  const std::string &ThreadName() const { return thread_name_; }
+
+ private:
+  struct Slot {
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+    EventRole role = EventRole::kOrdinary;
+    TracerEventType type = TracerEventType::NumTypes;
+    bool has_attr = false;
+    bool has_perf_counters = false;
+    PerfCountersInfo perf_counters;
+    char name[kMaxNameLength];
+    char attr[kMaxAttrLength];
+  };
+
+  static void CopyTruncated(char *dst, const char *src, size_t capacity) {
+    size_t len = strnlen(src, capacity - 1);
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+  }
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  uint64_t thread_id_;
+  std::string thread_name_;
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  alignas(64) std::atomic<uint64_t> dropped_{0};
+};
+
+// Keeps the rings of all threads while the continuous profiling mode is on.
+// Rings are shared with their recording threads, so the events of an exited
+// thread can still be drained.
+class HostEventRingRegistry {
+ public:
+  // singleton
+  static HostEventRingRegistry &GetInstance() {
+    static HostEventRingRegistry instance;
+    return instance;
+  }
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Record events into per-thread rings of ring_capacity events, and only
+  // keep 1 out of every sample_rate events of a thread.
+  void Enable(size_t ring_capacity, uint32_t sample_rate) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ring_capacity_ = ring_capacity;
+    sample_rate_.store(std::max<uint32_t>(sample_rate, 1),
+                       std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_release);
+  }
+
+  void Disable() { enabled_.store(false, std::memory_order_release); }
+
+  uint32_t SampleRate() const {
+    return sample_rate_.load(std::memory_order_relaxed);
+  }
+
+  // Rings created before the last Enable are stale and get replaced.
+  uint64_t Generation() const {
+    return generation_.load(std::memory_order_relaxed);
+  }
+
+  std::shared_ptr<HostEventRingBuffer> CreateRing(
+      uint64_t thread_id, const std::string &thread_name) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto ring = std::make_shared<HostEventRingBuffer>(ring_capacity_,
+                                                      thread_id, thread_name);
+    rings_.push_back(ring);
+    return ring;
+  }
+
+  // Returns all rings, and forgets drained rings no thread records into.
+  std::vector<std::shared_ptr<HostEventRingBuffer>> GetAllRings() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto orphan = [](const std::shared_ptr<HostEventRingBuffer> &ring) {
+      return ring.use_count() == 1 && ring->Empty();
+    };
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(), orphan),
+                 rings_.end());
+    return rings_;
+  }
+
+ private:
+  HostEventRingRegistry() = default;
+  DISABLE_COPY_AND_ASSIGN(HostEventRingRegistry);
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> generation_{0};
+  size_t ring_capacity_ = 0;
+  std::atomic<uint32_t> sample_rate_{1};
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<HostEventRingBuffer>> rings_;
+};
+
 struct ThreadEventSection {
   std::string thread_name;
   uint64_t thread_id;
@@ -197,9 +386,14 @@ class ThreadEventRecorder {
   DISABLE_COPY_AND_ASSIGN(ThreadEventRecorder);
 
  public:
-  // Forward call to EventContainer::Record
+  // Forward call to EventContainer::Record, or to the ring of this thread in
+  // the continuous profiling mode
   template <typename... Args>
   void RecordEvent(Args &&... args) {
+    if (UNLIKELY(HostEventRingRegistry::GetInstance().IsEnabled())) {
+      RecordEventToRing(std::forward<Args>(args)...);
+      return;
+    }
     base_evt_cntr_.Record(std::forward<Args>(args)...);
   }
 
@@ -212,9 +406,62 @@ class ThreadEventRecorder {
   }
 
  private:
+  static const char *CStr(const char *str) { return str; }
+  static const char *CStr(const std::string &str) { return str.c_str(); }
+
+  template <typename NameType>
+  void RecordEventToRing(const NameType &name, uint64_t start_ns,
+                         uint64_t end_ns, EventRole role,
+                         TracerEventType type) {
+    PushToRing(CStr(name), start_ns, end_ns, role, type, nullptr);
+  }
+
+  template <typename NameType>
+  void RecordEventToRing(const NameType &name, uint64_t start_ns,
+                         uint64_t end_ns, EventRole role, TracerEventType type,
+                         const std::string &attr) {
+    PushToRing(CStr(name), start_ns, end_ns, role, type, attr.c_str());
+  }
+
+  template <typename NameType>
+  void RecordEventToRing(const NameType &name, uint64_t start_ns,
+                         uint64_t end_ns, EventRole role, TracerEventType type,
+                         const PerfCountersInfo &perf_counters) {
+    PushToRing(CStr(name), start_ns, end_ns, role, type, nullptr,
+               &perf_counters);
+  }
+
+  template <typename NameType>
+  void RecordEventToRing(const NameType &name, uint64_t start_ns,
+                         uint64_t end_ns, EventRole role, TracerEventType type,
+                         const std::string &attr,
+                         const PerfCountersInfo &perf_counters) {
+    PushToRing(CStr(name), start_ns, end_ns, role, type, attr.c_str(),
+               &perf_counters);
+  }
+
+  void PushToRing(const char *name, uint64_t start_ns, uint64_t end_ns,
+                  EventRole role, TracerEventType type, const char *attr,
+                  const PerfCountersInfo *perf_counters = nullptr) {
+    auto &registry = HostEventRingRegistry::GetInstance();
+    uint32_t sample_rate = registry.SampleRate();
+    if (sample_rate > 1 && ++sample_counter_ % sample_rate != 0) {
+      return;
+    }
+    if (UNLIKELY(ring_ == nullptr ||
+                 ring_generation_ != registry.Generation())) {
+      ring_generation_ = registry.Generation();
+      ring_ = registry.CreateRing(thread_id_, thread_name_);
+    }
+    ring_->Push(name, start_ns, end_ns, role, type, attr, perf_counters);
+  }
+
   uint64_t thread_id_;
   std::string thread_name_;
   EventContainer<CommonEvent> base_evt_cntr_;
+  std::shared_ptr<HostEventRingBuffer> ring_;
+  uint64_t ring_generation_ = 0;
+  uint64_t sample_counter_ = 0;
 };
 
 struct HostEventSection {
@@ -17,6 +17,7 @@
 #include "paddle/fluid/platform/flags.h"
 #include "paddle/fluid/platform/profiler/common_event.h"
 #include "paddle/fluid/platform/profiler/host_event_recorder.h"
+#include "paddle/fluid/platform/profiler/perf_counter.h"
 
 // Used to filter events, works like glog VLOG(level).
 // RecordEvent will works if host_trace_level >= level.
@@ -44,6 +45,8 @@ void ProcessHostEvents(const HostEventSection& host_events,
       event.end_ns = evt.end_ns;
       event.process_id = host_events.process_id;
       event.thread_id = tid;
+      event.has_perf_counters = evt.has_perf_counters;
+      event.perf_counters = evt.perf_counters;
       collector->AddHostEvent(std::move(event));
     }
   }
@@ -61,8 +64,20 @@ void HostTracer::StartTracing() {
   PADDLE_ENFORCE_EQ(
       state_ == TracerState::READY || state_ == TracerState::STOPED, true,
       platform::errors::PreconditionNotMet("TracerState must be READY"));
+  PADDLE_ENFORCE_EQ(HostEventRingRegistry::GetInstance().IsEnabled(), false,
+                    platform::errors::PreconditionNotMet(
+                        "HostTracer can not be started while the "
+                        "ContinuousProfiler is running."));
   HostEventRecorder::GetInstance().GatherEvents();
   HostTraceLevel::GetInstance().SetLevel(options_.trace_level);
+  if (options_.with_perf_counters) {
+    if (PerfCounters::IsSupported()) {
+      PerfCounters::Enable();
+    } else {
+      LOG(WARNING) << "Hardware performance counters are not available, "
+                      "check /proc/sys/kernel/perf_event_paranoid.";
+    }
+  }
   state_ = TracerState::STARTED;
 }
 
@@ -71,6 +86,7 @@ void HostTracer::StopTracing() {
       state_, TracerState::STARTED,
       platform::errors::PreconditionNotMet("TracerState must be STARTED"));
   HostTraceLevel::GetInstance().SetLevel(HostTraceLevel::kDisabled);
+  PerfCounters::Disable();
   state_ = TracerState::STOPED;
 }
 
@@ -41,6 +41,8 @@ class HostTraceLevel {
 
 struct HostTracerOptions {
   uint32_t trace_level = 0;
+  // collect hardware performance counters for operator events
+  bool with_perf_counters = false;
 };
 
 class HostTracer : public TracerBase {
@@ -0,0 +1,139 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/perf_counter.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include "glog/logging.h"
+
+namespace paddle {
+namespace platform {
+
+std::atomic<bool> PerfCounters::enabled_{false};
+
+PerfCountersInfo operator-(const PerfCountersInfo& end,
+                           const PerfCountersInfo& start) {
+  PerfCountersInfo delta;
+  delta.cycles = end.cycles - start.cycles;
+  delta.instructions = end.instructions - start.instructions;
+  delta.llc_misses = end.llc_misses - start.llc_misses;
+  delta.branch_misses = end.branch_misses - start.branch_misses;
+  return delta;
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr int kNumCounters = 4;
+
+// The order of the counters in the group, and so in the values read.
+constexpr uint64_t kCounterConfigs[kNumCounters] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+class ThreadPerfCounters {
+ public:
+  ThreadPerfCounters() {
+    for (int i = 0; i < kNumCounters; ++i) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = kCounterConfigs[i];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // only the group leader starts disabled
+      attr.disabled = i == 0 ? 1 : 0;
+      int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1,
+                                        i == 0 ? -1 : fds_[0], 0));
+      if (fd < 0) {
+        VLOG(1) << "perf_event_open failed for counter " << i
+                << ", errno: " << errno;
+        Close();
+        return;
+      }
+      fds_[i] = fd;
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    opened_ = true;
+  }
+
+  ~ThreadPerfCounters() { Close(); }
+
+  bool IsOpened() const { return opened_; }
+
+  bool Read(PerfCountersInfo* info) {
+    if (!opened_) {
+      return false;
+    }
+    // layout of PERF_FORMAT_GROUP: { nr, values[nr] }
+    uint64_t buf[1 + kNumCounters];
+    if (read(fds_[0], buf, sizeof(buf)) != sizeof(buf) ||
+        buf[0] != kNumCounters) {
+      return false;
+    }
+    info->cycles = buf[1];
+    info->instructions = buf[2];
+    info->llc_misses = buf[3];
+    info->branch_misses = buf[4];
+    return true;
+  }
+
+ private:
+  void Close() {
+    for (int i = kNumCounters - 1; i >= 0; --i) {
+      if (fds_[i] >= 0) {
+        close(fds_[i]);
+        fds_[i] = -1;
+      }
+    }
+    opened_ = false;
+  }
+
+  int fds_[kNumCounters] = {-1, -1, -1, -1};
+  bool opened_ = false;
+};
+
+ThreadPerfCounters& GetThreadPerfCounters() {
+  static thread_local ThreadPerfCounters counters;
+  return counters;
+}
+
+}  // namespace
+
+bool PerfCounters::IsSupported() { return GetThreadPerfCounters().IsOpened(); }
+
+bool PerfCounters::Read(PerfCountersInfo* info) {
+  return GetThreadPerfCounters().Read(info);
+}
+
+#else
+
+bool PerfCounters::IsSupported() { return false; }
+
+bool PerfCounters::Read(PerfCountersInfo* info) { return false; }
+
+#endif
+
+}  // namespace platform
+}  // namespace paddle
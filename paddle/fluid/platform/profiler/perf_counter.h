@@ -0,0 +1,58 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include "paddle/fluid/platform/profiler/trace_event.h"
+
+namespace paddle {
+namespace platform {
+
+// Reads the hardware performance counters (cycles, instructions, LLC misses
+// and branch misses) of the calling thread through perf_event_open(2). The
+// counters of a thread are opened as one group at the first Read on it.
+// Counters are only available on Linux, and may be denied by the kernel,
+// see /proc/sys/kernel/perf_event_paranoid.
+class PerfCounters {
+ public:
+  static void Enable() { enabled_.store(true, std::memory_order_relaxed); }
+
+  static void Disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Whether the counters can be opened on the calling thread.
+  static bool IsSupported();
+
+  // Reads the accumulated counters of the calling thread, returns false if
+  // they are not available.
+  static bool Read(PerfCountersInfo* info);
+
+  // Whether counters are collected for the events of this type.
+  static bool NeedCounters(TracerEventType type) {
+    return type == TracerEventType::Operator ||
+           type == TracerEventType::OperatorInner;
+  }
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+// Returns end - start for every counter.
+PerfCountersInfo operator-(const PerfCountersInfo& end,
+                           const PerfCountersInfo& start);
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,51 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/perf_counter.h"
+
+#include "gtest/gtest.h"
+
+using paddle::platform::PerfCounters;
+using paddle::platform::PerfCountersInfo;
+using paddle::platform::TracerEventType;
+
+TEST(PerfCounterTest, TestNeedCounters) {
+  EXPECT_TRUE(PerfCounters::NeedCounters(TracerEventType::Operator));
+  EXPECT_TRUE(PerfCounters::NeedCounters(TracerEventType::OperatorInner));
+  EXPECT_FALSE(PerfCounters::NeedCounters(TracerEventType::UserDefined));
+  EXPECT_FALSE(PerfCounters::IsEnabled());
+  PerfCounters::Enable();
+  EXPECT_TRUE(PerfCounters::IsEnabled());
+  PerfCounters::Disable();
+  EXPECT_FALSE(PerfCounters::IsEnabled());
+}
+
+TEST(PerfCounterTest, TestRead) {
+  PerfCountersInfo start;
+  if (!PerfCounters::IsSupported()) {
+    // perf_event_open may be denied in containers.
+    EXPECT_FALSE(PerfCounters::Read(&start));
+    return;
+  }
+  ASSERT_TRUE(PerfCounters::Read(&start));
+  volatile double sum = 0;
+  for (int i = 0; i < 100000; ++i) {
+    sum = sum + i * 0.5;
+  }
+  PerfCountersInfo end;
+  ASSERT_TRUE(PerfCounters::Read(&end));
+  PerfCountersInfo delta = end - start;
+  EXPECT_GT(delta.instructions, 100000u);
+  EXPECT_LE(delta.instructions, end.instructions);
+}
@@ -67,6 +67,7 @@ Profiler::Profiler(const ProfilerOptions& options) {
   if (trace_switch.test(kProfileCPUOptionBit)) {
     HostTracerOptions host_tracer_options;
     host_tracer_options.trace_level = options_.trace_level;
+    host_tracer_options.with_perf_counters = options_.with_perf_counters;
     tracers_.emplace_back(new HostTracer(host_tracer_options), true);
   }
   if (trace_switch.test(kProfileGPUOptionBit)) {
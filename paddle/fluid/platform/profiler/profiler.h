@@ -38,6 +38,8 @@ static constexpr uint32_t kProfileMLUOptionBit = 2;
 struct ProfilerOptions {
   uint32_t trace_switch = 0;  // bit 0: cpu, bit 1: gpu, bit 2: mlu
   uint32_t trace_level = FLAGS_host_trace_level;
+  // collect hardware performance counters for operator events
+  bool with_perf_counters = false;
 };
 
 class Profiler {
@@ -118,6 +118,16 @@ struct MemsetEventInfo {
   uint32_t value;
 };
 
+// Hardware performance counters collected during a host event, see
+// perf_counter.h.
+struct PerfCountersInfo {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  // last level cache misses
+  uint64_t llc_misses = 0;
+  uint64_t branch_misses = 0;
+};
+
 struct HostTraceEvent {
   HostTraceEvent() = default;
   HostTraceEvent(const std::string& name, TracerEventType type,
@@ -141,6 +151,10 @@ struct HostTraceEvent {
   uint64_t process_id;
   // thread id of the record
   uint64_t thread_id;
+  // whether perf_counters is collected
+  bool has_perf_counters = false;
+  // hardware performance counters of the record
+  PerfCountersInfo perf_counters;
 };
 
 struct RuntimeTraceEvent {
@@ -21,6 +21,7 @@
 namespace py = pybind11;
 using paddle::framework::CostData;
 using paddle::framework::CostModel;
+using paddle::framework::MachineProfile;
 using paddle::framework::ProgramDesc;
 
 namespace paddle {
@@ -30,10 +31,32 @@ void BindCostModel(py::module* m) {
   py::class_<CostData>(*m, "CostData")
       .def(py::init<>())
       .def("get_whole_time_ms", &CostData::GetWholeTimeMs)
-      .def("get_op_time_ms", &CostData::GetOpTimeMs);
+      .def("get_op_time_ms", &CostData::GetOpTimeMs)
+      .def("get_whole_memory_bytes", &CostData::GetWholeMemoryBytes)
+      .def("get_op_memory_bytes", &CostData::GetOpMemoryBytes);
+
+  py::class_<MachineProfile>(*m, "MachineProfile")
+      .def(py::init<>())
+      .def_readwrite("gflops", &MachineProfile::gflops)
+      .def_readwrite("memory_bandwidth_gbps",
+                     &MachineProfile::memory_bandwidth_gbps)
+      .def_readwrite("op_overhead_ms", &MachineProfile::op_overhead_ms);
 
   py::class_<CostModel>(*m, "CostModel")
       .def(py::init<>())
+      .def_static("get_machine_profile", &CostModel::GetMachineProfile)
+      .def_static("set_machine_profile", &CostModel::SetMachineProfile)
+      .def("static_estimate",
+           [](CostModel& self, py::object py_main_program,
+              const std::string& device, int64_t batch_size) {
+             py::object py_main_program_desc = py_main_program.attr("desc");
+             ProgramDesc* main_program_desc =
+                 py_main_program_desc.cast<ProgramDesc*>();
+             return self.StaticEstimate(*main_program_desc, device,
+                                        batch_size);
+           },
+           py::arg("main_program"), py::arg("device") = "cpu",
+           py::arg("batch_size") = 1)
       .def("profile_measure",
            [](CostModel& self, py::object py_main_program,
               py::object py_startup_program, const std::string& device,
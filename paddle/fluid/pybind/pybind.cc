@@ -65,6 +65,7 @@ limitations under the License. */
 #include "paddle/fluid/imperative/amp_auto_cast.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
+#include "paddle/fluid/memory/allocation_profiler.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/memory/allocation/cuda_ipc_allocator.h"
 #endif
@@ -82,6 +83,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/monitor.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/profiler/continuous_profiler.h"
 #include "paddle/fluid/platform/profiler/event_python.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
@@ -3000,6 +3002,18 @@ All parameter, weight, gradient are variables in Paddle.
   });
   m.def("memory_stat_get_current", memory::StatGetCurrentValue);
   m.def("memory_stat_get_peak", memory::StatGetPeakValue);
+  m.def("allocation_profile_snapshot", []() {
+    return memory::AllocationProfiler::Instance().Snapshot().ToString();
+  });
+  m.def("allocation_profile_diff",
+        [](const std::string &before, const std::string &after) {
+          return memory::DiffAllocationProfileSnapshots(
+                     memory::AllocationProfileSnapshot::FromString(before),
+                     memory::AllocationProfileSnapshot::FromString(after))
+              .ToString();
+        });
+  m.def("allocation_profile_reset",
+        []() { memory::AllocationProfiler::Instance().Reset(); });
   m.def("run_cmd",
         [](const std::string &cmd, int time_out = -1,
            int sleep_inter = -1) -> const std::string {
@@ -3376,6 +3390,15 @@ All parameter, weight, gradient are variables in Paddle.
       .def_readwrite("process_id",
                      &paddle::platform::HostPythonNode::process_id)
       .def_readwrite("thread_id", &paddle::platform::HostPythonNode::thread_id)
+      .def_readwrite("has_perf_counters",
+                     &paddle::platform::HostPythonNode::has_perf_counters)
+      .def_readwrite("cycles", &paddle::platform::HostPythonNode::cycles)
+      .def_readwrite("instructions",
+                     &paddle::platform::HostPythonNode::instructions)
+      .def_readwrite("llc_misses",
+                     &paddle::platform::HostPythonNode::llc_misses)
+      .def_readwrite("branch_misses",
+                     &paddle::platform::HostPythonNode::branch_misses)
       .def_readwrite("children_node",
                      &paddle::platform::HostPythonNode::children_node_ptrs)
       .def_readwrite("runtime_node",
@@ -3408,7 +3431,47 @@ All parameter, weight, gradient are variables in Paddle.
   py::class_<paddle::platform::ProfilerOptions>(m, "ProfilerOptions")
       .def(py::init<>())
       .def_readwrite("trace_switch",
-                     &paddle::platform::ProfilerOptions::trace_switch);
+                     &paddle::platform::ProfilerOptions::trace_switch)
+      .def_readwrite("with_perf_counters",
+                     &paddle::platform::ProfilerOptions::with_perf_counters);
+
+  py::class_<paddle::platform::ContinuousProfilerOptions>(
+      m, "ContinuousProfilerOptions")
+      .def(py::init<>())
+      .def_readwrite("file_prefix",
+                     &paddle::platform::ContinuousProfilerOptions::file_prefix)
+      .def_readwrite("format",
+                     &paddle::platform::ContinuousProfilerOptions::format)
+      .def_readwrite("trace_level",
+                     &paddle::platform::ContinuousProfilerOptions::trace_level)
+      .def_readwrite(
+          "ring_capacity",
+          &paddle::platform::ContinuousProfilerOptions::ring_capacity)
+      .def_readwrite("sample_rate",
+                     &paddle::platform::ContinuousProfilerOptions::sample_rate)
+      .def_readwrite(
+          "drain_interval_ms",
+          &paddle::platform::ContinuousProfilerOptions::drain_interval_ms)
+      .def_readwrite(
+          "max_events_per_file",
+          &paddle::platform::ContinuousProfilerOptions::max_events_per_file)
+      .def_readwrite(
+          "rotate_interval_ms",
+          &paddle::platform::ContinuousProfilerOptions::rotate_interval_ms)
+      .def_readwrite("max_files",
+                     &paddle::platform::ContinuousProfilerOptions::max_files);
+
+  m.def("start_continuous_profiler",
+        [](const paddle::platform::ContinuousProfilerOptions &options) {
+          platform::EnableHostEventRecorder();
+          platform::ContinuousProfiler::GetInstance().Start(options);
+        });
+  m.def("stop_continuous_profiler", []() {
+    platform::ContinuousProfiler::GetInstance().Stop();
+    platform::DisableHostEventRecorder();
+  });
+  m.def("flush_continuous_profiler",
+        []() { platform::ContinuousProfiler::GetInstance().Flush(); });
 
   py::class_<platform::RecordEvent>(m, "_RecordEvent")
       .def(py::init([](std::string name, platform::TracerEventType type) {
@@ -14,6 +14,10 @@
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #include "paddle/phi/api/ext/exception.h"
 #include "paddle/phi/common/place.h"
 
@@ -21,9 +25,44 @@
 // without eigen.
 #include "paddle/phi/core/device_context.h"
 #include "unsupported/Eigen/CXX11/Tensor"
+#include "unsupported/Eigen/CXX11/ThreadPool"
+
+// TODO(wilber): The phi computing library requires a component to manage
+// flags.
+#include "paddle/fluid/platform/flags.h"
+
+PADDLE_DEFINE_EXPORTED_int32(
+    cpu_parallel_pool_size,
+    0,
+    "The number of threads in the pool shared by the ParallelFor of the CPU "
+    "kernels, 0 for the number of cores. The threads a loop runs on are set "
+    "by SetIntraOpNumThreads, e.g. with the number of math library threads.");
 
 namespace phi {
 
+static thread_local int intra_op_num_threads = 1;
+
+void SetIntraOpNumThreads(int num_threads) {
+  intra_op_num_threads = std::max(num_threads, 1);
+}
+
+int GetIntraOpNumThreads() { return intra_op_num_threads; }
+
+// Whether the current thread runs a chunk of a ParallelFor, in which case the
+// nested loops run on the current thread.
+static thread_local bool in_parallel_region = false;
+
+// The pool shared by the ParallelFor of all the threads, created when a
+// thread first asks for more than one thread. Never destroyed, so that the
+// workers do not outlive the globals they use at exit.
+static Eigen::ThreadPool* SharedThreadPool() {
+  static Eigen::ThreadPool* pool = new Eigen::ThreadPool(
+      FLAGS_cpu_parallel_pool_size > 0
+          ? FLAGS_cpu_parallel_pool_size
+          : std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  return pool;
+}
+
 struct CPUContext::Impl {
   Impl() : place_(CPUPlace()) {}
 
@@ -70,6 +109,67 @@ Eigen::DefaultDevice* CPUContext::eigen_device() const {
 
 const Place& CPUContext::GetPlace() const { return impl_->place_; }
 
+int64_t CPUContext::NumParallelChunks(int64_t n, int64_t grain_size) {
+  if (n <= 0) {
+    return 0;
+  }
+  int64_t num_threads = intra_op_num_threads;
+  if (num_threads <= 1 || in_parallel_region) {
+    return 1;
+  }
+  grain_size = std::max<int64_t>(grain_size, 1);
+  return std::min(num_threads, (n + grain_size - 1) / grain_size);
+}
+
+void CPUContext::ParallelFor(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    const std::function<void(int64_t, int64_t)>& func) const {
+  int64_t num_chunks = NumParallelChunks(end - begin, grain_size);
+  if (num_chunks == 0) {
+    return;
+  }
+  if (num_chunks == 1) {
+    func(begin, end);
+    return;
+  }
+  int64_t chunk_size = (end - begin + num_chunks - 1) / num_chunks;
+  std::mutex mutex;
+  std::exception_ptr error;
+  auto run_chunk = [&](int64_t chunk_begin) {
+    in_parallel_region = true;
+    try {
+      func(chunk_begin, std::min(end, chunk_begin + chunk_size));
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+    in_parallel_region = false;
+  };
+  auto* pool = SharedThreadPool();
+  Eigen::Barrier barrier(static_cast<unsigned int>(num_chunks - 1));
+  for (int64_t i = 1; i < num_chunks; ++i) {
+    int64_t chunk_begin = begin + i * chunk_size;
+    if (chunk_begin >= end) {
+      barrier.Notify();
+      continue;
+    }
+    pool->Schedule([&, chunk_begin] {
+      run_chunk(chunk_begin);
+      barrier.Notify();
+    });
+  }
+  // The calling thread runs the first chunk.
+  run_chunk(begin);
+  barrier.Wait();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 void CPUContext::SetEigenDevice(Eigen::DefaultDevice* device) {
   impl_->eigen_device_ = device;
 }
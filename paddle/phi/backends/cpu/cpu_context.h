@@ -14,7 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "paddle/phi/backends/cpu/forwards.h"
 #include "paddle/phi/core/device_context.h"
@@ -24,6 +28,13 @@ limitations under the License. */
 
 namespace phi {
 
+// Sets the threads the ParallelFor called on the current thread runs on,
+// including the current thread. The other threads are taken from a pool
+// shared by all the CPUContexts. 1 by default, which runs the loops on the
+// current thread only.
+PADDLE_API void SetIntraOpNumThreads(int num_threads);
+PADDLE_API int GetIntraOpNumThreads();
+
 class PADDLE_API CPUContext : public DeviceContext {
  public:
   CPUContext();
@@ -34,6 +45,48 @@ class PADDLE_API CPUContext : public DeviceContext {
   Eigen::DefaultDevice* eigen_device() const;
   const Place& GetPlace() const override;
 
+  // Splits [begin, end) into at most GetIntraOpNumThreads() chunks of at
+  // least grain_size iterations, and runs func(chunk_begin, chunk_end) for
+  // each of them in parallel. The calls nested in func run on the thread of
+  // their chunk. The first exception thrown by func is rethrown after all the
+  // chunks ran.
+  void ParallelFor(int64_t begin,
+                   int64_t end,
+                   int64_t grain_size,
+                   const std::function<void(int64_t, int64_t)>& func) const;
+
+  // Computes func(chunk_begin, chunk_end) for the chunks ParallelFor splits
+  // [begin, end) into, and combines the results in the order of the chunks
+  // with reduce, starting from identity.
+  template <typename T, typename Func, typename Reduce>
+  T ParallelReduce(int64_t begin,
+                   int64_t end,
+                   int64_t grain_size,
+                   const T& identity,
+                   const Func& func,
+                   const Reduce& reduce) const {
+    int64_t num_chunks = NumParallelChunks(end - begin, grain_size);
+    if (num_chunks <= 1) {
+      return begin < end ? reduce(identity, func(begin, end)) : identity;
+    }
+    int64_t chunk_size = (end - begin + num_chunks - 1) / num_chunks;
+    std::vector<T> results(num_chunks, identity);
+    ParallelFor(0, num_chunks, 1, [&](int64_t first, int64_t last) {
+      for (int64_t i = first; i < last; ++i) {
+        int64_t chunk_begin = begin + i * chunk_size;
+        int64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+        if (chunk_begin < chunk_end) {
+          results[i] = func(chunk_begin, chunk_end);
+        }
+      }
+    });
+    T result = identity;
+    for (auto& value : results) {
+      result = reduce(result, value);
+    }
+    return result;
+  }
+
  public:
   // NOTE: DeviceContext hold resources. Used in training scenarios.
   // The interface used by the training scene, DeviceContext will initialize
@@ -47,6 +100,9 @@ class PADDLE_API CPUContext : public DeviceContext {
   void SetEigenDevice(Eigen::DefaultDevice* device);
 
  private:
+  // The number of chunks ParallelFor splits n iterations into.
+  static int64_t NumParallelChunks(int64_t n, int64_t grain_size);
+
   struct Impl;
   std::unique_ptr<Impl> impl_;
 };
@@ -0,0 +1,105 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cmath>
+
+#include "paddle/phi/common/scalar.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/cpu_jit.h"
+
+namespace phi {
+
+// The update of the adam and adamw CPU kernels: updates the beta pows unless
+// use_global_beta_pow, and writes the moments and param by funcs::JitAdam,
+// which also decays param by lr * lr_ratio * coeff if coeff is not 0.
+template <typename T, typename Context>
+void AdamCPUUpdate(const Context& dev_ctx,
+                   const DenseTensor& param,
+                   const DenseTensor& grad,
+                   const DenseTensor& learning_rate,
+                   const DenseTensor& moment1,
+                   const DenseTensor& moment2,
+                   const DenseTensor& beta1_pow,
+                   const DenseTensor& beta2_pow,
+                   const Scalar& beta1,
+                   const Scalar& beta2,
+                   const Scalar& epsilon,
+                   T lr_ratio,
+                   T coeff,
+                   bool use_global_beta_pow,
+                   DenseTensor* param_out,
+                   DenseTensor* moment1_out,
+                   DenseTensor* moment2_out,
+                   DenseTensor* beta1_pow_out,
+                   DenseTensor* beta2_pow_out) {
+  T beta1_ = beta1.to<T>();
+  T beta2_ = beta2.to<T>();
+  T epsilon_ = epsilon.to<T>();
+
+  VLOG(3) << "beta1_pow.numel() : " << beta1_pow.numel();
+  VLOG(3) << "beta2_pow.numel() : " << beta2_pow.numel();
+  VLOG(3) << "param.numel(): " << param.numel();
+
+  PADDLE_ENFORCE_EQ(
+      beta1_pow_out->numel(),
+      1,
+      errors::InvalidArgument("beta1 pow output size should be 1, but received "
+                              "value is:%d.",
+                              beta1_pow_out->numel()));
+
+  PADDLE_ENFORCE_EQ(
+      beta2_pow_out->numel(),
+      1,
+      errors::InvalidArgument("beta2 pow output size should be 1, but received "
+                              "value is:%d.",
+                              beta2_pow_out->numel()));
+
+  T beta1_p = beta1_pow.data<T>()[0];
+  T beta2_p = beta2_pow.data<T>()[0];
+
+  if (!use_global_beta_pow) {
+    dev_ctx.template Alloc<T>(beta1_pow_out)[0] = beta1_ * beta1_p;
+    dev_ctx.template Alloc<T>(beta2_pow_out)[0] = beta2_ * beta2_p;
+  }
+
+  T* param_out_ptr = dev_ctx.template Alloc<T>(param_out);
+  T* mom1_out_ptr = dev_ctx.template Alloc<T>(moment1_out);
+  T* mom2_out_ptr = dev_ctx.template Alloc<T>(moment2_out);
+
+  T old_lr = learning_rate.data<T>()[0];
+  T learning_rate_ = old_lr * (sqrt(1 - beta2_p) / (1 - beta1_p));
+  T eps = epsilon_ * sqrt(1 - beta2_p);
+
+  funcs::JitAdam(dev_ctx,
+                 beta1_,
+                 beta2_,
+                 learning_rate_,
+                 eps,
+                 old_lr,
+                 lr_ratio,
+                 coeff,
+                 param.numel(),
+                 grad.data<T>(),
+                 moment1.data<T>(),
+                 moment2.data<T>(),
+                 param.data<T>(),
+                 mom1_out_ptr,
+                 mom2_out_ptr,
+                 param_out_ptr);
+}
+
+}  // namespace phi
@@ -21,6 +21,7 @@
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/adam_kernel.h"
+#include "paddle/phi/kernels/cpu/adam_kernel_impl.h"
 #include "paddle/phi/kernels/funcs/adam_functors.h"
 
 namespace phi {
@@ -92,41 +93,40 @@ void AdamwDenseKernel(const Context& dev_ctx,
     return;
   }
 
-  auto* param_ =
-      master_param.is_initialized() ? master_param.get_ptr() : &param;
   T coeff_ = static_cast<T>(coeff);
   T lr_ratio_ = static_cast<T>(lr_ratio);
 
-  funcs::AdamWFunctor<T, funcs::CPUAdamW> functor(
-      coeff_,
-      lr_ratio_,
-      learning_rate.data<T>(),
-      const_cast<T*>(param_->data<T>()));
-  functor(param_->numel());
+  if (master_param.is_initialized()) {
+    // The master weights are decayed in place, and param by adam alone.
+    funcs::AdamWFunctor<T, funcs::CPUAdamW> functor(
+        coeff_,
+        lr_ratio_,
+        learning_rate.data<T>(),
+        const_cast<T*>(master_param->data<T>()));
+    functor(master_param->numel());
+    coeff_ = static_cast<T>(0);
+  }
 
-  AdamDenseKernel<T, Context>(dev_ctx,
-                              param,
-                              grad,
-                              learning_rate,
-                              moment1,
-                              moment2,
-                              beta1_pow,
-                              beta2_pow,
-                              master_param,
-                              skip_update,
-                              beta1,
-                              beta2,
-                              epsilon,
-                              lazy_mode,
-                              min_row_size_to_use_multithread,
-                              multi_precision,
-                              use_global_beta_pow,
-                              param_out,
-                              moment1_out,
-                              moment2_out,
-                              beta1_pow_out,
-                              beta2_pow_out,
-                              master_param_outs);
+  // The decay of param and the update of adam in one pass.
+  AdamCPUUpdate<T, Context>(dev_ctx,
+                            param,
+                            grad,
+                            learning_rate,
+                            moment1,
+                            moment2,
+                            beta1_pow,
+                            beta2_pow,
+                            beta1,
+                            beta2,
+                            epsilon,
+                            lr_ratio_,
+                            coeff_,
+                            use_global_beta_pow,
+                            param_out,
+                            moment1_out,
+                            moment2_out,
+                            beta1_pow_out,
+                            beta2_pow_out);
 }
 
 }  // namespace phi
@@ -18,6 +18,8 @@ limitations under the License. */
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/broadcast_function.h"
 #include "paddle/phi/kernels/funcs/common_shape.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
 
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
@@ -189,6 +191,45 @@ struct SameDimsMultiplyFunctor<
   }
 };
 
+// bfloat16 is converted to float a block at a time, where Eigen would
+// convert each element.
+template <typename Functor>
+void SameDimsComputeAsFloat(const CPUContext& dev_ctx,
+                            const DenseTensor& x,
+                            const DenseTensor& y,
+                            DenseTensor* z) {
+  using T = phi::dtype::bfloat16;
+  funcs::TransformAsFloat(dev_ctx,
+                          x.data<T>(),
+                          y.data<T>(),
+                          x.numel(),
+                          dev_ctx.template Alloc<T>(z),
+                          [](float* a, const float* b, int64_t n) {
+                            Functor functor;
+                            for (int64_t i = 0; i < n; ++i) {
+                              a[i] = functor(a[i], b[i]);
+                            }
+                          });
+}
+
+#define DEFINE_SAME_DIMS_BF16_FUNCTOR(name)                                   \
+  template <typename DevCtx>                                                  \
+  struct SameDims##name##Functor<DevCtx, phi::dtype::bfloat16> {              \
+    void operator()(const DevCtx& dev_ctx,                                    \
+                    const DenseTensor& x,                                     \
+                    const DenseTensor& y,                                     \
+                    DenseTensor* z) {                                         \
+      SameDimsComputeAsFloat<funcs::name##Functor<float>>(dev_ctx, x, y, z); \
+    }                                                                         \
+  };
+
+DEFINE_SAME_DIMS_BF16_FUNCTOR(Add)
+DEFINE_SAME_DIMS_BF16_FUNCTOR(Subtract)
+DEFINE_SAME_DIMS_BF16_FUNCTOR(Multiply)
+DEFINE_SAME_DIMS_BF16_FUNCTOR(Divide)
+
+#undef DEFINE_SAME_DIMS_BF16_FUNCTOR
+
 template <typename Functor>
 struct SameDimsElementwiseCompute {
   void operator()(const CPUContext& dev_ctx,
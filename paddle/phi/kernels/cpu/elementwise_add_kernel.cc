@@ -52,7 +52,8 @@ PD_REGISTER_KERNEL(add_raw,
                    int,
                    int64_t,
                    complex64,
-                   complex128) {}
+                   complex128,
+                   phi::dtype::bfloat16) {}
 
 PD_REGISTER_KERNEL(add,
                    CPU,
@@ -64,4 +65,5 @@ PD_REGISTER_KERNEL(add,
                    int,
                    int64_t,
                    complex64,
-                   complex128) {}
+                   complex128,
+                   phi::dtype::bfloat16) {}
@@ -13,7 +13,7 @@
 // limitations under the License.
 
 #include "paddle/phi/kernels/embedding_kernel.h"
-#include "paddle/phi/kernels/funcs/embedding_util.h"
+#include "paddle/phi/kernels/funcs/cpu_embedding_pool.h"
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/common/data_type.h"
@@ -37,44 +37,15 @@ struct EmbeddingCPUFunctor {
 
   template <typename IdT>
   void apply() {
-    auto ids = CopyIdsToVector<IdT, int64_t>(input_);
-    auto ids_numel = static_cast<int64_t>(ids.size());
-
-    int64_t row_number = weight_.dims()[0];
-    int64_t row_width = weight_.dims()[1];
-
-    auto* table = weight_.data<T>();
-
     dev_ctx_.template Alloc<T>(out_);
-    auto* output = out_->data<T>();
-
-    for (int64_t i = 0; i < ids_numel; ++i) {
-      if (padding_idx_ != kNoPadding && ids[i] == padding_idx_) {
-        memset(output + i * row_width, 0, row_width * sizeof(T));
-      } else {
-        PADDLE_ENFORCE_LT(
-            ids[i],
-            row_number,
-            phi::errors::InvalidArgument(
-                "Variable value (input) of OP(fluid.layers.embedding) "
-                "expected >= 0 and < %ld, but got %ld. Please check input "
-                "value.",
-                row_number,
-                ids[i]));
-        PADDLE_ENFORCE_GE(
-            ids[i],
-            0,
-            phi::errors::InvalidArgument(
-                "Variable value (input) of OP(fluid.layers.embedding) "
-                "expected >= 0 and < %ld, but got %ld. Please check input "
-                "value.",
-                row_number,
-                ids[i]));
-        memcpy(output + i * row_width,
-               table + ids[i] * row_width,
-               row_width * sizeof(T));
-      }
-    }
+    funcs::EmbeddingLookup(dev_ctx_,
+                           weight_.data<T>(),
+                           weight_.dims()[0],
+                           weight_.dims()[1],
+                           input_.data<IdT>(),
+                           input_.numel(),
+                           padding_idx_,
+                           out_->data<T>());
   }
 
  private:
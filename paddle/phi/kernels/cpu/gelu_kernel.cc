@@ -19,6 +19,7 @@
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/blas/blas_impl.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 
@@ -97,6 +98,59 @@ void GeluKernel(const Context& dev_ctx,
   functor(dev, eigen_x, eigen_out, approximate);
 }
 
+namespace {
+
+// bfloat16 and float16 are converted to float a block at a time, where the
+// functor would convert each element.
+template <typename T>
+void LowPrecisionGelu(const CPUContext& dev_ctx,
+                      const DenseTensor& x,
+                      bool approximate,
+                      DenseTensor* out) {
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  funcs::TransformAsFloat(
+      dev_ctx,
+      x.data<T>(),
+      x.numel(),
+      out_data,
+      [approximate](float* block, int64_t n) {
+        EigenVector<float>::Type v(block, n);
+        if (approximate) {
+          auto temp = (static_cast<float>(M_2_SQRTPI * M_SQRT1_2) *
+                       (v + static_cast<float>(GELU_CONSTANT) * v.cube()))
+                          .tanh();
+          v = v * 0.5f * (1.f + temp);
+        } else {
+          v = v * 0.5f * (1.f + (v * static_cast<float>(M_SQRT1_2)).erf());
+        }
+      });
+}
+
+}  // namespace
+
+template <>
+void GeluKernel<dtype::bfloat16, CPUContext>(const CPUContext& dev_ctx,
+                                             const DenseTensor& x,
+                                             bool approximate,
+                                             DenseTensor* out) {
+  LowPrecisionGelu<dtype::bfloat16>(dev_ctx, x, approximate, out);
+}
+
+template <>
+void GeluKernel<dtype::float16, CPUContext>(const CPUContext& dev_ctx,
+                                            const DenseTensor& x,
+                                            bool approximate,
+                                            DenseTensor* out) {
+  LowPrecisionGelu<dtype::float16>(dev_ctx, x, approximate, out);
+}
+
 }  // namespace phi
 
-PD_REGISTER_KERNEL(gelu, CPU, ALL_LAYOUT, phi::GeluKernel, float, double) {}
+PD_REGISTER_KERNEL(gelu,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::GeluKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16,
+                   phi::dtype::float16) {}
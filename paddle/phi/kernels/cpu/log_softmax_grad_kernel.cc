@@ -17,6 +17,7 @@
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/axis_utils.h"
+#include "paddle/phi/kernels/funcs/cpu_row_kernels.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 
@@ -72,10 +73,21 @@ void LogSoftmaxGradKernel(const Context& dev_ctx,
   const int canonical_axis = funcs::CanonicalAxis(axis, rank);
 
   dev_ctx.template Alloc<T>(x_grad);
-  if (out.numel() != 0) {
-    LogSoftmaxGradFunctor<Context, T>()(
-        dev_ctx, &out, &out_grad, x_grad, canonical_axis);
+  if (out.numel() == 0) {
+    return;
   }
+  const int d = funcs::SizeFromAxis(canonical_axis, out.dims());
+  if (d == out.dims()[canonical_axis]) {
+    funcs::LogSoftmaxGradRows<T>(dev_ctx,
+                                 out.data<T>(),
+                                 out_grad.data<T>(),
+                                 x_grad->data<T>(),
+                                 funcs::SizeToAxis(canonical_axis, out.dims()),
+                                 d);
+    return;
+  }
+  LogSoftmaxGradFunctor<Context, T>()(
+      dev_ctx, &out, &out_grad, x_grad, canonical_axis);
 }
 
 }  // namespace phi
@@ -17,6 +17,7 @@
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/axis_utils.h"
+#include "paddle/phi/kernels/funcs/cpu_row_kernels.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 
@@ -112,9 +113,20 @@ void LogSoftmaxKernel(const Context& dev_ctx,
   const int canonical_axis = funcs::CanonicalAxis(axis, rank);
 
   dev_ctx.template Alloc<T>(out);
-  if (x.numel() != 0) {
-    LogSoftmaxFunctor<Context, T>()(dev_ctx, &x, out, canonical_axis);
+  if (x.numel() == 0) {
+    return;
   }
+  const int d = funcs::SizeFromAxis(canonical_axis, x.dims());
+  if (d == x.dims()[canonical_axis]) {
+    // log_softmax along the innermost axis, one row at a time.
+    funcs::LogSoftmaxRows<T>(dev_ctx,
+                             x.data<T>(),
+                             out->data<T>(),
+                             funcs::SizeToAxis(canonical_axis, x.dims()),
+                             d);
+    return;
+  }
+  LogSoftmaxFunctor<Context, T>()(dev_ctx, &x, out, canonical_axis);
 }
 
 }  // namespace phi
@@ -18,14 +18,110 @@ limitations under the License. */
 #include "paddle/phi/core/kernel_registry.h"
 
 #include "paddle/phi/common/complex.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
 #include "paddle/phi/kernels/impl/matmul_kernel_impl.h"
 
+namespace phi {
+
+namespace {
+
+// The matmul of bfloat16 and float16 computes the GEMMs of a 2-D y, and of
+// batches of the same dims, by LowPrecisionGemm, which accumulates them in
+// float. The other broadcasts run through the float kernel.
+template <typename T>
+void LowPrecisionMatmul(const CPUContext& dev_ctx,
+                        const DenseTensor& x,
+                        const DenseTensor& y,
+                        bool transpose_x,
+                        bool transpose_y,
+                        DenseTensor* out) {
+  PADDLE_ENFORCE_NE(
+      phi::product(x.dims()),
+      0,
+      phi::errors::InvalidArgument("The Input(X) dims size must not be equal 0,"
+                                   " but reviced dims size is 0. "));
+  PADDLE_ENFORCE_NE(
+      phi::product(y.dims()),
+      0,
+      phi::errors::InvalidArgument("The Input(Y) dims size must not be equal 0,"
+                                   " but reviced dims size is 0. "));
+  const auto& x_dims = x.dims();
+  const auto& y_dims = y.dims();
+  const int x_rank = x_dims.size();
+  const int y_rank = y_dims.size();
+  bool same_batch = x_rank == y_rank && x_rank >= 2;
+  for (int i = 0; same_batch && i < x_rank - 2; ++i) {
+    same_batch = x_dims[i] == y_dims[i];
+  }
+  // A 2-D y takes the rows of x as one matrix, unless they are transposed.
+  const bool flatten_x = y_rank == 2 && x_rank >= 2 && !transpose_x;
+  if (!same_batch && !flatten_x) {
+    DenseTensor x_float = funcs::ToFloat(dev_ctx, x);
+    DenseTensor y_float = funcs::ToFloat(dev_ctx, y);
+    DenseTensor out_float;
+    out_float.Resize(out->dims());
+    MatmulKernel<float, CPUContext>(
+        dev_ctx, x_float, y_float, transpose_x, transpose_y, &out_float);
+    out->Resize(out_float.dims());
+    funcs::FromFloat<T>(dev_ctx, out_float, out);
+    return;
+  }
+
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  const int64_t K = transpose_y ? y_dims[y_rank - 1] : y_dims[y_rank - 2];
+  const int64_t N = transpose_y ? y_dims[y_rank - 2] : y_dims[y_rank - 1];
+  const int64_t batch_size =
+      flatten_x ? 1 : x.numel() / (x_dims[x_rank - 1] * x_dims[x_rank - 2]);
+  const int64_t M = x.numel() / batch_size / K;
+  for (int64_t b = 0; b < batch_size; ++b) {
+    funcs::LowPrecisionGemm<T>(dev_ctx,
+                               transpose_x,
+                               transpose_y,
+                               M,
+                               N,
+                               K,
+                               1.f,
+                               x.data<T>() + b * M * K,
+                               y.data<T>() + b * K * N,
+                               0.f,
+                               out_data + b * M * N);
+  }
+}
+
+}  // namespace
+
+template <>
+void MatmulKernel<dtype::bfloat16, CPUContext>(const CPUContext& dev_ctx,
+                                               const DenseTensor& x,
+                                               const DenseTensor& y,
+                                               bool transpose_x,
+                                               bool transpose_y,
+                                               DenseTensor* out) {
+  LowPrecisionMatmul<dtype::bfloat16>(
+      dev_ctx, x, y, transpose_x, transpose_y, out);
+}
+
+template <>
+void MatmulKernel<dtype::float16, CPUContext>(const CPUContext& dev_ctx,
+                                              const DenseTensor& x,
+                                              const DenseTensor& y,
+                                              bool transpose_x,
+                                              bool transpose_y,
+                                              DenseTensor* out) {
+  LowPrecisionMatmul<dtype::float16>(
+      dev_ctx, x, y, transpose_x, transpose_y, out);
+}
+
+}  // namespace phi
+
 PD_REGISTER_KERNEL(matmul,
                    CPU,
                    ALL_LAYOUT,
                    phi::MatmulKernel,
                    float,
                    double,
+                   phi::dtype::bfloat16,
+                   phi::dtype::float16,
                    phi::dtype::complex<float>,
                    phi::dtype::complex<double>) {}
 
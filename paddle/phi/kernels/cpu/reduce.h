@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <set>
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
@@ -149,6 +150,65 @@ void HandleLargeDim(const DeviceContext& dev_ctx,
   output->ResizeAndAllocate(output_dim);
 }
 
+////////////// ReduceLastDimsInParallel
+
+template <typename OutT, typename Functor, typename DeviceContext>
+bool ReduceLastDimsInParallel(const DeviceContext& dev_ctx,
+                              const phi::DenseTensor& input,
+                              phi::DenseTensor* output,
+                              const std::vector<int64_t>& dims) {
+  return false;
+}
+
+// When the reduced dims are the last ones, the input is a 2D tensor whose
+// shape is {unreduced, reduced}, and the rows are reduced in parallel.
+// Returns false for the other dims.
+template <typename OutT, typename Functor>
+bool ReduceLastDimsInParallel(const CPUContext& dev_ctx,
+                              const phi::DenseTensor& input,
+                              phi::DenseTensor* output,
+                              const std::vector<int64_t>& dims) {
+  if (GetIntraOpNumThreads() <= 1) {
+    return false;
+  }
+  const int ndim = input.dims().size();
+  std::vector<int64_t> sorted_dims;
+  for (auto dim : dims) {
+    sorted_dims.push_back(dim < 0 ? dim + ndim : dim);
+  }
+  std::sort(sorted_dims.begin(), sorted_dims.end());
+  sorted_dims.erase(std::unique(sorted_dims.begin(), sorted_dims.end()),
+                    sorted_dims.end());
+  const int first_reduced = ndim - static_cast<int>(sorted_dims.size());
+  int64_t reduced = 1;
+  for (size_t i = 0; i < sorted_dims.size(); ++i) {
+    if (sorted_dims[i] != first_reduced + static_cast<int64_t>(i)) {
+      return false;
+    }
+    reduced *= input.dims()[sorted_dims[i]];
+  }
+  if (reduced == 0 || input.numel() / reduced < 2) {
+    return false;
+  }
+  const int64_t unreduced = input.numel() / reduced;
+
+  const OutT* x_data = input.data<OutT>();
+  OutT* out_data = output->data<OutT>();
+  auto& place = *dev_ctx.eigen_device();
+  auto reduce_dim = Eigen::array<int, 1>({{1}});
+  int64_t grain_size = std::max<int64_t>(1, 32768 / reduced);
+  dev_ctx.ParallelFor(
+      0, unreduced, grain_size, [&](int64_t begin, int64_t end) {
+        typename EigenTensor<OutT, 2>::ConstType x(
+            x_data + begin * reduced, end - begin, reduced);
+        typename EigenTensor<OutT, 1>::Type out(out_data + begin,
+                                               end - begin);
+        Functor functor;
+        functor(place, &x, &out, reduce_dim);
+      });
+  return true;
+}
+
 ////////////// ReduceKernel
 
 template <typename DeviceContext, typename T, typename OutT, typename Functor>
@@ -169,7 +229,8 @@ void ReduceKernelImpl(const DeviceContext& dev_ctx,
 
     Functor functor;
     functor(dev, &x, &out, reduce_dim);
-  } else {
+  } else if (!ReduceLastDimsInParallel<OutT, Functor>(
+                 dev_ctx, input, output, dims)) {
     int ndim = input.dims().size();
     int rdim = dims.size();
     if (ndim > 6) {
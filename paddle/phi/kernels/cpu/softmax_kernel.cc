@@ -14,9 +14,97 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/softmax_kernel.h"
 
+#include "paddle/fluid/operators/math/softmax.h"
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
-#include "paddle/phi/kernels/impl/softmax_kernel_impl.h"
+#include "paddle/phi/kernels/funcs/axis_utils.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+#include "paddle/phi/kernels/funcs/cpu_row_kernels.h"
 
-PD_REGISTER_KERNEL(
-    softmax, CPU, ALL_LAYOUT, phi::SoftmaxKernel, float, double) {}
+namespace phi {
+
+template <typename T, typename Context>
+void SoftmaxKernel(const Context& dev_ctx,
+                   const DenseTensor& x,
+                   int axis,
+                   DenseTensor* out) {
+  const int rank = x.dims().size();
+  const int calc_axis = phi::funcs::CanonicalAxis(axis, rank);
+  int axis_dim = x.dims()[calc_axis];
+
+  // allocate memory on device.
+  dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) {
+    return;
+  }
+
+  const int n = phi::funcs::SizeToAxis(calc_axis, x.dims());
+  const int d = phi::funcs::SizeFromAxis(calc_axis, x.dims());
+  if (d == axis_dim) {
+    // softmax along the innermost axis, one row at a time.
+    funcs::SoftmaxRows<T>(dev_ctx, x.data<T>(), out->data<T>(), n, d);
+    return;
+  }
+  DenseTensor X_2d, Out_2d;
+  X_2d.ShareDataWith(x).Resize({n, d});
+  Out_2d.ShareDataWith(*out).Resize({n, d});
+  paddle::operators::math::SoftmaxFunctor<Context, T, false>()(
+      dev_ctx, axis_dim, &X_2d, &Out_2d);
+}
+
+namespace {
+
+// bfloat16 and float16 run the softmax along the innermost axis in float a
+// row at a time, and the other axes by the float kernel.
+template <typename T>
+void LowPrecisionSoftmax(const CPUContext& dev_ctx,
+                         const DenseTensor& x,
+                         int axis,
+                         DenseTensor* out) {
+  const int rank = x.dims().size();
+  const int calc_axis = phi::funcs::CanonicalAxis(axis, rank);
+  dev_ctx.template Alloc<T>(out);
+  if (out->numel() == 0) {
+    return;
+  }
+  const int n = phi::funcs::SizeToAxis(calc_axis, x.dims());
+  const int d = phi::funcs::SizeFromAxis(calc_axis, x.dims());
+  if (d == x.dims()[calc_axis]) {
+    funcs::SoftmaxRows<T>(dev_ctx, x.data<T>(), out->data<T>(), n, d);
+    return;
+  }
+  DenseTensor x_float = funcs::ToFloat(dev_ctx, x);
+  DenseTensor out_float;
+  out_float.Resize(out->dims());
+  SoftmaxKernel<float, CPUContext>(dev_ctx, x_float, axis, &out_float);
+  funcs::FromFloat<T>(dev_ctx, out_float, out);
+}
+
+}  // namespace
+
+template <>
+void SoftmaxKernel<dtype::bfloat16, CPUContext>(const CPUContext& dev_ctx,
+                                                const DenseTensor& x,
+                                                int axis,
+                                                DenseTensor* out) {
+  LowPrecisionSoftmax<dtype::bfloat16>(dev_ctx, x, axis, out);
+}
+
+template <>
+void SoftmaxKernel<dtype::float16, CPUContext>(const CPUContext& dev_ctx,
+                                               const DenseTensor& x,
+                                               int axis,
+                                               DenseTensor* out) {
+  LowPrecisionSoftmax<dtype::float16>(dev_ctx, x, axis, out);
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(softmax,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SoftmaxKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16,
+                   phi::dtype::float16) {}
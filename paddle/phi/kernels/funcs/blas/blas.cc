@@ -14,6 +14,8 @@
 
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 
+#include <algorithm>
+
 namespace phi {
 namespace funcs {
 MatDescriptor CreateMatrixDescriptor(const DDim &tensor_dim,
@@ -51,5 +53,65 @@ MatDescriptor CreateMatrixDescriptor(const DDim &tensor_dim,
   retv.trans_ = trans;
   return retv;
 }
+
+namespace {
+
+#ifdef PADDLE_USE_OPENBLAS
+// The threads of OpenBLAS are shared by the process, so they are set once
+// around the loop.
+class OpenBlasSingleThreadGuard {
+ public:
+  OpenBlasSingleThreadGuard() : num_threads_(openblas_get_num_threads()) {
+    openblas_set_num_threads(1);
+  }
+  ~OpenBlasSingleThreadGuard() { openblas_set_num_threads(num_threads_); }
+
+ private:
+  int num_threads_;
+};
+#endif
+
+#ifdef PADDLE_WITH_MKLML
+// MKL keeps the threads of each thread, so they are set in each chunk.
+class MklSingleThreadGuard {
+ public:
+  MklSingleThreadGuard()
+      : num_threads_(
+            paddle::platform::dynload::MKL_Set_Num_Threads_Local(1)) {}
+  ~MklSingleThreadGuard() {
+    paddle::platform::dynload::MKL_Set_Num_Threads_Local(num_threads_);
+  }
+
+ private:
+  int num_threads_;
+};
+#endif
+
+}  // namespace
+
+void BlasParallelFor(const CPUContext &dev_ctx,
+                     int64_t begin,
+                     int64_t end,
+                     int64_t grain_size,
+                     const std::function<void(int64_t, int64_t)> &func) {
+  if (begin >= end) {
+    return;
+  }
+  grain_size = std::max<int64_t>(grain_size, 1);
+  const int64_t num_grains = (end - begin + grain_size - 1) / grain_size;
+  if (num_grains < GetIntraOpNumThreads()) {
+    func(begin, end);
+    return;
+  }
+#ifdef PADDLE_USE_OPENBLAS
+  OpenBlasSingleThreadGuard openblas_guard;
+#endif
+  dev_ctx.ParallelFor(begin, end, grain_size, [&](int64_t first, int64_t last) {
+#ifdef PADDLE_WITH_MKLML
+    MklSingleThreadGuard mkl_guard;
+#endif
+    func(first, last);
+  });
+}
 }  // namespace funcs
 }  // namespace phi
@@ -14,7 +14,10 @@
 
 #pragma once
 
+#include <functional>
+
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/core/dense_tensor.h"
 
 #ifdef PADDLE_WITH_MKLML
@@ -77,6 +80,22 @@ extern MatDescriptor CreateMatrixDescriptor(const DDim& tensor_dim,
                                             int num_flatten_cols,
                                             bool trans);
 
+/**
+ * Runs func(chunk_begin, chunk_end) for the chunks of [begin, end), like
+ * CPUContext::ParallelFor, where func calls the CPU blas.
+ *
+ * The loop is parallelized at one level only: if [begin, end) has as many
+ * chunks of grain_size as the threads of the loop, the chunks run in
+ * parallel, each calling a single threaded blas, and otherwise func runs
+ * once on the calling thread, whose blas uses the threads of the math
+ * library. Without it, each chunk would start as many blas threads again.
+ */
+void BlasParallelFor(const CPUContext& dev_ctx,
+                     int64_t begin,
+                     int64_t end,
+                     int64_t grain_size,
+                     const std::function<void(int64_t, int64_t)>& func);
+
 template <typename DeviceContext>
 class Blas {
  public:
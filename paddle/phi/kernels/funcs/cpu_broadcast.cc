@@ -0,0 +1,103 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+
+namespace phi {
+namespace funcs {
+
+namespace jit = paddle::operators::jit;
+
+int64_t CpuBroadcastJitLoop::Run(const float* x,
+                                 const float* y,
+                                 float* z,
+                                 int64_t n,
+                                 bool x_full,
+                                 bool y_full) const {
+  const int64_t done = n / kJitBlockSize * kJitBlockSize;
+  if (done == 0) {
+    return 0;
+  }
+  // The kernel of the op computes z = func(a, b), where a is a scalar if
+  // not a_full, and b is contiguous.
+  jit::VAddTuple<float>::func_type func = nullptr;
+  const float* a = x;
+  const float* b = y;
+  bool a_full = x_full && y_full;
+  bool fused_relu = false;
+  float scalar = 0.f;
+  switch (op_) {
+    case kAdd:
+      if (x_full && y_full) {
+        fused_relu = act_ == JitActivation::kRelu;
+        func = fused_relu ? GetJitFunc<jit::VAddReluTuple<float>>(kJitBlockSize)
+                          : GetJitFunc<jit::VAddTuple<float>>(kJitBlockSize);
+      } else if (x_full) {
+        func = GetJitFunc<jit::VAddBiasTuple<float>>(kJitBlockSize);
+        a = y;
+        b = x;
+      } else if (y_full) {
+        func = GetJitFunc<jit::VAddBiasTuple<float>>(kJitBlockSize);
+      }
+      break;
+    case kSubtract:
+      if (x_full && y_full) {
+        func = GetJitFunc<jit::VSubTuple<float>>(kJitBlockSize);
+      } else if (x_full) {
+        func = GetJitFunc<jit::VAddBiasTuple<float>>(kJitBlockSize);
+        scalar = -*y;
+        a = &scalar;
+        b = x;
+      }
+      break;
+    case kInverseSubtract:
+      // func(x, y) is y - x.
+      if (x_full && y_full) {
+        func = GetJitFunc<jit::VSubTuple<float>>(kJitBlockSize);
+        a = y;
+        b = x;
+      } else if (y_full) {
+        func = GetJitFunc<jit::VAddBiasTuple<float>>(kJitBlockSize);
+        scalar = -*x;
+        a = &scalar;
+      }
+      break;
+    case kMultiply:
+      if (x_full && y_full) {
+        func = GetJitFunc<jit::VMulTuple<float>>(kJitBlockSize);
+      } else if (x_full) {
+        func = GetJitFunc<jit::VScalTuple<float>>(kJitBlockSize);
+        a = y;
+        b = x;
+      } else if (y_full) {
+        func = GetJitFunc<jit::VScalTuple<float>>(kJitBlockSize);
+      }
+      break;
+    default:
+      break;
+  }
+  if (func == nullptr) {
+    return 0;
+  }
+  for (int64_t i = 0; i < done; i += kJitBlockSize) {
+    func(a_full ? a + i : a, b + i, z + i, kJitBlockSize);
+  }
+  if (act_ != JitActivation::kIdentity && !fused_relu) {
+    JitActivate(act_, z, z, static_cast<int>(done));
+  }
+  return done;
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,356 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/common_shape.h"
+#include "paddle/phi/kernels/funcs/cpu_jit.h"
+#include "paddle/phi/kernels/funcs/elementwise_functor.h"
+
+namespace phi {
+namespace funcs {
+
+// The shape of a binary op broadcast on CPU. Adjacent dims broadcast in the
+// same way are merged, and the dims of size 1 in the output are dropped, so
+// each dim is either full or broadcast in each input, and the strides of the
+// inputs are either 0 or contiguous.
+struct CpuBroadcastPlan {
+  std::vector<int64_t> out_dims;
+  std::vector<int64_t> x_strides;
+  std::vector<int64_t> y_strides;
+
+  int64_t numel() const {
+    int64_t numel = 1;
+    for (auto dim : out_dims) {
+      numel *= dim;
+    }
+    return numel;
+  }
+  int64_t inner() const { return out_dims.back(); }
+  bool x_inner_full() const { return x_strides.back() != 0; }
+  bool y_inner_full() const { return y_strides.back() != 0; }
+};
+
+// Makes the plan from the dims of x and y aligned to those of out, as
+// GetBroadcastDimsArrays returns them.
+inline CpuBroadcastPlan MakeCpuBroadcastPlan(const int* x_dims,
+                                             const int* y_dims,
+                                             const int* out_dims,
+                                             int ndim) {
+  CpuBroadcastPlan plan;
+  std::vector<bool> x_full;
+  std::vector<bool> y_full;
+  for (int i = 0; i < ndim; ++i) {
+    if (out_dims[i] == 1) {
+      continue;
+    }
+    bool x_is_full = x_dims[i] != 1;
+    bool y_is_full = y_dims[i] != 1;
+    if (!plan.out_dims.empty() && x_full.back() == x_is_full &&
+        y_full.back() == y_is_full) {
+      plan.out_dims.back() *= out_dims[i];
+      continue;
+    }
+    plan.out_dims.push_back(out_dims[i]);
+    x_full.push_back(x_is_full);
+    y_full.push_back(y_is_full);
+  }
+  if (plan.out_dims.empty()) {
+    plan.out_dims.push_back(1);
+    x_full.push_back(true);
+    y_full.push_back(true);
+  }
+
+  int merged_ndim = static_cast<int>(plan.out_dims.size());
+  plan.x_strides.resize(merged_ndim);
+  plan.y_strides.resize(merged_ndim);
+  int64_t x_stride = 1;
+  int64_t y_stride = 1;
+  for (int i = merged_ndim - 1; i >= 0; --i) {
+    plan.x_strides[i] = x_full[i] ? x_stride : 0;
+    plan.y_strides[i] = y_full[i] ? y_stride : 0;
+    x_stride *= x_full[i] ? plan.out_dims[i] : 1;
+    y_stride *= y_full[i] ? plan.out_dims[i] : 1;
+  }
+  return plan;
+}
+
+// The activations CpuBroadcastCompute can fuse into its output.
+struct BroadcastNoActivation {
+  template <typename T>
+  T operator()(const T value) const {
+    return value;
+  }
+};
+
+struct BroadcastReluActivation {
+  template <typename T>
+  T operator()(const T value) const {
+    return value > static_cast<T>(0) ? value : static_cast<T>(0);
+  }
+};
+
+struct BroadcastSigmoidActivation {
+  template <typename T>
+  T operator()(const T value) const {
+    return static_cast<T>(1) / (static_cast<T>(1) + std::exp(-value));
+  }
+};
+
+struct BroadcastTanhActivation {
+  template <typename T>
+  T operator()(const T value) const {
+    return std::tanh(value);
+  }
+};
+
+// The inner loops of float add, subtract and multiply, followed by an
+// activation, run by the jit kernels of funcs/cpu_jit.h.
+class CpuBroadcastJitLoop {
+ public:
+  enum Op { kNone, kAdd, kSubtract, kInverseSubtract, kMultiply };
+
+  CpuBroadcastJitLoop(Op op, JitActivation act) : op_(op), act_(act) {}
+
+  // Computes the leading elements of the n elements of z in blocks of
+  // kJitBlockSize, where x and y are either contiguous or a broadcast
+  // scalar. Returns the number of the elements computed, 0 if no jit kernel
+  // computes them, which leaves the tail to the loops of the compiler.
+  int64_t Run(const float* x,
+              const float* y,
+              float* z,
+              int64_t n,
+              bool x_full,
+              bool y_full) const;
+
+ private:
+  Op op_;
+  JitActivation act_;
+};
+
+template <typename Functor, typename T, typename OutType>
+struct CpuBroadcastJitOp {
+  static constexpr CpuBroadcastJitLoop::Op kOp = CpuBroadcastJitLoop::kNone;
+};
+
+#define DEFINE_CPU_BROADCAST_JIT_OP(functor, op)                            \
+  template <>                                                               \
+  struct CpuBroadcastJitOp<functor<float>, float, float> {                  \
+    static constexpr CpuBroadcastJitLoop::Op kOp = CpuBroadcastJitLoop::op; \
+  }
+
+DEFINE_CPU_BROADCAST_JIT_OP(AddFunctor, kAdd);
+DEFINE_CPU_BROADCAST_JIT_OP(InverseAddFunctor, kAdd);
+DEFINE_CPU_BROADCAST_JIT_OP(SubtractFunctor, kSubtract);
+DEFINE_CPU_BROADCAST_JIT_OP(InverseSubtractFunctor, kInverseSubtract);
+DEFINE_CPU_BROADCAST_JIT_OP(MultiplyFunctor, kMultiply);
+DEFINE_CPU_BROADCAST_JIT_OP(InverseMultiplyFunctor, kMultiply);
+
+#undef DEFINE_CPU_BROADCAST_JIT_OP
+
+template <typename Activation>
+struct CpuBroadcastJitActivation {
+  static constexpr bool kSupported = false;
+  static constexpr JitActivation kActivation = JitActivation::kIdentity;
+};
+
+#define DEFINE_CPU_BROADCAST_JIT_ACTIVATION(activation, act)         \
+  template <>                                                        \
+  struct CpuBroadcastJitActivation<activation> {                     \
+    static constexpr bool kSupported = true;                         \
+    static constexpr JitActivation kActivation = JitActivation::act; \
+  }
+
+DEFINE_CPU_BROADCAST_JIT_ACTIVATION(BroadcastNoActivation, kIdentity);
+DEFINE_CPU_BROADCAST_JIT_ACTIVATION(BroadcastReluActivation, kRelu);
+DEFINE_CPU_BROADCAST_JIT_ACTIVATION(BroadcastSigmoidActivation, kSigmoid);
+DEFINE_CPU_BROADCAST_JIT_ACTIVATION(BroadcastTanhActivation, kTanh);
+
+#undef DEFINE_CPU_BROADCAST_JIT_ACTIVATION
+
+// Computes the n elements of z, where x and y are either contiguous or a
+// broadcast scalar. The loops are simple enough for the compiler to
+// vectorize.
+template <typename T, typename OutType, typename Functor, typename Activation>
+inline void CpuBroadcastLoop(const T* x,
+                             const T* y,
+                             OutType* z,
+                             int64_t n,
+                             bool x_full,
+                             bool y_full,
+                             const Functor& func,
+                             const Activation& act) {
+  if (x_full && y_full) {
+    for (int64_t i = 0; i < n; ++i) {
+      z[i] = act(func(x[i], y[i]));
+    }
+  } else if (x_full) {
+    const T b = *y;
+    for (int64_t i = 0; i < n; ++i) {
+      z[i] = act(func(x[i], b));
+    }
+  } else if (y_full) {
+    const T a = *x;
+    for (int64_t i = 0; i < n; ++i) {
+      z[i] = act(func(a, y[i]));
+    }
+  } else {
+    const OutType value = act(func(*x, *y));
+    std::fill(z, z + n, value);
+  }
+}
+
+// The longest piece of a row run at once, so that long rows are split among
+// the threads too.
+constexpr int64_t kCpuBroadcastBlockSize = 16384;
+
+// Computes z = act(func(x, y)) for each element of the plan, in parallel on
+// the threads of dev_ctx over the blocks of the rows, i.e. of the last dim.
+template <typename T, typename OutType, typename Functor, typename Activation>
+void RunCpuBroadcastPlan(const CPUContext& dev_ctx,
+                         const CpuBroadcastPlan& plan,
+                         const T* x,
+                         const T* y,
+                         OutType* z,
+                         Functor func,
+                         Activation act) {
+  const int64_t inner = plan.inner();
+  if (inner == 0 || plan.numel() == 0) {
+    return;
+  }
+  const int64_t rows = plan.numel() / inner;
+  const int64_t block = std::min(inner, kCpuBroadcastBlockSize);
+  const int64_t blocks_per_row = (inner + block - 1) / block;
+  const int outer_ndim = static_cast<int>(plan.out_dims.size()) - 1;
+  const bool x_full = plan.x_inner_full();
+  const bool y_full = plan.y_inner_full();
+  constexpr auto kJitOp = CpuBroadcastJitOp<Functor, T, OutType>::kOp;
+  constexpr bool kUseJit = kJitOp != CpuBroadcastJitLoop::kNone &&
+                           CpuBroadcastJitActivation<Activation>::kSupported;
+  const CpuBroadcastJitLoop jit_loop(
+      kJitOp, CpuBroadcastJitActivation<Activation>::kActivation);
+
+  auto run_blocks = [&](int64_t begin, int64_t end) {
+    // The index of the row in the outer dims, and the offsets of its inputs.
+    std::vector<int64_t> index(outer_ndim, 0);
+    int64_t row = begin / blocks_per_row;
+    int64_t x_offset = 0;
+    int64_t y_offset = 0;
+    int64_t rest = row;
+    for (int d = outer_ndim - 1; d >= 0; --d) {
+      index[d] = rest % plan.out_dims[d];
+      rest /= plan.out_dims[d];
+      x_offset += index[d] * plan.x_strides[d];
+      y_offset += index[d] * plan.y_strides[d];
+    }
+    int64_t block_index = begin % blocks_per_row;
+    for (int64_t i = begin; i < end; ++i) {
+      int64_t col = block_index * block;
+      int64_t size = std::min(block, inner - col);
+      const T* x_begin = x + x_offset + (x_full ? col : 0);
+      const T* y_begin = y + y_offset + (y_full ? col : 0);
+      OutType* z_begin = z + row * inner + col;
+      int64_t done = 0;
+      if (kUseJit) {
+        done = jit_loop.Run(reinterpret_cast<const float*>(x_begin),
+                            reinterpret_cast<const float*>(y_begin),
+                            reinterpret_cast<float*>(z_begin),
+                            size,
+                            x_full,
+                            y_full);
+      }
+      if (done < size) {
+        CpuBroadcastLoop(x_begin + (x_full ? done : 0),
+                         y_begin + (y_full ? done : 0),
+                         z_begin + done,
+                         size - done,
+                         x_full,
+                         y_full,
+                         func,
+                         act);
+      }
+      if (++block_index < blocks_per_row) {
+        continue;
+      }
+      block_index = 0;
+      ++row;
+      for (int d = outer_ndim - 1; d >= 0; --d) {
+        x_offset += plan.x_strides[d];
+        y_offset += plan.y_strides[d];
+        if (++index[d] < plan.out_dims[d]) {
+          break;
+        }
+        x_offset -= plan.x_strides[d] * plan.out_dims[d];
+        y_offset -= plan.y_strides[d] * plan.out_dims[d];
+        index[d] = 0;
+      }
+    }
+  };
+  int64_t grain_size = std::max<int64_t>(1, 32768 / block);
+  dev_ctx.ParallelFor(0, rows * blocks_per_row, grain_size, run_blocks);
+}
+
+// Computes z = act(func(x, y)), where x and y are broadcast to the shape of
+// z. As in ElementwiseCompute, the dims of the input with fewer dims are
+// aligned to the dims of the other one from axis, or -1 to align the last
+// dims.
+template <typename Functor,
+          typename T,
+          typename OutType = T,
+          typename Activation = BroadcastNoActivation>
+void CpuBroadcastCompute(const CPUContext& dev_ctx,
+                         const DenseTensor& x,
+                         const DenseTensor& y,
+                         int axis,
+                         Functor func,
+                         DenseTensor* z,
+                         Activation act = Activation()) {
+  const auto& x_dims = x.dims();
+  const auto& y_dims = y.dims();
+  CpuBroadcastPlan plan;
+  if (x_dims == y_dims) {
+    plan.out_dims = {x.numel()};
+    plan.x_strides = {1};
+    plan.y_strides = {1};
+  } else {
+    int max_dim = std::max(x_dims.size(), y_dims.size());
+    axis = (axis == -1 ? std::abs(x_dims.size() - y_dims.size()) : axis);
+    std::vector<int> x_dims_array(max_dim);
+    std::vector<int> y_dims_array(max_dim);
+    std::vector<int> out_dims_array(max_dim);
+    GetBroadcastDimsArrays(x_dims,
+                           y_dims,
+                           x_dims_array.data(),
+                           y_dims_array.data(),
+                           out_dims_array.data(),
+                           max_dim,
+                           axis);
+    plan = MakeCpuBroadcastPlan(x_dims_array.data(),
+                                y_dims_array.data(),
+                                out_dims_array.data(),
+                                max_dim);
+  }
+  OutType* z_data = dev_ctx.Alloc<OutType>(z);
+  RunCpuBroadcastPlan(
+      dev_ctx, plan, x.data<T>(), y.data<T>(), z_data, func, act);
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,564 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The output pixels of a GEMM of the 1x1 convolution.
+constexpr int64_t kGemm1x1PixelBlock = 256;
+// The tiles transformed and multiplied together by the Winograd
+// convolution, which bounds its buffers.
+constexpr int64_t kWinogradTileBlock = 64;
+// The multiply-adds given to a thread at least.
+constexpr int64_t kConvGrainSize = 1 << 16;
+
+int64_t GrainSize(int64_t cost_per_unit) {
+  return std::max<int64_t>(
+      1, kConvGrainSize / std::max<int64_t>(cost_per_unit, 1));
+}
+
+int64_t DivUp(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+// The range [*begin, *end) of the output columns whose input column
+// out * stride - pad + offset is inside [0, size).
+void ValidOutputRange(int64_t size,
+                      int64_t out_size,
+                      int64_t stride,
+                      int64_t pad,
+                      int64_t offset,
+                      int64_t* begin,
+                      int64_t* end) {
+  int64_t shift = pad - offset;
+  *begin = shift > 0 ? DivUp(shift, stride) : 0;
+  *end = shift + size > 0 ? DivUp(shift + size, stride) : 0;
+  *begin = std::min(*begin, out_size);
+  *end = std::max(*begin, std::min(*end, out_size));
+}
+
+bool IsDepthwise(const Conv2dShape& shape) {
+  return shape.groups > 1 && shape.in_channels == shape.groups;
+}
+
+bool IsWinogradShape(const Conv2dShape& shape) {
+  return shape.groups == 1 && shape.kernel_h == 3 && shape.kernel_w == 3 &&
+         shape.stride_h == 1 && shape.stride_w == 1 &&
+         shape.dilation_h == 1 && shape.dilation_w == 1;
+}
+
+void Im2colGemm(const CPUContext& dev_ctx,
+                const Conv2dShape& s,
+                const float* input,
+                const float* filter,
+                float* output) {
+  const int64_t in_step = s.in_channels / s.groups;
+  const int64_t out_step = s.out_channels / s.groups;
+  const int64_t col_rows = in_step * s.kernel_h * s.kernel_w;
+  const int64_t out_size = s.out_h * s.out_w;
+  const int64_t in_size = s.in_h * s.in_w;
+  auto blas = GetBlas<CPUContext, float>(dev_ctx);
+  BlasParallelFor(
+      dev_ctx,
+      0,
+      s.batch * s.groups,
+      GrainSize(out_step * col_rows * out_size),
+      [&](int64_t begin, int64_t end) {
+        std::vector<float> col(col_rows * out_size);
+        for (int64_t unit = begin; unit < end; ++unit) {
+          int64_t n = unit / s.groups;
+          int64_t g = unit % s.groups;
+          const float* in =
+              input + (n * s.in_channels + g * in_step) * in_size;
+          for (int64_t row = 0; row < col_rows; ++row) {
+            int64_t c = row / (s.kernel_h * s.kernel_w);
+            int64_t kh = row / s.kernel_w % s.kernel_h;
+            int64_t kw = row % s.kernel_w;
+            float* col_row = col.data() + row * out_size;
+            std::fill(col_row, col_row + out_size, 0.f);
+            int64_t w_begin, w_end;
+            ValidOutputRange(s.in_w,
+                             s.out_w,
+                             s.stride_w,
+                             s.pad_left,
+                             kw * s.dilation_w,
+                             &w_begin,
+                             &w_end);
+            for (int64_t oh = 0; oh < s.out_h; ++oh) {
+              int64_t ih = oh * s.stride_h - s.pad_top + kh * s.dilation_h;
+              if (ih < 0 || ih >= s.in_h) {
+                continue;
+              }
+              const float* in_row = in + (c * s.in_h + ih) * s.in_w;
+              float* col_out = col_row + oh * s.out_w;
+              for (int64_t ow = w_begin; ow < w_end; ++ow) {
+                col_out[ow] =
+                    in_row[ow * s.stride_w - s.pad_left + kw * s.dilation_w];
+              }
+            }
+          }
+          blas.GEMM(false,
+                    false,
+                    out_step,
+                    out_size,
+                    col_rows,
+                    1.f,
+                    filter + g * out_step * col_rows,
+                    col_rows,
+                    col.data(),
+                    out_size,
+                    0.f,
+                    output + (n * s.out_channels + g * out_step) * out_size,
+                    out_size);
+        }
+      });
+}
+
+void Gemm1x1(const CPUContext& dev_ctx,
+             const Conv2dShape& s,
+             const float* input,
+             const float* filter,
+             float* output) {
+  const int64_t in_size = s.in_h * s.in_w;
+  const int64_t out_size = s.out_h * s.out_w;
+  const int64_t blocks = DivUp(out_size, kGemm1x1PixelBlock);
+  const bool strided = s.stride_h != 1 || s.stride_w != 1;
+  auto blas = GetBlas<CPUContext, float>(dev_ctx);
+  BlasParallelFor(
+      dev_ctx,
+      0,
+      s.batch * blocks,
+      GrainSize(s.out_channels * s.in_channels * kGemm1x1PixelBlock),
+      [&](int64_t begin, int64_t end) {
+        std::vector<float> gathered;
+        if (strided) {
+          gathered.resize(s.in_channels * kGemm1x1PixelBlock);
+        }
+        for (int64_t unit = begin; unit < end; ++unit) {
+          int64_t n = unit / blocks;
+          int64_t pixel = unit % blocks * kGemm1x1PixelBlock;
+          int64_t pixels = std::min(kGemm1x1PixelBlock, out_size - pixel);
+          const float* in = input + n * s.in_channels * in_size;
+          const float* b = in + pixel;
+          int64_t ldb = in_size;
+          if (strided) {
+            // Gathers the input pixels of the block, channel by channel.
+            for (int64_t c = 0; c < s.in_channels; ++c) {
+              const float* in_channel = in + c * in_size;
+              float* to = gathered.data() + c * pixels;
+              for (int64_t i = 0; i < pixels; ++i) {
+                int64_t oh = (pixel + i) / s.out_w;
+                int64_t ow = (pixel + i) % s.out_w;
+                to[i] = in_channel[oh * s.stride_h * s.in_w + ow * s.stride_w];
+              }
+            }
+            b = gathered.data();
+            ldb = pixels;
+          }
+          blas.GEMM(false,
+                    false,
+                    s.out_channels,
+                    pixels,
+                    s.in_channels,
+                    1.f,
+                    filter,
+                    s.in_channels,
+                    b,
+                    ldb,
+                    0.f,
+                    output + n * s.out_channels * out_size + pixel,
+                    out_size);
+        }
+      });
+}
+
+// The direct convolution of in_channels == groups, i.e. depthwise, one row
+// of output pixels at a time.
+void DirectDepthwise(const CPUContext& dev_ctx,
+                     const Conv2dShape& s,
+                     const float* input,
+                     const float* filter,
+                     float* output) {
+  const int64_t multiplier = s.out_channels / s.groups;
+  const int64_t kernel_size = s.kernel_h * s.kernel_w;
+  const int64_t in_size = s.in_h * s.in_w;
+  dev_ctx.ParallelFor(
+      0,
+      s.batch * s.out_channels * s.out_h,
+      GrainSize(kernel_size * s.out_w),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t unit = begin; unit < end; ++unit) {
+          int64_t oh = unit % s.out_h;
+          int64_t o = unit / s.out_h % s.out_channels;
+          int64_t n = unit / s.out_h / s.out_channels;
+          const float* in =
+              input + (n * s.in_channels + o / multiplier) * in_size;
+          const float* w = filter + o * kernel_size;
+          float* out = output + unit * s.out_w;
+          std::fill(out, out + s.out_w, 0.f);
+          for (int64_t kh = 0; kh < s.kernel_h; ++kh) {
+            int64_t ih = oh * s.stride_h - s.pad_top + kh * s.dilation_h;
+            if (ih < 0 || ih >= s.in_h) {
+              continue;
+            }
+            const float* in_row = in + ih * s.in_w;
+            for (int64_t kw = 0; kw < s.kernel_w; ++kw) {
+              int64_t w_begin, w_end;
+              int64_t offset = kw * s.dilation_w - s.pad_left;
+              ValidOutputRange(s.in_w,
+                               s.out_w,
+                               s.stride_w,
+                               s.pad_left,
+                               kw * s.dilation_w,
+                               &w_begin,
+                               &w_end);
+              const float weight = w[kh * s.kernel_w + kw];
+              if (s.stride_w == 1) {
+                for (int64_t ow = w_begin; ow < w_end; ++ow) {
+                  out[ow] += weight * in_row[ow + offset];
+                }
+              } else {
+                for (int64_t ow = w_begin; ow < w_end; ++ow) {
+                  out[ow] += weight * in_row[ow * s.stride_w + offset];
+                }
+              }
+            }
+          }
+        }
+      });
+}
+
+// The matrices of Winograd F(m x m, 3 x 3), whose tiles are
+// (m + 2) x (m + 2): output = AT * ((G * g * GT) .* (BT * d * B)) * A.
+template <int M>
+struct WinogradMatrices;
+
+template <>
+struct WinogradMatrices<2> {
+  static constexpr int kTile = 4;
+  static constexpr float kBT[4][4] = {
+      {1.f, 0.f, -1.f, 0.f},
+      {0.f, 1.f, 1.f, 0.f},
+      {0.f, -1.f, 1.f, 0.f},
+      {0.f, 1.f, 0.f, -1.f},
+  };
+  static constexpr float kG[4][3] = {
+      {1.f, 0.f, 0.f},
+      {.5f, .5f, .5f},
+      {.5f, -.5f, .5f},
+      {0.f, 0.f, 1.f},
+  };
+  static constexpr float kAT[2][4] = {
+      {1.f, 1.f, 1.f, 0.f},
+      {0.f, 1.f, -1.f, -1.f},
+  };
+};
+
+template <>
+struct WinogradMatrices<4> {
+  static constexpr int kTile = 6;
+  static constexpr float kBT[6][6] = {
+      {4.f, 0.f, -5.f, 0.f, 1.f, 0.f},
+      {0.f, -4.f, -4.f, 1.f, 1.f, 0.f},
+      {0.f, 4.f, -4.f, -1.f, 1.f, 0.f},
+      {0.f, -2.f, -1.f, 2.f, 1.f, 0.f},
+      {0.f, 2.f, -1.f, -2.f, 1.f, 0.f},
+      {0.f, 4.f, 0.f, -5.f, 0.f, 1.f},
+  };
+  static constexpr float kG[6][3] = {
+      {1.f / 4, 0.f, 0.f},
+      {-1.f / 6, -1.f / 6, -1.f / 6},
+      {-1.f / 6, 1.f / 6, -1.f / 6},
+      {1.f / 24, 1.f / 12, 1.f / 6},
+      {1.f / 24, -1.f / 12, 1.f / 6},
+      {0.f, 0.f, 1.f},
+  };
+  static constexpr float kAT[4][6] = {
+      {1.f, 1.f, 1.f, 1.f, 1.f, 0.f},
+      {0.f, 1.f, -1.f, 2.f, -2.f, 0.f},
+      {0.f, 1.f, 1.f, 4.f, 4.f, 0.f},
+      {0.f, 1.f, -1.f, 8.f, -8.f, 1.f},
+  };
+};
+
+constexpr float WinogradMatrices<2>::kBT[4][4];
+constexpr float WinogradMatrices<2>::kG[4][3];
+constexpr float WinogradMatrices<2>::kAT[2][4];
+constexpr float WinogradMatrices<4>::kBT[6][6];
+constexpr float WinogradMatrices<4>::kG[6][3];
+constexpr float WinogradMatrices<4>::kAT[4][6];
+
+// The tiles are processed in blocks: the input tiles of a block are
+// transformed into {tile * tile, in_channels, tiles}, multiplied by the
+// transformed filter {tile * tile, out_channels, in_channels} with a GEMM
+// per tile element, and transformed back into the output.
+template <int M>
+void Winograd(const CPUContext& dev_ctx,
+              const Conv2dShape& s,
+              const float* input,
+              const float* filter,
+              float* output) {
+  using Matrices = WinogradMatrices<M>;
+  constexpr int kTile = Matrices::kTile;
+  constexpr int kTileSize = kTile * kTile;
+  const int64_t tiles_h = DivUp(s.out_h, M);
+  const int64_t tiles_w = DivUp(s.out_w, M);
+  const int64_t tiles = tiles_h * tiles_w;
+  const int64_t blocks = DivUp(tiles, kWinogradTileBlock);
+  const int64_t in_size = s.in_h * s.in_w;
+  const int64_t out_size = s.out_h * s.out_w;
+  const int64_t channels = s.in_channels * s.out_channels;
+
+  // U = G * g * GT for each pair of channels.
+  std::vector<float> transformed_filter(kTileSize * channels);
+  dev_ctx.ParallelFor(
+      0, channels, GrainSize(kTileSize * 9), [&](int64_t begin, int64_t end) {
+        for (int64_t pair = begin; pair < end; ++pair) {
+          const float* g = filter + pair * 9;
+          float temp[kTile][3];
+          for (int i = 0; i < kTile; ++i) {
+            for (int j = 0; j < 3; ++j) {
+              temp[i][j] = Matrices::kG[i][0] * g[j] +
+                           Matrices::kG[i][1] * g[3 + j] +
+                           Matrices::kG[i][2] * g[6 + j];
+            }
+          }
+          for (int i = 0; i < kTile; ++i) {
+            for (int j = 0; j < kTile; ++j) {
+              transformed_filter[(i * kTile + j) * channels + pair] =
+                  temp[i][0] * Matrices::kG[j][0] +
+                  temp[i][1] * Matrices::kG[j][1] +
+                  temp[i][2] * Matrices::kG[j][2];
+            }
+          }
+        }
+      });
+
+  auto blas = GetBlas<CPUContext, float>(dev_ctx);
+  BlasParallelFor(
+      dev_ctx,
+      0,
+      s.batch * blocks,
+      GrainSize(kTileSize * channels * kWinogradTileBlock),
+      [&](int64_t begin, int64_t end) {
+        std::vector<float> transformed_input(kTileSize * s.in_channels *
+                                             kWinogradTileBlock);
+        std::vector<float> product(kTileSize * s.out_channels *
+                                   kWinogradTileBlock);
+        for (int64_t unit = begin; unit < end; ++unit) {
+          const int64_t n = unit / blocks;
+          const int64_t first_tile = unit % blocks * kWinogradTileBlock;
+          const int64_t count =
+              std::min(kWinogradTileBlock, tiles - first_tile);
+
+          // V = BT * d * B.
+          for (int64_t c = 0; c < s.in_channels; ++c) {
+            const float* in = input + (n * s.in_channels + c) * in_size;
+            for (int64_t t = 0; t < count; ++t) {
+              const int64_t tile = first_tile + t;
+              const int64_t h0 = tile / tiles_w * M - s.pad_top;
+              const int64_t w0 = tile % tiles_w * M - s.pad_left;
+              float d[kTile][kTile];
+              for (int i = 0; i < kTile; ++i) {
+                const int64_t ih = h0 + i;
+                for (int j = 0; j < kTile; ++j) {
+                  const int64_t iw = w0 + j;
+                  d[i][j] = ih >= 0 && ih < s.in_h && iw >= 0 && iw < s.in_w
+                                ? in[ih * s.in_w + iw]
+                                : 0.f;
+                }
+              }
+              float temp[kTile][kTile];
+              for (int i = 0; i < kTile; ++i) {
+                for (int j = 0; j < kTile; ++j) {
+                  float sum = 0.f;
+                  for (int k = 0; k < kTile; ++k) {
+                    sum += Matrices::kBT[i][k] * d[k][j];
+                  }
+                  temp[i][j] = sum;
+                }
+              }
+              for (int i = 0; i < kTile; ++i) {
+                for (int j = 0; j < kTile; ++j) {
+                  float sum = 0.f;
+                  for (int k = 0; k < kTile; ++k) {
+                    sum += temp[i][k] * Matrices::kBT[j][k];
+                  }
+                  transformed_input[((i * kTile + j) * s.in_channels + c) *
+                                        count +
+                                    t] = sum;
+                }
+              }
+            }
+          }
+
+          for (int e = 0; e < kTileSize; ++e) {
+            blas.GEMM(false,
+                      false,
+                      s.out_channels,
+                      count,
+                      s.in_channels,
+                      1.f,
+                      transformed_filter.data() + e * channels,
+                      s.in_channels,
+                      transformed_input.data() + e * s.in_channels * count,
+                      count,
+                      0.f,
+                      product.data() + e * s.out_channels * count,
+                      count);
+          }
+
+          // Y = AT * m * A.
+          for (int64_t o = 0; o < s.out_channels; ++o) {
+            float* out = output + (n * s.out_channels + o) * out_size;
+            for (int64_t t = 0; t < count; ++t) {
+              const int64_t tile = first_tile + t;
+              const int64_t h0 = tile / tiles_w * M;
+              const int64_t w0 = tile % tiles_w * M;
+              float m[kTile][kTile];
+              for (int i = 0; i < kTile; ++i) {
+                for (int j = 0; j < kTile; ++j) {
+                  m[i][j] =
+                      product[((i * kTile + j) * s.out_channels + o) * count +
+                              t];
+                }
+              }
+              float temp[M][kTile];
+              for (int i = 0; i < M; ++i) {
+                for (int j = 0; j < kTile; ++j) {
+                  float sum = 0.f;
+                  for (int k = 0; k < kTile; ++k) {
+                    sum += Matrices::kAT[i][k] * m[k][j];
+                  }
+                  temp[i][j] = sum;
+                }
+              }
+              for (int i = 0; i < M && h0 + i < s.out_h; ++i) {
+                for (int j = 0; j < M && w0 + j < s.out_w; ++j) {
+                  float sum = 0.f;
+                  for (int k = 0; k < kTile; ++k) {
+                    sum += temp[i][k] * Matrices::kAT[j][k];
+                  }
+                  out[(h0 + i) * s.out_w + w0 + j] = sum;
+                }
+              }
+            }
+          }
+        }
+      });
+}
+
+}  // namespace
+
+const char* Conv2dAlgorithmName(Conv2dAlgorithm algorithm) {
+  switch (algorithm) {
+    case Conv2dAlgorithm::kIm2colGemm:
+      return "im2col_gemm";
+    case Conv2dAlgorithm::kGemm1x1:
+      return "gemm_1x1";
+    case Conv2dAlgorithm::kDirect:
+      return "direct";
+    case Conv2dAlgorithm::kWinogradF2x3:
+      return "winograd_f2x3";
+    case Conv2dAlgorithm::kWinogradF4x3:
+      return "winograd_f4x3";
+  }
+  return "unknown";
+}
+
+bool IsConv2dAlgorithmSupported(const Conv2dShape& shape,
+                                Conv2dAlgorithm algorithm) {
+  switch (algorithm) {
+    case Conv2dAlgorithm::kIm2colGemm:
+      return true;
+    case Conv2dAlgorithm::kGemm1x1:
+      return shape.groups == 1 && shape.kernel_h == 1 && shape.kernel_w == 1 &&
+             shape.pad_top == 0 && shape.pad_left == 0 &&
+             (shape.out_h - 1) * shape.stride_h < shape.in_h &&
+             (shape.out_w - 1) * shape.stride_w < shape.in_w;
+    case Conv2dAlgorithm::kDirect:
+      return IsDepthwise(shape);
+    case Conv2dAlgorithm::kWinogradF2x3:
+    case Conv2dAlgorithm::kWinogradF4x3:
+      return IsWinogradShape(shape);
+  }
+  return false;
+}
+
+Conv2dAlgorithm SelectConv2dAlgorithm(const Conv2dShape& shape) {
+  if (IsDepthwise(shape)) {
+    // im2col runs a GEMM of a single input channel per group.
+    return Conv2dAlgorithm::kDirect;
+  }
+  if (IsConv2dAlgorithmSupported(shape, Conv2dAlgorithm::kGemm1x1)) {
+    return Conv2dAlgorithm::kGemm1x1;
+  }
+  if (shape.groups != 1) {
+    return Conv2dAlgorithm::kIm2colGemm;
+  }
+  if (IsWinogradShape(shape) && shape.in_channels >= 16 &&
+      shape.out_channels >= 16 && shape.out_h >= 14 && shape.out_w >= 14) {
+    // The GEMMs of the tile elements only have as many columns as tiles, so
+    // the small maps of the last stages of a CNN stay on im2col, and F(4x4,
+    // 3x3) saves more multiplies but needs 4 times the pixels of F(2x2,
+    // 3x3) for the same tiles.
+    if (shape.out_h >= 28 && shape.out_w >= 28) {
+      return Conv2dAlgorithm::kWinogradF4x3;
+    }
+    return Conv2dAlgorithm::kWinogradF2x3;
+  }
+  return Conv2dAlgorithm::kIm2colGemm;
+}
+
+void Conv2dForward(const CPUContext& dev_ctx,
+                   const Conv2dShape& shape,
+                   Conv2dAlgorithm algorithm,
+                   const float* input,
+                   const float* filter,
+                   float* output) {
+  PADDLE_ENFORCE_EQ(
+      IsConv2dAlgorithmSupported(shape, algorithm),
+      true,
+      errors::InvalidArgument("The conv2d algorithm %s does not support the "
+                              "shape of the convolution.",
+                              Conv2dAlgorithmName(algorithm)));
+  switch (algorithm) {
+    case Conv2dAlgorithm::kIm2colGemm:
+      Im2colGemm(dev_ctx, shape, input, filter, output);
+      break;
+    case Conv2dAlgorithm::kGemm1x1:
+      Gemm1x1(dev_ctx, shape, input, filter, output);
+      break;
+    case Conv2dAlgorithm::kDirect:
+      DirectDepthwise(dev_ctx, shape, input, filter, output);
+      break;
+    case Conv2dAlgorithm::kWinogradF2x3:
+      Winograd<2>(dev_ctx, shape, input, filter, output);
+      break;
+    case Conv2dAlgorithm::kWinogradF4x3:
+      Winograd<4>(dev_ctx, shape, input, filter, output);
+      break;
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
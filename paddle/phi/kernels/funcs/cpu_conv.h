@@ -0,0 +1,82 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+namespace funcs {
+
+// The shape of a 2D convolution of NCHW float tensors, whose filter is
+// {out_channels, in_channels / groups, kernel_h, kernel_w}.
+struct Conv2dShape {
+  int64_t batch{1};
+  int64_t in_channels{1};
+  int64_t in_h{1};
+  int64_t in_w{1};
+  int64_t out_channels{1};
+  int64_t out_h{1};
+  int64_t out_w{1};
+  int64_t kernel_h{1};
+  int64_t kernel_w{1};
+  int64_t stride_h{1};
+  int64_t stride_w{1};
+  int64_t pad_top{0};
+  int64_t pad_left{0};
+  int64_t dilation_h{1};
+  int64_t dilation_w{1};
+  int64_t groups{1};
+};
+
+enum class Conv2dAlgorithm {
+  // im2col and a GEMM per sample and group, which supports every shape.
+  kIm2colGemm,
+  // A GEMM per block of output pixels of a 1x1 convolution, which reads the
+  // input in place when the stride is 1.
+  kGemm1x1,
+  // A direct depthwise convolution, one row of output pixels at a time,
+  // without any column buffer.
+  kDirect,
+  // Winograd F(2x2, 3x3) and F(4x4, 3x3): the tiles of the input and the
+  // filter are transformed, multiplied by a GEMM per tile element and
+  // transformed back.
+  kWinogradF2x3,
+  kWinogradF4x3,
+};
+
+const char* Conv2dAlgorithmName(Conv2dAlgorithm algorithm);
+
+// Returns whether algorithm computes the convolution of shape.
+bool IsConv2dAlgorithmSupported(const Conv2dShape& shape,
+                                Conv2dAlgorithm algorithm);
+
+// Picks the algorithm expected to be the fastest for shape.
+Conv2dAlgorithm SelectConv2dAlgorithm(const Conv2dShape& shape);
+
+// Computes output = conv2d(input, filter) with algorithm, which must be
+// supported for shape. The batch samples and the output pixels run in
+// parallel on the threads of dev_ctx, each calling a single threaded blas,
+// or one after another on a multithreaded blas if they are too few.
+void Conv2dForward(const CPUContext& dev_ctx,
+                   const Conv2dShape& shape,
+                   Conv2dAlgorithm algorithm,
+                   const float* input,
+                   const float* filter,
+                   float* output);
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,450 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_embedding_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/embedding_util.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The row elements given to a thread at least.
+constexpr int64_t kEmbeddingGrainSize = 1 << 15;
+// The ids ahead of the current one whose rows are prefetched.
+constexpr int64_t kPrefetchDistance = 4;
+constexpr int64_t kCacheLineSize = 64;
+
+template <typename T>
+using AccType = typename phi::dtype::MPTypeTrait<T>::Type;
+
+int64_t GrainSize(int64_t elements_per_unit) {
+  return std::max<int64_t>(
+      1, kEmbeddingGrainSize / std::max<int64_t>(elements_per_unit, 1));
+}
+
+inline void PrefetchRow(const void* row, int64_t bytes) {
+#if defined(__GNUC__)
+  const char* begin = static_cast<const char*>(row);
+  for (int64_t i = 0; i < bytes; i += kCacheLineSize) {
+    __builtin_prefetch(begin + i);
+  }
+#endif
+}
+
+inline void CheckId(int64_t id, int64_t height) {
+  PADDLE_ENFORCE_EQ(
+      id >= 0 && id < height,
+      true,
+      errors::InvalidArgument(
+          "The ids of the embedding lookup should be >= 0 and < %ld, but "
+          "got %ld. Please check the input value.",
+          height,
+          id));
+}
+
+// Whether id is skipped as padding. kNoPadding pads no id, so that an id of
+// -1 is still checked.
+inline bool IsPadding(int64_t id, int64_t padding_idx) {
+  return padding_idx != kNoPadding && id == padding_idx;
+}
+
+// The factor of the weighted sum of a bag of weights.
+template <typename AccT>
+AccT PoolScale(EmbeddingPoolType type, AccT weight_sum, AccT square_sum) {
+  switch (type) {
+    case EmbeddingPoolType::kMean:
+      return weight_sum != AccT(0) ? AccT(1) / weight_sum : AccT(0);
+    case EmbeddingPoolType::kSqrt:
+      return square_sum > AccT(0) ? AccT(1) / std::sqrt(square_sum) : AccT(0);
+    default:
+      return AccT(1);
+  }
+}
+
+// The bags of a lookup, and the positions of each bag in ids.
+struct Bags {
+  Bags(const std::vector<uint64_t>& offsets, int64_t slots)
+      : offsets(offsets),
+        slots(slots),
+        num_seqs(offsets.empty() ? 0 : offsets.size() - 1) {}
+
+  int64_t size() const { return num_seqs * slots; }
+  // The indices in ids of bag run from First(bag) up to Last(bag), which
+  // is excluded, by steps of slots.
+  int64_t First(int64_t bag) const {
+    return offsets[bag / slots] * slots + bag % slots;
+  }
+  int64_t Last(int64_t bag) const { return offsets[bag / slots + 1] * slots; }
+  int64_t AverageElements(int64_t width) const {
+    return num_seqs == 0 ? 0 : offsets.back() / num_seqs * width;
+  }
+
+  const std::vector<uint64_t>& offsets;
+  int64_t slots;
+  int64_t num_seqs;
+};
+
+template <typename T, typename IdT>
+void PoolBag(const T* table,
+             int64_t height,
+             int64_t width,
+             const IdT* ids,
+             const T* weights,
+             const Bags& bags,
+             int64_t bag,
+             EmbeddingPoolType type,
+             int64_t padding_idx,
+             AccType<T>* buffer,
+             T* out) {
+  using AccT = AccType<T>;
+  // float and double accumulate in out right away.
+  constexpr bool kInPlace = std::is_same<T, AccT>::value;
+  AccT* acc = kInPlace ? reinterpret_cast<AccT*>(out) : buffer;
+  std::fill(acc, acc + width, AccT(0));
+  AccT weight_sum = 0;
+  AccT square_sum = 0;
+  bool empty = true;
+  const int64_t slots = bags.slots;
+  const int64_t prefetch_step = kPrefetchDistance * slots;
+  const int64_t last = bags.Last(bag);
+  for (int64_t index = bags.First(bag); index < last; index += slots) {
+    if (index + prefetch_step < last) {
+      int64_t next = ids[index + prefetch_step];
+      if (next >= 0 && next < height) {
+        PrefetchRow(table + next * width, width * sizeof(T));
+      }
+    }
+    const int64_t id = ids[index];
+    if (IsPadding(id, padding_idx)) {
+      continue;
+    }
+    CheckId(id, height);
+    const AccT weight = weights ? static_cast<AccT>(weights[index]) : AccT(1);
+    const T* row = table + id * width;
+    if (type == EmbeddingPoolType::kMax) {
+      for (int64_t e = 0; e < width; ++e) {
+        AccT value = weight * static_cast<AccT>(row[e]);
+        acc[e] = empty ? value : std::max(acc[e], value);
+      }
+    } else {
+      for (int64_t e = 0; e < width; ++e) {
+        acc[e] += weight * static_cast<AccT>(row[e]);
+      }
+    }
+    empty = false;
+    weight_sum += weight;
+    square_sum += weight * weight;
+  }
+  const AccT scale = PoolScale(type, weight_sum, square_sum);
+  if (!kInPlace || scale != AccT(1)) {
+    for (int64_t e = 0; e < width; ++e) {
+      out[e] = static_cast<T>(acc[e] * scale);
+    }
+  }
+}
+
+}  // namespace
+
+EmbeddingPoolType GetEmbeddingPoolType(const std::string& combiner) {
+  if (combiner == "sum") {
+    return EmbeddingPoolType::kSum;
+  } else if (combiner == "mean") {
+    return EmbeddingPoolType::kMean;
+  } else if (combiner == "sqrt") {
+    return EmbeddingPoolType::kSqrt;
+  } else if (combiner == "max") {
+    return EmbeddingPoolType::kMax;
+  }
+  PADDLE_THROW(errors::Unimplemented(
+      "The combiner of the embedding pooling should be sum, mean, sqrt or "
+      "max, but got %s.",
+      combiner));
+}
+
+template <typename T, typename IdT>
+void EmbeddingLookup(const CPUContext& dev_ctx,
+                     const T* table,
+                     int64_t height,
+                     int64_t width,
+                     const IdT* ids,
+                     int64_t num_ids,
+                     int64_t padding_idx,
+                     T* out) {
+  dev_ctx.ParallelFor(
+      0, num_ids, GrainSize(width), [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          if (i + kPrefetchDistance < end) {
+            int64_t next = ids[i + kPrefetchDistance];
+            if (next >= 0 && next < height) {
+              PrefetchRow(table + next * width, width * sizeof(T));
+            }
+          }
+          const int64_t id = ids[i];
+          if (IsPadding(id, padding_idx)) {
+            std::memset(out + i * width, 0, width * sizeof(T));
+            continue;
+          }
+          CheckId(id, height);
+          std::memcpy(
+              out + i * width, table + id * width, width * sizeof(T));
+        }
+      });
+}
+
+template <typename T, typename IdT>
+void EmbeddingSeqPool(const CPUContext& dev_ctx,
+                      const T* table,
+                      int64_t height,
+                      int64_t width,
+                      const IdT* ids,
+                      const T* weights,
+                      const std::vector<uint64_t>& offsets,
+                      int64_t slots,
+                      EmbeddingPoolType type,
+                      int64_t padding_idx,
+                      T* out) {
+  const Bags bags(offsets, slots);
+  dev_ctx.ParallelFor(0,
+                      bags.size(),
+                      GrainSize(bags.AverageElements(width)),
+                      [&](int64_t begin, int64_t end) {
+                        std::vector<AccType<T>> acc(width);
+                        for (int64_t bag = begin; bag < end; ++bag) {
+                          PoolBag(table,
+                                  height,
+                                  width,
+                                  ids,
+                                  weights,
+                                  bags,
+                                  bag,
+                                  type,
+                                  padding_idx,
+                                  acc.data(),
+                                  out + bag * width);
+                        }
+                      });
+}
+
+template <typename IdT>
+EmbeddingIdGroups GroupEmbeddingIds(const IdT* ids,
+                                    int64_t num_ids,
+                                    int64_t padding_idx) {
+  std::vector<std::pair<int64_t, int64_t>> sorted;
+  sorted.reserve(num_ids);
+  for (int64_t i = 0; i < num_ids; ++i) {
+    if (!IsPadding(ids[i], padding_idx)) {
+      sorted.emplace_back(ids[i], i);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  EmbeddingIdGroups groups;
+  groups.positions.reserve(sorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    if (i == 0 || sorted[i].first != sorted[i - 1].first) {
+      groups.rows.push_back(sorted[i].first);
+      groups.starts.push_back(i);
+    }
+    groups.positions.push_back(sorted[i].second);
+  }
+  groups.starts.push_back(sorted.size());
+  return groups;
+}
+
+template <typename T, typename IdT>
+void EmbeddingSeqPoolGrad(const CPUContext& dev_ctx,
+                          const T* table,
+                          int64_t width,
+                          const IdT* ids,
+                          const T* weights,
+                          const std::vector<uint64_t>& offsets,
+                          int64_t slots,
+                          EmbeddingPoolType type,
+                          int64_t padding_idx,
+                          const EmbeddingIdGroups& groups,
+                          const T* out_grad,
+                          bool by_id,
+                          T* grad) {
+  using AccT = AccType<T>;
+  const Bags bags(offsets, slots);
+  const int64_t num_positions = bags.num_seqs == 0 ? 0 : offsets.back();
+  std::vector<int64_t> seq_of_position(num_positions);
+  for (int64_t i = 0; i < bags.num_seqs; ++i) {
+    std::fill(seq_of_position.begin() + offsets[i],
+              seq_of_position.begin() + offsets[i + 1],
+              i);
+  }
+
+  // The factor of the weighted sum of each bag, or for kMax the index in
+  // ids of the max of each element of each bag, the first one on ties.
+  std::vector<AccT> scales;
+  std::vector<int64_t> argmax;
+  if (type == EmbeddingPoolType::kMax) {
+    argmax.resize(bags.size() * width);
+    dev_ctx.ParallelFor(
+        0,
+        bags.size(),
+        GrainSize(bags.AverageElements(width)),
+        [&](int64_t begin, int64_t end) {
+          std::vector<AccT> max(width);
+          for (int64_t bag = begin; bag < end; ++bag) {
+            int64_t* bag_argmax = argmax.data() + bag * width;
+            std::fill(bag_argmax, bag_argmax + width, -1);
+            const int64_t last = bags.Last(bag);
+            for (int64_t index = bags.First(bag); index < last;
+                 index += slots) {
+              if (IsPadding(ids[index], padding_idx)) {
+                continue;
+              }
+              const AccT weight =
+                  weights ? static_cast<AccT>(weights[index]) : AccT(1);
+              const T* row = table + ids[index] * width;
+              for (int64_t e = 0; e < width; ++e) {
+                AccT value = weight * static_cast<AccT>(row[e]);
+                if (bag_argmax[e] < 0 || value > max[e]) {
+                  max[e] = value;
+                  bag_argmax[e] = index;
+                }
+              }
+            }
+          }
+        });
+  } else {
+    scales.resize(bags.size());
+    dev_ctx.ParallelFor(
+        0,
+        bags.size(),
+        GrainSize(bags.AverageElements(1)),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t bag = begin; bag < end; ++bag) {
+            AccT weight_sum = 0;
+            AccT square_sum = 0;
+            const int64_t last = bags.Last(bag);
+            for (int64_t index = bags.First(bag); index < last;
+                 index += slots) {
+              if (IsPadding(ids[index], padding_idx)) {
+                continue;
+              }
+              const AccT weight =
+                  weights ? static_cast<AccT>(weights[index]) : AccT(1);
+              weight_sum += weight;
+              square_sum += weight * weight;
+            }
+            scales[bag] = PoolScale(type, weight_sum, square_sum);
+          }
+        });
+  }
+
+  // Each row sums the gradients of the bags its id occurs in.
+  const int64_t num_rows = groups.rows.size();
+  dev_ctx.ParallelFor(
+      0, num_rows, GrainSize(width), [&](int64_t begin, int64_t end) {
+        std::vector<AccT> acc(width);
+        for (int64_t r = begin; r < end; ++r) {
+          std::fill(acc.begin(), acc.end(), AccT(0));
+          for (int64_t i = groups.starts[r]; i < groups.starts[r + 1]; ++i) {
+            const int64_t index = groups.positions[i];
+            const int64_t bag =
+                seq_of_position[index / slots] * slots + index % slots;
+            const AccT weight =
+                weights ? static_cast<AccT>(weights[index]) : AccT(1);
+            const T* bag_grad = out_grad + bag * width;
+            if (type == EmbeddingPoolType::kMax) {
+              const int64_t* bag_argmax = argmax.data() + bag * width;
+              for (int64_t e = 0; e < width; ++e) {
+                if (bag_argmax[e] == index) {
+                  acc[e] += weight * static_cast<AccT>(bag_grad[e]);
+                }
+              }
+            } else {
+              const AccT scale = weight * scales[bag];
+              for (int64_t e = 0; e < width; ++e) {
+                acc[e] += scale * static_cast<AccT>(bag_grad[e]);
+              }
+            }
+          }
+          T* row = grad + (by_id ? groups.rows[r] : r) * width;
+          for (int64_t e = 0; e < width; ++e) {
+            row[e] = static_cast<T>(acc[e]);
+          }
+        }
+      });
+}
+
+#define INSTANTIATE_EMBEDDING_POOL(T, IdT)                       \
+  template void EmbeddingLookup<T, IdT>(                         \
+      const CPUContext&,                                         \
+      const T*,                                                  \
+      int64_t,                                                   \
+      int64_t,                                                   \
+      const IdT*,                                                \
+      int64_t,                                                   \
+      int64_t,                                                   \
+      T*);                                                       \
+  template void EmbeddingSeqPool<T, IdT>(                        \
+      const CPUContext&,                                         \
+      const T*,                                                  \
+      int64_t,                                                   \
+      int64_t,                                                   \
+      const IdT*,                                                \
+      const T*,                                                  \
+      const std::vector<uint64_t>&,                              \
+      int64_t,                                                   \
+      EmbeddingPoolType,                                         \
+      int64_t,                                                   \
+      T*);                                                       \
+  template void EmbeddingSeqPoolGrad<T, IdT>(                    \
+      const CPUContext&,                                         \
+      const T*,                                                  \
+      int64_t,                                                   \
+      const IdT*,                                                \
+      const T*,                                                  \
+      const std::vector<uint64_t>&,                              \
+      int64_t,                                                   \
+      EmbeddingPoolType,                                         \
+      int64_t,                                                   \
+      const EmbeddingIdGroups&,                                  \
+      const T*,                                                  \
+      bool,                                                      \
+      T*)
+
+INSTANTIATE_EMBEDDING_POOL(float, int32_t);
+INSTANTIATE_EMBEDDING_POOL(float, int64_t);
+INSTANTIATE_EMBEDDING_POOL(double, int32_t);
+INSTANTIATE_EMBEDDING_POOL(double, int64_t);
+INSTANTIATE_EMBEDDING_POOL(phi::dtype::bfloat16, int32_t);
+INSTANTIATE_EMBEDDING_POOL(phi::dtype::bfloat16, int64_t);
+
+#undef INSTANTIATE_EMBEDDING_POOL
+
+template EmbeddingIdGroups GroupEmbeddingIds<int32_t>(const int32_t*,
+                                                      int64_t,
+                                                      int64_t);
+template EmbeddingIdGroups GroupEmbeddingIds<int64_t>(const int64_t*,
+                                                      int64_t,
+                                                      int64_t);
+
+}  // namespace funcs
+}  // namespace phi
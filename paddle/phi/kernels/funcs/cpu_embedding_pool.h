@@ -0,0 +1,112 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+namespace funcs {
+
+// The lookups below pool the rows of an embedding table for the bags of a
+// batch of sequences. The positions [offsets[i], offsets[i + 1]) belong to
+// the sequence i, each position holds slots ids, and the ids of slot s of
+// sequence i form the bag (i, s), whose pooled row is written to the
+// columns [s * width, (s + 1) * width) of the row i of out. Each id may
+// have a weight, 1 by default, and the ids equal to padding_idx are
+// skipped, unless it is kNoPadding. An empty bag pools to zeros.
+enum class EmbeddingPoolType {
+  // The weighted sum of the rows.
+  kSum,
+  // The weighted sum divided by the sum of the weights.
+  kMean,
+  // The weighted sum divided by the square root of the sum of the squared
+  // weights.
+  kSqrt,
+  // The element-wise max of the weighted rows.
+  kMax,
+};
+
+// Parses a combiner, one of "sum", "mean", "sqrt" and "max".
+EmbeddingPoolType GetEmbeddingPoolType(const std::string& combiner);
+
+// Copies the row of each of the num_ids ids to out, zeros for padding_idx,
+// the ids running in parallel on the threads of dev_ctx.
+template <typename T, typename IdT>
+void EmbeddingLookup(const CPUContext& dev_ctx,
+                     const T* table,
+                     int64_t height,
+                     int64_t width,
+                     const IdT* ids,
+                     int64_t num_ids,
+                     int64_t padding_idx,
+                     T* out);
+
+// Looks up and pools the bags, which run in parallel on the threads of
+// dev_ctx. weights may be null. T is float, double or bfloat16, which is
+// accumulated in float.
+template <typename T, typename IdT>
+void EmbeddingSeqPool(const CPUContext& dev_ctx,
+                      const T* table,
+                      int64_t height,
+                      int64_t width,
+                      const IdT* ids,
+                      const T* weights,
+                      const std::vector<uint64_t>& offsets,
+                      int64_t slots,
+                      EmbeddingPoolType type,
+                      int64_t padding_idx,
+                      T* out);
+
+// The ids grouped by value: rows are the distinct ids other than
+// padding_idx in ascending order, and the indices in ids of rows[r] are
+// positions[starts[r]], ..., positions[starts[r + 1] - 1].
+struct EmbeddingIdGroups {
+  std::vector<int64_t> rows;
+  std::vector<int64_t> starts;
+  std::vector<int64_t> positions;
+};
+
+template <typename IdT>
+EmbeddingIdGroups GroupEmbeddingIds(const IdT* ids,
+                                    int64_t num_ids,
+                                    int64_t padding_idx);
+
+// Computes the gradient of the table rows of groups from out_grad, the
+// gradient of out, each row once however often its id occurs. Row r is
+// written to grad + r * width, as the value of a SelectedRows, or to
+// grad + rows[r] * width if by_id, the other rows of a dense gradient
+// being left to the caller. table is read by kMax only, to find the ids
+// whose elements were the max again.
+template <typename T, typename IdT>
+void EmbeddingSeqPoolGrad(const CPUContext& dev_ctx,
+                          const T* table,
+                          int64_t width,
+                          const IdT* ids,
+                          const T* weights,
+                          const std::vector<uint64_t>& offsets,
+                          int64_t slots,
+                          EmbeddingPoolType type,
+                          int64_t padding_idx,
+                          const EmbeddingIdGroups& groups,
+                          const T* out_grad,
+                          bool by_id,
+                          T* grad);
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,244 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_jit.h"
+
+#include <algorithm>
+
+#include "paddle/phi/core/enforce.h"
+
+namespace phi {
+namespace funcs {
+
+namespace jit = paddle::operators::jit;
+
+// The elements of adam run by a thread at least, as the jit kernels are
+// called once for each range of a thread.
+constexpr int64_t kJitAdamGrainSize = 1 << 14;
+// The elements reduced by a thread at least.
+constexpr int64_t kJitReduceGrainSize = 1 << 15;
+// The widths that the sums of the rows are generated for, the widest
+// first. The rows are summed in chunks of them and the narrower tails by
+// the reference code.
+constexpr int kJitReduceWidths[] = {kJitBlockSize, 64, 16};
+
+template <typename KernelTuple>
+void JitActivateBlocks(const float* x, float* y, int n) {
+  int done = 0;
+  if (n >= kJitBlockSize) {
+    auto block = GetJitFunc<KernelTuple>(kJitBlockSize);
+    for (; done + kJitBlockSize <= n; done += kJitBlockSize) {
+      block(x + done, y + done, kJitBlockSize);
+    }
+  }
+  if (done < n) {
+    jit::GetReferFunc<KernelTuple>()(x + done, y + done, n - done);
+  }
+}
+
+void JitActivate(JitActivation act, const float* x, float* y, int n) {
+  switch (act) {
+    case JitActivation::kIdentity:
+      JitActivateBlocks<jit::VIdentityTuple<float>>(x, y, n);
+      break;
+    case JitActivation::kRelu:
+      JitActivateBlocks<jit::VReluTuple<float>>(x, y, n);
+      break;
+    case JitActivation::kSigmoid:
+      JitActivateBlocks<jit::VSigmoidTuple<float>>(x, y, n);
+      break;
+    case JitActivation::kTanh:
+      JitActivateBlocks<jit::VTanhTuple<float>>(x, y, n);
+      break;
+  }
+}
+
+void JitReduceRows(const CPUContext& dev_ctx,
+                   const float* x,
+                   int64_t rows,
+                   int64_t cols,
+                   bool mean,
+                   float* y) {
+  PADDLE_ENFORCE_EQ(
+      cols > 0 && cols <= kJitReduceMaxCols,
+      true,
+      errors::InvalidArgument("The rows reduced by the jit kernels should "
+                              "have 1 to %d elements, but received %d.",
+                              kJitReduceMaxCols,
+                              cols));
+  constexpr int kNumWidths = sizeof(kJitReduceWidths) / sizeof(int);
+  // The code of the widths not wider than the rows, which the threads
+  // share.
+  jit::HSumTuple<float>::func_type hsums[kNumWidths] = {};
+  for (int k = 0; k < kNumWidths; ++k) {
+    if (kJitReduceWidths[k] <= cols) {
+      hsums[k] = GetJitFunc<jit::HSumTuple<float>>(kJitReduceWidths[k]);
+    }
+  }
+  auto hsum_tail = jit::GetReferFunc<jit::HSumTuple<float>>();
+  const int width = static_cast<int>(cols);
+  const float scale = mean ? 1.f / static_cast<float>(cols) : 1.f;
+  dev_ctx.ParallelFor(
+      0,
+      rows,
+      std::max<int64_t>(1, kJitReduceGrainSize / cols),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const float* row = x + i * cols;
+          float sum = 0.f;
+          int done = 0;
+          for (int k = 0; k < kNumWidths; ++k) {
+            for (; hsums[k] && done + kJitReduceWidths[k] <= width;
+                 done += kJitReduceWidths[k]) {
+              float part;
+              hsums[k](row + done, &part, kJitReduceWidths[k]);
+              sum += part;
+            }
+          }
+          if (done < width) {
+            float part;
+            hsum_tail(row + done, &part, width - done);
+            sum += part;
+          }
+          y[i] = sum * scale;
+        }
+      });
+}
+
+bool JitReduceLastAxis(const CPUContext& dev_ctx,
+                       const DenseTensor& x,
+                       const std::vector<int64_t>& dims,
+                       bool reduce_all,
+                       bool mean,
+                       DenseTensor* out) {
+  const int rank = x.dims().size();
+  const int64_t numel = x.numel();
+  if (x.dtype() != DataType::FLOAT32 || numel == 0 || rank == 0) {
+    return false;
+  }
+  int64_t cols = 0;
+  if (reduce_all || static_cast<int>(dims.size()) == rank) {
+    cols = numel;
+  } else if (dims.size() == 1 && (dims[0] == -1 || dims[0] == rank - 1)) {
+    cols = x.dims()[rank - 1];
+  }
+  if (cols == 0 || cols > kJitReduceMaxCols) {
+    return false;
+  }
+  JitReduceRows(dev_ctx,
+                x.data<float>(),
+                numel / cols,
+                cols,
+                mean,
+                dev_ctx.Alloc<float>(out));
+  return true;
+}
+
+template <typename T>
+void JitAdam(const CPUContext& dev_ctx,
+             T beta1,
+             T beta2,
+             T lr,
+             T eps,
+             T old_lr,
+             T lr_ratio,
+             T coeff,
+             int64_t numel,
+             const T* grad,
+             const T* mom1,
+             const T* mom2,
+             const T* param,
+             T* mom1_out,
+             T* mom2_out,
+             T* param_out) {
+  if (numel == 0) {
+    return;
+  }
+  if (coeff == static_cast<T>(0)) {
+    jit::adam_attr_t attr(beta1, beta2);
+    auto adam = GetJitFunc<jit::AdamTuple<T>>(attr);
+    dev_ctx.ParallelFor(
+        0, numel, kJitAdamGrainSize, [&](int64_t begin, int64_t end) {
+          adam(beta1,
+               beta2,
+               -lr,
+               eps,
+               end - begin,
+               grad + begin,
+               mom1 + begin,
+               mom2 + begin,
+               param + begin,
+               mom1_out + begin,
+               mom2_out + begin,
+               param_out + begin);
+        });
+    return;
+  }
+  jit::adamw_attr_t attr(beta1, beta2, coeff);
+  auto adamw = GetJitFunc<jit::AdamWTuple<T>>(attr);
+  dev_ctx.ParallelFor(
+      0, numel, kJitAdamGrainSize, [&](int64_t begin, int64_t end) {
+        adamw(beta1,
+              beta2,
+              -lr,
+              eps,
+              old_lr,
+              lr_ratio,
+              coeff,
+              end - begin,
+              grad + begin,
+              mom1 + begin,
+              mom2 + begin,
+              param + begin,
+              mom1_out + begin,
+              mom2_out + begin,
+              param_out + begin);
+      });
+}
+
+template void JitAdam<float>(const CPUContext& dev_ctx,
+                             float beta1,
+                             float beta2,
+                             float lr,
+                             float eps,
+                             float old_lr,
+                             float lr_ratio,
+                             float coeff,
+                             int64_t numel,
+                             const float* grad,
+                             const float* mom1,
+                             const float* mom2,
+                             const float* param,
+                             float* mom1_out,
+                             float* mom2_out,
+                             float* param_out);
+template void JitAdam<double>(const CPUContext& dev_ctx,
+                              double beta1,
+                              double beta2,
+                              double lr,
+                              double eps,
+                              double old_lr,
+                              double lr_ratio,
+                              double coeff,
+                              int64_t numel,
+                              const double* grad,
+                              const double* mom1,
+                              const double* mom2,
+                              const double* param,
+                              double* mom1_out,
+                              double* mom2_out,
+                              double* param_out);
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,102 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+// The phi CPU kernels use the jit kernels of paddle/fluid/operators/jit from
+// here. A jit kernel generates the code specialized for the attr of a call,
+// e.g. the size of its vectors, at runtime with the widest vector
+// instructions of the CPU, and keeps it in the jit code pool of the thread,
+// so that the code of each attr is generated once. The kernels of double,
+// or of a CPU without AVX, run the reference code instead.
+
+// Returns the function of KernelTuple, e.g. jit::VAddTuple<float>, for attr.
+template <typename KernelTuple>
+inline typename KernelTuple::func_type GetJitFunc(
+    const typename KernelTuple::attr_type& attr) {
+  return paddle::operators::jit::KernelFuncs<KernelTuple,
+                                             phi::CPUPlace>::Cache()
+      .At(attr);
+}
+
+// The elements of the vectors that the elementwise jit kernels are
+// generated for. The callers run their vectors in blocks of it and the
+// tails by the reference code, so that the pool keeps one code of each
+// kernel instead of one for every length.
+constexpr int kJitBlockSize = 256;
+
+// The activations of the jit kernels.
+enum class JitActivation { kIdentity, kRelu, kSigmoid, kTanh };
+
+// Computes y = act(x) for n floats, in place if y is x.
+void JitActivate(JitActivation act, const float* x, float* y, int n);
+
+// The widest rows reduced by the jit kernels. Eigen reduces the wider ones
+// as fast.
+constexpr int64_t kJitReduceMaxCols = 4096;
+
+// Sums, or averages if mean, each of the rows of cols elements of x to y,
+// the rows running in parallel on the threads of dev_ctx. cols is 1 to
+// kJitReduceMaxCols. The rows are summed in chunks of a few fixed widths.
+void JitReduceRows(const CPUContext& dev_ctx,
+                   const float* x,
+                   int64_t rows,
+                   int64_t cols,
+                   bool mean,
+                   float* y);
+
+// Reduces x to out by JitReduceRows if dims, or reduce_all, reduce the
+// last axis of a float x only. Returns false, having done nothing, for any
+// other reduce.
+bool JitReduceLastAxis(const CPUContext& dev_ctx,
+                       const DenseTensor& x,
+                       const std::vector<int64_t>& dims,
+                       bool reduce_all,
+                       bool mean,
+                       DenseTensor* out);
+
+// Updates the numel elements of param, mom1 and mom2 by a step of adam, or
+// of adamw if coeff is not 0, which first decays param by
+// old_lr * lr_ratio * coeff. lr is the learning rate corrected by the beta
+// pows. The elements run in parallel on the threads of dev_ctx.
+template <typename T>
+void JitAdam(const CPUContext& dev_ctx,
+             T beta1,
+             T beta2,
+             T lr,
+             T eps,
+             T old_lr,
+             T lr_ratio,
+             T coeff,
+             int64_t numel,
+             const T* grad,
+             const T* mom1,
+             const T* mom2,
+             const T* param,
+             T* mom1_out,
+             T* mom2_out,
+             T* param_out);
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,716 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+
+#include <cstring>
+#include <vector>
+
+#include "paddle/fluid/platform/cpu_info.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+#if defined(__GNUC__) && !defined(_WIN32) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PADDLE_CPU_LOW_PRECISION_AVX512
+// The avx512bf16 intrinsics need GCC 10, which cmake/simd.cmake checks.
+#ifdef PADDLE_WITH_AVX512BF16_INTRINSICS
+#define PADDLE_CPU_LOW_PRECISION_AVX512_BF16
+#endif
+#endif
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The elements converted by a thread at least.
+constexpr int64_t kConvertGrainSize = 16384;
+
+uint16_t FloatToBf16Bits(float x) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  if (x != x) {
+    // Keeps the sign and makes the NaN quiet, which rounding could turn
+    // into an infinity.
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+float Bf16BitsToFloat(uint16_t x) {
+  uint32_t bits = static_cast<uint32_t>(x) << 16;
+  float y;
+  std::memcpy(&y, &bits, sizeof(y));
+  return y;
+}
+
+bool UseAvx512() {
+  static const bool use_avx512 =
+      paddle::platform::MayIUse(paddle::platform::avx512_core);
+  return use_avx512;
+}
+
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512vl")))
+
+__mmask16 TailMask(int64_t n) {
+  return static_cast<__mmask16>((1U << n) - 1);
+}
+
+AVX512_TARGET __m512 LoadBf16(const uint16_t* x, __mmask16 mask) {
+  __m512i v = _mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(mask, x));
+  return _mm512_castsi512_ps(_mm512_slli_epi32(v, 16));
+}
+
+AVX512_TARGET void Bf16ToFloatAvx512(const uint16_t* x, int64_t n, float* y) {
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(y + i, LoadBf16(x + i, 0xffff));
+  }
+  if (i < n) {
+    __mmask16 mask = TailMask(n - i);
+    _mm512_mask_storeu_ps(y + i, mask, LoadBf16(x + i, mask));
+  }
+}
+
+// The rounding of FloatToBf16Bits on 16 floats.
+AVX512_TARGET __m256i FloatToBf16Avx512(__m512 x) {
+  __m512i bits = _mm512_castps_si512(x);
+  __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(bits, 16),
+                                 _mm512_set1_epi32(1));
+  __m512i rounded = _mm512_srli_epi32(
+      _mm512_add_epi32(_mm512_add_epi32(bits, _mm512_set1_epi32(0x7fff)), lsb),
+      16);
+  __m512i nan = _mm512_or_si512(_mm512_srli_epi32(bits, 16),
+                                _mm512_set1_epi32(0x40));
+  __mmask16 is_nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+  return _mm512_cvtepi32_epi16(_mm512_mask_blend_epi32(is_nan, rounded, nan));
+}
+
+AVX512_TARGET void FloatToBf16Avx512(const float* x, int64_t n, uint16_t* y) {
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i),
+                        FloatToBf16Avx512(_mm512_loadu_ps(x + i)));
+  }
+  if (i < n) {
+    __mmask16 mask = TailMask(n - i);
+    _mm256_mask_storeu_epi16(
+        y + i, mask, FloatToBf16Avx512(_mm512_maskz_loadu_ps(mask, x + i)));
+  }
+}
+
+AVX512_TARGET void Fp16ToFloatAvx512(const uint16_t* x, int64_t n, float* y) {
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+    _mm512_storeu_ps(y + i, _mm512_cvtph_ps(v));
+  }
+  if (i < n) {
+    __mmask16 mask = TailMask(n - i);
+    __m256i v = _mm256_maskz_loadu_epi16(mask, x + i);
+    _mm512_mask_storeu_ps(y + i, mask, _mm512_cvtph_ps(v));
+  }
+}
+
+AVX512_TARGET void FloatToFp16Avx512(const float* x, int64_t n, uint16_t* y) {
+  constexpr int kRound = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i),
+                        _mm512_cvtps_ph(_mm512_loadu_ps(x + i), kRound));
+  }
+  if (i < n) {
+    __mmask16 mask = TailMask(n - i);
+    __m512 v = _mm512_maskz_loadu_ps(mask, x + i);
+    _mm256_mask_storeu_epi16(y + i, mask, _mm512_cvtps_ph(v, kRound));
+  }
+}
+
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512_BF16
+
+#define AVX512_BF16_TARGET \
+  __attribute__((target("avx512f,avx512bw,avx512vl,avx512bf16")))
+
+AVX512_BF16_TARGET __m256i FloatToBf16Native(__m512 x) {
+  return (__m256i)_mm512_cvtneps_pbh(x);
+}
+
+AVX512_BF16_TARGET void FloatToBf16Native(const float* x,
+                                          int64_t n,
+                                          uint16_t* y) {
+  int64_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i),
+                        FloatToBf16Native(_mm512_loadu_ps(x + i)));
+  }
+  if (i < n) {
+    __mmask16 mask = TailMask(n - i);
+    _mm256_mask_storeu_epi16(
+        y + i, mask, FloatToBf16Native(_mm512_maskz_loadu_ps(mask, x + i)));
+  }
+}
+
+// Columns of B computed per panel, one float per column in a zmm register.
+constexpr int kPanelWidth = 16;
+// Rows of A sharing the loads of a packed panel.
+constexpr int kRowBlock = 4;
+
+// Packs the columns [n0, n0 + nb) of op(B) into the layout vdpbf16ps
+// consumes: for every pair of rows, 16 columns x the 2 elements of a column.
+// The missing rows and columns are filled with zeros.
+AVX512_TARGET void PackPanel(int64_t K,
+                             int64_t N,
+                             bool trans_b,
+                             const uint16_t* B,
+                             int64_t n0,
+                             int64_t nb,
+                             uint16_t* panel) {
+  const int64_t K2 = (K + 1) / 2;
+  int64_t k2_full = 0;
+  if (!trans_b && nb == kPanelWidth) {
+    k2_full = K / 2;
+    for (int64_t k2 = 0; k2 < k2_full; ++k2) {
+      const uint16_t* b = B + 2 * k2 * N + n0;
+      __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+      __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + N));
+      __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 8));
+      __m128i r3 =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + N + 8));
+      __m128i* dst = reinterpret_cast<__m128i*>(panel + 32 * k2);
+      _mm_storeu_si128(dst, _mm_unpacklo_epi16(r0, r1));
+      _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(r0, r1));
+      _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(r2, r3));
+      _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(r2, r3));
+    }
+  }
+  for (int64_t k2 = k2_full; k2 < K2; ++k2) {
+    uint16_t* dst = panel + 32 * k2;
+    for (int64_t j = 0; j < kPanelWidth; ++j) {
+      for (int64_t i = 0; i < 2; ++i) {
+        const int64_t k = 2 * k2 + i;
+        const int64_t n = n0 + j;
+        uint16_t v = 0;
+        if (j < nb && k < K) {
+          v = trans_b ? B[n * K + k] : B[k * N + n];
+        }
+        dst[2 * j + i] = v;
+      }
+    }
+  }
+}
+
+template <int kRows>
+AVX512_BF16_TARGET void ComputeRows(int64_t K,
+                                    const uint16_t* A,
+                                    const uint16_t* panel,
+                                    float alpha,
+                                    float beta,
+                                    __mmask16 mask,
+                                    uint16_t* C,
+                                    int64_t ldc) {
+  __m512 acc[kRows];
+  for (int i = 0; i < kRows; ++i) {
+    acc[i] = _mm512_setzero_ps();
+  }
+  const int64_t k2_full = K / 2;
+  for (int64_t k2 = 0; k2 < k2_full; ++k2) {
+    const __m512bh b = (__m512bh)_mm512_loadu_si512(panel + 32 * k2);
+    for (int i = 0; i < kRows; ++i) {
+      int32_t a2;
+      std::memcpy(&a2, A + i * K + 2 * k2, sizeof(a2));
+      acc[i] = _mm512_dpbf16_ps(acc[i], (__m512bh)_mm512_set1_epi32(a2), b);
+    }
+  }
+  if (K % 2 != 0) {
+    // The packed row past K is zeros, so is the element of A past K.
+    const __m512bh b = (__m512bh)_mm512_loadu_si512(panel + 32 * k2_full);
+    for (int i = 0; i < kRows; ++i) {
+      int32_t a2 = 0;
+      std::memcpy(&a2, A + i * K + 2 * k2_full, sizeof(uint16_t));
+      acc[i] = _mm512_dpbf16_ps(acc[i], (__m512bh)_mm512_set1_epi32(a2), b);
+    }
+  }
+  const __m512 alpha_v = _mm512_set1_ps(alpha);
+  const __m512 beta_v = _mm512_set1_ps(beta);
+  for (int i = 0; i < kRows; ++i) {
+    __m512 c = _mm512_mul_ps(acc[i], alpha_v);
+    if (beta != 0.f) {
+      c = _mm512_fmadd_ps(beta_v, LoadBf16(C + i * ldc, mask), c);
+    }
+    _mm256_mask_storeu_epi16(C + i * ldc, mask, FloatToBf16Native(c));
+  }
+}
+
+// The few rows of A, as in the decoding of a token, read B once rather than
+// pack it. Without trans_b, a block of 64 columns of C is accumulated in
+// float from the rows of B, and with trans_b, an element of C is the dot
+// product of the rows of A and of B.
+constexpr int kSmallRowsVectors = 8;
+constexpr int kSmallRowsWidth = kSmallRowsVectors * kPanelWidth;
+
+template <int kRows>
+AVX512_BF16_TARGET void ComputeSmallRows(int64_t K,
+                                         int64_t N,
+                                         const uint16_t* A,
+                                         const uint16_t* B,
+                                         int64_t n0,
+                                         int64_t nb,
+                                         float alpha,
+                                         float beta,
+                                         uint16_t* C) {
+  __mmask16 masks[kSmallRowsVectors];
+  for (int j = 0; j < kSmallRowsVectors; ++j) {
+    masks[j] = TailMask(
+        std::max<int64_t>(0, std::min<int64_t>(kPanelWidth, nb - 16 * j)));
+  }
+  __m512 acc[kRows][kSmallRowsVectors];
+  for (int i = 0; i < kRows; ++i) {
+    for (int j = 0; j < kSmallRowsVectors; ++j) {
+      acc[i][j] = _mm512_setzero_ps();
+    }
+  }
+  for (int64_t k = 0; k < K; ++k) {
+    __m512 a[kRows];
+    for (int i = 0; i < kRows; ++i) {
+      a[i] = _mm512_set1_ps(Bf16BitsToFloat(A[i * K + k]));
+    }
+    for (int j = 0; j < kSmallRowsVectors; ++j) {
+      const __m512 b = LoadBf16(B + k * N + n0 + 16 * j, masks[j]);
+      for (int i = 0; i < kRows; ++i) {
+        acc[i][j] = _mm512_fmadd_ps(a[i], b, acc[i][j]);
+      }
+    }
+  }
+  const __m512 alpha_v = _mm512_set1_ps(alpha);
+  const __m512 beta_v = _mm512_set1_ps(beta);
+  for (int i = 0; i < kRows; ++i) {
+    for (int j = 0; j < kSmallRowsVectors; ++j) {
+      uint16_t* c = C + i * N + n0 + 16 * j;
+      __m512 v = _mm512_mul_ps(acc[i][j], alpha_v);
+      if (beta != 0.f) {
+        v = _mm512_fmadd_ps(beta_v, LoadBf16(c, masks[j]), v);
+      }
+      _mm256_mask_storeu_epi16(c, masks[j], FloatToBf16Native(v));
+    }
+  }
+}
+
+AVX512_BF16_TARGET float DotBf16(int64_t K,
+                                 const uint16_t* a,
+                                 const uint16_t* b) {
+  __m512 acc = _mm512_setzero_ps();
+  int64_t k = 0;
+  for (; k + 32 <= K; k += 32) {
+    acc = _mm512_dpbf16_ps(acc,
+                           (__m512bh)_mm512_loadu_si512(a + k),
+                           (__m512bh)_mm512_loadu_si512(b + k));
+  }
+  if (k < K) {
+    const __mmask32 mask = static_cast<__mmask32>((1ULL << (K - k)) - 1);
+    acc = _mm512_dpbf16_ps(acc,
+                           (__m512bh)_mm512_maskz_loadu_epi16(mask, a + k),
+                           (__m512bh)_mm512_maskz_loadu_epi16(mask, b + k));
+  }
+  return _mm512_reduce_add_ps(acc);
+}
+
+void GemmBf16SmallRows(const CPUContext& dev_ctx,
+                       bool trans_b,
+                       int64_t M,
+                       int64_t N,
+                       int64_t K,
+                       float alpha,
+                       const uint16_t* A,
+                       const uint16_t* B,
+                       float beta,
+                       uint16_t* C) {
+  if (trans_b) {
+    dev_ctx.ParallelFor(
+        0,
+        N,
+        std::max<int64_t>(1, kConvertGrainSize / std::max<int64_t>(K, 1)),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t n = begin; n < end; ++n) {
+            for (int64_t m = 0; m < M; ++m) {
+              float v = alpha * DotBf16(K, A + m * K, B + n * K);
+              if (beta != 0.f) {
+                v += beta * Bf16BitsToFloat(C[m * N + n]);
+              }
+              C[m * N + n] = FloatToBf16Bits(v);
+            }
+          }
+        });
+    return;
+  }
+  const int64_t blocks = (N + kSmallRowsWidth - 1) / kSmallRowsWidth;
+  dev_ctx.ParallelFor(
+      0,
+      blocks,
+      std::max<int64_t>(
+          1, kConvertGrainSize / (kSmallRowsWidth * std::max<int64_t>(K, 1))),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t block = begin; block < end; ++block) {
+          const int64_t n0 = block * kSmallRowsWidth;
+          const int64_t nb = std::min<int64_t>(kSmallRowsWidth, N - n0);
+          switch (M) {
+            case 3:
+              ComputeSmallRows<3>(K, N, A, B, n0, nb, alpha, beta, C);
+              break;
+            case 2:
+              ComputeSmallRows<2>(K, N, A, B, n0, nb, alpha, beta, C);
+              break;
+            default:
+              ComputeSmallRows<1>(K, N, A, B, n0, nb, alpha, beta, C);
+              break;
+          }
+        }
+      });
+}
+
+void GemmBf16Native(const CPUContext& dev_ctx,
+                    bool trans_a,
+                    bool trans_b,
+                    int64_t M,
+                    int64_t N,
+                    int64_t K,
+                    float alpha,
+                    const uint16_t* A,
+                    const uint16_t* B,
+                    float beta,
+                    uint16_t* C) {
+  // The pairs of A are read from its rows.
+  std::vector<uint16_t> a_transposed;
+  if (trans_a) {
+    a_transposed.resize(M * K);
+    for (int64_t k = 0; k < K; ++k) {
+      for (int64_t m = 0; m < M; ++m) {
+        a_transposed[m * K + k] = A[k * M + m];
+      }
+    }
+    A = a_transposed.data();
+  }
+  if (M < kRowBlock) {
+    GemmBf16SmallRows(dev_ctx, trans_b, M, N, K, alpha, A, B, beta, C);
+    return;
+  }
+  const int64_t K2 = (K + 1) / 2;
+  const int64_t panels = (N + kPanelWidth - 1) / kPanelWidth;
+  const int64_t panel_size = 2 * kPanelWidth * K2;
+  std::vector<uint16_t> packed(panels * panel_size);
+  dev_ctx.ParallelFor(
+      0,
+      panels,
+      std::max<int64_t>(1, kConvertGrainSize / std::max<int64_t>(K, 1)),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t p = begin; p < end; ++p) {
+          const int64_t n0 = p * kPanelWidth;
+          PackPanel(K,
+                    N,
+                    trans_b,
+                    B,
+                    n0,
+                    std::min<int64_t>(kPanelWidth, N - n0),
+                    packed.data() + p * panel_size);
+        }
+      });
+
+  // The tasks are the row blocks of each panel, those of a panel being
+  // adjacent so that they share its loads from the cache.
+  const int64_t row_blocks = (M + kRowBlock - 1) / kRowBlock;
+  const int64_t grain_size = std::max<int64_t>(
+      1, kConvertGrainSize / (kRowBlock * std::max<int64_t>(K, 1)));
+  dev_ctx.ParallelFor(
+      0, panels * row_blocks, grain_size, [&](int64_t begin, int64_t end) {
+        for (int64_t t = begin; t < end; ++t) {
+          const int64_t p = t / row_blocks;
+          const int64_t m = (t % row_blocks) * kRowBlock;
+          const int64_t n0 = p * kPanelWidth;
+          const uint16_t* panel = packed.data() + p * panel_size;
+          const uint16_t* a = A + m * K;
+          uint16_t* c = C + m * N + n0;
+          const __mmask16 mask =
+              TailMask(std::min<int64_t>(kPanelWidth, N - n0));
+          switch (std::min<int64_t>(kRowBlock, M - m)) {
+            case 4:
+              ComputeRows<4>(K, a, panel, alpha, beta, mask, c, N);
+              break;
+            case 3:
+              ComputeRows<3>(K, a, panel, alpha, beta, mask, c, N);
+              break;
+            case 2:
+              ComputeRows<2>(K, a, panel, alpha, beta, mask, c, N);
+              break;
+            default:
+              ComputeRows<1>(K, a, panel, alpha, beta, mask, c, N);
+              break;
+          }
+        }
+      });
+}
+
+#endif  // PADDLE_CPU_LOW_PRECISION_AVX512_BF16
+
+#endif  // PADDLE_CPU_LOW_PRECISION_AVX512
+
+template <typename T>
+void ParallelConvertToFloat(const CPUContext& dev_ctx,
+                            const T* x,
+                            int64_t n,
+                            float* y) {
+  dev_ctx.ParallelFor(
+      0, n, kConvertGrainSize, [&](int64_t begin, int64_t end) {
+        ConvertToFloat(x + begin, end - begin, y + begin);
+      });
+}
+
+template <typename T>
+void ParallelConvertFromFloat(const CPUContext& dev_ctx,
+                              const float* x,
+                              int64_t n,
+                              T* y) {
+  dev_ctx.ParallelFor(
+      0, n, kConvertGrainSize, [&](int64_t begin, int64_t end) {
+        ConvertFromFloat(x + begin, end - begin, y + begin);
+      });
+}
+
+template <typename T>
+void GemmAsFloat(const CPUContext& dev_ctx,
+                 bool trans_a,
+                 bool trans_b,
+                 int64_t M,
+                 int64_t N,
+                 int64_t K,
+                 float alpha,
+                 const T* A,
+                 const T* B,
+                 float beta,
+                 T* C) {
+  std::vector<float> a(M * K);
+  std::vector<float> b(K * N);
+  std::vector<float> c(M * N);
+  ParallelConvertToFloat(dev_ctx, A, M * K, a.data());
+  ParallelConvertToFloat(dev_ctx, B, K * N, b.data());
+  if (beta != 0.f) {
+    ParallelConvertToFloat(dev_ctx, C, M * N, c.data());
+  }
+  auto blas = GetBlas<CPUContext, float>(dev_ctx);
+  blas.GEMM(trans_a ? CblasTrans : CblasNoTrans,
+            trans_b ? CblasTrans : CblasNoTrans,
+            static_cast<int>(M),
+            static_cast<int>(N),
+            static_cast<int>(K),
+            alpha,
+            a.data(),
+            b.data(),
+            beta,
+            c.data());
+  ParallelConvertFromFloat(dev_ctx, c.data(), M * N, C);
+}
+
+// Runs the GEMM on the dot products of the CPU if it has some for T, and
+// returns whether it did.
+bool GemmNative(const CPUContext& dev_ctx,
+                bool trans_a,
+                bool trans_b,
+                int64_t M,
+                int64_t N,
+                int64_t K,
+                float alpha,
+                const dtype::bfloat16* A,
+                const dtype::bfloat16* B,
+                float beta,
+                dtype::bfloat16* C) {
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512_BF16
+  if (CpuUseAvx512Bf16()) {
+    GemmBf16Native(dev_ctx,
+                   trans_a,
+                   trans_b,
+                   M,
+                   N,
+                   K,
+                   alpha,
+                   reinterpret_cast<const uint16_t*>(A),
+                   reinterpret_cast<const uint16_t*>(B),
+                   beta,
+                   reinterpret_cast<uint16_t*>(C));
+    return true;
+  }
+#endif
+  return false;
+}
+
+bool GemmNative(const CPUContext& dev_ctx,
+                bool trans_a,
+                bool trans_b,
+                int64_t M,
+                int64_t N,
+                int64_t K,
+                float alpha,
+                const dtype::float16* A,
+                const dtype::float16* B,
+                float beta,
+                dtype::float16* C) {
+  return false;
+}
+
+}  // namespace
+
+void ConvertToFloat(const dtype::bfloat16* x, int64_t n, float* y) {
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512
+  if (UseAvx512()) {
+    Bf16ToFloatAvx512(reinterpret_cast<const uint16_t*>(x), n, y);
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = static_cast<float>(x[i]);
+  }
+}
+
+void ConvertToFloat(const dtype::float16* x, int64_t n, float* y) {
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512
+  if (UseAvx512()) {
+    Fp16ToFloatAvx512(reinterpret_cast<const uint16_t*>(x), n, y);
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = static_cast<float>(x[i]);
+  }
+}
+
+void ConvertFromFloat(const float* x, int64_t n, dtype::bfloat16* y) {
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512_BF16
+  if (CpuUseAvx512Bf16()) {
+    FloatToBf16Native(x, n, reinterpret_cast<uint16_t*>(y));
+    return;
+  }
+#endif
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512
+  if (UseAvx512()) {
+    FloatToBf16Avx512(x, n, reinterpret_cast<uint16_t*>(y));
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = dtype::raw_uint16_to_bfloat16(FloatToBf16Bits(x[i]));
+  }
+}
+
+void ConvertFromFloat(const float* x, int64_t n, dtype::float16* y) {
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512
+  if (UseAvx512()) {
+    FloatToFp16Avx512(x, n, reinterpret_cast<uint16_t*>(y));
+    return;
+  }
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = static_cast<dtype::float16>(x[i]);
+  }
+}
+
+bool CpuUseAvx512Bf16() {
+#ifdef PADDLE_CPU_LOW_PRECISION_AVX512_BF16
+  static const bool use_avx512_bf16 =
+      paddle::platform::MayIUse(paddle::platform::avx512_bf16);
+  return use_avx512_bf16;
+#else
+  return false;
+#endif
+}
+
+DenseTensor ToFloat(const CPUContext& dev_ctx, const DenseTensor& x) {
+  DenseTensor out;
+  out.Resize(x.dims());
+  float* y = dev_ctx.Alloc<float>(&out);
+  if (x.dtype() == DataType::BFLOAT16) {
+    ParallelConvertToFloat(dev_ctx, x.data<dtype::bfloat16>(), x.numel(), y);
+  } else if (x.dtype() == DataType::FLOAT16) {
+    ParallelConvertToFloat(dev_ctx, x.data<dtype::float16>(), x.numel(), y);
+  } else {
+    PADDLE_THROW(phi::errors::InvalidArgument(
+        "ToFloat converts a bfloat16 or float16 tensor, but got %s.",
+        x.dtype()));
+  }
+  return out;
+}
+
+template <typename T>
+void FromFloat(const CPUContext& dev_ctx,
+               const DenseTensor& x,
+               DenseTensor* out) {
+  PADDLE_ENFORCE_EQ(x.numel(),
+                    out->numel(),
+                    phi::errors::InvalidArgument(
+                        "The numel of out (%d) must be that of x (%d).",
+                        out->numel(),
+                        x.numel()));
+  T* y = dev_ctx.Alloc<T>(out);
+  ParallelConvertFromFloat(dev_ctx, x.data<float>(), x.numel(), y);
+}
+
+template void FromFloat<dtype::bfloat16>(const CPUContext&,
+                                         const DenseTensor&,
+                                         DenseTensor*);
+template void FromFloat<dtype::float16>(const CPUContext&,
+                                        const DenseTensor&,
+                                        DenseTensor*);
+
+template <typename T>
+void LowPrecisionGemm(const CPUContext& dev_ctx,
+                      bool trans_a,
+                      bool trans_b,
+                      int64_t M,
+                      int64_t N,
+                      int64_t K,
+                      float alpha,
+                      const T* A,
+                      const T* B,
+                      float beta,
+                      T* C) {
+  if (M == 0 || N == 0) {
+    return;
+  }
+  if (!GemmNative(
+          dev_ctx, trans_a, trans_b, M, N, K, alpha, A, B, beta, C)) {
+    GemmAsFloat(dev_ctx, trans_a, trans_b, M, N, K, alpha, A, B, beta, C);
+  }
+}
+
+#define INSTANTIATE_LOW_PRECISION_GEMM(T)                           \
+  template void LowPrecisionGemm<T>(const CPUContext&,              \
+                                    bool,                           \
+                                    bool,                           \
+                                    int64_t,                        \
+                                    int64_t,                        \
+                                    int64_t,                        \
+                                    float,                          \
+                                    const T*,                       \
+                                    const T*,                       \
+                                    float,                          \
+                                    T*)
+
+INSTANTIATE_LOW_PRECISION_GEMM(dtype::bfloat16);
+INSTANTIATE_LOW_PRECISION_GEMM(dtype::float16);
+
+#undef INSTANTIATE_LOW_PRECISION_GEMM
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,123 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+// The functions below let the CPU kernels store bfloat16 and float16
+// tensors, which halves the bytes they move, while computing in float.
+// They pick their instructions when first called: the conversions use
+// AVX512-BF16 or AVX512F, and the bfloat16 GEMM the vdpbf16ps dot products
+// of AVX512-BF16, when the CPU supports them.
+
+// Converts n elements to float.
+void ConvertToFloat(const dtype::bfloat16* x, int64_t n, float* y);
+void ConvertToFloat(const dtype::float16* x, int64_t n, float* y);
+
+// Converts n floats. bfloat16 is rounded to the nearest even, where its
+// constructor truncates, and so is float16 on the CPUs with AVX512F. NaNs
+// stay NaNs, and the AVX512-BF16 instructions flush the denormals to zero.
+void ConvertFromFloat(const float* x, int64_t n, dtype::bfloat16* y);
+void ConvertFromFloat(const float* x, int64_t n, dtype::float16* y);
+
+// Whether the conversions and LowPrecisionGemm of bfloat16 run with the
+// AVX512-BF16 instructions, which this CPU and the compiler support.
+bool CpuUseAvx512Bf16();
+
+// The conversions of a tensor, running in parallel on the threads of
+// dev_ctx. ToFloat returns a float copy of x, whose dtype is bfloat16 or
+// float16, and FromFloat writes x, a float tensor, to out as T.
+DenseTensor ToFloat(const CPUContext& dev_ctx, const DenseTensor& x);
+
+template <typename T>
+void FromFloat(const CPUContext& dev_ctx,
+               const DenseTensor& x,
+               DenseTensor* out);
+
+// The elements converted to float at a time by TransformAsFloat.
+constexpr int64_t kLowPrecisionBlockSize = 1024;
+
+// Calls func(float* block, int64_t n) on the blocks of x, converted to
+// float, then converts the blocks func computed in place to out, which may
+// be x. The blocks run in parallel on the threads of dev_ctx.
+template <typename T, typename Func>
+void TransformAsFloat(
+    const CPUContext& dev_ctx, const T* x, int64_t n, T* out, Func func) {
+  dev_ctx.ParallelFor(
+      0, n, kLowPrecisionBlockSize * 4, [&](int64_t begin, int64_t end) {
+        float block[kLowPrecisionBlockSize];
+        for (int64_t i = begin; i < end; i += kLowPrecisionBlockSize) {
+          int64_t len = std::min(kLowPrecisionBlockSize, end - i);
+          ConvertToFloat(x + i, len, block);
+          func(block, len);
+          ConvertFromFloat(block, len, out + i);
+        }
+      });
+}
+
+// The binary TransformAsFloat, calling func(float* x_block,
+// const float* y_block, int64_t n) to compute the block of out in x_block.
+template <typename T, typename Func>
+void TransformAsFloat(const CPUContext& dev_ctx,
+                      const T* x,
+                      const T* y,
+                      int64_t n,
+                      T* out,
+                      Func func) {
+  dev_ctx.ParallelFor(
+      0, n, kLowPrecisionBlockSize * 4, [&](int64_t begin, int64_t end) {
+        float x_block[kLowPrecisionBlockSize];
+        float y_block[kLowPrecisionBlockSize];
+        for (int64_t i = begin; i < end; i += kLowPrecisionBlockSize) {
+          int64_t len = std::min(kLowPrecisionBlockSize, end - i);
+          ConvertToFloat(x + i, len, x_block);
+          ConvertToFloat(y + i, len, y_block);
+          func(x_block, y_block, len);
+          ConvertFromFloat(x_block, len, out + i);
+        }
+      });
+}
+
+// C = alpha * op(A) * op(B) + beta * C, where op(A) is M x K, op(B) is
+// K x N and all of them are row major, the products being accumulated in
+// float. bfloat16 runs on vdpbf16ps when the CPU supports it, with B packed
+// into panels of 16 columns and the panels running in parallel on the
+// threads of dev_ctx; below 4 rows of op(A), B is read in place. Otherwise,
+// and for float16, the matrices are converted to float for the float GEMM
+// of blas.
+template <typename T>
+void LowPrecisionGemm(const CPUContext& dev_ctx,
+                      bool trans_a,
+                      bool trans_b,
+                      int64_t M,
+                      int64_t N,
+                      int64_t K,
+                      float alpha,
+                      const T* A,
+                      const T* B,
+                      float beta,
+                      T* C);
+
+}  // namespace funcs
+}  // namespace phi
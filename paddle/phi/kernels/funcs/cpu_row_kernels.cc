@@ -0,0 +1,664 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_row_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+#include "paddle/phi/kernels/funcs/detail/activation_functions.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The elements given to a thread at least.
+constexpr int64_t kRowKernelGrainSize = 32768;
+// The shifted logits are clipped to it, as the Eigen softmax does.
+constexpr double kShiftedLogitMin = -64.;
+// The rows of log_softmax at least this long compute the max and the sum in
+// one pass, which costs a second exp per element but saves reading a row
+// that no longer fits in the cache. The shorter rows compute them in two.
+constexpr int64_t kOnlineLogSoftmaxMinCols = 16384;
+
+int64_t RowGrainSize(int64_t cols) {
+  return std::max<int64_t>(1, kRowKernelGrainSize / std::max<int64_t>(cols, 1));
+}
+
+template <typename T>
+T RowMax(const T* x, int64_t n) {
+  return *std::max_element(x, x + n);
+}
+
+template <typename T>
+T RowSum(const T* x, int64_t n) {
+  T sum = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    sum += x[i];
+  }
+  return sum;
+}
+
+template <typename T>
+T RowDot(const T* x, const T* y, int64_t n) {
+  T sum = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+// out = exp(x - max), returns the sum of out.
+template <typename T>
+T RowExpSum(const T* x, T max, T* out, int64_t n) {
+  const T min = static_cast<T>(kShiftedLogitMin);
+  T sum = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = std::exp(std::max(x[i] - max, min));
+    sum += out[i];
+  }
+  return sum;
+}
+
+// Computes the max of x and the sum of exp(x - max) in one pass, rescaling
+// the sum when the max grows.
+template <typename T>
+void RowOnlineMaxSum(const T* x, int64_t n, T* max, T* sum) {
+  T m = x[0];
+  T s = 1;
+  for (int64_t i = 1; i < n; ++i) {
+    if (x[i] > m) {
+      s = s * std::exp(m - x[i]) + 1;
+      m = x[i];
+    } else {
+      s += std::exp(x[i] - m);
+    }
+  }
+  *max = m;
+  *sum = s;
+}
+
+// x_grad = out_grad - exp(out) * sum.
+template <typename T>
+void RowLogSoftmaxGrad(
+    const T* out, const T* out_grad, T sum, T* x_grad, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    x_grad[i] = out_grad[i] - std::exp(out[i]) * sum;
+  }
+}
+
+// Computes the mean and the variance of x in one pass. The elements are
+// shifted by the first one, so that a large mean costs no precision.
+template <typename T>
+void RowMoments(const T* x, int64_t n, T* mean, T* var) {
+  const T shift = x[0];
+  T sum = 0;
+  T square_sum = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    T value = x[i] - shift;
+    sum += value;
+    square_sum += value * value;
+  }
+  T shifted_mean = sum / n;
+  *mean = shift + shifted_mean;
+  *var = std::max(square_sum / n - shifted_mean * shifted_mean, T(0));
+}
+
+#ifdef __AVX__
+
+constexpr int64_t kAVXBlock = 8;
+
+float HorizontalSum(__m256 value) {
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(value),
+                          _mm256_extractf128_ps(value, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+}
+
+float HorizontalMax(__m256 value) {
+  __m128 max = _mm_max_ps(_mm256_castps256_ps128(value),
+                          _mm256_extractf128_ps(value, 1));
+  max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+  max = _mm_max_ss(max, _mm_shuffle_ps(max, max, 1));
+  return _mm_cvtss_f32(max);
+}
+
+float RowMax(const float* x, int64_t n) {
+  if (n < kAVXBlock) {
+    return *std::max_element(x, x + n);
+  }
+  __m256 max = _mm256_loadu_ps(x);
+  int64_t i = kAVXBlock;
+  for (; i + kAVXBlock <= n; i += kAVXBlock) {
+    max = _mm256_max_ps(max, _mm256_loadu_ps(x + i));
+  }
+  float result = HorizontalMax(max);
+  for (; i < n; ++i) {
+    result = std::max(result, x[i]);
+  }
+  return result;
+}
+
+float RowSum(const float* x, int64_t n) {
+  __m256 sum = _mm256_setzero_ps();
+  int64_t i = 0;
+  for (; i + kAVXBlock <= n; i += kAVXBlock) {
+    sum = _mm256_add_ps(sum, _mm256_loadu_ps(x + i));
+  }
+  float result = HorizontalSum(sum);
+  for (; i < n; ++i) {
+    result += x[i];
+  }
+  return result;
+}
+
+float RowDot(const float* x, const float* y, int64_t n) {
+  __m256 sum = _mm256_setzero_ps();
+  int64_t i = 0;
+  for (; i + kAVXBlock <= n; i += kAVXBlock) {
+    sum = _mm256_add_ps(
+        sum, _mm256_mul_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+  }
+  float result = HorizontalSum(sum);
+  for (; i < n; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+}
+
+float RowExpSum(const float* x, float max, float* out, int64_t n) {
+  const float min = static_cast<float>(kShiftedLogitMin);
+  const __m256 shift = _mm256_set1_ps(max);
+  const __m256 lower = _mm256_set1_ps(min);
+  __m256 sum = _mm256_setzero_ps();
+  int64_t i = 0;
+  for (; i + kAVXBlock <= n; i += kAVXBlock) {
+    __m256 value = _mm256_sub_ps(_mm256_loadu_ps(x + i), shift);
+    value = detail::Exp(_mm256_max_ps(value, lower));
+    _mm256_storeu_ps(out + i, value);
+    sum = _mm256_add_ps(sum, value);
+  }
+  float result = HorizontalSum(sum);
+  for (; i < n; ++i) {
+    out[i] = std::exp(std::max(x[i] - max, min));
+    result += out[i];
+  }
+  return result;
+}
+
+// Each lane keeps its own max and sum, which are merged at the end.
+void RowOnlineMaxSum(const float* x, int64_t n, float* max, float* sum) {
+  if (n < kAVXBlock) {
+    RowOnlineMaxSum<float>(x, n, max, sum);
+    return;
+  }
+  __m256 lane_max = _mm256_loadu_ps(x);
+  __m256 lane_sum = _mm256_set1_ps(1.f);
+  int64_t i = kAVXBlock;
+  for (; i + kAVXBlock <= n; i += kAVXBlock) {
+    __m256 value = _mm256_loadu_ps(x + i);
+    __m256 new_max = _mm256_max_ps(lane_max, value);
+    lane_sum = _mm256_add_ps(
+        _mm256_mul_ps(lane_sum, detail::Exp(_mm256_sub_ps(lane_max, new_max))),
+        detail::Exp(_mm256_sub_ps(value, new_max)));
+    lane_max = new_max;
+  }
+  float m = HorizontalMax(lane_max);
+  __m256 scaled = _mm256_mul_ps(
+      lane_sum,
+      detail::Exp(_mm256_sub_ps(lane_max, _mm256_set1_ps(m))));
+  float s = HorizontalSum(scaled);
+  for (; i < n; ++i) {
+    if (x[i] > m) {
+      s = s * std::exp(m - x[i]) + 1.f;
+      m = x[i];
+    } else {
+      s += std::exp(x[i] - m);
+    }
+  }
+  *max = m;
+  *sum = s;
+}
+
+void RowLogSoftmaxGrad(const float* out,
+                       const float* out_grad,
+                       float sum,
+                       float* x_grad,
+                       int64_t n) {
+  const __m256 scale = _mm256_set1_ps(sum);
+  int64_t i = 0;
+  for (; i + kAVXBlock <= n; i += kAVXBlock) {
+    __m256 value = detail::Exp(_mm256_loadu_ps(out + i));
+    value = _mm256_sub_ps(_mm256_loadu_ps(out_grad + i),
+                          _mm256_mul_ps(value, scale));
+    _mm256_storeu_ps(x_grad + i, value);
+  }
+  for (; i < n; ++i) {
+    x_grad[i] = out_grad[i] - std::exp(out[i]) * sum;
+  }
+}
+
+void RowMoments(const float* x, int64_t n, float* mean, float* var) {
+  const float shift_value = x[0];
+  const __m256 shift = _mm256_set1_ps(shift_value);
+  __m256 lane_sum = _mm256_setzero_ps();
+  __m256 lane_square_sum = _mm256_setzero_ps();
+  int64_t i = 0;
+  for (; i + kAVXBlock <= n; i += kAVXBlock) {
+    __m256 value = _mm256_sub_ps(_mm256_loadu_ps(x + i), shift);
+    lane_sum = _mm256_add_ps(lane_sum, value);
+    lane_square_sum =
+        _mm256_add_ps(lane_square_sum, _mm256_mul_ps(value, value));
+  }
+  float sum = HorizontalSum(lane_sum);
+  float square_sum = HorizontalSum(lane_square_sum);
+  for (; i < n; ++i) {
+    float value = x[i] - shift_value;
+    sum += value;
+    square_sum += value * value;
+  }
+  float shifted_mean = sum / n;
+  *mean = shift_value + shifted_mean;
+  *var = std::max(square_sum / n - shifted_mean * shifted_mean, 0.f);
+}
+
+#endif  // __AVX__
+
+template <typename T>
+void SoftmaxRow(const T* x, T* out, int64_t cols) {
+  T max = RowMax(x, cols);
+  T scale = static_cast<T>(1) / RowExpSum(x, max, out, cols);
+  for (int64_t i = 0; i < cols; ++i) {
+    out[i] *= scale;
+  }
+}
+
+template <typename T>
+void LayerNormRow(const T* x,
+                  const T* scale,
+                  const T* bias,
+                  float epsilon,
+                  T* y,
+                  T* mean,
+                  T* var,
+                  int64_t cols) {
+  RowMoments(x, cols, mean, var);
+  const T row_mean = *mean;
+  const T rstd = static_cast<T>(1) / std::sqrt(*var + static_cast<T>(epsilon));
+  if (scale && bias) {
+    for (int64_t i = 0; i < cols; ++i) {
+      y[i] = (x[i] - row_mean) * rstd * scale[i] + bias[i];
+    }
+  } else if (scale) {
+    for (int64_t i = 0; i < cols; ++i) {
+      y[i] = (x[i] - row_mean) * rstd * scale[i];
+    }
+  } else if (bias) {
+    for (int64_t i = 0; i < cols; ++i) {
+      y[i] = (x[i] - row_mean) * rstd + bias[i];
+    }
+  } else {
+    for (int64_t i = 0; i < cols; ++i) {
+      y[i] = (x[i] - row_mean) * rstd;
+    }
+  }
+}
+
+template <typename T>
+void SoftmaxRowsAsFloat(const CPUContext& dev_ctx,
+                        const T* x,
+                        T* out,
+                        int64_t rows,
+                        int64_t cols) {
+  if (cols == 0) {
+    return;
+  }
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        std::vector<float> x_row(cols);
+        std::vector<float> out_row(cols);
+        for (int64_t row = begin; row < end; ++row) {
+          ConvertToFloat(x + row * cols, cols, x_row.data());
+          SoftmaxRow(x_row.data(), out_row.data(), cols);
+          ConvertFromFloat(out_row.data(), cols, out + row * cols);
+        }
+      });
+}
+
+template <typename T>
+void LayerNormRowsAsFloat(const CPUContext& dev_ctx,
+                          const T* x,
+                          const T* scale,
+                          const T* bias,
+                          float epsilon,
+                          T* y,
+                          T* mean,
+                          T* var,
+                          int64_t rows,
+                          int64_t cols) {
+  if (cols == 0) {
+    return;
+  }
+  std::vector<float> scale_float(scale ? cols : 0);
+  std::vector<float> bias_float(bias ? cols : 0);
+  if (scale) {
+    ConvertToFloat(scale, cols, scale_float.data());
+  }
+  if (bias) {
+    ConvertToFloat(bias, cols, bias_float.data());
+  }
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        std::vector<float> x_row(cols);
+        std::vector<float> y_row(cols);
+        for (int64_t row = begin; row < end; ++row) {
+          float row_mean;
+          float row_var;
+          ConvertToFloat(x + row * cols, cols, x_row.data());
+          LayerNormRow<float>(x_row.data(),
+                              scale ? scale_float.data() : nullptr,
+                              bias ? bias_float.data() : nullptr,
+                              epsilon,
+                              y_row.data(),
+                              &row_mean,
+                              &row_var,
+                              cols);
+          ConvertFromFloat(y_row.data(), cols, y + row * cols);
+          ConvertFromFloat(&row_mean, 1, mean + row);
+          ConvertFromFloat(&row_var, 1, var + row);
+        }
+      });
+}
+
+}  // namespace
+
+template <typename T>
+void SoftmaxRows(const CPUContext& dev_ctx,
+                 const T* x,
+                 T* out,
+                 int64_t rows,
+                 int64_t cols) {
+  if (cols == 0) {
+    return;
+  }
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          SoftmaxRow(x + row * cols, out + row * cols, cols);
+        }
+      });
+}
+
+template <typename T>
+void LogSoftmaxRows(const CPUContext& dev_ctx,
+                    const T* x,
+                    T* out,
+                    int64_t rows,
+                    int64_t cols) {
+  if (cols == 0) {
+    return;
+  }
+  const T min = static_cast<T>(kShiftedLogitMin);
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          const T* x_row = x + row * cols;
+          T* out_row = out + row * cols;
+          T max;
+          T sum;
+          if (cols >= kOnlineLogSoftmaxMinCols) {
+            RowOnlineMaxSum(x_row, cols, &max, &sum);
+          } else {
+            // out_row holds the exp until it is overwritten below.
+            max = RowMax(x_row, cols);
+            sum = RowExpSum(x_row, max, out_row, cols);
+          }
+          T log_sum = std::log(sum);
+          for (int64_t i = 0; i < cols; ++i) {
+            out_row[i] = std::max(x_row[i] - max, min) - log_sum;
+          }
+        }
+      });
+}
+
+template <typename T>
+void SoftmaxGradRows(const CPUContext& dev_ctx,
+                     const T* out,
+                     const T* out_grad,
+                     T* x_grad,
+                     int64_t rows,
+                     int64_t cols) {
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          const T* out_row = out + row * cols;
+          const T* out_grad_row = out_grad + row * cols;
+          T* x_grad_row = x_grad + row * cols;
+          T dot = RowDot(out_row, out_grad_row, cols);
+          for (int64_t i = 0; i < cols; ++i) {
+            x_grad_row[i] = (out_grad_row[i] - dot) * out_row[i];
+          }
+        }
+      });
+}
+
+template <typename T>
+void LogSoftmaxGradRows(const CPUContext& dev_ctx,
+                        const T* out,
+                        const T* out_grad,
+                        T* x_grad,
+                        int64_t rows,
+                        int64_t cols) {
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          const T* out_grad_row = out_grad + row * cols;
+          T sum = RowSum(out_grad_row, cols);
+          RowLogSoftmaxGrad(
+              out + row * cols, out_grad_row, sum, x_grad + row * cols, cols);
+        }
+      });
+}
+
+template <typename T>
+void LayerNormRows(const CPUContext& dev_ctx,
+                   const T* x,
+                   const T* scale,
+                   const T* bias,
+                   float epsilon,
+                   T* y,
+                   T* mean,
+                   T* var,
+                   int64_t rows,
+                   int64_t cols) {
+  if (cols == 0) {
+    return;
+  }
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        for (int64_t row = begin; row < end; ++row) {
+          LayerNormRow(x + row * cols,
+                       scale,
+                       bias,
+                       epsilon,
+                       y + row * cols,
+                       mean + row,
+                       var + row,
+                       cols);
+        }
+      });
+}
+
+template <typename T>
+void LayerNormGradRows(const CPUContext& dev_ctx,
+                       const T* x,
+                       const T* mean,
+                       const T* var,
+                       const T* scale,
+                       const T* y_grad,
+                       float epsilon,
+                       T* x_grad,
+                       T* scale_grad,
+                       T* bias_grad,
+                       int64_t rows,
+                       int64_t cols) {
+  if (cols == 0) {
+    return;
+  }
+  std::vector<T> rstd(rows);
+  for (int64_t row = 0; row < rows; ++row) {
+    rstd[row] =
+        static_cast<T>(1) / std::sqrt(var[row] + static_cast<T>(epsilon));
+  }
+
+  if (x_grad) {
+    // x_grad = rstd * (g - mean(g) - x_norm * mean(g * x_norm)), where g is
+    // y_grad * scale.
+    dev_ctx.ParallelFor(
+        0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+          for (int64_t row = begin; row < end; ++row) {
+            const T* x_row = x + row * cols;
+            const T* y_grad_row = y_grad + row * cols;
+            T* x_grad_row = x_grad + row * cols;
+            const T row_mean = mean[row];
+            const T row_rstd = rstd[row];
+            // x_grad_row holds g until the second pass.
+            if (scale) {
+              for (int64_t i = 0; i < cols; ++i) {
+                x_grad_row[i] = y_grad_row[i] * scale[i];
+              }
+            } else {
+              std::copy(y_grad_row, y_grad_row + cols, x_grad_row);
+            }
+            T grad_sum = 0;
+            T grad_norm_sum = 0;
+            for (int64_t i = 0; i < cols; ++i) {
+              grad_sum += x_grad_row[i];
+              grad_norm_sum += x_grad_row[i] * (x_row[i] - row_mean);
+            }
+            const T grad_mean = grad_sum / cols;
+            const T grad_norm_mean = grad_norm_sum * row_rstd / cols;
+            for (int64_t i = 0; i < cols; ++i) {
+              T x_norm = (x_row[i] - row_mean) * row_rstd;
+              x_grad_row[i] = row_rstd * (x_grad_row[i] - grad_mean -
+                                          x_norm * grad_norm_mean);
+            }
+          }
+        });
+  }
+
+  if (scale_grad || bias_grad) {
+    // Each thread sums all the rows of a block of columns, so that no
+    // partial sums need merging.
+    int64_t grain_size =
+        std::max<int64_t>(16, kRowKernelGrainSize / std::max<int64_t>(rows, 1));
+    dev_ctx.ParallelFor(0, cols, grain_size, [&](int64_t begin, int64_t end) {
+      if (scale_grad) {
+        std::fill(scale_grad + begin, scale_grad + end, static_cast<T>(0));
+      }
+      if (bias_grad) {
+        std::fill(bias_grad + begin, bias_grad + end, static_cast<T>(0));
+      }
+      for (int64_t row = 0; row < rows; ++row) {
+        const T* x_row = x + row * cols;
+        const T* y_grad_row = y_grad + row * cols;
+        const T row_mean = mean[row];
+        const T row_rstd = rstd[row];
+        if (scale_grad) {
+          for (int64_t i = begin; i < end; ++i) {
+            scale_grad[i] += y_grad_row[i] * (x_row[i] - row_mean) * row_rstd;
+          }
+        }
+        if (bias_grad) {
+          for (int64_t i = begin; i < end; ++i) {
+            bias_grad[i] += y_grad_row[i];
+          }
+        }
+      }
+    });
+  }
+}
+
+#define INSTANTIATE_ROW_KERNELS(T)                                      \
+  template void SoftmaxRows<T>(                                         \
+      const CPUContext&, const T*, T*, int64_t, int64_t);               \
+  template void LogSoftmaxRows<T>(                                      \
+      const CPUContext&, const T*, T*, int64_t, int64_t);               \
+  template void SoftmaxGradRows<T>(                                     \
+      const CPUContext&, const T*, const T*, T*, int64_t, int64_t);     \
+  template void LogSoftmaxGradRows<T>(                                  \
+      const CPUContext&, const T*, const T*, T*, int64_t, int64_t);     \
+  template void LayerNormRows<T>(const CPUContext&,                     \
+                                 const T*,                              \
+                                 const T*,                              \
+                                 const T*,                              \
+                                 float,                                 \
+                                 T*,                                    \
+                                 T*,                                    \
+                                 T*,                                    \
+                                 int64_t,                               \
+                                 int64_t);                              \
+  template void LayerNormGradRows<T>(const CPUContext&,                 \
+                                     const T*,                          \
+                                     const T*,                          \
+                                     const T*,                          \
+                                     const T*,                          \
+                                     const T*,                          \
+                                     float,                             \
+                                     T*,                                \
+                                     T*,                                \
+                                     T*,                                \
+                                     int64_t,                           \
+                                     int64_t)
+
+INSTANTIATE_ROW_KERNELS(float);
+INSTANTIATE_ROW_KERNELS(double);
+
+#undef INSTANTIATE_ROW_KERNELS
+
+#define SPECIALIZE_ROW_KERNELS_AS_FLOAT(T)                              \
+  template <>                                                           \
+  void SoftmaxRows<T>(const CPUContext& dev_ctx,                        \
+                      const T* x,                                       \
+                      T* out,                                           \
+                      int64_t rows,                                     \
+                      int64_t cols) {                                   \
+    SoftmaxRowsAsFloat(dev_ctx, x, out, rows, cols);                    \
+  }                                                                     \
+  template <>                                                           \
+  void LayerNormRows<T>(const CPUContext& dev_ctx,                      \
+                        const T* x,                                     \
+                        const T* scale,                                 \
+                        const T* bias,                                  \
+                        float epsilon,                                  \
+                        T* y,                                           \
+                        T* mean,                                        \
+                        T* var,                                         \
+                        int64_t rows,                                   \
+                        int64_t cols) {                                 \
+    LayerNormRowsAsFloat(                                               \
+        dev_ctx, x, scale, bias, epsilon, y, mean, var, rows, cols);    \
+  }
+
+SPECIALIZE_ROW_KERNELS_AS_FLOAT(dtype::bfloat16)
+SPECIALIZE_ROW_KERNELS_AS_FLOAT(dtype::float16)
+
+#undef SPECIALIZE_ROW_KERNELS_AS_FLOAT
+
+}  // namespace funcs
+}  // namespace phi
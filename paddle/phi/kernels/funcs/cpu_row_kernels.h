@@ -0,0 +1,140 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace phi {
+namespace funcs {
+
+// The kernels below compute a row-wise op over a {rows, cols} matrix, i.e.
+// an op along the last axis of a tensor. The rows run in parallel on the
+// threads of dev_ctx, and each row is read at most twice. The float kernels
+// use AVX, including the vectorized exp of avx_mathfun.h, when paddle is
+// compiled with AVX.
+
+// out = softmax(x), in two passes: the max, then the exp and its sum.
+template <typename T>
+void SoftmaxRows(const CPUContext& dev_ctx,
+                 const T* x,
+                 T* out,
+                 int64_t rows,
+                 int64_t cols);
+
+// out = log_softmax(x). The max and the sum of the exp are computed online
+// in one pass for the long rows, then the output in another.
+template <typename T>
+void LogSoftmaxRows(const CPUContext& dev_ctx,
+                    const T* x,
+                    T* out,
+                    int64_t rows,
+                    int64_t cols);
+
+// x_grad = (out_grad - sum(out_grad * out)) * out.
+template <typename T>
+void SoftmaxGradRows(const CPUContext& dev_ctx,
+                     const T* out,
+                     const T* out_grad,
+                     T* x_grad,
+                     int64_t rows,
+                     int64_t cols);
+
+// x_grad = out_grad - exp(out) * sum(out_grad).
+template <typename T>
+void LogSoftmaxGradRows(const CPUContext& dev_ctx,
+                        const T* out,
+                        const T* out_grad,
+                        T* x_grad,
+                        int64_t rows,
+                        int64_t cols);
+
+// y = (x - mean) / sqrt(var + epsilon) * scale + bias, where scale and bias
+// may be null. The mean and the variance of each row are computed in one
+// pass and written to mean and var.
+template <typename T>
+void LayerNormRows(const CPUContext& dev_ctx,
+                   const T* x,
+                   const T* scale,
+                   const T* bias,
+                   float epsilon,
+                   T* y,
+                   T* mean,
+                   T* var,
+                   int64_t rows,
+                   int64_t cols);
+
+// The grad of LayerNormRows. Any of x_grad, scale_grad and bias_grad may be
+// null, and so may scale.
+template <typename T>
+void LayerNormGradRows(const CPUContext& dev_ctx,
+                       const T* x,
+                       const T* mean,
+                       const T* var,
+                       const T* scale,
+                       const T* y_grad,
+                       float epsilon,
+                       T* x_grad,
+                       T* scale_grad,
+                       T* bias_grad,
+                       int64_t rows,
+                       int64_t cols);
+
+// SoftmaxRows and LayerNormRows of bfloat16 and float16 convert each row to
+// float, compute it as a float row and round it back, so that only the
+// tensors are stored in low precision.
+template <>
+void SoftmaxRows<dtype::bfloat16>(const CPUContext& dev_ctx,
+                                  const dtype::bfloat16* x,
+                                  dtype::bfloat16* out,
+                                  int64_t rows,
+                                  int64_t cols);
+
+template <>
+void SoftmaxRows<dtype::float16>(const CPUContext& dev_ctx,
+                                 const dtype::float16* x,
+                                 dtype::float16* out,
+                                 int64_t rows,
+                                 int64_t cols);
+
+template <>
+void LayerNormRows<dtype::bfloat16>(const CPUContext& dev_ctx,
+                                    const dtype::bfloat16* x,
+                                    const dtype::bfloat16* scale,
+                                    const dtype::bfloat16* bias,
+                                    float epsilon,
+                                    dtype::bfloat16* y,
+                                    dtype::bfloat16* mean,
+                                    dtype::bfloat16* var,
+                                    int64_t rows,
+                                    int64_t cols);
+
+template <>
+void LayerNormRows<dtype::float16>(const CPUContext& dev_ctx,
+                                   const dtype::float16* x,
+                                   const dtype::float16* scale,
+                                   const dtype::float16* bias,
+                                   float epsilon,
+                                   dtype::float16* y,
+                                   dtype::float16* mean,
+                                   dtype::float16* var,
+                                   int64_t rows,
+                                   int64_t cols);
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,472 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_selection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// A heap keeps the k smallest keys when k * kHeapMinRatio <= cols, since
+// few of the keys streamed then enter the heap.
+constexpr int64_t kHeapMinRatio = 16;
+// The columns of a chunk of a long row given to a thread at least.
+constexpr int64_t kSelectChunkCols = 1 << 16;
+// The elements given to a thread at least.
+constexpr int64_t kSelectionGrainSize = 1 << 14;
+
+int64_t DivUp(int64_t a, int64_t b) { return (a + b - 1) / b; }
+
+int64_t RowGrainSize(int64_t cols) {
+  return std::max<int64_t>(1,
+                           kSelectionGrainSize / std::max<int64_t>(cols, 1));
+}
+
+// Maps each element to an unsigned key of the same order, with NaN above
+// every number and -0 equal to +0.
+inline uint32_t OrderedKey(float value) {
+  if (std::isnan(value)) {
+    return 0xFFFFFFFFu;
+  }
+  if (value == 0.f) {
+    value = 0.f;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline uint64_t OrderedKey(double value) {
+  if (std::isnan(value)) {
+    return 0xFFFFFFFFFFFFFFFFull;
+  }
+  if (value == 0.) {
+    value = 0.;
+  }
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x8000000000000000ull) ? ~bits
+                                        : (bits | 0x8000000000000000ull);
+}
+
+inline uint32_t OrderedKey(int32_t value) {
+  return static_cast<uint32_t>(value) ^ 0x80000000u;
+}
+
+inline uint64_t OrderedKey(int64_t value) {
+  return static_cast<uint64_t>(value) ^ 0x8000000000000000ull;
+}
+
+// An entry pairs a key with its index, and entries compare by key, then by
+// index. The 32-bit keys and the index pack into one uint64_t, since the
+// rows are shorter than 2^32.
+template <typename Key>
+struct EntryTraits;
+
+template <>
+struct EntryTraits<uint32_t> {
+  using Entry = uint64_t;
+  static Entry Make(uint32_t key, int64_t index) {
+    return (static_cast<uint64_t>(key) << 32) | static_cast<uint64_t>(index);
+  }
+  static uint32_t Key(Entry entry) { return entry >> 32; }
+  static int64_t Index(Entry entry) { return entry & 0xFFFFFFFFu; }
+  static Entry Max() { return 0xFFFFFFFFFFFFFFFFull; }
+};
+
+template <>
+struct EntryTraits<uint64_t> {
+  using Entry = std::pair<uint64_t, int64_t>;
+  static Entry Make(uint64_t key, int64_t index) { return {key, index}; }
+  static uint64_t Key(const Entry& entry) { return entry.first; }
+  static int64_t Index(const Entry& entry) { return entry.second; }
+  static Entry Max() { return {0xFFFFFFFFFFFFFFFFull, INT64_MAX}; }
+};
+
+// Replaces the largest entry of the max-heap [first, first + n) by entry,
+// sifting it down with a single pass.
+template <typename Entry>
+void ReplaceHeapTop(Entry* first, int64_t n, Entry entry) {
+  int64_t hole = 0;
+  int64_t child = 1;
+  while (child < n) {
+    if (child + 1 < n && first[child] < first[child + 1]) {
+      ++child;
+    }
+    if (!(entry < first[child])) {
+      break;
+    }
+    first[hole] = first[child];
+    hole = child;
+    child = 2 * hole + 1;
+  }
+  first[hole] = entry;
+}
+
+// Selects the smallest entries of the rows of x, whose keys are inverted
+// for the largest ones. It keeps the buffers of a thread across rows.
+template <typename T>
+class RowSelector {
+ public:
+  using Key = decltype(OrderedKey(T()));
+  using Traits = EntryTraits<Key>;
+  using Entry = typename Traits::Entry;
+
+  explicit RowSelector(bool descending) : descending_(descending) {}
+
+  Key KeyOf(T value) const {
+    Key key = OrderedKey(value);
+    return descending_ ? ~key : key;
+  }
+
+  // Appends the entries of [begin, end) of row to *out, sorted.
+  void Sort(const T* row,
+            int64_t begin,
+            int64_t end,
+            std::vector<Entry>* out) {
+    SortToEntries(row, begin, end);
+    out->insert(out->end(), entries_.begin(), entries_.end());
+  }
+
+  // Appends the k smallest entries of [begin, end) of row to *out, in an
+  // unspecified order unless k covers the whole range.
+  void Select(const T* row,
+              int64_t begin,
+              int64_t end,
+              int64_t k,
+              std::vector<Entry>* out) {
+    const int64_t n = end - begin;
+    if (k >= n) {
+      SortToEntries(row, begin, end);
+      out->insert(
+          out->end(), entries_.begin(), entries_.begin() + std::min(k, n));
+    } else if (k * kHeapMinRatio <= n) {
+      SelectByHeap(row, begin, end, k, out);
+    } else {
+      SelectByRadix(row, begin, end, k, out);
+    }
+  }
+
+ private:
+  void SortToEntries(const T* row, int64_t begin, int64_t end) {
+    entries_.clear();
+    for (int64_t j = begin; j < end; ++j) {
+      entries_.push_back(Traits::Make(KeyOf(row[j]), j));
+    }
+    std::sort(entries_.begin(), entries_.end());
+  }
+
+  // Streams the row through a max-heap of the k smallest entries so far.
+  void SelectByHeap(const T* row,
+                    int64_t begin,
+                    int64_t end,
+                    int64_t k,
+                    std::vector<Entry>* out) {
+    entries_.clear();
+    for (int64_t j = begin; j < begin + k; ++j) {
+      entries_.push_back(Traits::Make(KeyOf(row[j]), j));
+    }
+    std::make_heap(entries_.begin(), entries_.end());
+    Key threshold = Traits::Key(entries_.front());
+    for (int64_t j = begin + k; j < end; ++j) {
+      // An equal key has a larger index than every entry of the heap.
+      Key key = KeyOf(row[j]);
+      if (key < threshold) {
+        ReplaceHeapTop(entries_.data(), k, Traits::Make(key, j));
+        threshold = Traits::Key(entries_.front());
+      }
+    }
+    out->insert(out->end(), entries_.begin(), entries_.end());
+  }
+
+  // Finds the key of the k-th smallest entry 8 bits at a time, from the
+  // highest ones, counting only the keys whose higher bits match so far.
+  void SelectByRadix(const T* row,
+                     int64_t begin,
+                     int64_t end,
+                     int64_t k,
+                     std::vector<Entry>* out) {
+    constexpr int kBits = sizeof(Key) * 8;
+    const int64_t n = end - begin;
+    keys_.resize(n);
+    int64_t counts[256] = {0};
+    for (int64_t j = 0; j < n; ++j) {
+      keys_[j] = KeyOf(row[begin + j]);
+      ++counts[keys_[j] >> (kBits - 8)];
+    }
+
+    Key prefix = 0;
+    Key mask = 0;
+    // The entries still to select among the keys matching prefix.
+    int64_t remaining = k;
+    for (int shift = kBits - 8;; shift -= 8) {
+      int digit = 0;
+      while (counts[digit] < remaining) {
+        remaining -= counts[digit];
+        ++digit;
+      }
+      prefix |= static_cast<Key>(digit) << shift;
+      mask |= static_cast<Key>(0xFF) << shift;
+      if (shift == 0 || counts[digit] == remaining) {
+        break;
+      }
+      // Keeps the positions of the keys matching the new prefix.
+      if (shift == kBits - 8) {
+        candidates_.clear();
+        for (int64_t j = 0; j < n; ++j) {
+          if ((keys_[j] & mask) == prefix) {
+            candidates_.push_back(j);
+          }
+        }
+      } else {
+        int64_t kept = 0;
+        for (int64_t j : candidates_) {
+          if ((keys_[j] & mask) == prefix) {
+            candidates_[kept++] = j;
+          }
+        }
+        candidates_.resize(kept);
+      }
+      std::fill(counts, counts + 256, 0);
+      for (int64_t j : candidates_) {
+        ++counts[(keys_[j] >> (shift - 8)) & 0xFF];
+      }
+    }
+
+    // Every key below the prefix, and the first remaining ones matching it.
+    for (int64_t j = 0; j < n; ++j) {
+      Key masked = keys_[j] & mask;
+      if (masked < prefix || (masked == prefix && remaining-- > 0)) {
+        out->push_back(Traits::Make(keys_[j], begin + j));
+      }
+    }
+  }
+
+  bool descending_;
+  std::vector<Key> keys_;
+  std::vector<int64_t> candidates_;
+  std::vector<Entry> entries_;
+};
+
+template <typename T, typename Entry>
+void WriteEntries(const T* row,
+                  const Entry* entries,
+                  int64_t n,
+                  T* values,
+                  int64_t* indices) {
+  using Traits = typename RowSelector<T>::Traits;
+  for (int64_t i = 0; i < n; ++i) {
+    int64_t index = Traits::Index(entries[i]);
+    values[i] = row[index];
+    indices[i] = index;
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void TopKRows(const CPUContext& dev_ctx,
+              const T* x,
+              int64_t rows,
+              int64_t cols,
+              int64_t k,
+              bool largest,
+              bool sorted,
+              T* values,
+              int64_t* indices) {
+  using Entry = typename RowSelector<T>::Entry;
+  // The rows fewer than the threads are split into chunks of at least
+  // kSelectChunkCols, whose k entries are merged after.
+  const int64_t chunks = std::min<int64_t>(
+      DivUp(GetIntraOpNumThreads(), std::max<int64_t>(rows, 1)),
+      cols / kSelectChunkCols);
+  if (chunks <= 1 || k * 8 > cols / chunks) {
+    dev_ctx.ParallelFor(
+        0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+          RowSelector<T> selector(largest);
+          std::vector<Entry> entries;
+          for (int64_t r = begin; r < end; ++r) {
+            entries.clear();
+            selector.Select(x + r * cols, 0, cols, k, &entries);
+            if (sorted) {
+              std::sort(entries.begin(), entries.end());
+            }
+            WriteEntries(x + r * cols,
+                         entries.data(),
+                         k,
+                         values + r * k,
+                         indices + r * k);
+          }
+        });
+    return;
+  }
+
+  // Selects k entries of each chunk, and then k of the entries of the
+  // chunks of each row.
+  const int64_t chunk_cols = DivUp(cols, chunks);
+  std::vector<Entry> candidates(rows * chunks * k);
+  std::vector<int64_t> counts(rows * chunks);
+  dev_ctx.ParallelFor(0, rows * chunks, 1, [&](int64_t begin, int64_t end) {
+    RowSelector<T> selector(largest);
+    std::vector<Entry> entries;
+    for (int64_t unit = begin; unit < end; ++unit) {
+      int64_t r = unit / chunks;
+      int64_t col_begin = unit % chunks * chunk_cols;
+      int64_t col_end = std::min(cols, col_begin + chunk_cols);
+      entries.clear();
+      selector.Select(x + r * cols,
+                      col_begin,
+                      col_end,
+                      std::min(k, col_end - col_begin),
+                      &entries);
+      std::copy(entries.begin(), entries.end(), candidates.begin() + unit * k);
+      counts[unit] = entries.size();
+    }
+  });
+  dev_ctx.ParallelFor(0, rows, 1, [&](int64_t begin, int64_t end) {
+    std::vector<Entry> entries;
+    for (int64_t r = begin; r < end; ++r) {
+      entries.clear();
+      for (int64_t unit = r * chunks; unit < (r + 1) * chunks; ++unit) {
+        auto first = candidates.begin() + unit * k;
+        entries.insert(entries.end(), first, first + counts[unit]);
+      }
+      std::nth_element(entries.begin(), entries.begin() + k, entries.end());
+      entries.resize(k);
+      if (sorted) {
+        std::sort(entries.begin(), entries.end());
+      }
+      WriteEntries(
+          x + r * cols, entries.data(), k, values + r * k, indices + r * k);
+    }
+  });
+}
+
+template <typename T>
+void SortRows(const CPUContext& dev_ctx,
+              const T* x,
+              int64_t rows,
+              int64_t cols,
+              bool descending,
+              T* values,
+              int64_t* indices) {
+  using Entry = typename RowSelector<T>::Entry;
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        RowSelector<T> selector(descending);
+        std::vector<Entry> entries;
+        for (int64_t r = begin; r < end; ++r) {
+          entries.clear();
+          selector.Sort(x + r * cols, 0, cols, &entries);
+          WriteEntries(x + r * cols,
+                       entries.data(),
+                       cols,
+                       values + r * cols,
+                       indices + r * cols);
+        }
+      });
+}
+
+template <typename T>
+void KthValueRows(const CPUContext& dev_ctx,
+                  const T* x,
+                  int64_t rows,
+                  int64_t cols,
+                  int64_t k,
+                  T* values,
+                  int64_t* indices) {
+  using Entry = typename RowSelector<T>::Entry;
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        RowSelector<T> selector(false);
+        std::vector<Entry> entries;
+        for (int64_t r = begin; r < end; ++r) {
+          entries.clear();
+          selector.Select(x + r * cols, 0, cols, k, &entries);
+          auto kth = std::max_element(entries.begin(), entries.end());
+          WriteEntries(x + r * cols, &*kth, 1, values + r, indices + r);
+        }
+      });
+}
+
+template <typename T>
+void ModeRows(const CPUContext& dev_ctx,
+              const T* x,
+              int64_t rows,
+              int64_t cols,
+              T* values,
+              int64_t* indices) {
+  using Entry = typename RowSelector<T>::Entry;
+  using Traits = typename RowSelector<T>::Traits;
+  dev_ctx.ParallelFor(
+      0, rows, RowGrainSize(cols), [&](int64_t begin, int64_t end) {
+        RowSelector<T> selector(false);
+        std::vector<Entry> entries;
+        for (int64_t r = begin; r < end; ++r) {
+          const T* row = x + r * cols;
+          entries.clear();
+          selector.Sort(row, 0, cols, &entries);
+          // NaN differs from itself, so that each NaN is a run of its own.
+          int64_t mode = 0;
+          int64_t max_count = 0;
+          int64_t count = 0;
+          for (int64_t i = 0; i < cols; ++i) {
+            ++count;
+            if (i == cols - 1 || row[Traits::Index(entries[i + 1])] !=
+                                     row[Traits::Index(entries[i])]) {
+              if (count > max_count) {
+                max_count = count;
+                mode = i;
+              }
+              count = 0;
+            }
+          }
+          WriteEntries(row, entries.data() + mode, 1, values + r, indices + r);
+        }
+      });
+}
+
+#define INSTANTIATE_SELECTION_KERNELS(T)                                      \
+  template void TopKRows<T>(const CPUContext&,                                \
+                            const T*,                                         \
+                            int64_t,                                          \
+                            int64_t,                                          \
+                            int64_t,                                          \
+                            bool,                                             \
+                            bool,                                             \
+                            T*,                                               \
+                            int64_t*);                                        \
+  template void SortRows<T>(                                                  \
+      const CPUContext&, const T*, int64_t, int64_t, bool, T*, int64_t*);     \
+  template void KthValueRows<T>(                                              \
+      const CPUContext&, const T*, int64_t, int64_t, int64_t, T*, int64_t*);  \
+  template void ModeRows<T>(                                                  \
+      const CPUContext&, const T*, int64_t, int64_t, T*, int64_t*)
+
+INSTANTIATE_SELECTION_KERNELS(float);
+INSTANTIATE_SELECTION_KERNELS(double);
+INSTANTIATE_SELECTION_KERNELS(int32_t);
+INSTANTIATE_SELECTION_KERNELS(int64_t);
+
+#undef INSTANTIATE_SELECTION_KERNELS
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,81 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+namespace funcs {
+
+// The kernels below select or sort the elements of each row of a {rows,
+// cols} matrix, i.e. along the last axis of a tensor, and write their
+// values and indices. NaN is larger than every number, and equal elements
+// are ordered by their indices, as a stable sort would.
+//
+// Each element is mapped to an unsigned key of the same order, which packs
+// with the index of a 32-bit element into one integer to sort, so that a
+// small k of a long row is kept in a heap while streaming the row and a
+// larger k is found by a radix select on the keys. The rows run in
+// parallel on the threads of dev_ctx, and the rows fewer than the threads
+// are split into chunks selected in parallel and merged.
+
+// The k largest, or smallest, elements of each row, sorted if sorted is
+// true and in an unspecified order otherwise. values and indices are
+// {rows, k}.
+template <typename T>
+void TopKRows(const CPUContext& dev_ctx,
+              const T* x,
+              int64_t rows,
+              int64_t cols,
+              int64_t k,
+              bool largest,
+              bool sorted,
+              T* values,
+              int64_t* indices);
+
+// Sorts each row in ascending, or descending, order.
+template <typename T>
+void SortRows(const CPUContext& dev_ctx,
+              const T* x,
+              int64_t rows,
+              int64_t cols,
+              bool descending,
+              T* values,
+              int64_t* indices);
+
+// The k-th smallest element of each row, k counting from 1.
+template <typename T>
+void KthValueRows(const CPUContext& dev_ctx,
+                  const T* x,
+                  int64_t rows,
+                  int64_t cols,
+                  int64_t k,
+                  T* values,
+                  int64_t* indices);
+
+// The most frequent element of each row, the smallest one on ties, and the
+// last index of it.
+template <typename T>
+void ModeRows(const CPUContext& dev_ctx,
+              const T* x,
+              int64_t rows,
+              int64_t cols,
+              T* values,
+              int64_t* indices);
+
+}  // namespace funcs
+}  // namespace phi
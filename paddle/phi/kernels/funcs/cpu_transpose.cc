@@ -0,0 +1,423 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/enforce.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The elements given to a thread at least.
+constexpr int64_t kTransposeGrainSize = 1 << 15;
+// The side of the tiles of the two innermost dims, whose source and
+// destination fit in the L1 cache together.
+constexpr int64_t kTransposeTile = 32;
+
+struct Bytes16 {
+  uint64_t low;
+  uint64_t high;
+};
+
+template <size_t kSize>
+struct ElementOf;
+
+template <>
+struct ElementOf<1> {
+  using type = uint8_t;
+};
+
+template <>
+struct ElementOf<2> {
+  using type = uint16_t;
+};
+
+template <>
+struct ElementOf<4> {
+  using type = uint32_t;
+};
+
+template <>
+struct ElementOf<8> {
+  using type = uint64_t;
+};
+
+template <>
+struct ElementOf<16> {
+  using type = Bytes16;
+};
+
+// A dim of out, and the stride of the same dim in x.
+struct PermutedDim {
+  int64_t size;
+  int64_t in_stride;
+  int64_t out_stride;
+};
+
+// The dims of out whose size is not 1, each run of dims that is contiguous
+// in x merged into one.
+std::vector<PermutedDim> MergeDims(const std::vector<int64_t>& dims,
+                                   const std::vector<int>& axis) {
+  const int rank = dims.size();
+  std::vector<int64_t> in_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+  }
+  std::vector<PermutedDim> merged;
+  for (int i = 0; i < rank; ++i) {
+    int64_t size = dims[axis[i]];
+    int64_t stride = in_strides[axis[i]];
+    if (size == 1) {
+      continue;
+    }
+    if (!merged.empty() && merged.back().in_stride == size * stride) {
+      merged.back().size *= size;
+      merged.back().in_stride = stride;
+    } else {
+      merged.push_back({size, stride, 0});
+    }
+  }
+  int64_t out_stride = 1;
+  for (auto it = merged.rbegin(); it != merged.rend(); ++it) {
+    it->out_stride = out_stride;
+    out_stride *= it->size;
+  }
+  return merged;
+}
+
+// Walks the combinations of the indices of dims in row-major order, and
+// tracks their offsets in x and in out.
+class OuterIndex {
+ public:
+  OuterIndex(const std::vector<PermutedDim>& dims, int64_t index)
+      : dims_(dims), index_(dims.size()) {
+    for (int i = dims_.size() - 1; i >= 0; --i) {
+      index_[i] = index % dims_[i].size;
+      index /= dims_[i].size;
+      in_offset_ += index_[i] * dims_[i].in_stride;
+      out_offset_ += index_[i] * dims_[i].out_stride;
+    }
+  }
+
+  int64_t in_offset() const { return in_offset_; }
+  int64_t out_offset() const { return out_offset_; }
+
+  void Next() {
+    for (int i = dims_.size() - 1; i >= 0; --i) {
+      in_offset_ += dims_[i].in_stride;
+      out_offset_ += dims_[i].out_stride;
+      if (++index_[i] < dims_[i].size) {
+        return;
+      }
+      in_offset_ -= dims_[i].size * dims_[i].in_stride;
+      out_offset_ -= dims_[i].size * dims_[i].out_stride;
+      index_[i] = 0;
+    }
+  }
+
+ private:
+  const std::vector<PermutedDim>& dims_;
+  std::vector<int64_t> index_;
+  int64_t in_offset_{0};
+  int64_t out_offset_{0};
+};
+
+// dst[c * dst_stride + r] = src[r * src_stride + c] for r < rows and
+// c < cols, the inner loop running along the longer side.
+template <typename E>
+void TransposeLoops(const E* src,
+                   int64_t src_stride,
+                   int64_t rows,
+                   int64_t cols,
+                   E* dst,
+                   int64_t dst_stride) {
+  if (rows < cols) {
+    for (int64_t r = 0; r < rows; ++r) {
+      for (int64_t c = 0; c < cols; ++c) {
+        dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
+  } else {
+    for (int64_t c = 0; c < cols; ++c) {
+      for (int64_t r = 0; r < rows; ++r) {
+        dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
+  }
+}
+
+template <typename E>
+void TransposeTile(const E* src,
+                   int64_t src_stride,
+                   int64_t rows,
+                   int64_t cols,
+                   E* dst,
+                   int64_t dst_stride) {
+  TransposeLoops(src, src_stride, rows, cols, dst, dst_stride);
+}
+
+// The 4-byte elements are transposed by square blocks in registers. The
+// shuffles move bits only, so that the float registers serve every type.
+#if defined(__AVX__)
+
+constexpr int64_t kMicroTile = 8;
+
+inline void MicroTranspose(const uint32_t* src,
+                           int64_t src_stride,
+                           uint32_t* dst,
+                           int64_t dst_stride) {
+  const float* in = reinterpret_cast<const float*>(src);
+  float* out = reinterpret_cast<float*>(dst);
+  __m256 r0 = _mm256_loadu_ps(in);
+  __m256 r1 = _mm256_loadu_ps(in + src_stride);
+  __m256 r2 = _mm256_loadu_ps(in + 2 * src_stride);
+  __m256 r3 = _mm256_loadu_ps(in + 3 * src_stride);
+  __m256 r4 = _mm256_loadu_ps(in + 4 * src_stride);
+  __m256 r5 = _mm256_loadu_ps(in + 5 * src_stride);
+  __m256 r6 = _mm256_loadu_ps(in + 6 * src_stride);
+  __m256 r7 = _mm256_loadu_ps(in + 7 * src_stride);
+  // Interleaves the pairs of rows, then the pairs of pairs, in each lane.
+  __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+  __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+  __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+  __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+  __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+  __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+  __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  // Joins the lanes of the rows 0-3 and 4-7.
+  _mm256_storeu_ps(out, _mm256_permute2f128_ps(u0, u4, 0x20));
+  _mm256_storeu_ps(out + dst_stride, _mm256_permute2f128_ps(u1, u5, 0x20));
+  _mm256_storeu_ps(out + 2 * dst_stride,
+                   _mm256_permute2f128_ps(u2, u6, 0x20));
+  _mm256_storeu_ps(out + 3 * dst_stride,
+                   _mm256_permute2f128_ps(u3, u7, 0x20));
+  _mm256_storeu_ps(out + 4 * dst_stride,
+                   _mm256_permute2f128_ps(u0, u4, 0x31));
+  _mm256_storeu_ps(out + 5 * dst_stride,
+                   _mm256_permute2f128_ps(u1, u5, 0x31));
+  _mm256_storeu_ps(out + 6 * dst_stride,
+                   _mm256_permute2f128_ps(u2, u6, 0x31));
+  _mm256_storeu_ps(out + 7 * dst_stride,
+                   _mm256_permute2f128_ps(u3, u7, 0x31));
+}
+
+#elif defined(__SSE__)
+
+constexpr int64_t kMicroTile = 4;
+
+inline void MicroTranspose(const uint32_t* src,
+                           int64_t src_stride,
+                           uint32_t* dst,
+                           int64_t dst_stride) {
+  const float* in = reinterpret_cast<const float*>(src);
+  float* out = reinterpret_cast<float*>(dst);
+  __m128 r0 = _mm_loadu_ps(in);
+  __m128 r1 = _mm_loadu_ps(in + src_stride);
+  __m128 r2 = _mm_loadu_ps(in + 2 * src_stride);
+  __m128 r3 = _mm_loadu_ps(in + 3 * src_stride);
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+  _mm_storeu_ps(out, r0);
+  _mm_storeu_ps(out + dst_stride, r1);
+  _mm_storeu_ps(out + 2 * dst_stride, r2);
+  _mm_storeu_ps(out + 3 * dst_stride, r3);
+}
+
+#endif
+
+#if defined(__AVX__) || defined(__SSE__)
+
+template <>
+void TransposeTile<uint32_t>(const uint32_t* src,
+                             int64_t src_stride,
+                             int64_t rows,
+                             int64_t cols,
+                             uint32_t* dst,
+                             int64_t dst_stride) {
+  int64_t r = 0;
+  for (; r + kMicroTile <= rows; r += kMicroTile) {
+    int64_t c = 0;
+    for (; c + kMicroTile <= cols; c += kMicroTile) {
+      MicroTranspose(src + r * src_stride + c,
+                     src_stride,
+                     dst + c * dst_stride + r,
+                     dst_stride);
+    }
+    if (c < cols) {
+      TransposeLoops(src + r * src_stride + c,
+                     src_stride,
+                     kMicroTile,
+                     cols - c,
+                     dst + c * dst_stride + r,
+                     dst_stride);
+    }
+  }
+  if (r < rows) {
+    TransposeLoops(src + r * src_stride,
+                   src_stride,
+                   rows - r,
+                   cols,
+                   dst + r,
+                   dst_stride);
+  }
+}
+
+#endif
+
+template <typename E>
+void PermuteElements(const CPUContext& dev_ctx,
+                     const E* x,
+                     std::vector<PermutedDim> dims,
+                     E* out) {
+  int64_t numel = 1;
+  for (const auto& dim : dims) {
+    numel *= dim.size;
+  }
+  if (dims.size() <= 1) {
+    dev_ctx.ParallelFor(
+        0, numel, kTransposeGrainSize, [&](int64_t begin, int64_t end) {
+          std::memcpy(out + begin, x + begin, (end - begin) * sizeof(E));
+        });
+    return;
+  }
+
+  // The last dim of out is contiguous in x too, so that its rows are
+  // copied whole.
+  const PermutedDim last = dims.back();
+  if (last.in_stride == 1) {
+    dims.pop_back();
+    const int64_t grain_size =
+        std::max<int64_t>(1, kTransposeGrainSize / last.size);
+    dev_ctx.ParallelFor(
+        0, numel / last.size, grain_size, [&](int64_t begin, int64_t end) {
+          OuterIndex index(dims, begin);
+          for (int64_t row = begin; row < end; ++row) {
+            std::memcpy(out + index.out_offset(),
+                        x + index.in_offset(),
+                        last.size * sizeof(E));
+            index.Next();
+          }
+        });
+    return;
+  }
+
+  // Tiles the plane of the last dim of out, of rows, and the dim of out
+  // that is the last one of x, of cols, for each index of the other dims.
+  auto inner =
+      std::find_if(dims.begin(), dims.end(), [](const PermutedDim& dim) {
+        return dim.in_stride == 1;
+      });
+  const PermutedDim col = *inner;
+  dims.erase(inner);
+  dims.pop_back();
+  const int64_t row_tiles = (last.size + kTransposeTile - 1) / kTransposeTile;
+  const int64_t col_tiles = (col.size + kTransposeTile - 1) / kTransposeTile;
+  const int64_t plane_tiles = row_tiles * col_tiles;
+  const int64_t planes = numel / (last.size * col.size);
+  dev_ctx.ParallelFor(
+      0,
+      planes * plane_tiles,
+      std::max<int64_t>(
+          1, kTransposeGrainSize / (kTransposeTile * kTransposeTile)),
+      [&](int64_t begin, int64_t end) {
+        OuterIndex index(dims, begin / plane_tiles);
+        for (int64_t tile = begin; tile < end; ++tile) {
+          int64_t plane_tile = tile % plane_tiles;
+          if (tile != begin && plane_tile == 0) {
+            index.Next();
+          }
+          int64_t row = plane_tile / col_tiles * kTransposeTile;
+          int64_t col_begin = plane_tile % col_tiles * kTransposeTile;
+          TransposeTile(
+              x + index.in_offset() + row * last.in_stride + col_begin,
+              last.in_stride,
+              std::min(kTransposeTile, last.size - row),
+              std::min(kTransposeTile, col.size - col_begin),
+              out + index.out_offset() + col_begin * col.out_stride + row,
+              col.out_stride);
+        }
+      });
+}
+
+}  // namespace
+
+void Permute(const CPUContext& dev_ctx,
+             const void* x,
+             const std::vector<int64_t>& dims,
+             const std::vector<int>& axis,
+             size_t elem_size,
+             void* out) {
+  PADDLE_ENFORCE_EQ(
+      axis.size(),
+      dims.size(),
+      errors::InvalidArgument("The axis of Permute should have as many "
+                              "elements as the dims %d, but got %d.",
+                              dims.size(),
+                              axis.size()));
+  auto merged = MergeDims(dims, axis);
+  switch (elem_size) {
+#define PERMUTE_ELEMENTS_CASE(SIZE)                                       \
+  case SIZE: {                                                            \
+    using E = typename ElementOf<SIZE>::type;                             \
+    PermuteElements(                                                      \
+        dev_ctx, static_cast<const E*>(x), merged, static_cast<E*>(out)); \
+    break;                                                                \
+  }
+    PERMUTE_ELEMENTS_CASE(1)
+    PERMUTE_ELEMENTS_CASE(2)
+    PERMUTE_ELEMENTS_CASE(4)
+    PERMUTE_ELEMENTS_CASE(8)
+    PERMUTE_ELEMENTS_CASE(16)
+#undef PERMUTE_ELEMENTS_CASE
+    default:
+      PADDLE_THROW(errors::Unimplemented(
+          "Permute does not support elements of %d bytes.", elem_size));
+  }
+}
+
+void Permute(const CPUContext& dev_ctx,
+             const DenseTensor& x,
+             const std::vector<int>& axis,
+             DenseTensor* out) {
+  if (x.numel() == 0) {
+    return;
+  }
+  Permute(dev_ctx,
+          x.data(),
+          phi::vectorize<int64_t>(x.dims()),
+          axis,
+          SizeOf(x.dtype()),
+          out->data());
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,51 @@
+// Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+// Copies x, a row-major tensor of dims, to out, whose dim i is
+// dims[axis[i]]. The elements are moved as elem_size bytes, which is 1, 2,
+// 4, 8 or 16, so that one copy serves every data type.
+//
+// The dims of size 1 are dropped, and the dims adjacent in both x and out
+// are merged. When the last dim stays the last one, rows are copied whole.
+// Otherwise the two dims innermost in x and in out are transposed by
+// square tiles, the 4-byte elements by 8x8 AVX, or 4x4 SSE, transposes in
+// registers. The tiles, or the rows, run in parallel on the threads of
+// dev_ctx.
+void Permute(const CPUContext& dev_ctx,
+             const void* x,
+             const std::vector<int64_t>& dims,
+             const std::vector<int>& axis,
+             size_t elem_size,
+             void* out);
+
+// Permute for tensors, out being allocated already.
+void Permute(const CPUContext& dev_ctx,
+             const DenseTensor& x,
+             const std::vector<int>& axis,
+             DenseTensor* out);
+
+}  // namespace funcs
+}  // namespace phi
@@ -276,6 +276,8 @@ inline DEVICE double activation(double a, double b, int index) {
 #endif  // PADDLE_WITH_CUDA
 
 #ifdef __AVX__
+__m256 Exp(__m256 a);
+
 namespace forward {
 namespace avx {
 __m256 Relu(const __m256 a);
@@ -14,9 +14,14 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/funcs/fc_functor.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/int8_gemm.h"
 
 namespace phi {
 namespace funcs {
@@ -102,5 +107,60 @@ template class FCFunctor<paddle::platform::CPUDeviceContext, double>;
 template class FCFunctor<CPUContext, float>;
 template class FCFunctor<CPUContext, double>;
 
+template <typename T>
+void Int8FCFunctor<T>::operator()(const int M,
+                                  const int N,
+                                  const int K,
+                                  const T* X,
+                                  const float scale_x,
+                                  const int8_t* W,
+                                  const float* scale_w,
+                                  T* Y,
+                                  const T* B,
+                                  bool relu) {
+  // The activations are symmetric int8 shifted by 128 into uint8.
+  constexpr int kZeroPoint = 128;
+  std::vector<uint8_t> x_q(static_cast<size_t>(M) * K);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < M; i++) {
+    const int64_t offset = static_cast<int64_t>(i) * K;
+    const T* x = X + offset;
+    uint8_t* q = x_q.data() + offset;
+    for (int k = 0; k < K; k++) {
+      float v = std::round(static_cast<float>(x[k]) * scale_x);
+      v = std::min(std::max(v, -127.f), 127.f);
+      q[k] = static_cast<uint8_t>(static_cast<int>(v) + kZeroPoint);
+    }
+  }
+
+  std::vector<int32_t> y_q(static_cast<size_t>(M) * N);
+  GemmU8S8S32(M, N, K, x_q.data(), K, kZeroPoint, W, N, y_q.data(), N);
+
+  std::vector<T> inv_scale(N);
+  for (int n = 0; n < N; n++) {
+    inv_scale[n] = static_cast<T>(1.0 / (scale_x * scale_w[n]));
+  }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < M; i++) {
+    const int64_t offset = static_cast<int64_t>(i) * N;
+    const int32_t* src = y_q.data() + offset;
+    T* dst = Y + offset;
+    for (int n = 0; n < N; n++) {
+      T v = static_cast<T>(src[n]) * inv_scale[n];
+      if (B != nullptr) {
+        v += B[n];
+      }
+      dst[n] = (relu && v < 0) ? static_cast<T>(0) : v;
+    }
+  }
+}
+
+template class Int8FCFunctor<float>;
+template class Int8FCFunctor<double>;
+
 }  // namespace funcs
 }  // namespace phi
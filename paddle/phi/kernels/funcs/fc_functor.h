@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include "paddle/fluid/platform/device_context.h"
 
@@ -35,5 +36,23 @@ class FCFunctor {
                   bool weight_pass = false);
 };
 
+// Computes Y = X * W + B on CPU with the int8 weights W, whose column n was
+// quantized as round(w * scale_w[n]). X is quantized with scale_x on the fly,
+// multiplied by W in int32 and dequantized back to T.
+template <typename T>
+class Int8FCFunctor {
+ public:
+  void operator()(const int M,
+                  const int N,
+                  const int K,
+                  const T* X,
+                  const float scale_x,
+                  const int8_t* W,
+                  const float* scale_w,
+                  T* Y,
+                  const T* B = nullptr,
+                  bool relu = false);
+};
+
 }  // namespace funcs
 }  // namespace phi
@@ -0,0 +1,233 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/int8_gemm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "paddle/fluid/platform/cpu_info.h"
+
+// The avx512vnni intrinsics need GCC 8, which cmake/simd.cmake checks.
+#if defined(PADDLE_WITH_AVX512VNNI_INTRINSICS) && !defined(_WIN32) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PADDLE_INT8_GEMM_VNNI
+#endif
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+void GemmU8S8S32Ref(const int M,
+                    const int N,
+                    const int K,
+                    const uint8_t* A,
+                    const int lda,
+                    const int a_zero_point,
+                    const int8_t* B,
+                    const int ldb,
+                    int32_t* C,
+                    const int ldc) {
+  // The offsets are int64_t, so that large matrices do not overflow them.
+  for (int64_t m = 0; m < M; ++m) {
+    int32_t* c = C + m * ldc;
+    std::fill(c, c + N, 0);
+    for (int64_t k = 0; k < K; ++k) {
+      const int32_t a = static_cast<int32_t>(A[m * lda + k]) - a_zero_point;
+      const int8_t* b = B + k * ldb;
+      for (int n = 0; n < N; ++n) {
+        c[n] += a * static_cast<int32_t>(b[n]);
+      }
+    }
+  }
+}
+
+#ifdef PADDLE_INT8_GEMM_VNNI
+
+#define VNNI_TARGET __attribute__((target("avx512f,avx512bw,avx512vnni")))
+
+// Columns of B computed per panel, one int32 per column in a zmm register.
+constexpr int kPanelWidth = 16;
+// Rows of A sharing the loads of a packed panel.
+constexpr int kRowBlock = 4;
+
+// Packs the columns [n0, n0 + nb) of B into the layout vpdpbusd consumes:
+// for every group of 4 rows, 16 columns x 4 consecutive bytes of a column.
+// The missing rows and columns are filled with zeros.
+VNNI_TARGET void PackPanel(const int K,
+                           const int8_t* B,
+                           const int ldb,
+                           const int n0,
+                           const int nb,
+                           int8_t* panel) {
+  const int k4_full = nb == kPanelWidth ? K / 4 : 0;
+  for (int64_t k4 = 0; k4 < k4_full; ++k4) {
+    const int8_t* b = B + 4 * k4 * ldb + n0;
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + ldb));
+    __m128i r2 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 2 * ldb));
+    __m128i r3 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 3 * ldb));
+    __m128i t0 = _mm_unpacklo_epi8(r0, r1);
+    __m128i t1 = _mm_unpackhi_epi8(r0, r1);
+    __m128i t2 = _mm_unpacklo_epi8(r2, r3);
+    __m128i t3 = _mm_unpackhi_epi8(r2, r3);
+    __m128i* dst = reinterpret_cast<__m128i*>(panel + 64 * k4);
+    _mm_storeu_si128(dst, _mm_unpacklo_epi16(t0, t2));
+    _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(t0, t2));
+    _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(t1, t3));
+    _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(t1, t3));
+  }
+  const int K4 = (K + 3) / 4;
+  for (int k4 = k4_full; k4 < K4; ++k4) {
+    int8_t* dst = panel + 64 * k4;
+    for (int j = 0; j < kPanelWidth; ++j) {
+      for (int i = 0; i < 4; ++i) {
+        const int64_t k = 4 * k4 + i;
+        dst[4 * j + i] = (j < nb && k < K) ? B[k * ldb + n0 + j] : 0;
+      }
+    }
+  }
+}
+
+template <int kRows>
+VNNI_TARGET void ComputeRows(const int K,
+                             const uint8_t* A,
+                             const int lda,
+                             const int8_t* panel,
+                             const __m512i compensation,
+                             const __mmask16 mask,
+                             int32_t* C,
+                             const int ldc) {
+  __m512i acc[kRows];
+  for (int i = 0; i < kRows; ++i) {
+    acc[i] = _mm512_setzero_si512();
+  }
+  const int k4_full = K / 4;
+  for (int k4 = 0; k4 < k4_full; ++k4) {
+    const __m512i b = _mm512_loadu_si512(panel + 64 * k4);
+    for (int i = 0; i < kRows; ++i) {
+      int32_t a4;
+      std::memcpy(&a4, A + i * lda + 4 * k4, sizeof(a4));
+      acc[i] = _mm512_dpbusd_epi32(acc[i], _mm512_set1_epi32(a4), b);
+    }
+  }
+  if (K % 4 != 0) {
+    // The packed rows past K are zeros, so are the bytes of A past K.
+    const __m512i b = _mm512_loadu_si512(panel + 64 * k4_full);
+    for (int i = 0; i < kRows; ++i) {
+      int32_t a4 = 0;
+      std::memcpy(&a4, A + i * lda + 4 * k4_full, K % 4);
+      acc[i] = _mm512_dpbusd_epi32(acc[i], _mm512_set1_epi32(a4), b);
+    }
+  }
+  for (int i = 0; i < kRows; ++i) {
+    _mm512_mask_storeu_epi32(
+        C + i * ldc, mask, _mm512_sub_epi32(acc[i], compensation));
+  }
+}
+
+VNNI_TARGET void GemmU8S8S32Vnni(const int M,
+                                 const int N,
+                                 const int K,
+                                 const uint8_t* A,
+                                 const int lda,
+                                 const int a_zero_point,
+                                 const int8_t* B,
+                                 const int ldb,
+                                 int32_t* C,
+                                 const int ldc) {
+  const int K4 = (K + 3) / 4;
+  std::vector<int8_t> panel(64 * K4);
+  const __m512i ones = _mm512_set1_epi8(1);
+  const __m512i zero_point = _mm512_set1_epi32(a_zero_point);
+  for (int n0 = 0; n0 < N; n0 += kPanelWidth) {
+    const int nb = std::min(kPanelWidth, N - n0);
+    PackPanel(K, B, ldb, n0, nb, panel.data());
+    // (A - zp) * B = A * B - zp * colsum(B), so A stays unsigned.
+    __m512i colsum = _mm512_setzero_si512();
+    for (int k4 = 0; k4 < K4; ++k4) {
+      colsum = _mm512_dpbusd_epi32(
+          colsum, ones, _mm512_loadu_si512(panel.data() + 64 * k4));
+    }
+    const __m512i compensation = _mm512_mullo_epi32(colsum, zero_point);
+    const __mmask16 mask = static_cast<__mmask16>((1U << nb) - 1);
+    int64_t m = 0;
+    for (; m + kRowBlock <= M; m += kRowBlock) {
+      ComputeRows<kRowBlock>(K, A + m * lda, lda, panel.data(), compensation,
+                             mask, C + m * ldc + n0, ldc);
+    }
+    switch (M - m) {
+      case 3:
+        ComputeRows<3>(K, A + m * lda, lda, panel.data(), compensation, mask,
+                       C + m * ldc + n0, ldc);
+        break;
+      case 2:
+        ComputeRows<2>(K, A + m * lda, lda, panel.data(), compensation, mask,
+                       C + m * ldc + n0, ldc);
+        break;
+      case 1:
+        ComputeRows<1>(K, A + m * lda, lda, panel.data(), compensation, mask,
+                       C + m * ldc + n0, ldc);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+#endif  // PADDLE_INT8_GEMM_VNNI
+
+}  // namespace
+
+static std::atomic<bool> gemm_u8s8s32_force_ref{false};
+
+void GemmU8S8S32ForceRef(bool force_ref) { gemm_u8s8s32_force_ref = force_ref; }
+
+bool GemmU8S8S32UseVnni() {
+#ifdef PADDLE_INT8_GEMM_VNNI
+  static const bool use_vnni =
+      paddle::platform::MayIUse(paddle::platform::avx512_core_vnni);
+  return use_vnni && !gemm_u8s8s32_force_ref;
+#else
+  return false;
+#endif
+}
+
+void GemmU8S8S32(const int M,
+                 const int N,
+                 const int K,
+                 const uint8_t* A,
+                 const int lda,
+                 const int a_zero_point,
+                 const int8_t* B,
+                 const int ldb,
+                 int32_t* C,
+                 const int ldc) {
+#ifdef PADDLE_INT8_GEMM_VNNI
+  if (GemmU8S8S32UseVnni()) {
+    GemmU8S8S32Vnni(M, N, K, A, lda, a_zero_point, B, ldb, C, ldc);
+    return;
+  }
+#endif
+  GemmU8S8S32Ref(M, N, K, A, lda, a_zero_point, B, ldb, C, ldc);
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,49 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+namespace phi {
+namespace funcs {
+
+// C = (A - a_zero_point) * B, where A is a M x K uint8 matrix, B is a K x N
+// int8 matrix and C is a M x N int32 matrix, all of them row major.
+//
+// The products are accumulated with the AVX512-VNNI instructions when the CPU
+// supports them, and with a plain loop otherwise. Keeping A unsigned is what
+// VNNI requires; an int8 activation x is passed as x + 128 with a zero point
+// of 128.
+void GemmU8S8S32(const int M,
+                 const int N,
+                 const int K,
+                 const uint8_t* A,
+                 const int lda,
+                 const int a_zero_point,
+                 const int8_t* B,
+                 const int ldb,
+                 int32_t* C,
+                 const int ldc);
+
+// Whether GemmU8S8S32 runs with the AVX512-VNNI instructions, which this CPU
+// and the compiler support.
+bool GemmU8S8S32UseVnni();
+
+// Makes GemmU8S8S32 run the plain loop even if the CPU supports VNNI, e.g. to
+// test both paths on the same CPU.
+void GemmU8S8S32ForceRef(bool force_ref);
+
+}  // namespace funcs
+}  // namespace phi
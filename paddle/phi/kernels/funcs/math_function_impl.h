@@ -16,6 +16,7 @@ limitations under the License. */
 #include <memory>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 
 namespace phi {
@@ -41,12 +42,32 @@ void SetConstant<DeviceContext, T>::operator()(
   }
 }
 
+// The CPU contexts transpose by funcs::Permute, and the others return
+// false to shuffle by Eigen.
+inline bool TransposeOnCPU(const phi::CPUContext& context,
+                           const paddle::framework::Tensor& in,
+                           paddle::framework::Tensor* out,
+                           const std::vector<int>& axis) {
+  Permute(context, in, axis, out);
+  return true;
+}
+
+inline bool TransposeOnCPU(const phi::DeviceContext& context,
+                           const paddle::framework::Tensor& in,
+                           paddle::framework::Tensor* out,
+                           const std::vector<int>& axis) {
+  return false;
+}
+
 template <typename DeviceContext, typename T, int Rank>
 void Transpose<DeviceContext, T, Rank>::operator()(
     const DeviceContext& context,
     const paddle::framework::Tensor& in,
     paddle::framework::Tensor* out,
     const std::vector<int>& axis) {
+  if (TransposeOnCPU(context, in, out, axis)) {
+    return;
+  }
   Eigen::array<int, Rank> permute;
   for (int i = 0; i < Rank; i++) {
     permute[i] = axis[i];
@@ -18,6 +18,8 @@
 #define _USE_MATH_DEFINES  // use M_2_SQRTPI on Windows
 #endif
 
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/dense_tensor.h"
 
 namespace phi {
@@ -29,4 +31,20 @@ void GeluKernel(const Context& dev_ctx,
                 const DenseTensor& x,
                 bool approximate,
                 DenseTensor* out);
+
+class CPUContext;
+
+// bfloat16 and float16 are computed in float on CPU, see cpu/gelu_kernel.cc.
+template <>
+void GeluKernel<dtype::bfloat16, CPUContext>(const CPUContext& dev_ctx,
+                                             const DenseTensor& x,
+                                             bool approximate,
+                                             DenseTensor* out);
+
+template <>
+void GeluKernel<dtype::float16, CPUContext>(const CPUContext& dev_ctx,
+                                            const DenseTensor& x,
+                                            bool approximate,
+                                            DenseTensor* out);
+
 }  // namespace phi
@@ -25,17 +25,12 @@ namespace phi {
 #define ToString(x) #x
 
 template <typename T, typename Context, typename Functor>
-void ActivationImpl(const Context& dev_ctx,
-                    const DenseTensor& X,
-                    DenseTensor* Out,
-                    const Functor& functor) {
-  PADDLE_ENFORCE_NOT_NULL(Out,
-                          errors::NotFound("Output Out should not be nullptr"));
-  dev_ctx.template Alloc<T>(Out);
-  auto x = phi::EigenVector<T>::Flatten(
-      GET_DATA_SAFELY(&X, "Input", "X", "Activation"));
-  auto out = phi::EigenVector<T>::Flatten(
-      GET_DATA_SAFELY(Out, "Output", "Out", "Activation"));
+void RunActivationFunctor(const Context& dev_ctx,
+                          const DenseTensor& X,
+                          DenseTensor* Out,
+                          const Functor& functor) {
+  auto x = phi::EigenVector<T>::Flatten(X);
+  auto out = phi::EigenVector<T>::Flatten(*Out);
   auto* place = dev_ctx.eigen_device();
   // use 32bit index to speed up computation
   bool use_32bit_index = out.size() < Eigen::NumTraits<int>::highest();
@@ -47,6 +42,37 @@ void ActivationImpl(const Context& dev_ctx,
   }
 }
 
+// The activations are elementwise, so they run on the chunks of the
+// flattened tensors on the threads of the CPUContext.
+template <typename T, typename Functor>
+void RunActivationFunctor(const CPUContext& dev_ctx,
+                          const DenseTensor& X,
+                          DenseTensor* Out,
+                          const Functor& functor) {
+  const T* x_data = X.data<T>();
+  T* out_data = Out->data<T>();
+  auto* place = dev_ctx.eigen_device();
+  dev_ctx.ParallelFor(0, X.numel(), 32768, [&](int64_t begin, int64_t end) {
+    typename phi::EigenVector<T>::ConstType x(x_data + begin, end - begin);
+    typename phi::EigenVector<T>::Type out(out_data + begin, end - begin);
+    functor(*place, x, out);
+  });
+}
+
+template <typename T, typename Context, typename Functor>
+void ActivationImpl(const Context& dev_ctx,
+                    const DenseTensor& X,
+                    DenseTensor* Out,
+                    const Functor& functor) {
+  PADDLE_ENFORCE_NOT_NULL(Out,
+                          errors::NotFound("Output Out should not be nullptr"));
+  dev_ctx.template Alloc<T>(Out);
+  RunActivationFunctor<T>(dev_ctx,
+                          GET_DATA_SAFELY(&X, "Input", "X", "Activation"),
+                          &GET_DATA_SAFELY(Out, "Output", "Out", "Activation"),
+                          functor);
+}
+
 template <typename T, typename Context>
 void LogitKernel(const Context& dev_ctx,
                  const DenseTensor& x,
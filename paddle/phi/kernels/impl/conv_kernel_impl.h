@@ -20,10 +20,68 @@
 #include "paddle/phi/kernels/cpu/conv_util.h"
 #include "paddle/phi/kernels/funcs/batch_norm_utils.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 
 namespace phi {
 
+// Runs the 2D convolution of the NCHW tensors with one of the algorithms of
+// funcs/cpu_conv.h, if one fits better than im2col and GEMM. Returns false
+// otherwise.
+template <typename T, typename Context>
+bool RunConv2dAlgorithm(const Context& dev_ctx,
+                        const DenseTensor& input,
+                        const DenseTensor& filter,
+                        const std::vector<int>& strides,
+                        const std::vector<int>& paddings,
+                        const std::vector<int>& dilations,
+                        int groups,
+                        DenseTensor* output) {
+  return false;
+}
+
+template <typename T>
+bool RunConv2dAlgorithm(const CPUContext& dev_ctx,
+                        const DenseTensor& input,
+                        const DenseTensor& filter,
+                        const std::vector<int>& strides,
+                        const std::vector<int>& paddings,
+                        const std::vector<int>& dilations,
+                        int groups,
+                        DenseTensor* output) {
+  if (!std::is_same<T, float>::value || input.dims().size() != 4) {
+    return false;
+  }
+  funcs::Conv2dShape shape;
+  shape.batch = input.dims()[0];
+  shape.in_channels = input.dims()[1];
+  shape.in_h = input.dims()[2];
+  shape.in_w = input.dims()[3];
+  shape.out_channels = output->dims()[1];
+  shape.out_h = output->dims()[2];
+  shape.out_w = output->dims()[3];
+  shape.kernel_h = filter.dims()[2];
+  shape.kernel_w = filter.dims()[3];
+  shape.stride_h = strides[0];
+  shape.stride_w = strides[1];
+  shape.pad_top = paddings[0];
+  shape.pad_left = paddings[2];
+  shape.dilation_h = dilations[0];
+  shape.dilation_w = dilations[1];
+  shape.groups = groups;
+  auto algorithm = funcs::SelectConv2dAlgorithm(shape);
+  if (algorithm == funcs::Conv2dAlgorithm::kIm2colGemm) {
+    return false;
+  }
+  funcs::Conv2dForward(dev_ctx,
+                       shape,
+                       algorithm,
+                       input.data<float>(),
+                       filter.data<float>(),
+                       output->data<float>());
+  return true;
+}
+
 template <typename T, typename Context>
 void ConvKernel(const Context& dev_ctx,
                 const DenseTensor& input,
@@ -73,6 +131,20 @@ void ConvKernel(const Context& dev_ctx,
   UpdatePaddingAndDilation(
       &paddings, &dilations, padding_algorithm, in_data_dims, strides, ksize);
 
+  if (RunConv2dAlgorithm<T>(dev_ctx,
+                            transformed_input,
+                            filter,
+                            strides,
+                            paddings,
+                            dilations,
+                            groups,
+                            &transformed_output)) {
+    if (channel_last) {
+      TransToChannelLast<Context, T>(dev_ctx, &transformed_output, output);
+    }
+    return;
+  }
+
   const int batch_size = static_cast<int>(transformed_input.dims()[0]);
 
   // filter_shape_vec:
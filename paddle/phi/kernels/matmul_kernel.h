@@ -29,6 +29,25 @@ void MatmulKernel(const Context& dev_ctx,
                   bool transpose_y,
                   DenseTensor* out);
 
+class CPUContext;
+
+// bfloat16 and float16 accumulate in float on CPU, see cpu/matmul_kernel.cc.
+template <>
+void MatmulKernel<dtype::bfloat16, CPUContext>(const CPUContext& dev_ctx,
+                                               const DenseTensor& x,
+                                               const DenseTensor& y,
+                                               bool transpose_x,
+                                               bool transpose_y,
+                                               DenseTensor* out);
+
+template <>
+void MatmulKernel<dtype::float16, CPUContext>(const CPUContext& dev_ctx,
+                                              const DenseTensor& x,
+                                              const DenseTensor& y,
+                                              bool transpose_x,
+                                              bool transpose_y,
+                                              DenseTensor* out);
+
 // In order to be compatible with `mul` op in fluid,
 // it is no longer used in 2.x API
 template <typename T, typename Context>
@@ -25,4 +25,19 @@ void SoftmaxKernel(const Context& dev_ctx,
                    int axis,
                    DenseTensor* out);
 
+class CPUContext;
+
+// bfloat16 and float16 compute in float on CPU, see cpu/softmax_kernel.cc.
+template <>
+void SoftmaxKernel<dtype::bfloat16, CPUContext>(const CPUContext& dev_ctx,
+                                                const DenseTensor& x,
+                                                int axis,
+                                                DenseTensor* out);
+
+template <>
+void SoftmaxKernel<dtype::float16, CPUContext>(const CPUContext& dev_ctx,
+                                               const DenseTensor& x,
+                                               int axis,
+                                               DenseTensor* out);
+
 }  // namespace phi
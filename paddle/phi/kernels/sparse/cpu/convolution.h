@@ -14,7 +14,11 @@ limitations under the License. */
 
 #pragma once
 
-#include <set>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_registry.h"
@@ -28,9 +32,86 @@ namespace sparse {
 
 using Dims4D = phi::funcs::sparse::Dims4D;
 
+// The points given to a thread at least by the rulebook builders.
+constexpr int64_t kRulebookGrainSize = 1 << 12;
+
+// An open addressing hash table of the linear indices of sparse points,
+// each slot keeping an index and a value. Insert and Find can be called
+// from several threads at once.
+class PointHashTable {
+ public:
+  explicit PointHashTable(int64_t capacity) {
+    int64_t size = 2;
+    bits_ = 1;
+    while (size < 2 * capacity) {
+      size <<= 1;
+      ++bits_;
+    }
+    mask_ = size - 1;
+    keys_.reset(new std::atomic<int64_t>[size]);
+    for (int64_t i = 0; i < size; ++i) {
+      keys_[i].store(kEmpty, std::memory_order_relaxed);
+    }
+    values_.resize(size);
+  }
+
+  int64_t Size() const { return mask_ + 1; }
+
+  // Inserts key if absent, and returns its slot.
+  int64_t Insert(int64_t key) {
+    for (int64_t slot = Hash(key);; slot = (slot + 1) & mask_) {
+      int64_t current = keys_[slot].load(std::memory_order_relaxed);
+      if (current == kEmpty && keys_[slot].compare_exchange_strong(
+                                   current, key, std::memory_order_relaxed)) {
+        return slot;
+      }
+      if (current == key) {
+        return slot;
+      }
+    }
+  }
+
+  // Returns the slot of key, or -1 if it is absent.
+  int64_t Find(int64_t key) const {
+    for (int64_t slot = Hash(key);; slot = (slot + 1) & mask_) {
+      int64_t current = keys_[slot].load(std::memory_order_relaxed);
+      if (current == key) {
+        return slot;
+      }
+      if (current == kEmpty) {
+        return -1;
+      }
+    }
+  }
+
+  int64_t Key(int64_t slot) const {
+    return keys_[slot].load(std::memory_order_relaxed);
+  }
+  int64_t& Value(int64_t slot) { return values_[slot]; }
+
+ private:
+  static constexpr int64_t kEmpty = -1;
+
+  int64_t Hash(int64_t key) const {
+    return static_cast<int64_t>((static_cast<uint64_t>(key) *
+                                 0x9E3779B97F4A7C15ULL) >>
+                                (64 - bits_)) &
+           mask_;
+  }
+
+  int bits_;
+  int64_t mask_;
+  std::unique_ptr<std::atomic<int64_t>[]> keys_;
+  std::vector<int64_t> values_;
+};
+
 // such as: kernel(3, 3, 3), kernel_size = 27
 // counter_per_weight: (kernel_size)
-// TODO(zhangkaihuo): optimize performance with multithreading
+// The input points are split into chunks, and the valid pairs of input
+// point and out index of every kernel offset and chunk are collected in
+// parallel, the input points of subm being looked up in a hash table. The
+// pairs are then copied to the rulebook in the order of the kernel offsets
+// and the input points, so that only the valid pairs are kept in memory.
 template <typename T, typename Context, typename IntT = int>
 void ProductRuleBook(const Context& dev_ctx,
                      const SparseCooTensor& x,
@@ -49,8 +130,6 @@ void ProductRuleBook(const Context& dev_ctx,
   int kernel_size = kernel_sizes[0] * kernel_sizes[1] * kernel_sizes[2];
   memset(counter_ptr, 0, kernel_size * sizeof(int));
 
-  int rulebook_len = 0;
-  // calc the rulebook_len
   const auto& x_dims = x.dims();
   const Dims4D c_x_dims(x_dims[0], x_dims[3], x_dims[2], x_dims[1]);
   const Dims4D c_kernel_dims(
@@ -60,71 +139,80 @@ void ProductRuleBook(const Context& dev_ctx,
   const Dims4D c_strides(1, strides[2], strides[1], strides[0]);
   const Dims4D c_dilations(1, dilations[2], dilations[1], dilations[0]);
 
-  std::set<IntT> hash_in;
+  PointHashTable hash_in(subm ? non_zero_num : 0);
   if (subm) {
-    for (int i = 0; i < non_zero_num; i++) {
-      IntT batch = indices_ptr[i];
-      IntT in_z = indices_ptr[i + non_zero_num];
-      IntT in_y = indices_ptr[i + 2 * non_zero_num];
-      IntT in_x = indices_ptr[i + 3 * non_zero_num];
-      IntT index = phi::funcs::sparse::PointToIndex<DDim>(
-          batch, in_x, in_y, in_z, x_dims);
-      hash_in.insert(index);
-    }
+    dev_ctx.ParallelFor(
+        0, non_zero_num, kRulebookGrainSize, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; i++) {
+            IntT batch = indices_ptr[i];
+            IntT in_z = indices_ptr[i + non_zero_num];
+            IntT in_y = indices_ptr[i + 2 * non_zero_num];
+            IntT in_x = indices_ptr[i + 3 * non_zero_num];
+            hash_in.Insert(phi::funcs::sparse::PointToIndex<DDim>(
+                batch, in_x, in_y, in_z, x_dims));
+          }
+        });
   }
 
-  auto f_calc_rulebook = [&](IntT* rulebook_ptr) {
-    int kernel_index = 0, rulebook_index = 0;
-    for (int kz = 0; kz < kernel_sizes[0]; kz++) {
-      for (int ky = 0; ky < kernel_sizes[1]; ky++) {
-        for (int kx = 0; kx < kernel_sizes[2]; kx++) {
-          ++kernel_index;
-          for (int64_t i = 0; i < non_zero_num; i++) {
+  // The pairs of input point and out index of the kernel offset k and the
+  // chunk c are at pairs[k * num_chunks + c].
+  const int64_t num_chunks =
+      (non_zero_num + kRulebookGrainSize - 1) / kRulebookGrainSize;
+  std::vector<std::vector<std::pair<IntT, IntT>>> pairs(kernel_size *
+                                                        num_chunks);
+  dev_ctx.ParallelFor(
+      0, kernel_size * num_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t unit = begin; unit < end; unit++) {
+          int kernel_index = unit / num_chunks;
+          int64_t chunk_begin = unit % num_chunks * kRulebookGrainSize;
+          int64_t chunk_end =
+              std::min(non_zero_num, chunk_begin + kRulebookGrainSize);
+          int kx = kernel_index % kernel_sizes[2];
+          int ky = kernel_index / kernel_sizes[2] % kernel_sizes[1];
+          int kz = kernel_index / kernel_sizes[2] / kernel_sizes[1];
+          for (int64_t i = chunk_begin; i < chunk_end; i++) {
             IntT batch = indices_ptr[i];
             IntT in_z = indices_ptr[i + non_zero_num];
             IntT in_y = indices_ptr[i + 2 * non_zero_num];
             IntT in_x = indices_ptr[i + 3 * non_zero_num];
+            if (!phi::funcs::sparse::Check(c_x_dims,
+                                           c_kernel_dims,
+                                           c_paddings,
+                                           c_dilations,
+                                           c_strides,
+                                           in_x,
+                                           in_y,
+                                           in_z,
+                                           kx,
+                                           ky,
+                                           kz)) {
+              continue;
+            }
             IntT out_z = (in_z + paddings[0] - kz * dilations[0]) / strides[0];
             IntT out_y = (in_y + paddings[1] - ky * dilations[1]) / strides[1];
             IntT out_x = (in_x + paddings[2] - kx * dilations[2]) / strides[2];
-            if (phi::funcs::sparse::Check(c_x_dims,
-                                          c_kernel_dims,
-                                          c_paddings,
-                                          c_dilations,
-                                          c_strides,
-                                          in_x,
-                                          in_y,
-                                          in_z,
-                                          kx,
-                                          ky,
-                                          kz)) {
-              if (subm) {
-                IntT out_index = phi::funcs::sparse::PointToIndex<DDim>(
-                    batch, out_x, out_y, out_z, out_dims);
-                if (hash_in.find(out_index) == hash_in.end()) {
-                  continue;
-                }
-              }
-
-              if (rulebook_ptr == nullptr) {
-                counter_ptr[kernel_index - 1] += 1;
-                ++rulebook_len;
-              } else {
-                rulebook_ptr[rulebook_index] = kernel_index - 1;
-                rulebook_ptr[rulebook_index + rulebook_len] = i;  // in_i
-                rulebook_ptr[rulebook_index + rulebook_len * 2] =
-                    phi::funcs::sparse::PointToIndex<DDim>(
-                        batch, out_x, out_y, out_z, out_dims);  // out_index
-                ++rulebook_index;
-              }
+            IntT out_index = phi::funcs::sparse::PointToIndex<DDim>(
+                batch, out_x, out_y, out_z, out_dims);
+            if (subm && hash_in.Find(out_index) < 0) {
+              continue;
             }
+            pairs[unit].emplace_back(static_cast<IntT>(i), out_index);
           }
         }
-      }
+      });
+
+  // The first rulebook entry of every kernel offset and chunk.
+  std::vector<int> unit_offsets(kernel_size * num_chunks);
+  int rulebook_len = 0;
+  for (int k = 0; k < kernel_size; k++) {
+    const int kernel_begin = rulebook_len;
+    for (int64_t c = 0; c < num_chunks; c++) {
+      unit_offsets[k * num_chunks + c] = rulebook_len;
+      rulebook_len += pairs[k * num_chunks + c].size();
     }
-  };
+    counter_ptr[k] = rulebook_len - kernel_begin;
+  }
 
-  f_calc_rulebook(nullptr);
   // alloc the rulebook
   *rulebook = phi::Empty(
       dev_ctx,
@@ -132,9 +220,25 @@ void ProductRuleBook(const Context& dev_ctx,
                       {3, rulebook_len},
                       DataLayout::NCHW));
   IntT* rulebook_ptr = rulebook->data<IntT>();
-  f_calc_rulebook(rulebook_ptr);
+  dev_ctx.ParallelFor(
+      0, kernel_size * num_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t unit = begin; unit < end; unit++) {
+          int rulebook_index = unit_offsets[unit];
+          for (const auto& pair : pairs[unit]) {
+            rulebook_ptr[rulebook_index] = unit / num_chunks;
+            rulebook_ptr[rulebook_index + rulebook_len] = pair.first;  // in_i
+            rulebook_ptr[rulebook_index + rulebook_len * 2] =
+                pair.second;  // out_index
+            ++rulebook_index;
+          }
+          // Frees the pairs as soon as they are copied.
+          std::vector<std::pair<IntT, IntT>>().swap(pairs[unit]);
+        }
+      });
 }
 
+// The distinct out indexes of the rulebook are collected in a hash table
+// and sorted, and each rulebook entry then looks up its position.
 template <typename T, typename Context, typename IntT = int>
 void UpdateRulebookAndOutIndex(const Context& dev_ctx,
                                const SparseCooTensor& x,
@@ -143,12 +247,25 @@ void UpdateRulebookAndOutIndex(const Context& dev_ctx,
                                const DDim& out_dims,
                                DenseTensor* rulebook,
                                SparseCooTensor* out) {
-  std::set<IntT> out_indexs;
   int n = rulebook->dims()[1];
   IntT* rulebook_ptr = rulebook->data<IntT>();
-  for (int i = 0; i < n; i++) {
-    out_indexs.insert(rulebook_ptr[i + n * 2]);
+  PointHashTable out_table(n);
+  std::vector<int64_t> slots(n);
+  dev_ctx.ParallelFor(
+      0, n, kRulebookGrainSize, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          slots[i] = out_table.Insert(rulebook_ptr[i + n * 2]);
+        }
+      });
+
+  // The pairs of out index and slot, sorted by out index.
+  std::vector<std::pair<int64_t, int64_t>> out_indexs;
+  for (int64_t slot = 0; slot < out_table.Size(); slot++) {
+    if (out_table.Key(slot) >= 0) {
+      out_indexs.emplace_back(out_table.Key(slot), slot);
+    }
   }
+  std::sort(out_indexs.begin(), out_indexs.end());
 
   int out_non_zero_num = out_indexs.size();
   const int64_t sparse_dim = 4;
@@ -162,43 +279,92 @@ void UpdateRulebookAndOutIndex(const Context& dev_ctx,
   phi::DenseTensor out_indices = phi::Empty(dev_ctx, std::move(indices_meta));
   phi::DenseTensor out_values = phi::Empty(dev_ctx, std::move(values_meta));
   IntT* out_indices_ptr = out_indices.data<IntT>();
-  int i = 0;
-  for (auto it = out_indexs.begin(); it != out_indexs.end(); it++, i++) {
-    const IntT index = *it;
-    IntT batch, x, y, z;
-    phi::funcs::sparse::IndexToPoint<DDim>(index, out_dims, &batch, &x, &y, &z);
-    out_indices_ptr[i] = batch;
-    out_indices_ptr[i + out_non_zero_num] = z;
-    out_indices_ptr[i + out_non_zero_num * 2] = y;
-    out_indices_ptr[i + out_non_zero_num * 3] = x;
-  }
-  for (i = 0; i < n; i++) {
-    IntT out_index = rulebook_ptr[i + n * 2];
-    rulebook_ptr[i + n * 2] =
-        std::distance(out_indexs.begin(), out_indexs.find(out_index));
-  }
+  dev_ctx.ParallelFor(
+      0,
+      out_non_zero_num,
+      kRulebookGrainSize,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          const IntT index = out_indexs[i].first;
+          out_table.Value(out_indexs[i].second) = i;
+          IntT batch, x, y, z;
+          phi::funcs::sparse::IndexToPoint<DDim>(
+              index, out_dims, &batch, &x, &y, &z);
+          out_indices_ptr[i] = batch;
+          out_indices_ptr[i + out_non_zero_num] = z;
+          out_indices_ptr[i + out_non_zero_num * 2] = y;
+          out_indices_ptr[i + out_non_zero_num * 3] = x;
+        }
+      });
+  dev_ctx.ParallelFor(
+      0, n, kRulebookGrainSize, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          rulebook_ptr[i + n * 2] = out_table.Value(slots[i]);
+        }
+      });
 
   out->SetMember(out_indices, out_values, out_dims, true);
 }
 
 template <typename T, typename IntT = int>
-void Gather(
-    const T* x, const IntT* indexs, const int n, const int channels, T* out) {
-  for (int i = 0; i < n; i++) {
-    IntT real_i = indexs[i];
-    memcpy(out + i * channels, x + real_i * channels, channels * sizeof(T));
-  }
+void Gather(const CPUContext& dev_ctx,
+            const T* x,
+            const IntT* indexs,
+            const int n,
+            const int channels,
+            T* out) {
+  dev_ctx.ParallelFor(
+      0,
+      n,
+      std::max<int64_t>(1, kRulebookGrainSize / std::max(channels, 1)),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          IntT real_i = indexs[i];
+          memcpy(
+              out + i * channels, x + real_i * channels, channels * sizeof(T));
+        }
+      });
 }
 
+// Adds the rows of x into the out_n rows of out given by indexs. The rows
+// are first grouped by their destination, so that each thread owns the
+// rows of out it adds into.
 template <typename T, typename IntT = int>
-void Scatter(
-    const T* x, const IntT* indexs, const int n, const int channels, T* out) {
+void Scatter(const CPUContext& dev_ctx,
+             const T* x,
+             const IntT* indexs,
+             const int n,
+             const int out_n,
+             const int channels,
+             T* out) {
+  std::vector<int> offsets(out_n + 1, 0);
   for (int i = 0; i < n; i++) {
-    IntT real_i = indexs[i];
-    for (int j = 0; j < channels; j++) {
-      out[real_i * channels + j] += x[i * channels + j];
-    }
+    ++offsets[indexs[i] + 1];
   }
+  for (int i = 0; i < out_n; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+  std::vector<int> rows(n);
+  std::vector<int> positions(offsets.begin(), offsets.end() - 1);
+  for (int i = 0; i < n; i++) {
+    rows[positions[indexs[i]]++] = i;
+  }
+  dev_ctx.ParallelFor(
+      0,
+      out_n,
+      std::max<int64_t>(
+          1, kRulebookGrainSize * out_n / std::max<int64_t>(n * channels, 1)),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t real_i = begin; real_i < end; real_i++) {
+          T* to = out + real_i * channels;
+          for (int k = offsets[real_i]; k < offsets[real_i + 1]; k++) {
+            const T* from = x + static_cast<int64_t>(rows[k]) * channels;
+            for (int j = 0; j < channels; j++) {
+              to[j] += from[j];
+            }
+          }
+        }
+      });
 }
 
 }  // namespace sparse
@@ -116,63 +116,73 @@ void Conv3dGradCPUKernel(const CPUContext& dev_ctx,
     }
   }
 
-  Gather<T, IntT>(x.non_zero_elements().data<T>(),
+  Gather<T, IntT>(dev_ctx,
+                  x.non_zero_elements().data<T>(),
                   rulebook_ptr + rulebook_len,
                   rulebook_len,
                   in_channels,
                   in_features_ptr);
-  Gather<T, IntT>(out_grad.non_zero_elements().data<T>(),
+  Gather<T, IntT>(dev_ctx,
+                  out_grad.non_zero_elements().data<T>(),
                   rulebook_ptr + rulebook_len * 2,
                   rulebook_len,
                   out_channels,
                   out_grad_features_ptr);
 
+  // The kernel offsets write disjoint rows of d_x_features and slices of
+  // kernel_grad, so they run in parallel.
   const T* kernel_ptr = kernel.data<T>();
-  for (int i = 0; i < kernel_size; i++) {
-    if (counter[i] <= 0 || (subm && i == half_kernel_size)) {
-      continue;
-    }
-
-    const int M = counter[i];
-    const int K = in_channels;
-    const int N = out_channels;
-    T* tmp_in_ptr = in_features_ptr + offsets[i] * in_channels;
-    T* tmp_out_grad_ptr = out_grad_features_ptr + offsets[i] * out_channels;
-    const T* tmp_kernel_ptr = kernel_ptr + i * in_channels * out_channels;
-    T* tmp_d_x_ptr = d_x_features_ptr + offsets[i] * in_channels;
-    T* tmp_d_kernel_ptr = d_kernel_ptr + i * in_channels * out_channels;
-
-    // call gemm: d_kernel = transpose(x) * out_grad
-    // (in_channels, n) * (n, out_channels)
-    blas.GEMM(CblasTrans,
-              CblasNoTrans,
-              K,
-              N,
-              M,
-              static_cast<T>(1),
-              tmp_in_ptr,
-              tmp_out_grad_ptr,
-              static_cast<T>(0),
-              tmp_d_kernel_ptr);
-
-    // call gemm: d_x = out_grad * transpose(kernel)
-    // (n, out_channels) * (out_channels, in_channels)
-    blas.GEMM(CblasNoTrans,
-              CblasTrans,
-              M,
-              K,
-              N,
-              static_cast<T>(1),
-              tmp_out_grad_ptr,
-              tmp_kernel_ptr,
-              static_cast<T>(0),
-              tmp_d_x_ptr);
-  }
+  phi::funcs::BlasParallelFor(
+      dev_ctx, 0, kernel_size, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          if (counter[i] <= 0 || (subm && i == half_kernel_size)) {
+            continue;
+          }
+
+          const int M = counter[i];
+          const int K = in_channels;
+          const int N = out_channels;
+          T* tmp_in_ptr = in_features_ptr + offsets[i] * in_channels;
+          T* tmp_out_grad_ptr =
+              out_grad_features_ptr + offsets[i] * out_channels;
+          const T* tmp_kernel_ptr = kernel_ptr + i * in_channels * out_channels;
+          T* tmp_d_x_ptr = d_x_features_ptr + offsets[i] * in_channels;
+          T* tmp_d_kernel_ptr = d_kernel_ptr + i * in_channels * out_channels;
+
+          // call gemm: d_kernel = transpose(x) * out_grad
+          // (in_channels, n) * (n, out_channels)
+          blas.GEMM(CblasTrans,
+                    CblasNoTrans,
+                    K,
+                    N,
+                    M,
+                    static_cast<T>(1),
+                    tmp_in_ptr,
+                    tmp_out_grad_ptr,
+                    static_cast<T>(0),
+                    tmp_d_kernel_ptr);
+
+          // call gemm: d_x = out_grad * transpose(kernel)
+          // (n, out_channels) * (out_channels, in_channels)
+          blas.GEMM(CblasNoTrans,
+                    CblasTrans,
+                    M,
+                    K,
+                    N,
+                    static_cast<T>(1),
+                    tmp_out_grad_ptr,
+                    tmp_kernel_ptr,
+                    static_cast<T>(0),
+                    tmp_d_x_ptr);
+        }
+      });
 
   // 4. scatter
-  Scatter<T, IntT>(d_x_features_ptr,
+  Scatter<T, IntT>(dev_ctx,
+                   d_x_features_ptr,
                    rulebook.data<IntT>() + rulebook_len,
                    rulebook_len,
+                   x.nnz(),
                    in_channels,
                    x_grad_values_ptr);
 }
@@ -87,65 +87,67 @@ void Conv3dCPUKernel(const CPUContext& dev_ctx,
   int n = rulebook->dims()[1];
   const int* counter_ptr = counter_per_kernel.data<int>();
 
-  // 2. gather
-  DenseTensorMeta in_features_meta(
-      x.dtype(), {n, in_channels}, DataLayout::NHWC);
+  // 2. gather, gemm and scatter
+  // The rulebook entries of each kernel offset are split into blocks of at
+  // most kRulebookBlockRows, and the blocks are gathered and multiplied by
+  // their weight in parallel, each into its own rows of out_features.
+  constexpr int kRulebookBlockRows = 256;
   DenseTensorMeta out_features_meta(
       x.dtype(), {n, out_channels}, DataLayout::NHWC);
-  phi::DenseTensor in_features =
-      phi::Empty(dev_ctx, std::move(in_features_meta));
   phi::DenseTensor out_features =
       phi::Empty(dev_ctx, std::move(out_features_meta));
-  T* in_features_ptr = in_features.data<T>();
   T* out_features_ptr = out_features.data<T>();
 
-  Gather<T, IntT>(x.non_zero_elements().data<T>(),
-                  rulebook->data<IntT>() + n,
-                  n,
-                  in_channels,
-                  in_features_ptr);
-
-  // 3. call gemm for every werght
-  auto blas = phi::funcs::GetBlas<CPUContext, T>(dev_ctx);
   std::vector<int> offsets(kernel_size + 1);
-  int offset = 0;
+  phi::funcs::sparse::PrefixSum(counter_ptr, offsets.data(), kernel_size);
+  // The first rulebook entry of every block.
+  std::vector<int> blocks;
   for (int i = 0; i < kernel_size; i++) {
-    offsets[i] = offset;
-    offset += counter_ptr[i];
+    for (int row = offsets[i]; row < offsets[i + 1];
+         row += kRulebookBlockRows) {
+      blocks.push_back(row);
+    }
   }
-  offsets[kernel_size] = offset;
 
+  auto blas = phi::funcs::GetBlas<CPUContext, T>(dev_ctx);
+  const T* x_values_ptr = x.non_zero_elements().data<T>();
+  const IntT* rulebook_ptr = rulebook->data<IntT>();
   const T* kernel_ptr = kernel.data<T>();
-  for (int i = 0; i < kernel_size; i++) {
-    if (counter_ptr[i] <= 0) {
-      continue;
-    }
-
-    // call gemm: (n, in_channels) * (in_channels, out_channels)
-    const int M = counter_ptr[i];
-    const int K = in_channels;   // in_channels
-    const int N = out_channels;  // out_channels
-    T* tmp_in_ptr = in_features_ptr + offsets[i] * in_channels;
-    const T* tmp_kernel_ptr = kernel_ptr + i * K * N;
-    T* tmp_out_ptr = out_features_ptr + offsets[i] * out_channels;
-    blas.GEMM(CblasNoTrans,
-              CblasNoTrans,
-              M,
-              N,
-              K,
-              static_cast<T>(1),
-              tmp_in_ptr,
-              tmp_kernel_ptr,
-              static_cast<T>(0),
-              tmp_out_ptr);
-  }
+  phi::funcs::BlasParallelFor(
+      dev_ctx, 0, blocks.size(), 1, [&](int64_t begin, int64_t end) {
+        std::vector<T> in_features(kRulebookBlockRows * in_channels);
+        for (int64_t b = begin; b < end; b++) {
+          const int row = blocks[b];
+          const int i = rulebook_ptr[row];
+          // call gemm: (M, in_channels) * (in_channels, out_channels)
+          const int M = std::min(kRulebookBlockRows, offsets[i + 1] - row);
+          const int K = in_channels;
+          const int N = out_channels;
+          for (int m = 0; m < M; m++) {
+            memcpy(in_features.data() + m * K,
+                   x_values_ptr + rulebook_ptr[row + m + n] * K,
+                   K * sizeof(T));
+          }
+          blas.GEMM(CblasNoTrans,
+                    CblasNoTrans,
+                    M,
+                    N,
+                    K,
+                    static_cast<T>(1),
+                    in_features.data(),
+                    kernel_ptr + i * K * N,
+                    static_cast<T>(0),
+                    out_features_ptr + row * N);
+        }
+      });
 
-  // 4. scatter
   T* out_values_ptr = out->mutable_non_zero_elements()->data<T>();
   memset(out_values_ptr, 0, sizeof(T) * out->nnz() * out_channels);
-  Scatter<T, IntT>(out_features_ptr,
-                   rulebook->data<IntT>() + n * 2,
+  Scatter<T, IntT>(dev_ctx,
+                   out_features_ptr,
+                   rulebook_ptr + n * 2,
                    n,
+                   out->nnz(),
                    out_channels,
                    out_values_ptr);
 }
@@ -12,6 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <atomic>
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "gtest/gtest.h"
 
 // TODO(wilber): will remove after the cpu, gpu context megre.
@@ -50,5 +55,64 @@ TEST(DeviceContext, cpu_context) {
   delete device;
 }
 
+TEST(DeviceContext, cpu_parallel_for) {
+  phi::CPUContext ctx;
+  ctx.Init();
+  EXPECT_EQ(GetIntraOpNumThreads(), 1);
+  for (int num_threads : {1, 4}) {
+    SetIntraOpNumThreads(num_threads);
+    std::vector<int> counts(1000, 0);
+    std::atomic<int> num_chunks{0};
+    ctx.ParallelFor(0, 1000, 100, [&](int64_t begin, int64_t end) {
+      EXPECT_LT(begin, end);
+      ++num_chunks;
+      auto chunk_thread = std::this_thread::get_id();
+      for (int64_t i = begin; i < end; ++i) {
+        ++counts[i];
+        // The nested loops run on the thread of the chunk, including the
+        // calling thread.
+        ctx.ParallelFor(0, 10, 1, [&](int64_t, int64_t) {
+          EXPECT_EQ(std::this_thread::get_id(), chunk_thread);
+        });
+      }
+    });
+    EXPECT_EQ(num_chunks.load(), num_threads);
+    for (int count : counts) {
+      EXPECT_EQ(count, 1);
+    }
+    // The chunks are at least grain_size long.
+    num_chunks = 0;
+    ctx.ParallelFor(
+        0, 150, 100, [&](int64_t begin, int64_t end) { ++num_chunks; });
+    EXPECT_EQ(num_chunks.load(), std::min(num_threads, 2));
+
+    auto sum = ctx.ParallelReduce(
+        1,
+        101,
+        10,
+        int64_t{0},
+        [](int64_t begin, int64_t end) {
+          int64_t value = 0;
+          for (int64_t i = begin; i < end; ++i) {
+            value += i;
+          }
+          return value;
+        },
+        [](int64_t a, int64_t b) { return a + b; });
+    EXPECT_EQ(sum, 5050);
+
+    EXPECT_THROW(ctx.ParallelFor(0,
+                                 1000,
+                                 1,
+                                 [](int64_t begin, int64_t end) {
+                                   if (end == 1000) {
+                                     throw std::runtime_error("last chunk");
+                                   }
+                                 }),
+                 std::runtime_error);
+  }
+  SetIntraOpNumThreads(1);
+}
+
 }  // namespace tests
 }  // namespace phi
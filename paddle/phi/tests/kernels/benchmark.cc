@@ -0,0 +1,51 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/tests/kernels/benchmark.h"
+
+#include <chrono>
+#include <string>
+
+#include "glog/logging.h"
+
+DEFINE_int32(burning, 2, "Burning times.");
+DEFINE_int32(repeat, 10, "Repeat times.");
+
+namespace phi {
+namespace tests {
+
+void InitBenchmark(int* argc, char*** argv, int burning, int repeat) {
+  gflags::SetCommandLineOptionWithMode(
+      "burning", std::to_string(burning).c_str(), gflags::SET_FLAGS_DEFAULT);
+  gflags::SetCommandLineOptionWithMode(
+      "repeat", std::to_string(repeat).c_str(), gflags::SET_FLAGS_DEFAULT);
+  gflags::ParseCommandLineFlags(argc, argv, true);
+  google::InitGoogleLogging((*argv)[0]);
+}
+
+double Time(const std::function<void()>& func) {
+  for (int i = 0; i < FLAGS_burning; ++i) {
+    func();
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    func();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         FLAGS_repeat;
+}
+
+}  // namespace tests
+}  // namespace phi
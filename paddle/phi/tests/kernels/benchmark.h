@@ -0,0 +1,41 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <functional>
+
+#include "gflags/gflags.h"
+
+DECLARE_int32(burning);
+DECLARE_int32(repeat);
+
+namespace phi {
+namespace tests {
+
+// Parses the flags of a kernel benchmark and initializes the logging. The
+// defaults of --burning and --repeat are given by the benchmark.
+void InitBenchmark(int* argc, char*** argv, int burning = 2, int repeat = 10);
+
+// Returns the average microseconds of func over --repeat runs, after
+// --burning runs.
+double Time(const std::function<void()>& func);
+
+// Returns the average milliseconds of func, see Time.
+inline double TimeMs(const std::function<void()>& func) {
+  return Time(func) / 1000;
+}
+
+}  // namespace tests
+}  // namespace phi
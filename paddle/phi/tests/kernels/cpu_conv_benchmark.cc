@@ -0,0 +1,144 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times every conv2d algorithm of funcs/cpu_conv.h supporting the layers of
+// ResNet-50, VGG-16 and MobileNet-v1, and marks the selected one, e.g.
+//   cpu_conv_benchmark --batch=1 --threads=8
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+
+DEFINE_int64(batch, 1, "The batch size of the input.");
+DEFINE_int32(threads, 1, "The threads of the runs.");
+
+namespace {
+
+using phi::tests::Time;
+
+using phi::funcs::Conv2dAlgorithm;
+using phi::funcs::Conv2dShape;
+
+struct Layer {
+  const char* name;
+  int64_t in_channels;
+  int64_t size;
+  int64_t out_channels;
+  int64_t kernel;
+  int64_t stride;
+  int64_t groups;
+};
+
+// The distinct layers of the networks, padded to keep the size when the
+// stride is 1.
+const Layer kLayers[] = {
+    {"resnet50_conv1", 3, 224, 64, 7, 2, 1},
+    {"resnet50_res2_1x1_reduce", 256, 56, 64, 1, 1, 1},
+    {"resnet50_res2_3x3", 64, 56, 64, 3, 1, 1},
+    {"resnet50_res2_1x1_expand", 64, 56, 256, 1, 1, 1},
+    {"resnet50_res3_3x3", 128, 28, 128, 3, 1, 1},
+    {"resnet50_res3_downsample", 256, 56, 512, 1, 2, 1},
+    {"resnet50_res4_3x3", 256, 14, 256, 3, 1, 1},
+    {"resnet50_res5_3x3", 512, 7, 512, 3, 1, 1},
+    {"vgg16_conv1_1", 3, 224, 64, 3, 1, 1},
+    {"vgg16_conv1_2", 64, 224, 64, 3, 1, 1},
+    {"vgg16_conv3_2", 256, 56, 256, 3, 1, 1},
+    {"vgg16_conv5_2", 512, 14, 512, 3, 1, 1},
+    {"mobilenet_conv1", 3, 224, 32, 3, 2, 1},
+    {"mobilenet_dw2", 64, 112, 64, 3, 2, 64},
+    {"mobilenet_dw3", 128, 56, 128, 3, 1, 128},
+    {"mobilenet_pw3", 128, 56, 128, 1, 1, 1},
+    {"mobilenet_dw6", 512, 14, 512, 3, 1, 512},
+    {"mobilenet_pw6", 512, 14, 512, 1, 1, 1},
+};
+
+std::vector<float> RandomVector(int64_t n) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> result(n);
+  for (auto& value : result) {
+    value = dist(rng);
+  }
+  return result;
+}
+
+void Benchmark(const Layer& layer) {
+  Conv2dShape shape;
+  shape.batch = FLAGS_batch;
+  shape.in_channels = layer.in_channels;
+  shape.in_h = layer.size;
+  shape.in_w = layer.size;
+  shape.out_channels = layer.out_channels;
+  shape.kernel_h = layer.kernel;
+  shape.kernel_w = layer.kernel;
+  shape.stride_h = layer.stride;
+  shape.stride_w = layer.stride;
+  shape.pad_top = layer.kernel / 2;
+  shape.pad_left = layer.kernel / 2;
+  shape.groups = layer.groups;
+  shape.out_h = (layer.size + 2 * shape.pad_top - layer.kernel) / layer.stride +
+                1;
+  shape.out_w = shape.out_h;
+
+  phi::CPUContext dev_ctx;
+  auto input = RandomVector(shape.batch * shape.in_channels * shape.in_h *
+                            shape.in_w);
+  auto filter =
+      RandomVector(shape.out_channels * shape.in_channels / shape.groups *
+                   shape.kernel_h * shape.kernel_w);
+  std::vector<float> output(shape.batch * shape.out_channels * shape.out_h *
+                            shape.out_w);
+
+  const Conv2dAlgorithm selected = phi::funcs::SelectConv2dAlgorithm(shape);
+  std::ostringstream os;
+  os << layer.name << " batch=" << shape.batch;
+  for (auto algorithm : {Conv2dAlgorithm::kIm2colGemm,
+                         Conv2dAlgorithm::kGemm1x1,
+                         Conv2dAlgorithm::kDirect,
+                         Conv2dAlgorithm::kWinogradF2x3,
+                         Conv2dAlgorithm::kWinogradF4x3}) {
+    if (!phi::funcs::IsConv2dAlgorithmSupported(shape, algorithm)) {
+      continue;
+    }
+    double time = Time([&] {
+      phi::funcs::Conv2dForward(dev_ctx,
+                                shape,
+                                algorithm,
+                                input.data(),
+                                filter.data(),
+                                output.data());
+    });
+    os << " " << phi::funcs::Conv2dAlgorithmName(algorithm)
+       << (algorithm == selected ? "*=" : "=") << time << "us";
+  }
+  LOG(INFO) << os.str();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv);
+  phi::SetIntraOpNumThreads(FLAGS_threads);
+  for (const auto& layer : kLayers) {
+    Benchmark(layer);
+  }
+  return 0;
+}
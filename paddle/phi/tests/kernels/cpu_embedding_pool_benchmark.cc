@@ -0,0 +1,149 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times the lookups of funcs/cpu_embedding_pool against the serial loops
+// the embedding and fused_embedding_seq_pool kernels used to run, on the
+// random ids of a large table, e.g.
+//   cpu_embedding_pool_benchmark --batch=2048 --threads=8
+
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_embedding_pool.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+
+DEFINE_int64(batch, 512, "The sequences of the lookups.");
+DEFINE_int64(height, 1 << 18, "The rows of the table.");
+DEFINE_int32(threads, 1, "The threads of the runs.");
+
+namespace {
+
+using phi::tests::Time;
+
+// The sum pooling of fused_embedding_seq_pool without MKL.
+void SerialSumPool(const float* table,
+                   int64_t width,
+                   const int64_t* ids,
+                   const std::vector<uint64_t>& offsets,
+                   int64_t slots,
+                   float* out) {
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    for (int64_t s = 0; s < slots; ++s) {
+      float* dst = out + (i * slots + s) * width;
+      std::memset(dst, 0, width * sizeof(float));
+      for (uint64_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+        const float* row = table + ids[j * slots + s] * width;
+        for (int64_t e = 0; e < width; ++e) {
+          dst[e] += row[e];
+        }
+      }
+    }
+  }
+}
+
+void Benchmark(int64_t width, int64_t length, int64_t slots) {
+  phi::CPUContext dev_ctx;
+  std::mt19937 rng(width);
+  std::uniform_int_distribution<int64_t> id(0, FLAGS_height - 1);
+  std::vector<float> table(FLAGS_height * width);
+  for (size_t i = 0; i < table.size(); ++i) {
+    table[i] = static_cast<float>(i % 97) / 97.f;
+  }
+  std::vector<uint64_t> offsets(FLAGS_batch + 1);
+  for (int64_t i = 0; i <= FLAGS_batch; ++i) {
+    offsets[i] = i * length;
+  }
+  std::vector<int64_t> ids(offsets.back() * slots);
+  for (auto& i : ids) {
+    i = id(rng);
+  }
+  std::vector<float> out(FLAGS_batch * slots * width);
+  std::vector<float> rows(ids.size() * width);
+
+  double serial_pool = Time([&] {
+    SerialSumPool(table.data(), width, ids.data(), offsets, slots, out.data());
+  });
+  double pool = Time([&] {
+    phi::funcs::EmbeddingSeqPool(dev_ctx,
+                                 table.data(),
+                                 FLAGS_height,
+                                 width,
+                                 ids.data(),
+                                 static_cast<const float*>(nullptr),
+                                 offsets,
+                                 slots,
+                                 phi::funcs::EmbeddingPoolType::kSum,
+                                 int64_t(-1),
+                                 out.data());
+  });
+  double serial_lookup = Time([&] {
+    for (size_t i = 0; i < ids.size(); ++i) {
+      std::memcpy(rows.data() + i * width,
+                  table.data() + ids[i] * width,
+                  width * sizeof(float));
+    }
+  });
+  double lookup = Time([&] {
+    phi::funcs::EmbeddingLookup(dev_ctx,
+                                table.data(),
+                                FLAGS_height,
+                                width,
+                                ids.data(),
+                                static_cast<int64_t>(ids.size()),
+                                int64_t(-1),
+                                rows.data());
+  });
+  auto groups = phi::funcs::GroupEmbeddingIds(
+      ids.data(), static_cast<int64_t>(ids.size()), int64_t(-1));
+  std::vector<float> grad(groups.rows.size() * width);
+  double pool_grad = Time([&] {
+    phi::funcs::EmbeddingSeqPoolGrad(dev_ctx,
+                                     table.data(),
+                                     width,
+                                     ids.data(),
+                                     static_cast<const float*>(nullptr),
+                                     offsets,
+                                     slots,
+                                     phi::funcs::EmbeddingPoolType::kSum,
+                                     int64_t(-1),
+                                     groups,
+                                     out.data(),
+                                     false,
+                                     grad.data());
+  });
+  std::ostringstream os;
+  os << "width=" << width << " length=" << length << " slots=" << slots
+     << " serial_pool=" << serial_pool << "us pool=" << pool
+     << "us serial_lookup=" << serial_lookup << "us lookup=" << lookup
+     << "us sparse_grad=" << pool_grad << "us";
+  LOG(INFO) << os.str();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv);
+  phi::SetIntraOpNumThreads(FLAGS_threads);
+  Benchmark(16, 20, 1);
+  Benchmark(64, 20, 1);
+  Benchmark(16, 4, 8);
+  Benchmark(128, 50, 1);
+  return 0;
+}
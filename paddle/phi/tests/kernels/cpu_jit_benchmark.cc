@@ -0,0 +1,120 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times the jit kernels of funcs/cpu_jit against the loops of the compiler,
+// for the small and medium rows of reduce and the steps of adamw, e.g.
+//   cpu_jit_benchmark --numel=1048576 --threads=8
+
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_jit.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+
+DEFINE_int64(numel, 1 << 20, "The elements of the tensors.");
+DEFINE_int32(threads, 1, "The threads of the runs.");
+
+namespace {
+
+using phi::tests::Time;
+
+void BenchmarkReduce(int64_t cols) {
+  phi::CPUContext dev_ctx;
+  const int64_t rows = FLAGS_numel / cols;
+  std::vector<float> x(rows * cols);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = static_cast<float>(i % 97) / 97.f;
+  }
+  std::vector<float> y(rows);
+  double serial = Time([&] {
+    for (int64_t i = 0; i < rows; ++i) {
+      float sum = 0.f;
+      for (int64_t j = 0; j < cols; ++j) {
+        sum += x[i * cols + j];
+      }
+      y[i] = sum / cols;
+    }
+  });
+  double jit = Time([&] {
+    phi::funcs::JitReduceRows(dev_ctx, x.data(), rows, cols, true, y.data());
+  });
+  std::ostringstream os;
+  os << "mean rows=" << rows << " cols=" << cols << " serial=" << serial
+     << "us jit=" << jit << "us";
+  LOG(INFO) << os.str();
+}
+
+void BenchmarkAdamW() {
+  phi::CPUContext dev_ctx;
+  const int64_t numel = FLAGS_numel;
+  std::vector<float> grad(numel, 0.1f);
+  std::vector<float> mom1(numel, 0.2f);
+  std::vector<float> mom2(numel, 0.3f);
+  std::vector<float> param(numel, 0.4f);
+  const float beta1 = 0.9f;
+  const float beta2 = 0.999f;
+  const float lr = 0.001f;
+  const float eps = 1e-8f;
+  const float decay = lr * 0.01f;
+  // The decay of param in place and the step of adam, in two passes.
+  double serial = Time([&] {
+    for (int64_t i = 0; i < numel; ++i) {
+      param[i] -= decay * param[i];
+    }
+    for (int64_t i = 0; i < numel; ++i) {
+      mom1[i] = beta1 * mom1[i] + (1 - beta1) * grad[i];
+      mom2[i] = beta2 * mom2[i] + (1 - beta2) * grad[i] * grad[i];
+      param[i] -= lr * (mom1[i] / (std::sqrt(mom2[i]) + eps));
+    }
+  });
+  double jit = Time([&] {
+    phi::funcs::JitAdam(dev_ctx,
+                        beta1,
+                        beta2,
+                        lr,
+                        eps,
+                        lr,
+                        1.f,
+                        0.01f,
+                        numel,
+                        grad.data(),
+                        mom1.data(),
+                        mom2.data(),
+                        param.data(),
+                        mom1.data(),
+                        mom2.data(),
+                        param.data());
+  });
+  std::ostringstream os;
+  os << "adamw numel=" << numel << " serial=" << serial << "us jit=" << jit
+     << "us";
+  LOG(INFO) << os.str();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv);
+  phi::SetIntraOpNumThreads(FLAGS_threads);
+  BenchmarkReduce(16);
+  BenchmarkReduce(64);
+  BenchmarkReduce(300);
+  BenchmarkReduce(2048);
+  BenchmarkAdamW();
+  return 0;
+}
@@ -0,0 +1,109 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times the bfloat16 GEMM and conversions of funcs/cpu_low_precision against
+// the float GEMM of blas, on the shapes of the transformer layers, e.g.
+//   cpu_low_precision_benchmark --threads=8
+
+#include <sstream>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+
+DEFINE_int32(threads, 1, "The threads of the runs.");
+
+namespace {
+
+using phi::tests::Time;
+
+void Benchmark(int64_t M, int64_t N, int64_t K) {
+  phi::CPUContext dev_ctx;
+  std::vector<float> a(M * K);
+  std::vector<float> b(K * N);
+  std::vector<float> c(M * N);
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = static_cast<float>(i % 89) / 89.f - 0.5f;
+  }
+  for (size_t i = 0; i < b.size(); ++i) {
+    b[i] = static_cast<float>(i % 97) / 97.f - 0.5f;
+  }
+  std::vector<phi::dtype::bfloat16> a_bf16(a.size());
+  std::vector<phi::dtype::bfloat16> b_bf16(b.size());
+  std::vector<phi::dtype::bfloat16> c_bf16(c.size());
+  phi::funcs::ConvertFromFloat(
+      a.data(), static_cast<int64_t>(a.size()), a_bf16.data());
+  phi::funcs::ConvertFromFloat(
+      b.data(), static_cast<int64_t>(b.size()), b_bf16.data());
+
+  auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(dev_ctx);
+  double sgemm = Time([&] {
+    blas.GEMM(CblasNoTrans,
+              CblasNoTrans,
+              M,
+              N,
+              K,
+              1.f,
+              a.data(),
+              b.data(),
+              0.f,
+              c.data());
+  });
+  double bf16_gemm = Time([&] {
+    phi::funcs::LowPrecisionGemm(dev_ctx,
+                                 false,
+                                 false,
+                                 M,
+                                 N,
+                                 K,
+                                 1.f,
+                                 a_bf16.data(),
+                                 b_bf16.data(),
+                                 0.f,
+                                 c_bf16.data());
+  });
+  double to_bf16 = Time([&] {
+    phi::funcs::ConvertFromFloat(
+        a.data(), static_cast<int64_t>(a.size()), a_bf16.data());
+  });
+  double to_float = Time([&] {
+    phi::funcs::ConvertToFloat(
+        a_bf16.data(), static_cast<int64_t>(a.size()), a.data());
+  });
+  double gflop = 2e-3 * M * N * K;
+  std::ostringstream os;
+  os << "M=" << M << " N=" << N << " K=" << K << " sgemm=" << sgemm << "us ("
+     << gflop / sgemm << " GFLOPS) bf16_gemm=" << bf16_gemm << "us ("
+     << gflop / bf16_gemm << " GFLOPS) to_bf16=" << to_bf16
+     << "us to_float=" << to_float << "us";
+  LOG(INFO) << os.str();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv);
+  phi::SetIntraOpNumThreads(FLAGS_threads);
+  LOG(INFO) << "AVX512-BF16: " << phi::funcs::CpuUseAvx512Bf16();
+  Benchmark(128, 768, 768);
+  Benchmark(128, 3072, 768);
+  Benchmark(128, 768, 3072);
+  Benchmark(1, 4096, 4096);
+  Benchmark(512, 1024, 1024);
+  return 0;
+}
@@ -0,0 +1,240 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times the row kernels of softmax, log_softmax and layer_norm, and the
+// Eigen expressions the softmax kernels used before them, e.g.
+//   cpu_row_kernels_benchmark --rows=512 --cols=768,3072 --threads=8
+
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_row_kernels.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+
+DEFINE_int64(rows, 512, "The rows of the input.");
+DEFINE_string(cols, "64,128,768,1024,3072", "The cols of the input.");
+DEFINE_int32(threads, 4, "The threads of the parallel runs.");
+
+namespace {
+
+using phi::tests::Time;
+
+using EigenMatrix = Eigen::TensorMap<Eigen::Tensor<float, 2, Eigen::RowMajor>>;
+using ConstEigenMatrix =
+    Eigen::TensorMap<Eigen::Tensor<const float, 2, Eigen::RowMajor>>;
+
+std::vector<float> RandomVector(int64_t n, float lower, float upper) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> dist(lower, upper);
+  std::vector<float> result(n);
+  for (auto& value : result) {
+    value = dist(rng);
+  }
+  return result;
+}
+
+void EigenSoftmax(const float* x, float* out, int64_t rows, int64_t cols) {
+  ConstEigenMatrix logits(x, rows, cols);
+  EigenMatrix softmax(out, rows, cols);
+  Eigen::DSizes<int, 1> along_class(1);
+  Eigen::DSizes<int, 2> batch_by_one(rows, 1);
+  Eigen::DSizes<int, 2> one_by_class(1, cols);
+  softmax = (logits - logits.maximum(along_class)
+                          .eval()
+                          .reshape(batch_by_one)
+                          .broadcast(one_by_class))
+                .exp();
+  softmax = softmax * softmax.sum(along_class)
+                          .inverse()
+                          .eval()
+                          .reshape(batch_by_one)
+                          .broadcast(one_by_class);
+}
+
+void EigenSoftmaxGrad(const float* out,
+                      const float* out_grad,
+                      float* x_grad,
+                      int64_t rows,
+                      int64_t cols) {
+  ConstEigenMatrix softmax(out, rows, cols);
+  ConstEigenMatrix softmax_grad(out_grad, rows, cols);
+  EigenMatrix logits_grad(x_grad, rows, cols);
+  Eigen::DSizes<int, 1> along_class(1);
+  Eigen::DSizes<int, 2> batch_by_one(rows, 1);
+  Eigen::DSizes<int, 2> one_by_class(1, cols);
+  auto dot = (softmax * softmax_grad)
+                 .sum(along_class)
+                 .eval()
+                 .reshape(batch_by_one)
+                 .broadcast(one_by_class);
+  logits_grad = (softmax_grad - dot) * softmax;
+}
+
+void EigenLogSoftmax(const float* x, float* out, int64_t rows, int64_t cols) {
+  ConstEigenMatrix logits(x, rows, cols);
+  EigenMatrix log_softmax(out, rows, cols);
+  Eigen::DSizes<int, 1> along_class(1);
+  Eigen::DSizes<int, 2> batch_by_one(rows, 1);
+  Eigen::DSizes<int, 2> one_by_class(1, cols);
+  log_softmax = logits - logits.maximum(along_class)
+                             .eval()
+                             .reshape(batch_by_one)
+                             .broadcast(one_by_class);
+  log_softmax = log_softmax - log_softmax.exp()
+                                  .eval()
+                                  .sum(along_class)
+                                  .log()
+                                  .eval()
+                                  .reshape(batch_by_one)
+                                  .broadcast(one_by_class);
+}
+
+void Report(const std::string& name,
+            int64_t cols,
+            double eigen,
+            double single,
+            double parallel) {
+  std::ostringstream os;
+  os << name << " rows=" << FLAGS_rows << " cols=" << cols;
+  if (eigen > 0) {
+    os << " eigen=" << eigen << "us";
+  }
+  os << " row_kernel=" << single << "us row_kernel_" << FLAGS_threads
+     << "_threads=" << parallel << "us";
+  LOG(INFO) << os.str();
+}
+
+void Benchmark(int64_t cols) {
+  const int64_t rows = FLAGS_rows;
+  const int64_t numel = rows * cols;
+  phi::CPUContext dev_ctx;
+  auto x = RandomVector(numel, -10.f, 10.f);
+  auto out_grad = RandomVector(numel, -1.f, 1.f);
+  auto scale = RandomVector(cols, 0.5f, 1.5f);
+  auto bias = RandomVector(cols, -1.f, 1.f);
+  std::vector<float> out(numel);
+  std::vector<float> x_grad(numel);
+  std::vector<float> mean(rows);
+  std::vector<float> var(rows);
+  std::vector<float> scale_grad(cols);
+  std::vector<float> bias_grad(cols);
+
+  // Runs func with one thread and then with FLAGS_threads.
+  auto time_row_kernel = [&](const std::function<void()>& func,
+                             double* single,
+                             double* parallel) {
+    phi::SetIntraOpNumThreads(1);
+    *single = Time(func);
+    phi::SetIntraOpNumThreads(FLAGS_threads);
+    *parallel = Time(func);
+    phi::SetIntraOpNumThreads(1);
+  };
+  double eigen = 0;
+  double single = 0;
+  double parallel = 0;
+
+  eigen = Time([&] { EigenSoftmax(x.data(), out.data(), rows, cols); });
+  time_row_kernel(
+      [&] {
+        phi::funcs::SoftmaxRows(dev_ctx, x.data(), out.data(), rows, cols);
+      },
+      &single,
+      &parallel);
+  Report("softmax", cols, eigen, single, parallel);
+
+  eigen = Time([&] {
+    EigenSoftmaxGrad(out.data(), out_grad.data(), x_grad.data(), rows, cols);
+  });
+  time_row_kernel(
+      [&] {
+        phi::funcs::SoftmaxGradRows(
+            dev_ctx, out.data(), out_grad.data(), x_grad.data(), rows, cols);
+      },
+      &single,
+      &parallel);
+  Report("softmax_grad", cols, eigen, single, parallel);
+
+  eigen = Time([&] { EigenLogSoftmax(x.data(), out.data(), rows, cols); });
+  time_row_kernel(
+      [&] {
+        phi::funcs::LogSoftmaxRows(dev_ctx, x.data(), out.data(), rows, cols);
+      },
+      &single,
+      &parallel);
+  Report("log_softmax", cols, eigen, single, parallel);
+
+  time_row_kernel(
+      [&] {
+        phi::funcs::LogSoftmaxGradRows(
+            dev_ctx, out.data(), out_grad.data(), x_grad.data(), rows, cols);
+      },
+      &single,
+      &parallel);
+  Report("log_softmax_grad", cols, 0, single, parallel);
+
+  time_row_kernel(
+      [&] {
+        phi::funcs::LayerNormRows(dev_ctx,
+                                  x.data(),
+                                  scale.data(),
+                                  bias.data(),
+                                  1e-5f,
+                                  out.data(),
+                                  mean.data(),
+                                  var.data(),
+                                  rows,
+                                  cols);
+      },
+      &single,
+      &parallel);
+  Report("layer_norm", cols, 0, single, parallel);
+
+  time_row_kernel(
+      [&] {
+        phi::funcs::LayerNormGradRows(dev_ctx,
+                                      x.data(),
+                                      mean.data(),
+                                      var.data(),
+                                      scale.data(),
+                                      out_grad.data(),
+                                      1e-5f,
+                                      x_grad.data(),
+                                      scale_grad.data(),
+                                      bias_grad.data(),
+                                      rows,
+                                      cols);
+      },
+      &single,
+      &parallel);
+  Report("layer_norm_grad", cols, 0, single, parallel);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv, 10, 100);
+  std::stringstream cols(FLAGS_cols);
+  std::string item;
+  while (std::getline(cols, item, ',')) {
+    Benchmark(std::stoll(item));
+  }
+  return 0;
+}
@@ -0,0 +1,210 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times the top-k of the selection kernels on retrieval shapes, a batch of
+// scores over a large vocabulary, and the argsort of short rows, against
+// the std::partial_sort, std::nth_element and std::sort of pairs the CPU
+// kernels used before them, e.g.
+//   cpu_selection_benchmark --rows=1,16 --cols=1000000 --k=100,1000
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_selection.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+
+DEFINE_string(rows, "1,16", "The rows of the top-k input.");
+DEFINE_int64(cols, 1000000, "The cols of the top-k input.");
+DEFINE_string(k, "100,1000", "The k of the top-k.");
+DEFINE_int64(sort_rows, 4096, "The rows of the argsort input.");
+DEFINE_string(sort_cols, "32,128,1024", "The cols of the argsort input.");
+DEFINE_int32(threads, 4, "The threads of the parallel runs.");
+
+namespace {
+
+using phi::tests::TimeMs;
+
+using Pair = std::pair<float, int64_t>;
+
+std::vector<int64_t> ParseList(const std::string& list) {
+  std::vector<int64_t> result;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    result.push_back(std::stoll(item));
+  }
+  return result;
+}
+
+bool Greater(const Pair& l, const Pair& r) {
+  return (std::isnan(l.first) && !std::isnan(r.first)) || l.first > r.first;
+}
+
+// The largest k of each row as the CPU top_k kernel computed them before.
+void StdTopK(const float* x,
+             int64_t rows,
+             int64_t cols,
+             int64_t k,
+             float* values,
+             int64_t* indices) {
+  for (int64_t r = 0; r < rows; ++r) {
+    std::vector<Pair> row;
+    row.reserve(cols);
+    for (int64_t j = 0; j < cols; ++j) {
+      row.emplace_back(x[r * cols + j], j);
+    }
+    if (k * 64 < cols) {
+      std::partial_sort(row.begin(), row.begin() + k, row.end(), Greater);
+    } else {
+      std::nth_element(row.begin(), row.begin() + k - 1, row.end(), Greater);
+      std::sort(row.begin(), row.begin() + k - 1, Greater);
+    }
+    for (int64_t j = 0; j < k; ++j) {
+      values[r * k + j] = row[j].first;
+      indices[r * k + j] = row[j].second;
+    }
+  }
+}
+
+void StdSort(const float* x,
+             int64_t rows,
+             int64_t cols,
+             float* values,
+             int64_t* indices) {
+  for (int64_t r = 0; r < rows; ++r) {
+    std::vector<Pair> row;
+    row.reserve(cols);
+    for (int64_t j = 0; j < cols; ++j) {
+      row.emplace_back(x[r * cols + j], j);
+    }
+    std::sort(row.begin(), row.end(), Greater);
+    for (int64_t j = 0; j < cols; ++j) {
+      values[r * cols + j] = row[j].first;
+      indices[r * cols + j] = row[j].second;
+    }
+  }
+}
+
+std::vector<float> RandomScores(int64_t n) {
+  std::mt19937 rng(100);
+  std::normal_distribution<float> dist(0.f, 1.f);
+  std::vector<float> result(n);
+  for (auto& value : result) {
+    value = dist(rng);
+  }
+  return result;
+}
+
+// Runs func with one thread and then with FLAGS_threads.
+void TimeKernel(const std::function<void()>& func,
+                double* single,
+                double* parallel) {
+  phi::SetIntraOpNumThreads(1);
+  *single = TimeMs(func);
+  phi::SetIntraOpNumThreads(FLAGS_threads);
+  *parallel = TimeMs(func);
+  phi::SetIntraOpNumThreads(1);
+}
+
+void Report(const std::string& name,
+            double std,
+            double single,
+            double parallel) {
+  std::ostringstream os;
+  os << name << " std=" << std << "ms kernel=" << single << "ms kernel_"
+     << FLAGS_threads << "_threads=" << parallel << "ms";
+  LOG(INFO) << os.str();
+}
+
+void BenchmarkTopK(int64_t rows, int64_t k) {
+  const int64_t cols = FLAGS_cols;
+  phi::CPUContext dev_ctx;
+  auto x = RandomScores(rows * cols);
+  std::vector<float> values(rows * k);
+  std::vector<int64_t> indices(rows * k);
+  double std = TimeMs([&] {
+    StdTopK(x.data(), rows, cols, k, values.data(), indices.data());
+  });
+  double single = 0;
+  double parallel = 0;
+  TimeKernel(
+      [&] {
+        phi::funcs::TopKRows(dev_ctx,
+                             x.data(),
+                             rows,
+                             cols,
+                             k,
+                             true,
+                             true,
+                             values.data(),
+                             indices.data());
+      },
+      &single,
+      &parallel);
+  std::ostringstream name;
+  name << "top_k rows=" << rows << " cols=" << cols << " k=" << k;
+  Report(name.str(), std, single, parallel);
+}
+
+void BenchmarkSort(int64_t cols) {
+  const int64_t rows = FLAGS_sort_rows;
+  phi::CPUContext dev_ctx;
+  auto x = RandomScores(rows * cols);
+  std::vector<float> values(rows * cols);
+  std::vector<int64_t> indices(rows * cols);
+  double std = TimeMs([&] {
+    StdSort(x.data(), rows, cols, values.data(), indices.data());
+  });
+  double single = 0;
+  double parallel = 0;
+  TimeKernel(
+      [&] {
+        phi::funcs::SortRows(dev_ctx,
+                             x.data(),
+                             rows,
+                             cols,
+                             true,
+                             values.data(),
+                             indices.data());
+      },
+      &single,
+      &parallel);
+  std::ostringstream name;
+  name << "argsort rows=" << rows << " cols=" << cols;
+  Report(name.str(), std, single, parallel);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv);
+  for (int64_t rows : ParseList(FLAGS_rows)) {
+    for (int64_t k : ParseList(FLAGS_k)) {
+      BenchmarkTopK(rows, k);
+    }
+  }
+  for (int64_t cols : ParseList(FLAGS_sort_cols)) {
+    BenchmarkSort(cols);
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+namespace tests {
+
+// n values drawn uniformly from [lower, upper), the same for the same seed.
+template <typename T>
+std::vector<T> RandomVector(int64_t n,
+                            double lower,
+                            double upper,
+                            uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> dist(lower, upper);
+  std::vector<T> result(n);
+  for (auto& value : result) {
+    value = static_cast<T>(dist(rng));
+  }
+  return result;
+}
+
+// Sets the intra op threads of the calling thread for a scope, and restores
+// the previous count on exit, also when an assertion returns early.
+class ScopedIntraOpNumThreads {
+ public:
+  explicit ScopedIntraOpNumThreads(int num_threads)
+      : previous_(GetIntraOpNumThreads()) {
+    SetIntraOpNumThreads(num_threads);
+  }
+
+  ~ScopedIntraOpNumThreads() { SetIntraOpNumThreads(previous_); }
+
+  ScopedIntraOpNumThreads(const ScopedIntraOpNumThreads&) = delete;
+  ScopedIntraOpNumThreads& operator=(const ScopedIntraOpNumThreads&) = delete;
+
+ private:
+  int previous_;
+};
+
+}  // namespace tests
+}  // namespace phi
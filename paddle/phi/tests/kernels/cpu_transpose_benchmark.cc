@@ -0,0 +1,113 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times funcs::Permute against the Eigen shuffle funcs::Transpose used to
+// run, on the layout changes of conv layers and the head transposes of
+// attention layers, e.g.
+//   cpu_transpose_benchmark --batch=8 --threads=8
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+#include "unsupported/Eigen/CXX11/Tensor"
+
+DEFINE_int64(batch, 1, "The batch size of the inputs.");
+DEFINE_int32(threads, 1, "The threads of the runs.");
+
+namespace {
+
+using phi::tests::Time;
+
+struct Case {
+  const char* name;
+  std::vector<int64_t> dims;
+  std::vector<int> axis;
+};
+
+template <int Rank>
+void EigenShuffle(const float* x,
+                  const std::vector<int64_t>& dims,
+                  const std::vector<int>& axis,
+                  float* out) {
+  Eigen::DSizes<Eigen::DenseIndex, Rank> in_dims;
+  Eigen::DSizes<Eigen::DenseIndex, Rank> out_dims;
+  Eigen::array<int, Rank> permute;
+  for (int i = 0; i < Rank; ++i) {
+    in_dims[i] = dims[i];
+    out_dims[i] = dims[axis[i]];
+    permute[i] = axis[i];
+  }
+  Eigen::TensorMap<Eigen::Tensor<const float, Rank, Eigen::RowMajor>> in(
+      x, in_dims);
+  Eigen::TensorMap<Eigen::Tensor<float, Rank, Eigen::RowMajor>> result(
+      out, out_dims);
+  Eigen::DefaultDevice device;
+  result.device(device) = in.shuffle(permute);
+}
+
+void Benchmark(const Case& c) {
+  phi::CPUContext dev_ctx;
+  int64_t numel = 1;
+  for (auto dim : c.dims) {
+    numel *= dim;
+  }
+  std::vector<float> x(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    x[i] = static_cast<float>(i % 1000);
+  }
+  std::vector<float> out(numel);
+
+  double eigen = Time([&] {
+    if (c.dims.size() == 2) {
+      EigenShuffle<2>(x.data(), c.dims, c.axis, out.data());
+    } else {
+      EigenShuffle<4>(x.data(), c.dims, c.axis, out.data());
+    }
+  });
+  double permute = Time([&] {
+    phi::funcs::Permute(
+        dev_ctx, x.data(), c.dims, c.axis, sizeof(float), out.data());
+  });
+  std::ostringstream os;
+  os << c.name << " eigen_shuffle=" << eigen << "us permute=" << permute
+     << "us " << 2. * numel * sizeof(float) / permute / 1e3 << "GB/s";
+  LOG(INFO) << os.str();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv);
+  phi::SetIntraOpNumThreads(FLAGS_threads);
+  const int64_t n = FLAGS_batch;
+  const Case cases[] = {
+      {"nchw_to_nhwc_64x112x112", {n, 64, 112, 112}, {0, 2, 3, 1}},
+      {"nchw_to_nhwc_256x56x56", {n, 256, 56, 56}, {0, 2, 3, 1}},
+      {"nhwc_to_nchw_256x56x56", {n, 56, 56, 256}, {0, 3, 1, 2}},
+      {"nchw_to_nhwc_3x224x224", {n, 3, 224, 224}, {0, 2, 3, 1}},
+      {"bert_split_heads_128x12x64", {n, 128, 12, 64}, {0, 2, 1, 3}},
+      {"bert_key_transpose_12x128x64", {n, 12, 128, 64}, {0, 1, 3, 2}},
+      {"matrix_2048x2048", {2048, 2048}, {1, 0}},
+  };
+  for (const auto& c : cases) {
+    Benchmark(c);
+  }
+  return 0;
+}
@@ -0,0 +1,175 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Times the CPU sparse conv3d and its grad on the voxels of a simulated
+// 64-beam LiDAR sweep over a KITTI-sized grid, e.g.
+//   sparse_conv3d_benchmark --sweeps=2 --threads=8
+
+#include <cmath>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/sparse/convolution_grad_kernel.h"
+#include "paddle/phi/kernels/sparse/convolution_kernel.h"
+#include "paddle/phi/tests/kernels/benchmark.h"
+
+DEFINE_int32(sweeps, 1, "The LiDAR sweeps in the batch.");
+DEFINE_int32(azimuths, 2048, "The points of a beam in a sweep.");
+DEFINE_int32(in_channels, 16, "The channels of the input.");
+DEFINE_int32(out_channels, 16, "The channels of the output.");
+DEFINE_int32(threads, 4, "The threads of the parallel runs.");
+
+namespace {
+
+using phi::tests::TimeMs;
+
+// The voxel grid of (D, H, W) = (41, 1600, 1408) covers z in [-3, 1.1),
+// y in [-40, 40) and x in [0, 70.4) meters.
+constexpr int kDepth = 41;
+constexpr int kHeight = 1600;
+constexpr int kWidth = 1408;
+constexpr double kVoxelXY = 0.05;
+constexpr double kVoxelZ = 0.1;
+
+// The sorted (batch, z, y, x) voxels hit by 64 beams from -24.8 to 2
+// degrees of elevation, mounted 1.73m above a flat ground scattered with
+// box obstacles.
+std::vector<std::vector<int>> LidarVoxels() {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::set<std::vector<int>> voxels;
+  const double pi = std::acos(-1.);
+  for (int sweep = 0; sweep < FLAGS_sweeps; ++sweep) {
+    for (int beam = 0; beam < 64; ++beam) {
+      double elevation = (-24.8 + 26.8 * beam / 63.) * pi / 180.;
+      for (int a = 0; a < FLAGS_azimuths; ++a) {
+        double azimuth = (a + uniform(rng)) * 2 * pi / FLAGS_azimuths;
+        double range = elevation < 0 ? 1.73 / std::tan(-elevation) : 80.;
+        if (uniform(rng) < 0.3) {
+          // An obstacle between 3m and the ground hit.
+          range = 3. + uniform(rng) * (std::min(range, 70.) - 3.);
+        }
+        double x = range * std::cos(azimuth);
+        double y = range * std::sin(azimuth);
+        double z = 1.73 + range * std::tan(elevation) - 3.;
+        int vx = static_cast<int>(x / kVoxelXY);
+        int vy = static_cast<int>((y + 40.) / kVoxelXY);
+        int vz = static_cast<int>((z + 3.) / kVoxelZ);
+        if (vx < 0 || vx >= kWidth || vy < 0 || vy >= kHeight || vz < 0 ||
+            vz >= kDepth) {
+          continue;
+        }
+        voxels.insert({sweep, vz, vy, vx});
+      }
+    }
+  }
+  return std::vector<std::vector<int>>(voxels.begin(), voxels.end());
+}
+
+void Benchmark(const phi::CPUContext& dev_ctx, bool subm) {
+  auto voxels = LidarVoxels();
+  const int nnz = voxels.size();
+  phi::DenseTensor indices = phi::Empty(
+      dev_ctx,
+      phi::DenseTensorMeta(
+          phi::DataType::INT32, {4, nnz}, phi::DataLayout::NCHW));
+  for (int i = 0; i < nnz; ++i) {
+    for (int d = 0; d < 4; ++d) {
+      indices.data<int>()[d * nnz + i] = voxels[i][d];
+    }
+  }
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  phi::DenseTensor features = phi::Empty(
+      dev_ctx,
+      phi::DenseTensorMeta(phi::DataType::FLOAT32,
+                           {nnz, FLAGS_in_channels},
+                           phi::DataLayout::NHWC));
+  for (int64_t i = 0; i < features.numel(); ++i) {
+    features.data<float>()[i] = dist(rng);
+  }
+  phi::SparseCooTensor x(
+      indices,
+      features,
+      {FLAGS_sweeps, kDepth, kHeight, kWidth, FLAGS_in_channels});
+  phi::DenseTensor kernel = phi::Empty(
+      dev_ctx,
+      phi::DenseTensorMeta(phi::DataType::FLOAT32,
+                           {3, 3, 3, FLAGS_in_channels, FLAGS_out_channels},
+                           phi::DataLayout::NHWC));
+  for (int64_t i = 0; i < kernel.numel(); ++i) {
+    kernel.data<float>()[i] = dist(rng);
+  }
+
+  const std::vector<int> paddings = {1, 1, 1};
+  const std::vector<int> dilations = {1, 1, 1};
+  const std::vector<int> strides =
+      subm ? std::vector<int>{1, 1, 1} : std::vector<int>{2, 2, 2};
+  phi::DenseTensor rulebook;
+  phi::SparseCooTensor out;
+  auto forward = [&] {
+    out = phi::sparse::Conv3d<float>(
+        dev_ctx, x, kernel, paddings, dilations, strides, 1, subm, &rulebook);
+  };
+  auto backward = [&] {
+    phi::sparse::Conv3dGrad<float>(dev_ctx,
+                                   x,
+                                   kernel,
+                                   rulebook,
+                                   out,
+                                   paddings,
+                                   dilations,
+                                   strides,
+                                   1,
+                                   subm);
+  };
+
+  std::ostringstream os;
+  os << (subm ? "subm_conv3d" : "conv3d_stride2") << " voxels=" << nnz
+     << " channels=" << FLAGS_in_channels << "x" << FLAGS_out_channels;
+  for (int threads : {1, FLAGS_threads}) {
+    phi::SetIntraOpNumThreads(threads);
+    double forward_time = TimeMs(forward);
+    double backward_time = TimeMs(backward);
+    os << " threads=" << threads << ": forward=" << forward_time
+       << "ms backward=" << backward_time << "ms";
+  }
+  phi::SetIntraOpNumThreads(1);
+  LOG(INFO) << os.str() << " rulebook=" << rulebook.dims()[1]
+            << " out_voxels=" << out.nnz();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  phi::tests::InitBenchmark(&argc, &argv, 1, 5);
+  phi::CPUContext dev_ctx;
+  auto allocator = paddle::memory::allocation::AllocatorFacade::Instance()
+                       .GetAllocator(paddle::platform::CPUPlace())
+                       .get();
+  dev_ctx.SetAllocator(allocator);
+  dev_ctx.SetHostAllocator(allocator);
+  dev_ctx.Init();
+  Benchmark(dev_ctx, true);
+  Benchmark(dev_ctx, false);
+  return 0;
+}
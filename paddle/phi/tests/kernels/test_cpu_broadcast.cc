@@ -0,0 +1,190 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/cpu_broadcast.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+using funcs::CpuBroadcastPlan;
+
+CpuBroadcastPlan MakePlan(const std::vector<int>& x_dims,
+                          const std::vector<int>& y_dims) {
+  std::vector<int> out_dims(x_dims.size());
+  for (size_t i = 0; i < x_dims.size(); ++i) {
+    out_dims[i] = std::max(x_dims[i], y_dims[i]);
+  }
+  return funcs::MakeCpuBroadcastPlan(x_dims.data(),
+                                     y_dims.data(),
+                                     out_dims.data(),
+                                     static_cast<int>(x_dims.size()));
+}
+
+TEST(CpuBroadcast, plan) {
+  auto same = MakePlan({2, 3, 4}, {2, 3, 4});
+  EXPECT_EQ(same.out_dims, std::vector<int64_t>({24}));
+
+  auto scalar = MakePlan({2, 3, 4}, {1, 1, 1});
+  EXPECT_EQ(scalar.y_strides, std::vector<int64_t>({0}));
+
+  auto row = MakePlan({2, 3, 4, 5}, {1, 1, 4, 5});
+  EXPECT_EQ(row.out_dims, std::vector<int64_t>({6, 20}));
+  EXPECT_EQ(row.y_strides, std::vector<int64_t>({0, 1}));
+
+  auto column = MakePlan({2, 3, 4, 5}, {2, 3, 1, 1});
+  EXPECT_EQ(column.out_dims, std::vector<int64_t>({6, 20}));
+  EXPECT_EQ(column.y_strides, std::vector<int64_t>({1, 0}));
+
+  auto general = MakePlan({2, 3, 1, 5}, {1, 3, 4, 1});
+  EXPECT_EQ(general.out_dims, std::vector<int64_t>({2, 3, 4, 5}));
+  EXPECT_EQ(general.x_strides, std::vector<int64_t>({15, 5, 0, 1}));
+  EXPECT_EQ(general.y_strides, std::vector<int64_t>({0, 4, 1, 0}));
+}
+
+template <typename Functor, typename Activation>
+void CheckBroadcast(const std::vector<int>& x_dims,
+                    const std::vector<int>& y_dims,
+                    Functor func,
+                    Activation act) {
+  int ndim = static_cast<int>(x_dims.size());
+  std::vector<int> out_dims(ndim);
+  int64_t x_numel = 1;
+  int64_t y_numel = 1;
+  int64_t out_numel = 1;
+  for (int i = 0; i < ndim; ++i) {
+    out_dims[i] = std::max(x_dims[i], y_dims[i]);
+    x_numel *= x_dims[i];
+    y_numel *= y_dims[i];
+    out_numel *= out_dims[i];
+  }
+  std::vector<float> x(x_numel);
+  std::vector<float> y(y_numel);
+  for (int64_t i = 0; i < x_numel; ++i) {
+    x[i] = static_cast<float>(i % 17) - 8.f;
+  }
+  for (int64_t i = 0; i < y_numel; ++i) {
+    y[i] = static_cast<float>(i % 13) * 0.5f - 2.75f;
+  }
+
+  std::vector<float> expected(out_numel);
+  std::vector<int> index(ndim, 0);
+  for (int64_t i = 0; i < out_numel; ++i) {
+    int64_t x_offset = 0;
+    int64_t y_offset = 0;
+    for (int d = 0; d < ndim; ++d) {
+      x_offset = x_offset * x_dims[d] + (x_dims[d] == 1 ? 0 : index[d]);
+      y_offset = y_offset * y_dims[d] + (y_dims[d] == 1 ? 0 : index[d]);
+    }
+    expected[i] = act(func(x[x_offset], y[y_offset]));
+    for (int d = ndim - 1; d >= 0 && ++index[d] == out_dims[d]; --d) {
+      index[d] = 0;
+    }
+  }
+
+  CPUContext dev_ctx;
+  std::vector<float> out(out_numel);
+  auto plan = funcs::MakeCpuBroadcastPlan(
+      x_dims.data(), y_dims.data(), out_dims.data(), ndim);
+  funcs::RunCpuBroadcastPlan(
+      dev_ctx, plan, x.data(), y.data(), out.data(), func, act);
+  for (int64_t i = 0; i < out_numel; ++i) {
+    ASSERT_NEAR(out[i], expected[i], 1e-5) << "at " << i;
+  }
+}
+
+template <typename Functor>
+void CheckBroadcastShapes(Functor func) {
+  std::vector<std::vector<std::vector<int>>> shapes = {
+      {{4, 300}, {4, 300}},
+      {{3, 5000}, {1, 1}},
+      {{1, 1}, {3, 5000}},
+      {{8, 1000}, {1, 1000}},
+      {{1, 1000}, {8, 1000}},
+      {{8, 1000}, {8, 1}},
+      {{2, 3, 1, 70}, {1, 3, 4, 1}},
+      {{2, 16, 20000}, {1, 16, 1}},
+      {{2, 1, 3}, {2, 1, 3}},
+  };
+  for (auto& shape : shapes) {
+    CheckBroadcast(shape[0], shape[1], func, funcs::BroadcastNoActivation());
+    CheckBroadcast(
+        shape[0], shape[1], func, funcs::BroadcastReluActivation());
+    CheckBroadcast(
+        shape[0], shape[1], func, funcs::BroadcastSigmoidActivation());
+    CheckBroadcast(
+        shape[0], shape[1], func, funcs::BroadcastTanhActivation());
+  }
+}
+
+TEST(CpuBroadcast, compute) {
+  CheckBroadcastShapes(funcs::AddFunctor<float>());
+  CheckBroadcastShapes(funcs::InverseAddFunctor<float>());
+  CheckBroadcastShapes(funcs::SubtractFunctor<float>());
+  CheckBroadcastShapes(funcs::InverseSubtractFunctor<float>());
+  CheckBroadcastShapes(funcs::MultiplyFunctor<float>());
+  CheckBroadcastShapes(funcs::InverseMultiplyFunctor<float>());
+  CheckBroadcastShapes(funcs::DivideFunctor<float>());
+}
+
+TEST(CpuBroadcast, parallel) {
+  ScopedIntraOpNumThreads threads(4);
+  CheckBroadcastShapes(funcs::AddFunctor<float>());
+  CheckBroadcastShapes(funcs::SubtractFunctor<float>());
+}
+
+TEST(CpuBroadcast, dense_tensor) {
+  const auto alloc = std::make_unique<paddle::experimental::DefaultAllocator>(
+      paddle::platform::CPUPlace());
+  DenseTensor x(alloc.get(),
+                DenseTensorMeta(DataType::INT32,
+                                make_ddim({2, 3, 4}),
+                                DataLayout::NCHW));
+  DenseTensor y(alloc.get(),
+                DenseTensorMeta(
+                    DataType::INT32, make_ddim({3}), DataLayout::NCHW));
+  auto* x_data = x.mutable_data<int>(paddle::platform::CPUPlace());
+  auto* y_data = y.mutable_data<int>(paddle::platform::CPUPlace());
+  for (int i = 0; i < 24; ++i) {
+    x_data[i] = i;
+  }
+  for (int i = 0; i < 3; ++i) {
+    y_data[i] = i * 100;
+  }
+
+  CPUContext dev_ctx;
+  dev_ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                           .GetAllocator(paddle::platform::CPUPlace())
+                           .get());
+  dev_ctx.Init();
+  DenseTensor out;
+  out.Resize(x.dims());
+  funcs::CpuBroadcastCompute<funcs::AddFunctor<int>, int>(
+      dev_ctx, x, y, 1, funcs::AddFunctor<int>(), &out);
+  const int* out_data = out.data<int>();
+  for (int i = 0; i < 24; ++i) {
+    ASSERT_EQ(out_data[i], i + i / 4 % 3 * 100);
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,169 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+using funcs::Conv2dAlgorithm;
+using funcs::Conv2dShape;
+
+Conv2dShape MakeShape(int64_t batch,
+                      int64_t in_channels,
+                      int64_t size,
+                      int64_t out_channels,
+                      int64_t kernel,
+                      int64_t stride,
+                      int64_t pad,
+                      int64_t dilation = 1,
+                      int64_t groups = 1) {
+  Conv2dShape shape;
+  shape.batch = batch;
+  shape.in_channels = in_channels;
+  shape.in_h = size;
+  shape.in_w = size + 3;
+  shape.out_channels = out_channels;
+  shape.kernel_h = kernel;
+  shape.kernel_w = kernel;
+  shape.stride_h = stride;
+  shape.stride_w = stride;
+  shape.pad_top = pad;
+  shape.pad_left = pad;
+  shape.dilation_h = dilation;
+  shape.dilation_w = dilation;
+  shape.groups = groups;
+  int64_t extent = dilation * (kernel - 1) + 1;
+  shape.out_h = (shape.in_h + 2 * pad - extent) / stride + 1;
+  shape.out_w = (shape.in_w + 2 * pad - extent) / stride + 1;
+  return shape;
+}
+
+std::vector<float> NaiveConv2d(const Conv2dShape& s,
+                               const std::vector<float>& input,
+                               const std::vector<float>& filter) {
+  std::vector<float> output(s.batch * s.out_channels * s.out_h * s.out_w);
+  const int64_t in_step = s.in_channels / s.groups;
+  const int64_t out_step = s.out_channels / s.groups;
+  for (int64_t n = 0; n < s.batch; ++n) {
+    for (int64_t o = 0; o < s.out_channels; ++o) {
+      for (int64_t oh = 0; oh < s.out_h; ++oh) {
+        for (int64_t ow = 0; ow < s.out_w; ++ow) {
+          double sum = 0;
+          for (int64_t c = 0; c < in_step; ++c) {
+            int64_t ic = o / out_step * in_step + c;
+            for (int64_t kh = 0; kh < s.kernel_h; ++kh) {
+              for (int64_t kw = 0; kw < s.kernel_w; ++kw) {
+                int64_t ih = oh * s.stride_h - s.pad_top + kh * s.dilation_h;
+                int64_t iw = ow * s.stride_w - s.pad_left + kw * s.dilation_w;
+                if (ih < 0 || ih >= s.in_h || iw < 0 || iw >= s.in_w) {
+                  continue;
+                }
+                sum += input[((n * s.in_channels + ic) * s.in_h + ih) *
+                                 s.in_w +
+                             iw] *
+                       filter[((o * in_step + c) * s.kernel_h + kh) *
+                                  s.kernel_w +
+                              kw];
+              }
+            }
+          }
+          output[((n * s.out_channels + o) * s.out_h + oh) * s.out_w + ow] =
+              sum;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+void CheckConv2d(const Conv2dShape& shape) {
+  auto input = RandomVector<float>(
+      shape.batch * shape.in_channels * shape.in_h * shape.in_w, -1., 1., 7);
+  auto filter = RandomVector<float>(shape.out_channels * shape.in_channels /
+                                        shape.groups * shape.kernel_h *
+                                        shape.kernel_w,
+                                    -1.,
+                                    1.,
+                                    8);
+  auto expected = NaiveConv2d(shape, input, filter);
+
+  CPUContext dev_ctx;
+  for (auto algorithm : {Conv2dAlgorithm::kIm2colGemm,
+                         Conv2dAlgorithm::kGemm1x1,
+                         Conv2dAlgorithm::kDirect,
+                         Conv2dAlgorithm::kWinogradF2x3,
+                         Conv2dAlgorithm::kWinogradF4x3}) {
+    if (!funcs::IsConv2dAlgorithmSupported(shape, algorithm)) {
+      continue;
+    }
+    std::vector<float> output(expected.size(), -1.f);
+    funcs::Conv2dForward(dev_ctx,
+                         shape,
+                         algorithm,
+                         input.data(),
+                         filter.data(),
+                         output.data());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_NEAR(output[i], expected[i], 1e-3)
+          << funcs::Conv2dAlgorithmName(algorithm) << " at " << i;
+    }
+  }
+}
+
+TEST(CpuConv, algorithms) {
+  CheckConv2d(MakeShape(2, 16, 9, 24, 3, 1, 1));
+  CheckConv2d(MakeShape(1, 8, 10, 13, 3, 1, 0));
+  CheckConv2d(MakeShape(2, 3, 11, 10, 7, 2, 3));
+  CheckConv2d(MakeShape(1, 4, 9, 5, 3, 2, 2, 2));
+  CheckConv2d(MakeShape(2, 12, 8, 20, 1, 1, 0));
+  CheckConv2d(MakeShape(1, 12, 9, 20, 1, 2, 0));
+  CheckConv2d(MakeShape(2, 16, 9, 16, 3, 1, 1, 1, 16));
+  CheckConv2d(MakeShape(1, 8, 10, 16, 3, 2, 1, 1, 8));
+  CheckConv2d(MakeShape(1, 8, 10, 16, 3, 1, 1, 1, 4));
+}
+
+TEST(CpuConv, parallel) {
+  ScopedIntraOpNumThreads threads(4);
+  CheckConv2d(MakeShape(3, 16, 12, 24, 3, 1, 1));
+  CheckConv2d(MakeShape(3, 32, 12, 32, 3, 1, 1, 1, 32));
+  CheckConv2d(MakeShape(3, 12, 20, 20, 1, 1, 0));
+}
+
+TEST(CpuConv, select) {
+  using funcs::SelectConv2dAlgorithm;
+  EXPECT_EQ(SelectConv2dAlgorithm(MakeShape(1, 64, 56, 64, 1, 1, 0)),
+            Conv2dAlgorithm::kGemm1x1);
+  EXPECT_EQ(SelectConv2dAlgorithm(MakeShape(1, 64, 56, 64, 3, 1, 1)),
+            Conv2dAlgorithm::kWinogradF4x3);
+  EXPECT_EQ(SelectConv2dAlgorithm(MakeShape(1, 256, 14, 256, 3, 1, 1)),
+            Conv2dAlgorithm::kWinogradF2x3);
+  EXPECT_EQ(SelectConv2dAlgorithm(MakeShape(1, 512, 7, 512, 3, 1, 1)),
+            Conv2dAlgorithm::kIm2colGemm);
+  EXPECT_EQ(SelectConv2dAlgorithm(MakeShape(1, 32, 56, 32, 3, 1, 1, 1, 32)),
+            Conv2dAlgorithm::kDirect);
+  EXPECT_EQ(SelectConv2dAlgorithm(MakeShape(1, 3, 224, 32, 3, 2, 1)),
+            Conv2dAlgorithm::kIm2colGemm);
+  EXPECT_EQ(SelectConv2dAlgorithm(MakeShape(1, 64, 56, 128, 3, 2, 1)),
+            Conv2dAlgorithm::kIm2colGemm);
+}
+
+}  // namespace tests
+}  // namespace phi
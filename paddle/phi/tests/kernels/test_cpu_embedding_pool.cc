@@ -0,0 +1,356 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_embedding_pool.h"
+#include "paddle/phi/kernels/funcs/embedding_util.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+using funcs::EmbeddingPoolType;
+
+struct Lookup {
+  int64_t height;
+  int64_t width;
+  int64_t slots;
+  std::vector<uint64_t> offsets;
+  std::vector<double> table;
+  std::vector<int64_t> ids;
+  std::vector<double> weights;
+};
+
+Lookup RandomLookup(int64_t height,
+                    int64_t width,
+                    int64_t slots,
+                    const std::vector<int>& lengths,
+                    int64_t padding_idx) {
+  std::mt19937 rng(height * 31 + width);
+  std::uniform_real_distribution<double> value(-1., 1.);
+  std::uniform_int_distribution<int64_t> id(0, height - 1);
+  Lookup lookup{height, width, slots, {0}, {}, {}, {}};
+  for (int length : lengths) {
+    lookup.offsets.push_back(lookup.offsets.back() + length);
+  }
+  lookup.table.resize(height * width);
+  for (auto& v : lookup.table) {
+    v = value(rng);
+  }
+  lookup.ids.resize(lookup.offsets.back() * slots);
+  lookup.weights.resize(lookup.ids.size());
+  for (size_t i = 0; i < lookup.ids.size(); ++i) {
+    // A few paddings, and many repeated ids for the gradient.
+    lookup.ids[i] = i % 7 == 3 && padding_idx != kNoPadding
+                        ? padding_idx
+                        : id(rng) % (height / 2 + 1);
+    lookup.weights[i] = value(rng) + 1.5;
+  }
+  return lookup;
+}
+
+// The pooled rows and the dense table gradient of a sum of the output.
+void NaivePool(const Lookup& lookup,
+               bool weighted,
+               EmbeddingPoolType type,
+               int64_t padding_idx,
+               const std::vector<double>& out_grad,
+               std::vector<double>* out,
+               std::vector<double>* grad) {
+  const int64_t width = lookup.width;
+  const int64_t slots = lookup.slots;
+  const int64_t num_seqs = lookup.offsets.size() - 1;
+  out->assign(num_seqs * slots * width, 0.);
+  grad->assign(lookup.height * width, 0.);
+  for (int64_t bag = 0; bag < num_seqs * slots; ++bag) {
+    const int64_t seq = bag / slots;
+    const int64_t slot = bag % slots;
+    double weight_sum = 0;
+    double square_sum = 0;
+    std::vector<int64_t> indices;
+    for (uint64_t j = lookup.offsets[seq]; j < lookup.offsets[seq + 1]; ++j) {
+      int64_t index = j * slots + slot;
+      if (lookup.ids[index] == padding_idx) {
+        continue;
+      }
+      double w = weighted ? lookup.weights[index] : 1.;
+      weight_sum += w;
+      square_sum += w * w;
+      indices.push_back(index);
+    }
+    double scale = 1.;
+    if (type == EmbeddingPoolType::kMean) {
+      scale = weight_sum != 0 ? 1. / weight_sum : 0.;
+    } else if (type == EmbeddingPoolType::kSqrt) {
+      scale = square_sum > 0 ? 1. / std::sqrt(square_sum) : 0.;
+    }
+    for (int64_t e = 0; e < width; ++e) {
+      double& o = (*out)[bag * width + e];
+      const double g = out_grad[bag * width + e];
+      int64_t argmax = -1;
+      for (int64_t index : indices) {
+        double w = weighted ? lookup.weights[index] : 1.;
+        double v = w * lookup.table[lookup.ids[index] * width + e];
+        if (type == EmbeddingPoolType::kMax) {
+          if (argmax < 0 || v > o) {
+            o = v;
+            argmax = index;
+          }
+        } else {
+          o += v * scale;
+          (*grad)[lookup.ids[index] * width + e] += w * scale * g;
+        }
+      }
+      if (argmax >= 0) {
+        double w = weighted ? lookup.weights[argmax] : 1.;
+        (*grad)[lookup.ids[argmax] * width + e] += w * g;
+      }
+    }
+  }
+}
+
+template <typename To, typename From>
+std::vector<To> Cast(const std::vector<From>& x) {
+  std::vector<To> out(x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    out[i] = static_cast<To>(x[i]);
+  }
+  return out;
+}
+
+template <typename T, typename IdT>
+void CheckPool(const Lookup& lookup,
+               bool weighted,
+               EmbeddingPoolType type,
+               int64_t padding_idx,
+               double tolerance) {
+  CPUContext dev_ctx;
+  const int64_t width = lookup.width;
+  const int64_t num_bags = (lookup.offsets.size() - 1) * lookup.slots;
+  auto table = Cast<T>(lookup.table);
+  auto ids = Cast<IdT>(lookup.ids);
+  auto weights = Cast<T>(lookup.weights);
+  std::vector<double> out_grad(num_bags * width);
+  for (size_t i = 0; i < out_grad.size(); ++i) {
+    out_grad[i] = static_cast<double>(i % 13) / 8. - 0.75;
+  }
+  auto out_grad_t = Cast<T>(out_grad);
+  // The rounded table is the reference of the lookup.
+  Lookup rounded = lookup;
+  rounded.table = Cast<double>(table);
+  rounded.weights = Cast<double>(weights);
+  std::vector<double> expected_out;
+  std::vector<double> expected_grad;
+  NaivePool(rounded,
+            weighted,
+            type,
+            padding_idx,
+            out_grad,
+            &expected_out,
+            &expected_grad);
+
+  std::vector<T> out(num_bags * width);
+  funcs::EmbeddingSeqPool(dev_ctx,
+                          table.data(),
+                          lookup.height,
+                          width,
+                          ids.data(),
+                          weighted ? weights.data() : nullptr,
+                          lookup.offsets,
+                          lookup.slots,
+                          type,
+                          padding_idx,
+                          out.data());
+  for (size_t i = 0; i < out.size(); ++i) {
+    ASSERT_NEAR(expected_out[i], static_cast<double>(out[i]), tolerance)
+        << "out at " << i;
+  }
+
+  auto groups = funcs::GroupEmbeddingIds(
+      ids.data(), static_cast<int64_t>(ids.size()), padding_idx);
+  for (size_t r = 1; r < groups.rows.size(); ++r) {
+    ASSERT_LT(groups.rows[r - 1], groups.rows[r]);
+  }
+  std::vector<T> dense(lookup.height * width, static_cast<T>(0));
+  funcs::EmbeddingSeqPoolGrad(dev_ctx,
+                              table.data(),
+                              width,
+                              ids.data(),
+                              weighted ? weights.data() : nullptr,
+                              lookup.offsets,
+                              lookup.slots,
+                              type,
+                              padding_idx,
+                              groups,
+                              out_grad_t.data(),
+                              true,
+                              dense.data());
+  std::vector<T> rows(groups.rows.size() * width);
+  funcs::EmbeddingSeqPoolGrad(dev_ctx,
+                              table.data(),
+                              width,
+                              ids.data(),
+                              weighted ? weights.data() : nullptr,
+                              lookup.offsets,
+                              lookup.slots,
+                              type,
+                              padding_idx,
+                              groups,
+                              out_grad_t.data(),
+                              false,
+                              rows.data());
+  for (size_t i = 0; i < dense.size(); ++i) {
+    ASSERT_NEAR(expected_grad[i], static_cast<double>(dense[i]), tolerance)
+        << "dense grad at " << i;
+  }
+  for (size_t r = 0; r < groups.rows.size(); ++r) {
+    for (int64_t e = 0; e < width; ++e) {
+      ASSERT_EQ(static_cast<double>(dense[groups.rows[r] * width + e]),
+                static_cast<double>(rows[r * width + e]));
+    }
+  }
+}
+
+template <typename T, typename IdT>
+void CheckTypes(const Lookup& lookup, int64_t padding_idx, double tolerance) {
+  for (auto type : {EmbeddingPoolType::kSum,
+                    EmbeddingPoolType::kMean,
+                    EmbeddingPoolType::kSqrt,
+                    EmbeddingPoolType::kMax}) {
+    for (bool weighted : {false, true}) {
+      CheckPool<T, IdT>(lookup, weighted, type, padding_idx, tolerance);
+    }
+  }
+}
+
+TEST(CpuEmbeddingPool, combiner) {
+  EXPECT_EQ(funcs::GetEmbeddingPoolType("sum"), EmbeddingPoolType::kSum);
+  EXPECT_EQ(funcs::GetEmbeddingPoolType("mean"), EmbeddingPoolType::kMean);
+  EXPECT_EQ(funcs::GetEmbeddingPoolType("sqrt"), EmbeddingPoolType::kSqrt);
+  EXPECT_EQ(funcs::GetEmbeddingPoolType("max"), EmbeddingPoolType::kMax);
+  EXPECT_ANY_THROW(funcs::GetEmbeddingPoolType("min"));
+}
+
+TEST(CpuEmbeddingPool, float) {
+  // Empty sequences, a single slot and several slots.
+  auto lookup = RandomLookup(50, 16, 1, {3, 0, 5, 1, 9}, kNoPadding);
+  CheckTypes<float, int64_t>(lookup, kNoPadding, 1e-5);
+  CheckTypes<float, int32_t>(lookup, kNoPadding, 1e-5);
+  lookup = RandomLookup(40, 7, 3, {4, 2, 0, 6}, 5);
+  CheckTypes<float, int64_t>(lookup, 5, 1e-5);
+}
+
+TEST(CpuEmbeddingPool, double) {
+  auto lookup = RandomLookup(30, 9, 2, {5, 1, 7}, 2);
+  CheckTypes<double, int64_t>(lookup, 2, 1e-12);
+  CheckTypes<double, int32_t>(lookup, 2, 1e-12);
+}
+
+TEST(CpuEmbeddingPool, bfloat16) {
+  auto lookup = RandomLookup(20, 8, 1, {4, 3, 6}, kNoPadding);
+  CheckTypes<phi::dtype::bfloat16, int64_t>(lookup, kNoPadding, 0.1);
+}
+
+TEST(CpuEmbeddingPool, parallel) {
+  ScopedIntraOpNumThreads threads(4);
+  std::vector<int> lengths(300);
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    lengths[i] = i % 17;
+  }
+  auto lookup = RandomLookup(1000, 64, 2, lengths, 0);
+  CheckTypes<float, int64_t>(lookup, 0, 1e-4);
+}
+
+TEST(CpuEmbeddingPool, lookup) {
+  CPUContext dev_ctx;
+  ScopedIntraOpNumThreads threads(4);
+  const int64_t height = 100;
+  const int64_t width = 33;
+  std::vector<float> table(height * width);
+  for (size_t i = 0; i < table.size(); ++i) {
+    table[i] = static_cast<float>(i);
+  }
+  std::vector<int32_t> ids(5000);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    ids[i] = (i * 37) % height;
+  }
+  std::vector<float> out(ids.size() * width);
+  funcs::EmbeddingLookup(dev_ctx,
+                         table.data(),
+                         height,
+                         width,
+                         ids.data(),
+                         static_cast<int64_t>(ids.size()),
+                         int64_t(3),
+                         out.data());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    for (int64_t e = 0; e < width; ++e) {
+      float expected = ids[i] == 3 ? 0.f : table[ids[i] * width + e];
+      ASSERT_EQ(expected, out[i * width + e]) << "at " << i;
+    }
+  }
+}
+
+TEST(CpuEmbeddingPool, out_of_range) {
+  CPUContext dev_ctx;
+  std::vector<float> table(4 * 2, 1.f);
+  std::vector<int64_t> ids = {1, 4};
+  std::vector<float> out(2);
+  EXPECT_ANY_THROW(funcs::EmbeddingSeqPool(dev_ctx,
+                                           table.data(),
+                                           4,
+                                           2,
+                                           ids.data(),
+                                           static_cast<float*>(nullptr),
+                                           {0, 2},
+                                           1,
+                                           EmbeddingPoolType::kSum,
+                                           kNoPadding,
+                                           out.data()));
+  // An id of -1 is not padding without a padding_idx.
+  ids = {1, -1};
+  EXPECT_ANY_THROW(funcs::EmbeddingSeqPool(dev_ctx,
+                                           table.data(),
+                                           4,
+                                           2,
+                                           ids.data(),
+                                           static_cast<float*>(nullptr),
+                                           {0, 2},
+                                           1,
+                                           EmbeddingPoolType::kSum,
+                                           kNoPadding,
+                                           out.data()));
+  std::vector<float> rows(ids.size() * 2);
+  EXPECT_ANY_THROW(funcs::EmbeddingLookup(dev_ctx,
+                                          table.data(),
+                                          4,
+                                          2,
+                                          ids.data(),
+                                          static_cast<int64_t>(ids.size()),
+                                          kNoPadding,
+                                          rows.data()));
+  auto groups = funcs::GroupEmbeddingIds(
+      ids.data(), static_cast<int64_t>(ids.size()), kNoPadding);
+  EXPECT_EQ(groups.rows, std::vector<int64_t>({-1, 1}));
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,169 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_jit.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+using funcs::JitActivation;
+
+void CheckReduceRows(int64_t rows, int64_t cols, bool mean) {
+  CPUContext dev_ctx;
+  auto x = RandomVector<float>(rows * cols, -1., 1., rows + cols);
+  std::vector<float> y(rows);
+  funcs::JitReduceRows(dev_ctx, x.data(), rows, cols, mean, y.data());
+  for (int64_t i = 0; i < rows; ++i) {
+    double expected = 0;
+    for (int64_t j = 0; j < cols; ++j) {
+      expected += x[i * cols + j];
+    }
+    if (mean) {
+      expected /= cols;
+    }
+    // The rounding of the float sums grows with cols.
+    ASSERT_NEAR(expected, y[i], 1e-6 * cols + 1e-5)
+        << "row " << i << " of " << cols;
+  }
+}
+
+TEST(CpuJit, reduce_rows) {
+  for (int64_t cols : {1, 3, 7, 8, 13, 64, 100, 1000, 4096}) {
+    CheckReduceRows(37, cols, false);
+    CheckReduceRows(37, cols, true);
+  }
+  CPUContext dev_ctx;
+  std::vector<float> x(funcs::kJitReduceMaxCols + 1);
+  float y = 0.f;
+  EXPECT_ANY_THROW(funcs::JitReduceRows(
+      dev_ctx, x.data(), 1, funcs::kJitReduceMaxCols + 1, false, &y));
+}
+
+TEST(CpuJit, reduce_rows_parallel) {
+  ScopedIntraOpNumThreads threads(4);
+  CheckReduceRows(5000, 33, false);
+  CheckReduceRows(300, 1024, true);
+}
+
+void CheckActivate(int n) {
+  auto x = RandomVector<float>(n, -1., 1., n);
+  for (auto& v : x) {
+    v *= 5.f;
+  }
+  std::vector<float> y(n);
+  funcs::JitActivate(JitActivation::kIdentity, x.data(), y.data(), n);
+  EXPECT_EQ(x, y);
+  funcs::JitActivate(JitActivation::kRelu, x.data(), y.data(), n);
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(x[i] > 0.f ? x[i] : 0.f, y[i]);
+  }
+  funcs::JitActivate(JitActivation::kSigmoid, x.data(), y.data(), n);
+  for (int i = 0; i < n; ++i) {
+    ASSERT_NEAR(1. / (1. + std::exp(-x[i])), y[i], 1e-5);
+  }
+  // In place.
+  y = x;
+  funcs::JitActivate(JitActivation::kTanh, y.data(), y.data(), n);
+  for (int i = 0; i < n; ++i) {
+    ASSERT_NEAR(std::tanh(x[i]), y[i], 1e-5);
+  }
+}
+
+TEST(CpuJit, activation) {
+  // The blocks of the jit code, with and without the tails.
+  for (int n : {77, funcs::kJitBlockSize, 3 * funcs::kJitBlockSize + 5}) {
+    CheckActivate(n);
+  }
+}
+
+template <typename T>
+void CheckAdam(int64_t numel, T coeff, double tolerance) {
+  CPUContext dev_ctx;
+  const T beta1 = 0.9;
+  const T beta2 = 0.99;
+  const T old_lr = 0.01;
+  const T lr_ratio = 0.5;
+  const T lr = old_lr * std::sqrt(1 - beta2 * beta2) / (1 - beta1 * beta1);
+  const T eps = 1e-8;
+  auto f_grad = RandomVector<float>(numel, -1., 1., 1);
+  auto f_mom1 = RandomVector<float>(numel, -1., 1., 2);
+  auto f_mom2 = RandomVector<float>(numel, -1., 1., 3);
+  auto f_param = RandomVector<float>(numel, -1., 1., 4);
+  std::vector<T> grad(f_grad.begin(), f_grad.end());
+  std::vector<T> mom1(f_mom1.begin(), f_mom1.end());
+  std::vector<T> mom2(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    mom2[i] = std::abs(f_mom2[i]);
+  }
+  std::vector<T> param(f_param.begin(), f_param.end());
+  std::vector<T> mom1_out(numel);
+  std::vector<T> mom2_out(numel);
+  std::vector<T> param_out(numel);
+  funcs::JitAdam(dev_ctx,
+                 beta1,
+                 beta2,
+                 lr,
+                 eps,
+                 old_lr,
+                 lr_ratio,
+                 coeff,
+                 numel,
+                 grad.data(),
+                 mom1.data(),
+                 mom2.data(),
+                 param.data(),
+                 mom1_out.data(),
+                 mom2_out.data(),
+                 param_out.data());
+  for (int64_t i = 0; i < numel; ++i) {
+    double g = grad[i];
+    double m1 = beta1 * mom1[i] + (1 - beta1) * g;
+    double m2 = beta2 * mom2[i] + (1 - beta2) * g * g;
+    double p = param[i] * (1 - old_lr * lr_ratio * coeff);
+    p -= lr * m1 / (std::sqrt(m2) + eps);
+    ASSERT_NEAR(m1, mom1_out[i], tolerance) << "at " << i;
+    ASSERT_NEAR(m2, mom2_out[i], tolerance) << "at " << i;
+    ASSERT_NEAR(p, param_out[i], tolerance) << "at " << i;
+  }
+}
+
+TEST(CpuJit, adam) {
+  for (int64_t numel : {1, 7, 8, 100, 1003}) {
+    CheckAdam<float>(numel, 0.f, 1e-5);
+    CheckAdam<double>(numel, 0., 1e-12);
+  }
+}
+
+TEST(CpuJit, adamw) {
+  for (int64_t numel : {1, 7, 8, 100, 1003}) {
+    CheckAdam<float>(numel, 0.01f, 1e-5);
+    CheckAdam<double>(numel, 0.01, 1e-12);
+  }
+}
+
+TEST(CpuJit, adam_parallel) {
+  ScopedIntraOpNumThreads threads(4);
+  CheckAdam<float>(100003, 0.f, 1e-5);
+  CheckAdam<float>(100003, 0.01f, 1e-5);
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,291 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/cpu_low_precision.h"
+#include "paddle/phi/kernels/funcs/cpu_row_kernels.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+using dtype::bfloat16;
+using dtype::float16;
+
+// The bfloat16 of x rounded to the nearest even.
+uint16_t RoundToBf16(float x) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  uint32_t lsb = (bits >> 16) & 1;
+  return static_cast<uint16_t>((bits + 0x7fff + lsb) >> 16);
+}
+
+template <typename T>
+std::vector<T> Round(const std::vector<float>& x) {
+  std::vector<T> y(x.size());
+  funcs::ConvertFromFloat(x.data(), static_cast<int64_t>(x.size()), y.data());
+  return y;
+}
+
+template <typename T>
+std::vector<float> Widen(const std::vector<T>& x) {
+  std::vector<float> y(x.size());
+  funcs::ConvertToFloat(x.data(), static_cast<int64_t>(x.size()), y.data());
+  return y;
+}
+
+TEST(CpuLowPrecision, bfloat16_convert) {
+  // Every length up to two vectors and a tail, with ties of both parities.
+  for (int n = 0; n < 40; ++n) {
+    auto x = RandomVector<float>(n, -100., 100., n);
+    if (n > 3) {
+      x[1] = 1.f + 1.f / 256.f;  // A tie rounded down to even.
+      x[2] = 1.f + 3.f / 256.f;  // A tie rounded up to even.
+      x[3] = 3.4e38f;            // Rounds up to the infinity.
+    }
+    auto y = Round<bfloat16>(x);
+    auto back = Widen(y);
+    for (int i = 0; i < n; ++i) {
+      ASSERT_EQ(RoundToBf16(x[i]), y[i].x) << "at " << i << " of " << n;
+      ASSERT_EQ(static_cast<float>(y[i]), back[i]);
+    }
+  }
+  std::vector<float> special = {std::numeric_limits<float>::quiet_NaN(),
+                                -std::numeric_limits<float>::quiet_NaN(),
+                                std::numeric_limits<float>::infinity(),
+                                -std::numeric_limits<float>::infinity(),
+                                0.f,
+                                -0.f};
+  auto y = Widen(Round<bfloat16>(special));
+  EXPECT_TRUE(std::isnan(y[0]));
+  EXPECT_TRUE(std::isnan(y[1]));
+  EXPECT_EQ(y[2], std::numeric_limits<float>::infinity());
+  EXPECT_EQ(y[3], -std::numeric_limits<float>::infinity());
+  EXPECT_EQ(y[4], 0.f);
+  EXPECT_TRUE(std::signbit(y[5]));
+}
+
+TEST(CpuLowPrecision, float16_convert) {
+  for (int n = 0; n < 40; ++n) {
+    auto x = RandomVector<float>(n, -1000., 1000., n);
+    auto y = Widen(Round<float16>(x));
+    for (int i = 0; i < n; ++i) {
+      // An ulp of the 11 bits of float16, as the CPUs without AVX512F may
+      // truncate.
+      ASSERT_LE(std::fabs(x[i] - y[i]), std::ldexp(std::fabs(x[i]), -10))
+          << "at " << i << " of " << n;
+    }
+  }
+  // The values float16 holds exactly survive the round trip.
+  std::vector<float> exact(100);
+  for (size_t i = 0; i < exact.size(); ++i) {
+    exact[i] = static_cast<float>(i) / 64.f - 0.75f;
+  }
+  EXPECT_EQ(exact, Widen(Round<float16>(exact)));
+}
+
+TEST(CpuLowPrecision, tensor) {
+  CPUContext dev_ctx;
+  dev_ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                           .GetAllocator(paddle::platform::CPUPlace())
+                           .get());
+  dev_ctx.Init();
+  ScopedIntraOpNumThreads threads(4);
+  const int64_t n = 100000;
+  auto x = RandomVector<float>(n, -10., 10., 1);
+  DenseTensor low;
+  low.Resize({n});
+  auto* low_data = dev_ctx.Alloc<bfloat16>(&low);
+  funcs::ConvertFromFloat(x.data(), n, low_data);
+  DenseTensor wide = funcs::ToFloat(dev_ctx, low);
+  ASSERT_EQ(wide.dtype(), DataType::FLOAT32);
+  DenseTensor out;
+  out.Resize({n});
+  funcs::FromFloat<bfloat16>(dev_ctx, wide, &out);
+  for (int64_t i = 0; i < n; ++i) {
+    ASSERT_EQ(static_cast<float>(low_data[i]), wide.data<float>()[i]);
+    ASSERT_EQ(low_data[i].x, out.data<bfloat16>()[i].x);
+  }
+}
+
+TEST(CpuLowPrecision, transform) {
+  CPUContext dev_ctx;
+  ScopedIntraOpNumThreads threads(4);
+  const int64_t n = 10000;
+  auto x = Round<bfloat16>(RandomVector<float>(n, -4., 4., 2));
+  auto y = Round<bfloat16>(RandomVector<float>(n, -4., 4., 3));
+  std::vector<bfloat16> out(n);
+  funcs::TransformAsFloat(
+      dev_ctx, x.data(), n, out.data(), [](float* v, int64_t len) {
+        for (int64_t i = 0; i < len; ++i) {
+          v[i] = 2.f * v[i] + 1.f;
+        }
+      });
+  for (int64_t i = 0; i < n; ++i) {
+    ASSERT_EQ(RoundToBf16(2.f * static_cast<float>(x[i]) + 1.f), out[i].x);
+  }
+  // In place, out being x.
+  auto x_copy = x;
+  funcs::TransformAsFloat(
+      dev_ctx,
+      x.data(),
+      y.data(),
+      n,
+      x.data(),
+      [](float* a, const float* b, int64_t len) {
+        for (int64_t i = 0; i < len; ++i) {
+          a[i] *= b[i];
+        }
+      });
+  for (int64_t i = 0; i < n; ++i) {
+    float expected = static_cast<float>(x_copy[i]) * static_cast<float>(y[i]);
+    ASSERT_EQ(RoundToBf16(expected), x[i].x);
+  }
+}
+
+template <typename T>
+void CheckGemm(bool trans_a,
+               bool trans_b,
+               int64_t M,
+               int64_t N,
+               int64_t K,
+               float alpha,
+               float beta) {
+  CPUContext dev_ctx;
+  auto a = Round<T>(RandomVector<float>(M * K, -1., 1., M + N));
+  auto b = Round<T>(RandomVector<float>(K * N, -1., 1., N + K));
+  auto c = Round<T>(RandomVector<float>(M * N, -1., 1., M + K));
+  auto a_f = Widen(a);
+  auto b_f = Widen(b);
+  auto c_f = Widen(c);
+  funcs::LowPrecisionGemm<T>(dev_ctx,
+                             trans_a,
+                             trans_b,
+                             M,
+                             N,
+                             K,
+                             alpha,
+                             a.data(),
+                             b.data(),
+                             beta,
+                             c.data());
+  auto out = Widen(c);
+  for (int64_t m = 0; m < M; ++m) {
+    for (int64_t n = 0; n < N; ++n) {
+      double sum = 0;
+      for (int64_t k = 0; k < K; ++k) {
+        double va = trans_a ? a_f[k * M + m] : a_f[m * K + k];
+        double vb = trans_b ? b_f[n * K + k] : b_f[k * N + n];
+        sum += va * vb;
+      }
+      double expected = alpha * sum + beta * c_f[m * N + n];
+      // The rounding of the output, and of the float sums.
+      double tolerance = std::fabs(expected) / 128. + 1e-5 * K;
+      ASSERT_NEAR(expected, out[m * N + n], tolerance)
+          << "at " << m << ", " << n << " of " << M << "x" << N << "x" << K
+          << " trans " << trans_a << trans_b;
+    }
+  }
+}
+
+template <typename T>
+void CheckGemms() {
+  for (bool trans_a : {false, true}) {
+    for (bool trans_b : {false, true}) {
+      // Full and partial panels and row blocks, and odd K.
+      CheckGemm<T>(trans_a, trans_b, 8, 32, 64, 1.f, 0.f);
+      CheckGemm<T>(trans_a, trans_b, 7, 21, 33, 0.5f, 1.f);
+      CheckGemm<T>(trans_a, trans_b, 1, 5, 1, 1.f, -2.f);
+      CheckGemm<T>(trans_a, trans_b, 13, 50, 130, 1.f, 0.f);
+      // The few rows reading B unpacked.
+      CheckGemm<T>(trans_a, trans_b, 2, 130, 100, 1.f, 0.5f);
+      CheckGemm<T>(trans_a, trans_b, 3, 64, 45, 2.f, 0.f);
+    }
+  }
+}
+
+TEST(CpuLowPrecision, bfloat16_gemm) {
+  CheckGemms<bfloat16>();
+  ScopedIntraOpNumThreads threads(4);
+  CheckGemm<bfloat16>(false, false, 67, 100, 257, 1.f, 0.f);
+}
+
+TEST(CpuLowPrecision, float16_gemm) { CheckGemms<float16>(); }
+
+TEST(CpuLowPrecision, rows) {
+  CPUContext dev_ctx;
+  const int64_t rows = 9;
+  const int64_t cols = 37;
+  auto x_f = RandomVector<float>(rows * cols, -3., 3., 4);
+  auto scale_f = RandomVector<float>(cols, 0.5, 1.5, 5);
+  auto bias_f = RandomVector<float>(cols, -1., 1., 6);
+  auto x = Round<bfloat16>(x_f);
+  auto scale = Round<bfloat16>(scale_f);
+  auto bias = Round<bfloat16>(bias_f);
+  x_f = Widen(x);
+  scale_f = Widen(scale);
+  bias_f = Widen(bias);
+
+  std::vector<bfloat16> out(rows * cols);
+  funcs::SoftmaxRows(dev_ctx, x.data(), out.data(), rows, cols);
+  std::vector<float> expected(rows * cols);
+  funcs::SoftmaxRows(dev_ctx, x_f.data(), expected.data(), rows, cols);
+  for (int64_t i = 0; i < rows * cols; ++i) {
+    ASSERT_EQ(RoundToBf16(expected[i]), out[i].x) << "softmax at " << i;
+  }
+
+  std::vector<bfloat16> mean(rows);
+  std::vector<bfloat16> var(rows);
+  std::vector<float> mean_f(rows);
+  std::vector<float> var_f(rows);
+  funcs::LayerNormRows(dev_ctx,
+                       x.data(),
+                       scale.data(),
+                       bias.data(),
+                       1e-5f,
+                       out.data(),
+                       mean.data(),
+                       var.data(),
+                       rows,
+                       cols);
+  funcs::LayerNormRows(dev_ctx,
+                       x_f.data(),
+                       scale_f.data(),
+                       bias_f.data(),
+                       1e-5f,
+                       expected.data(),
+                       mean_f.data(),
+                       var_f.data(),
+                       rows,
+                       cols);
+  for (int64_t i = 0; i < rows * cols; ++i) {
+    ASSERT_EQ(RoundToBf16(expected[i]), out[i].x) << "layer_norm at " << i;
+  }
+  for (int64_t i = 0; i < rows; ++i) {
+    ASSERT_EQ(RoundToBf16(mean_f[i]), mean[i].x);
+    ASSERT_EQ(RoundToBf16(var_f[i]), var[i].x);
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,195 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_row_kernels.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+const std::vector<int64_t> kTestCols = {1, 7, 8, 33, 256, 1031, 20000};
+constexpr int64_t kTestRows = 5;
+
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 1e-4 : 1e-10;
+}
+
+template <typename T>
+void CheckSoftmax(const CPUContext& dev_ctx, int64_t cols) {
+  int64_t numel = kTestRows * cols;
+  auto x = RandomVector<T>(numel, -30., 30., numel);
+  auto out_grad = RandomVector<T>(numel + 1, -1., 1., numel + 1);
+  std::vector<T> out(numel);
+  std::vector<T> log_out(numel);
+  std::vector<T> x_grad(numel);
+  std::vector<T> log_x_grad(numel);
+  funcs::SoftmaxRows(dev_ctx, x.data(), out.data(), kTestRows, cols);
+  funcs::LogSoftmaxRows(dev_ctx, x.data(), log_out.data(), kTestRows, cols);
+  funcs::SoftmaxGradRows(
+      dev_ctx, out.data(), out_grad.data(), x_grad.data(), kTestRows, cols);
+  funcs::LogSoftmaxGradRows(dev_ctx,
+                            log_out.data(),
+                            out_grad.data(),
+                            log_x_grad.data(),
+                            kTestRows,
+                            cols);
+
+  for (int64_t row = 0; row < kTestRows; ++row) {
+    const T* x_row = x.data() + row * cols;
+    const T* dy_row = out_grad.data() + row * cols;
+    double max = x_row[0];
+    for (int64_t i = 0; i < cols; ++i) {
+      max = std::max(max, static_cast<double>(x_row[i]));
+    }
+    double sum = 0;
+    double dy_sum = 0;
+    for (int64_t i = 0; i < cols; ++i) {
+      sum += std::exp(x_row[i] - max);
+      dy_sum += dy_row[i];
+    }
+    double dot = 0;
+    for (int64_t i = 0; i < cols; ++i) {
+      dot += dy_row[i] * std::exp(x_row[i] - max) / sum;
+    }
+    for (int64_t i = 0; i < cols; ++i) {
+      int64_t index = row * cols + i;
+      double softmax = std::exp(x_row[i] - max) / sum;
+      double log_softmax = x_row[i] - max - std::log(sum);
+      EXPECT_NEAR(out[index], softmax, Tolerance<T>());
+      EXPECT_NEAR(log_out[index], log_softmax, Tolerance<T>() * 10);
+      EXPECT_NEAR(x_grad[index], (dy_row[i] - dot) * softmax, Tolerance<T>());
+      EXPECT_NEAR(log_x_grad[index],
+                  dy_row[i] - softmax * dy_sum,
+                  Tolerance<T>() * 10);
+    }
+  }
+}
+
+template <typename T>
+void CheckLayerNorm(const CPUContext& dev_ctx, int64_t cols, bool affine) {
+  const float epsilon = 1e-5f;
+  int64_t numel = kTestRows * cols;
+  auto x = RandomVector<T>(numel, 95., 105., numel);
+  auto y_grad = RandomVector<T>(numel + 2, -1., 1., numel + 2);
+  auto scale = RandomVector<T>(cols + 3, 0.5, 1.5, cols + 3);
+  auto bias = RandomVector<T>(cols + 4, -1., 1., cols + 4);
+  const T* scale_data = affine ? scale.data() : nullptr;
+  std::vector<T> y(numel);
+  std::vector<T> mean(kTestRows);
+  std::vector<T> var(kTestRows);
+  std::vector<T> x_grad(numel);
+  std::vector<T> scale_grad(cols);
+  std::vector<T> bias_grad(cols);
+  funcs::LayerNormRows(dev_ctx,
+                       x.data(),
+                       scale_data,
+                       affine ? bias.data() : nullptr,
+                       epsilon,
+                       y.data(),
+                       mean.data(),
+                       var.data(),
+                       kTestRows,
+                       cols);
+  funcs::LayerNormGradRows(dev_ctx,
+                           x.data(),
+                           mean.data(),
+                           var.data(),
+                           scale_data,
+                           y_grad.data(),
+                           epsilon,
+                           x_grad.data(),
+                           scale_grad.data(),
+                           bias_grad.data(),
+                           kTestRows,
+                           cols);
+
+  std::vector<double> expected_scale_grad(cols, 0.);
+  std::vector<double> expected_bias_grad(cols, 0.);
+  for (int64_t row = 0; row < kTestRows; ++row) {
+    const T* x_row = x.data() + row * cols;
+    const T* dy_row = y_grad.data() + row * cols;
+    double row_mean = 0;
+    for (int64_t i = 0; i < cols; ++i) {
+      row_mean += x_row[i];
+    }
+    row_mean /= cols;
+    double row_var = 0;
+    for (int64_t i = 0; i < cols; ++i) {
+      row_var += (x_row[i] - row_mean) * (x_row[i] - row_mean);
+    }
+    row_var /= cols;
+    double rstd = 1. / std::sqrt(row_var + epsilon);
+    EXPECT_NEAR(mean[row], row_mean, Tolerance<T>() * 100);
+    EXPECT_NEAR(var[row], row_var, Tolerance<T>() * 10);
+
+    double grad_mean = 0;
+    double grad_norm_mean = 0;
+    for (int64_t i = 0; i < cols; ++i) {
+      double g = dy_row[i] * (affine ? scale[i] : 1.);
+      grad_mean += g / cols;
+      grad_norm_mean += g * (x_row[i] - row_mean) * rstd / cols;
+    }
+    for (int64_t i = 0; i < cols; ++i) {
+      int64_t index = row * cols + i;
+      double x_norm = (x_row[i] - row_mean) * rstd;
+      double expected = affine ? x_norm * scale[i] + bias[i] : x_norm;
+      EXPECT_NEAR(y[index], expected, Tolerance<T>() * 100);
+      double g = dy_row[i] * (affine ? scale[i] : 1.);
+      EXPECT_NEAR(x_grad[index],
+                  rstd * (g - grad_mean - x_norm * grad_norm_mean),
+                  Tolerance<T>() * 100);
+      expected_scale_grad[i] += dy_row[i] * x_norm;
+      expected_bias_grad[i] += dy_row[i];
+    }
+  }
+  for (int64_t i = 0; i < cols; ++i) {
+    EXPECT_NEAR(scale_grad[i], expected_scale_grad[i], Tolerance<T>() * 100);
+    EXPECT_NEAR(bias_grad[i], expected_bias_grad[i], Tolerance<T>() * 10);
+  }
+}
+
+TEST(CpuRowKernels, softmax) {
+  CPUContext dev_ctx;
+  for (auto cols : kTestCols) {
+    CheckSoftmax<float>(dev_ctx, cols);
+    CheckSoftmax<double>(dev_ctx, cols);
+  }
+}
+
+TEST(CpuRowKernels, layer_norm) {
+  CPUContext dev_ctx;
+  for (auto cols : kTestCols) {
+    CheckLayerNorm<float>(dev_ctx, cols, true);
+    CheckLayerNorm<float>(dev_ctx, cols, false);
+    CheckLayerNorm<double>(dev_ctx, cols, true);
+  }
+}
+
+TEST(CpuRowKernels, parallel) {
+  CPUContext dev_ctx;
+  ScopedIntraOpNumThreads threads(4);
+  for (auto cols : kTestCols) {
+    CheckSoftmax<float>(dev_ctx, cols);
+    CheckLayerNorm<float>(dev_ctx, cols, true);
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
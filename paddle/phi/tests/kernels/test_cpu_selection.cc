@@ -0,0 +1,196 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/cpu_selection.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+// Many equal values and, for floating points, NaN and signed zeros.
+template <typename T>
+std::vector<T> RandomRows(int64_t rows, int64_t cols) {
+  std::mt19937 rng(cols);
+  std::vector<T> x(rows * cols);
+  for (auto& value : x) {
+    value = static_cast<T>(static_cast<int>(rng() % 200) - 100);
+    if (std::is_floating_point<T>::value) {
+      int choice = rng() % 64;
+      if (choice == 0) {
+        value = std::numeric_limits<T>::quiet_NaN();
+      } else if (choice == 1) {
+        value = -0.;
+      } else if (choice < 32) {
+        value /= 7;
+      }
+    }
+  }
+  return x;
+}
+
+template <typename T>
+bool Less(T a, T b) {
+  return (!std::isnan(static_cast<double>(a)) &&
+          std::isnan(static_cast<double>(b))) ||
+         a < b;
+}
+
+// The indices of row in the order of a stable sort.
+template <typename T>
+std::vector<int64_t> StableOrder(const T* row, int64_t cols, bool descending) {
+  std::vector<int64_t> order(cols);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return descending ? Less(row[b], row[a]) : Less(row[a], row[b]);
+  });
+  return order;
+}
+
+template <typename T>
+void ExpectSame(T expected, T actual) {
+  if (std::isnan(static_cast<double>(expected))) {
+    EXPECT_TRUE(std::isnan(static_cast<double>(actual)));
+  } else {
+    EXPECT_EQ(expected, actual);
+  }
+}
+
+template <typename T>
+void CheckTopK(int64_t rows, int64_t cols, int64_t k) {
+  CPUContext dev_ctx;
+  auto x = RandomRows<T>(rows, cols);
+  std::vector<T> values(rows * k);
+  std::vector<int64_t> indices(rows * k);
+  for (bool largest : {true, false}) {
+    for (bool sorted : {true, false}) {
+      funcs::TopKRows(dev_ctx,
+                      x.data(),
+                      rows,
+                      cols,
+                      k,
+                      largest,
+                      sorted,
+                      values.data(),
+                      indices.data());
+      for (int64_t r = 0; r < rows; ++r) {
+        const T* row = x.data() + r * cols;
+        auto order = StableOrder(row, cols, largest);
+        std::vector<int64_t> expected(order.begin(), order.begin() + k);
+        std::vector<int64_t> actual(indices.begin() + r * k,
+                                    indices.begin() + (r + 1) * k);
+        for (int64_t i = 0; i < k; ++i) {
+          ExpectSame(row[actual[i]], values[r * k + i]);
+        }
+        if (!sorted) {
+          std::sort(expected.begin(), expected.end());
+          std::sort(actual.begin(), actual.end());
+        }
+        ASSERT_EQ(expected, actual) << "cols=" << cols << " k=" << k
+                                    << " largest=" << largest;
+      }
+    }
+  }
+}
+
+template <typename T>
+void CheckOthers(int64_t rows, int64_t cols) {
+  CPUContext dev_ctx;
+  auto x = RandomRows<T>(rows, cols);
+  std::vector<T> values(rows * cols);
+  std::vector<int64_t> indices(rows * cols);
+  for (bool descending : {true, false}) {
+    funcs::SortRows(dev_ctx,
+                    x.data(),
+                    rows,
+                    cols,
+                    descending,
+                    values.data(),
+                    indices.data());
+    for (int64_t r = 0; r < rows; ++r) {
+      auto order = StableOrder(x.data() + r * cols, cols, descending);
+      ASSERT_TRUE(std::equal(
+          order.begin(), order.end(), indices.begin() + r * cols));
+    }
+  }
+
+  for (int64_t k : {int64_t(1), (cols + 1) / 2, cols}) {
+    funcs::KthValueRows(
+        dev_ctx, x.data(), rows, cols, k, values.data(), indices.data());
+    for (int64_t r = 0; r < rows; ++r) {
+      const T* row = x.data() + r * cols;
+      auto order = StableOrder(row, cols, false);
+      ExpectSame(row[order[k - 1]], values[r]);
+      EXPECT_EQ(order[k - 1], indices[r]);
+    }
+  }
+
+  funcs::ModeRows(dev_ctx, x.data(), rows, cols, values.data(), indices.data());
+  for (int64_t r = 0; r < rows; ++r) {
+    const T* row = x.data() + r * cols;
+    auto order = StableOrder(row, cols, false);
+    int64_t mode = 0;
+    int64_t max_count = 0;
+    int64_t count = 0;
+    for (int64_t i = 0; i < cols; ++i) {
+      ++count;
+      if (i == cols - 1 || row[order[i + 1]] != row[order[i]]) {
+        if (count > max_count) {
+          max_count = count;
+          mode = order[i];
+        }
+        count = 0;
+      }
+    }
+    ExpectSame(row[mode], values[r]);
+    EXPECT_EQ(mode, indices[r]);
+  }
+}
+
+template <typename T>
+void CheckAll() {
+  for (int64_t cols : {1, 7, 200, 1000, 5000}) {
+    for (int64_t k : {int64_t(1), int64_t(3), (cols + 1) / 2, cols}) {
+      if (k <= cols) {
+        CheckTopK<T>(3, cols, k);
+      }
+    }
+    CheckOthers<T>(3, cols);
+  }
+  CheckTopK<T>(2, 150000, 100);
+  CheckTopK<T>(1, 150000, 20000);
+}
+
+TEST(CpuSelection, float) { CheckAll<float>(); }
+TEST(CpuSelection, double) { CheckAll<double>(); }
+TEST(CpuSelection, int32) { CheckAll<int32_t>(); }
+TEST(CpuSelection, int64) { CheckAll<int64_t>(); }
+
+TEST(CpuSelection, parallel) {
+  ScopedIntraOpNumThreads threads(4);
+  CheckTopK<float>(16, 3000, 40);
+  CheckTopK<float>(2, 300000, 300);
+  CheckOthers<float>(16, 500);
+}
+
+}  // namespace tests
+}  // namespace phi
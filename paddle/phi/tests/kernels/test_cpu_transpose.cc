@@ -0,0 +1,116 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/complex.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
+
+namespace phi {
+namespace tests {
+
+template <typename T>
+std::vector<T> NaivePermute(const std::vector<T>& x,
+                            const std::vector<int64_t>& dims,
+                            const std::vector<int>& axis) {
+  const int rank = dims.size();
+  std::vector<int64_t> in_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+  }
+  std::vector<T> out(x.size());
+  std::vector<int64_t> index(rank, 0);
+  for (size_t o = 0; o < out.size(); ++o) {
+    int64_t offset = 0;
+    for (int i = 0; i < rank; ++i) {
+      offset += index[i] * in_strides[axis[i]];
+    }
+    out[o] = x[offset];
+    for (int i = rank - 1; i >= 0; --i) {
+      if (++index[i] < dims[axis[i]]) {
+        break;
+      }
+      index[i] = 0;
+    }
+  }
+  return out;
+}
+
+// The values of the elements cycle, and the complex ones differ in the
+// imaginary parts, so that the halves of an element are checked too.
+template <typename T>
+T Element(int64_t i) {
+  return static_cast<T>(i % 251);
+}
+
+template <>
+dtype::complex<double> Element(int64_t i) {
+  return dtype::complex<double>(i % 251, -static_cast<double>(i));
+}
+
+template <typename T>
+void CheckPermute(const std::vector<int64_t>& dims,
+                  const std::vector<int>& axis) {
+  CPUContext dev_ctx;
+  int64_t numel = std::accumulate(
+      dims.begin(), dims.end(), int64_t(1), std::multiplies<int64_t>());
+  std::vector<T> x(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    x[i] = Element<T>(i);
+  }
+  std::vector<T> out(numel);
+  funcs::Permute(dev_ctx, x.data(), dims, axis, sizeof(T), out.data());
+  auto expected = NaivePermute(x, dims, axis);
+  for (int64_t i = 0; i < numel; ++i) {
+    ASSERT_EQ(expected[i], out[i]) << "at " << i;
+  }
+}
+
+template <typename T>
+void CheckShapes() {
+  // Identity, contiguous rows, 2D tiles with tails and NCHW <-> NHWC.
+  CheckPermute<T>({37}, {0});
+  CheckPermute<T>({3, 4, 5}, {0, 1, 2});
+  CheckPermute<T>({2, 3, 4, 64}, {0, 2, 1, 3});
+  CheckPermute<T>({67, 45}, {1, 0});
+  CheckPermute<T>({64, 128}, {1, 0});
+  CheckPermute<T>({2, 16, 9, 11}, {0, 2, 3, 1});
+  CheckPermute<T>({2, 9, 11, 16}, {0, 3, 1, 2});
+  // Dims of size 1, and dims merged on both sides.
+  CheckPermute<T>({1, 5, 1, 7}, {3, 2, 1, 0});
+  CheckPermute<T>({4, 5, 6, 7, 3}, {2, 3, 0, 1, 4});
+  CheckPermute<T>({3, 2, 5, 4, 2, 3, 2}, {6, 0, 4, 2, 1, 5, 3});
+}
+
+TEST(CpuTranspose, uint8) { CheckShapes<uint8_t>(); }
+TEST(CpuTranspose, int16) { CheckShapes<int16_t>(); }
+TEST(CpuTranspose, float) { CheckShapes<float>(); }
+TEST(CpuTranspose, double) { CheckShapes<double>(); }
+TEST(CpuTranspose, complex128) { CheckShapes<dtype::complex<double>>(); }
+
+TEST(CpuTranspose, parallel) {
+  ScopedIntraOpNumThreads threads(4);
+  CheckPermute<float>({2, 128, 56, 56}, {0, 2, 3, 1});
+  CheckPermute<float>({4, 128, 12, 64}, {0, 2, 1, 3});
+  CheckPermute<int64_t>({300, 500}, {1, 0});
+  CheckPermute<float>({1 << 16}, {0});
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,73 @@
+/* Copyright (c) 2022 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/int8_gemm.h"
+
+namespace phi {
+namespace tests {
+
+void TestGemmU8S8S32(int M, int N, int K, int zero_point) {
+  std::mt19937 rng(M * 131 + N * 17 + K);
+  std::uniform_int_distribution<int> dist(0, 255);
+  // Row strides larger than the matrices, to cover lda, ldb and ldc.
+  const int lda = K + 3, ldb = N + 5, ldc = N + 1;
+  std::vector<uint8_t> a(M * lda);
+  std::vector<int8_t> b(K * ldb);
+  for (auto& v : a) v = static_cast<uint8_t>(dist(rng));
+  for (auto& v : b) v = static_cast<int8_t>(dist(rng) - 128);
+
+  std::vector<int32_t> c(M * ldc, -1);
+  phi::funcs::GemmU8S8S32(M, N, K, a.data(), lda, zero_point, b.data(), ldb,
+                          c.data(), ldc);
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < N; ++n) {
+      int32_t ref = 0;
+      for (int k = 0; k < K; ++k) {
+        ref += (a[m * lda + k] - zero_point) * b[k * ldb + n];
+      }
+      ASSERT_EQ(c[m * ldc + n], ref) << "M " << M << " N " << N << " K " << K
+                                     << " at (" << m << ", " << n << ")";
+    }
+    // The padding of C is not written.
+    EXPECT_EQ(c[m * ldc + N], -1);
+  }
+}
+
+TEST(int8_gemm, u8s8s32) {
+  // The VNNI path, if the CPU supports it, and then the plain loop.
+  for (bool force_ref : {false, true}) {
+    phi::funcs::GemmU8S8S32ForceRef(force_ref);
+    VLOG(3) << "GemmU8S8S32 uses VNNI: " << phi::funcs::GemmU8S8S32UseVnni();
+    if (force_ref) {
+      EXPECT_FALSE(phi::funcs::GemmU8S8S32UseVnni());
+    }
+    for (int M : {1, 3, 4, 7}) {
+      for (int N : {1, 16, 33}) {
+        for (int K : {1, 4, 9, 64}) {
+          TestGemmU8S8S32(M, N, K, 0);
+          TestGemmU8S8S32(M, N, K, 128);
+        }
+      }
+    }
+  }
+  phi::funcs::GemmU8S8S32ForceRef(false);
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include <gtest/gtest.h>
 #include <memory>
+#include <random>
+#include <set>
+#include <tuple>
 
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/common/place.h"
@@ -24,6 +27,7 @@ limitations under the License. */
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/tests/kernels/cpu_test_helper.h"
 
 namespace phi {
 namespace tests {
@@ -821,5 +825,133 @@ TEST(DEV_API, sparse_conv3d_subm) {
              true);
 }
 
+struct Conv3dResult {
+  std::vector<int> rulebook;
+  std::vector<int> out_indices;
+  std::vector<float> out_values;
+  std::vector<float> x_grad;
+  std::vector<float> kernel_grad;
+};
+
+template <typename T>
+std::vector<T> ToVector(const DenseTensor& tensor) {
+  const T* data = tensor.data<T>();
+  return std::vector<T>(data, data + tensor.numel());
+}
+
+// Runs the conv3d and its grad on num_threads threads.
+Conv3dResult RunConv3d(const SparseCooTensor& x,
+                       const DenseTensor& kernel,
+                       const std::vector<int>& paddings,
+                       const std::vector<int>& strides,
+                       bool subm,
+                       int num_threads) {
+  phi::CPUContext dev_ctx;
+  dev_ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                           .GetAllocator(paddle::platform::CPUPlace())
+                           .get());
+  dev_ctx.Init();
+  ScopedIntraOpNumThreads threads(num_threads);
+
+  std::vector<int> dilations = {1, 1, 1};
+  DenseTensor rulebook = phi::Empty(
+      dev_ctx, DenseTensorMeta(DataType::INT32, {1}, DataLayout::NCHW));
+  SparseCooTensor out = sparse::Conv3d<float>(
+      dev_ctx, x, kernel, paddings, dilations, strides, 1, subm, &rulebook);
+  std::tuple<SparseCooTensor, DenseTensor> grads =
+      sparse::Conv3dGrad<float>(dev_ctx,
+                                x,
+                                kernel,
+                                rulebook,
+                                out,
+                                paddings,
+                                dilations,
+                                strides,
+                                1,
+                                subm);
+
+  Conv3dResult result;
+  result.rulebook = ToVector<int>(rulebook);
+  result.out_indices = ToVector<int>(out.non_zero_indices());
+  result.out_values = ToVector<float>(out.non_zero_elements());
+  result.x_grad = ToVector<float>(std::get<0>(grads).non_zero_elements());
+  result.kernel_grad = ToVector<float>(std::get<1>(grads));
+  return result;
+}
+
+void ExpectNear(const std::vector<float>& a, const std::vector<float>& b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    ASSERT_NEAR(a[i], b[i], 1e-4) << "at " << i;
+  }
+}
+
+// The parallel rulebook, gather, gemm and scatter on 4 threads give the
+// results of 1 thread on a random point cloud.
+TEST(DEV_API, sparse_conv3d_parallel) {
+  const int in_channels = 4;
+  const int out_channels = 8;
+  DDim x_dims = {2, 24, 24, 24, in_channels};
+  DDim kernel_dims = {3, 3, 3, in_channels, out_channels};
+
+  std::mt19937 rng(2022);
+  std::uniform_real_distribution<float> uniform(-1.f, 1.f);
+  std::set<std::vector<int>> points;
+  while (points.size() < 3000) {
+    points.insert({static_cast<int>(rng() % 2),
+                   static_cast<int>(rng() % 24),
+                   static_cast<int>(rng() % 24),
+                   static_cast<int>(rng() % 24)});
+  }
+  const int non_zero_num = points.size();
+
+  phi::CPUContext dev_ctx;
+  dev_ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                           .GetAllocator(paddle::platform::CPUPlace())
+                           .get());
+  dev_ctx.Init();
+  DenseTensor indices = phi::Empty(
+      dev_ctx,
+      DenseTensorMeta(DataType::INT32, {4, non_zero_num}, DataLayout::NCHW));
+  int* indices_ptr = indices.data<int>();
+  int col = 0;
+  for (auto& point : points) {
+    for (int d = 0; d < 4; d++) {
+      indices_ptr[d * non_zero_num + col] = point[d];
+    }
+    col++;
+  }
+  DenseTensor features = phi::Empty(
+      dev_ctx,
+      DenseTensorMeta(
+          DataType::FLOAT32, {non_zero_num, in_channels}, DataLayout::NHWC));
+  for (int64_t i = 0; i < features.numel(); i++) {
+    features.data<float>()[i] = uniform(rng);
+  }
+  SparseCooTensor x(indices, features, x_dims);
+  DenseTensor kernel = phi::Empty(
+      dev_ctx,
+      DenseTensorMeta(DataType::FLOAT32, kernel_dims, DataLayout::NHWC));
+  for (int64_t i = 0; i < kernel.numel(); i++) {
+    kernel.data<float>()[i] = uniform(rng);
+  }
+
+  for (bool subm : {true, false}) {
+    std::vector<int> paddings = {1, 1, 1};
+    std::vector<int> strides = {1, 1, 1};
+    if (!subm) {
+      strides = {2, 2, 2};
+    }
+    Conv3dResult serial = RunConv3d(x, kernel, paddings, strides, subm, 1);
+    Conv3dResult parallel = RunConv3d(x, kernel, paddings, strides, subm, 4);
+    ASSERT_FALSE(serial.rulebook.empty());
+    EXPECT_EQ(serial.rulebook, parallel.rulebook);
+    EXPECT_EQ(serial.out_indices, parallel.out_indices);
+    ExpectNear(serial.out_values, parallel.out_values);
+    ExpectNear(serial.x_grad, parallel.x_grad);
+    ExpectNear(serial.kernel_grad, parallel.kernel_grad);
+  }
+}
+
 }  // namespace tests
 }  // namespace phi
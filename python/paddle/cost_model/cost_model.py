@@ -58,6 +58,21 @@ class CostModel():
         cost_model = core.CostModel()
         cost_data = cost_model.ProfileMeasure(device)
 
+    def static_estimate(self, main_program, device='cpu', batch_size=1):
+        r"""
+        Estimate the time and memory of every op in main_program without
+        running it, from the op shapes and the throughput of the device.
+        The unknown dims of the shapes are taken as batch_size. The cpu is
+        calibrated by a micro-benchmark the first time, the other devices
+        should be set by core.CostModel.set_machine_profile first.
+
+        Returns:
+            core.CostData: the estimated cost, whose op ids are the indices
+            of the ops in the global block.
+        """
+        cost_model = core.CostModel()
+        return cost_model.static_estimate(main_program, device, batch_size)
+
     def static_cost_data(self):
         static_cost_data_path = os.path.join(
             os.path.dirname(__file__), "static_op_benchmark.json")
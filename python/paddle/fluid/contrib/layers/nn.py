@@ -462,14 +462,15 @@ def fused_embedding_seq_pool(input,
                              padding_idx=None,
                              combiner='sum',
                              param_attr=None,
-                             dtype='float32'):
+                             dtype='float32',
+                             id_weight=None):
     r"""
     **Embedding Sequence pool**
 
     This layer is the fusion of lookup table and sequence_pool.
 
     Args:
-        input (Variable): Input is a Tensor<int64> Variable, which contains the IDs' information.
+        input (Variable): Input is a Tensor<int32|int64> Variable, which contains the IDs' information.
             The value of the input IDs should satisfy :math:`0<= id < size[0]`.
         size (tuple|list): The shape of the lookup_table parameter. It should
             have two elements which indicate the size of the dictionary of
@@ -481,11 +482,17 @@ def fused_embedding_seq_pool(input,
             no effect to output. If :math:`padding\_idx < 0`, the :math:`padding\_idx`
             will automatically be converted to :math:`size[0] + padding\_idx` to use.
             Default: None.
-        combiner (str): The pooling type of sequence_pool, and only support `sum`.
+        combiner (str): The pooling type of sequence_pool, one of `sum`, `mean`,
+            `sqrt` and `max`. `mean` divides the weighted sum by the sum of the
+            weights, `sqrt` by the square root of the sum of the squared weights,
+            and `max` takes the element-wise max of the weighted embeddings.
             Default: sum.
         param_attr (ParamAttr): Parameters for this layer.
         dtype (np.dtype|core.VarDesc.VarType|str): The dtype refers to the data type of output
             tensor. It can be float32, float_16, int etc.
+        id_weight (Variable|None): The weights of the IDs, which have the same shape
+            as input and the data type of the output. If set :attr:`None`, every
+            ID weighs 1. Default: None.
     Returns:
         The sequence pooling variable which is a Tensor.
     Examples:
@@ -510,10 +517,12 @@ def fused_embedding_seq_pool(input,
     out = helper.create_variable_for_type_inference(dtype)
     padding_idx = -1 if padding_idx is None else padding_idx if padding_idx >= 0 else (
         size[0] + padding_idx)
+    inputs = {'Ids': input, 'W': w}
+    if id_weight is not None:
+        inputs['IdWeight'] = id_weight
     helper.append_op(
         type='fused_embedding_seq_pool',
-        inputs={'Ids': input,
-                'W': w},
+        inputs=inputs,
         outputs={'Out': out},
         attrs={
             'is_sparse': is_sparse,
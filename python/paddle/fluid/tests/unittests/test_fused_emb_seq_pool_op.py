@@ -17,7 +17,7 @@ from __future__ import print_function
 import unittest
 import platform
 import numpy as np
-from op_test import OpTest, skip_check_grad_ci
+from op_test import OpTest
 import paddle.fluid.core as core
 import paddle.fluid as fluid
 from paddle.fluid.op import Operator
@@ -25,8 +25,6 @@ import paddle.compat as cpt
 import paddle.version as ver
 
 
-@skip_check_grad_ci(reason="check_grad is called when ver.mkl() == ON"
-                    "and 'Linux' in platform.platform().")
 class TestFusedEmbeddingSeqPoolOp(OpTest):
     def setUp(self):
         self.op_type = "fused_embedding_seq_pool"
@@ -52,10 +50,8 @@ class TestFusedEmbeddingSeqPoolOp(OpTest):
 
     def test_check_grad(self):
         # TODO(wangzhongpu): support lod in dygraph mode
-        if ver.mkl() == "ON" and 'Linux' in platform.platform():
-            self.attrs = {'is_sparse': False}
-            self.check_grad(
-                ['W'], 'Out', no_grad_set=['Ids'], check_dygraph=False)
+        self.attrs = {'is_sparse': False}
+        self.check_grad(['W'], 'Out', no_grad_set=['Ids'], check_dygraph=False)
 
 
 class TestLookupTableOpWithPadding(TestFusedEmbeddingSeqPoolOp):
@@ -92,6 +88,79 @@ class TestLookupTableOpWithPadding(TestFusedEmbeddingSeqPoolOp):
                 ['W'], 'Out', no_grad_set=['Ids'], check_dygraph=False)
 
 
+class TestFusedEmbeddingSeqPoolOpMean(OpTest):
+    def setUp(self):
+        self.op_type = "fused_embedding_seq_pool"
+        self.set_attrs()
+        self.emb_size = 6
+        self.table = np.random.random((17, self.emb_size)).astype("float64")
+        ids = np.random.randint(0, 17, (6, 1, 2, 1)).astype(self.ids_dtype)
+        weights = np.random.uniform(0.5, 1.5, ids.shape).astype("float64")
+        self.lod = [[3, 1, 2]]
+        self.attrs = {'combiner': self.combiner}
+        self.inputs = {
+            'W': self.table,
+            'Ids': (ids, self.lod),
+            'IdWeight': (weights, self.lod)
+        }
+        self.outputs = {'Out': self.pool(ids, weights)}
+
+    def set_attrs(self):
+        self.combiner = 'mean'
+        self.ids_dtype = 'int64'
+
+    def pool(self, ids, weights):
+        ids = np.reshape(ids, [ids.shape[0], -1])
+        weights = np.reshape(weights, ids.shape)
+        output = list()
+        start = 0
+        for length in self.lod[0]:
+            pooled = list()
+            for slot in range(ids.shape[1]):
+                w = weights[start:start + length, slot][:, np.newaxis]
+                rows = self.table[ids[start:start + length, slot]] * w
+                if self.combiner == 'max':
+                    pooled.append(np.max(rows, 0))
+                elif self.combiner == 'mean':
+                    pooled.append(np.sum(rows, 0) / np.sum(w))
+                elif self.combiner == 'sqrt':
+                    pooled.append(np.sum(rows, 0) / np.sqrt(np.sum(w * w)))
+                else:
+                    pooled.append(np.sum(rows, 0))
+            output.append(np.concatenate(pooled))
+            start += length
+        return np.array(output)
+
+    def test_check_output(self):
+        # TODO(wangzhongpu): support lod in dygraph mode
+        self.check_output(check_dygraph=False)
+
+    def test_check_grad(self):
+        self.check_grad(
+            ['W'],
+            'Out',
+            no_grad_set=['Ids', 'IdWeight'],
+            check_dygraph=False)
+
+
+class TestFusedEmbeddingSeqPoolOpSqrt(TestFusedEmbeddingSeqPoolOpMean):
+    def set_attrs(self):
+        self.combiner = 'sqrt'
+        self.ids_dtype = 'int64'
+
+
+class TestFusedEmbeddingSeqPoolOpMax(TestFusedEmbeddingSeqPoolOpMean):
+    def set_attrs(self):
+        self.combiner = 'max'
+        self.ids_dtype = 'int64'
+
+
+class TestFusedEmbeddingSeqPoolOpInt32(TestFusedEmbeddingSeqPoolOpMean):
+    def set_attrs(self):
+        self.combiner = 'sum'
+        self.ids_dtype = 'int32'
+
+
 class TestFusedEmbeddingSeqPoolApi(unittest.TestCase):
     def test_api(self):
         if ver.mkl() == "ON" and 'Linux' in platform.platform():
@@ -280,6 +280,8 @@ class Profiler:
             This callable object will be called when ``scheduler`` returns ``ProfilerState.RECORD_AND_RETURN``. The default value is :ref:`export_chrome_tracing <api_paddle_profiler_export_chrome_tracing>` (./profiler_log/).
         timer_only (bool, optional): If it is True, the cost of Dataloader and every step of the model will be count without profiling. Otherwise, the model will
             be timed and profiled. Default: False.
+        with_perf_counters (bool, optional): If it is True, hardware performance counters (cycles, instructions, last level cache misses and branch misses)
+            are collected for every operator on CPU, shown in the chrome tracing file and in the summary table. It relies on perf_event_open and only works on Linux. Default: False.
 
     Examples:
         1. profiling range [2, 5).
@@ -397,7 +399,8 @@ class Profiler:
             targets: Optional[Iterable[ProfilerTarget]]=None,
             scheduler: Union[Callable[[int], ProfilerState], tuple, None]=None,
             on_trace_ready: Optional[Callable[..., Any]]=None,
-            timer_only: Optional[bool]=False):
+            timer_only: Optional[bool]=False,
+            with_perf_counters: Optional[bool]=False):
         supported_targets = _get_supported_targets()
         if targets:
             self.targets = set(targets)
@@ -415,6 +418,7 @@ class Profiler:
             profileoption.trace_switch |= (1 << 1)
         if ProfilerTarget.MLU in self.targets:
             profileoption.trace_switch |= (1 << 2)
+        profileoption.with_perf_counters = with_perf_counters
         wrap_optimizers()
         self.profiler = _Profiler.create(profileoption)
         if callable(scheduler):
@@ -374,11 +374,22 @@ class EventSummary:
             self.general_gpu_time = 0
             self.min_general_gpu_time = float('inf')
             self.max_general_gpu_time = 0
+            self.perf_counter_call = 0
+            self.cycles = 0
+            self.instructions = 0
+            self.llc_misses = 0
+            self.branch_misses = 0
 
         @property
         def avg_cpu_time(self):
             return self.cpu_time / self.call
 
+        @property
+        def ipc(self):
+            if self.cycles == 0:
+                return 0
+            return float(self.instructions) / self.cycles
+
         @property
         def avg_gpu_time(self):
             return self.gpu_time / self.call
@@ -411,11 +422,20 @@ class EventSummary:
         def add_call(self):
             self.call += 1
 
+        def add_perf_counters(self, node):
+            self.perf_counter_call += 1
+            self.cycles += node.cycles
+            self.instructions += node.instructions
+            self.llc_misses += node.llc_misses
+            self.branch_misses += node.branch_misses
+
         def add_item(self, node):
             self.add_call()
             self.add_cpu_time(node.cpu_time)
             self.add_gpu_time(node.gpu_time)
             self.add_general_gpu_time(node.general_gpu_time)
+            if node.has_perf_counters:
+                self.add_perf_counters(node)
             for child in node.children_node:
                 if child.name not in self.operator_inners:
                     self.operator_inners[
@@ -1244,6 +1264,70 @@ def _build_table(statistic_data,
         append('')
         append('')
 
+    ###### Print Operator Hardware Counter Summary Report ######
+    perf_counter_items = [(name, item)
+                          for name, item in
+                          statistic_data.event_summary.items.items()
+                          if item.perf_counter_call > 0]
+    if perf_counter_items:
+        all_row_values = []
+        name_column_width = 52
+        sorted_items = sorted(
+            perf_counter_items, key=lambda x: x[1].cycles, reverse=True)
+        for name, item in sorted_items:
+            if len(name) > name_column_width:
+                name = name[:name_column_width - 3] + "..."
+            all_row_values.append([
+                name, item.perf_counter_call, item.cycles,
+                item.instructions, '{:.3f}'.format(item.ipc), item.llc_misses,
+                item.branch_misses
+            ])
+            for innerop_name, innerop_node in item.operator_inners.items():
+                if innerop_node.perf_counter_call == 0:
+                    continue
+                if len(innerop_name) + 2 > name_column_width:
+                    innerop_name = innerop_name[:name_column_width - 5]
+                    innerop_name += "..."
+                all_row_values.append([
+                    '  {}'.format(innerop_name),
+                    innerop_node.perf_counter_call, innerop_node.cycles,
+                    innerop_node.instructions,
+                    '{:.3f}'.format(innerop_node.ipc),
+                    innerop_node.llc_misses, innerop_node.branch_misses
+                ])
+
+        headers = [
+            'Name', 'Calls', 'Cycles', 'Instructions', 'IPC', 'LLC Misses',
+            'Branch Misses'
+        ]
+        column_widths = [len(header) for header in headers]
+        column_widths[0] = name_column_width
+        for row_values in all_row_values:
+            for i in range(1, len(row_values)):
+                column_widths[i] = max(column_widths[i],
+                                       len(str(row_values[i])))
+
+        row_format_list = [""]
+        header_sep_list = [""]
+        line_length_list = [-SPACING_SIZE]
+        for width in column_widths:
+            add_column(width)
+
+        row_format = row_format_list[0]
+        header_sep = header_sep_list[0]
+        line_length = line_length_list[0]
+
+        # construct table string
+        append(add_title(line_length, "Operator Hardware Counter Summary"))
+        append(header_sep)
+        append(row_format.format(*headers))
+        append(header_sep)
+        for row_values in all_row_values:
+            append(row_format.format(*row_values))
+        append(header_sep)
+        append('')
+        append('')
+
     ###### Print Kernel Summary Report ######
     if statistic_data.event_summary.kernel_items:
         all_row_values = []